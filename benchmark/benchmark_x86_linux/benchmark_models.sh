@@ -5,6 +5,10 @@ NETWORK_TYPE=OPENVINO
 NUM_THREAD=4
 BUILD_ONLY="OFF"
 DOWNLOAD_MODEL="OFF"
+INSTANCE_NUM=1
+PIN_LIST=""
+NUMA_MODE=""
+JSON_OUTPUT="OFF"
 
 if [ -z $TNN_ROOT_PATH ]
 then
@@ -14,6 +18,7 @@ fi
 WORK_DIR=`pwd`
 BENCHMARK_MODEL_DIR=$WORK_DIR/benchmark_model
 OUTPUT_LOG_FILE=benchmark_models_result.txt
+OUTPUT_JSON_DIR=$WORK_DIR/benchmark_json
 LOOP_COUNT=20
 WARM_UP_COUNT=5
 
@@ -85,9 +90,13 @@ function download_bench_model() {
 }
 
 function usage() {
-    echo "usage: ./benchmark_models.sh  [-th] [-b] [-dl] [-mp] [-native]"
+    echo "usage: ./benchmark_models.sh  [-th] [-b] [-dl] [-mp] [-native] [-ni] [-pl] [-numa] [-json]"
     echo "options:"
     echo "        -th      thread num, defalut 1"
+    echo "        -ni      instance num running concurrently, default 1"
+    echo "        -pl      cpu list of each instance, eg: 0,1,2,3;4,5,6,7"
+    echo "        -numa    numa placement with -json: local, interleave or compare"
+    echo "        -json    bench with TNNBenchmark, write latency percentiles to benchmark_json/<model>.json"
     echo "        -b       build only "
     echo "        -dl      download model from github "
     echo "        -mp      model dir path"
@@ -135,9 +144,17 @@ function bench_x86_linux() {
         device=X86
         echo "benchmark device: ${device} " >> $WORK_DIR/$OUTPUT_LOG_FILE
 
+    if [ "OFF" != "$JSON_OUTPUT" ]; then
+        mkdir -p ${OUTPUT_JSON_DIR}
+    fi
+
     for benchmark_model in ${benchmark_model_list[*]}
     do
-        cd ${WORK_DIR}; LD_LIBRARY_PATH=x86_linux_release/lib ./x86_linux_release/bin/TNNTest -th ${NUM_THREAD} -wc ${WARM_UP_COUNT} -ic ${LOOP_COUNT} -dt ${device} -mt ${MODEL_TYPE} -nt ${NETWORK_TYPE} -mp ${BENCHMARK_MODEL_DIR}/${benchmark_model}  >> $OUTPUT_LOG_FILE
+        if [ "OFF" != "$JSON_OUTPUT" ]; then
+            cd ${WORK_DIR}; LD_LIBRARY_PATH=x86_linux_release/lib ./x86_linux_release/bin/TNNBenchmark -th ${NUM_THREAD} -wc ${WARM_UP_COUNT} -ic ${LOOP_COUNT} -dt ${device} -mt ${MODEL_TYPE} -nt ${NETWORK_TYPE} -ni ${INSTANCE_NUM} -pl "${PIN_LIST}" -nm "${NUMA_MODE}" -jp ${OUTPUT_JSON_DIR}/${benchmark_model%.*}.json -mp ${BENCHMARK_MODEL_DIR}/${benchmark_model}  >> $OUTPUT_LOG_FILE
+        else
+            cd ${WORK_DIR}; LD_LIBRARY_PATH=x86_linux_release/lib ./x86_linux_release/bin/TNNTest -th ${NUM_THREAD} -wc ${WARM_UP_COUNT} -ic ${LOOP_COUNT} -dt ${device} -mt ${MODEL_TYPE} -nt ${NETWORK_TYPE} -mp ${BENCHMARK_MODEL_DIR}/${benchmark_model}  >> $OUTPUT_LOG_FILE
+        fi
     done
     fi
 
@@ -158,6 +175,25 @@ while [ "$1" != "" ]; do
             NUM_THREAD="$1"
             shift
             ;;
+        -ni)
+            shift
+            INSTANCE_NUM="$1"
+            shift
+            ;;
+        -pl)
+            shift
+            PIN_LIST="$1"
+            shift
+            ;;
+        -numa)
+            shift
+            NUMA_MODE="$1"
+            shift
+            ;;
+        -json)
+            shift
+            JSON_OUTPUT=ON
+            ;;
         -b)
             shift
             BUILD_ONLY=ON
@@ -40,6 +40,73 @@ const int kMaxCharsPerWords = 100;
 const int MaxSeqCount = 256;
 const size_t maxAns = 3;
 
+// decode one utf-8 code point, an invalid byte is returned as U+FFFD of length 1
+static uint32_t DecodeUtf8(const char* data, size_t size, size_t& len) {
+    const uint8_t* p = reinterpret_cast<const uint8_t*>(data);
+    if (p[0] < 0x80) {
+        len = 1;
+        return p[0];
+    }
+    int extra = 0;
+    uint32_t cp = 0;
+    if ((p[0] & 0xE0) == 0xC0) {
+        extra = 1;
+        cp    = p[0] & 0x1F;
+    } else if ((p[0] & 0xF0) == 0xE0) {
+        extra = 2;
+        cp    = p[0] & 0x0F;
+    } else if ((p[0] & 0xF8) == 0xF0) {
+        extra = 3;
+        cp    = p[0] & 0x07;
+    } else {
+        len = 1;
+        return 0xFFFD;
+    }
+    if (static_cast<size_t>(extra) >= size) {
+        len = 1;
+        return 0xFFFD;
+    }
+    for (int i = 1; i <= extra; i++) {
+        if ((p[i] & 0xC0) != 0x80) {
+            len = 1;
+            return 0xFFFD;
+        }
+        cp = (cp << 6) | (p[i] & 0x3F);
+    }
+    len = extra + 1;
+    return cp;
+}
+
+static bool IsWhitespace(uint32_t cp) {
+    return cp == ' ' || cp == '\t' || cp == '\r' || cp == '\n' || cp == 0x00A0 || cp == 0x3000 ||
+           (cp >= 0x2000 && cp <= 0x200A);
+}
+
+static bool IsPunct(uint32_t cp) {
+    if (cp < 0x80) {
+        return (cp >= 33 && cp <= 47) || (cp >= 58 && cp <= 64) || (cp >= 91 && cp <= 96) ||
+               (cp >= 123 && cp <= 126);
+    }
+    if (cp <= 0xFFFF && kChinesePunts.count(static_cast<uint16_t>(cp)) > 0) {
+        return true;
+    }
+    // general punctuation, cjk symbols and punctuation, fullwidth ascii punctuation
+    return (cp >= 0x2010 && cp <= 0x2027) || (cp >= 0x2030 && cp <= 0x205E) || (cp >= 0x3001 && cp <= 0x3003) ||
+           (cp >= 0x3008 && cp <= 0x3011) || (cp >= 0x3014 && cp <= 0x301F) || (cp >= 0xFF01 && cp <= 0xFF0F) ||
+           (cp >= 0xFF1A && cp <= 0xFF20) || (cp >= 0xFF3B && cp <= 0xFF40) || (cp >= 0xFF5B && cp <= 0xFF65);
+}
+
+// cjk ideographs are words of their own, as in the original bert basic tokenizer
+static bool IsCjk(uint32_t cp) {
+    return (cp >= 0x4E00 && cp <= 0x9FFF) || (cp >= 0x3400 && cp <= 0x4DBF) || (cp >= 0x20000 && cp <= 0x2A6DF) ||
+           (cp >= 0x2A700 && cp <= 0x2B73F) || (cp >= 0x2B740 && cp <= 0x2B81F) || (cp >= 0x2B820 && cp <= 0x2CEAF) ||
+           (cp >= 0xF900 && cp <= 0xFAFF) || (cp >= 0x2F800 && cp <= 0x2FA1F);
+}
+
+static inline uint8_t ToLowerASCII(char c) {
+    return (c <= 'Z' && c >= 'A') ? static_cast<uint8_t>(c + 32) : static_cast<uint8_t>(c);
+}
+
 bool BertTokenizer::is_punct_char(char cp) {
   if ((cp >= 33 && cp <= 47) || (cp >= 58 && cp <= 64) ||
       (cp >= 91 && cp <= 96) || (cp >= 123 && cp <= 126)) {
@@ -143,6 +210,7 @@ Status BertTokenizer::InitByFileContent(std::string content) {
     SplitString(content.c_str(), content.size(), '\n', lines);
 
     InitFromLines(lines);
+    BuildTrie();
     if (token_2_id_map_.find(kPadToken) == token_2_id_map_.end()) {
         return Status(TNNERR_INVALID_INPUT, "The vocab file is invalid, [PAD] needed.");
     }
@@ -158,6 +226,7 @@ Status BertTokenizer::InitByFileContent(std::string content) {
     if (token_2_id_map_.find(kMaskToken) == token_2_id_map_.end()) {
         return Status(TNNERR_INVALID_INPUT, "The vocab file is invliad, [MASK] needed.");
     }
+    unk_id_ = token_2_id_map_.at(kUnkToken);
     int v = token_2_id_map_.at(kPadToken);
     if (v != 0) {
         return Status(TNNERR_INVALID_INPUT, "The vocab file is invliad, [PAD] shoulde be at the head of file.");
@@ -206,137 +275,230 @@ std::string BertTokenizer::Id2Word(size_t id) {
     return kUnkToken;
 }
 
-void BertTokenizer::max_seg_(std::string s, std::vector<size_t>& results) {
-  bool sep = false;
-  if (s.find("##") != std::string::npos) {
-      s.replace(s.find("##"), 2, "");
-      sep = true;
-  }
-  int end = s.size();
-  int start = 0;
-  bool firstOne = true;
-  while (start < end) {
-    std::string test(s.c_str() + start, end - start);
-    if (!firstOne) {
-      test = std::string("##") + test;
-    }
-    std::string test_low = toLower(test);
-    auto it = token_2_id_map_.find(test_low);
-    
-    if (it == token_2_id_map_.end()) {
-      end -= 1;
-    } else {
-      // spdlog::info("now got :{}", test);
-      if (sep) {
-        std::string test1 = "##" + test;
-        features_.push_back(test1);
-        sep = false;
-      } else {
-        features_.push_back(test);
-      }
-      results.push_back(it->second);
-      start = end;
-      end = s.size();
-      firstOne = false;
+void BertTokenizer::BuildTrie() {
+    // build with sorted child maps, then flatten the nodes breadth first
+    std::vector<std::map<uint8_t, int>> children(1);
+    std::vector<int> token_ids(1, -1);
+    for (size_t i = 0; i < tokens_.size(); i++) {
+        int node = 0;
+        for (char c : tokens_[i]) {
+            auto iter = children[node].find(static_cast<uint8_t>(c));
+            if (iter == children[node].end()) {
+                int child = static_cast<int>(children.size());
+                children[node][static_cast<uint8_t>(c)] = child;
+                children.push_back({});
+                token_ids.push_back(-1);
+                node = child;
+            } else {
+                node = iter->second;
+            }
+        }
+        // later duplicates win, as in token_2_id_map_
+        token_ids[node] = static_cast<int>(i);
     }
-  }
-  if (firstOne) {
-    // not any one matched
-    if (sep) {
-        std::string test1 = "##" + s;
-        features_.push_back(s.append(2, '#'));
-    } else
-        features_.push_back(s);
-    results.push_back(token_2_id_map_.at(kUnkToken));
-  }
+
+    std::vector<int> order(1, 0), new_index(children.size(), -1);
+    new_index[0] = 0;
+    for (size_t i = 0; i < order.size(); i++) {
+        for (auto& child : children[order[i]]) {
+            new_index[child.second] = static_cast<int>(order.size());
+            order.push_back(child.second);
+        }
+    }
+
+    trie_child_begin_.assign(1, 0);
+    trie_edge_bytes_.clear();
+    trie_edge_nodes_.clear();
+    trie_token_ids_.clear();
+    for (int old_index : order) {
+        for (auto& child : children[old_index]) {
+            trie_edge_bytes_.push_back(child.first);
+            trie_edge_nodes_.push_back(new_index[child.second]);
+        }
+        trie_child_begin_.push_back(static_cast<int>(trie_edge_bytes_.size()));
+        trie_token_ids_.push_back(token_ids[old_index]);
+    }
+    trie_root_children_.assign(256, -1);
+    for (int e = trie_child_begin_[0]; e < trie_child_begin_[1]; e++) {
+        trie_root_children_[trie_edge_bytes_[e]] = trie_edge_nodes_[e];
+    }
+
+    int node = trie_root_children_['#'];
+    trie_suffix_root_ = node >= 0 ? TrieChild(node, '#') : -1;
 }
 
-std::vector<size_t> BertTokenizer::Encode(std::string text, Status &status) {
-    std::vector<size_t> results;
-    text = StripStringASCIIWhole(text);
-    text = basic_separate(text);
-    // for(size_t i = 0; i < text.length(); i++) {
-    //     if (text[i] <= 'Z' && text[i] >= 'A') text[i] += 32;
-    // }
-    std::vector<std::string> tokens;
-    SplitString(text.c_str(), text.size(), ' ', tokens);
-    for (auto s : tokens) {
-        // features_.push_back(s);
-        if (s.size() > kMaxCharsPerWords) {
-            results.push_back(token_2_id_map_.at(kUnkToken));
+int BertTokenizer::TrieChild(int node, uint8_t byte) const {
+    if (node == 0) {
+        return trie_root_children_[byte];
+    }
+    const uint8_t* begin = trie_edge_bytes_.data() + trie_child_begin_[node];
+    const uint8_t* end   = trie_edge_bytes_.data() + trie_child_begin_[node + 1];
+    const uint8_t* edge  = std::lower_bound(begin, end, byte);
+    if (edge == end || *edge != byte) {
+        return -1;
+    }
+    return trie_edge_nodes_[edge - trie_edge_bytes_.data()];
+}
+
+void BertTokenizer::EncodeWord(const char* word, size_t len, bool sep, std::vector<int>& ids,
+                               std::vector<std::string>* features) {
+    if (len + (sep ? 2 : 0) > kMaxCharsPerWords) {
+        ids.push_back(unk_id_);
+        return;
+    }
+    size_t start = 0;
+    bool first   = true;
+    while (start < len) {
+        // longest piece from start, pieces after the first one are looked up as ##piece
+        int node         = first ? 0 : trie_suffix_root_;
+        int match_id     = -1;
+        size_t match_end = start;
+        for (size_t k = start; k < len && node >= 0; k++) {
+            node = TrieChild(node, ToLowerASCII(word[k]));
+            if (node >= 0 && trie_token_ids_[node] >= 0) {
+                match_id  = trie_token_ids_[node];
+                match_end = k + 1;
+            }
+        }
+        if (match_id < 0) {
+            // the rest of a partly matched word is dropped
+            break;
+        }
+        ids.push_back(match_id);
+        if (features) {
+            // ## represents connections between tokens(no white-space)
+            features->push_back((first && !sep) ? std::string() : std::string("##"));
+            features->back().append(word + start, match_end - start);
+        }
+        start = match_end;
+        first = false;
+    }
+    if (first) {
+        // not any one matched
+        ids.push_back(unk_id_);
+        if (features) {
+            features->push_back(sep ? std::string("##") : std::string());
+            features->back().append(word, len);
+        }
+    }
+}
+
+void BertTokenizer::EncodeText(const std::string& text, std::vector<int>& ids, std::vector<std::string>* features) {
+    const char* data  = text.data();
+    const size_t size = text.size();
+    size_t word_begin = 0;
+    bool in_word      = false;
+    bool word_sep     = false;
+    // a word right after punctuation or a cjk character, and punctuation not after white-space, are
+    // joined to the previous word
+    bool prev_isolated = false;
+    bool prev_space    = true;
+    size_t i = 0;
+    while (i < size) {
+        size_t len  = 1;
+        uint32_t cp = DecodeUtf8(data + i, size - i, len);
+        bool space  = IsWhitespace(cp);
+        if (space || IsPunct(cp) || IsCjk(cp)) {
+            if (in_word) {
+                EncodeWord(data + word_begin, i - word_begin, word_sep, ids, features);
+                in_word = false;
+            }
+            if (!space) {
+                EncodeWord(data + i, len, !prev_space, ids, features);
+            }
+            prev_space    = space;
+            prev_isolated = !space;
         } else {
-            max_seg_(s, results);
+            if (!in_word) {
+                in_word    = true;
+                word_begin = i;
+                word_sep   = prev_isolated;
+            }
+            prev_space    = false;
+            prev_isolated = false;
         }
+        i += len;
     }
+    if (in_word) {
+        EncodeWord(data + word_begin, size - word_begin, word_sep, ids, features);
+    }
+}
 
+std::vector<size_t> BertTokenizer::Encode(std::string text, Status &status) {
+    std::vector<int> ids;
+    EncodeText(text, ids, &features_);
     status = TNN_OK;
-
-    return results;
-
+    return std::vector<size_t>(ids.begin(), ids.end());
 }
 
-std::string BertTokenizer::StripStringASCIIWhole(const std::string str) {
-    size_t nn = str.size();
-    while (nn > 0 && (str[nn - 1] == ' ' || str[nn - 1] == '\t' ||
-                      str[nn - 1] == '\r' || str[nn - 1] == '\n')) {
-      nn -= 1;
-    }
-    size_t off = 0;
-    while (off < nn && (str[off] == ' ' || str[off] == '\t' ||
-                        str[off] == '\r' || str[off] == '\n')) {
-      off += 1;
-    }
-    bool seeWhitespace = false;
-    std::string ret;
-    for (size_t k = off; k < nn; k++) {
-      if (str[k] == ' ' || str[k] == '\t' || str[k] == '\r' || str[k] == '\n') {
-        if (!seeWhitespace) {
-          seeWhitespace = true;
-          ret.append(1, ' ');
+void BertTokenizer::FillSequence(const std::vector<int>& question, const std::vector<int>& paragraph, int seq_len,
+                                 int* input_ids, int* input_mask, int* segment_ids) {
+    int pos = 0;
+    auto push = [&](int id, int segment) {
+        if (pos < seq_len) {
+            input_ids[pos]   = id;
+            input_mask[pos]  = 1;
+            segment_ids[pos] = segment;
+            pos++;
         }
-      } else {
-        seeWhitespace = false;
-        ret.append(1, str[k]);
-      }
+    };
+    const int cls = static_cast<int>(ClsId());
+    const int sep = static_cast<int>(SepId());
+    push(cls, 0);
+    for (int id : question) {
+        push(id, 0);
+    }
+    push(sep, 0);
+    for (int id : paragraph) {
+        push(id, 1);
+    }
+    push(sep, 1);
+    for (; pos < seq_len; pos++) {
+        input_ids[pos]   = 0;
+        input_mask[pos]  = 0;
+        segment_ids[pos] = 0;
     }
-    return ret;
 }
 
 Status BertTokenizer::buildInput(std::string paragraph, std::string question, std::shared_ptr<BertTokenizerInput> input) {
-    std::vector<size_t> code1, code2;
-    Status status;
+    std::vector<int> code1, code2;
     features_.clear();
     
     features_.push_back("[CLS]");
-    code1 = Encode(question, status);
+    EncodeText(question, code1, &features_);
     features_.push_back("[SEP]");
-    code2 = Encode(paragraph, status);
+    EncodeText(paragraph, code2, &features_);
     features_.push_back("[SEP]");
 
-    code1.insert(code1.begin(), ClsId());
-    code1.insert(code1.end(), SepId());
-    for (size_t i = 0; i < MaxSeqCount; i++) {
-        if (i >= code1.size() && i < code1.size() + code2.size() + 1) reinterpret_cast<int*>(input->segments)[i] = 1;
-        else reinterpret_cast<int*>(input->segments)[i] = 0;
-    }
-    code1.insert(code1.end(), code2.begin(), code2.end());
-    code1.insert(code1.end(), SepId());
-
-    if (code1.size() < MaxSeqCount) {
-        code1.insert(code1.end(), (MaxSeqCount - code1.size()), 0);
-    }
+    FillSequence(code1, code2, MaxSeqCount, reinterpret_cast<int*>(input->inputIds),
+                 reinterpret_cast<int*>(input->inputMasks), reinterpret_cast<int*>(input->segments));
+    return TNN_OK;
+}
 
-    for (size_t i = 0; i < MaxSeqCount; i++) {
-        if (code1[i]) {
-            reinterpret_cast<int*>(input->inputIds)[i] = code1[i];
-            reinterpret_cast<int*>(input->inputMasks)[i] = 1;
+Status BertTokenizer::BuildBatchInput(const std::vector<std::string>& paragraphs,
+                                      const std::vector<std::string>& questions,
+                                      std::shared_ptr<BertTokenizerBatchInput> input) {
+    if (paragraphs.size() != questions.size() || paragraphs.size() > static_cast<size_t>(input->batch)) {
+        return Status(TNNERR_INVALID_INPUT, "paragraphs and questions do not match the batch input");
+    }
+    // the id buffers are reused for all sequences
+    std::vector<int> code1, code2;
+    const int seq_len = input->seq_len;
+    for (int b = 0; b < input->batch; b++) {
+        code1.clear();
+        code2.clear();
+        if (b < static_cast<int>(paragraphs.size())) {
+            EncodeText(questions[b], code1, nullptr);
+            EncodeText(paragraphs[b], code2, nullptr);
+            FillSequence(code1, code2, seq_len, input->inputIds.data() + b * seq_len,
+                         input->inputMasks.data() + b * seq_len, input->segments.data() + b * seq_len);
         } else {
-            reinterpret_cast<int*>(input->inputIds)[i] = 0;
-            reinterpret_cast<int*>(input->inputMasks)[i] = 0;
-            reinterpret_cast<int*>(input->segments)[i] = 0;
+            // unused rows of the batch are all padding
+            std::fill_n(input->inputIds.data() + b * seq_len, seq_len, 0);
+            std::fill_n(input->inputMasks.data() + b * seq_len, seq_len, 0);
+            std::fill_n(input->segments.data() + b * seq_len, seq_len, 0);
         }
     }
-
     return TNN_OK;
 }
 
@@ -361,6 +523,20 @@ BertTokenizerInput::~BertTokenizerInput() {
     if (inputMasks) free(inputMasks);
     if (segments) free(segments);
 }
+
+BertTokenizerBatchInput::BertTokenizerBatchInput(DeviceType device_type, int batch, int seq_len,
+    const std::string& input_id_name, const std::string& mask_name, const std::string& segment_name) :
+    batch(batch), seq_len(seq_len), inputIds(batch * seq_len, 0), inputMasks(batch * seq_len, 0),
+    segments(batch * seq_len, 0) {
+    DimsVector dims = {batch, seq_len};
+    mat_map_[input_id_name] = std::make_shared<TNN_NS::Mat>(device_type, NC_INT32, dims, inputIds.data());
+    mat_map_[mask_name]     = std::make_shared<TNN_NS::Mat>(device_type, NC_INT32, dims, inputMasks.data());
+    mat_map_[segment_name]  = std::make_shared<TNN_NS::Mat>(device_type, NC_INT32, dims, segments.data());
+}
+
+BertTokenizerBatchInput::~BertTokenizerBatchInput() {
+    mat_map_.clear();
+}
  
 std::vector<size_t> BertTokenizer::_get_best_indexes(float* logits, size_t size, size_t n_best_size) {
     std::map<float, size_t, std::greater<float>> logits_index;
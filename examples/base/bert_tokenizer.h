@@ -17,6 +17,7 @@
 
 #include "tnn_sdk_sample.h"
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 #include <fstream>
 #include <string>
@@ -43,6 +44,19 @@ public:
     void* segments;
 };
 
+class BertTokenizerBatchInput : public TNNSDKInput {
+public:
+    // @brief int32 [batch, seq_len] ids, mask and segment mats
+    BertTokenizerBatchInput(DeviceType device_type, int batch, int seq_len, const std::string& input_id_name,
+            const std::string& mask_name, const std::string& segment_name);
+    virtual ~BertTokenizerBatchInput();
+    int batch;
+    int seq_len;
+    std::vector<int> inputIds;
+    std::vector<int> inputMasks;
+    std::vector<int> segments;
+};
+
 class BertTokenizer {
 public:
     // @brief Init vocabulary with vocab file
@@ -69,6 +83,11 @@ public:
     // build inputBert with paragraph and question
     Status buildInput(std::string paragraph, std::string question, std::shared_ptr<BertTokenizerInput> input);
 
+    // @brief build padded inputs of many paragraph and question pairs at once, pairs longer than the
+    // input seq_len are truncated. the features for ConvertResult are not kept.
+    Status BuildBatchInput(const std::vector<std::string>& paragraphs, const std::vector<std::string>& questions,
+            std::shared_ptr<BertTokenizerBatchInput> input);
+
     // @brief get indexes from result
     std::vector<size_t> _get_best_indexes(float* logits, size_t size, size_t n_best_size);
 
@@ -88,8 +107,22 @@ public:
     // @brief calculate probabilities for result
     Status CalProbs(std::vector<std::shared_ptr<prelim_prediction>> scores);
 private:
-    // @brief separate token to indivisible one
-    void max_seg_(std::string s, std::vector<size_t>& results);
+    // @brief split utf-8 text into words at whitespace, punctuation and cjk characters and append the
+    // word piece ids, the word pieces are appended to features if it is not null
+    void EncodeText(const std::string& text, std::vector<int>& ids, std::vector<std::string>* features);
+
+    // @brief greedy longest match of the word pieces of one word, sep marks a word joined to the previous one
+    void EncodeWord(const char* word, size_t len, bool sep, std::vector<int>& ids, std::vector<std::string>* features);
+
+    // @brief [CLS] question [SEP] paragraph [SEP] padded to seq_len
+    void FillSequence(const std::vector<int>& question, const std::vector<int>& paragraph, int seq_len,
+            int* input_ids, int* input_mask, int* segment_ids);
+
+    // @brief build the word piece trie from tokens_
+    void BuildTrie();
+
+    // @brief child of a trie node by byte, -1 if there is none
+    int TrieChild(int node, uint8_t byte) const;
 
     // @brief get vocabulary by lines of char
     Status InitFromLines(const std::vector<std::string>& lines);
@@ -97,13 +130,22 @@ private:
     // @brief split strings by sepChar (usually '\\n')
     Status SplitString(const char *str, size_t len, char sepChar, std::vector<std::string> &pOut);
 
-    // @brief split string ASCII
-    std::string StripStringASCIIWhole(const std::string str);
-
     // @param map between token and id in vocabulary
     std::map<std::string, int> token_2_id_map_;
     std::vector<std::string> tokens_;
 
+    // @param byte trie of the tokens, the children of node n are the edges [trie_child_begin_[n], trie_child_begin_[n + 1])
+    // sorted by byte, the root children are also kept in a table
+    std::vector<int> trie_child_begin_;
+    std::vector<uint8_t> trie_edge_bytes_;
+    std::vector<int> trie_edge_nodes_;
+    std::vector<int> trie_root_children_;
+    // @param token id of each node, -1 if no token ends there
+    std::vector<int> trie_token_ids_;
+    // @param node of "##", word piece continuations are matched from it
+    int trie_suffix_root_ = -1;
+    int unk_id_ = 0;
+
     // signs needed by vocabulary
     // @param [Unk] for Unknown
     static std::string kUnkToken;
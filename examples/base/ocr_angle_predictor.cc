@@ -31,6 +31,23 @@ namespace TNN_NS {
 
 OCRAnglePredictorOutput::~OCRAnglePredictorOutput() {}
 
+Status OCRAnglePredictor::Init(std::shared_ptr<TNNSDKOption> option) {
+    auto angle_option = dynamic_cast<OCRAnglePredictorOption *>(option.get());
+    if (angle_option && angle_option->max_batch > 1) {
+        // the blob memory is planned at init, so the instance is created with the largest batch
+        auto status = InitNet(option);
+        RETURN_ON_NEQ(status, TNN_OK);
+        InputShapesMap shapes;
+        status = net_->GetModelInputShapesMap(shapes);
+        RETURN_ON_NEQ(status, TNN_OK);
+        for (auto iter : shapes) {
+            option->input_shapes[iter.first] = {angle_option->max_batch, 3, dst_height_, dst_width_};
+        }
+        max_batch_ = angle_option->max_batch;
+    }
+    return TNNSDKSample::Init(option);
+}
+
 MatConvertParam OCRAnglePredictor::GetConvertParamForInput(std::string name) {
     MatConvertParam input_convert_param;
     input_convert_param.scale = {1.0 / 127.5, 1.0 / 127.5, 1.0 / 127.5, 0.0};
@@ -144,6 +161,64 @@ void OCRAnglePredictor::ProcessAngles(std::vector<std::shared_ptr<TNNSDKOutput>>
     }
 }
 
+Status OCRAnglePredictor::PredictBatch(const std::vector<std::shared_ptr<Mat>> &mats,
+                                       std::vector<std::shared_ptr<TNNSDKOutput>> &outputs) {
+    if (!instance_) {
+        return Status(TNNERR_INST_ERR, "TNN instance is null");
+    }
+    outputs.clear();
+    const auto input_name = GetInputNames()[0];
+    for (size_t begin = 0; begin < mats.size(); begin += max_batch_) {
+        const int batch = std::min(max_batch_, static_cast<int>(mats.size() - begin));
+
+        // every part image is fit into dst_height_ x dst_width_, stack them in one N8UC4 mat
+        DimsVector batch_dims = {batch, 4, dst_height_, dst_width_};
+        const int image_bytes = 4 * dst_height_ * dst_width_;
+        auto batch_mat = std::make_shared<Mat>(mats[begin]->GetDeviceType(), N8UC4, batch_dims);
+        for (int b = 0; b < batch; ++b) {
+            auto image = ProcessSDKInputMat(mats[begin + b]);
+            if (!image || image->GetDeviceType() != batch_mat->GetDeviceType()) {
+                return Status(TNNERR_PARAM_ERR, "OCRAnglePredictor::PredictBatch only supports cpu mats");
+            }
+            memcpy(static_cast<uint8_t *>(batch_mat->GetData()) + b * image_bytes, image->GetData(), image_bytes);
+        }
+
+        auto status = instance_->Reshape({{input_name, {batch, 3, dst_height_, dst_width_}}});
+        RETURN_ON_NEQ(status, TNN_OK);
+        status = instance_->SetInputMat(batch_mat, GetConvertParamForInput());
+        RETURN_ON_NEQ(status, TNN_OK);
+        status = instance_->ForwardAsync(nullptr);
+        RETURN_ON_NEQ(status, TNN_OK);
+
+        std::shared_ptr<Mat> output_mat = nullptr;
+        status = instance_->GetOutputMat(output_mat, GetConvertParamForOutput(), "",
+                                         TNNSDKUtils::GetFallBackDeviceType(batch_mat->GetDeviceType()),
+                                         GetOutputMatType());
+        RETURN_ON_NEQ(status, TNN_OK);
+        status = ProcessBatchOutput(output_mat, outputs);
+        RETURN_ON_NEQ(status, TNN_OK);
+    }
+    return TNN_OK;
+}
+
+Status OCRAnglePredictor::ProcessBatchOutput(std::shared_ptr<Mat> output_mat,
+                                             std::vector<std::shared_ptr<TNNSDKOutput>> &outputs) {
+    const auto output_dims  = output_mat->GetDims();
+    const int batch         = output_dims[0];
+    const int output_count  = DimsVectorUtils::Count(output_dims, 1);
+    const float *batch_data = static_cast<float *>(output_mat->GetData());
+
+    for (int b = 0; b < batch; ++b) {
+        const float *output_data = batch_data + b * output_count;
+        auto output              = std::make_shared<OCRAnglePredictorOutput>();
+        int max_idx              = static_cast<int>(std::max_element(output_data, output_data + output_count) - output_data);
+        output->index            = max_idx;
+        output->score            = output_data[max_idx];
+        outputs.push_back(output);
+    }
+    return TNN_OK;
+}
+
 OCRAnglePredictor::~OCRAnglePredictor() {}
 
 }
@@ -24,6 +24,14 @@
 
 namespace TNN_NS {
 
+class OCRAnglePredictorOption : public TNNSDKOption {
+public:
+    OCRAnglePredictorOption() {}
+    virtual ~OCRAnglePredictorOption() {}
+    // max part images predicted in one forward, the instance is created with this batch
+    int max_batch = 1;
+};
+
 class OCRAnglePredictorOutput : public TNNSDKOutput {
 public:
     OCRAnglePredictorOutput(std::shared_ptr<Mat> mat = nullptr) : TNNSDKOutput(mat) {};
@@ -35,6 +43,7 @@ public:
 class OCRAnglePredictor : public TNN_NS::TNNSDKSample {
 public:
     ~OCRAnglePredictor();
+    virtual Status Init(std::shared_ptr<TNNSDKOption> option);
     virtual MatConvertParam GetConvertParamForInput(std::string name = "");
     virtual std::shared_ptr<TNNSDKOutput> CreateSDKOutput();
     virtual Status ProcessSDKOutput(std::shared_ptr<TNNSDKOutput> output);
@@ -44,8 +53,16 @@ public:
     // Process angles from same image
     void ProcessAngles(std::vector<std::shared_ptr<TNNSDKOutput>>& angles);
     bool DoAngle() { return do_angle_; }
+
+    // predict the angles of cpu part images in forwards of at most GetMaxBatch() images
+    Status PredictBatch(const std::vector<std::shared_ptr<Mat>> &mats,
+                        std::vector<std::shared_ptr<TNNSDKOutput>> &outputs);
+    int GetMaxBatch() { return max_batch_; }
     
 private:
+    Status ProcessBatchOutput(std::shared_ptr<Mat> output_mat, std::vector<std::shared_ptr<TNNSDKOutput>> &outputs);
+
+    int max_batch_   = 1;
     bool do_angle_   = true;
     bool most_angle_ = true;
     int dst_width_   = 192;
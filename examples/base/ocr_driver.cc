@@ -20,12 +20,16 @@
 #include "ocr_angle_predictor.h"
 #include "ocr_text_recognizer.h"
 #include "ocr_driver.h"
+#include "sample_timer.h"
 #include "tnn/utils/dims_vector_utils.h"
 
 #include "opencv2/core/mat.hpp"
 #include "opencv2/core/core.hpp"
 #include "opencv2/imgproc.hpp"
 
+#include <atomic>
+#include <numeric>
+#include <thread>
 #include <vector>
 
 namespace TNN_NS {
@@ -106,6 +110,13 @@ Status OCRDriver::Init(std::vector<std::shared_ptr<TNNSDKSample>> sdks) {
     textbox_detector_ = sdks[0];
     angle_predictor_  = sdks[1];
     text_recognizer_  = sdks[2];
+    text_recognizers_.clear();
+    for (size_t i = 2; i < sdks.size(); ++i) {
+        if (!dynamic_cast<OCRTextRecognizer *>(sdks[i].get())) {
+            return Status(TNNERR_INST_ERR, "OCRDriver::Init has invalid sdks, extra sdks must be text recognizers");
+        }
+        text_recognizers_.push_back(sdks[i]);
+    }
     return TNNSDKComposeSample::Init(sdks);
 }
 
@@ -137,6 +148,125 @@ bool OCRDriver::hideTextBox() {
     return true;
 }
 
+Status OCRDriver::PartImagesToTNNMats(std::vector<cv::Mat>& part_images, std::shared_ptr<Mat> input_mat,
+                                      std::vector<std::shared_ptr<Mat>>& tnn_mats) {
+    auto dims = input_mat->GetDims();
+    tnn_mats.clear();
+    for (auto& cv_mat : part_images) {
+        // cv::Mat to TNN::Mat
+        dims[2] = cv_mat.rows;
+        dims[3] = cv_mat.cols;
+        auto tnn_mat = std::make_shared<Mat>(input_mat->GetDeviceType(), input_mat->GetMatType(), dims, nullptr);
+        auto status  = MatToTNNMat(cv_mat, tnn_mat, true);
+        RETURN_ON_NEQ(status, TNN_OK);
+        tnn_mats.push_back(tnn_mat);
+    }
+    return TNN_OK;
+}
+
+Status OCRDriver::PredictAngles(std::vector<std::shared_ptr<Mat>>& mats, bool batch,
+                                std::vector<std::shared_ptr<TNNSDKOutput>>& angles) {
+    auto angle_predictor = dynamic_cast<OCRAnglePredictor *>(angle_predictor_.get());
+    if (batch) {
+        auto status = angle_predictor->PredictBatch(mats, angles);
+        if (status == TNN_OK) {
+            return status;
+        }
+        LOGE("batched angle prediction failed, predict box by box: %s\n", status.description().c_str());
+    }
+
+    angles.clear();
+    for (auto& mat : mats) {
+        auto input = std::make_shared<TNNSDKInput>(mat);
+        std::shared_ptr<TNNSDKOutput> angle;
+        angle_predictor->Predict(input, angle);
+        angles.push_back(angle);
+    }
+    return TNN_OK;
+}
+
+Status OCRDriver::RecognizeTexts(std::vector<std::shared_ptr<Mat>>& mats, bool batch,
+                                 std::vector<std::shared_ptr<TNNSDKOutput>>& texts) {
+    texts.assign(mats.size(), nullptr);
+    if (!batch) {
+        auto text_recognizer = dynamic_cast<OCRTextRecognizer *>(text_recognizer_.get());
+        for (size_t i = 0; i < mats.size(); ++i) {
+#ifdef _CUDA_
+            DimsVector resized_dim = mats[i]->GetDims();
+            resized_dim[2] = 32;
+            resized_dim[3] = 48;
+            auto resized_mat = std::make_shared<Mat>(mats[i]->GetDeviceType(), mats[i]->GetMatType(), resized_dim);
+            Resize(mats[i], resized_mat, TNNInterpNearest);
+            auto input = std::make_shared<TNNSDKInput>(resized_mat);
+#else
+            auto input = std::make_shared<TNNSDKInput>(mats[i]);
+#endif
+            RETURN_ON_NEQ(text_recognizer->Predict(input, texts[i]), TNN_OK);
+        }
+        return TNN_OK;
+    }
+
+    // a batch is padded to its widest box, so boxes of similar width go together
+    const float max_width_ratio = 1.5f;
+    auto text_recognizer = dynamic_cast<OCRTextRecognizer *>(text_recognizers_[0].get());
+    int max_batch = text_recognizer->GetMaxBatch();
+    for (auto& sdk : text_recognizers_) {
+        max_batch = std::min(max_batch, dynamic_cast<OCRTextRecognizer *>(sdk.get())->GetMaxBatch());
+    }
+    std::vector<int> widths;
+    for (auto& mat : mats) {
+        widths.push_back(text_recognizer->GetInputWidth(mat->GetHeight(), mat->GetWidth()));
+    }
+    std::vector<int> order(mats.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return widths[a] < widths[b]; });
+
+    std::vector<std::vector<int>> buckets;
+    for (int index : order) {
+        if (buckets.empty() || buckets.back().size() >= max_batch ||
+            widths[index] > widths[buckets.back().front()] * max_width_ratio) {
+            buckets.push_back({});
+        }
+        buckets.back().push_back(index);
+    }
+
+    // every recognizer of the pool runs on its own thread and takes the next bucket until none is left
+    std::atomic<int> next_bucket(0);
+    const int worker_count = static_cast<int>(std::min(text_recognizers_.size(), buckets.size()));
+    std::vector<Status> statuses(worker_count, TNN_OK);
+    auto worker = [&](int worker_index) {
+        auto recognizer = dynamic_cast<OCRTextRecognizer *>(text_recognizers_[worker_index].get());
+        for (int b = next_bucket++; b < static_cast<int>(buckets.size()); b = next_bucket++) {
+            std::vector<std::shared_ptr<Mat>> bucket_mats;
+            for (int index : buckets[b]) {
+                bucket_mats.push_back(mats[index]);
+            }
+            std::vector<std::shared_ptr<TNNSDKOutput>> bucket_texts;
+            auto status = recognizer->PredictBatch(bucket_mats, bucket_texts);
+            if (status != TNN_OK) {
+                statuses[worker_index] = status;
+                return;
+            }
+            // results go back to the position of their box
+            for (size_t i = 0; i < buckets[b].size(); ++i) {
+                texts[buckets[b][i]] = bucket_texts[i];
+            }
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int i = 1; i < worker_count; ++i) {
+        threads.emplace_back(worker, i);
+    }
+    worker(0);
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    for (auto& status : statuses) {
+        RETURN_ON_NEQ(status, TNN_OK);
+    }
+    return TNN_OK;
+}
+
 Status OCRDriver::Predict(std::shared_ptr<TNNSDKInput> sdk_input,
                                   std::shared_ptr<TNNSDKOutput> &sdk_output) {
     Status status = TNN_OK;
@@ -146,50 +276,49 @@ Status OCRDriver::Predict(std::shared_ptr<TNNSDKInput> sdk_input,
         LOGE("input image is empty ,please check!\n");
         return status;
     }
-    auto predictor_textbox_detector_async = textbox_detector_;
-    auto predictor_angle_predictor_async  = angle_predictor_;
-    auto predictor_text_recognizer_async  = text_recognizer_;
-    
-    auto predictor_textbox_detector_cast = dynamic_cast<OCRTextboxDetector *>(predictor_textbox_detector_async.get());
-    auto predictor_angle_predictor_cast = dynamic_cast<OCRAnglePredictor *>(predictor_angle_predictor_async.get());
-    auto predictor_text_recognizer_cast = dynamic_cast<OCRTextRecognizer *>(predictor_text_recognizer_async.get());
+    auto predictor_textbox_detector_cast = dynamic_cast<OCRTextboxDetector *>(textbox_detector_.get());
+    auto predictor_angle_predictor_cast = dynamic_cast<OCRAnglePredictor *>(angle_predictor_.get());
     
     const auto input_mat = sdk_input->GetMat();
-    cv::Mat origin_input(input_mat->GetHeight(), input_mat->GetWidth(), CV_8UC4, input_mat->GetData());
+    last_timing_ = OCRDriverTiming();
+    SampleTimer total_timer, phase_timer;
+    total_timer.Start();
+
+    // batches are built on the host, gpu mats and the cuda recognizer run box by box
+    const auto device = input_mat->GetDeviceType();
+    bool batch = !sequential_ && (device == DEVICE_NAIVE || device == DEVICE_ARM || device == DEVICE_X86);
+#ifdef _CUDA_
+    batch = false;
+#endif
 
     std::vector<TextBox> text_boxes;
     std::shared_ptr<TNNSDKOutput> textbox_det;
     {
         // phase1: textbox detection
+        phase_timer.Start();
         status = predictor_textbox_detector_cast->Predict(sdk_input, textbox_det);
         if (textbox_det && dynamic_cast<OCRTextboxDetectorOutput *>(textbox_det.get())) {
             auto output = dynamic_cast<OCRTextboxDetectorOutput *>(textbox_det.get());
             text_boxes = output->text_boxes;
         }
+        phase_timer.Stop();
+        last_timing_.detect_ms = phase_timer.GetTime();
         if(text_boxes.size() <= 0) {
             return TNN_OK;
         }
     }
+    last_timing_.box_count = static_cast<int>(text_boxes.size());
     std::vector<cv::Mat> part_images = getPartImages(predictor_textbox_detector_cast->GetPaddedInput(), text_boxes);
-    auto dims = input_mat->GetDims();
+    std::vector<std::shared_ptr<Mat>> part_mats;
     
     if (predictor_angle_predictor_cast->DoAngle()) {
         // phase2: angle prediction
-        std::vector<std::shared_ptr<TNNSDKOutput>>angles;
-        for(int i=0; i<part_images.size(); ++i) {
-            // cv::Mat to TNN::Mat
-            auto& cv_mat   = part_images[i];
-            dims[2] = cv_mat.rows;
-            dims[3] = cv_mat.cols;
-            auto tnn_mat = std::make_shared<Mat>(input_mat->GetDeviceType(), input_mat->GetMatType(), dims, nullptr);
-            status = MatToTNNMat(cv_mat, tnn_mat, true);
-            RETURN_ON_NEQ(status, TNN_OK);
-            auto input   = std::make_shared<TNNSDKInput>(tnn_mat);
-            
-            std::shared_ptr<TNNSDKOutput> angle;
-            predictor_angle_predictor_cast->Predict(input, angle);
-            angles.push_back(angle);
-        }
+        phase_timer.Start();
+        status = PartImagesToTNNMats(part_images, input_mat, part_mats);
+        RETURN_ON_NEQ(status, TNN_OK);
+        std::vector<std::shared_ptr<TNNSDKOutput>> angles;
+        status = PredictAngles(part_mats, batch, angles);
+        RETURN_ON_NEQ(status, TNN_OK);
         predictor_angle_predictor_cast->ProcessAngles(angles);
         for(int i=0; i<part_images.size(); ++i) {
             auto angle = dynamic_cast<OCRAnglePredictorOutput *>(angles[i].get());
@@ -197,43 +326,29 @@ Status OCRDriver::Predict(std::shared_ptr<TNNSDKInput> sdk_input,
                 matRotateClockwise180(part_images[i]);
             }
         }
+        phase_timer.Stop();
+        last_timing_.angle_ms = phase_timer.GetTime();
     }
     std::vector<std::shared_ptr<TNNSDKOutput>> texts;
     {
         // phase3: text recognize
-        for(int i=0; i<part_images.size(); ++i) {
-            // cv::Mat to TNN::Mat
-            auto& cv_mat   = part_images[i];
-            dims[2] = cv_mat.rows;
-            dims[3] = cv_mat.cols;
-            auto tnn_mat = std::make_shared<Mat>(input_mat->GetDeviceType(), input_mat->GetMatType(), dims, nullptr);
-            status = MatToTNNMat(cv_mat, tnn_mat, true);
-            RETURN_ON_NEQ(status, TNN_OK);
-            #ifdef _CUDA_
-                DimsVector resized_dim = dims;
-                resized_dim[2] = 32;
-                resized_dim[3] = 48;
-                auto resized_mat = std::make_shared<Mat>(tnn_mat->GetDeviceType(), tnn_mat->GetMatType(), resized_dim);
-                Resize(tnn_mat, resized_mat, TNNInterpNearest);
-                auto input = std::make_shared<TNNSDKInput>(resized_mat);
-            #else
-                auto input   = std::make_shared<TNNSDKInput>(tnn_mat);
-            #endif
-            
-            std::shared_ptr<TNNSDKOutput> text;
-            RETURN_ON_NEQ(predictor_text_recognizer_cast->Predict(input, text), TNN_OK);
-            if (text && dynamic_cast<OCRTextRecognizerOutput *>(text.get())) {
-                texts.push_back(text);
-            }
-        }
+        phase_timer.Start();
+        status = PartImagesToTNNMats(part_images, input_mat, part_mats);
+        RETURN_ON_NEQ(status, TNN_OK);
+        status = RecognizeTexts(part_mats, batch, texts);
+        RETURN_ON_NEQ(status, TNN_OK);
+        phase_timer.Stop();
+        last_timing_.recognize_ms = phase_timer.GetTime();
     }
 
     {
         auto ocr_output = std::make_shared<OCROutput>();
         for(int i=0; i<texts.size(); ++i) {
-            const auto& o = texts[i];
+            auto text_output = dynamic_cast<OCRTextRecognizerOutput *>(texts[i].get());
+            if (!text_output) {
+                continue;
+            }
             const auto& box = text_boxes[i];
-            auto text_output = dynamic_cast<OCRTextRecognizerOutput *>(o.get());
             const auto& text = text_output->text;
             ocr_output->texts.push_back(text);
 
@@ -247,6 +362,8 @@ Status OCRDriver::Predict(std::shared_ptr<TNNSDKInput> sdk_input,
         // fill output
         sdk_output = ocr_output;
     }
+    total_timer.Stop();
+    last_timing_.total_ms = total_timer.GetTime();
 
     return TNN_OK;
 }
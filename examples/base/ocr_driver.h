@@ -45,22 +45,47 @@ public:
     float angle;
 };
 
+// latency of the phases of one OCRDriver::Predict in ms
+struct OCRDriverTiming {
+    int box_count       = 0;
+    double detect_ms    = 0;
+    double angle_ms     = 0;
+    double recognize_ms = 0;
+    double total_ms     = 0;
+};
+
 class OCRDriver : public TNN_NS::TNNSDKComposeSample {
 public:
     virtual ~OCRDriver() {}
     
     virtual Status Predict(std::shared_ptr<TNNSDKInput> input, std::shared_ptr<TNNSDKOutput> &output);
     
+    // sdks: textbox detector, angle predictor and one or more text recognizers, the recognizers run
+    // width bucketed batches of boxes concurrently
     virtual Status Init(std::vector<std::shared_ptr<TNNSDKSample>> sdks);
 
     virtual bool hideTextBox();
 
+    // predict angles and texts box by box instead of in batches
+    void SetSequential(bool sequential) { sequential_ = sequential; }
+    OCRDriverTiming GetLastTiming() { return last_timing_; }
+
 protected:
     Status MatToTNNMat(const cv::Mat& mat, std::shared_ptr<Mat>& tnn_mat, bool try_share_data);
+    Status PartImagesToTNNMats(std::vector<cv::Mat>& part_images, std::shared_ptr<Mat> input_mat,
+                               std::vector<std::shared_ptr<Mat>>& tnn_mats);
+    Status PredictAngles(std::vector<std::shared_ptr<Mat>>& mats, bool batch,
+                         std::vector<std::shared_ptr<TNNSDKOutput>>& angles);
+    Status RecognizeTexts(std::vector<std::shared_ptr<Mat>>& mats, bool batch,
+                          std::vector<std::shared_ptr<TNNSDKOutput>>& texts);
 
     std::shared_ptr<TNNSDKSample> textbox_detector_;
     std::shared_ptr<TNNSDKSample> angle_predictor_;
     std::shared_ptr<TNNSDKSample> text_recognizer_;
+    std::vector<std::shared_ptr<TNNSDKSample>> text_recognizers_;
+
+    bool sequential_ = false;
+    OCRDriverTiming last_timing_;
 };
 
 }
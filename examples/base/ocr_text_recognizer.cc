@@ -34,14 +34,16 @@ namespace TNN_NS {
 OCRTextRecognizerOutput::~OCRTextRecognizerOutput() {}
 
 Status OCRTextRecognizer::Init(std::shared_ptr<TNNSDKOption> option) {
+    auto recognizer_option = dynamic_cast<OCRTextRecognizerOption *>(option.get());
+    max_batch_ = std::max(recognizer_option->max_batch, 1);
     if (option->compute_units == TNNComputeUnitsGPU) {
-        option->max_input_shapes.insert( {"input", DimsVector({1, 3, dst_height_, max_width_})} );
+        option->max_input_shapes.insert( {"input", DimsVector({max_batch_, 3, dst_height_, max_width_})} );
         option->input_shapes.insert({"input", DimsVector({1, 3, 8, 8})});
     } else {
-        option->input_shapes.insert({"input", DimsVector({1, 3, dst_height_, max_width_})});
+        option->input_shapes.insert({"input", DimsVector({max_batch_, 3, dst_height_, max_width_})});
     }
     // load vocabulary
-    const auto& vocab_file_path = dynamic_cast<OCRTextRecognizerOption *>(option.get())->vocab_path;
+    const auto& vocab_file_path = recognizer_option->vocab_path;
     std::ifstream in(vocab_file_path.c_str());
     if (!in) {
         return Status(TNNERR_PARAM_ERR, "invalid vocabulary file path!");
@@ -155,11 +157,17 @@ Status OCRTextRecognizer::ProcessSDKOutput(std::shared_ptr<TNNSDKOutput> output_
     if (vocab_len != vocabulary_.size()) {
         return Status(TNNERR_INST_ERR, "invalid result shape!");
     }
-    
+    DecodeText(output_data, seq_len, 1, 0, output);
+
+    return status;
+}
+
+void OCRTextRecognizer::DecodeText(const float *output_data, int seq_len, int batch, int index,
+                                   OCRTextRecognizerOutput *output) {
+    const int vocab_len = static_cast<int>(vocabulary_.size());
     std::vector<float> scores;
     std::string result;
     
-    std::vector<float> exps(seq_len*vocab_len, 0);
     int last_idx = 0;
     // TODO: move this search into model
     for(int s=0; s<seq_len; ++s) {
@@ -167,16 +175,15 @@ Status OCRTextRecognizer::ProcessSDKOutput(std::shared_ptr<TNNSDKOutput> output_
         float max_score = -INFINITY;
         float max_score_pre_exp = -INFINITY;
         int max_idx = 0;
+        const float *step_data = output_data + (s * batch + index) * vocab_len;
         for(int i=0; i<vocab_len; ++i) {
-            float score = output_data[s * vocab_len + i];
+            float score = step_data[i];
             if (score > max_score_pre_exp) {
                 max_score_pre_exp = score;
             }
         }
         for(int i=0; i<vocab_len; ++i) {
-            float score = std::exp(output_data[s * vocab_len + i] - max_score_pre_exp);
-            //output_data[s * vocab_len + i] = score;
-            exps[s * vocab_len + i] = score;
+            float score = std::exp(step_data[i] - max_score_pre_exp);
             if (score > max_score) {
                 max_score = score;
                 max_idx = i;
@@ -193,8 +200,85 @@ Status OCRTextRecognizer::ProcessSDKOutput(std::shared_ptr<TNNSDKOutput> output_
     
     output->scores = scores;
     output->text = result;
+}
 
-    return status;
+int OCRTextRecognizer::GetInputWidth(int image_height, int image_width) {
+    if (image_height == dst_height_) {
+        return image_width;
+    }
+    return static_cast<int>(image_width * (static_cast<float>(dst_height_) / image_height));
+}
+
+Status OCRTextRecognizer::PredictBatch(const std::vector<std::shared_ptr<Mat>> &mats,
+                                       std::vector<std::shared_ptr<TNNSDKOutput>> &outputs) {
+    if (!instance_) {
+        return Status(TNNERR_INST_ERR, "TNN instance is null");
+    }
+    if (mats.empty() || mats.size() > max_batch_) {
+        return Status(TNNERR_PARAM_ERR, "OCRTextRecognizer::PredictBatch has invalid batch size");
+    }
+    const int batch = static_cast<int>(mats.size());
+
+    // 1) resize every part image to the input height
+    std::vector<cv::Mat> images;
+    int batch_width = 0;
+    for (const auto &mat : mats) {
+        if (mat->GetDeviceType() != DEVICE_NAIVE && mat->GetDeviceType() != DEVICE_ARM &&
+            mat->GetDeviceType() != DEVICE_X86) {
+            return Status(TNNERR_PARAM_ERR, "OCRTextRecognizer::PredictBatch only supports cpu mats");
+        }
+        cv::Mat cv_src(mat->GetHeight(), mat->GetWidth(), CV_8UC4, mat->GetData());
+        const int width = GetInputWidth(mat->GetHeight(), mat->GetWidth());
+        if (cv_src.rows != dst_height_) {
+            cv::Mat resized_src;
+            cv::resize(cv_src, resized_src, cv::Size(width, dst_height_));
+            cv_src = resized_src;
+        }
+        images.push_back(cv_src);
+        batch_width = std::max(batch_width, cv_src.cols);
+    }
+    if (batch_width > max_width_) {
+        LOGE("invalid input: input width:%d is too large!\n", batch_width);
+        return Status(TNNERR_PARAM_ERR, "input width is too large");
+    }
+
+    // 2) pad the images on the right with white to the widest one and stack them
+    DimsVector batch_dims = {batch, 4, dst_height_, batch_width};
+    auto batch_mat = std::make_shared<Mat>(mats[0]->GetDeviceType(), N8UC4, batch_dims);
+    const int image_bytes = 4 * dst_height_ * batch_width;
+    for (int b = 0; b < batch; ++b) {
+        cv::Mat padded(dst_height_, batch_width, CV_8UC4, static_cast<uint8_t *>(batch_mat->GetData()) + b * image_bytes);
+        padded.setTo(cv::Scalar(255, 255, 255, 255));
+        images[b].copyTo(padded(cv::Rect(0, 0, images[b].cols, images[b].rows)));
+    }
+
+    // 3) forward
+    const auto input_name = GetInputNames()[0];
+    auto status = instance_->Reshape({{input_name, {batch, 3, dst_height_, batch_width}}});
+    RETURN_ON_NEQ(status, TNN_OK);
+    status = instance_->SetInputMat(batch_mat, GetConvertParamForInput());
+    RETURN_ON_NEQ(status, TNN_OK);
+    status = instance_->ForwardAsync(nullptr);
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    std::shared_ptr<Mat> output_mat = nullptr;
+    status = instance_->GetOutputMat(output_mat, GetConvertParamForOutput(), "",
+                                     TNNSDKUtils::GetFallBackDeviceType(batch_mat->GetDeviceType()),
+                                     GetOutputMatType());
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    // 4) decode, the output is [seq_len, batch, vocab]
+    const auto output_shape = output_mat->GetDims();
+    if (output_shape.size() < 3 || output_shape[1] != batch || output_shape[2] != vocabulary_.size()) {
+        return Status(TNNERR_INST_ERR, "invalid result shape!");
+    }
+    outputs.clear();
+    for (int b = 0; b < batch; ++b) {
+        auto output = std::make_shared<OCRTextRecognizerOutput>();
+        DecodeText(static_cast<float *>(output_mat->GetData()), output_shape[0], batch, b, output.get());
+        outputs.push_back(output);
+    }
+    return TNN_OK;
 }
 
 OCRTextRecognizer::~OCRTextRecognizer() {}
@@ -29,6 +29,8 @@ public:
     OCRTextRecognizerOption() {}
     virtual ~OCRTextRecognizerOption() {}
     std::string vocab_path;
+    // max part images recognized in one forward, the instance is created with this batch
+    int max_batch = 1;
 };
 
 class OCRTextRecognizerOutput : public TNNSDKOutput {
@@ -48,12 +50,23 @@ public:
     virtual Status ProcessSDKOutput(std::shared_ptr<TNNSDKOutput> output);
     virtual std::shared_ptr<Mat> ProcessSDKInputMat(std::shared_ptr<Mat> mat,
                                                             std::string name = kTNNSDKDefaultName);
+
+    // recognize cpu part images in one forward, the images are padded to the widest one
+    Status PredictBatch(const std::vector<std::shared_ptr<Mat>> &mats,
+                        std::vector<std::shared_ptr<TNNSDKOutput>> &outputs);
+    int GetMaxBatch() { return max_batch_; }
+    // width of a part image after it is resized to the input height
+    int GetInputWidth(int image_height, int image_width);
     
 private:
+    // decode one sequence of the [seq_len, batch, vocab] output
+    void DecodeText(const float *output_data, int seq_len, int batch, int index, OCRTextRecognizerOutput *output);
+
     std::vector<std::string> vocabulary_;
     constexpr static int vocab_size_ = 5531;
     int dst_height_ = 32;
     int max_width_  = 4096;
+    int max_batch_  = 1;
 };
 
 }
@@ -0,0 +1,388 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn_length_batcher.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+#include "tnn/core/macro.h"
+#include "tnn/utils/dims_vector_utils.h"
+
+namespace TNN_NS {
+
+namespace {
+
+double ElapsedMs(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// copy a region of shape region between two dense tensors of the same rank. the region starts at
+// index 0 of every axis except batch_axis, where it starts at src_batch in src and dst_batch in dst
+template <typename T>
+void CopyRegion(const T *src, const DimsVector &src_dims, int src_batch, T *dst, const DimsVector &dst_dims,
+                int dst_batch, const DimsVector &region, int batch_axis) {
+    const int rank = (int)region.size();
+    std::vector<int64_t> src_strides(rank, 1), dst_strides(rank, 1);
+    for (int i = rank - 2; i >= 0; --i) {
+        src_strides[i] = src_strides[i + 1] * src_dims[i + 1];
+        dst_strides[i] = dst_strides[i + 1] * dst_dims[i + 1];
+    }
+    src += src_batch * src_strides[batch_axis];
+    dst += dst_batch * dst_strides[batch_axis];
+
+    const int row = region[rank - 1];
+    const int64_t rows = DimsVectorUtils::Count(region) / std::max(row, 1);
+    std::vector<int> index(rank, 0);
+    for (int64_t r = 0; r < rows; ++r) {
+        int64_t src_offset = 0, dst_offset = 0;
+        for (int i = 0; i < rank - 1; ++i) {
+            src_offset += index[i] * src_strides[i];
+            dst_offset += index[i] * dst_strides[i];
+        }
+        memcpy(dst + dst_offset, src + src_offset, row * sizeof(T));
+        for (int i = rank - 2; i >= 0; --i) {
+            if (++index[i] < region[i]) {
+                break;
+            }
+            index[i] = 0;
+        }
+    }
+}
+
+}  // namespace
+
+double LengthBatcherStats::PaddingWaste() const {
+    return padded_length > 0 ? 1.0 - (double)valid_length / padded_length : 0;
+}
+
+double LengthBatcherStats::ItemsPerSecond() const {
+    return run_ms > 0 ? item_count * 1000.0 / run_ms : 0;
+}
+
+double LengthBatcherStats::AverageBatch() const {
+    return forward_count > 0 ? (double)item_count / forward_count : 0;
+}
+
+Status TNNLengthBatcher::Init(std::shared_ptr<TNN> net, const NetworkConfig &config,
+                              const LengthBatcherOption &option) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!net || option.max_length <= 0 || option.max_batch <= 0 || option.length_axis <= 0) {
+        return Status(TNNERR_PARAM_ERR, "TNNLengthBatcher::Init has invalid net or option");
+    }
+    RETURN_ON_NEQ(net->GetModelInputShapesMap(model_shapes_), TNN_OK);
+    for (const auto &iter : model_shapes_) {
+        if ((int)iter.second.size() <= option.length_axis) {
+            return Status(TNNERR_PARAM_ERR, "TNNLengthBatcher::Init has length_axis out of the input dims of " +
+                                                iter.first);
+        }
+    }
+
+    net_    = net;
+    config_ = config;
+    option_ = option;
+    edges_.clear();
+    for (auto edge : option.bucket_edges) {
+        if (edge > 0 && edge < option.max_length) {
+            edges_.push_back(edge);
+        }
+    }
+    std::sort(edges_.begin(), edges_.end());
+    edges_.erase(std::unique(edges_.begin(), edges_.end()), edges_.end());
+    edges_.push_back(option.max_length);
+    learn_edges_ = option.bucket_edges.empty() && option.learn_bucket_count > 1;
+
+    instances_.clear();
+    histogram_.assign(option.max_length + 1, 0);
+    histogram_count_ = 0;
+    stats_           = LengthBatcherStats();
+    return TNN_OK;
+}
+
+InputShapesMap TNNLengthBatcher::BucketShapes(int batch, int edge) {
+    InputShapesMap shapes = model_shapes_;
+    for (auto &iter : shapes) {
+        iter.second[0]                   = batch;
+        iter.second[option_.length_axis] = edge;
+    }
+    return shapes;
+}
+
+Status TNNLengthBatcher::GetItemLength(const MatMap &item, int &length) {
+    length = -1;
+    for (const auto &iter : model_shapes_) {
+        auto mat = item.find(iter.first);
+        if (mat == item.end() || !mat->second) {
+            return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher item misses input " + iter.first);
+        }
+        auto dims = mat->second->GetDims();
+        auto type = mat->second->GetMatType();
+        if (dims.size() != iter.second.size() || dims[0] != 1 || (type != NCHW_FLOAT && type != NC_INT32)) {
+            return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher item has invalid mat of input " + iter.first);
+        }
+        const int item_length = dims[option_.length_axis];
+        if (length >= 0 && item_length != length) {
+            return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher item inputs differ in length");
+        }
+        length = item_length;
+    }
+    if (length <= 0 || length > option_.max_length) {
+        return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher item length is out of (0, max_length]");
+    }
+    return TNN_OK;
+}
+
+Status TNNLengthBatcher::GetBucketInstance(int edge, std::shared_ptr<Instance> &instance) {
+    auto iter = instances_.find(edge);
+    if (iter != instances_.end()) {
+        instance = iter->second;
+        return TNN_OK;
+    }
+    // memory of cpu devices is planned for the shapes given at creation, so create with the largest batch
+    Status status;
+    instance = net_->CreateInst(config_, status, BucketShapes(option_.max_batch, edge));
+    RETURN_ON_NEQ(status, TNN_OK);
+    if (!instance) {
+        return Status(TNNERR_INST_ERR, "TNNLengthBatcher failed to create the bucket instance");
+    }
+    instances_[edge] = instance;
+    return TNN_OK;
+}
+
+void TNNLengthBatcher::UpdateHistogram(const std::vector<int> &lengths) {
+    const bool learned = histogram_count_ >= option_.learn_after;
+    for (auto length : lengths) {
+        histogram_[length]++;
+    }
+    histogram_count_ += lengths.size();
+    if (!learn_edges_ || learned || histogram_count_ < option_.learn_after) {
+        return;
+    }
+
+    // edges are learned once, every new edge costs an instance
+    edges_ = LearnBucketEdges(histogram_, option_.learn_bucket_count, option_.learn_align);
+    for (auto iter = instances_.begin(); iter != instances_.end();) {
+        if (std::find(edges_.begin(), edges_.end(), iter->first) == edges_.end()) {
+            iter = instances_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+    std::string text;
+    for (auto edge : edges_) {
+        text += " " + std::to_string(edge);
+    }
+    LOGI("TNNLengthBatcher learned bucket edges:%s\n", text.c_str());
+}
+
+std::vector<int> TNNLengthBatcher::LearnBucketEdges(const std::vector<int64_t> &histogram, int count, int align) {
+    const int max_length = (int)histogram.size() - 1;
+    if (max_length <= 0) {
+        return {1};
+    }
+    align = std::max(align, 1);
+    std::vector<int> candidates;
+    for (int edge = align; edge < max_length; edge += align) {
+        candidates.push_back(edge);
+    }
+    candidates.push_back(max_length);
+    const int m = (int)candidates.size();
+    count       = std::max(std::min(count, m), 1);
+
+    std::vector<double> items(max_length + 1, 0), lengths(max_length + 1, 0);
+    for (int l = 0; l <= max_length; ++l) {
+        items[l]   = (l > 0 ? items[l - 1] : 0) + histogram[l];
+        lengths[l] = (l > 0 ? lengths[l - 1] : 0) + (double)histogram[l] * l;
+    }
+    // padding of the items with length in (prev, edge], prev < 0 for the first bucket
+    auto padding = [&](int prev, int edge) {
+        const double n = items[edge] - (prev >= 0 ? items[prev] : 0);
+        const double s = lengths[edge] - (prev >= 0 ? lengths[prev] : 0);
+        return n * edge - s;
+    };
+
+    // best[j][i]: least padding of the items up to candidates[i] in j + 1 buckets, the last one ending there
+    const double inf = std::numeric_limits<double>::max();
+    std::vector<std::vector<double>> best(count, std::vector<double>(m, inf));
+    std::vector<std::vector<int>> from(count, std::vector<int>(m, -1));
+    for (int i = 0; i < m; ++i) {
+        best[0][i] = padding(-1, candidates[i]);
+    }
+    for (int j = 1; j < count; ++j) {
+        for (int i = j; i < m; ++i) {
+            for (int p = j - 1; p < i; ++p) {
+                const double value = best[j - 1][p] + padding(candidates[p], candidates[i]);
+                if (value < best[j][i]) {
+                    best[j][i] = value;
+                    from[j][i] = p;
+                }
+            }
+        }
+    }
+
+    // fewest buckets reaching the least padding, as more buckets only cost instances
+    int buckets = count - 1;
+    for (int j = 0; j < count - 1; ++j) {
+        if (best[j][m - 1] <= best[count - 1][m - 1]) {
+            buckets = j;
+            break;
+        }
+    }
+    std::vector<int> edges;
+    for (int j = buckets, i = m - 1; j >= 0 && i >= 0; i = from[j][i], --j) {
+        edges.push_back(candidates[i]);
+    }
+    std::reverse(edges.begin(), edges.end());
+    return edges;
+}
+
+Status TNNLengthBatcher::ForwardBatch(int edge, const std::vector<const MatMap *> &items,
+                                      const std::vector<int> &lengths, std::vector<MatMap *> &outputs) {
+    std::shared_ptr<Instance> instance;
+    RETURN_ON_NEQ(GetBucketInstance(edge, instance), TNN_OK);
+    const int batch = (int)items.size();
+    RETURN_ON_NEQ(instance->Reshape(BucketShapes(batch, edge)), TNN_OK);
+
+    const int axis = option_.length_axis;
+    for (const auto &iter : BucketShapes(batch, edge)) {
+        const auto &name = iter.first;
+        const auto type  = items[0]->at(name)->GetMatType();
+        auto input       = std::make_shared<Mat>(DEVICE_NAIVE, type, iter.second);
+        const int count  = DimsVectorUtils::Count(iter.second);
+        if (type == NC_INT32) {
+            std::fill_n((int32_t *)input->GetData(), count, (int32_t)option_.pad_value);
+        } else {
+            std::fill_n((float *)input->GetData(), count, option_.pad_value);
+        }
+        for (int b = 0; b < batch; ++b) {
+            auto mat = items[b]->at(name);
+            if (mat->GetMatType() != type) {
+                return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher items differ in mat type of input " + name);
+            }
+            auto dims = mat->GetDims();
+            for (int i = 1; i < (int)dims.size(); ++i) {
+                if (i != axis && dims[i] != iter.second[i]) {
+                    return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher item has invalid dims of input " + name);
+                }
+            }
+            if (type == NC_INT32) {
+                CopyRegion((const int32_t *)mat->GetData(), dims, 0, (int32_t *)input->GetData(), iter.second, b,
+                           dims, 0);
+            } else {
+                CopyRegion((const float *)mat->GetData(), dims, 0, (float *)input->GetData(), iter.second, b, dims,
+                           0);
+            }
+        }
+        RETURN_ON_NEQ(instance->SetInputMat(input, MatConvertParam(), name), TNN_OK);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    RETURN_ON_NEQ(instance->Forward(), TNN_OK);
+    stats_.forward_ms += ElapsedMs(start);
+    stats_.forward_count++;
+    stats_.item_count += batch;
+    stats_.padded_length += (int64_t)batch * edge;
+    for (auto length : lengths) {
+        stats_.valid_length += length;
+    }
+
+    BlobMap output_blobs;
+    RETURN_ON_NEQ(instance->GetAllOutputBlobs(output_blobs), TNN_OK);
+    for (const auto &iter : output_blobs) {
+        const auto &name = iter.first;
+        std::shared_ptr<Mat> output;
+        RETURN_ON_NEQ(instance->GetOutputMat(output, MatConvertParam(), name, DEVICE_NAIVE, NCHW_FLOAT), TNN_OK);
+        const auto dims      = output->GetDims();
+        const int rank       = (int)dims.size();
+        auto batch_iter      = option_.output_batch_axis.find(name);
+        auto length_iter     = option_.output_length_axis.find(name);
+        const int batch_axis = batch_iter == option_.output_batch_axis.end() ? 0 : batch_iter->second;
+        const int out_axis   = length_iter == option_.output_length_axis.end() ? -1 : length_iter->second;
+        if (batch_axis < 0 || batch_axis >= rank || out_axis >= rank || dims[batch_axis] != batch) {
+            return Status(TNNERR_INVALID_INPUT, "TNNLengthBatcher has invalid batch or length axis of output " + name);
+        }
+        for (int b = 0; b < batch; ++b) {
+            auto item_dims        = dims;
+            item_dims[batch_axis] = 1;
+            if (out_axis >= 0) {
+                // outputs may be strided along the length, e.g. crnn steps of width / 4
+                item_dims[out_axis] = (int)(((int64_t)dims[out_axis] * lengths[b] + edge - 1) / edge);
+            }
+            auto item = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, item_dims);
+            CopyRegion((const float *)output->GetData(), dims, b, (float *)item->GetData(), item_dims, 0, item_dims,
+                       batch_axis);
+            (*outputs[b])[name] = item;
+        }
+    }
+    return TNN_OK;
+}
+
+Status TNNLengthBatcher::Run(const std::vector<MatMap> &items, std::vector<MatMap> &outputs) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!net_) {
+        return Status(TNNERR_INST_ERR, "TNNLengthBatcher is not initialized");
+    }
+    auto start = std::chrono::steady_clock::now();
+
+    std::vector<int> lengths(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        RETURN_ON_NEQ(GetItemLength(items[i], lengths[i]), TNN_OK);
+    }
+    UpdateHistogram(lengths);
+
+    std::vector<std::vector<int>> buckets(edges_.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        const int bucket = (int)(std::lower_bound(edges_.begin(), edges_.end(), lengths[i]) - edges_.begin());
+        buckets[bucket].push_back((int)i);
+    }
+
+    outputs.assign(items.size(), MatMap());
+    for (size_t bucket = 0; bucket < buckets.size(); ++bucket) {
+        const auto &indices = buckets[bucket];
+        for (size_t begin = 0; begin < indices.size(); begin += option_.max_batch) {
+            const size_t end = std::min(indices.size(), begin + option_.max_batch);
+            std::vector<const MatMap *> batch_items;
+            std::vector<int> batch_lengths;
+            std::vector<MatMap *> batch_outputs;
+            for (size_t i = begin; i < end; ++i) {
+                batch_items.push_back(&items[indices[i]]);
+                batch_lengths.push_back(lengths[indices[i]]);
+                batch_outputs.push_back(&outputs[indices[i]]);
+            }
+            RETURN_ON_NEQ(ForwardBatch(edges_[bucket], batch_items, batch_lengths, batch_outputs), TNN_OK);
+        }
+    }
+    stats_.run_ms += ElapsedMs(start);
+    return TNN_OK;
+}
+
+std::vector<int> TNNLengthBatcher::GetBucketEdges() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return edges_;
+}
+
+LengthBatcherStats TNNLengthBatcher::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+void TNNLengthBatcher::ResetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats_ = LengthBatcherStats();
+}
+
+}  // namespace TNN_NS
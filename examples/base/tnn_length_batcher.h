@@ -0,0 +1,114 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_EXAMPLES_BASE_TNN_LENGTH_BATCHER_H_
+#define TNN_EXAMPLES_BASE_TNN_LENGTH_BATCHER_H_
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "tnn/core/instance.h"
+#include "tnn/core/mat.h"
+#include "tnn/core/status.h"
+#include "tnn/core/tnn.h"
+
+namespace TNN_NS {
+
+struct LengthBatcherOption {
+    // upper edges of the length buckets in ascending order, the last one is raised to max_length.
+    // if empty, edges are learned from the length histogram once learn_after items have been seen
+    std::vector<int> bucket_edges = {};
+    // longest item accepted
+    int max_length = 512;
+    // most items run in one forward
+    int max_batch = 8;
+    // axis of every input that holds the sequence length, e.g. 1 for [N, L] token ids, 3 for [N, C, H, W] text lines
+    int length_axis = 1;
+    // axis of each output that follows the input length, outputs not listed are not un-padded
+    std::map<std::string, int> output_length_axis = {};
+    // axis of each output that holds the batch, 0 if not listed, e.g. 1 for [T, N, C] crnn outputs
+    std::map<std::string, int> output_batch_axis = {};
+    // value written into the padded tail of the inputs
+    float pad_value = 0;
+    // bucket count and edge alignment used when learning edges
+    int learn_bucket_count = 4;
+    int learn_align = 8;
+    int learn_after = 256;
+};
+
+struct LengthBatcherStats {
+    int64_t item_count = 0;
+    int64_t forward_count = 0;
+    // item lengths summed, and bucket edges summed over the batched items
+    int64_t valid_length = 0;
+    int64_t padded_length = 0;
+    double forward_ms = 0;
+    double run_ms = 0;
+
+    // share of the forwarded sequence positions that are padding
+    double PaddingWaste() const;
+    double ItemsPerSecond() const;
+    double AverageBatch() const;
+};
+
+// @brief runs variable length items in batches padded only to the edge of their length bucket.
+// every bucket owns an instance created with the shape [max_batch, ..., edge, ...], since cpu devices
+// plan blob memory once at init. items of a bucket are batched, the instance is reshaped to the real
+// batch, and the outputs are sliced back to every item with the padded positions removed.
+class TNNLengthBatcher {
+public:
+    // @param net the model, the shapes of its inputs give every dim except batch and length
+    Status Init(std::shared_ptr<TNN> net, const NetworkConfig &config, const LengthBatcherOption &option);
+
+    // @param items inputs of every item, each of shape [1, ..., length, ...] in NCHW_FLOAT or NC_INT32 on DEVICE_NAIVE.
+    //        all inputs of one item share the same length
+    // @param outputs NCHW_FLOAT outputs of every item in the order of items
+    Status Run(const std::vector<MatMap> &items, std::vector<MatMap> &outputs);
+
+    std::vector<int> GetBucketEdges();
+    LengthBatcherStats GetStats();
+    void ResetStats();
+
+    // @brief choose count edges, each a multiple of align, that minimize the padding of histogram,
+    // histogram[l] being the number of items of length l
+    static std::vector<int> LearnBucketEdges(const std::vector<int64_t> &histogram, int count, int align);
+
+private:
+    Status GetItemLength(const MatMap &item, int &length);
+    Status GetBucketInstance(int edge, std::shared_ptr<Instance> &instance);
+    Status ForwardBatch(int edge, const std::vector<const MatMap *> &items, const std::vector<int> &lengths,
+                        std::vector<MatMap *> &outputs);
+    void UpdateHistogram(const std::vector<int> &lengths);
+    InputShapesMap BucketShapes(int batch, int edge);
+
+    std::shared_ptr<TNN> net_ = nullptr;
+    NetworkConfig config_;
+    LengthBatcherOption option_;
+    InputShapesMap model_shapes_;
+    bool learn_edges_ = false;
+
+    std::mutex mutex_;
+    std::vector<int> edges_;
+    std::map<int, std::shared_ptr<Instance>> instances_;
+    std::vector<int64_t> histogram_;
+    int64_t histogram_count_ = 0;
+    LengthBatcherStats stats_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_EXAMPLES_BASE_TNN_LENGTH_BATCHER_H_
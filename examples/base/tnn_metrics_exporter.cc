@@ -0,0 +1,129 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn_metrics_exporter.h"
+
+#include <cstdio>
+#include <sstream>
+
+namespace TNN_NS {
+
+TNNMetricsExporter::TNNMetricsExporter(std::string prefix, std::map<std::string, std::string> labels)
+    : prefix_(prefix), labels_(labels) {}
+
+// the exposition format escapes backslash and line feed in help texts, and the double quote in label values too
+static std::string Escape(const std::string &text, bool label_value) {
+    std::string escaped = "";
+    for (char c : text) {
+        if (c == '\\') {
+            escaped += "\\\\";
+        } else if (c == '\n') {
+            escaped += "\\n";
+        } else if (c == '"' && label_value) {
+            escaped += "\\\"";
+        } else {
+            escaped += c;
+        }
+    }
+    return escaped;
+}
+
+std::string TNNMetricsExporter::LabelString(const std::string &extra_label) {
+    std::string labels = "";
+    for (auto iter : labels_) {
+        labels += (labels.empty() ? "" : ",") + iter.first + "=\"" + Escape(iter.second, true) + "\"";
+    }
+    if (!extra_label.empty()) {
+        labels += (labels.empty() ? "" : ",") + extra_label;
+    }
+    return labels.empty() ? "" : "{" + labels + "}";
+}
+
+static std::string FormatValue(double value) {
+    std::ostringstream stream;
+    stream.precision(12);
+    stream << value;
+    return stream.str();
+}
+
+void TNNMetricsExporter::AddCounter(std::string &out, const std::string &name, const std::string &help, double value) {
+    auto full_name = prefix_ + "_" + name;
+    out += "# HELP " + full_name + " " + Escape(help, false) + "\n";
+    out += "# TYPE " + full_name + " counter\n";
+    out += full_name + LabelString() + " " + FormatValue(value) + "\n";
+}
+
+void TNNMetricsExporter::AddGauge(std::string &out, const std::string &name, const std::string &help, double value) {
+    auto full_name = prefix_ + "_" + name;
+    out += "# HELP " + full_name + " " + Escape(help, false) + "\n";
+    out += "# TYPE " + full_name + " gauge\n";
+    out += full_name + LabelString() + " " + FormatValue(value) + "\n";
+}
+
+// prometheus buckets are cumulative and in seconds
+void TNNMetricsExporter::AddHistogram(std::string &out, const std::string &name, const std::string &help,
+                                      const LatencyHistogram &histogram) {
+    auto full_name = prefix_ + "_" + name;
+    out += "# HELP " + full_name + " " + Escape(help, false) + "\n";
+    out += "# TYPE " + full_name + " histogram\n";
+
+    uint64_t cumulative = 0;
+    for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        cumulative += histogram.buckets[i];
+        double bound_us = LatencyHistogram::GetBucketBoundUs(i);
+        auto le         = bound_us < 0 ? std::string("+Inf") : FormatValue(bound_us * 1e-6);
+        out += full_name + "_bucket" + LabelString("le=\"" + le + "\"") + " " + FormatValue(cumulative) + "\n";
+    }
+    out += full_name + "_sum" + LabelString() + " " + FormatValue(histogram.sum_us * 1e-6) + "\n";
+    out += full_name + "_count" + LabelString() + " " + FormatValue(histogram.count) + "\n";
+}
+
+std::string TNNMetricsExporter::Format(const InstanceMetrics &metrics) {
+    std::string out = "";
+    AddCounter(out, "forward_total", "Forwards started.", metrics.forward_count);
+    AddCounter(out, "forward_errors_total", "Forwards that returned an error.", metrics.forward_error_count);
+    AddCounter(out, "reshape_total", "Calls of Reshape.", metrics.reshape_count);
+    AddGauge(out, "forward_memory_bytes", "Blob memory planned for forward.", metrics.forward_memory_bytes);
+    AddGauge(out, "aliased_copy_bytes", "Bytes per forward not copied because blobs share memory.",
+             metrics.aliased_copy_bytes);
+    AddGauge(out, "workspace_bytes", "Shared workspace held by the device context.", metrics.workspace_bytes);
+    AddCounter(out, "workspace_grow_total", "Times the shared workspace grew.", metrics.workspace_grow_count);
+    AddCounter(out, "adapter_fallback_total", "Layer forwards run through a cpu adapter.",
+               metrics.adapter_fallback_count);
+    AddCounter(out, "reformat_bytes_total", "Bytes written by reformat layers.", metrics.reformat_bytes);
+    AddHistogram(out, "convert_in_seconds", "Latency of SetInputMat.", metrics.convert_in_latency);
+    AddHistogram(out, "forward_seconds", "Latency of the network forward.", metrics.forward_latency);
+    AddHistogram(out, "convert_out_seconds", "Latency of GetOutputMat.", metrics.convert_out_latency);
+    return out;
+}
+
+Status TNNMetricsExporter::WriteToFile(const InstanceMetrics &metrics, const std::string &path) {
+    auto content  = Format(metrics);
+    auto tmp_path = path + ".tmp";
+
+    FILE *file = fopen(tmp_path.c_str(), "w");
+    if (!file) {
+        return Status(TNNERR_OPEN_FILE, "open metrics file failed");
+    }
+    size_t written = fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+    if (written != content.size() || rename(tmp_path.c_str(), path.c_str()) != 0) {
+        remove(tmp_path.c_str());
+        return Status(TNNERR_OPEN_FILE, "write metrics file failed");
+    }
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,52 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_EXAMPLES_BASE_TNN_METRICS_EXPORTER_H_
+#define TNN_EXAMPLES_BASE_TNN_METRICS_EXPORTER_H_
+#include <map>
+#include <string>
+
+#include "tnn/core/instance_metrics.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+// @brief formats InstanceMetrics in the prometheus text exposition format
+class TNNMetricsExporter {
+public:
+    // @param prefix prefix of every metric name
+    // @param labels labels added to every sample, e.g. {{"model", "squeezenet"}}
+    explicit TNNMetricsExporter(std::string prefix = "tnn", std::map<std::string, std::string> labels = {});
+
+    std::string Format(const InstanceMetrics &metrics);
+
+    // @brief write the metrics to path through a temporary file and a rename, so that
+    // the textfile collector of node_exporter never reads a partial file
+    Status WriteToFile(const InstanceMetrics &metrics, const std::string &path);
+
+private:
+    std::string LabelString(const std::string &extra_label = "");
+    void AddCounter(std::string &out, const std::string &name, const std::string &help, double value);
+    void AddGauge(std::string &out, const std::string &name, const std::string &help, double value);
+    void AddHistogram(std::string &out, const std::string &name, const std::string &help,
+                      const LatencyHistogram &histogram);
+
+    std::string prefix_;
+    std::map<std::string, std::string> labels_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_EXAMPLES_BASE_TNN_METRICS_EXPORTER_H_
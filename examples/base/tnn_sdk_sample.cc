@@ -555,8 +555,7 @@ void TNNSDKSample::setNpuModelPath(std::string stored_path)
     model_path_str_ = stored_path;
 }
 
-TNN_NS::Status TNNSDKSample::Init(std::shared_ptr<TNNSDKOption> option) {
-    option_ = option;
+TNN_NS::Status TNNSDKSample::InitNet(std::shared_ptr<TNNSDKOption> option) {
     //网络初始化
     TNN_NS::Status status;
     if (!net_) {
@@ -576,6 +575,13 @@ TNN_NS::Status TNNSDKSample::Init(std::shared_ptr<TNNSDKOption> option) {
         }
         net_ = net;
     }
+    return TNN_NS::TNN_OK;
+}
+
+TNN_NS::Status TNNSDKSample::Init(std::shared_ptr<TNNSDKOption> option) {
+    option_ = option;
+    TNN_NS::Status status = InitNet(option);
+    RETURN_ON_NEQ(status, TNN_NS::TNN_OK);
 
     // network init
 #if defined(TNN_USE_NEON)
@@ -231,6 +231,8 @@ protected:
     BenchOption bench_option_;
     BenchResult bench_result_;
 
+    // create the net only, samples may query the model before the instance is created
+    Status InitNet(std::shared_ptr<TNNSDKOption> option);
     std::vector<std::string> GetInputNames();
     std::vector<std::string> GetOutputNames();
     std::shared_ptr<Mat> ResizeToInputShape(std::shared_ptr<Mat> input_mat, std::string name);
@@ -0,0 +1,117 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bert_tokenizer.h"
+#include "sample_timer.h"
+
+#include "../flags.h"
+
+using namespace TNN_NS;
+
+static const char vocab_path_message[] = "(required) vocab file path";
+DEFINE_string(v, "", vocab_path_message);
+static const char batch_message[] = "(optional) sequences per batch. Default is: 32";
+DEFINE_int32(b, 32, batch_message);
+static const char seq_len_message[] = "(optional) sequence length. Default is: 256";
+DEFINE_int32(l, 256, seq_len_message);
+static const char rounds_message[] = "(optional) passes over the text file. Default is: 3";
+DEFINE_int32(n, 3, rounds_message);
+
+static void PrintUsage(const char *exe) {
+    printf("usage:\n%s -v <vocab> -i <text file> [-b] batch [-l] seq_len [-n] rounds\n", exe);
+    printf("\t-v, <vocab>    \t%s\n", vocab_path_message);
+    printf("\t-i, <input>    \t%s, one paragraph per line\n", input_path_message);
+    printf("\t-b, <batch>    \t%s\n", batch_message);
+    printf("\t-l, <seq_len>  \t%s\n", seq_len_message);
+    printf("\t-n, <rounds>   \t%s\n", rounds_message);
+}
+
+int main(int argc, char **argv) {
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h || FLAGS_v.empty() || FLAGS_i.empty() || FLAGS_b <= 0 || FLAGS_l <= 0 || FLAGS_n <= 0) {
+        PrintUsage(argv[0]);
+        return -1;
+    }
+
+    BertTokenizer tokenizer;
+    auto status = tokenizer.Init(FLAGS_v);
+    if (status != TNN_OK) {
+        fprintf(stderr, "vocab init failed: %s\n", status.description().c_str());
+        return -1;
+    }
+
+    std::ifstream in(FLAGS_i);
+    if (!in) {
+        fprintf(stderr, "open %s failed\n", FLAGS_i.c_str());
+        return -1;
+    }
+    std::vector<std::string> paragraphs;
+    std::string line;
+    size_t text_bytes = 0;
+    while (std::getline(in, line)) {
+        if (!line.empty()) {
+            text_bytes += line.size();
+            paragraphs.push_back(line);
+        }
+    }
+    if (paragraphs.empty()) {
+        fprintf(stderr, "%s has no text\n", FLAGS_i.c_str());
+        return -1;
+    }
+    const double total_mb = static_cast<double>(text_bytes) * FLAGS_n / (1024.0 * 1024.0);
+
+    // one sequence at a time, as the reading comprehension demo does, keeping the features
+    SampleTimer timer;
+    size_t token_count = 0;
+    timer.Start();
+    for (int r = 0; r < FLAGS_n; r++) {
+        for (const auto &paragraph : paragraphs) {
+            auto ids = tokenizer.Encode(paragraph, status);
+            token_count += ids.size();
+        }
+    }
+    timer.Stop();
+    double seconds = timer.GetTime() / 1000.0;
+    printf("encode      : %8.2f MB/s %10.0f tokens/s %8.0f sequences/s\n", total_mb / seconds,
+           token_count / seconds, paragraphs.size() * FLAGS_n / seconds);
+
+    // padded batches of paragraphs with an empty question
+    auto input = std::make_shared<BertTokenizerBatchInput>(DEVICE_NAIVE, FLAGS_b, FLAGS_l, "input_ids_0",
+                                                           "input_mask_0", "segment_ids_0");
+    std::vector<std::string> batch_paragraphs, batch_questions;
+    timer.Start();
+    for (int r = 0; r < FLAGS_n; r++) {
+        for (size_t begin = 0; begin < paragraphs.size(); begin += FLAGS_b) {
+            size_t end = std::min(paragraphs.size(), begin + FLAGS_b);
+            batch_paragraphs.assign(paragraphs.begin() + begin, paragraphs.begin() + end);
+            batch_questions.resize(batch_paragraphs.size());
+            status = tokenizer.BuildBatchInput(batch_paragraphs, batch_questions, input);
+            if (status != TNN_OK) {
+                fprintf(stderr, "build batch input failed: %s\n", status.description().c_str());
+                return -1;
+            }
+        }
+    }
+    timer.Stop();
+    seconds = timer.GetTime() / 1000.0;
+    printf("batch encode: %8.2f MB/s %10s tokens/s %8.0f sequences/s\n", total_mb / seconds, "-",
+           paragraphs.size() * FLAGS_n / seconds);
+    return 0;
+}
@@ -0,0 +1,151 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include <algorithm>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bert_tokenizer.h"
+#include "tnn_length_batcher.h"
+#include "utils/utils.h"
+
+#include "../flags.h"
+
+using namespace TNN_NS;
+
+static const char vocab_path_message[] = "(required) vocab file path";
+DEFINE_string(v, "", vocab_path_message);
+static const char batch_message[] = "(optional) sequences per forward. Default is: 8";
+DEFINE_int32(b, 8, batch_message);
+static const char max_length_message[] = "(optional) max sequence length. Default is: 256";
+DEFINE_int32(l, 256, max_length_message);
+static const char buckets_message[] = "(optional) buckets learned from the lengths. Default is: 4";
+DEFINE_int32(k, 4, buckets_message);
+
+static void PrintUsage(const char *exe) {
+    printf("usage:\n%s -p <proto> -m <model> -v <vocab> -i <text file> [-b] batch [-l] max_length [-k] buckets\n", exe);
+    printf("\t-p, <proto>    \tbertsquad tnnproto path\n");
+    printf("\t-m, <model>    \tbertsquad tnnmodel path\n");
+    printf("\t-v, <vocab>    \t%s\n", vocab_path_message);
+    printf("\t-i, <input>    \t%s, one paragraph per line\n", input_path_message);
+    printf("\t-b, <batch>    \t%s\n", batch_message);
+    printf("\t-l, <length>   \t%s\n", max_length_message);
+    printf("\t-k, <buckets>  \t%s\n", buckets_message);
+}
+
+// the tokenized sequence without its padding as ids, mask and segments of shape [1, length]
+static MatMap BuildItem(std::shared_ptr<BertTokenizerBatchInput> input) {
+    const int length = (int)std::count(input->inputMasks.begin(), input->inputMasks.end(), 1);
+    DimsVector dims  = {1, length};
+    MatMap item;
+    item["input_ids_0"]   = std::make_shared<Mat>(DEVICE_NAIVE, NC_INT32, dims);
+    item["input_mask_0"]  = std::make_shared<Mat>(DEVICE_NAIVE, NC_INT32, dims);
+    item["segment_ids_0"] = std::make_shared<Mat>(DEVICE_NAIVE, NC_INT32, dims);
+    std::copy_n(input->inputIds.begin(), length, (int32_t *)item["input_ids_0"]->GetData());
+    std::copy_n(input->inputMasks.begin(), length, (int32_t *)item["input_mask_0"]->GetData());
+    std::copy_n(input->segments.begin(), length, (int32_t *)item["segment_ids_0"]->GetData());
+    return item;
+}
+
+static int RunBatcher(const char *name, std::shared_ptr<TNN> net, NetworkConfig &config,
+                      const LengthBatcherOption &option, const std::vector<MatMap> &items) {
+    TNNLengthBatcher batcher;
+    auto status = batcher.Init(net, config, option);
+    std::vector<MatMap> outputs;
+    if (status == TNN_OK) {
+        // the first pass creates the bucket instances and, with learned edges, fills the histogram
+        status = batcher.Run(items, outputs);
+    }
+    if (status == TNN_OK) {
+        batcher.ResetStats();
+        status = batcher.Run(items, outputs);
+    }
+    if (status != TNN_OK) {
+        fprintf(stderr, "%s failed: %s\n", name, status.description().c_str());
+        return -1;
+    }
+
+    std::string edges;
+    for (auto edge : batcher.GetBucketEdges()) {
+        edges += " " + std::to_string(edge);
+    }
+    auto stats = batcher.GetStats();
+    printf("%-10s: edges%-24s padding waste %5.1f%% %8.1f sequences/s %5.2f average batch %8.1f ms forward\n",
+           name, edges.c_str(), stats.PaddingWaste() * 100, stats.ItemsPerSecond(), stats.AverageBatch(),
+           stats.forward_ms);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+    if (FLAGS_h || FLAGS_p.empty() || FLAGS_m.empty() || FLAGS_v.empty() || FLAGS_i.empty() || FLAGS_b <= 0 ||
+        FLAGS_l <= 2 || FLAGS_k <= 0) {
+        PrintUsage(argv[0]);
+        return -1;
+    }
+
+    BertTokenizer tokenizer;
+    auto status = tokenizer.Init(FLAGS_v);
+    if (status != TNN_OK) {
+        fprintf(stderr, "vocab init failed: %s\n", status.description().c_str());
+        return -1;
+    }
+    std::ifstream in(FLAGS_i);
+    if (!in) {
+        fprintf(stderr, "open %s failed\n", FLAGS_i.c_str());
+        return -1;
+    }
+    // every paragraph with an empty question, as the batch encoder builds it
+    auto input = std::make_shared<BertTokenizerBatchInput>(DEVICE_NAIVE, 1, FLAGS_l, "input_ids_0", "input_mask_0",
+                                                           "segment_ids_0");
+    std::vector<MatMap> items;
+    std::string line;
+    while (std::getline(in, line)) {
+        if (!line.empty() && tokenizer.BuildBatchInput({line}, {""}, input) == TNN_OK) {
+            items.push_back(BuildItem(input));
+        }
+    }
+    if (items.empty()) {
+        fprintf(stderr, "%s has no text\n", FLAGS_i.c_str());
+        return -1;
+    }
+
+    ModelConfig model_config;
+    model_config.model_type = MODEL_TYPE_TNN;
+    model_config.params     = {fdLoadFile(FLAGS_p.c_str()), fdLoadFile(FLAGS_m.c_str())};
+    auto net                = std::make_shared<TNN>();
+    status                  = net->Init(model_config);
+    if (status != TNN_OK) {
+        fprintf(stderr, "model init failed: %s\n", status.description().c_str());
+        return -1;
+    }
+    NetworkConfig config;
+    config.device_type = DEVICE_X86;
+
+    LengthBatcherOption option;
+    option.max_length                      = FLAGS_l;
+    option.max_batch                       = FLAGS_b;
+    option.output_length_axis["unstack:0"] = 1;
+    option.output_length_axis["unstack:1"] = 1;
+    option.bucket_edges                    = {FLAGS_l};
+    if (RunBatcher("padded", net, config, option, items) != 0) {
+        return -1;
+    }
+    option.bucket_edges       = {};
+    option.learn_bucket_count = FLAGS_k;
+    option.learn_after        = (int)items.size();
+    return RunBatcher("bucketed", net, config, option, items);
+}
@@ -0,0 +1,112 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+#include "tnn/core/instance.h"
+#include "tnn/core/tnn.h"
+#include "tnn_metrics_exporter.h"
+#include "utils/utils.h"
+
+#include "../flags.h"
+
+using namespace TNN_NS;
+
+static const char output_path_message[] = "(optional) metrics file path. Default is: tnn_metrics.prom";
+DEFINE_string(o, "tnn_metrics.prom", output_path_message);
+static const char iterations_message[] = "(optional) number of forwards. Default is: 100";
+DEFINE_int32(n, 100, iterations_message);
+static const char export_interval_message[] = "(optional) forwards between two exports. Default is: 10";
+DEFINE_int32(e, 10, export_interval_message);
+
+int main(int argc, char** argv) {
+    if (!ParseAndCheckCommandLine(argc, argv, false)) {
+        ShowUsage(argv[0], false);
+        printf("\t-o, <output>   \t%s\n", output_path_message);
+        printf("\t-n, <count>    \t%s\n", iterations_message);
+        printf("\t-e, <interval> \t%s\n", export_interval_message);
+        return -1;
+    }
+
+    ModelConfig model_config;
+    model_config.model_type = MODEL_TYPE_TNN;
+    model_config.params     = {fdLoadFile(FLAGS_p.c_str()), fdLoadFile(FLAGS_m.c_str())};
+
+    TNN net;
+    auto status = net.Init(model_config);
+    if (status != TNN_OK) {
+        fprintf(stderr, "TNN init failed: %s\n", status.description().c_str());
+        return -1;
+    }
+
+    NetworkConfig network_config;
+    network_config.device_type = DEVICE_X86;
+    auto instance              = net.CreateInst(network_config, status);
+    if (status != TNN_OK || !instance) {
+        fprintf(stderr, "TNN create instance failed: %s\n", status.description().c_str());
+        return -1;
+    }
+
+    BlobMap input_blobs;
+    instance->GetAllInputBlobs(input_blobs);
+    std::vector<std::shared_ptr<Mat>> input_mats;
+    for (auto iter : input_blobs) {
+        auto dims = iter.second->GetBlobDesc().dims;
+        auto mat  = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, dims);
+        int count = 1;
+        for (auto dim : dims) {
+            count *= dim;
+        }
+        auto data = static_cast<float*>(mat->GetData());
+        for (int i = 0; i < count; i++) {
+            data[i] = std::sin(0.01f * i);
+        }
+        input_mats.push_back(mat);
+    }
+
+    TNNMetricsExporter exporter("tnn", {{"device", "x86"}});
+    for (int i = 0; i < FLAGS_n; i++) {
+        int index = 0;
+        for (auto iter : input_blobs) {
+            instance->SetInputMat(input_mats[index++], MatConvertParam(), iter.first);
+        }
+        status = instance->Forward();
+        if (status != TNN_OK) {
+            fprintf(stderr, "TNN forward failed: %s\n", status.description().c_str());
+            return -1;
+        }
+        std::shared_ptr<Mat> output_mat = nullptr;
+        instance->GetOutputMat(output_mat, MatConvertParam(), "", DEVICE_NAIVE);
+
+        // a scraper reads the file between exports, so write it regularly rather than only at exit
+        if ((i + 1) % FLAGS_e == 0 || i + 1 == FLAGS_n) {
+            InstanceMetrics metrics;
+            instance->GetMetrics(metrics);
+            status = exporter.WriteToFile(metrics, FLAGS_o);
+            if (status != TNN_OK) {
+                fprintf(stderr, "write %s failed: %s\n", FLAGS_o.c_str(), status.description().c_str());
+                return -1;
+            }
+        }
+    }
+
+    InstanceMetrics metrics;
+    instance->GetMetrics(metrics);
+    printf("%s", exporter.Format(metrics).c_str());
+    printf("metrics written to %s\n", FLAGS_o.c_str());
+    return 0;
+}
@@ -77,11 +77,14 @@ Status initOCRDetector(std::shared_ptr<OCRDriver> &predictor, DimsVector &target
     protoContent = fdLoadFile(modelPath + "angle_net.tnnproto");
     modelContent = fdLoadFile(modelPath + "angle_net.tnnmodel");
     {
-        auto option = std::make_shared<TNNSDKOption>();
+        auto option = std::make_shared<OCRAnglePredictorOption>();
         option->compute_units = compute_units;
         option->library_path = "";
         option->proto_content = protoContent;
         option->model_content = modelContent;
+        #ifndef _CUDA_
+            option->max_batch = 16;
+        #endif
         auto status = gOCRAnglePredictor->Init(option);
         if (status != TNN_OK) {
             LOGE("ocr angle predictor init failed %d",(int)status);
@@ -89,23 +92,35 @@ Status initOCRDetector(std::shared_ptr<OCRDriver> &predictor, DimsVector &target
         }
     }
 
+    // text recognizers, each one runs a batch of boxes with similar width on its own thread
     protoContent = fdLoadFile(modelPath + "crnn_lite_lstm.tnnproto");
     modelContent = fdLoadFile(modelPath + "crnn_lite_lstm.tnnmodel");
-    {
+    std::vector<std::shared_ptr<TNNSDKSample>> sdks = {gOCRTextBoxDetector, gOCRAnglePredictor};
+    #ifdef _CUDA_
+        const int recognizer_count = 1;
+    #else
+        const int recognizer_count = 2;
+    #endif
+    for (int i = 0; i < recognizer_count; ++i) {
+        auto recognizer = i == 0 ? gOCRTextRecognizer : std::make_shared<OCRTextRecognizer>();
         auto option = std::make_shared<OCRTextRecognizerOption>();
         option->compute_units = compute_units;
         option->library_path = "";
         option->vocab_path = modelPath + "keys.txt";
         option->proto_content = protoContent;
         option->model_content = modelContent;
-        auto status = gOCRTextRecognizer->Init(option);
+        #ifndef _CUDA_
+            option->max_batch = 4;
+        #endif
+        auto status = recognizer->Init(option);
         if (status != TNN_OK) {
             LOGE("ocr text recognizer init failed %d", (int)status);
             return -1;
         }
+        sdks.push_back(recognizer);
     }
 
-    auto status = predictor->Init({gOCRTextBoxDetector, gOCRAnglePredictor, gOCRTextRecognizer});
+    auto status = predictor->Init(sdks);
     if (status != TNN_OK) {
         LOGE("ocr detector init failed %d", (int)status);
         return -1;
@@ -190,7 +205,23 @@ int main(int argc, char **argv) {
         auto image_mat = std::make_shared<TNN_NS::Mat>(DEVICE_NAIVE, TNN_NS::N8UC4, nchw, data);
         auto resized_mat = std::make_shared<TNN_NS::Mat>(DEVICE_NAIVE, TNN_NS::N8UC3, target_dims);
         predictor->Resize(image_mat, image_mat, TNNInterpLinear);
+        auto print_timing = [&](const char *mode) {
+            auto timing = predictor->GetLastTiming();
+            printf("%s: boxes %d, detect %.2f ms, angle %.2f ms, recognize %.2f ms, total %.2f ms\n", mode,
+                   timing.box_count, timing.detect_ms, timing.angle_ms, timing.recognize_ms, timing.total_ms);
+        };
+        if (detect_type == 1) {
+            // box by box run of the same page to compare the page latency with
+            predictor->SetSequential(true);
+            if (predictor->Predict(std::make_shared<TNNSDKInput>(image_mat), skd_output) == TNN_OK) {
+                print_timing("box by box");
+            }
+            predictor->SetSequential(false);
+        }
         auto status = predictor->Predict(std::make_shared<TNNSDKInput>(image_mat), skd_output);
+        if (status == TNN_OK && detect_type == 1) {
+            print_timing("batched");
+        }
         if (status != TNN_OK) 
             if (detect_type == 1) break;
             else {
@@ -16,6 +16,7 @@
 #define TNN_INCLUDE_TNN_CORE_COMMON_H_
 
 #include <functional>
+#include <set>
 #include <string>
 #include <vector>
 
@@ -166,7 +167,24 @@ struct PUBLIC NetworkConfig {
 
     // network init or reshape may cost more time to select opt kernel implement if enable tune kernel
     // cache_path can set to store tune kernel info.
+    // on x86, conv, inner product and matmul kernels are timed in Init and the winners are saved in cache_path.
     bool enable_tune_kernel = false;
+
+    // numa node the instance is bound to on linux, -1 means no binding.
+    // weights, blobs and workspace are allocated on the node, and on x86 the forward runs on its cpus. the calling
+    // thread gets its previous affinity back after each forward, its omp workers stay bound until another node is used.
+    int numa_node = -1;
+
+    // copy the weights shared with other instances of the same model to numa_node instead of reading them remotely
+    bool numa_replicate_weights = false;
+
+    // fuse a depthwise conv and the pointwise conv reading it into one layer on x86. it is only faster for some
+    // shapes and the depthwise output blob is no longer available to model check or blob dump.
+    bool enable_fuse_dw_pw_conv = false;
+
+    // input and output blobs bound to caller memory with Instance::BindInputMat or BindOutputMat on cpu.
+    // they get no forward memory of their own and must be bound before Forward.
+    std::set<std::string> external_memory_blobs = {};
 };
 
 struct PUBLIC ModelConfig {
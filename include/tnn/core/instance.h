@@ -21,6 +21,7 @@
 
 #include "tnn/core/blob.h"
 #include "tnn/core/common.h"
+#include "tnn/core/instance_metrics.h"
 #include "tnn/core/macro.h"
 #include "tnn/core/status.h"
 #include "tnn/utils/blob_converter.h"
@@ -32,6 +33,8 @@ namespace TNN_NS {
 
 class AbstractNetwork;
 class AbstractModelInterpreter;
+class AsyncForwardExecutor;
+struct InstanceMetricsRecorder;
 
 struct LayerInfo;
 
@@ -89,6 +92,12 @@ public:
 
     // tnn instance network infer async.
     // device gpu, all layer infer complete will call Callback.
+    // device cpu (naive, x86, arm), a non-null Callback runs the forward on an internal worker thread
+    // and returns at once, Callback is invoked on that thread when the outputs are ready. only one
+    // forward is in flight: the next ForwardAsync, Forward, Reshape or GetOutputMat waits for it and
+    // its Callback. SetInputMat during the forward stages the input for the next one, and
+    // GetCompletedOutputMat reads the outputs of the last finished forward. a null Callback infers
+    // synchronously.
     Status ForwardAsync(Callback call_back);
 
     // get all input blobs
@@ -100,6 +109,12 @@ public:
     // set threads run on cpu
     Status SetCpuNumThreads(int num_threads);
 
+    // snapshot of the always-on counters and latency histograms, safe to call while a forward runs
+    Status GetMetrics(InstanceMetrics& metrics);
+
+    // reset the counters and histograms, gauges such as memory sizes keep their values
+    Status ResetMetrics();
+
 #if TNN_PROFILE
 public:
     /**start to profile each layer, dont call this func if you only want to profile the whole mode*/
@@ -129,8 +144,35 @@ public:
                         MatConvertParam param = MatConvertParam(),
                         std::string output_name = "",
                         DeviceType device = DEVICE_ARM, MatType mat_type = NCHW_FLOAT);
+
+    // get output Mat of the last finished cpu ForwardAsync without waiting for the running one,
+    // a new Mat is returned on every call. if output_name is not set, take the first output as default
+    Status GetCompletedOutputMat(std::shared_ptr<Mat>& mat,
+                                 MatConvertParam param = MatConvertParam(),
+                                 std::string output_name = "",
+                                 DeviceType device = DEVICE_ARM, MatType mat_type = NCHW_FLOAT);
+    
+    // bind the memory of mat to the input blob on cpu devices, Forward reads it in place without conversion.
+    // mat must have the dims of the blob and the type of its data: NCHW_FLOAT for float, NC_INT32 for int32,
+    // RESERVED_INT8_TEST for int8, and the blob must be nchw. the binding has to be renewed after Reshape.
+    // list the blob in NetworkConfig::external_memory_blobs to leave it out of the forward memory.
+    // if input_name is not set, take the first input as default
+    Status BindInputMat(std::shared_ptr<Mat> mat, std::string input_name = "");
+
+    // bind the memory of mat to the output blob on cpu devices, Forward writes it in place.
+    // the requirements are those of BindInputMat. if output_name is not set, take the first output as default
+    Status BindOutputMat(std::shared_ptr<Mat> mat, std::string output_name = "");
+
+    // release the mat bound to the input or output blob named blob_name, the blob gets its forward memory back.
+    // blobs in NetworkConfig::external_memory_blobs have none and must be bound again before Forward
+    Status UnbindMat(std::string blob_name);
     
 private:
+    // wait for the forward running on the async executor
+    Status WaitAsyncForward();
+
+    // bind mat to the blob named name of blobs
+    Status BindMat(std::shared_ptr<Mat> mat, BlobMap &blobs, std::string name);
     // input converter
     std::map<std::string, std::shared_ptr<BlobConverter>> input_converters_ = {};
 
@@ -141,6 +183,16 @@ private:
     std::map<std::string, std::shared_ptr<Mat>> output_mats_ = {};
     // output mat convert status
     std::map<std::string, int> output_mats_convert_status_ = {};
+    // default network on a cpu device, it supports the async executor and external blob memory
+    bool cpu_default_network_ = false;
+    // cpu networks run ForwardAsync on an executor with double buffered inputs and outputs
+    std::shared_ptr<AsyncForwardExecutor> async_forward_ = nullptr;
+    // converters of the staged input blobs of async_forward_
+    std::map<std::string, std::shared_ptr<BlobConverter>> staged_input_converters_ = {};
+    // mats bound as blob memory, held until they are replaced or the instance is released
+    std::map<std::string, std::shared_ptr<Mat>> bound_mats_ = {};
+    // counters and histograms reported by GetMetrics
+    std::shared_ptr<InstanceMetricsRecorder> metrics_ = nullptr;
 };
 
 }  // namespace TNN_NS
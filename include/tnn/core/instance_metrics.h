@@ -0,0 +1,74 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_INCLUDE_TNN_CORE_INSTANCE_METRICS_H_
+#define TNN_INCLUDE_TNN_CORE_INSTANCE_METRICS_H_
+
+#include <cstdint>
+
+#include "tnn/core/macro.h"
+
+namespace TNN_NS {
+
+// @brief latency histogram with fixed bucket bounds, the same for all histograms
+struct PUBLIC LatencyHistogram {
+    // number of buckets, the last one has no upper bound
+    static const int kBucketCount = 15;
+
+    // @brief upper bound of bucket index in microseconds, the last bucket returns -1
+    static double GetBucketBoundUs(int index);
+
+    // samples per bucket, not cumulative
+    uint64_t buckets[kBucketCount] = {0};
+    // number of samples
+    uint64_t count = 0;
+    // sum of the samples in microseconds
+    double sum_us = 0;
+};
+
+// @brief snapshot of the counters of an instance, counts are since init or the last ResetMetrics
+struct PUBLIC InstanceMetrics {
+    // forwards started with Forward, ForwardAsync or ForwardWithCallback
+    uint64_t forward_count = 0;
+    // forwards that returned an error
+    uint64_t forward_error_count = 0;
+    // calls of Reshape
+    uint64_t reshape_count = 0;
+
+    // bytes of the blob memory planned for forward
+    int64_t forward_memory_bytes = 0;
+    // bytes per forward that layers do not copy because their blobs share memory
+    int64_t aliased_copy_bytes = 0;
+    // bytes of the shared workspace held by the device context
+    int64_t workspace_bytes = 0;
+    // times the shared workspace grew
+    uint64_t workspace_grow_count = 0;
+
+    // forwards of layers that fell back to another device through a cpu adapter
+    uint64_t adapter_fallback_count = 0;
+    // bytes written by reformat layers
+    uint64_t reformat_bytes = 0;
+
+    // SetInputMat
+    LatencyHistogram convert_in_latency;
+    // network forward
+    LatencyHistogram forward_latency;
+    // GetOutputMat and GetCompletedOutputMat
+    LatencyHistogram convert_out_latency;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_INCLUDE_TNN_CORE_INSTANCE_METRICS_H_
@@ -42,6 +42,17 @@ public:
     // @brief set x86 cpu denormal ftz and daz, no use for other cpu.
     // @param denormal 0:turn off denormal 1:turn on denormal
     PUBLIC static void SetCpuDenormal(int denormal);
+
+    // @brief get the number of numa nodes, 1 if numa is not supported
+    PUBLIC static int GetNumaNodeCount();
+
+    // @brief get cpuids of a numa node
+    // @param node numa node id, from 0 to GetNumaNodeCount() - 1
+    PUBLIC static Status GetNumaNodeCpus(int node, std::vector<int>& cpu_list);
+
+    // @brief set numa memory policy of the calling thread, only for linux
+    // @param interleave true:interleave pages over all nodes false:allocate on the local node
+    PUBLIC static Status SetNumaInterleave(bool interleave);
 };
 
 }  // namespace TNN_NS
@@ -164,6 +164,7 @@ pack_tnn() {
     cp -RP ${TNN_ROOT_PATH}/include ${TNN_INSTALL_DIR}/
     cp -P libTNN.so* ${TNN_INSTALL_DIR}/lib
     cp test/TNNTest ${TNN_INSTALL_DIR}/bin
+    cp test/benchmark/TNNBenchmark ${TNN_INSTALL_DIR}/bin
 }
 
 # building procedure of TNN X86
@@ -33,6 +33,19 @@ Status AbstractNetwork::SetCpuNumThreads(int num_threads) {
     return TNN_OK;
 }
 
+Status AbstractNetwork::GetMetrics(InstanceMetrics &metrics) {
+    return TNN_OK;
+}
+
+Status AbstractNetwork::ResetMetrics() {
+    return TNN_OK;
+}
+
+Status AbstractNetwork::BindExternalBlob(std::string name, void *data) {
+    LOGE("Subclass of AbstractNetwork must implement this func BindExternalBlob\n");
+    return Status(TNNERR_COMMON_ERROR, "Subclass of AbstractNetwork must implement this func BindExternalBlob");
+}
+
 #if TNN_PROFILE
 void AbstractNetwork::StartProfile() {
     LOGI("warning: to make profiling work, subclass should implement the func: StartProfile\n");
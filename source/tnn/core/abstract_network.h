@@ -93,6 +93,17 @@ public:
     // @brief set threads run on device
     virtual Status SetCpuNumThreads(int num_threads);
 
+    // @brief bind caller owned memory to an input or output blob
+    // @param name input or output blob name
+    // @param data caller memory with the size and layout of the blob, nullptr to unbind
+    virtual Status BindExternalBlob(std::string name, void *data);
+
+    // @brief fill the network and device counters of metrics, the instance ones are left untouched
+    virtual Status GetMetrics(InstanceMetrics &metrics);
+
+    // @brief reset the network and device counters
+    virtual Status ResetMetrics();
+
 #if TNN_PROFILE
 public:
     virtual void StartProfile();
@@ -0,0 +1,222 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/core/async_forward_executor.h"
+
+#include <cstring>
+
+#include "tnn/core/abstract_device.h"
+#include "tnn/core/macro.h"
+#include "tnn/memory_manager/blob_memory_size_info.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+static Status CopyBlobData(Blob *dst, Blob *src) {
+    auto device = GetDevice(src->GetBlobDesc().device_type);
+    RETURN_VALUE_ON_NEQ(device != NULL, true, TNNERR_DEVICE_NOT_SUPPORT);
+
+    BlobMemorySizeInfo size_info = device->Calculate(src->GetBlobDesc());
+    auto bytes                   = GetBlobMemoryBytesSize(size_info);
+    auto src_handle              = src->GetHandle();
+    auto dst_handle              = dst->GetHandle();
+    if (!src_handle.base || !dst_handle.base) {
+        return Status(TNNERR_NULL_PARAM, "blob handle is nil");
+    }
+    memcpy(reinterpret_cast<char *>(dst_handle.base) + dst_handle.bytes_offset,
+           reinterpret_cast<char *>(src_handle.base) + src_handle.bytes_offset, bytes);
+    return TNN_OK;
+}
+
+// the copy keeps the desc of src and owns its memory, it is reallocated when the dims change
+static Status CloneBlob(std::shared_ptr<Blob> &dst, Blob *src) {
+    if (!dst || !DimsVectorUtils::Equal(dst->GetBlobDesc().dims, src->GetBlobDesc().dims) ||
+        dst->GetBlobDesc().data_type != src->GetBlobDesc().data_type) {
+        dst = std::make_shared<Blob>(src->GetBlobDesc(), true);
+    }
+    return CopyBlobData(dst.get(), src);
+}
+
+AsyncForwardExecutor::AsyncForwardExecutor(AbstractNetwork *network, InstanceMetricsRecorder *metrics)
+    : network_(network), metrics_(metrics) {
+    worker_ = std::thread(&AsyncForwardExecutor::WorkerLoop, this);
+}
+
+AsyncForwardExecutor::~AsyncForwardExecutor() {
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [this] { return IsIdle(); });
+        stop_ = true;
+    }
+    cond_.notify_all();
+    if (worker_.joinable()) {
+        worker_.join();
+    }
+}
+
+void AsyncForwardExecutor::WorkerLoop() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (true) {
+        cond_.wait(lock, [this] { return stop_ || running_; });
+        if (stop_) {
+            return;
+        }
+        auto call_back = call_back_;
+        lock.unlock();
+
+        auto begin    = std::chrono::steady_clock::now();
+        Status status = network_->Forward();
+        if (metrics_) {
+            metrics_->AddForward(std::chrono::steady_clock::now() - begin, status == TNN_OK);
+        }
+        if (status == TNN_OK) {
+            status = SaveOutputs();
+        }
+
+        lock.lock();
+        status_       = status;
+        finished_     = true;
+        running_      = false;
+        calling_back_ = call_back != nullptr;
+        lock.unlock();
+        cond_.notify_all();
+
+        if (call_back) {
+            call_back();
+            lock.lock();
+            calling_back_ = false;
+            lock.unlock();
+            cond_.notify_all();
+        }
+        lock.lock();
+    }
+}
+
+// must hold mutex_. waiting callers also wait for the callback, so state it captured outlives it,
+// except a callback that chains the next forward from the worker itself
+bool AsyncForwardExecutor::IsIdle() {
+    return !running_ && (!calling_back_ || std::this_thread::get_id() == worker_.get_id());
+}
+
+Status AsyncForwardExecutor::Run(Callback call_back) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return IsIdle(); });
+    Publish();
+    Status last_status = status_;
+
+    auto status = CopyStagedInputs();
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    call_back_ = call_back;
+    running_   = true;
+    lock.unlock();
+    cond_.notify_all();
+    return last_status;
+}
+
+Status AsyncForwardExecutor::Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return IsIdle(); });
+    Publish();
+    return status_;
+}
+
+Status AsyncForwardExecutor::Sync() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cond_.wait(lock, [this] { return IsIdle(); });
+    Publish();
+    return CopyStagedInputs();
+}
+
+Status AsyncForwardExecutor::ConvertInput(const std::string &name, Blob *network_blob,
+                                          std::function<Status(Blob *)> convert) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (!running_ && !calling_back_) {
+        // written in place, an older staged copy must not overwrite it at the next launch
+        dirty_inputs_.erase(name);
+        return convert(network_blob);
+    }
+
+    auto &staged = staged_inputs_[name];
+    if (!staged || !DimsVectorUtils::Equal(staged->GetBlobDesc().dims, network_blob->GetBlobDesc().dims) ||
+        staged->GetBlobDesc().data_type != network_blob->GetBlobDesc().data_type) {
+        staged = std::make_shared<Blob>(network_blob->GetBlobDesc(), true);
+    }
+    auto status = convert(staged.get());
+    // only a complete input is copied at the next launch
+    if (status == TNN_OK) {
+        dirty_inputs_.insert(name);
+    }
+    return status;
+}
+
+Status AsyncForwardExecutor::ConvertCompletedOutput(const std::string &name, std::function<Status(Blob *)> convert) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    Publish();
+    auto iter = front_outputs_.find(name);
+    if (iter == front_outputs_.end()) {
+        LOGE("AsyncForwardExecutor dont have the completed output with name: %s\n", name.c_str());
+        return Status(TNNERR_INST_ERR, "instance dont have the completed output with name");
+    }
+    return convert(iter->second.get());
+}
+
+// must hold mutex_. the worker only writes back_outputs_ while running_, so the swap is safe here
+void AsyncForwardExecutor::Publish() {
+    if (finished_) {
+        if (status_ == TNN_OK) {
+            front_outputs_.swap(back_outputs_);
+        }
+        finished_ = false;
+    }
+}
+
+// must hold mutex_ with the worker idle
+Status AsyncForwardExecutor::CopyStagedInputs() {
+    if (dirty_inputs_.empty()) {
+        return TNN_OK;
+    }
+
+    BlobMap input_blobs;
+    auto status = network_->GetAllInputBlobs(input_blobs);
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    for (const auto &name : dirty_inputs_) {
+        auto iter = input_blobs.find(name);
+        if (iter == input_blobs.end()) {
+            LOGE("AsyncForwardExecutor dont have the input with name: %s\n", name.c_str());
+            return Status(TNNERR_MODEL_ERR, "instance dont have the input with name");
+        }
+        status = CopyBlobData(iter->second, staged_inputs_[name].get());
+        RETURN_ON_NEQ(status, TNN_OK);
+    }
+    dirty_inputs_.clear();
+    return TNN_OK;
+}
+
+// runs on the worker thread
+Status AsyncForwardExecutor::SaveOutputs() {
+    BlobMap output_blobs;
+    auto status = network_->GetAllOutputBlobs(output_blobs);
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    for (auto iter : output_blobs) {
+        status = CloneBlob(back_outputs_[iter.first], iter.second);
+        RETURN_ON_NEQ(status, TNN_OK);
+    }
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
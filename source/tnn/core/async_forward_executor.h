@@ -0,0 +1,104 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_CORE_ASYNC_FORWARD_EXECUTOR_H_
+#define TNN_SOURCE_TNN_CORE_ASYNC_FORWARD_EXECUTOR_H_
+
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+#include "tnn/core/abstract_network.h"
+#include "tnn/core/blob.h"
+#include "tnn/core/common.h"
+#include "tnn/core/metrics_recorder.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+// @brief runs the forwards of a cpu network on its own worker thread, one at a time.
+// inputs written while a forward runs go to staging blobs and are copied into the network
+// before the next forward starts. outputs are copied into a back buffer when a forward ends
+// and become readable once published, so the outputs of frame n can be converted while
+// frame n+1 runs. all methods except the worker loop are called from the instance thread,
+// or from a callback on the worker that chains the next forward.
+class AsyncForwardExecutor {
+public:
+    // @param metrics receives the latency of each forward, may be nullptr
+    AsyncForwardExecutor(AbstractNetwork *network, InstanceMetricsRecorder *metrics);
+    ~AsyncForwardExecutor();
+
+    // @brief wait for the running forward and its callback, publish its outputs, copy the staged
+    // inputs into the network and start the next forward. call_back is invoked on the worker thread after the
+    // outputs of this forward are saved.
+    // @return the status of the previous forward, or the error that prevented starting this one
+    Status Run(Callback call_back);
+
+    // @brief wait for the running forward and its callback, and publish its outputs
+    // @return the status of the last forward
+    Status Wait();
+
+    // @brief wait for the running forward and copy the staged inputs into the network,
+    // so that the network can be used synchronously
+    Status Sync();
+
+    // @brief run convert on the blob that input name should be written to: a staging blob while a forward runs,
+    // the network blob otherwise. the executor stays locked until it returns, so a forward chained from a callback
+    // copies a staged input only once it is complete. staging blobs stay valid until the executor is destroyed,
+    // or until a reshape changes the dims of network_blob.
+    Status ConvertInput(const std::string &name, Blob *network_blob, std::function<Status(Blob *)> convert);
+
+    // @brief run convert on output name of the last finished forward. the outputs stay locked until it returns,
+    // so a forward chained from a callback cannot publish over them meanwhile
+    // @return TNNERR_INST_ERR if no forward has finished yet or it has no such output, the status of convert otherwise
+    Status ConvertCompletedOutput(const std::string &name, std::function<Status(Blob *)> convert);
+
+private:
+    void WorkerLoop();
+    bool IsIdle();
+    void Publish();
+    Status CopyStagedInputs();
+    Status SaveOutputs();
+
+    AbstractNetwork *network_ = nullptr;
+    InstanceMetricsRecorder *metrics_ = nullptr;
+
+    std::thread worker_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_     = false;
+    // a forward is queued or running on the worker
+    bool running_  = false;
+    // a forward finished and its outputs in back_outputs_ are not published yet
+    bool finished_ = false;
+    // the worker is running the callback of the last forward
+    bool calling_back_ = false;
+    Status status_ = TNN_OK;
+    Callback call_back_ = nullptr;
+
+    std::map<std::string, std::shared_ptr<Blob>> staged_inputs_;
+    std::set<std::string> dirty_inputs_;
+    std::map<std::string, std::shared_ptr<Blob>> front_outputs_;
+    std::map<std::string, std::shared_ptr<Blob>> back_outputs_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_CORE_ASYNC_FORWARD_EXECUTOR_H_
@@ -18,6 +18,7 @@
 #include <cstring>
 #include <set>
 
+#include "tnn/interpreter/layer_param.h"
 #include "tnn/memory_manager/blob_memory_pool_factory.h"
 #include "tnn/memory_manager/blob_memory_size_info.h"
 #include "tnn/memory_manager/memory_mode_state_factory.h"
@@ -25,6 +26,7 @@
 #include "tnn/memory_manager/memory_unify_assign_strategy.h"
 #include "tnn/utils/dims_utils.h"
 #include "tnn/utils/data_flag_utils.h"
+#include "tnn/utils/numa_utils.h"
 
 namespace TNN_NS {
 
@@ -144,6 +146,16 @@ Status BlobManager::Init(NetworkConfig &config, NetStructure *net_structure, Inp
         output_blobs_[name] = blob;
     }
 
+    external_blobs_.clear();
+    bound_blob_dims_.clear();
+    for (auto name : config.external_memory_blobs) {
+        if (input_blobs_.count(name) == 0 && output_blobs_.count(name) == 0) {
+            LOGE("external memory blob %s is not an input or output blob\n", name.c_str());
+            return Status(TNNERR_PARAM_ERR, "external memory blob is not an input or output blob");
+        }
+        external_blobs_.insert(name);
+    }
+
     return TNN_OK;
 }
 
@@ -156,10 +168,12 @@ Status BlobManager::Init(NetworkConfig &config, NetStructure *net_structure, Inp
 Status BlobManager::AllocateBlobMemory(int flag) {
     const auto &input_shapes_map = net_structure_->inputs_shape_map;
 
+    PlanBlobAlias(flag);
+
     for (auto iter : input_shapes_map) {
         std::string current_blob_name = iter.first;
         Blob *current_blob            = blobs_[current_blob_name];
-        if (current_blob->NeedAllocateInForward() ||
+        if (current_blob->NeedAllocateInForward() || external_blobs_.count(current_blob_name) > 0 ||
             DataFlagUtils::ChangeStatus(current_blob->GetFlag()) != DataFlagUtils::ChangeStatus(flag)) {
             continue;
         }
@@ -183,7 +197,7 @@ Status BlobManager::AllocateBlobMemory(int flag) {
         // allocating blob memory for every out nodes of this layer
         for (auto current_blob_name : layer_info->outputs) {
             Blob *current_blob = blobs_[current_blob_name];
-            if (current_blob->NeedAllocateInForward() ||
+            if (current_blob->NeedAllocateInForward() || external_blobs_.count(current_blob_name) > 0 ||
                 DataFlagUtils::ChangeStatus(current_blob->GetFlag()) != DataFlagUtils::ChangeStatus(flag)) {
                 continue;
             }
@@ -194,6 +208,12 @@ Status BlobManager::AllocateBlobMemory(int flag) {
                 return Status(TNNERR_LAYER_ERR, "blob dims is invaid");
             }
 
+            if (blob_alias_.count(current_blob_name) > 0 || blob_alias_roots_.count(current_blob_name) > 0) {
+                Status status = AllocateAliasBlobMemory((int)layer_index, current_blob_name);
+                RETURN_ON_NEQ(status, TNN_OK);
+                continue;
+            }
+
             if (blob_memory_mapping_.find(current_blob) == blob_memory_mapping_.end()) {
                 // calculate the use count of this blob
                 int use_count = GetBlobUseCount(layer_index, current_blob_name);
@@ -208,7 +228,7 @@ Status BlobManager::AllocateBlobMemory(int flag) {
         // refund the input blob memory
         for (auto current_blob_name : layer_info->inputs) {
             Blob *current_blob = blobs_[current_blob_name];
-            if (current_blob->NeedAllocateInForward() ||
+            if (current_blob->NeedAllocateInForward() || external_blobs_.count(current_blob_name) > 0 ||
                 DataFlagUtils::ChangeStatus(current_blob->GetFlag()) != DataFlagUtils::ChangeStatus(flag)) {
                 continue;
             }
@@ -238,6 +258,7 @@ Status BlobManager::AllocateBlobMemory(int flag) {
             }
             BREAK_IF(status != TNN_OK);
             BindBlobMemory();
+            BindBlobMemoryToNumaNode();
         } else if (config_.share_memory_mode == SHARE_MEMORY_MODE_SHARE_ONE_THREAD) {
             // The share_on_thread strategy may share memory of different models-
             // within the same thread.
@@ -254,12 +275,214 @@ Status BlobManager::AllocateBlobMemory(int flag) {
             }
             BREAK_IF(status != TNN_OK);
             BindBlobMemory();
+            BindBlobMemoryToNumaNode();
         }
     } while (0);
 
     return status;
 }
 
+/*
+ * x86 blobs are plain buffers without padding, so some layers only need to move bytes around:
+ *  - the output of a view layer (reshape, flatten, squeeze, unsqueeze) shares the memory of its input.
+ *  - the inputs of a concat along a leading axis are written in place into the concat output.
+ *  - the outputs of a splitv along a leading axis point into the split input.
+ * The layer accs skip the copy when the pointers already match. Offsets are fixed at the init dims, the accs
+ * fall back to moving the data in place when a reshape makes the blobs smaller. That move overwrites the concat
+ * inputs and the split input, so those are only aliased when the concat or split is their sole reader, for a
+ * split input that is a view also of the blobs it is a view of.
+ */
+void BlobManager::PlanBlobAlias(int flag) {
+    if (device_->GetDeviceType() != DEVICE_X86) {
+        return;
+    }
+
+    auto can_alias = [&](const std::string &name) -> bool {
+        auto iter = blobs_.find(name);
+        if (iter == blobs_.end() || iter->second == nullptr) {
+            return false;
+        }
+        Blob *blob = iter->second;
+        return !blob->NeedAllocateInForward() && external_blobs_.count(name) == 0 &&
+               DataFlagUtils::ChangeStatus(blob->GetFlag()) == DataFlagUtils::ChangeStatus(flag) &&
+               DimsVectorUtils::Count(blob->GetBlobDesc().dims) > 0;
+    };
+    auto bytes_of = [&](const std::string &name) -> int64_t {
+        BlobMemorySizeInfo info = device_->Calculate(blobs_[name]->GetBlobDesc());
+        return GetBlobMemoryBytesSize(info);
+    };
+    auto data_type_of = [&](const std::string &name) -> DataType {
+        return blobs_[name]->GetBlobDesc().data_type;
+    };
+    // slices along axis are contiguous only if all dims before axis are 1
+    auto leading_axis = [&](const std::string &name, int &axis) -> bool {
+        auto dims = blobs_[name]->GetBlobDesc().dims;
+        if (axis < 0) {
+            axis += (int)dims.size();
+        }
+        return axis >= 0 && axis < (int)dims.size() && DimsVectorUtils::Count(dims, 0, axis) == 1;
+    };
+    // blobs read only by the given layer, their memory may be clobbered by it
+    std::map<std::string, int> reader_count;
+    for (auto layer : net_structure_->layers) {
+        for (const auto &name : layer->inputs) {
+            reader_count[name]++;
+        }
+    }
+    auto sole_reader = [&](const std::string &name) -> bool {
+        return reader_count[name] == 1 && net_structure_->outputs.count(name) == 0;
+    };
+    // a blob may live in the memory of the blob it is a view of, so a layer clobbering it needs to be the sole
+    // reader of every blob up to the one owning the memory
+    auto sole_reader_of_memory = [&](std::string name) -> bool {
+        while (sole_reader(name) && input_blobs_.count(name) == 0) {
+            auto iter = blob_alias_.find(name);
+            if (iter == blob_alias_.end()) {
+                return true;
+            }
+            name = iter->second.first;
+        }
+        return false;
+    };
+    // aligned offsets keep the aligned simd loads of the accs valid
+    const int64_t offset_alignment = 32;
+
+    int view_count = 0, concat_count = 0, split_count = 0;
+    int64_t aliased_bytes = 0;
+    for (auto layer : net_structure_->layers) {
+        if (layer->inputs.empty() || layer->outputs.empty() || !can_alias(layer->inputs[0])) {
+            continue;
+        }
+        const auto &input = layer->inputs[0];
+
+        bool is_view = layer->type == LAYER_FLATTEN || layer->type == LAYER_SQUEEZE ||
+                       layer->type == LAYER_UNSQUEEZE;
+        if (layer->type == LAYER_RESHAPE) {
+            auto param = dynamic_cast<ReshapeLayerParam *>(layer->param.get());
+            is_view    = param && param->reshape_type == 0;
+        }
+
+        if (is_view) {
+            const auto &output = layer->outputs[0];
+            if (layer->inputs.size() != 1 || layer->outputs.size() != 1 || input == output ||
+                blob_alias_.count(output) > 0 || !can_alias(output) ||
+                data_type_of(input) != data_type_of(output) || bytes_of(input) != bytes_of(output)) {
+                continue;
+            }
+            blob_alias_[output] = std::make_pair(input, 0);
+            aliased_bytes += bytes_of(output);
+            view_count++;
+        } else if (layer->type == LAYER_CONCAT) {
+            auto param = dynamic_cast<ConcatLayerParam *>(layer->param.get());
+            const auto &output = layer->outputs[0];
+            int axis = param ? param->axis : -1;
+            if (!param || layer->outputs.size() != 1 || !can_alias(output) || blob_alias_.count(output) > 0 ||
+                data_type_of(output) != DATA_TYPE_FLOAT || !leading_axis(output, axis)) {
+                continue;
+            }
+            std::set<std::string> members;
+            std::vector<std::pair<std::string, int64_t>> offsets;
+            int64_t offset = 0;
+            for (const auto &name : layer->inputs) {
+                // a member must be produced by a layer into memory it owns
+                if (!can_alias(name) || !sole_reader(name) || members.count(name) > 0 || blob_alias_.count(name) > 0 ||
+                    input_blobs_.count(name) > 0 || data_type_of(name) != DATA_TYPE_FLOAT ||
+                    offset % offset_alignment != 0) {
+                    break;
+                }
+                members.insert(name);
+                offsets.push_back(std::make_pair(name, offset));
+                offset += bytes_of(name);
+            }
+            if (offsets.size() != layer->inputs.size() || offset != bytes_of(output)) {
+                continue;
+            }
+            for (const auto &iter : offsets) {
+                blob_alias_[iter.first] = std::make_pair(output, iter.second);
+            }
+            aliased_bytes += offset;
+            concat_count++;
+        } else if (layer->type == LAYER_SPLITV) {
+            auto param = dynamic_cast<SplitVLayerParam *>(layer->param.get());
+            int axis   = param ? param->axis : -1;
+            if (!param || layer->inputs.size() != 1 || !sole_reader_of_memory(input) ||
+                data_type_of(input) != DATA_TYPE_FLOAT || !leading_axis(input, axis)) {
+                continue;
+            }
+            std::vector<std::pair<std::string, int64_t>> offsets;
+            int64_t offset = 0;
+            for (const auto &name : layer->outputs) {
+                if (!can_alias(name) || name == input || blob_alias_.count(name) > 0 ||
+                    data_type_of(name) != DATA_TYPE_FLOAT || offset % offset_alignment != 0) {
+                    break;
+                }
+                offsets.push_back(std::make_pair(name, offset));
+                offset += bytes_of(name);
+            }
+            if (offsets.size() != layer->outputs.size() || offset != bytes_of(input)) {
+                continue;
+            }
+            for (const auto &iter : offsets) {
+                blob_alias_[iter.first] = std::make_pair(input, iter.second);
+            }
+            aliased_bytes += offset;
+            split_count++;
+        }
+    }
+
+    for (const auto &iter : blob_alias_) {
+        std::string root = iter.second.first;
+        while (blob_alias_.count(root) > 0) {
+            root = blob_alias_[root].first;
+        }
+        blob_alias_roots_.insert(root);
+    }
+
+    if (aliased_bytes > 0) {
+        aliased_bytes_ += aliased_bytes;
+        LOGI("blob memory aliasing removes %lld bytes of copies per forward, views: %d concats: %d splits: %d\n",
+             (long long)aliased_bytes, view_count, concat_count, split_count);
+    }
+}
+
+Status BlobManager::AllocateAliasBlobMemory(int layer_index, std::string current_blob_name) {
+    Blob *current_blob = blobs_[current_blob_name];
+    int use_count      = GetBlobUseCount(layer_index, current_blob_name);
+
+    // walk up to the blob that owns the memory
+    std::string root = current_blob_name;
+    int64_t offset   = 0;
+    while (blob_alias_.count(root) > 0) {
+        offset += blob_alias_[root].second;
+        root = blob_alias_[root].first;
+    }
+    Blob *root_blob = blobs_[root];
+
+    auto iter = blob_memory_mapping_.find(root_blob);
+    if (iter == blob_memory_mapping_.end()) {
+        // the first concat input is produced before the concat output, borrow the whole output now
+        BlobMemorySizeInfo info = device_->Calculate(root_blob->GetBlobDesc());
+        BlobMemory *blob_memory = blob_memory_pool_map_[info.dims.size()]->BorrowBlobMemory(0, info, false);
+        if (blob_memory == nullptr) {
+            return Status(TNNERR_COMMON_ERROR, "borrow blob memory failed");
+        }
+        iter = blob_memory_mapping_.insert(std::make_pair(root_blob, blob_memory)).first;
+    }
+
+    // the shared memory is refunded after the last use of any blob living in it
+    BlobMemory *blob_memory = iter->second;
+    blob_memory->SetUseCount(blob_memory->GetUseCount() + use_count);
+    if (current_blob != root_blob) {
+        blob_memory_mapping_[current_blob] = blob_memory;
+        blob_alias_offset_[current_blob]   = offset;
+    }
+    return TNN_OK;
+}
+
+int64_t BlobManager::GetAliasedBytes() {
+    return aliased_bytes_;
+}
+
 /*
  * This function calculate the use count of the given blob.
  * output layer is regarded as an additional reference.
@@ -330,7 +553,11 @@ void BlobManager::BindBlobMemory() {
     memory_mode_state_->SetMemoryAllocatedFlag();
     // bind every blob_memory's data_ into every blob's data
     for (auto iter : blob_memory_mapping_) {
-        iter.first->SetHandle(iter.second->GetHandle());
+        // blobs bound to caller memory keep it
+        if (bound_blob_dims_.count(iter.first->GetBlobDesc().name) > 0) {
+            continue;
+        }
+        iter.first->SetHandle(GetBlobMemoryHandle(iter.first, iter.second));
         // set blob data format to nchw when blob memory is 1d on opencl
         if (device_->GetDeviceType() == DEVICE_OPENCL &&
             iter.second->GetBlobMemorySizeInfo().dims.size() == 1) {
@@ -341,6 +568,42 @@ void BlobManager::BindBlobMemory() {
     }
 }
 
+// the blob memory may be allocated before the instance binds its thread, or shared with instances of other
+// nodes, so its pages are moved to the numa node of the instance once assigned
+void BlobManager::BindBlobMemoryToNumaNode() {
+    auto device_type = device_->GetDeviceType();
+    if (config_.numa_node < 0 ||
+        (device_type != DEVICE_X86 && device_type != DEVICE_ARM && device_type != DEVICE_NAIVE)) {
+        return;
+    }
+    std::set<BlobMemory *> bound_memory;
+    for (auto iter : blob_memory_mapping_) {
+        if (!bound_memory.insert(iter.second).second) {
+            continue;
+        }
+        auto handle    = iter.second->GetHandle();
+        auto size_info = iter.second->GetBlobMemorySizeInfo();
+        auto status    = NumaUtils::BindMemory(static_cast<char *>(handle.base) + handle.bytes_offset,
+                                               GetBlobMemoryBytesSize(size_info), config_.numa_node);
+        if (status != TNN_OK) {
+            LOGE("BlobManager: bind blob memory to numa node %d failed: %s\n", config_.numa_node,
+                 status.description().c_str());
+            return;
+        }
+    }
+}
+
+BlobHandle BlobManager::GetBlobMemoryHandle(Blob *blob, BlobMemory *memory) {
+    BlobHandle handle = memory->GetHandle();
+    auto alias_iter   = blob_alias_offset_.find(blob);
+    if (alias_iter != blob_alias_offset_.end() && alias_iter->second != 0) {
+        // fold the offset into base, accs reading handle.base directly see the right data
+        handle.base         = static_cast<char *>(handle.base) + handle.bytes_offset + alias_iter->second;
+        handle.bytes_offset = 0;
+    }
+    return handle;
+}
+
 int BlobManager::GetAllBlobMemorySize() {
     int mem_size_all_blob = 0;
     for (auto blob_memory_pool_iter : blob_memory_pool_map_) {
@@ -383,7 +646,45 @@ void BlobManager::ReplaceBlob(std::string name, Blob *new_blob) {
         output_blobs_[name] = new_blob;
 }
 
+Status BlobManager::BindExternalBlob(std::string name, void *data) {
+    if (input_blobs_.count(name) == 0 && output_blobs_.count(name) == 0) {
+        LOGE("blob %s is not an input or output blob\n", name.c_str());
+        return Status(TNNERR_PARAM_ERR, "only input and output blobs can be bound to external memory");
+    }
+    Blob *blob = blobs_[name];
+    if (blob->NeedAllocateInForward()) {
+        LOGE("blob %s is allocated in forward and can not be bound\n", name.c_str());
+        return Status(TNNERR_PARAM_ERR, "blob allocated in forward can not be bound to external memory");
+    }
+    if (!data) {
+        // external memory blobs have no forward memory to go back to, forward fails until they are bound again
+        bound_blob_dims_.erase(name);
+        auto iter = blob_memory_mapping_.find(blob);
+        blob->SetHandle(iter != blob_memory_mapping_.end() ? GetBlobMemoryHandle(blob, iter->second) : BlobHandle());
+        return TNN_OK;
+    }
+
+    BlobHandle handle;
+    handle.base = data;
+    blob->SetHandle(handle);
+    bound_blob_dims_[name] = blob->GetBlobDesc().dims;
+    return TNN_OK;
+}
+
 Status BlobManager::CheckBlobMemoryState() {
+    for (auto name : external_blobs_) {
+        if (bound_blob_dims_.count(name) == 0) {
+            LOGE("external memory blob %s is not bound\n", name.c_str());
+            return Status(TNNERR_NET_ERR, "external memory blob is not bound");
+        }
+    }
+    // a binding sized for other dims would be overrun, it has to be renewed after reshape
+    for (auto iter : bound_blob_dims_) {
+        if (!DimsVectorUtils::Equal(blobs_[iter.first]->GetBlobDesc().dims, iter.second)) {
+            LOGE("blob %s bound to external memory changed dims, bind it again\n", iter.first.c_str());
+            return Status(TNNERR_NET_ERR, "blob bound to external memory changed dims");
+        }
+    }
     return memory_mode_state_->GetStatus();
 }
 
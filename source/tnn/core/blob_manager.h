@@ -17,6 +17,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 #include <string>
 #include <thread>
 
@@ -79,9 +80,27 @@ public:
     // @brief replace blob with new_blob, and delete the original blob if exist
     void ReplaceBlob(std::string name, Blob *new_blob);
 
+    // @brief bind caller owned memory to an input or output blob, the binding is kept until the blob
+    // dims change. blobs in NetworkConfig::external_memory_blobs get no forward memory of their own.
+    // @param name input or output blob name
+    // @param data caller memory with the size and layout of the blob, nullptr gives the blob its forward
+    // memory back
+    Status BindExternalBlob(std::string name, void *data);
+
+    // @brief bytes that layers no longer copy in one forward because their blobs share memory
+    int64_t GetAliasedBytes();
+
 protected:
     void BindBlobMemory();
+    // move the pages of the blob memory to config_.numa_node on cpu devices
+    void BindBlobMemoryToNumaNode();
+    // handle of blob in memory, with the alias offset folded into base
+    BlobHandle GetBlobMemoryHandle(Blob *blob, BlobMemory *memory);
     int GetBlobUseCount(int layer_index, std::string current_blob_name);
+    // plan the blobs that live inside the memory of another blob
+    void PlanBlobAlias(int flag);
+    // borrow or reuse the memory of the blob the alias lives in
+    Status AllocateAliasBlobMemory(int layer_index, std::string current_blob_name);
 
     NetworkConfig config_;
     NetStructure *net_structure_;
@@ -94,6 +113,17 @@ protected:
     std::map<std::string, Blob *> blobs_;
     std::map<Blob *, BlobMemory *> blob_memory_mapping_;
     bool shared_memory_allocated_;
+    // blobs left out of the forward memory, they must be bound before forward
+    std::set<std::string> external_blobs_;
+    // dims of the blobs bound to caller memory when they were bound
+    std::map<std::string, DimsVector> bound_blob_dims_;
+    // blob name -> name of the blob whose memory it lives in and the byte offset there
+    std::map<std::string, std::pair<std::string, int64_t>> blob_alias_;
+    // byte offset of every aliased blob in its shared memory
+    std::map<Blob *, int64_t> blob_alias_offset_;
+    // blobs other blobs live in that do not live in another blob themselves
+    std::set<std::string> blob_alias_roots_;
+    int64_t aliased_bytes_ = 0;
 
     std::thread::id init_thread_id_;
     MemoryModeState *memory_mode_state_;
@@ -78,6 +78,18 @@ std::string Context::GetCacheFilePath() {
     return cache_file_path_;
 }
 
+void Context::SetNumaNode(int numa_node) {
+    numa_node_ = numa_node;
+}
+
+int Context::GetNumaNode() {
+    return numa_node_;
+}
+
+ContextCounters &Context::GetCounters() {
+    return counters_;
+}
+
 #if TNN_PROFILE
 void Context::StartProfile() {
     profile_layer     = true;
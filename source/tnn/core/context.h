@@ -15,6 +15,7 @@
 #ifndef TNN_SOURCE_TNN_CORE_CONTEXT_H_
 #define TNN_SOURCE_TNN_CORE_CONTEXT_H_
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,6 +27,17 @@
 
 namespace TNN_NS {
 
+// @brief counters updated on the forward path, read by Instance::GetMetrics
+struct ContextCounters {
+    // bytes of the shared workspace held by the context
+    std::atomic<int64_t> workspace_bytes{0};
+    std::atomic<uint64_t> workspace_grow_count{0};
+    // forwards of layers run through a cpu adapter
+    std::atomic<uint64_t> adapter_fallback_count{0};
+    // bytes written by reformat layers
+    std::atomic<uint64_t> reformat_bytes{0};
+};
+
 class Context {
 public:
     // @brief virtual destructor
@@ -75,6 +87,12 @@ public:
 
     std::string GetCacheFilePath();
 
+    void SetNumaNode(int numa_node);
+
+    int GetNumaNode();
+
+    ContextCounters &GetCounters();
+
 #if TNN_PROFILE
 public:
     virtual void StartProfile();
@@ -92,6 +110,8 @@ protected:
     bool enable_tune_kernel_ = true;
     std::string cache_path_ = ""; // dir to save cache files
     std::string cache_file_path_ = "";
+    int numa_node_ = -1;
+    ContextCounters counters_;
 };
 
 }  // namespace TNN_NS
@@ -27,6 +27,7 @@
 #include "tnn/utils/blob_transfer_utils.h"
 #include "tnn/utils/cpu_utils.h"
 #include "tnn/utils/data_flag_utils.h"
+#include "tnn/utils/data_type_utils.h"
 #include "tnn/utils/dims_utils.h"
 #include "tnn/utils/md5.h"
 #include "tnn/utils/string_utils_inner.h"
@@ -88,6 +89,7 @@ Status DefaultNetwork::Init(NetworkConfig &net_config, ModelConfig &model_config
 #endif
     context_->SetPrecision(net_config.precision);
     context_->SetEnableTuneKernel(net_config.enable_tune_kernel);
+    context_->SetNumaNode(net_config.numa_node);
 
     if(!net_config.cache_path.empty()) {
         auto params_md5 = default_interpreter->GetParamsMd5();
@@ -449,6 +451,31 @@ Status DefaultNetwork::GetAllOutputBlobs(BlobMap &blobs) {
     return TNN_OK;
 }
 
+Status DefaultNetwork::BindExternalBlob(std::string name, void *data) {
+    return blob_manager_->BindExternalBlob(name, data);
+}
+
+Status DefaultNetwork::GetMetrics(InstanceMetrics &metrics) {
+    metrics.forward_memory_bytes = blob_manager_->GetAllBlobMemorySize();
+    metrics.aliased_copy_bytes   = blob_manager_->GetAliasedBytes();
+
+    auto &counters                 = context_->GetCounters();
+    metrics.workspace_bytes        = counters.workspace_bytes.load(std::memory_order_relaxed);
+    metrics.workspace_grow_count   = counters.workspace_grow_count.load(std::memory_order_relaxed);
+    metrics.adapter_fallback_count = counters.adapter_fallback_count.load(std::memory_order_relaxed);
+    metrics.reformat_bytes         = counters.reformat_bytes.load(std::memory_order_relaxed);
+    return TNN_OK;
+}
+
+Status DefaultNetwork::ResetMetrics() {
+    // workspace_bytes is a gauge and keeps its value
+    auto &counters = context_->GetCounters();
+    counters.workspace_grow_count.store(0, std::memory_order_relaxed);
+    counters.adapter_fallback_count.store(0, std::memory_order_relaxed);
+    counters.reformat_bytes.store(0, std::memory_order_relaxed);
+    return TNN_OK;
+}
+
 /*
  * Reshape function is called when the input shape changes.
  * Memory allocation may be involved in Reshape function.
@@ -629,6 +656,9 @@ Status DefaultNetwork::Forward() {
         
         cnt++;
     }
+    if (reformat_bytes_ > 0) {
+        context_->GetCounters().reformat_bytes.fetch_add(reformat_bytes_, std::memory_order_relaxed);
+    }
     context_->OnInstanceForwardEnd();
     context_->Synchronize();
     return status;
@@ -664,6 +694,9 @@ Status DefaultNetwork::ForwardWithCallback(BlobStatisticCallback before, BlobSta
 
         cnt++;
     }
+    if (reformat_bytes_ > 0) {
+        context_->GetCounters().reformat_bytes.fetch_add(reformat_bytes_, std::memory_order_relaxed);
+    }
     context_->OnInstanceForwardEnd();
     return result;
 }
@@ -683,6 +716,9 @@ Status DefaultNetwork::ForwardAsync(Callback call_back) {
         result = layer->Forward();
         RETURN_ON_NEQ(result, TNN_OK);
     }
+    if (reformat_bytes_ > 0) {
+        context_->GetCounters().reformat_bytes.fetch_add(reformat_bytes_, std::memory_order_relaxed);
+    }
     context_->OnInstanceForwardEnd();
     return result;
 }
@@ -704,11 +740,20 @@ std::string DefaultNetwork::GenerateCacheFileName(ModelConfig &model_config, std
 }
 
 Status DefaultNetwork::ReshapeLayers() {
+    reformat_bytes_ = 0;
     for (auto cur_layer : layers_) {
         auto status = cur_layer->Reshape();
         RETURN_ON_NEQ(status, TNN_OK);
         //Note output shape may not change after reshape for const folder, but will do change after forward because shape may be determined at rumtime
         LOGD("ReshapeLayers Output Shape: [%s]\n", cur_layer->GetOutputBlobs()[0]->GetBlobDesc().description().c_str());
+
+        if (cur_layer->GetLayerType() == LAYER_REFORMAT) {
+            for (auto blob : cur_layer->GetOutputBlobs()) {
+                auto &desc = blob->GetBlobDesc();
+                reformat_bytes_ +=
+                    (int64_t)DimsVectorUtils::Count(desc.dims) * DataTypeUtils::GetBytesSize(desc.data_type);
+            }
+        }
     }
     return TNN_OK;
 }
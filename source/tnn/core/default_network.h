@@ -92,6 +92,15 @@ public:
     // @brief set threads run on device
     virtual Status SetCpuNumThreads(int num_threads);
 
+    // @brief bind caller owned memory to an input or output blob
+    virtual Status BindExternalBlob(std::string name, void *data);
+
+    // @brief fill the forward memory and the device counters of metrics
+    virtual Status GetMetrics(InstanceMetrics &metrics);
+
+    // @brief reset the device counters
+    virtual Status ResetMetrics();
+
 #if TNN_PROFILE
 public:
     virtual void StartProfile();
@@ -126,6 +135,9 @@ protected:
 
     NetworkConfig config_;
 
+    // bytes written by the reformat layers in one forward, updated on reshape
+    int64_t reformat_bytes_ = 0;
+
     static std::mutex optimize_mtx_;
 
 private:
@@ -17,14 +17,17 @@
 #include <memory>
 
 #include "tnn/core/abstract_network.h"
+#include "tnn/core/async_forward_executor.h"
 #include "tnn/core/common.h"
 #include "tnn/core/const_folder.h"
+#include "tnn/core/metrics_recorder.h"
 #include "tnn/core/macro.h"
 #include "tnn/core/profile.h"
 #include "tnn/core/status.h"
 #include "tnn/interpreter/abstract_model_interpreter.h"
 #include "tnn/interpreter/default_model_interpreter.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/numa_utils.h"
 
 namespace TNN_NS {
 
@@ -36,6 +39,7 @@ namespace TNN_NS {
 Instance::Instance(NetworkConfig &net_config, ModelConfig &model_config) {
     net_config_   = net_config;
     model_config_ = model_config; // note that, the params in model_config is empty, don't use it
+    metrics_      = std::make_shared<InstanceMetricsRecorder>();
 }
 Instance::~Instance() {
     DeInit();
@@ -60,6 +64,13 @@ Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, Inp
     auto device = GetDevice(type);
     LOGE_IF(!device, "device is nil or unsupported for type: %d\n", type);
     RETURN_VALUE_ON_NEQ(device != NULL, true, TNNERR_DEVICE_NOT_SUPPORT);
+
+    if (net_config_.numa_node >= NumaUtils::GetNodeCount()) {
+        LOGE("numa node %d is out of range, only %d nodes\n", net_config_.numa_node, NumaUtils::GetNodeCount());
+        return Status(TNNERR_PARAM_ERR, "numa node is out of range");
+    }
+    // memory allocated while initializing the instance is placed on its numa node
+    NumaMemoryGuard numa_guard(net_config_.numa_node);
     
     if (interpreter) {
         interpreter_ = interpreter->Copy();
@@ -71,6 +82,15 @@ Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, Inp
     }
     
     auto default_interpreter = dynamic_cast<DefaultModelInterpreter *>(interpreter_.get());
+    if (default_interpreter && interpreter_ != interpreter && net_config_.numa_node >= 0 &&
+        net_config_.numa_replicate_weights) {
+        auto status = default_interpreter->ReplicateNetResource();
+        if (status != TNN_OK) {
+            LOGE("Replicate weights to numa node %d failed: %s\n", net_config_.numa_node,
+                 status.description().c_str());
+            return status;
+        }
+    }
 
     auto network_type = net_config_.network_type;
     if(network_type == NETWORK_TYPE_AUTO) {
@@ -99,6 +119,7 @@ Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, Inp
         auto const_folder = std::make_shared<ConstFolder>();
         auto folder_net_config = net_config_;
         folder_net_config.share_memory_mode = SHARE_MEMORY_MODE_DEFAULT;
+        folder_net_config.external_memory_blobs.clear();
         auto status = const_folder->Init(folder_net_config, model_config_, interpreter_.get(), min_inputs_shape, max_inputs_shape);
         RETURN_ON_NEQ(status, TNN_OK);
 
@@ -124,11 +145,17 @@ Status Instance::Init(std::shared_ptr<AbstractModelInterpreter> interpreter, Inp
     auto ret = network_->Init(net_config_, model_config_, interpreter_.get(), min_inputs_shape, max_inputs_shape, true);
     RETURN_ON_NEQ(ret, TNN_OK);
 
+    cpu_default_network_ = network_type == NETWORK_TYPE_DEFAULT &&
+                           (type == DEVICE_NAIVE || type == DEVICE_X86 || type == DEVICE_ARM);
+
     return TNN_OK;
 }
 
 Status Instance::DeInit() {
+    async_forward_ = nullptr;
+    staged_input_converters_.clear();
     network_ = nullptr;
+    bound_mats_.clear();
     return TNN_OK;
 }
 
@@ -137,11 +164,20 @@ Status Instance::GetForwardMemorySize(int &memory_size) {
 }
 
 Status Instance::SetForwardMemory(void *memory) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
     return network_->SetForwardMemory(memory);
 }
 
 Status Instance::Reshape(const InputShapesMap &inputs) {
-    Status status = TNN_OK;
+    // inputs staged during the async forward are copied into the network and kept, the staging blobs
+    // are reallocated for the new shapes when they are written next
+    Status status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
+    staged_input_converters_.clear();
+    metrics_->reshape_count.fetch_add(1, std::memory_order_relaxed);
+
+    NumaMemoryGuard numa_guard(net_config_.numa_node);
     if (const_folder_) {
         auto folder = dynamic_cast<ConstFolder*>(const_folder_.get());
         status = folder->Reshape(inputs);
@@ -164,14 +200,25 @@ AbstractNetwork *Instance::GetNetwork() {
 }
 
 Status Instance::Forward() {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
     output_mats_convert_status_.clear();
-    return network_->Forward();
+
+    auto begin = std::chrono::steady_clock::now();
+    status     = network_->Forward();
+    metrics_->AddForward(std::chrono::steady_clock::now() - begin, status == TNN_OK);
+    return status;
 }
 
 #ifdef FORWARD_CALLBACK_ENABLE
 Status Instance::ForwardWithCallback(BlobStatisticCallback before, BlobStatisticCallback after) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
     output_mats_convert_status_.clear();
-    return network_->ForwardWithCallback(before, after);
+    auto begin = std::chrono::steady_clock::now();
+    status     = network_->ForwardWithCallback(before, after);
+    metrics_->AddForward(std::chrono::steady_clock::now() - begin, status == TNN_OK);
+    return status;
 }
 #endif  // end of FORWARD_CALLBACK_ENABLE
 
@@ -184,18 +231,44 @@ std::shared_ptr<AbstractModelInterpreter> Instance::GetInterpreter() {
 
 Status Instance::ForwardAsync(Callback call_back) {
     output_mats_convert_status_.clear();
-    return (Status)network_->ForwardAsync(call_back);
+    if (cpu_default_network_ && call_back) {
+        if (!async_forward_) {
+            async_forward_ = std::make_shared<AsyncForwardExecutor>(network_.get(), metrics_.get());
+        }
+        return async_forward_->Run(call_back);
+    }
+
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    auto begin = std::chrono::steady_clock::now();
+    status     = network_->ForwardAsync(call_back);
+    metrics_->AddForward(std::chrono::steady_clock::now() - begin, status == TNN_OK);
+    return status;
+}
+
+Status Instance::WaitAsyncForward() {
+    if (!async_forward_) {
+        return TNN_OK;
+    }
+    return async_forward_->Sync();
 }
 
 Status Instance::GetAllInputBlobs(BlobMap &blobs) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
     return network_->GetAllInputBlobs(blobs);
 }
 
 Status Instance::GetAllOutputBlobs(BlobMap &blobs) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
     return network_->GetAllOutputBlobs(blobs);
 }
 
 Status Instance::SetCpuNumThreads(int num_threads) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
     return network_->SetCpuNumThreads(num_threads);
 }
 
@@ -205,6 +278,7 @@ Status Instance::SetInputMat(std::shared_ptr<Mat> mat, MatConvertParam param, st
         LOGE("input mat is empty ,please check!\n");
         return Status(TNNERR_PARAM_ERR, "input mat is empty ,please check!");
     }
+    ScopedLatency latency(metrics_->convert_in_latency);
 
     // get input blobs
     BlobMap input_blobs;
@@ -224,32 +298,48 @@ Status Instance::SetInputMat(std::shared_ptr<Mat> mat, MatConvertParam param, st
         }
     }
 
-    // check blob convert
-    std::shared_ptr<BlobConverter> blob_converter = nullptr;
-    if (input_converters_.size() > 0 && input_converters_.find(input_name) != input_converters_.end()) {
-        blob_converter = input_converters_[input_name];
-    } else {
-        auto input_blob               = input_blobs[input_name];
-        blob_converter                = std::make_shared<BlobConverter>(input_blob);
-        input_converters_[input_name] = blob_converter;
-    }
+    auto input_blob = input_blobs[input_name];
+    auto convert    = [&](Blob *target_blob) -> Status {
+        // a staging blob gets its own converter
+        auto converters = target_blob == input_blob ? &input_converters_ : &staged_input_converters_;
 
-    // get command queue
-    void *command_queue = nullptr;
-    network_->GetCommandQueue(&command_queue);
+        // check blob convert
+        std::shared_ptr<BlobConverter> blob_converter = nullptr;
+        if (converters->size() > 0 && converters->find(input_name) != converters->end()) {
+            blob_converter = (*converters)[input_name];
+        } else {
+            blob_converter            = std::make_shared<BlobConverter>(target_blob);
+            (*converters)[input_name] = blob_converter;
+        }
 
-    status = blob_converter->ConvertFromMatAsync(*(mat.get()), param, command_queue);
-    if (status != TNN_NS::TNN_OK) {
-        LOGE("input_blob_convert.ConvertFromMatAsync Error: %s\n", status.description().c_str());
-        return status;
-    }
+        // get command queue
+        void *command_queue = nullptr;
+        network_->GetCommandQueue(&command_queue);
 
-    return TNN_OK;
+        auto status = blob_converter->ConvertFromMatAsync(*(mat.get()), param, command_queue);
+        if (status != TNN_NS::TNN_OK) {
+            LOGE("input_blob_convert.ConvertFromMatAsync Error: %s\n", status.description().c_str());
+            return status;
+        }
+        return TNN_OK;
+    };
+
+    // while an async forward runs, the input is staged for the next one
+    if (async_forward_) {
+        return async_forward_->ConvertInput(input_name, input_blob, convert);
+    }
+    return convert(input_blob);
 }
 
 // get output Mat
 Status Instance::GetOutputMat(std::shared_ptr<Mat> &mat, MatConvertParam param, std::string output_name,
                               DeviceType device, MatType mat_type) {
+    if (async_forward_) {
+        auto status = async_forward_->Wait();
+        RETURN_ON_NEQ(status, TNN_OK);
+    }
+    ScopedLatency latency(metrics_->convert_out_latency);
+
     // get output blobs
     BlobMap output_blobs;
     auto status = network_->GetAllOutputBlobs(output_blobs);
@@ -318,6 +408,150 @@ Status Instance::GetOutputMat(std::shared_ptr<Mat> &mat, MatConvertParam param,
     return status;
 }
 
+// get output Mat of the last finished async forward
+Status Instance::GetCompletedOutputMat(std::shared_ptr<Mat> &mat, MatConvertParam param, std::string output_name,
+                                       DeviceType device, MatType mat_type) {
+    ScopedLatency latency(metrics_->convert_out_latency);
+    if (!async_forward_) {
+        LOGE("instance has no finished async forward\n");
+        return Status(TNNERR_INST_ERR, "instance has no finished async forward");
+    }
+
+    // insure name is valid, take the first output name for default
+    if (output_name.length() <= 0) {
+        BlobMap output_blobs;
+        auto status = network_->GetAllOutputBlobs(output_blobs);
+        if (status != TNN_OK || output_blobs.size() <= 0) {
+            LOGE("instance.GetAllOutputBlobs Error: %s\n", status.description().c_str());
+            return status;
+        }
+        output_name = output_blobs.begin()->first;
+    }
+
+    void *command_queue = nullptr;
+    network_->GetCommandQueue(&command_queue);
+    return async_forward_->ConvertCompletedOutput(output_name, [&](Blob *output_blob) {
+        mat = std::make_shared<Mat>(device, mat_type, output_blob->GetBlobDesc().dims);
+
+        BlobConverter blob_converter(output_blob);
+        auto status = blob_converter.ConvertToMat(*(mat.get()), param, command_queue);
+        if (status != TNN_NS::TNN_OK) {
+            LOGE("output_blob_convert.ConvertFromMat Error: %s\n", status.description().c_str());
+        }
+        return status;
+    });
+}
+
+Status Instance::GetMetrics(InstanceMetrics &metrics) {
+    metrics = InstanceMetrics();
+    metrics_->Snapshot(metrics);
+    if (network_) {
+        return network_->GetMetrics(metrics);
+    }
+    return TNN_OK;
+}
+
+Status Instance::ResetMetrics() {
+    metrics_->Reset();
+    if (network_) {
+        return network_->ResetMetrics();
+    }
+    return TNN_OK;
+}
+
+Status Instance::BindInputMat(std::shared_ptr<Mat> mat, std::string input_name) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    BlobMap input_blobs;
+    status = network_->GetAllInputBlobs(input_blobs);
+    RETURN_ON_NEQ(status, TNN_OK);
+    return BindMat(mat, input_blobs, input_name);
+}
+
+Status Instance::BindOutputMat(std::shared_ptr<Mat> mat, std::string output_name) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    BlobMap output_blobs;
+    status = network_->GetAllOutputBlobs(output_blobs);
+    RETURN_ON_NEQ(status, TNN_OK);
+    return BindMat(mat, output_blobs, output_name);
+}
+
+Status Instance::BindMat(std::shared_ptr<Mat> mat, BlobMap &blobs, std::string name) {
+    if (!mat || !mat->GetData()) {
+        LOGE("bind mat is empty ,please check!\n");
+        return Status(TNNERR_PARAM_ERR, "bind mat is empty ,please check!");
+    }
+    if (!cpu_default_network_) {
+        LOGE("blob memory can only be bound on cpu devices\n");
+        return Status(TNNERR_DEVICE_NOT_SUPPORT, "blob memory can only be bound on cpu devices");
+    }
+    if (blobs.size() <= 0) {
+        return Status(TNNERR_MODEL_ERR, "instance dont have blobs to bind");
+    }
+
+    // insure name is valid, take the first blob name for default
+    if (name.length() <= 0) {
+        name = blobs.begin()->first;
+    } else if (blobs.find(name) == blobs.end()) {
+        LOGE("instance dont have the blob with name: %s\n", name.c_str());
+        return Status(TNNERR_MODEL_ERR, "instance dont have the blob with name");
+    }
+
+    // the mat is used as blob memory as is, so it must hold the blob data type in nchw order
+    auto &desc        = blobs[name]->GetBlobDesc();
+    auto mat_type     = mat->GetMatType();
+    bool type_match   = (desc.data_type == DATA_TYPE_FLOAT && mat_type == NCHW_FLOAT) ||
+                        (desc.data_type == DATA_TYPE_INT32 && mat_type == NC_INT32) ||
+                        (desc.data_type == DATA_TYPE_INT8 && mat_type == RESERVED_INT8_TEST);
+    bool format_match = desc.data_format == DATA_FORMAT_NCHW ||
+                        (desc.data_format == DATA_FORMAT_AUTO && desc.device_type != DEVICE_ARM);
+    bool device_match = mat->GetDeviceType() == DEVICE_NAIVE || mat->GetDeviceType() == DEVICE_X86 ||
+                        mat->GetDeviceType() == DEVICE_ARM;
+    if (!type_match || !format_match || !device_match || !DimsVectorUtils::Equal(mat->GetDims(), desc.dims)) {
+        LOGE("mat of type %d does not match the layout of blob %s, use SetInputMat or GetOutputMat\n", mat_type,
+             desc.description(true).c_str());
+        return Status(TNNERR_PARAM_ERR, "mat does not match the layout of the blob");
+    }
+
+    // a layer writing one bound blob would clobber another one sharing its memory
+    auto mat_bytes = [](std::shared_ptr<Mat> m) -> int {
+        int count = DimsVectorUtils::Count(m->GetDims());
+        return m->GetMatType() == RESERVED_INT8_TEST ? count : count * 4;
+    };
+    auto begin = static_cast<char *>(mat->GetData());
+    auto end   = begin + mat_bytes(mat);
+    for (auto iter : bound_mats_) {
+        auto bound_begin = static_cast<char *>(iter.second->GetData());
+        auto bound_end   = bound_begin + mat_bytes(iter.second);
+        if (iter.first != name && begin < bound_end && bound_begin < end) {
+            LOGE("mat overlaps the mat bound to blob %s\n", iter.first.c_str());
+            return Status(TNNERR_PARAM_ERR, "mat overlaps a mat bound to another blob");
+        }
+    }
+
+    auto status = network_->BindExternalBlob(name, mat->GetData());
+    RETURN_ON_NEQ(status, TNN_OK);
+    bound_mats_[name] = mat;
+    return TNN_OK;
+}
+
+Status Instance::UnbindMat(std::string blob_name) {
+    auto status = WaitAsyncForward();
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    if (bound_mats_.find(blob_name) == bound_mats_.end()) {
+        LOGE("no mat is bound to blob %s\n", blob_name.c_str());
+        return Status(TNNERR_PARAM_ERR, "no mat is bound to the blob");
+    }
+    status = network_->BindExternalBlob(blob_name, nullptr);
+    RETURN_ON_NEQ(status, TNN_OK);
+    bound_mats_.erase(blob_name);
+    return TNN_OK;
+}
+
 #if TNN_PROFILE
 void Instance::StartProfile() {
     network_->StartProfile();
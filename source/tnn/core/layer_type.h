@@ -237,6 +237,7 @@ enum LayerType {
 
     LAYER_CBAM_FUSED_REDUCE                                 = 800,
     LAYER_CBAM_FUSED_POOLING                                = 801,
+    LAYER_DW_PW_FUSED_CONV                                  = 802,
 
     // TNN Graph Matcher related LAYER_TYPES
     LAYER_DUMMY_TYPE                                        = 1000,
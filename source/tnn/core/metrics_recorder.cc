@@ -0,0 +1,90 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/core/metrics_recorder.h"
+
+namespace TNN_NS {
+
+// roughly 1-2.5-5 steps from 50us to 1s
+static const double kLatencyBucketBoundsUs[LatencyHistogram::kBucketCount - 1] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000, 1000000};
+
+double LatencyHistogram::GetBucketBoundUs(int index) {
+    if (index < 0 || index >= kBucketCount - 1) {
+        return -1;
+    }
+    return kLatencyBucketBoundsUs[index];
+}
+
+LatencyRecorder::LatencyRecorder() {
+    Reset();
+}
+
+void LatencyRecorder::Add(std::chrono::steady_clock::duration latency) {
+    uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(latency).count();
+    double us   = ns * 1e-3;
+
+    int index = 0;
+    while (index < LatencyHistogram::kBucketCount - 1 && us > kLatencyBucketBoundsUs[index]) {
+        index++;
+    }
+    buckets_[index].fetch_add(1, std::memory_order_relaxed);
+    count_.fetch_add(1, std::memory_order_relaxed);
+    sum_ns_.fetch_add(ns, std::memory_order_relaxed);
+}
+
+void LatencyRecorder::Snapshot(LatencyHistogram &histogram) const {
+    for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        histogram.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+    }
+    histogram.count  = count_.load(std::memory_order_relaxed);
+    histogram.sum_us = sum_ns_.load(std::memory_order_relaxed) * 1e-3;
+}
+
+void LatencyRecorder::Reset() {
+    for (int i = 0; i < LatencyHistogram::kBucketCount; i++) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+    count_.store(0, std::memory_order_relaxed);
+    sum_ns_.store(0, std::memory_order_relaxed);
+}
+
+void InstanceMetricsRecorder::AddForward(std::chrono::steady_clock::duration latency, bool success) {
+    forward_count.fetch_add(1, std::memory_order_relaxed);
+    if (!success) {
+        forward_error_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    forward_latency.Add(latency);
+}
+
+void InstanceMetricsRecorder::Snapshot(InstanceMetrics &metrics) const {
+    metrics.forward_count       = forward_count.load(std::memory_order_relaxed);
+    metrics.forward_error_count = forward_error_count.load(std::memory_order_relaxed);
+    metrics.reshape_count       = reshape_count.load(std::memory_order_relaxed);
+    convert_in_latency.Snapshot(metrics.convert_in_latency);
+    forward_latency.Snapshot(metrics.forward_latency);
+    convert_out_latency.Snapshot(metrics.convert_out_latency);
+}
+
+void InstanceMetricsRecorder::Reset() {
+    forward_count.store(0, std::memory_order_relaxed);
+    forward_error_count.store(0, std::memory_order_relaxed);
+    reshape_count.store(0, std::memory_order_relaxed);
+    convert_in_latency.Reset();
+    forward_latency.Reset();
+    convert_out_latency.Reset();
+}
+
+}  // namespace TNN_NS
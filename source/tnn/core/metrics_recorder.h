@@ -0,0 +1,78 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_CORE_METRICS_RECORDER_H_
+#define TNN_SOURCE_TNN_CORE_METRICS_RECORDER_H_
+
+#include <atomic>
+#include <chrono>
+
+#include "tnn/core/instance_metrics.h"
+
+namespace TNN_NS {
+
+// @brief lock free LatencyHistogram, samples can be added from any thread
+class LatencyRecorder {
+public:
+    LatencyRecorder();
+
+    void Add(std::chrono::steady_clock::duration latency);
+
+    void Snapshot(LatencyHistogram &histogram) const;
+
+    void Reset();
+
+private:
+    std::atomic<uint64_t> buckets_[LatencyHistogram::kBucketCount];
+    std::atomic<uint64_t> count_;
+    std::atomic<uint64_t> sum_ns_;
+};
+
+// @brief adds the time from its construction to its destruction to a LatencyRecorder
+class ScopedLatency {
+public:
+    explicit ScopedLatency(LatencyRecorder &recorder)
+        : recorder_(recorder), begin_(std::chrono::steady_clock::now()) {}
+
+    ~ScopedLatency() {
+        recorder_.Add(std::chrono::steady_clock::now() - begin_);
+    }
+
+private:
+    LatencyRecorder &recorder_;
+    std::chrono::steady_clock::time_point begin_;
+};
+
+// @brief counters kept by an instance, the network and context ones are added in the snapshot
+struct InstanceMetricsRecorder {
+    std::atomic<uint64_t> forward_count{0};
+    std::atomic<uint64_t> forward_error_count{0};
+    std::atomic<uint64_t> reshape_count{0};
+
+    LatencyRecorder convert_in_latency;
+    LatencyRecorder forward_latency;
+    LatencyRecorder convert_out_latency;
+
+    // @brief record a finished forward
+    void AddForward(std::chrono::steady_clock::duration latency, bool success);
+
+    void Snapshot(InstanceMetrics &metrics) const;
+
+    void Reset();
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_CORE_METRICS_RECORDER_H_
@@ -245,6 +245,9 @@ struct TNNVector {
         }
         return dst;
     }
+    static TNNVector<T, len> fast_exp(const TNNVector<T, len>& v) {
+        return exp(v);
+    }
     static TNNVector<T, len> pow(const TNNVector<T, len>& v, const TNNVector<T, len>& e) {
         TNNVector<T, len> dst;
         for (int i = 0; i < len; ++i) {
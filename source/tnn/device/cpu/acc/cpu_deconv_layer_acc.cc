@@ -19,6 +19,7 @@
 #include "tnn/interpreter/layer_resource_generator.h"
 #include "tnn/utils/dims_utils.h"
 #include "tnn/utils/naive_compute.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 static int LeastCommonMultiple(int m, int n) {
@@ -128,60 +129,55 @@ Status CpuDeconvLayerAcc::Exec(const std::vector<Blob *> &inputs, const std::vec
     const int delta_ix = delta_kx * dilation_w / stride_w;
 
     if (data_type != DATA_TYPE_INT8) {
-        // #pragma omp parallel
-        for (int b = 0; b < batch; b++) {
-            T *output_ptr_base = (T *)output_ptr + b * group * output_channel_per_group * output_size;
-            T *input_ptr_base  = (T *)input_ptr + b * group * input_channel_per_group * input_size;
-            for (int g = 0; g < group; g++) {
-                const float *weight_ptr_g =
-                    (float *)weight_ptr + g * input_channel_per_group * output_channel_per_group * kernel_size;
-                const float *bias_g = bias_ptr ? (float *)bias_ptr + g * output_channel_per_group : nullptr;
-                T *output_ptr_g     = output_ptr_base + g * output_channel_per_group * output_size;
-                T *input_ptr_g      = input_ptr_base + g * input_channel_per_group * input_size;
-
-                for (int oc = 0; oc < output_channel_per_group; oc++) {
-                    const float bias      = bias_g ? bias_g[oc] : 0.f;
-                    T *output_channel_ptr = output_ptr_g + oc * output_size;
-
-                    for (int oh = 0; oh < output_height; oh++) {
-                        for (int ow = 0; ow < output_width; ow++) {
-                            T *outout_data_ptr = output_channel_ptr + oh * output_width + ow;
-                            float sum          = bias;
-
-                            int oy     = oh + pad_h_begin;
-                            int ox     = ow + pad_w_begin;
-                            int max_sy = std::min((input_height - 1) * stride_h, oy / stride_h * stride_h);
-                            int max_sx = std::min((input_width - 1) * stride_w, ox / stride_w * stride_w);
-                            int min_ky = UP_DIV(oy - max_sy, dilation_h);
-                            int min_kx = UP_DIV(ox - max_sx, dilation_w);
-                            if ((oy - min_ky * dilation_h) % stride_h == 0 &&
-                                (ox - min_kx * dilation_w) % stride_w == 0) {
-                                int min_sy = std::max(0, ROUND_UP(oy + dilation_h - kernel_h * dilation_h, stride_h));
-                                int min_sx = std::max(0, ROUND_UP(ox + dilation_w - kernel_w * dilation_w, stride_w));
-                                int max_ky = (oy - min_sy) / dilation_h;
-                                int max_kx = (ox - min_sx) / dilation_w;
-                                int min_iy = (oy - max_ky * dilation_h) / stride_h;
-                                int min_ix = (ox - max_kx * dilation_w) / stride_w;
-
-                                auto weight_data = weight_ptr_g + oc * kernel_size;
-                                auto input_data  = (T *)input_ptr_g;
-                                for (auto ic = 0; ic < input_channel_per_group; ic++) {
-                                    for (auto ky = max_ky, iy = min_iy; ky >= min_ky; ky -= delta_ky, iy += delta_iy) {
-                                        for (auto kx = max_kx, ix = min_ix; kx >= min_kx;
-                                             kx -= delta_kx, ix += delta_ix) {
-                                            auto wt4 = weight_data[ic * output_channel_per_group * kernel_size +
-                                                                   ky * kernel_w + kx];
-                                            auto in4 = input_data[ic * input_size + iy * input_width + ix];
-                                            sum += float(in4) * wt4;
-                                        }
-                                    }
+        OMP_PARALLEL_FOR_
+        for (int index = 0; index < batch * output_channel; index++) {
+            const int b  = index / output_channel;
+            const int g  = index % output_channel / output_channel_per_group;
+            const int oc = index % output_channel_per_group;
+
+            const float *weight_ptr_g =
+                (float *)weight_ptr + g * input_channel_per_group * output_channel_per_group * kernel_size;
+            T *input_ptr_g        = (T *)input_ptr + (b * group + g) * input_channel_per_group * input_size;
+            const float bias      = bias_ptr ? ((float *)bias_ptr)[g * output_channel_per_group + oc] : 0.f;
+            T *output_channel_ptr = (T *)output_ptr + index * output_size;
+
+            for (int oh = 0; oh < output_height; oh++) {
+                for (int ow = 0; ow < output_width; ow++) {
+                    T *outout_data_ptr = output_channel_ptr + oh * output_width + ow;
+                    float sum          = bias;
+
+                    int oy     = oh + pad_h_begin;
+                    int ox     = ow + pad_w_begin;
+                    int max_sy = std::min((input_height - 1) * stride_h, oy / stride_h * stride_h);
+                    int max_sx = std::min((input_width - 1) * stride_w, ox / stride_w * stride_w);
+                    int min_ky = UP_DIV(oy - max_sy, dilation_h);
+                    int min_kx = UP_DIV(ox - max_sx, dilation_w);
+                    if ((oy - min_ky * dilation_h) % stride_h == 0 &&
+                        (ox - min_kx * dilation_w) % stride_w == 0) {
+                        int min_sy = std::max(0, ROUND_UP(oy + dilation_h - kernel_h * dilation_h, stride_h));
+                        int min_sx = std::max(0, ROUND_UP(ox + dilation_w - kernel_w * dilation_w, stride_w));
+                        int max_ky = (oy - min_sy) / dilation_h;
+                        int max_kx = (ox - min_sx) / dilation_w;
+                        int min_iy = (oy - max_ky * dilation_h) / stride_h;
+                        int min_ix = (ox - max_kx * dilation_w) / stride_w;
+
+                        auto weight_data = weight_ptr_g + oc * kernel_size;
+                        auto input_data  = (T *)input_ptr_g;
+                        for (auto ic = 0; ic < input_channel_per_group; ic++) {
+                            for (auto ky = max_ky, iy = min_iy; ky >= min_ky; ky -= delta_ky, iy += delta_iy) {
+                                for (auto kx = max_kx, ix = min_ix; kx >= min_kx;
+                                     kx -= delta_kx, ix += delta_ix) {
+                                    auto wt4 = weight_data[ic * output_channel_per_group * kernel_size +
+                                                           ky * kernel_w + kx];
+                                    auto in4 = input_data[ic * input_size + iy * input_width + ix];
+                                    sum += float(in4) * wt4;
                                 }
                             }
-                            // post op : only support relu and relu6
-                            ActiveOutput(param, sum);
-                            *outout_data_ptr = sum;
                         }
                     }
+                    // post op : only support relu and relu6
+                    ActiveOutput(param, sum);
+                    *outout_data_ptr = sum;
                 }
             }
         }
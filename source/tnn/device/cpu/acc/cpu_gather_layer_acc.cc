@@ -63,6 +63,17 @@ Status CpuGatherLayerAcc::Forward(const std::vector<Blob *> &inputs, const std::
     
     const int ele_size = DataTypeUtils::GetBytesSize(outputs[0]->GetBlobDesc().data_type);
     auto output_data_ptr = (char*)outputs[0]->GetHandle().base;
+
+    // int8 rows with per-row scale are dequantized to the fp32 output
+    const float *row_scale = nullptr;
+    if (layer_param->data_in_resource && layer_resource->data.GetDataType() == DATA_TYPE_INT8 &&
+        outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
+        if (axis != 0 || layer_resource->scale_data.GetDataCount() != input_slice_count) {
+            LOGE("CpuGatherLayerAcc::Forward int8 data needs axis 0 and one scale per row\n");
+            return Status(TNNERR_LAYER_ERR, "CpuGatherLayerAcc::Forward int8 data needs axis 0 and one scale per row");
+        }
+        row_scale = layer_resource->scale_data.force_to<float*>();
+    }
     
     for (int b=0; b<batch; b++) {
         int input_index_b = b*input_slice_count*slice_size;
@@ -79,6 +90,14 @@ Status CpuGatherLayerAcc::Forward(const std::vector<Blob *> &inputs, const std::
             int input_index = input_index_b + slice_index*slice_size;
             int output_index = output_index_b + i*slice_size;
             
+            if (row_scale) {
+                auto dst = (float*)output_data_ptr + output_index;
+                auto src = (int8_t*)input_data_ptr + input_index;
+                for (int j=0; j<slice_size; j++) {
+                    dst[j] = row_scale[slice_index] * src[j];
+                }
+                continue;
+            }
             memcpy(output_data_ptr + output_index*ele_size,
                    input_data_ptr + input_index*ele_size,
                    slice_size * ele_size);
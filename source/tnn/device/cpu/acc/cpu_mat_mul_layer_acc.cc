@@ -15,6 +15,7 @@
 #include "cpu_layer_acc.h"
 #include "tnn/device/cpu/acc/cpu_unary_layer_acc.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 //DECLARE_CPU_ACC(MatMul, LAYER_MATMUL);
@@ -95,21 +96,21 @@ Status CpuMatMulLayerAcc::Forward(const std::vector<Blob *> &inputs, const std::
         int batch_a   = count_a / (M * N);
         int batch_b   = count_b / (N * K);
         int batch_c   = count_c / (M * K);
-        for (int bc = 0; bc < batch_c; ++bc) {
+        OMP_PARALLEL_FOR_
+        for (int index = 0; index < count_c; ++index) {
+            int bc = index / (M * K);
+            int m  = index / K % M;
+            int k  = index % K;
             int ba = bc % batch_a;
             int bb = bc % batch_b;
-            
-            for (int m = 0; m < M; ++m) {
-                for (int k = 0; k < K; ++k) {
-                    //in align with onnx, use double to compute here for decision.
-                    //or for align with bert model, use COSINE distance ??? not checked
-                    double sum = 0;
-                    for (int n = 0; n < N; ++n) {
-                        sum += double(matrix_a[ba * M * N + m * N + n]) * double(matrix_b[bb * N * K + n * K + k]);
-                    }
-                    matrix_c[bc * M * K + m * K + k] = float(sum);
-                }
+
+            //in align with onnx, use double to compute here for decision.
+            //or for align with bert model, use COSINE distance ??? not checked
+            double sum = 0;
+            for (int n = 0; n < N; ++n) {
+                sum += double(matrix_a[ba * M * N + m * N + n]) * double(matrix_b[bb * N * K + n * K + k]);
             }
+            matrix_c[index] = float(sum);
         }
     }
 
@@ -17,11 +17,18 @@
 #include "tnn/utils/data_type_utils.h"
 #include "tnn/utils/dims_utils.h"
 #include "tnn/utils/naive_compute.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 
 CpuReduceLayerAcc::~CpuReduceLayerAcc() {}
 
+// the part-th of parts nearly equal ranges of [0, count)
+static inline void SplitRange(int count, int parts, int part, int &begin, int &end) {
+    begin = static_cast<int>(static_cast<int64_t>(count) * part / parts);
+    end   = static_cast<int>(static_cast<int64_t>(count) * (part + 1) / parts);
+}
+
 Status CalculateReduceDims(Blob *input_blob, ReduceLayerParam *layer_param,
                            std::vector<std::tuple<int, int, int>> &reduce_dims) {
     auto input_dims = input_blob->GetBlobDesc().dims;
@@ -49,7 +56,13 @@ Status CpuReduceLayerAcc::ProcessReduce(Blob *input_blob, Blob *output_blob,
 
     int input_count            = DimsVectorUtils::Count(input_dims);
     T* pre_cal_reduce_result = new T[input_count];
-    PreCalculateReduce(pre_cal_reduce_result, input_data, input_count);
+    const int thread_count   = OMP_MAX_THREADS_NUM_;
+    OMP_PARALLEL_FOR_
+    for (int t = 0; t < thread_count; ++t) {
+        int begin, end;
+        SplitRange(input_count, thread_count, t, begin, end);
+        PreCalculateReduce(pre_cal_reduce_result + begin, input_data + begin, end - begin);
+    }
 
     T *src       = pre_cal_reduce_result;
     T *tmp_ptr   = nullptr;
@@ -63,13 +76,46 @@ Status CpuReduceLayerAcc::ProcessReduce(Blob *input_blob, Blob *output_blob,
             release_mem = true;
         }
         tmp_ptr = new T[inner_count * outer_count]();
-        CalculateReduce(tmp_ptr, src, outer_count, reduce_count, inner_count);
+        // every output is reduced by one thread in the serial order, the outer slices are split across the
+        // threads, or the inner dim if there are fewer slices than threads
+        if (outer_count >= thread_count || inner_count < thread_count) {
+            const int tile_count = std::min(outer_count, thread_count);
+            OMP_PARALLEL_FOR_
+            for (int t = 0; t < tile_count; ++t) {
+                int begin, end;
+                SplitRange(outer_count, tile_count, t, begin, end);
+                CalculateReduce(tmp_ptr + (int64_t)begin * inner_count,
+                                src + (int64_t)begin * reduce_count * inner_count, end - begin, reduce_count,
+                                inner_count);
+            }
+        } else {
+            OMP_PARALLEL_FOR_
+            for (int index = 0; index < outer_count * thread_count; ++index) {
+                const int outer = index / thread_count;
+                int begin, end;
+                SplitRange(inner_count, thread_count, index % thread_count, begin, end);
+                const int width = end - begin;
+                std::vector<T> src_tile(reduce_count * width);
+                std::vector<T> dst_tile(width, 0);
+                T *src_outer = src + (int64_t)outer * reduce_count * inner_count + begin;
+                for (int r = 0; r < reduce_count; ++r) {
+                    memcpy(src_tile.data() + r * width, src_outer + (int64_t)r * inner_count, width * sizeof(T));
+                }
+                CalculateReduce(dst_tile.data(), src_tile.data(), 1, reduce_count, width);
+                memcpy(tmp_ptr + (int64_t)outer * inner_count + begin, dst_tile.data(), width * sizeof(T));
+            }
+        }
         if (release_mem) {
             delete[] src;
         }
         src = tmp_ptr;
     }
-    PostCalculateReduce(output_data, src, output_count);
+    OMP_PARALLEL_FOR_
+    for (int t = 0; t < thread_count; ++t) {
+        int begin, end;
+        SplitRange(output_count, thread_count, t, begin, end);
+        PostCalculateReduce(output_data + begin, src + begin, end - begin);
+    }
     if (release_mem || reduce_dims.size() == 1) {
         delete[] src;
     }
@@ -163,6 +163,8 @@ Status OpenCLCpuAdapterAcc::Reshape(const std::vector<Blob *> &inputs, const std
 }
 
 Status OpenCLCpuAdapterAcc::Forward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    ocl_context_->GetCounters().adapter_fallback_count.fetch_add(1, std::memory_order_relaxed);
+
     void* command_queue = nullptr;
     ocl_context_->GetCommandQueue(&command_queue);
 
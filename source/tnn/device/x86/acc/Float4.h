@@ -218,6 +218,26 @@ struct Float4 {
         dst.value = exp_ps(v.value);
         return dst;
     }
+    // exp(x) = 2^n * p(r), p is a degree 4 polynomial on |r| <= ln2/2, relative error below 1e-5
+    static Float4 fast_exp(const Float4 &v) {
+#ifdef __SSE4_1__
+        const __m128 one = _mm_set1_ps(1.0f);
+        __m128 x = _mm_min_ps(_mm_max_ps(v.value, _mm_set1_ps(-87.3f)), _mm_set1_ps(88.3f));
+        __m128 n = _mm_round_ps(_mm_mul_ps(x, _mm_set1_ps(1.44269504f)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m128 r = _mm_sub_ps(x, _mm_mul_ps(n, _mm_set1_ps(0.693359375f)));
+        r        = _mm_sub_ps(r, _mm_mul_ps(n, _mm_set1_ps(-2.12194440e-4f)));
+        __m128 p = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(4.09174029e-2f), r), _mm_set1_ps(1.67539760e-1f));
+        p        = _mm_add_ps(_mm_mul_ps(p, r), _mm_set1_ps(5.00089310e-1f));
+        p        = _mm_add_ps(_mm_mul_ps(p, r), one);
+        p        = _mm_add_ps(_mm_mul_ps(p, r), one);
+        __m128i e = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n), _mm_set1_epi32(127)), 23);
+        Float4 dst;
+        dst.value = _mm_mul_ps(p, _mm_castsi128_ps(e));
+        return dst;
+#else
+        return exp(v);
+#endif
+    }
     static Float4 log(const Float4 &v) {
         Float4 dst;
         dst.value = log_ps(v.value);
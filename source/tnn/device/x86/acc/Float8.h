@@ -146,12 +146,11 @@ struct Float8 {
         return dst;
     }
     static float reduce_add(const Float8& v) {
-        Float8 tmp;
-        tmp.value = _mm256_hadd_ps(v.value, v.value);
-        tmp.value = _mm256_hadd_ps(tmp.value, tmp.value);
-        float rst[8];
-        _mm256_store_ps(rst, tmp.value);
-        return rst[0];
+        // hadd only adds within 128-bit lanes, fold the high lane first
+        __m128 sum = _mm_add_ps(_mm256_castps256_ps128(v.value), _mm256_extractf128_ps(v.value, 1));
+        sum        = _mm_hadd_ps(sum, sum);
+        sum        = _mm_hadd_ps(sum, sum);
+        return _mm_cvtss_f32(sum);
     }
     static Float8 neg(const Float8 &v) {
         Float8 dst;
@@ -179,6 +178,27 @@ struct Float8 {
         dst.value = exp256_ps(v.value);
         return dst;
     }
+    // exp(x) = 2^n * p(r), p is a degree 4 polynomial on |r| <= ln2/2, relative error below 1e-5
+    static Float8 fast_exp(const Float8 &v) {
+#if defined(__AVX2__) && defined(__FMA__)
+        const __m256 one = _mm256_set1_ps(1.0f);
+        __m256 x = _mm256_min_ps(_mm256_max_ps(v.value, _mm256_set1_ps(-87.3f)), _mm256_set1_ps(88.3f));
+        __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504f)),
+                                   _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+        r        = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+        __m256 p = _mm256_fmadd_ps(_mm256_set1_ps(4.09174029e-2f), r, _mm256_set1_ps(1.67539760e-1f));
+        p        = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.00089310e-1f));
+        p        = _mm256_fmadd_ps(p, r, one);
+        p        = _mm256_fmadd_ps(p, r, one);
+        __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+        Float8 dst;
+        dst.value = _mm256_mul_ps(p, _mm256_castsi256_ps(e));
+        return dst;
+#else
+        return exp(v);
+#endif
+    }
     static Float8 log(const Float8 &v) {
         Float8 dst;
         dst.value = log256_ps(v.value);
@@ -134,6 +134,32 @@ void pack_col_a_n<float>(const float * a, dim_t lda, float * b, dim_t ldb,
                    dim_t m, dim_t n,
                    conv_gemm_config<float, float, float> &conv_gemm_conf);
 
+// same layout as pack_col_a_n, column i of the int8 a is multiplied by scale[i] on the way
+void pack_col_a_n_int8(const int8_t * a, dim_t lda, const float * scale, float * b, dim_t ldb, dim_t m, dim_t n,
+                       conv_gemm_config<float, float, float> &conv_gemm_conf)
+{
+    dim_t block_size = conv_gemm_conf.m_block_;
+
+    for (dim_t i = 0; i < n; i += block_size) {
+        dim_t cur_n = std::min(n - i, block_size);
+        float * cur_b = b + i * ldb;
+        for (dim_t k = 0; k < m; k++) {
+            const int8_t * src = a + i + k * lda;
+            float * dst = cur_b + k * block_size;
+            dim_t j = 0;
+#ifdef __AVX2__
+            for (; j + 8 <= cur_n; j += 8) {
+                __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64((const __m128i *)(src + j)));
+                _mm256_storeu_ps(dst + j, _mm256_mul_ps(_mm256_cvtepi32_ps(v), _mm256_loadu_ps(scale + i + j)));
+            }
+#endif
+            for (; j < cur_n; j++) {
+                dst[j] = src[j] * scale[i + j];
+            }
+        }
+    }
+}
+
 template <int blk, typename T>
 void pack_a_t_trans(
     const T *src,
@@ -28,6 +28,10 @@ void pack_col_a_n(const T * a, dim_t lda, T * b, dim_t ldb, dim_t m, dim_t n, co
 template<typename T>
 void pack_col_b_n(const T * a, dim_t lda, T * b, dim_t ldb, dim_t m, dim_t n, conv_gemm_config<T, T, T> &conv_gemm_conf);
 
+// pack_col_a_n of an int8 a, dequantized with one scale per column
+void pack_col_a_n_int8(const int8_t * a, dim_t lda, const float * scale, float * b, dim_t ldb, dim_t m, dim_t n,
+                       conv_gemm_config<float, float, float> &conv_gemm_conf);
+
 template<typename T>
 void pack_col_a_t(const T * a, dim_t lda, T * b, dim_t ldb, dim_t m, dim_t n, conv_gemm_config<T, T, T> &conv_gemm_conf);
 
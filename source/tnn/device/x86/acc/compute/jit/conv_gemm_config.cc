@@ -23,6 +23,7 @@
 
 #include "tnn/device/x86/acc/compute/jit/kernels/base_jit_kernel.h"
 #include "tnn/device/x86/acc/compute/jit/kernels/jit_kernels.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_cache.h"
 #include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
 
 namespace TNN_NS {
@@ -40,9 +41,6 @@ conv_gemm_config<a_t, b_t, c_t>::conv_gemm_config(
        throw std::runtime_error("value of n_block is not supported.");
     }
 
-    M_c_ = 64;
-    K_c_ = 256;
-
     if (cpu_with_isa(avx2)) {
 #ifdef XBYAK64
         m_block_ = 16;
@@ -56,6 +54,7 @@ conv_gemm_config<a_t, b_t, c_t>::conv_gemm_config(
         kernel_m_r_ = 4;
     }
     kernel_n_r_ = 6;
+    get_gemm_block_size(kernel_m_r_, kernel_n_r_, m_block_, n_block_, M_c_, K_c_, N_c_);
     this->init_jit_kernel();
 }
 
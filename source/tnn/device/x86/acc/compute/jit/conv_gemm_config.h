@@ -40,9 +40,11 @@ typedef void (*conv_sgemm_ker_func_t)(const dim_t K,
     dim_t kernel_m_r_;
     dim_t kernel_n_r_;
 
-    // block size for matrix spliting
+    // block size for matrix spliting, derived from the cache sizes
     dim_t M_c_;
     dim_t K_c_;
+    // upper bound of the N range handled by one parallel task
+    dim_t N_c_;
 
     constexpr static int nb_kernels_m = 16;
     constexpr static int nb_kernels_n = 6;
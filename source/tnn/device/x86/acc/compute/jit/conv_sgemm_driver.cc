@@ -82,13 +82,11 @@ void conv_sgemm_block_n(
     }
 }
 
-// sgemm col_major a no_trans, b no_trans
-// src_a: M * K, lda = M
-// src_b: K * N, ldb = K
-// dst  : M * N, ldc = M
-void conv_sgemm_nn_col_major(
+// pack_a(i, k, cur_m, cur_k, dst) packs the cur_m x cur_k block of a at (i, k) to dst
+template <typename PackA>
+static void conv_sgemm_nn_col_major_impl(
         dim_t M, dim_t N, dim_t K,
-        const float * src_a, dim_t lda,
+        PackA pack_a, dim_t lda,
         const float * src_b, dim_t ldb,
         float * dst, dim_t ldc,
         const float * bias, dim_t act_type,
@@ -130,7 +128,7 @@ void conv_sgemm_nn_col_major(
         for (i = 0; i < M; i += M_c)  {
             dim_t cur_m = MIN(M - i, M_c);
             // pack a -> M_c * K_c;
-            pack_col_a_n(src_a + i + k * lda, lda, pack_a_buf, K_c, cur_k, cur_m, conv_gemm_conf);
+            pack_a(i, k, cur_m, cur_k, pack_a_buf);
 
             for (j = 0; j < N;)  {
                 dim_t cur_n = MIN(N - j, conv_gemm_conf.kernel_n_r_);
@@ -149,22 +147,95 @@ void conv_sgemm_nn_col_major(
 
 // sgemm col_major a no_trans, b no_trans
 // src_a: M * K, lda = M
-// src_b: K * N, ldb = K, prepacked
+// src_b: K * N, ldb = K
 // dst  : M * N, ldc = M
-void conv_sgemm_nn_col_major_prepack_b(
+void conv_sgemm_nn_col_major(
         dim_t M, dim_t N, dim_t K,
         const float * src_a, dim_t lda,
         const float * src_b, dim_t ldb,
         float * dst, dim_t ldc,
         const float * bias, dim_t act_type,
-        float *src_trans_buf,
+        float *pack_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf)
+{
+    dim_t K_c = conv_gemm_conf.K_c_;
+    auto pack_a = [&](dim_t i, dim_t k, dim_t cur_m, dim_t cur_k, float *pack_a_buf) {
+        pack_col_a_n(src_a + i + k * lda, lda, pack_a_buf, K_c, cur_k, cur_m, conv_gemm_conf);
+    };
+    conv_sgemm_nn_col_major_impl(M, N, K, pack_a, lda, src_b, ldb, dst, ldc, bias, act_type, pack_buf, conv_gemm_conf);
+}
+
+// sgemm col_major a no_trans, b no_trans, a is int8 and dequantized while packing
+// src_a: M * K, lda = M, scale_a: M
+// src_b: K * N, ldb = K
+// dst  : M * N, ldc = M
+void conv_sgemm_nn_col_major_int8_a(
+        dim_t M, dim_t N, dim_t K,
+        const int8_t * src_a, dim_t lda, const float * scale_a,
+        const float * src_b, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t act_type,
+        float *pack_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf)
+{
+    dim_t K_c = conv_gemm_conf.K_c_;
+    auto pack_a = [&](dim_t i, dim_t k, dim_t cur_m, dim_t cur_k, float *pack_a_buf) {
+        pack_col_a_n_int8(src_a + i + k * lda, lda, scale_a + i, pack_a_buf, K_c, cur_k, cur_m, conv_gemm_conf);
+    };
+    conv_sgemm_nn_col_major_impl(M, N, K, pack_a, lda, src_b, ldb, dst, ldc, bias, act_type, pack_buf, conv_gemm_conf);
+}
+
+// one M_c x N_c task of conv_sgemm_nn_col_major_prepack_b for the k slab of b at pack_b_k
+static void conv_sgemm_nn_prepack_b_task(
+        dim_t t, dim_t m_tasks, dim_t N_c, dim_t M, dim_t N, dim_t k, dim_t cur_k,
+        const float * src_a, dim_t lda,
+        const float * pack_b_k, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t first, dim_t post_type,
+        float * src_trans_buf,
         conv_gemm_config<float, float, float> &conv_gemm_conf)
 {
     dim_t M_c = conv_gemm_conf.M_c_;
     dim_t K_c = conv_gemm_conf.K_c_;
-    dim_t m_block = conv_gemm_conf.m_block_;
     dim_t n_block = conv_gemm_conf.n_block_;
 
+    dim_t i = (t % m_tasks) * M_c;
+    dim_t n_start = (t / m_tasks) * N_c;
+    dim_t n_end = MIN(N, n_start + N_c);
+    dim_t cur_m = MIN(M - i, M_c);
+    // pack a -> M_c * K_c;
+    pack_col_a_n(src_a + i + k * lda, lda, src_trans_buf, K_c, cur_k, cur_m, conv_gemm_conf);
+
+    for (dim_t j = n_start; j < n_end;)  {
+        dim_t cur_n = MIN(n_end - j, conv_gemm_conf.kernel_n_r_);
+        float * cur_c = dst + i + j * ldc;
+
+        const float * packed_cur_b = pack_b_k + divDown(j, n_block) * K_c + j % n_block;
+        const float * cur_bias = bias + j;
+        conv_sgemm_block_n(cur_m, cur_n, cur_k, src_trans_buf, lda, packed_cur_b, ldb, cur_c, ldc, cur_bias, first, post_type, conv_gemm_conf);
+        j += cur_n;
+    }
+}
+
+template <bool parallel>
+static void conv_sgemm_nn_col_major_prepack_b_impl(
+        dim_t M, dim_t N, dim_t K,
+        const float * src_a, dim_t lda,
+        const float * src_b, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t act_type,
+        float * src_trans_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf)
+{
+    dim_t M_c = conv_gemm_conf.M_c_;
+    dim_t K_c = conv_gemm_conf.K_c_;
+    dim_t n_block = conv_gemm_conf.n_block_;
+
+    // N_c_ is a multiple of n_block, so every task starts at a packed panel of b
+    dim_t N_c = MAX(divDown(conv_gemm_conf.N_c_, n_block), n_block);
+    dim_t m_tasks = (M + M_c - 1) / M_c;
+    dim_t n_tasks = (N + N_c - 1) / N_c;
+
     dim_t first = 0;
     dim_t post_type;
 
@@ -185,22 +256,19 @@ void conv_sgemm_nn_col_major_prepack_b(
         // pack b -> K_c * N;
         const float *pack_b_k = src_b + k * divUp(N, n_block);
 
-        OMP_PARALLEL_FOR_DYNAMIC_
-        for (dim_t i = 0; i < M; i += M_c)  {
-            int thread_id = OMP_TID_;
-            auto src_trans_per_t = src_trans_buf + thread_id * M_c * K_c;
-            dim_t cur_m = MIN(M - i, M_c);
-            // pack a -> M_c * K_c;
-            pack_col_a_n(src_a + i + k * lda, lda, src_trans_per_t, K_c, cur_k, cur_m, conv_gemm_conf);
-
-            for (dim_t j = 0; j < N;)  {
-                dim_t cur_n = MIN(N - j, conv_gemm_conf.kernel_n_r_);
-                float * cur_c = dst + i + j * ldc;
-
-                const float * packed_cur_b = pack_b_k + divDown(j, n_block) * K_c + j % n_block;
-                const float * cur_bias = bias + j;
-                conv_sgemm_block_n(cur_m, cur_n, cur_k, src_trans_per_t, lda, packed_cur_b, ldb, cur_c, ldc, cur_bias, first, post_type, conv_gemm_conf);
-                j += cur_n;
+        if (parallel) {
+            // tasks are ordered N major, threads running at the same time share one slab of b
+            OMP_PARALLEL_FOR_DYNAMIC_
+            for (dim_t t = 0; t < m_tasks * n_tasks; t++)  {
+                int thread_id = OMP_TID_;
+                conv_sgemm_nn_prepack_b_task(t, m_tasks, N_c, M, N, k, cur_k, src_a, lda, pack_b_k, ldb, dst, ldc,
+                                             bias, first, post_type, src_trans_buf + thread_id * M_c * K_c,
+                                             conv_gemm_conf);
+            }
+        } else {
+            for (dim_t t = 0; t < m_tasks * n_tasks; t++)  {
+                conv_sgemm_nn_prepack_b_task(t, m_tasks, N_c, M, N, k, cur_k, src_a, lda, pack_b_k, ldb, dst, ldc,
+                                             bias, first, post_type, src_trans_buf, conv_gemm_conf);
             }
         }
         // if k != 0, first = 1
@@ -208,6 +276,37 @@ void conv_sgemm_nn_col_major_prepack_b(
     }
 }
 
+// sgemm col_major a no_trans, b no_trans
+// src_a: M * K, lda = M
+// src_b: K * N, ldb = K, prepacked
+// dst  : M * N, ldc = M
+void conv_sgemm_nn_col_major_prepack_b(
+        dim_t M, dim_t N, dim_t K,
+        const float * src_a, dim_t lda,
+        const float * src_b, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t act_type,
+        float *src_trans_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf)
+{
+    conv_sgemm_nn_col_major_prepack_b_impl<true>(M, N, K, src_a, lda, src_b, ldb, dst, ldc, bias, act_type,
+                                                 src_trans_buf, conv_gemm_conf);
+}
+
+// same as conv_sgemm_nn_col_major_prepack_b on the calling thread only, src_trans_buf holds M_c * K_c
+void conv_sgemm_nn_col_major_prepack_b_serial(
+        dim_t M, dim_t N, dim_t K,
+        const float * src_a, dim_t lda,
+        const float * src_b, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t act_type,
+        float *src_trans_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf)
+{
+    conv_sgemm_nn_col_major_prepack_b_impl<false>(M, N, K, src_a, lda, src_b, ldb, dst, ldc, bias, act_type,
+                                                  src_trans_buf, conv_gemm_conf);
+}
+
 // sgemm col_major a trans, b no_trans
 // src_a: K * M, lda = K
 // src_b: K * N, ldb = K, prepacked
@@ -398,4 +497,25 @@ void conv_ajust_m_blk_size(
     }
 }
 
+void conv_ajust_n_blk_size(
+    int max_num_threads,
+    dim_t m_all,
+    dim_t m_blk,
+    dim_t n_all,
+    dim_t n_block,
+    dim_t &n_blk)
+{
+    // enough M blocks to keep all threads busy
+    dim_t m_tasks = (m_all + m_blk - 1) / m_blk;
+    if (m_tasks >= max_num_threads) {
+        return;
+    }
+
+    // split N across the remaining threads, each task still
+    // computes several register blocks to amortize packing of a
+    dim_t n_tasks = (max_num_threads + m_tasks - 1) / m_tasks;
+    dim_t n_split = divUp((n_all + n_tasks - 1) / n_tasks, n_block);
+    n_blk = MIN(n_blk, MAX(n_split, n_block * 4));
+}
+
 } // namespace tnn
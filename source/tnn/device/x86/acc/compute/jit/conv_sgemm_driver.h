@@ -31,6 +31,16 @@ void conv_sgemm_nn_col_major(
         float *pack_buf,
         conv_gemm_config<float, float, float> &conv_gemm_conf);
 
+// sgemm col_major a no_trans, b no_trans, int8 a with one scale per row of a, dequantized while packing
+void conv_sgemm_nn_col_major_int8_a(
+        dim_t M, dim_t N, dim_t K,
+        const int8_t * src_a, dim_t lda, const float * scale_a,
+        const float * src_b, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t act_type,
+        float *pack_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf);
+
 // sgemm col_major a no_trans, b no_trans prepacked
 void conv_sgemm_nn_col_major_prepack_b(
         dim_t M, dim_t N, dim_t K,
@@ -41,6 +51,16 @@ void conv_sgemm_nn_col_major_prepack_b(
         float * src_buf,
         conv_gemm_config<float, float, float> &conv_gemm_conf);
 
+// sgemm col_major a no_trans, b no_trans prepacked, runs on the calling thread only
+void conv_sgemm_nn_col_major_prepack_b_serial(
+        dim_t M, dim_t N, dim_t K,
+        const float * src_a, dim_t lda,
+        const float * src_b, dim_t ldb,
+        float * dst, dim_t ldc,
+        const float * bias, dim_t act_type,
+        float * src_buf,
+        conv_gemm_config<float, float, float> &conv_gemm_conf);
+
 // sgemm col_major a trans, b no_trans prepacked
 void conv_sgemm_tn_col_major_prepack_b(
         dim_t M, dim_t N, dim_t K,
@@ -81,6 +101,15 @@ void conv_ajust_m_blk_size(
     dim_t m_all,
     dim_t &m_blk);
 
+// adjust N block size (N_c_) for mutil-thread when M has too few blocks
+void conv_ajust_n_blk_size(
+    int max_num_threads,
+    dim_t m_all,
+    dim_t m_blk,
+    dim_t n_all,
+    dim_t n_block,
+    dim_t &n_blk);
+
 }   // namespace TNN_NS
 
 #endif
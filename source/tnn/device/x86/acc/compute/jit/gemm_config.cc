@@ -23,6 +23,7 @@
 
 #include "tnn/device/x86/acc/compute/jit/kernels/base_jit_kernel.h"
 #include "tnn/device/x86/acc/compute/jit/kernels/jit_kernels.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_cache.h"
 
 namespace TNN_NS {
 
@@ -43,9 +44,6 @@ gemm_config<a_t, b_t, c_t>::gemm_config(const char * trans_a, const char * trans
        throw std::runtime_error("value of n_block is not supported.");
     }
 
-    M_c_ = 64;
-    K_c_ = 256;
-
 #ifdef XBYAK64
     kernel_m_r_ = 16; 
 #else 
@@ -53,6 +51,8 @@ gemm_config<a_t, b_t, c_t>::gemm_config(const char * trans_a, const char * trans
     kernel_m_r_ = 8; 
 #endif
     kernel_n_r_ = 6; 
+    dim_t N_c = 0;
+    get_gemm_block_size(kernel_m_r_, kernel_n_r_, m_block_, n_block_, M_c_, K_c_, N_c);
     this->init_jit_kernel();
 }
 
@@ -52,7 +52,7 @@ typedef void (*sgemm_ker_func_t)(const dim_t K, const float * alpha_ptr,
     dim_t kernel_m_r_;
     dim_t kernel_n_r_;
 
-    // block size for matrix spliting
+    // block size for matrix spliting, derived from the cache sizes
     dim_t M_c_;
     dim_t K_c_;
 
@@ -0,0 +1,215 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <xbyak/xbyak.h>
+#include <xbyak/xbyak_util.h>
+
+#include "tnn/device/x86/acc/compute/jit/utils/utils.h"
+
+namespace TNN_NS {
+
+#ifdef __linux__
+static bool read_sysfs_line(const std::string &path, char *buf, int len) {
+    FILE *fp = tnn_fopen(path.c_str(), "r");
+    if (!fp) {
+        return false;
+    }
+    bool ok = fgets(buf, len, fp) != nullptr;
+    fclose(fp);
+    return ok;
+}
+
+// "48K", "2048K", "32M"
+static dim_t parse_cache_size(const char *str) {
+    char *end = nullptr;
+    dim_t size = strtol(str, &end, 10);
+    if (end && (*end == 'K' || *end == 'k')) {
+        size *= 1024;
+    } else if (end && (*end == 'M' || *end == 'm')) {
+        size *= 1024 * 1024;
+    }
+    return size;
+}
+
+// "0-3,8-11" -> 8
+static dim_t parse_cpu_list_count(const char *str) {
+    dim_t count = 0;
+    const char *p = str;
+    while (*p && *p != '\n') {
+        char *end = nullptr;
+        long first = strtol(p, &end, 10);
+        if (end == p) {
+            break;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            last = strtol(p + 1, &end, 10);
+            p = end;
+        }
+        count += last - first + 1;
+        if (*p == ',') {
+            p++;
+        }
+    }
+    return std::max<dim_t>(count, 1);
+}
+
+static bool detect_from_sysfs(cpu_cache_info_t &info) {
+    bool found = false;
+    char buf[256];
+    for (int i = 0; i < 16; i++) {
+        std::string dir = "/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(i) + "/";
+        if (!read_sysfs_line(dir + "level", buf, sizeof(buf))) {
+            break;
+        }
+        int level = atoi(buf);
+        if (!read_sysfs_line(dir + "type", buf, sizeof(buf)) || strncmp(buf, "Instruction", 11) == 0) {
+            continue;
+        }
+        if (!read_sysfs_line(dir + "size", buf, sizeof(buf))) {
+            continue;
+        }
+        dim_t size    = parse_cache_size(buf);
+        dim_t sharing = 1;
+        if (read_sysfs_line(dir + "shared_cpu_list", buf, sizeof(buf))) {
+            sharing = parse_cpu_list_count(buf);
+        }
+        if (level == 1) {
+            info.l1d_size = size;
+        } else if (level == 2) {
+            info.l2_size    = size;
+            info.l2_sharing = sharing;
+        } else if (level == 3) {
+            info.l3_size    = size;
+            info.l3_sharing = sharing;
+        }
+        found = found || size > 0;
+    }
+    return found;
+}
+#endif
+
+// cpuid leaf 4, only reported by xbyak for intel cpus
+static bool detect_from_cpuid(cpu_cache_info_t &info) {
+    static Xbyak::util::Cpu cpu;
+    unsigned int levels = cpu.getDataCacheLevels();
+    for (unsigned int i = 0; i < levels && i < 3; i++) {
+        dim_t size    = cpu.getDataCacheSize(i);
+        dim_t sharing = std::max<dim_t>(cpu.getCoresSharingDataCache(i), 1);
+        if (i == 0) {
+            info.l1d_size = size;
+        } else if (i == 1) {
+            info.l2_size    = size;
+            info.l2_sharing = sharing;
+        } else {
+            info.l3_size    = size;
+            info.l3_sharing = sharing;
+        }
+    }
+    return levels > 0;
+}
+
+const cpu_cache_info_t &cpu_cache_info() {
+    static cpu_cache_info_t info;
+    static std::once_flag detected;
+    std::call_once(detected, [] {
+        memset(&info, 0, sizeof(info));
+        info.l2_sharing = 1;
+        info.l3_sharing = 1;
+        bool found = false;
+#ifdef __linux__
+        found = detect_from_sysfs(info);
+#endif
+        if (!found) {
+            detect_from_cpuid(info);
+        }
+    });
+    return info;
+}
+
+static std::atomic<dim_t> g_override_m_c(0);
+static std::atomic<dim_t> g_override_k_c(0);
+static std::atomic<dim_t> g_override_n_c(0);
+
+static void load_env_override() {
+    static std::once_flag loaded;
+    std::call_once(loaded, [] {
+        const char *env = getenv("TNN_X86_GEMM_BLOCK");
+        if (!env) {
+            return;
+        }
+        long long m_c = 0, k_c = 0, n_c = 0;
+        if (sscanf(env, "%lld,%lld,%lld", &m_c, &k_c, &n_c) >= 1) {
+            g_override_m_c = std::max<dim_t>(m_c, 0);
+            g_override_k_c = std::max<dim_t>(k_c, 0);
+            g_override_n_c = std::max<dim_t>(n_c, 0);
+        }
+    });
+}
+
+void set_gemm_block_size(dim_t M_c, dim_t K_c, dim_t N_c) {
+    load_env_override();
+    g_override_m_c = std::max<dim_t>(M_c, 0);
+    g_override_k_c = std::max<dim_t>(K_c, 0);
+    g_override_n_c = std::max<dim_t>(N_c, 0);
+}
+
+void get_gemm_block_size(dim_t kernel_m_r, dim_t kernel_n_r, dim_t m_block, dim_t n_block,
+                         dim_t &M_c, dim_t &K_c, dim_t &N_c) {
+    const auto &info = cpu_cache_info();
+    // typical sizes when detection fails
+    dim_t l1  = info.l1d_size > 0 ? info.l1d_size : 32 * 1024;
+    dim_t l2  = info.l2_size > 0 ? info.l2_size / info.l2_sharing : 256 * 1024;
+    dim_t llc = info.l3_size > 0 ? info.l3_size : l2;
+
+    // a quarter of L1 is left for c and the stack
+    K_c = l1 * 3 / 4 / ((kernel_m_r + kernel_n_r) * sizeof(float));
+    K_c = std::min<dim_t>(std::max<dim_t>(divDown(K_c, 32), 128), 512);
+
+    // M_c is halved for multi-thread later, keep it a power of two multiple of m_block
+    dim_t m_c_max = l2 / 2 / (K_c * sizeof(float));
+    M_c           = m_block;
+    while (M_c * 2 <= m_c_max && M_c * 2 <= 512) {
+        M_c *= 2;
+    }
+
+    N_c = llc / 2 / (K_c * sizeof(float));
+    N_c = std::max<dim_t>(divDown(N_c, n_block), n_block * 4);
+
+    load_env_override();
+    if (g_override_m_c > 0) {
+        M_c = divUp(g_override_m_c, m_block);
+    }
+    if (g_override_k_c > 0) {
+        K_c = g_override_k_c;
+    }
+    if (g_override_n_c > 0) {
+        N_c = divUp(g_override_n_c, n_block);
+    }
+}
+
+} // namespace tnn
@@ -0,0 +1,50 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_DEVICE_X86_ACC_COMPUTE_JIT_UTILS_CPU_CACHE_HPP_
+#define TNN_DEVICE_X86_ACC_COMPUTE_JIT_UTILS_CPU_CACHE_HPP_
+
+#include "tnn/device/x86/acc/compute/jit/common/type_def.h"
+
+namespace TNN_NS {
+
+// data cache sizes in bytes, 0 if the level does not exist or can not be detected.
+// *_sharing is the number of logical cpus sharing one instance of the cache.
+typedef struct {
+    dim_t l1d_size;
+    dim_t l2_size;
+    dim_t l3_size;
+    dim_t l2_sharing;
+    dim_t l3_sharing;
+} cpu_cache_info_t;
+
+// detected once, from sysfs on linux and from cpuid leaf 4 otherwise
+const cpu_cache_info_t &cpu_cache_info();
+
+// derive gemm block sizes from the cache topology:
+//   K_c: one kernel_m_r x K_c panel of a and one kernel_n_r x K_c panel of b stay in L1
+//   M_c: the packed M_c x K_c block of a stays in the per-core share of L2
+//   N_c: the packed K_c x N_c slab of b, read by all threads, stays in the LLC
+// the result can be overridden by set_gemm_block_size() or by the environment
+// variable TNN_X86_GEMM_BLOCK="M_c,K_c[,N_c]", a value of 0 keeps the derived one.
+void get_gemm_block_size(dim_t kernel_m_r, dim_t kernel_n_r, dim_t m_block, dim_t n_block,
+                         dim_t &M_c, dim_t &K_c, dim_t &N_c);
+
+// override the derived block sizes for gemm configs created afterwards, 0 means no override
+void set_gemm_block_size(dim_t M_c, dim_t K_c, dim_t N_c = 0);
+
+} // namespace tnn
+
+#endif // TNN_DEVICE_X86_ACC_COMPUTE_JIT_UTILS_CPU_CACHE_HPP_
@@ -15,6 +15,8 @@
 #include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/device/x86/acc/Float8.h"
 #include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
+#include "tnn/utils/half_utils.h"
 #include "tnn/utils/naive_compute.h"
 #include "tnn/utils/omp_utils.h"
 
@@ -822,83 +824,551 @@ template void DepthwiseConv<ActivationType_ReLU6, Float8, 8>(
     float* dst, const float* src, const float* weight, const float* bias, long width, long src_w_step, long fw, long fh,
     long dilate_x_step, long dilate_y_step, long height, long srcHStep, long dstHStep);
 
-template <int left, int oc_>
-void X86SgemvLeft(float* dst, const float* src, const float* weight, float *bias, size_t batch_stride) {
-    float acc[8];
-    for (int i = 0; i < left; i++) {
-        acc[i] = bias[i];
+X86SgemvPlan X86SgemvPartition(int rows, int cols, int depth, int pack, int num_threads) {
+    // rows of one task share every weight load, 4 rows still keep the accumulators in registers
+    const int max_row_tile = 4;
+    // depth per task below which the reduction of partial sums costs more than it saves
+    const int min_k_tile = 256;
+    // multiply-adds per task below which waking up another thread costs more than it saves
+    const long long min_task_work = 32 * 1024;
+
+    X86SgemvPlan plan;
+    plan.row_tile = MAX(MIN(rows, max_row_tile), 1);
+    plan.col_tile = ROUND_UP(cols, pack);
+    plan.k_tile   = depth;
+    int max_tasks = (int)MIN((long long)rows * cols * depth / min_task_work, (long long)num_threads * 4);
+    if (num_threads <= 1 || max_tasks <= 1) {
+        return plan;
     }
-    for (size_t ic = 0; ic < batch_stride; ic++) {
-        auto weight_ic = weight + ic * oc_;
-        for (int i = 0; i < left; i++) {
-            acc[i] += weight_ic[i] * src[ic];
+
+    // a few tasks per thread, so that dynamic scheduling can balance them
+    int row_tasks  = UP_DIV(rows, plan.row_tile);
+    int col_blocks = UP_DIV(cols, pack);
+    int col_tasks  = MIN(col_blocks, MAX(UP_DIV(max_tasks, row_tasks), 1));
+    plan.col_tile  = UP_DIV(col_blocks, col_tasks) * pack;
+    col_tasks      = UP_DIV(cols, plan.col_tile);
+
+    // output is too small to feed all threads, split depth and reduce the partial sums
+    int tasks = row_tasks * col_tasks;
+    if (tasks < num_threads * 2) {
+        int k_tasks = MIN(MIN(UP_DIV(num_threads * 2, tasks), max_tasks / tasks), depth / min_k_tile);
+        if (k_tasks > 1) {
+            plan.k_tile = ROUND_UP(UP_DIV(depth, k_tasks), 8);
         }
     }
-    for (int i = 0; i < left; i++) {
-        dst[i] = acc[i];
+    return plan;
+}
+
+size_t X86SgemvWorkspaceSize(const X86SgemvPlan &plan, int rows, int cols, int depth, int pack) {
+    int k_tasks = UP_DIV(depth, plan.k_tile);
+    if (k_tasks <= 1) {
+        return 0;
     }
+    return (size_t)k_tasks * rows * ROUND_UP(cols, pack) * sizeof(float);
 }
 
+// weights of the gemv kernels, fp32, raw fp16 bits or int8 expanded while streaming
+template <typename VEC, typename WT>
+struct X86SgemvWeight {
+    static inline VEC load(const float *weight) {
+        return VEC::loadu(weight);
+    }
+};
+
+template <typename VEC>
+struct X86SgemvWeight<VEC, uint16_t> {
+    static inline VEC load(const uint16_t *weight) {
+        float tmp[sizeof(VEC) / sizeof(float)];
+        X86HalfToFloat(tmp, weight, sizeof(VEC) / sizeof(float));
+        return VEC::loadu(tmp);
+    }
+};
+
+template <typename VEC>
+struct X86SgemvWeight<VEC, int8_t> {
+    static inline VEC load(const int8_t *weight) {
+        float tmp[sizeof(VEC) / sizeof(float)];
+        for (int i = 0; i < (int)(sizeof(VEC) / sizeof(float)); i++) {
+            tmp[i] = weight[i];
+        }
+        return VEC::loadu(tmp);
+    }
+};
+
+#ifdef __SSE4_1__
+template <>
+struct X86SgemvWeight<Float4, int8_t> {
+    static inline Float4 load(const int8_t *weight) {
+        int32_t bits;
+        memcpy(&bits, weight, sizeof(bits));
+        return Float4(_mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_cvtsi32_si128(bits))));
+    }
+};
+#endif
+
+#ifdef __AVX2__
+template <>
+struct X86SgemvWeight<Float8, int8_t> {
+    static inline Float8 load(const int8_t *weight) {
+        __m128i v = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(weight));
+        return Float8(_mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(v)));
+    }
+};
+#endif
+
+#if defined(__F16C__) && defined(__AVX__)
+template <>
+struct X86SgemvWeight<Float8, uint16_t> {
+    static inline Float8 load(const uint16_t *weight) {
+        return Float8(_mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(weight))));
+    }
+};
+#endif
+
 template <typename VEC, int pack>
-void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output) {
-    size_t batch_stride = DimsVectorUtils::Count(dims_input, 1);
-    int oc_vec_size = dims_output[1] / pack * pack;
-    int oc_left = dims_output[1] - oc_vec_size;
-    for (int b = 0; b < dims_output[0]; ++b) {
-        const float *src_batch = src + b * batch_stride;
-        float *dst_batch = dst + b * dims_output[1];
+static inline void X86SgemvStore(float *dst, VEC v, const float *bias, const float *scale, int valid) {
+    if (scale) {
+        v = v * VEC::loadu(scale);
+    }
+    if (valid == pack) {
+        if (bias) {
+            v = v + VEC::loadu(bias);
+        }
+        VEC::saveu(dst, v);
+    } else {
+        float tmp[pack];
+        VEC::saveu(tmp, v);
+        for (int i = 0; i < valid; i++) {
+            dst[i] = bias ? tmp[i] + bias[i] : tmp[i];
+        }
+    }
+}
 
-        OMP_PARALLEL_FOR_GUIDED_
-        for (int oc = 0; oc < oc_vec_size; oc += pack) {
-            auto weight_oc = weight + oc * batch_stride;
-            VEC acc = VEC::loadu(bias + oc);
-            size_t ic = 0;
-            for (; ic + 3 < batch_stride; ic += 4) {
-                auto weight_ic   = weight_oc + ic * pack;
-                VEC src_v0    = VEC(src_batch[ic]);
-                VEC src_v1    = VEC(src_batch[ic + 1]);
-                VEC src_v2    = VEC(src_batch[ic + 2]);
-                VEC src_v3    = VEC(src_batch[ic + 3]);
-                VEC weight_v0 = VEC::load(weight_ic);
-                VEC weight_v1 = VEC::load(weight_ic + pack * 1);
-                VEC weight_v2 = VEC::load(weight_ic + pack * 2);
-                VEC weight_v3 = VEC::load(weight_ic + pack * 3);
-                VEC::mla(acc, weight_v0, src_v0);
-                VEC::mla(acc, weight_v1, src_v1);
-                VEC::mla(acc, weight_v2, src_v2);
-                VEC::mla(acc, weight_v3, src_v3);
+// nb rows of src times one packed block of pack columns
+template <typename VEC, int pack, int nb, typename WT>
+static void X86SgemvKernel(float *dst, long ld_dst, const float *src, long ld_src, const WT *weight, long depth,
+                           const float *bias, const float *scale, int valid) {
+    // independent accumulators hide the fma latency when there are few rows
+    constexpr int unroll = nb == 1 ? 4 : 2;
+    VEC acc[unroll][nb];
+    for (int u = 0; u < unroll; u++) {
+        for (int r = 0; r < nb; r++) {
+            acc[u][r] = VEC(0.f);
+        }
+    }
+
+    long k = 0;
+    for (; k + unroll - 1 < depth; k += unroll) {
+        for (int u = 0; u < unroll; u++) {
+            VEC weight_v = X86SgemvWeight<VEC, WT>::load(weight + (k + u) * pack);
+            for (int r = 0; r < nb; r++) {
+                VEC::mla(acc[u][r], weight_v, VEC(src[r * ld_src + k + u]));
             }
-            for (; ic < batch_stride; ic++) {
-                VEC src_v    = VEC(src_batch[ic]);
-                VEC weight_v = VEC::load(weight_oc + ic * pack);
-                VEC::mla(acc, weight_v, src_v);
+        }
+    }
+    for (; k < depth; k++) {
+        VEC weight_v = X86SgemvWeight<VEC, WT>::load(weight + k * pack);
+        for (int r = 0; r < nb; r++) {
+            VEC::mla(acc[0][r], weight_v, VEC(src[r * ld_src + k]));
+        }
+    }
+
+    for (int r = 0; r < nb; r++) {
+        VEC sum = acc[0][r];
+        for (int u = 1; u < unroll; u++) {
+            sum = sum + acc[u][r];
+        }
+        X86SgemvStore<VEC, pack>(dst + r * ld_dst, sum, bias, scale, valid);
+    }
+}
+
+// nb rows of src times cv packed blocks, blocks are block_stride apart
+template <typename VEC, int pack, int nb, int cv, typename WT>
+static void X86SgemvWideKernel(float *dst, long ld_dst, const float *src, long ld_src, const WT *weight,
+                               long block_stride, long depth, const float *bias, const float *scale) {
+    VEC acc[nb][cv];
+    for (int r = 0; r < nb; r++) {
+        for (int v = 0; v < cv; v++) {
+            acc[r][v] = VEC(0.f);
+        }
+    }
+
+    for (long k = 0; k < depth; k++) {
+        VEC weight_v[cv];
+        for (int v = 0; v < cv; v++) {
+            weight_v[v] = X86SgemvWeight<VEC, WT>::load(weight + v * block_stride + k * pack);
+        }
+        for (int r = 0; r < nb; r++) {
+            VEC src_v = VEC(src[r * ld_src + k]);
+            for (int v = 0; v < cv; v++) {
+                VEC::mla(acc[r][v], weight_v[v], src_v);
             }
-            VEC::saveu(dst_batch + oc, acc);
         }
-        int left = oc_left;
-        int oc = oc_vec_size;
-        if (pack == 8) {
-            if (left == 7) {
-                X86SgemvLeft<7, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
-            } else if (left == 6) {
-                X86SgemvLeft<6, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
-            } else if (left == 5) {
-                X86SgemvLeft<5, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
-            } else if (left == 4) {
-                X86SgemvLeft<4, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
+    }
+
+    for (int r = 0; r < nb; r++) {
+        for (int v = 0; v < cv; v++) {
+            X86SgemvStore<VEC, pack>(dst + r * ld_dst + v * pack, acc[r][v], bias ? bias + v * pack : nullptr,
+                                     scale ? scale + v * pack : nullptr, pack);
+        }
+    }
+}
+
+// computes up to rows x cols of the tile starting at one packed block, returns the number of columns done
+template <typename VEC, int pack, typename WT>
+static int X86SgemvTile(float *dst, long ld_dst, const float *src, long ld_src, const WT *weight, long block_stride,
+                        long depth, const float *bias, const float *scale, int rows, int cols) {
+    // one row keeps 4 blocks in flight for the fma latency, more rows reuse each weight load instead
+    int width = rows == 1 ? 4 * pack : 2 * pack;
+    if (cols >= width) {
+        switch (rows) {
+            case 1:
+                X86SgemvWideKernel<VEC, pack, 1, 4, WT>(dst, ld_dst, src, ld_src, weight, block_stride, depth, bias,
+                                                        scale);
+                break;
+            case 2:
+                X86SgemvWideKernel<VEC, pack, 2, 2, WT>(dst, ld_dst, src, ld_src, weight, block_stride, depth, bias,
+                                                        scale);
+                break;
+            case 3:
+                X86SgemvWideKernel<VEC, pack, 3, 2, WT>(dst, ld_dst, src, ld_src, weight, block_stride, depth, bias,
+                                                        scale);
+                break;
+            default:
+                X86SgemvWideKernel<VEC, pack, 4, 2, WT>(dst, ld_dst, src, ld_src, weight, block_stride, depth, bias,
+                                                        scale);
+                break;
+        }
+        return width;
+    }
+
+    int valid = MIN(pack, cols);
+    switch (rows) {
+        case 1:
+            X86SgemvKernel<VEC, pack, 1, WT>(dst, ld_dst, src, ld_src, weight, depth, bias, scale, valid);
+            break;
+        case 2:
+            X86SgemvKernel<VEC, pack, 2, WT>(dst, ld_dst, src, ld_src, weight, depth, bias, scale, valid);
+            break;
+        case 3:
+            X86SgemvKernel<VEC, pack, 3, WT>(dst, ld_dst, src, ld_src, weight, depth, bias, scale, valid);
+            break;
+        default:
+            X86SgemvKernel<VEC, pack, 4, WT>(dst, ld_dst, src, ld_src, weight, depth, bias, scale, valid);
+            break;
+    }
+    return pack;
+}
+
+// sums the partial results of the depth tiles in workspace into dst
+template <typename VEC, int pack>
+static void X86SgemvReduce(float *dst, const float *workspace, const float *bias, int rows, int cols, int k_tasks) {
+    int cols_rup   = ROUND_UP(cols, pack);
+    int col_blocks = UP_DIV(cols, pack);
+    OMP_PARALLEL_FOR_
+    for (int t = 0; t < rows * col_blocks; t++) {
+        int r = t / col_blocks;
+        int c = (t % col_blocks) * pack;
+        VEC sum = VEC::loadu(workspace + r * cols_rup + c);
+        for (int kt = 1; kt < k_tasks; kt++) {
+            sum = sum + VEC::loadu(workspace + (kt * rows + r) * cols_rup + c);
+        }
+        X86SgemvStore<VEC, pack>(dst + r * cols + c, sum, bias ? bias + c : nullptr, nullptr, MIN(pack, cols - c));
+    }
+}
+
+/*
+dst[rows x cols] = src[rows x depth] * weight + bias, split into the tiles of plan.
+weight is packed to [cols / pack, depth, pack] and padded, so that full vectors can be read beyond cols.
+with more than one depth tile, every task writes partial sums to workspace, which are reduced afterwards.
+scale, if any, holds one padded factor per column of an int8 weight, the partial sums are scaled already.
+*/
+template <typename VEC, int pack, typename WT>
+static void X86SgemvCompute(float *dst, const float *src, const WT *weight, const float *bias, const float *scale,
+                            int rows, int cols, int depth, const X86SgemvPlan &plan, float *workspace) {
+    int row_tasks = UP_DIV(rows, plan.row_tile);
+    int col_tasks = UP_DIV(cols, plan.col_tile);
+    int k_tasks   = UP_DIV(depth, plan.k_tile);
+    int cols_rup  = ROUND_UP(cols, pack);
+
+    OMP_PARALLEL_FOR_DYNAMIC_
+    for (int t = 0; t < row_tasks * col_tasks * k_tasks; t++) {
+        int kt = t % k_tasks;
+        int ct = (t / k_tasks) % col_tasks;
+        int rt = t / (k_tasks * col_tasks);
+
+        int r_begin = rt * plan.row_tile;
+        int r_count = MIN(plan.row_tile, rows - r_begin);
+        int c_begin = ct * plan.col_tile;
+        int c_end   = MIN(c_begin + plan.col_tile, cols);
+        int k_begin = kt * plan.k_tile;
+        int k_count = MIN(plan.k_tile, depth - k_begin);
+
+        float *out       = dst + r_begin * cols;
+        long ld_out      = cols;
+        const float *add = bias;
+        if (k_tasks > 1) {
+            out    = workspace + (kt * rows + r_begin) * cols_rup;
+            ld_out = cols_rup;
+            add    = nullptr;
+        }
+
+        const float *src_k = src + r_begin * depth + k_begin;
+        for (int c = c_begin; c < c_end;) {
+            c += X86SgemvTile<VEC, pack, WT>(out + c, ld_out, src_k, depth, weight + c * depth + k_begin * pack,
+                                             (long)pack * depth, k_count, add ? add + c : nullptr,
+                                             scale ? scale + c : nullptr, r_count, c_end - c);
+        }
+    }
+
+    if (k_tasks > 1) {
+        X86SgemvReduce<VEC, pack>(dst, workspace, bias, rows, cols, k_tasks);
+    }
+}
+
+template <typename VEC, int pack>
+void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output,
+              const X86SgemvPlan &plan, float *workspace) {
+    int depth = DimsVectorUtils::Count(dims_input, 1);
+    X86SgemvCompute<VEC, pack, float>(dst, src, weight, bias, nullptr, dims_output[0], dims_output[1], depth, plan,
+                                      workspace);
+}
+template void X86Sgemv<Float4, 4>(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input,
+                                  DimsVector dims_output, const X86SgemvPlan &plan, float *workspace);
+template void X86Sgemv<Float8, 8>(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input,
+                                  DimsVector dims_output, const X86SgemvPlan &plan, float *workspace);
+
+void X86SgemvPackRowMajor(float *dst, const float *src, int depth, int cols, int pack) {
+    for (int c = 0; c < cols; c += pack) {
+        int valid   = MIN(pack, cols - c);
+        float *dst_c = dst + c * depth;
+        for (int k = 0; k < depth; k++) {
+            const float *src_k = src + k * cols + c;
+            int i = 0;
+            for (; i < valid; i++) {
+                dst_c[k * pack + i] = src_k[i];
+            }
+            for (; i < pack; i++) {
+                dst_c[k * pack + i] = 0.f;
+            }
+        }
+    }
+}
+
+template <typename VEC, int pack>
+void X86SgemvRowMajor(float *dst, const float *src, const float *weight, const float *bias, int rows, int cols,
+                      int depth, const X86SgemvPlan &plan, float *workspace) {
+    // columns per pass, the accumulated rows of dst stay in l1
+    const int chunk = 1024;
+
+    int row_tasks = UP_DIV(rows, plan.row_tile);
+    int col_tasks = UP_DIV(cols, plan.col_tile);
+    int k_tasks   = UP_DIV(depth, plan.k_tile);
+    int cols_rup  = ROUND_UP(cols, pack);
+
+    // the rows of weight are contiguous, every task streams them in depth order and accumulates in place
+    OMP_PARALLEL_FOR_DYNAMIC_
+    for (int t = 0; t < row_tasks * col_tasks * k_tasks; t++) {
+        int kt = t % k_tasks;
+        int ct = (t / k_tasks) % col_tasks;
+        int rt = t / (k_tasks * col_tasks);
+
+        int r_begin = rt * plan.row_tile;
+        int r_count = MIN(plan.row_tile, rows - r_begin);
+        int k_begin = kt * plan.k_tile;
+        int k_end   = MIN(k_begin + plan.k_tile, depth);
+
+        float *out       = dst + r_begin * cols;
+        long ld_out      = cols;
+        const float *add = bias;
+        if (k_tasks > 1) {
+            out    = workspace + (kt * rows + r_begin) * cols_rup;
+            ld_out = cols_rup;
+            add    = nullptr;
+        }
+
+        for (int c_begin = ct * plan.col_tile; c_begin < MIN((ct + 1) * plan.col_tile, cols); c_begin += chunk) {
+            int c_end = MIN(MIN(c_begin + chunk, (ct + 1) * plan.col_tile), cols);
+            for (int r = 0; r < r_count; r++) {
+                for (int c = c_begin; c < c_end; c++) {
+                    out[r * ld_out + c] = add ? add[c] : 0.f;
+                }
+            }
+            for (int k = k_begin; k < k_end; k++) {
+                const float *weight_k = weight + (long)k * cols;
+                int c = c_begin;
+                for (; c + pack <= c_end; c += pack) {
+                    VEC weight_v = VEC::loadu(weight_k + c);
+                    for (int r = 0; r < r_count; r++) {
+                        float *out_r = out + r * ld_out + c;
+                        VEC acc      = VEC::loadu(out_r);
+                        VEC::mla(acc, weight_v, VEC(src[(r_begin + r) * depth + k]));
+                        VEC::saveu(out_r, acc);
+                    }
+                }
+                for (; c < c_end; c++) {
+                    for (int r = 0; r < r_count; r++) {
+                        out[r * ld_out + c] += weight_k[c] * src[(r_begin + r) * depth + k];
+                    }
+                }
+            }
+        }
+    }
+
+    if (k_tasks > 1) {
+        X86SgemvReduce<VEC, pack>(dst, workspace, bias, rows, cols, k_tasks);
+    }
+}
+template void X86SgemvRowMajor<Float4, 4>(float *dst, const float *src, const float *weight, const float *bias,
+                                          int rows, int cols, int depth, const X86SgemvPlan &plan, float *workspace);
+template void X86SgemvRowMajor<Float8, 8>(float *dst, const float *src, const float *weight, const float *bias,
+                                          int rows, int cols, int depth, const X86SgemvPlan &plan, float *workspace);
+
+bool X86HalfWeightSupported() {
+#if defined(__F16C__) && defined(__AVX__)
+    // every cpu with avx2 has f16c
+    static bool supported = cpu_with_isa(avx2);
+    return supported;
+#else
+    return false;
+#endif
+}
+
+void X86HalfToFloat(float *dst, const uint16_t *src, long count) {
+    long i = 0;
+#if defined(__F16C__) && defined(__AVX__)
+    for (; i + 7 < count; i += 8) {
+        _mm256_storeu_ps(dst + i, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i))));
+    }
+    for (; i < count; i++) {
+        dst[i] = _cvtsh_ss(src[i]);
+    }
+#else
+    ConvertFromHalfToFloat((void *)(src + i), dst + i, count - i);
+#endif
+}
+
+void X86SgemvHalf(float *dst, const float *src, const uint16_t *weight, float *bias, DimsVector dims_input,
+                  DimsVector dims_output, const X86SgemvPlan &plan, float *workspace) {
+    int depth = DimsVectorUtils::Count(dims_input, 1);
+    X86SgemvCompute<Float8, 8, uint16_t>(dst, src, weight, bias, nullptr, dims_output[0], dims_output[1], depth, plan,
+                                         workspace);
+}
+
+void X86SgemvPackInt8(int8_t *dst, const int8_t *src, int depth, int cols, int pack, long col_stride,
+                      long depth_stride) {
+    for (int c = 0; c < cols; c += pack) {
+        int valid      = MIN(pack, cols - c);
+        int8_t *dst_c  = dst + (long)c * depth;
+        for (int k = 0; k < depth; k++) {
+            const int8_t *src_k = src + c * col_stride + k * depth_stride;
+            int i = 0;
+            for (; i < valid; i++) {
+                dst_c[k * pack + i] = src_k[i * col_stride];
+            }
+            for (; i < pack; i++) {
+                dst_c[k * pack + i] = 0;
             }
         }
-        if (left == 3) {
-            X86SgemvLeft<3, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
-        } else if (left == 2) {
-            X86SgemvLeft<2, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
-        } else if (left == 1) {
-            X86SgemvLeft<1, pack>(dst_batch + oc, src_batch, weight + oc * batch_stride, bias + oc, batch_stride);
+    }
+}
+
+template <typename VEC, int pack>
+void X86SgemvInt8(float *dst, const float *src, const int8_t *weight, const float *scale, const float *bias, int rows,
+                  int cols, int depth, const X86SgemvPlan &plan, float *workspace) {
+    X86SgemvCompute<VEC, pack, int8_t>(dst, src, weight, bias, scale, rows, cols, depth, plan, workspace);
+}
+template void X86SgemvInt8<Float4, 4>(float *dst, const float *src, const int8_t *weight, const float *scale,
+                                      const float *bias, int rows, int cols, int depth, const X86SgemvPlan &plan,
+                                      float *workspace);
+template void X86SgemvInt8<Float8, 8>(float *dst, const float *src, const int8_t *weight, const float *scale,
+                                      const float *bias, int rows, int cols, int depth, const X86SgemvPlan &plan,
+                                      float *workspace);
+
+static inline void X86Int8ToFloat(float *dst, const int8_t *src, float scale, long count) {
+    long i = 0;
+#ifdef __AVX2__
+    __m256 scale_v = _mm256_set1_ps(scale);
+    for (; i + 7 < count; i += 8) {
+        __m256i v = _mm256_cvtepi8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(src + i)));
+        _mm256_storeu_ps(dst + i, _mm256_mul_ps(_mm256_cvtepi32_ps(v), scale_v));
+    }
+#endif
+    for (; i < count; i++) {
+        dst[i] = scale * src[i];
+    }
+}
+
+static inline void X86PrefetchRow(const char *row, long bytes) {
+    for (long i = 0; i < bytes; i += 64) {
+        _mm_prefetch(row + i, _MM_HINT_T0);
+    }
+}
+
+/*
+rows of a large table are random accesses that miss every cache level, so the rows of the following indices
+are prefetched while the current one is copied, which keeps several dram requests in flight per thread.
+the indices are split into chunks of about 16KB of output, chunks are gathered in parallel.
+*/
+Status X86EmbeddingGather(float *dst, const void *table, DataType table_type, const float *row_scale, int rows,
+                          int row_size, const int *indices, int count) {
+    int ele_size = 0;
+    if (table_type == DATA_TYPE_FLOAT) {
+        ele_size = sizeof(float);
+    } else if (table_type == DATA_TYPE_HALF) {
+        ele_size = sizeof(uint16_t);
+    } else if (table_type == DATA_TYPE_INT8 && row_scale) {
+        ele_size = sizeof(int8_t);
+    } else {
+        LOGE("X86EmbeddingGather unsupported table data type %d\n", table_type);
+        return Status(TNNERR_PARAM_ERR, "X86EmbeddingGather unsupported table data type");
+    }
+    for (int i = 0; i < count; i++) {
+        if (indices[i] < -rows || indices[i] >= rows) {
+            LOGE("X86EmbeddingGather invalid index (%d) of %d rows\n", indices[i], rows);
+            return Status(TNNERR_MODEL_ERR, "X86EmbeddingGather invalid index");
         }
     }
+
+    const char *table_ptr = static_cast<const char *>(table);
+    const long row_bytes  = (long)row_size * ele_size;
+    // far enough to cover the dram latency, near enough that prefetched rows are not evicted before use
+    const int prefetch_distance = 8;
+    const int chunk             = MAX(16, UP_DIV(16 * 1024, row_size * (int)sizeof(float)));
+    const int chunk_count       = UP_DIV(count, chunk);
+
+    auto gather = [&](int begin, int end) {
+        auto row_of = [&](int i) { return indices[i] < 0 ? indices[i] + rows : indices[i]; };
+        for (int i = begin; i < MIN(begin + prefetch_distance, end); i++) {
+            X86PrefetchRow(table_ptr + row_of(i) * row_bytes, row_bytes);
+        }
+        for (int i = begin; i < end; i++) {
+            if (i + prefetch_distance < end) {
+                X86PrefetchRow(table_ptr + row_of(i + prefetch_distance) * row_bytes, row_bytes);
+            }
+            int row         = row_of(i);
+            const char *src = table_ptr + row * row_bytes;
+            float *dst_row  = dst + (long)i * row_size;
+            if (table_type == DATA_TYPE_FLOAT) {
+                memcpy(dst_row, src, row_bytes);
+            } else if (table_type == DATA_TYPE_HALF) {
+                X86HalfToFloat(dst_row, reinterpret_cast<const uint16_t *>(src), row_size);
+            } else {
+                X86Int8ToFloat(dst_row, reinterpret_cast<const int8_t *>(src), row_scale[row], row_size);
+            }
+        }
+    };
+
+    if (chunk_count == 1) {
+        gather(0, count);
+        return TNN_OK;
+    }
+    OMP_PARALLEL_FOR_
+    for (int c = 0; c < chunk_count; c++) {
+        gather(c * chunk, MIN(c * chunk + chunk, count));
+    }
+    return TNN_OK;
 }
-template void X86Sgemv<Float4, 4>(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output);
-template void X86Sgemv<Float8, 8>(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output);
 
 template <int activation_type, typename VEC, int pack>
 void X86_Post_Exec(float *dst, const float *bias, long channel, long area) {
@@ -63,8 +63,58 @@ template <int activation_type, typename VEC, int pack>
 void DepthwiseConv(float* dst, const float* src, const float* weight, const float* bias, long width, long src_w_step, long fw, long fh,
                    long dilate_x_step, long dilate_y_step, long height, long srcHStep, long dstHStep);
 
+// tiles of a gemv-like product dst[rows x cols] = src[rows x depth] * weight, one task per tile.
+// depth is only split when the output gives too few tiles, the partial sums are reduced afterwards.
+struct X86SgemvPlan {
+    int row_tile = 1;
+    int col_tile = 0;
+    int k_tile   = 0;
+};
+
+// choose the tiles from the shape and the number of threads
+X86SgemvPlan X86SgemvPartition(int rows, int cols, int depth, int pack, int num_threads);
+
+// bytes of workspace for the partial sums of plan, 0 if depth is not split
+size_t X86SgemvWorkspaceSize(const X86SgemvPlan &plan, int rows, int cols, int depth, int pack);
+
+// weight is packed by PackC4 / PackC8
 template <typename VEC, int pack>
-void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output);
+void X86Sgemv(float* dst, const float* src, const float* weight, float *bias, DimsVector dims_input, DimsVector dims_output,
+              const X86SgemvPlan &plan, float *workspace);
+
+// pack a row major [depth x cols] weight like PackC4 / PackC8 do, for X86Sgemv
+void X86SgemvPackRowMajor(float *dst, const float *src, int depth, int cols, int pack);
+
+// weight is a row major [depth x cols] matrix that is not packed, bias can be nullptr
+template <typename VEC, int pack>
+void X86SgemvRowMajor(float *dst, const float *src, const float *weight, const float *bias, int rows, int cols,
+                      int depth, const X86SgemvPlan &plan, float *workspace);
+
+// fp16 weights are converted with f16c inside the gemv loops, which halves the bytes streamed at batch 1
+bool X86HalfWeightSupported();
+
+// src holds raw fp16 bits
+void X86HalfToFloat(float *dst, const uint16_t *src, long count);
+
+// weight is fp16 packed by PackC8
+void X86SgemvHalf(float *dst, const float *src, const uint16_t *weight, float *bias, DimsVector dims_input,
+                  DimsVector dims_output, const X86SgemvPlan &plan, float *workspace);
+
+// pack an int8 [depth x cols] weight like X86SgemvPackRowMajor, element (k, c) is read from
+// src[c * col_stride + k * depth_stride]
+void X86SgemvPackInt8(int8_t *dst, const int8_t *src, int depth, int cols, int pack, long col_stride,
+                      long depth_stride);
+
+// weight is int8 packed by X86SgemvPackInt8 and dequantized while streaming, scale holds one factor per
+// column and is padded to a multiple of pack, bias can be nullptr
+template <typename VEC, int pack>
+void X86SgemvInt8(float *dst, const float *src, const int8_t *weight, const float *scale, const float *bias, int rows,
+                  int cols, int depth, const X86SgemvPlan &plan, float *workspace);
+
+// gather rows of a [rows x row_size] table into fp32 dst, negative indices count from the end.
+// table holds fp32, raw fp16 bits or int8 with one scale per row (row_scale).
+Status X86EmbeddingGather(float *dst, const void *table, DataType table_type, const float *row_scale, int rows,
+                          int row_size, const int *indices, int count);
 
 template <int activation_type, typename VEC, int pack>
 void X86_Post_Exec(float *dst, const float *bias, long channel, long area);
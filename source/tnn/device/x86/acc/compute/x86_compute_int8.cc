@@ -305,14 +305,68 @@ void X86SSEGemmInt8Unit4x4(const int8_t* src, const int8_t* weight, int8_t* dst,
     }
 }
 
+/*
+requant, activation and residual add of depthwise outputs, in the same order as the gemm kernels:
+relu == -1 is applied before the add, relu == 1 and relu == 2 (relu6) after it.
+add_input points to channel 0 of the output pixel, all other buffers are indexed by channel.
+*/
+static inline int8_t DepthwiseI8Requant(int32_t acc, long c, const float* scale, long relu, const int8_t* add_input,
+                                        const float* add_scale, const int8_t* relu6_max) {
+    float val = static_cast<float>(acc) * scale[c];
+    if (relu == -1) {
+        val = MAX(val, 0.f);
+    }
+    if (add_input) {
+        val += static_cast<float>(add_input[c]) * add_scale[c];
+    }
+    if (relu == 1) {
+        val = MAX(val, 0.f);
+    } else if (relu == 2) {
+        val = MIN(MAX(val, 0.f), static_cast<float>(relu6_max[c]));
+    }
+    return float2int8(val);
+}
+
+static inline void DepthwiseI8Store8(int8_t* dst, __m128i acc0, __m128i acc1, long dc, const float* scale, long relu,
+                                     const int8_t* add_input, const float* add_scale, const int8_t* relu6_max) {
+    DeclareRounding();
+    __m128 dst_4x32_0 = _mm_mul_ps(_mm_cvtepi32_ps(acc0), _mm_loadu_ps(scale + dc));
+    __m128 dst_4x32_1 = _mm_mul_ps(_mm_cvtepi32_ps(acc1), _mm_loadu_ps(scale + dc + 4));
+
+    if (relu == -1) {
+        dst_4x32_0 = _mm_max_ps(dst_4x32_0, zero_f32);
+        dst_4x32_1 = _mm_max_ps(dst_4x32_1, zero_f32);
+    }
+    if (add_input) {
+        __m128i add_vec   = _mm_loadl_epi64((__m128i*)(add_input + dc));
+        __m128 add_4x32_0 = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(add_vec));
+        __m128 add_4x32_1 = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_srli_si128(add_vec, 4)));
+        dst_4x32_0        = _mm_add_ps(dst_4x32_0, _mm_mul_ps(add_4x32_0, _mm_loadu_ps(add_scale + dc)));
+        dst_4x32_1        = _mm_add_ps(dst_4x32_1, _mm_mul_ps(add_4x32_1, _mm_loadu_ps(add_scale + dc + 4)));
+    }
+    if (relu == 1) {
+        dst_4x32_0 = _mm_max_ps(dst_4x32_0, zero_f32);
+        dst_4x32_1 = _mm_max_ps(dst_4x32_1, zero_f32);
+    } else if (relu == 2) {
+        __m128i relu6_vec = _mm_loadl_epi64((__m128i*)(relu6_max + dc));
+        __m128 relu6_0    = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(relu6_vec));
+        __m128 relu6_1    = _mm_cvtepi32_ps(_mm_cvtepi8_epi32(_mm_srli_si128(relu6_vec, 4)));
+        dst_4x32_0        = _mm_min_ps(_mm_max_ps(dst_4x32_0, zero_f32), relu6_0);
+        dst_4x32_1        = _mm_min_ps(_mm_max_ps(dst_4x32_1, zero_f32), relu6_1);
+    }
+
+    F32X8TOI8X8(dst_4x32_0, dst_4x32_1, (dst + dc));
+}
+
 static void DepthwiseI8K3Kernel(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z,
                                 long src_y_step, long src_w_step, long dst_depth, const float* scale_z,
-                                long dx, long dc) {
-    DeclareRounding();
+                                long dx, long dc, long relu, const int8_t* add_input, const float* add_scale,
+                                const int8_t* relu6_max) {
     __m128i zero_i8 = _mm_setzero_si128();
 
-    auto dst_x       = dst + dx * dst_depth + dc;
+    auto dst_x       = dst + dx * dst_depth;
     const auto src_z = src + dx * src_w_step + dc;
+    auto add_input_x = add_input ? add_input + dx * dst_depth : nullptr;
     __m128i bias_vec0 = _mm_loadu_si128((__m128i*)(bias_z + dc));
     __m128i bias_vec1 = _mm_loadu_si128((__m128i*)(bias_z + dc + 4));
 
@@ -355,25 +409,19 @@ static void DepthwiseI8K3Kernel(int8_t* dst, const int8_t* src, const int8_t* we
         bias_vec0 = _mm_add_epi32(bias_vec0, _mm_madd_epi16(w_16_20, src_16_20));
         bias_vec1 = _mm_add_epi32(bias_vec1, _mm_madd_epi16(w_16_21, src_16_21));
     }
-    __m128 scale_vec0 = _mm_loadu_ps(scale_z + dc);
-    __m128 scale_vec1 = _mm_loadu_ps(scale_z + dc + 4);
-
-    __m128 dst_4x32_0 = _mm_cvtepi32_ps(bias_vec0);
-    __m128 dst_4x32_1 = _mm_cvtepi32_ps(bias_vec1);
-    dst_4x32_0        = _mm_mul_ps(dst_4x32_0, scale_vec0);
-    dst_4x32_1        = _mm_mul_ps(dst_4x32_1, scale_vec1);
 
-    F32X8TOI8X8(dst_4x32_0, dst_4x32_1, dst_x);
+    DepthwiseI8Store8(dst_x, bias_vec0, bias_vec1, dc, scale_z, relu, add_input_x, add_scale, relu6_max);
 }
 
 void DepthwiseI8K5Kernel(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z,
                          long src_y_step, long src_w_step, long dst_depth, const float* scale_z,
-                         long dx, long dc) {
-    DeclareRounding();
+                         long dx, long dc, long relu, const int8_t* add_input, const float* add_scale,
+                         const int8_t* relu6_max) {
     __m128i zero_i8 = _mm_setzero_si128();
 
-    auto dst_x       = dst + dx * dst_depth + dc;
+    auto dst_x       = dst + dx * dst_depth;
     const auto src_z = src + dx * src_w_step + dc;
+    auto add_input_x = add_input ? add_input + dx * dst_depth : nullptr;
     __m128i bias_vec0 = _mm_loadu_si128((__m128i*)(bias_z + dc));
     __m128i bias_vec1 = _mm_loadu_si128((__m128i*)(bias_z + dc + 4));
 
@@ -437,51 +485,46 @@ void DepthwiseI8K5Kernel(int8_t* dst, const int8_t* src, const int8_t* weight, c
         bias_vec0 = _mm_add_epi32(bias_vec0, _mm_madd_epi16(w_16_40, src_16_40));
         bias_vec1 = _mm_add_epi32(bias_vec1, _mm_madd_epi16(w_16_41, src_16_41));
     }
-    __m128 scale_vec0 = _mm_loadu_ps(scale_z + dc);
-    __m128 scale_vec1 = _mm_loadu_ps(scale_z + dc + 4);
-
-    __m128 dst_4x32_0 = _mm_cvtepi32_ps(bias_vec0);
-    __m128 dst_4x32_1 = _mm_cvtepi32_ps(bias_vec1);
-    dst_4x32_0        = _mm_mul_ps(dst_4x32_0, scale_vec0);
-    dst_4x32_1        = _mm_mul_ps(dst_4x32_1, scale_vec1);
 
-    F32X8TOI8X8(dst_4x32_0, dst_4x32_1, dst_x);
+    DepthwiseI8Store8(dst_x, bias_vec0, bias_vec1, dc, scale_z, relu, add_input_x, add_scale, relu6_max);
 }
 
 void X86DepthwiseI8K3(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
                    long dilate_y_step, long dialte_x_step, long src_w_step, long dst_depth, long fw, long fh,
-                   const float* scale_z) {
+                   const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                   const int8_t* relu6_max) {
     // general k3 process, calc left dx
     for (long dx = 0; dx < width; dx++) {
         long dc = 0;
         for (; dc < dst_depth - 7; dc += 8) {
             DepthwiseI8K3Kernel(dst, src, weight, bias_z, dilate_y_step, src_w_step, dst_depth, scale_z,
-                                dx, dc);
+                                dx, dc, relu, add_input, add_scale, relu6_max);
         }
 
         if (dc < dst_depth) {
             dc = dst_depth - 8;
             DepthwiseI8K3Kernel(dst, src, weight, bias_z, dilate_y_step, src_w_step, dst_depth, scale_z,
-                                dx, dc);
+                                dx, dc, relu, add_input, add_scale, relu6_max);
         }
     }
 }
 
 void X86DepthwiseI8K5(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
                    long dilate_y_step, long dialte_x_step, long src_w_step, long dst_depth, long fw, long fh,
-                   const float* scale_z) {
+                   const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                   const int8_t* relu6_max) {
     // general k3 process, calc left dx
     for (long dx = 0; dx < width; dx++) {
         long dc = 0;
         for (; dc < dst_depth - 7; dc += 8) {
             DepthwiseI8K5Kernel(dst, src, weight, bias_z, dilate_y_step, src_w_step, dst_depth, scale_z,
-                                dx, dc);
+                                dx, dc, relu, add_input, add_scale, relu6_max);
         }
 
         if (dc < dst_depth) {
             dc = dst_depth - 8;
             DepthwiseI8K5Kernel(dst, src, weight, bias_z, dilate_y_step, src_w_step, dst_depth, scale_z,
-                                dx, dc);
+                                dx, dc, relu, add_input, add_scale, relu6_max);
         }
     }
 }
@@ -490,8 +533,8 @@ void X86DepthwiseI8K5(int8_t* dst, const int8_t* src, const int8_t* weight, cons
 convdw int8 kernel, used in corner process
 */
 void X86DepthwiseI8Unit(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias, long fw, long fh,
-                     long weight_y_step, long dilate_y_step, long dilate_x_step, const float* scale, long dst_depth) {
-    DeclareRounding();
+                     long weight_y_step, long dilate_y_step, long dilate_x_step, const float* scale, long dst_depth,
+                     long relu, const int8_t* add_input, const float* add_scale, const int8_t* relu6_max) {
     __m128i zero_i8 = _mm_setzero_si128();
     long dc = 0;
     for (; dc < dst_depth - 4; dc += 8) {
@@ -523,15 +566,8 @@ void X86DepthwiseI8Unit(int8_t* dst, const int8_t* src, const int8_t* weight, co
                 bias_vec1        = _mm_add_epi32(bias_vec1, dst_1);
             }
         }
-        __m128 scale_vec0 = _mm_loadu_ps(scale + dc);
-        __m128 scale_vec1 = _mm_loadu_ps(scale + dc + 4);
-
-        __m128 dst_4x32_0 = _mm_cvtepi32_ps(bias_vec0);
-        __m128 dst_4x32_1 = _mm_cvtepi32_ps(bias_vec1);
-        dst_4x32_0        = _mm_mul_ps(dst_4x32_0, scale_vec0);
-        dst_4x32_1        = _mm_mul_ps(dst_4x32_1, scale_vec1);
 
-        F32X8TOI8X8(dst_4x32_0, dst_4x32_1, (dst + dc));
+        DepthwiseI8Store8(dst, bias_vec0, bias_vec1, dc, scale, relu, add_input, add_scale, relu6_max);
     }
     for (; dc < dst_depth; dc += 4) {
         long dst_temp[4] = {0, 0, 0, 0};
@@ -547,7 +583,8 @@ void X86DepthwiseI8Unit(int8_t* dst, const int8_t* src, const int8_t* weight, co
             }
         }
         for (long i = 0; i < 4; ++i) {
-            dst[dc + i] = float2int8(static_cast<float>(dst_temp[i] + bias[dc + i]) * scale[dc + i]);
+            dst[dc + i] = DepthwiseI8Requant(dst_temp[i] + bias[dc + i], dc + i, scale, relu, add_input, add_scale,
+                                             relu6_max);
         }
     }
 }
@@ -557,15 +594,16 @@ general convdw int8 func
 */
 void X86DepthwiseI8General(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
                         long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth, long fw, long fh,
-                        const float* scale_z) {
-    DeclareRounding();
+                        const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                        const int8_t* relu6_max) {
     __m128i zero_i8 = _mm_setzero_si128();
 
     long dx, fx, fy;
     for (dx = 0; dx < width; ++dx) {
+        auto add_input_x = add_input ? add_input + dx * dst_depth : nullptr;
         long dc = 0;
         for (; dc < dst_depth - 4; dc += 8) {
-            auto dst_x       = dst + dx * dst_depth + dc;
+            auto dst_x       = dst + dx * dst_depth;
             const auto src_z = src + dx * src_w_step + dc;
             __m128i bias_vec0 = _mm_loadu_si128((__m128i*)(bias_z + dc));
             __m128i bias_vec1 = _mm_loadu_si128((__m128i*)(bias_z + dc + 4));
@@ -591,17 +629,11 @@ void X86DepthwiseI8General(int8_t* dst, const int8_t* src, const int8_t* weight,
                     bias_vec1        = _mm_add_epi32(bias_vec1, dst_1);
                 }
             }
-            __m128 scale_vec0 = _mm_loadu_ps(scale_z + dc);
-            __m128 scale_vec1 = _mm_loadu_ps(scale_z + dc + 4);
-            __m128 dst_4x32_0 = _mm_cvtepi32_ps(bias_vec0);
-            __m128 dst_4x32_1 = _mm_cvtepi32_ps(bias_vec1);
-            dst_4x32_0        = _mm_mul_ps(dst_4x32_0, scale_vec0);
-            dst_4x32_1        = _mm_mul_ps(dst_4x32_1, scale_vec1);
-
-            F32X8TOI8X8(dst_4x32_0, dst_4x32_1, dst_x);
+
+            DepthwiseI8Store8(dst_x, bias_vec0, bias_vec1, dc, scale_z, relu, add_input_x, add_scale, relu6_max);
         }
         for (; dc < dst_depth; dc += 4) {
-            auto dst_x          = dst + dx * dst_depth + dc;
+            auto dst_x          = dst + dx * dst_depth;
             const auto src_z    = src + dx * src_w_step + dc;
             int32_t dstInt32[4] = {0, 0, 0, 0};
             for (fy = 0; fy < fh; ++fy) {
@@ -617,12 +649,178 @@ void X86DepthwiseI8General(int8_t* dst, const int8_t* src, const int8_t* weight,
             }
 
             for (long i = 0; i < 4; ++i) {
-                dst_x[i] = float2int8(static_cast<float>(dstInt32[i] + bias_z[i + dc]) * scale_z[i + dc]);
+                dst_x[dc + i] = DepthwiseI8Requant(dstInt32[i] + bias_z[i + dc], dc + i, scale_z, relu, add_input_x,
+                                                   add_scale, relu6_max);
+            }
+        }
+    }
+}
+
+#ifdef __AVX2__
+/*
+avx2 version of DepthwiseI8Store8, 16 channels at dc
+*/
+static inline void X86AVXDepthwiseI8Store16(int8_t* dst, __m256i acc0, __m256i acc1, long dc, const float* scale,
+                                            long relu, const int8_t* add_input, const float* add_scale,
+                                            const int8_t* relu6_max) {
+    __m256 zero_f32   = _mm256_setzero_ps();
+    __m256 dst_8x32_0 = _mm256_mul_ps(_mm256_cvtepi32_ps(acc0), _mm256_loadu_ps(scale + dc));
+    __m256 dst_8x32_1 = _mm256_mul_ps(_mm256_cvtepi32_ps(acc1), _mm256_loadu_ps(scale + dc + 8));
+
+    if (relu == -1) {
+        dst_8x32_0 = _mm256_max_ps(dst_8x32_0, zero_f32);
+        dst_8x32_1 = _mm256_max_ps(dst_8x32_1, zero_f32);
+    }
+    if (add_input) {
+        __m128i add_vec   = _mm_loadu_si128((__m128i*)(add_input + dc));
+        __m256 add_8x32_0 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(add_vec));
+        __m256 add_8x32_1 = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(add_vec, 8)));
+        dst_8x32_0 = _mm256_add_ps(dst_8x32_0, _mm256_mul_ps(add_8x32_0, _mm256_loadu_ps(add_scale + dc)));
+        dst_8x32_1 = _mm256_add_ps(dst_8x32_1, _mm256_mul_ps(add_8x32_1, _mm256_loadu_ps(add_scale + dc + 8)));
+    }
+    if (relu == 1) {
+        dst_8x32_0 = _mm256_max_ps(dst_8x32_0, zero_f32);
+        dst_8x32_1 = _mm256_max_ps(dst_8x32_1, zero_f32);
+    } else if (relu == 2) {
+        __m128i relu6_vec = _mm_loadu_si128((__m128i*)(relu6_max + dc));
+        __m256 relu6_0    = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(relu6_vec));
+        __m256 relu6_1    = _mm256_cvtepi32_ps(_mm256_cvtepi8_epi32(_mm_srli_si128(relu6_vec, 8)));
+        dst_8x32_0        = _mm256_min_ps(_mm256_max_ps(dst_8x32_0, zero_f32), relu6_0);
+        dst_8x32_1        = _mm256_min_ps(_mm256_max_ps(dst_8x32_1, zero_f32), relu6_1);
+    }
+
+    // rounding to nearest ties away from zero, as F32X4TOI8X4
+    __m256 add_05     = _mm256_set1_ps(0.5f);
+    __m256 sub_05     = _mm256_set1_ps(-0.5f);
+    dst_8x32_0 = _mm256_add_ps(dst_8x32_0,
+                               _mm256_blendv_ps(sub_05, add_05, _mm256_cmp_ps(dst_8x32_0, zero_f32, _CMP_GE_OQ)));
+    dst_8x32_1 = _mm256_add_ps(dst_8x32_1,
+                               _mm256_blendv_ps(sub_05, add_05, _mm256_cmp_ps(dst_8x32_1, zero_f32, _CMP_GE_OQ)));
+    // packs works in 128-bit lanes, [c0-3, c8-11, c4-7, c12-15] -> [c0-3, c4-7, c8-11, c12-15]
+    __m256i dst_i16x16 = _mm256_packs_epi32(_mm256_cvttps_epi32(dst_8x32_0), _mm256_cvttps_epi32(dst_8x32_1));
+    dst_i16x16         = _mm256_permute4x64_epi64(dst_i16x16, 0xD8);
+    __m128i dst_i8x16  = _mm_packs_epi16(_mm256_castsi256_si128(dst_i16x16), _mm256_extracti128_si256(dst_i16x16, 1));
+    _mm_storeu_si128((__m128i*)(dst + dc), dst_i8x16);
+}
+
+/*
+16 channels of one convdw output, taps are taken in pairs so that one madd
+sums two of them, the int32 results come out in the order of the unpacks:
+acc_lo = [c0-3, c8-11], acc_hi = [c4-7, c12-15]
+*/
+static inline void X86AVXDepthwiseI8Kernel16(int8_t* dst, const int8_t* src, const int8_t* weight,
+                                             const int32_t* bias, long fw, long fh, long weight_y_step,
+                                             long dilate_y_step, long dilate_x_step, const float* scale,
+                                             long dst_depth, long dc, long relu, const int8_t* add_input,
+                                             const float* add_scale, const int8_t* relu6_max) {
+    __m256i acc_lo    = _mm256_setzero_si256();
+    __m256i acc_hi    = _mm256_setzero_si256();
+    __m256i src_first = _mm256_setzero_si256();
+    __m256i w_first   = _mm256_setzero_si256();
+    bool has_first    = false;
+
+    for (long fy = 0; fy < fh; ++fy) {
+        const auto src_y    = src + fy * dilate_y_step + dc;
+        const auto weight_y = weight + fy * weight_y_step + dc;
+        for (long fx = 0; fx < fw; ++fx) {
+            __m256i src_16 = _mm256_cvtepi8_epi16(_mm_loadu_si128((__m128i*)(src_y + fx * dilate_x_step)));
+            __m256i w_16   = _mm256_cvtepi8_epi16(_mm_loadu_si128((__m128i*)(weight_y + fx * dst_depth)));
+            if (!has_first) {
+                src_first = src_16;
+                w_first   = w_16;
+                has_first = true;
+                continue;
             }
+            acc_lo = _mm256_add_epi32(acc_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(src_first, src_16),
+                                                                _mm256_unpacklo_epi16(w_first, w_16)));
+            acc_hi = _mm256_add_epi32(acc_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(src_first, src_16),
+                                                                _mm256_unpackhi_epi16(w_first, w_16)));
+            has_first = false;
         }
     }
+    if (has_first) {
+        __m256i zero_i16 = _mm256_setzero_si256();
+        acc_lo = _mm256_add_epi32(acc_lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(src_first, zero_i16),
+                                                            _mm256_unpacklo_epi16(w_first, zero_i16)));
+        acc_hi = _mm256_add_epi32(acc_hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(src_first, zero_i16),
+                                                            _mm256_unpackhi_epi16(w_first, zero_i16)));
+    }
+
+    __m256i acc0 = _mm256_add_epi32(_mm256_permute2x128_si256(acc_lo, acc_hi, 0x20),
+                                    _mm256_loadu_si256((__m256i*)(bias + dc)));
+    __m256i acc1 = _mm256_add_epi32(_mm256_permute2x128_si256(acc_lo, acc_hi, 0x31),
+                                    _mm256_loadu_si256((__m256i*)(bias + dc + 8)));
+    X86AVXDepthwiseI8Store16(dst, acc0, acc1, dc, scale, relu, add_input, add_scale, relu6_max);
+}
+
+// all channels of one convdw output, the last block overlaps the previous one if dst_depth % 16 != 0
+static inline void X86AVXDepthwiseI8Pixel(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias,
+                                          long fw, long fh, long weight_y_step, long dilate_y_step,
+                                          long dilate_x_step, const float* scale, long dst_depth, long relu,
+                                          const int8_t* add_input, const float* add_scale,
+                                          const int8_t* relu6_max) {
+    long dc = 0;
+    for (; dc + 15 < dst_depth; dc += 16) {
+        X86AVXDepthwiseI8Kernel16(dst, src, weight, bias, fw, fh, weight_y_step, dilate_y_step, dilate_x_step,
+                                  scale, dst_depth, dc, relu, add_input, add_scale, relu6_max);
+    }
+    if (dc < dst_depth) {
+        X86AVXDepthwiseI8Kernel16(dst, src, weight, bias, fw, fh, weight_y_step, dilate_y_step, dilate_x_step,
+                                  scale, dst_depth, dst_depth - 16, relu, add_input, add_scale, relu6_max);
+    }
+}
+
+// kernel > 0 fixes fw and fh at compile time
+template <long kernel>
+static void X86AVXDepthwiseI8Row(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z,
+                                 long width, long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth,
+                                 long fw, long fh, const float* scale_z, long relu, const int8_t* add_input,
+                                 const float* add_scale, const int8_t* relu6_max) {
+    if (kernel > 0) {
+        fw = kernel;
+        fh = kernel;
+    }
+    for (long dx = 0; dx < width; ++dx) {
+        auto add_input_x = add_input ? add_input + dx * dst_depth : nullptr;
+        X86AVXDepthwiseI8Pixel(dst + dx * dst_depth, src + dx * src_w_step, weight, bias_z, fw, fh, fw * dst_depth,
+                               dilate_y_step, dilate_x_step, scale_z, dst_depth, relu, add_input_x, add_scale,
+                               relu6_max);
+    }
+}
+
+void X86AVXDepthwiseI8Unit(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias, long fw,
+                           long fh, long weight_y_step, long dilate_y_step, long dilate_x_step, const float* scale,
+                           long dst_depth, long relu, const int8_t* add_input, const float* add_scale,
+                           const int8_t* relu6_max) {
+    X86AVXDepthwiseI8Pixel(dst, src, weight, bias, fw, fh, weight_y_step, dilate_y_step, dilate_x_step, scale,
+                           dst_depth, relu, add_input, add_scale, relu6_max);
+}
+
+void X86AVXDepthwiseI8General(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z,
+                              long width, long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth,
+                              long fw, long fh, const float* scale_z, long relu, const int8_t* add_input,
+                              const float* add_scale, const int8_t* relu6_max) {
+    X86AVXDepthwiseI8Row<0>(dst, src, weight, bias_z, width, dilate_y_step, dilate_x_step, src_w_step, dst_depth, fw,
+                            fh, scale_z, relu, add_input, add_scale, relu6_max);
+}
+
+void X86AVXDepthwiseI8K3(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
+                         long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth, long fw, long fh,
+                         const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                         const int8_t* relu6_max) {
+    X86AVXDepthwiseI8Row<3>(dst, src, weight, bias_z, width, dilate_y_step, dilate_x_step, src_w_step, dst_depth, fw,
+                            fh, scale_z, relu, add_input, add_scale, relu6_max);
 }
 
+void X86AVXDepthwiseI8K5(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
+                         long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth, long fw, long fh,
+                         const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                         const int8_t* relu6_max) {
+    X86AVXDepthwiseI8Row<5>(dst, src, weight, bias_z, width, dilate_y_step, dilate_x_step, src_w_step, dst_depth, fw,
+                            fh, scale_z, relu, add_input, add_scale, relu6_max);
+}
+#endif
+
 void X86ReluInt8(int8_t* dst, const int8_t* src, long len) {
     __m128i zero_i8 = _mm_setzero_si128();
     long idx = len - len % 16;
@@ -789,6 +987,79 @@ void X86AvgPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow
     }
 }
 
+#ifdef __AVX2__
+/*
+avx2 int8 pooling, 32 channels per max and 16 channels per avg step, the last step
+overlaps the previous one if c_r4 is not a multiple of it. avg sums are kept in int32
+*/
+void X86AVXMaxPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow, long oh, long c_r4, long kw,
+                          long kh, long stride_w, long stride_h, long pad_w, long pad_h) {
+    OMP_PARALLEL_FOR_COLLAPSE_(2)
+    for (long oy = 0; oy < oh; ++oy) {
+        for (long ox = 0; ox < ow; ++ox) {
+            const long srcOriginX = ox * stride_w - pad_w;
+            const long srcOriginY = oy * stride_h - pad_h;
+            const long kxs        = MAX(0, -srcOriginX);
+            const long kxe        = MIN(kw, iw - srcOriginX);
+            const long kys        = MAX(0, -srcOriginY);
+            const long kye        = MIN(kh, ih - srcOriginY);
+
+            for (long oc = 0; oc < c_r4; oc += 32) {
+                oc                 = MIN(oc, c_r4 - 32);
+                const auto src_ptr = src + (srcOriginY * iw + srcOriginX) * c_r4 + oc;
+                auto dst_ptr       = dst + (oy * ow + ox) * c_r4 + oc;
+                __m256i max_reg    = _mm256_set1_epi8(-127);
+                for (long ky = kys; ky < kye; ++ky) {
+                    const auto src_ptr_h = src_ptr + (ky * iw) * c_r4;
+                    for (long kx = kxs; kx < kxe; kx++) {
+                        max_reg = _mm256_max_epi8(max_reg, _mm256_loadu_si256((__m256i*)(src_ptr_h + kx * c_r4)));
+                    }
+                }
+                _mm256_storeu_si256((__m256i*)dst_ptr, max_reg);
+            }
+        }
+    }
+}
+
+void X86AVXAvgPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow, long oh, long c_r4, long kw,
+                          long kh, long stride_w, long stride_h, long pad_w, long pad_h) {
+    OMP_PARALLEL_FOR_COLLAPSE_(2)
+    for (long oy = 0; oy < oh; ++oy) {
+        for (long ox = 0; ox < ow; ++ox) {
+            const long srcOriginX   = ox * stride_w - pad_w;
+            const long srcOriginY   = oy * stride_h - pad_h;
+            const long kxs          = MAX(0, -srcOriginX);
+            const long kxe          = MIN(kw, iw - srcOriginX);
+            const long kys          = MAX(0, -srcOriginY);
+            const long kye          = MIN(kh, ih - srcOriginY);
+            const long kernel_count = (kxe - kxs) * (kye - kys);
+            __m256 div_vec          = _mm256_set1_ps((float)kernel_count);
+
+            for (long oc = 0; oc < c_r4; oc += 16) {
+                oc                 = MIN(oc, c_r4 - 16);
+                const auto src_ptr = src + (srcOriginY * iw + srcOriginX) * c_r4 + oc;
+                auto dst_ptr       = dst + (oy * ow + ox) * c_r4 + oc;
+                __m256i sum_0      = _mm256_setzero_si256();
+                __m256i sum_1      = _mm256_setzero_si256();
+                for (long ky = kys; ky < kye; ++ky) {
+                    const auto src_ptr_h = src_ptr + (ky * iw) * c_r4;
+                    for (long kx = kxs; kx < kxe; kx++) {
+                        __m128i cur_val = _mm_loadu_si128((__m128i*)(src_ptr_h + kx * c_r4));
+                        sum_0           = _mm256_add_epi32(sum_0, _mm256_cvtepi8_epi32(cur_val));
+                        sum_1           = _mm256_add_epi32(sum_1, _mm256_cvtepi8_epi32(_mm_srli_si128(cur_val, 8)));
+                    }
+                }
+                __m256i avg_0     = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(sum_0), div_vec));
+                __m256i avg_1     = _mm256_cvttps_epi32(_mm256_div_ps(_mm256_cvtepi32_ps(sum_1), div_vec));
+                __m256i i16x16    = _mm256_permute4x64_epi64(_mm256_packs_epi32(avg_0, avg_1), 0xD8);
+                __m128i i8x16     = _mm_packs_epi16(_mm256_castsi256_si128(i16x16), _mm256_extracti128_si256(i16x16, 1));
+                _mm_storeu_si128((__m128i*)dst_ptr, i8x16);
+            }
+        }
+    }
+}
+#endif
+
 /*
 element add int8 func
 */
@@ -1130,16 +1401,14 @@ void X86UpsampleNearest2D(int8_t *output_data, const int8_t *input_data,
     auto src_y_step = iw * c_r4;
     auto dst_y_step = ow * c_r4;
 
-    const float height_scale = (float)ih / (float)oh;
-    const float width_scale  = (float)iw / (float)ow;
-
+    // source indices in integers, -ffast-math approximates vectorized float division
     OMP_PARALLEL_FOR_GUIDED_
     for (int h = 0; h < oh; h++) {
-        int scale_h = static_cast<int>(h * height_scale);
+        int scale_h = h * ih / oh;
         auto dst_y  = output_data + h * dst_y_step;
         auto src_y  = input_data + scale_h * src_y_step;
         for (int w = 0; w < ow; w++) {
-            int scale_w = static_cast<int>(w * width_scale);
+            int scale_w = w * iw / ow;
             auto dst_x  = dst_y + w * c_r4;
             auto src_x  = src_y + scale_w * c_r4;
             if (!do_scale) {
@@ -1317,4 +1586,150 @@ void X86FloatToInt8(int8_t* dst, const float* src, const float* scale, long batc
     }
 }
 
+void X86QuantizeRowsInt8(int8_t* dst, float* scale, const float* src, long rows, long k, long k_r32) {
+    OMP_PARALLEL_FOR_GUIDED_
+    for (long r = 0; r < rows; ++r) {
+        const float* src_r = src + r * k;
+        int8_t* dst_r      = dst + r * k_r32;
+
+        __m128 sign_mask = _mm_set1_ps(-0.f);
+        __m128 max_vec   = _mm_setzero_ps();
+        long i           = 0;
+        for (; i + 3 < k; i += 4) {
+            max_vec = _mm_max_ps(max_vec, _mm_andnot_ps(sign_mask, _mm_loadu_ps(src_r + i)));
+        }
+        max_vec = _mm_max_ps(max_vec, _mm_movehl_ps(max_vec, max_vec));
+        max_vec = _mm_max_ss(max_vec, _mm_shuffle_ps(max_vec, max_vec, 1));
+        float max_abs = _mm_cvtss_f32(max_vec);
+        for (; i < k; ++i) {
+            max_abs = std::max(max_abs, std::fabs(src_r[i]));
+        }
+
+        scale[r]        = max_abs / 127.f;
+        const float inv = max_abs > 0.f ? 127.f / max_abs : 0.f;
+        __m128 inv_vec  = _mm_set1_ps(inv);
+        for (i = 0; i + 7 < k; i += 8) {
+            __m128i lo  = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src_r + i), inv_vec));
+            __m128i hi  = _mm_cvtps_epi32(_mm_mul_ps(_mm_loadu_ps(src_r + i + 4), inv_vec));
+            __m128i i16 = _mm_packs_epi32(lo, hi);
+            _mm_storel_epi64((__m128i*)(dst_r + i), _mm_packs_epi16(i16, i16));
+        }
+        for (; i < k; ++i) {
+            dst_r[i] = static_cast<int8_t>(std::nearbyint(src_r[i] * inv));
+        }
+        memset(dst_r + k, 0, k_r32 - k);
+    }
+}
+
+// int32 dot products of rows of src with 4 rows of weight, sums[i] holds the 4 results of src row i.
+// maddubs needs an unsigned operand, so |a| is multiplied by w with the sign of a moved onto it;
+// |a| <= 127 keeps the pairwise int16 sums far from saturation.
+template <int rows>
+static inline void X86DynamicInt8Dot(const int8_t* src, const int8_t* weight, long k_r32, __m128i* sums) {
+#ifdef __AVX2__
+    const __m256i ones = _mm256_set1_epi16(1);
+    __m256i acc[rows][4];
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            acc[i][j] = _mm256_setzero_si256();
+        }
+    }
+    for (long c = 0; c < k_r32; c += 32) {
+        __m256i a[rows], abs_a[rows];
+        for (int i = 0; i < rows; ++i) {
+            a[i]     = _mm256_loadu_si256((const __m256i*)(src + i * k_r32 + c));
+            abs_a[i] = _mm256_abs_epi8(a[i]);
+        }
+        for (int j = 0; j < 4; ++j) {
+            __m256i w = _mm256_loadu_si256((const __m256i*)(weight + j * k_r32 + c));
+            for (int i = 0; i < rows; ++i) {
+                __m256i prod = _mm256_maddubs_epi16(abs_a[i], _mm256_sign_epi8(w, a[i]));
+                acc[i][j]    = _mm256_add_epi32(acc[i][j], _mm256_madd_epi16(prod, ones));
+            }
+        }
+    }
+    for (int i = 0; i < rows; ++i) {
+        __m256i s01 = _mm256_hadd_epi32(acc[i][0], acc[i][1]);
+        __m256i s23 = _mm256_hadd_epi32(acc[i][2], acc[i][3]);
+        __m256i s   = _mm256_hadd_epi32(s01, s23);
+        sums[i]     = _mm_add_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+    }
+#else
+    const __m128i ones = _mm_set1_epi16(1);
+    __m128i acc[rows][4];
+    for (int i = 0; i < rows; ++i) {
+        for (int j = 0; j < 4; ++j) {
+            acc[i][j] = _mm_setzero_si128();
+        }
+    }
+    for (long c = 0; c < k_r32; c += 16) {
+        __m128i a[rows], abs_a[rows];
+        for (int i = 0; i < rows; ++i) {
+            a[i]     = _mm_loadu_si128((const __m128i*)(src + i * k_r32 + c));
+            abs_a[i] = _mm_abs_epi8(a[i]);
+        }
+        for (int j = 0; j < 4; ++j) {
+            __m128i w = _mm_loadu_si128((const __m128i*)(weight + j * k_r32 + c));
+            for (int i = 0; i < rows; ++i) {
+                __m128i prod = _mm_maddubs_epi16(abs_a[i], _mm_sign_epi8(w, a[i]));
+                acc[i][j]    = _mm_add_epi32(acc[i][j], _mm_madd_epi16(prod, ones));
+            }
+        }
+    }
+    for (int i = 0; i < rows; ++i) {
+        __m128i s01 = _mm_hadd_epi32(acc[i][0], acc[i][1]);
+        __m128i s23 = _mm_hadd_epi32(acc[i][2], acc[i][3]);
+        sums[i]     = _mm_hadd_epi32(s01, s23);
+    }
+#endif
+}
+
+static inline void X86DynamicInt8Store(float* dst, __m128i sum, float src_scale, __m128 weight_scale, __m128 bias,
+                                       long count) {
+    __m128 scale = _mm_mul_ps(weight_scale, _mm_set1_ps(src_scale));
+    __m128 value = _mm_add_ps(_mm_mul_ps(_mm_cvtepi32_ps(sum), scale), bias);
+    if (count >= 4) {
+        _mm_storeu_ps(dst, value);
+    } else {
+        float tmp[4];
+        _mm_storeu_ps(tmp, value);
+        for (long i = 0; i < count; ++i) {
+            dst[i] = tmp[i];
+        }
+    }
+}
+
+void X86DynamicGemmInt8(float* dst, const int8_t* src, const float* src_scale, const int8_t* weight,
+                        const float* weight_scale, const float* bias, long m, long n, long k_r32, long ldc) {
+    // a tile of rows is reused from l1 for every 4 output channels
+    const long row_tile = 16;
+    const long m_tiles  = UP_DIV(m, row_tile);
+    const long n_blocks = UP_DIV(n, 4);
+
+    OMP_PARALLEL_FOR_COLLAPSE_(2)
+    for (long mt = 0; mt < m_tiles; ++mt) {
+        for (long nb = 0; nb < n_blocks; ++nb) {
+            const long nc        = nb * 4;
+            const int8_t* w      = weight + nc * k_r32;
+            __m128 w_scale       = _mm_loadu_ps(weight_scale + nc);
+            __m128 bias_vec      = bias ? _mm_loadu_ps(bias + nc) : _mm_setzero_ps();
+            const long row_end   = std::min(m, (mt + 1) * row_tile);
+            const long col_count = n - nc;
+            __m128i sums[2];
+
+            long r = mt * row_tile;
+            for (; r + 1 < row_end; r += 2) {
+                X86DynamicInt8Dot<2>(src + r * k_r32, w, k_r32, sums);
+                X86DynamicInt8Store(dst + r * ldc + nc, sums[0], src_scale[r], w_scale, bias_vec, col_count);
+                X86DynamicInt8Store(dst + (r + 1) * ldc + nc, sums[1], src_scale[r + 1], w_scale, bias_vec,
+                                    col_count);
+            }
+            if (r < row_end) {
+                X86DynamicInt8Dot<1>(src + r * k_r32, w, k_r32, sums);
+                X86DynamicInt8Store(dst + r * ldc + nc, sums[0], src_scale[r], w_scale, bias_vec, col_count);
+            }
+        }
+    }
+}
+
 }   // namespace TNN_NS
@@ -32,20 +32,49 @@ void X86SSEGemmInt8Unit4x4(const int8_t* src, const int8_t* weight, int8_t* dst,
                      const float* scale, const int32_t* bias, long relu, const int8_t* add_input,
                      const float* add_scale, const int8_t* relu6_max);
 
+// convdw int8 kernels with the requant epilogue fused, relu follows X86SSEGemmInt8Unit4x4:
+// -1 relu before the add, 1 relu, 2 relu6 clamped to relu6_max. add_input has the layout of dst and may be null
 void X86DepthwiseI8Unit(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias, long fw, long fh,
-                     long weight_y_step, long dilate_y_step, long dilate_x_step, const float* scale, long dst_depth);
+                     long weight_y_step, long dilate_y_step, long dilate_x_step, const float* scale, long dst_depth,
+                     long relu, const int8_t* add_input, const float* add_scale, const int8_t* relu6_max);
 
 void X86DepthwiseI8General(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
                         long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth, long fw, long fh,
-                        const float* scale_z);
+                        const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                        const int8_t* relu6_max);
 
 void X86DepthwiseI8K3(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
                    long dilate_y_step, long dialte_x_step, long src_w_step, long dst_depth, long fw, long fh,
-                   const float* scale_z);
+                   const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                   const int8_t* relu6_max);
 
 void X86DepthwiseI8K5(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
                    long dilate_y_step, long dialte_x_step, long src_w_step, long dst_depth, long fw, long fh,
-                   const float* scale_z);
+                   const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                   const int8_t* relu6_max);
+
+#ifdef __AVX2__
+// 16 channels per step, dst_depth must be at least 16
+void X86AVXDepthwiseI8Unit(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias, long fw,
+                           long fh, long weight_y_step, long dilate_y_step, long dilate_x_step, const float* scale,
+                           long dst_depth, long relu, const int8_t* add_input, const float* add_scale,
+                           const int8_t* relu6_max);
+
+void X86AVXDepthwiseI8General(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z,
+                              long width, long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth,
+                              long fw, long fh, const float* scale_z, long relu, const int8_t* add_input,
+                              const float* add_scale, const int8_t* relu6_max);
+
+void X86AVXDepthwiseI8K3(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
+                         long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth, long fw, long fh,
+                         const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                         const int8_t* relu6_max);
+
+void X86AVXDepthwiseI8K5(int8_t* dst, const int8_t* src, const int8_t* weight, const int32_t* bias_z, long width,
+                         long dilate_y_step, long dilate_x_step, long src_w_step, long dst_depth, long fw, long fh,
+                         const float* scale_z, long relu, const int8_t* add_input, const float* add_scale,
+                         const int8_t* relu6_max);
+#endif
 
 void X86ReluInt8(int8_t* dst, const int8_t* src, long len);
 void X86Relu6Int8(int8_t* dst, const int8_t* src, const int8_t* relu6_max, long width, long dst_depth);
@@ -56,6 +85,15 @@ void X86MaxPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow
 void X86AvgPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow, long oh, long c_r4, long kw, long kh,
                     long stride_w, long stride_h, long pad_w, long pad_h);
 
+#ifdef __AVX2__
+// c_r4 must be at least 32 for max and 16 for avg pooling
+void X86AVXMaxPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow, long oh, long c_r4, long kw,
+                          long kh, long stride_w, long stride_h, long pad_w, long pad_h);
+
+void X86AVXAvgPoolingINT8(const int8_t* src, long iw, long ih, int8_t* dst, long ow, long oh, long c_r4, long kw,
+                          long kh, long stride_w, long stride_h, long pad_w, long pad_h);
+#endif
+
 void X86MatrixAddInt8(int8_t* dst, const int8_t* A, const int8_t* B, float* dst_scale, const float* a_scale,
                    float* b_scale, long channel, long hw_size);
 
@@ -77,6 +115,16 @@ void X86UpsampleBilinear2D(int8_t *output_data, const int8_t *input_data,
 void X86Int8ToFloat(float* dst, const int8_t* src, const float* scale, long batch, long channel, long hw);
 void X86FloatToInt8(int8_t* dst, const float* src, const float* scale, long batch, long channel, long hw);
 
+// dynamic int8 gemm of float activations and int8 weights, used by matmul and inner product.
+// the activations are quantized symmetrically per row at runtime, the weights per output channel.
+// rows of dst of X86QuantizeRowsInt8 are k_r32 long and zero padded, scale gets max(|row|) / 127
+void X86QuantizeRowsInt8(int8_t* dst, float* scale, const float* src, long rows, long k, long k_r32);
+
+// dst[m][n] = sum(src[m][:] * weight[n][:]) * src_scale[m] * weight_scale[n] + bias[n], bias may be null.
+// weight holds n_r4 zero padded rows of k_r32 int8, dst rows are ldc apart
+void X86DynamicGemmInt8(float* dst, const int8_t* src, const float* src_scale, const int8_t* weight,
+                        const float* weight_scale, const float* bias, long m, long n, long k_r32, long ldc);
+
 }   // namespace TNN_NS
 
 #endif
@@ -0,0 +1,275 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/device/x86/acc/compute/x86_mat_util_avx2.h"
+
+#include <immintrin.h>
+
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
+
+namespace TNN_NS {
+
+#ifdef __AVX2__
+
+static bool& MatUtilAVX2Flag() {
+    static bool enabled = cpu_with_isa(avx2);
+    return enabled;
+}
+
+bool X86MatUtilAVX2Enabled() {
+    return MatUtilAVX2Flag();
+}
+
+void X86MatUtilSetAVX2Enabled(bool enabled) {
+    MatUtilAVX2Flag() = enabled && cpu_with_isa(avx2);
+}
+
+// bbbb, gggg, rrrr to bgr,bgr,bgr,bgr for 16 pixels
+static inline void StoreBGR16(uint8_t* dst, __m128i bb, __m128i gg, __m128i rr) {
+    const __m128i sh_a = _mm_setr_epi8(0, 11, 6, 1, 12, 7, 2, 13, 8, 3, 14, 9, 4, 15, 10, 5);
+    const __m128i sh_b = _mm_setr_epi8(5, 0, 11, 6, 1, 12, 7, 2, 13, 8, 3, 14, 9, 4, 15, 10);
+    const __m128i sh_c = _mm_setr_epi8(10, 5, 0, 11, 6, 1, 12, 7, 2, 13, 8, 3, 14, 9, 4, 15);
+    const __m128i m0   = _mm_setr_epi8(0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0);
+    const __m128i m1   = _mm_setr_epi8(0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0);
+
+    __m128i a = _mm_shuffle_epi8(bb, sh_a);
+    __m128i b = _mm_shuffle_epi8(gg, sh_b);
+    __m128i c = _mm_shuffle_epi8(rr, sh_c);
+
+    _mm_storeu_si128((__m128i*)dst, _mm_blendv_epi8(_mm_blendv_epi8(a, b, m1), c, m0));
+    _mm_storeu_si128((__m128i*)(dst + 16), _mm_blendv_epi8(_mm_blendv_epi8(b, c, m1), a, m0));
+    _mm_storeu_si128((__m128i*)(dst + 32), _mm_blendv_epi8(_mm_blendv_epi8(c, a, m1), b, m0));
+}
+
+// bbbb, gggg, rrrr, aaaa to bgra,bgra,bgra,bgra for 32 pixels
+static inline void StoreBGRA32(uint8_t* dst, __m256i bb, __m256i gg, __m256i rr, __m256i aa) {
+    // unpack works in 128-bit lanes: res0 holds pixel 0-3 | 16-19, res1 4-7 | 20-23, ...
+    __m256i bg_lo = _mm256_unpacklo_epi8(bb, gg);
+    __m256i ra_lo = _mm256_unpacklo_epi8(rr, aa);
+    __m256i bg_hi = _mm256_unpackhi_epi8(bb, gg);
+    __m256i ra_hi = _mm256_unpackhi_epi8(rr, aa);
+    __m256i res0  = _mm256_unpacklo_epi16(bg_lo, ra_lo);
+    __m256i res1  = _mm256_unpackhi_epi16(bg_lo, ra_lo);
+    __m256i res2  = _mm256_unpacklo_epi16(bg_hi, ra_hi);
+    __m256i res3  = _mm256_unpackhi_epi16(bg_hi, ra_hi);
+
+    _mm256_storeu_si256((__m256i*)dst, _mm256_permute2x128_si256(res0, res1, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 32), _mm256_permute2x128_si256(res2, res3, 0x20));
+    _mm256_storeu_si256((__m256i*)(dst + 64), _mm256_permute2x128_si256(res0, res1, 0x31));
+    _mm256_storeu_si256((__m256i*)(dst + 96), _mm256_permute2x128_si256(res2, res3, 0x31));
+}
+
+// >> 6 and saturate 2 x 16 shorts to 32 bytes in pixel order
+static inline __m256i YUVPackU8(__m256i lo, __m256i hi) {
+    __m256i packed = _mm256_packus_epi16(_mm256_srai_epi16(lo, 6), _mm256_srai_epi16(hi, 6));
+    return _mm256_permute4x64_epi64(packed, 0xD8);
+}
+
+// same fixed point formula as the sse4.2 YUVToBGR in x86_mat_util.cc
+int X86YUVToBGRTwoRowsAVX2(const uint8_t* yptr0, const uint8_t* yptr1, const uint8_t* vuptr, uint8_t* dst0,
+                           uint8_t* dst1, int width, bool is_nv12, bool has_alpha) {
+    const int channel = has_alpha ? 4 : 3;
+
+    const __m256i v1135 = _mm256_set1_epi16(-1135);
+    const __m256i v74   = _mm256_set1_epi16(74);
+    const __m256i v128  = _mm256_set1_epi16(128);
+    const __m256i v102  = _mm256_set1_epi16(102);
+    const __m256i v52   = _mm256_set1_epi16(-52);
+    const __m256i v25   = _mm256_set1_epi16(-25);
+    const __m256i v129  = _mm256_set1_epi16(129);
+    const __m256i v240  = _mm256_set1_epi8((char)0xf0);
+    const __m256i vaa   = _mm256_set1_epi8((char)0xff);
+    // duplicate the even / odd shorts of interleaved vu, one value per pixel
+    const __m256i sh_even = _mm256_setr_epi8(0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13,
+                                             0, 1, 0, 1, 4, 5, 4, 5, 8, 9, 8, 9, 12, 13, 12, 13);
+    const __m256i sh_odd  = _mm256_setr_epi8(2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 14, 15, 14, 15,
+                                             2, 3, 2, 3, 6, 7, 6, 7, 10, 11, 10, 11, 14, 15, 14, 15);
+
+    int x = 0;
+    for (; x + 32 <= width; x += 32) {
+        __m256i y0 = _mm256_loadu_si256((__m256i*)(yptr0 + x));
+        __m256i y1 = _mm256_loadu_si256((__m256i*)(yptr1 + x));
+        __m256i vu = _mm256_min_epu8(v240, _mm256_loadu_si256((__m256i*)(vuptr + x)));
+
+        __m256i vu_lo   = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(vu)), v128);
+        __m256i vu_hi   = _mm256_sub_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(vu, 1)), v128);
+        __m256i even_lo = _mm256_shuffle_epi8(vu_lo, sh_even);
+        __m256i odd_lo  = _mm256_shuffle_epi8(vu_lo, sh_odd);
+        __m256i even_hi = _mm256_shuffle_epi8(vu_hi, sh_even);
+        __m256i odd_hi  = _mm256_shuffle_epi8(vu_hi, sh_odd);
+
+        // nv12 u,v,u,v,...  nv21 v,u,v,u,...
+        __m256i uu_lo = is_nv12 ? even_lo : odd_lo;
+        __m256i vv_lo = is_nv12 ? odd_lo : even_lo;
+        __m256i uu_hi = is_nv12 ? even_hi : odd_hi;
+        __m256i vv_hi = is_nv12 ? odd_hi : even_hi;
+
+        // chroma terms are shared by both rows
+        __m256i r_lo = _mm256_mullo_epi16(vv_lo, v102);
+        __m256i g_lo = _mm256_add_epi16(_mm256_mullo_epi16(vv_lo, v52), _mm256_mullo_epi16(uu_lo, v25));
+        __m256i b_lo = _mm256_mullo_epi16(uu_lo, v129);
+        __m256i r_hi = _mm256_mullo_epi16(vv_hi, v102);
+        __m256i g_hi = _mm256_add_epi16(_mm256_mullo_epi16(vv_hi, v52), _mm256_mullo_epi16(uu_hi, v25));
+        __m256i b_hi = _mm256_mullo_epi16(uu_hi, v129);
+
+        __m256i yy[4];
+        yy[0] = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(y0)), v74), v1135);
+        yy[1] = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(y0, 1)), v74), v1135);
+        yy[2] = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(y1)), v74), v1135);
+        yy[3] = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(y1, 1)), v74), v1135);
+
+        for (int r = 0; r < 2; ++r) {
+            __m256i yy_lo = yy[2 * r];
+            __m256i yy_hi = yy[2 * r + 1];
+            uint8_t* dst  = (r == 0 ? dst0 : dst1) + x * channel;
+
+            __m256i rr = YUVPackU8(_mm256_add_epi16(yy_lo, r_lo), _mm256_add_epi16(yy_hi, r_hi));
+            __m256i gg = YUVPackU8(_mm256_add_epi16(yy_lo, g_lo), _mm256_add_epi16(yy_hi, g_hi));
+            __m256i bb = YUVPackU8(_mm256_add_epi16(yy_lo, b_lo), _mm256_add_epi16(yy_hi, b_hi));
+
+            if (has_alpha) {
+                StoreBGRA32(dst, bb, gg, rr, vaa);
+            } else {
+                StoreBGR16(dst, _mm256_castsi256_si128(bb), _mm256_castsi256_si128(gg), _mm256_castsi256_si128(rr));
+                StoreBGR16(dst + 48, _mm256_extracti128_si256(bb, 1), _mm256_extracti128_si256(gg, 1),
+                           _mm256_extracti128_si256(rr, 1));
+            }
+        }
+    }
+
+    return x;
+}
+
+int X86ColorToGrayAVX2(const uint8_t* src, uint8_t* gray, int count, int channel, bool bgr_order) {
+    const short k0  = bgr_order ? kX86GrayCoeffB : kX86GrayCoeffR;
+    const short k_g = kX86GrayCoeffG;
+    const short k2  = bgr_order ? kX86GrayCoeffR : kX86GrayCoeffB;
+
+    const __m256i coeff  = _mm256_setr_epi16(k0, k_g, k2, 0, k0, k_g, k2, 0, k0, k_g, k2, 0, k0, k_g, k2, 0);
+    const __m256i round  = _mm256_set1_epi32(1 << (kX86GrayShift - 1));
+    const __m256i perm   = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    const __m128i sh_c3  = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    // 3 channel loads read 4 bytes beyond the last pixel of a step
+    const int overread   = channel == 3 ? 2 : 0;
+
+    int x = 0;
+    for (; x + 16 + overread <= count; x += 16) {
+        __m256i sum[2];
+        for (int i = 0; i < 2; ++i) {
+            const uint8_t* p = src + (x + 8 * i) * channel;
+            __m128i px03, px47;
+            if (channel == 3) {
+                px03 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)p), sh_c3);
+                px47 = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)(p + 12)), sh_c3);
+            } else {
+                px03 = _mm_loadu_si128((__m128i*)p);
+                px47 = _mm_loadu_si128((__m128i*)(p + 16));
+            }
+            __m256i m0 = _mm256_madd_epi16(_mm256_cvtepu8_epi16(px03), coeff);
+            __m256i m1 = _mm256_madd_epi16(_mm256_cvtepu8_epi16(px47), coeff);
+            // hadd gives pixel 0 1 4 5 | 2 3 6 7
+            __m256i s  = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(m0, m1), perm);
+            sum[i]     = _mm256_srai_epi32(_mm256_add_epi32(s, round), kX86GrayShift);
+        }
+        __m256i s16 = _mm256_permute4x64_epi64(_mm256_packs_epi32(sum[0], sum[1]), 0xD8);
+        __m128i s8  = _mm_packus_epi16(_mm256_castsi256_si128(s16), _mm256_extracti128_si256(s16, 1));
+        _mm_storeu_si128((__m128i*)(gray + x), s8);
+    }
+
+    return x;
+}
+
+int X86ResizeBilinearVerticalAVX2(const short* rows0, const short* rows1, short b0, short b1, int count,
+                                  uint8_t* dst) {
+    const __m256i vb0 = _mm256_set1_epi16(b0);
+    const __m256i vb1 = _mm256_set1_epi16(b1);
+    const __m256i v2  = _mm256_set1_epi16(2);
+
+    int x = 0;
+    for (; x + 32 <= count; x += 32) {
+        __m256i r0_0 = _mm256_loadu_si256((__m256i*)(rows0 + x));
+        __m256i r1_0 = _mm256_loadu_si256((__m256i*)(rows1 + x));
+        __m256i r0_1 = _mm256_loadu_si256((__m256i*)(rows0 + x + 16));
+        __m256i r1_1 = _mm256_loadu_si256((__m256i*)(rows1 + x + 16));
+
+        __m256i acc0 = _mm256_adds_epi16(_mm256_mulhi_epi16(r0_0, vb0), _mm256_mulhi_epi16(r1_0, vb1));
+        __m256i acc1 = _mm256_adds_epi16(_mm256_mulhi_epi16(r0_1, vb0), _mm256_mulhi_epi16(r1_1, vb1));
+        acc0         = _mm256_srai_epi16(_mm256_adds_epi16(acc0, v2), 2);
+        acc1         = _mm256_srai_epi16(_mm256_adds_epi16(acc1, v2), 2);
+
+        __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi16(acc0, acc1), 0xD8);
+        _mm256_storeu_si256((__m256i*)(dst + x), packed);
+    }
+
+    return x;
+}
+
+int X86WarpAffineBilinearC1AVX2(const uint8_t* points, const short* tab_loc, const short* wtab, int count,
+                                uint8_t* dst) {
+    const __m256i delta = _mm256_set1_epi32(1 << 14);
+    const __m256i perm  = _mm256_setr_epi32(0, 1, 4, 5, 2, 3, 6, 7);
+    const long long* wtab64 = reinterpret_cast<const long long*>(wtab);
+
+    int x = 0;
+    for (; x + 8 <= count; x += 8) {
+        __m128i idx0 = _mm_cvtepi16_epi32(_mm_loadl_epi64((__m128i*)(tab_loc + x)));
+        __m128i idx1 = _mm_cvtepi16_epi32(_mm_loadl_epi64((__m128i*)(tab_loc + x + 4)));
+        // 4 weights of a pixel are one 64-bit entry
+        __m256i w0 = _mm256_i32gather_epi64(wtab64, idx0, 8);
+        __m256i w1 = _mm256_i32gather_epi64(wtab64, idx1, 8);
+
+        __m256i p  = _mm256_loadu_si256((__m256i*)(points + x * 4));
+        __m256i r0 = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_castsi256_si128(p)), w0);
+        __m256i r1 = _mm256_madd_epi16(_mm256_cvtepu8_epi16(_mm256_extracti128_si256(p, 1)), w1);
+
+        __m256i s   = _mm256_permutevar8x32_epi32(_mm256_hadd_epi32(r0, r1), perm);
+        s           = _mm256_srai_epi32(_mm256_add_epi32(s, delta), 15);
+        __m128i s16 = _mm_packs_epi32(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1));
+        _mm_storel_epi64((__m128i*)(dst + x), _mm_packus_epi16(s16, s16));
+    }
+
+    return x;
+}
+
+#else
+
+bool X86MatUtilAVX2Enabled() {
+    return false;
+}
+
+void X86MatUtilSetAVX2Enabled(bool enabled) {}
+
+int X86YUVToBGRTwoRowsAVX2(const uint8_t* yptr0, const uint8_t* yptr1, const uint8_t* vuptr, uint8_t* dst0,
+                           uint8_t* dst1, int width, bool is_nv12, bool has_alpha) {
+    return 0;
+}
+
+int X86ColorToGrayAVX2(const uint8_t* src, uint8_t* gray, int count, int channel, bool bgr_order) {
+    return 0;
+}
+
+int X86ResizeBilinearVerticalAVX2(const short* rows0, const short* rows1, short b0, short b1, int count,
+                                  uint8_t* dst) {
+    return 0;
+}
+
+int X86WarpAffineBilinearC1AVX2(const uint8_t* points, const short* tab_loc, const short* wtab, int count,
+                                uint8_t* dst) {
+    return 0;
+}
+
+#endif
+
+}  // namespace TNN_NS
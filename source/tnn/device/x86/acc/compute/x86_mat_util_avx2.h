@@ -0,0 +1,61 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef SOURCE_TNN_DEVICE_X86_ACC_COMPUTE_X86_MAT_UTIL_AVX2_H_
+#define SOURCE_TNN_DEVICE_X86_ACC_COMPUTE_X86_MAT_UTIL_AVX2_H_
+
+#include <stdint.h>
+
+#include "tnn/core/macro.h"
+
+namespace TNN_NS {
+
+// 256-bit kernels for x86_mat_util.cc, which is built with sse4.2 only.
+// Each kernel handles the largest prefix it can and returns the number of pixels
+// (or elements) processed, the caller finishes the remainder with the sse4.2 / naive code.
+// Without TNN_X86_AVX2_ENABLE the kernels are stubs that process nothing.
+
+// true if the kernels below are compiled with avx2 and the cpu supports avx2
+bool X86MatUtilAVX2Enabled();
+// force the sse4.2 path with false, used to benchmark the two paths against each other
+void X86MatUtilSetAVX2Enabled(bool enabled);
+
+// two rows of nv12/nv21 to bgr/bgra, 32 pixels per step
+int X86YUVToBGRTwoRowsAVX2(const uint8_t* yptr0, const uint8_t* yptr1, const uint8_t* vuptr, uint8_t* dst0,
+                           uint8_t* dst1, int width, bool is_nv12, bool has_alpha);
+
+// gray = (0.114 * b + 0.587 * g + 0.299 * r) in 14-bit fixed point, rounded to nearest.
+// the sse4.2 and naive paths of x86_mat_util.cc use the same coefficients, so all paths agree bit for bit.
+// the float code used before differs from this by at most 1 for some pixels.
+static const short kX86GrayCoeffB = 1868;
+static const short kX86GrayCoeffG = 9617;
+static const short kX86GrayCoeffR = 4899;
+static const int kX86GrayShift    = 14;
+
+// bgr/rgb/bgra/rgba to gray, 16 pixels per step
+int X86ColorToGrayAVX2(const uint8_t* src, uint8_t* gray, int count, int channel, bool bgr_order);
+
+// vertical pass of bilinear resize, dst = (rows0 * b0 >> 16 + rows1 * b1 >> 16 + 2) >> 2, 32 elements per step
+int X86ResizeBilinearVerticalAVX2(const short* rows0, const short* rows1, short b0, short b1, int count,
+                                  uint8_t* dst);
+
+// bilinear warp affine of one channel, points holds the 4 neighbours of each pixel,
+// tab_loc the index of its weights in wtab (4 shorts per entry), 8 pixels per step
+int X86WarpAffineBilinearC1AVX2(const uint8_t* points, const short* tab_loc, const short* wtab, int count,
+                                uint8_t* dst);
+
+}  // namespace TNN_NS
+
+#endif  // SOURCE_TNN_DEVICE_X86_ACC_COMPUTE_X86_MAT_UTIL_AVX2_H_
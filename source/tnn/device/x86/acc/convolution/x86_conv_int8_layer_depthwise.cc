@@ -30,10 +30,6 @@ bool X86ConvInt8LayerDepthwise::isPrefered(ConvLayerParam *param, const std::vec
     if (inputs[0]->GetBlobDesc().data_type != DATA_TYPE_INT8) {
         return false;
     }
-    if (param->fusion_type != FusionType_None) {
-        return false;
-    }
-
     auto dims_input          = inputs[0]->GetBlobDesc().dims;
     auto dims_output         = outputs[0]->GetBlobDesc().dims;
     const int input_channel  = dims_input[1];
@@ -109,6 +105,11 @@ Status X86ConvInt8LayerDepthwise::DoForward(const std::vector<Blob *> &inputs, c
     const int32_t *bias_data = buffer_bias_.force_to<int32_t *>();
     const float *scale_data  = buffer_scale_.force_to<float *>();
     int8_t *weight_data      = buffer_weight_.force_to<int8_t *>();
+    const float *add_scale   = buffer_add_scale_.force_to<float *>();
+    const int8_t *relu6_max  = relu6_max_.force_to<int8_t *>();
+    int8_t *add_input_data   = (conv_param->fusion_type == FusionType_None)
+                                   ? nullptr
+                                   : handle_ptr<int8_t *>(inputs[1]->GetHandle());
 
     int l = 0, t = 0, r = output_width, b = output_height;
     for (; l * stride_x - pad_x < 0; l++)
@@ -120,15 +121,37 @@ Status X86ConvInt8LayerDepthwise::DoForward(const std::vector<Blob *> &inputs, c
     for (; (b - 1) * stride_y - pad_y + kernel_y * dilate_y > input_height && b > t; b--)
         ;
 
-    auto RunCorner = [=](int8_t *dst_z, const int8_t *src_z, int left, int top, int right, int bottom) {
+    auto unit_func = X86DepthwiseI8Unit;
+    auto dwfunc    = X86DepthwiseI8General;
+    if (kernel_x == kernel_y && kernel_x == 3 && oc_r4 >= 8 && dilate_x == 1 && dilate_y == 1) {
+        dwfunc = X86DepthwiseI8K3;
+    } else if (kernel_x == kernel_y && kernel_x == 5 && oc_r4 >= 8 && dilate_x == 1 && dilate_y == 1) {
+        dwfunc = X86DepthwiseI8K5;
+    }
+#ifdef __AVX2__
+    if (arch_ == avx2 && oc_r4 >= 16) {
+        unit_func = X86AVXDepthwiseI8Unit;
+        dwfunc    = X86AVXDepthwiseI8General;
+        if (kernel_x == kernel_y && kernel_x == 3 && dilate_x == 1 && dilate_y == 1) {
+            dwfunc = X86AVXDepthwiseI8K3;
+        } else if (kernel_x == kernel_y && kernel_x == 5 && dilate_x == 1 && dilate_y == 1) {
+            dwfunc = X86AVXDepthwiseI8K5;
+        }
+    }
+#endif
+
+    auto RunCorner = [=](int8_t *dst_z, const int8_t *src_z, const int8_t *add_z, int left, int top, int right,
+                         int bottom) {
         for (long dy = top; dy < bottom; ++dy) {
             auto dst_y             = dst_z + dy * dst_y_step;
+            auto add_y             = add_z ? add_z + dy * dst_y_step : nullptr;
             const long src_start_y = dy * stride_y - pad_y;
             const auto src_y       = src_z + src_start_y * src_y_step;
             const long sfy         = MAX(0, (UP_DIV(-src_start_y, dilate_y)));
             const long efy         = MIN(kernel_y, (UP_DIV(dims_input[2] - src_start_y, dilate_y)));
             for (long dx = left; dx < right; ++dx) {
                 auto dst_x             = dst_y + oc_r4 * dx;
+                auto add_x             = add_y ? add_y + oc_r4 * dx : nullptr;
                 const long src_start_x = dx * stride_x - pad_x;
                 const auto src_x       = src_y + src_start_x * oc_r4;
                 const long sfx         = MAX(0, (UP_DIV(-src_start_x, dilate_x)));
@@ -136,9 +159,9 @@ Status X86ConvInt8LayerDepthwise::DoForward(const std::vector<Blob *> &inputs, c
                 const long srcIndex    = (sfx * dilate_x + sfy * dilate_y * dims_input[3]) * oc_r4;
                 const long weightIndex = (kernel_x * sfy + sfx) * oc_r4;
 
-                X86DepthwiseI8Unit(dst_x, src_x + srcIndex, weight_data + weightIndex, bias_data,
-                                efx - sfx, efy - sfy, oc_r4 * kernel_x, src_y_step * dilate_y,
-                                oc_r4 * dilate_x, scale_data, oc_r4);
+                unit_func(dst_x, src_x + srcIndex, weight_data + weightIndex, bias_data,
+                          efx - sfx, efy - sfy, oc_r4 * kernel_x, src_y_step * dilate_y,
+                          oc_r4 * dilate_x, scale_data, oc_r4, relu_, add_x, add_scale, relu6_max);
             }
         }
     };
@@ -146,32 +169,26 @@ Status X86ConvInt8LayerDepthwise::DoForward(const std::vector<Blob *> &inputs, c
     for (int bIndex = 0; bIndex < batch; ++bIndex) {
         const auto input_batch = input_data + bIndex * src_y_step * input_height;
         auto output_batch      = output_data + bIndex * dst_y_step * output_height;
+        auto add_input_batch   = add_input_data ? add_input_data + bIndex * dst_y_step * output_height : nullptr;
 
         long src_w_step = oc_r4 * conv_param->strides[0];
-        auto dwfunc     = X86DepthwiseI8General;
-
-        if (kernel_x == kernel_y && kernel_x == 3 && oc_r4 >= 8 && dilate_x == 1 && dilate_y == 1) {
-            dwfunc = X86DepthwiseI8K3;
-        } else if (kernel_x == kernel_y && kernel_x == 5 && oc_r4 >= 8 && dilate_x == 1 && dilate_y == 1) {
-            dwfunc = X86DepthwiseI8K5;
-        }
 
         OMP_PARALLEL_SECTIONS_ {
             OMP_SECTION_ {
                 // top corner
-                RunCorner(output_batch, input_batch, 0, 0, dims_output[3], t);
+                RunCorner(output_batch, input_batch, add_input_batch, 0, 0, dims_output[3], t);
             }
             OMP_SECTION_ {
                 // bottom corner
-                RunCorner(output_batch, input_batch, 0, b, dims_output[3], dims_output[2]);
+                RunCorner(output_batch, input_batch, add_input_batch, 0, b, dims_output[3], dims_output[2]);
             }
             OMP_SECTION_ {
                 // left corner
-                RunCorner(output_batch, input_batch, 0, t, l, b);
+                RunCorner(output_batch, input_batch, add_input_batch, 0, t, l, b);
             }
             OMP_SECTION_ {
                 // bottom corner
-                RunCorner(output_batch, input_batch, r, t, dims_output[3], b);
+                RunCorner(output_batch, input_batch, add_input_batch, r, t, dims_output[3], b);
             }
         }
         if (r > l && b > t) {
@@ -180,19 +197,15 @@ Status X86ConvInt8LayerDepthwise::DoForward(const std::vector<Blob *> &inputs, c
                 const long src_start_y = dy * conv_param->strides[1] - conv_param->pads[2];
                 const auto src_dy      = input_batch + src_start_y * src_y_step;
                 auto dst_y             = output_batch + dy * dst_y_step;
+                auto add_y             = add_input_batch ? add_input_batch + dy * dst_y_step + l * oc_r4 : nullptr;
                 dwfunc(dst_y + l * oc_r4,
                        src_dy + (l * conv_param->strides[0] - conv_param->pads[0]) * oc_r4,
                        weight_data, bias_data,
                        r - l, src_y_step * dilate_y, oc_r4 * dilate_x, src_w_step, oc_r4,
-                       conv_param->kernels[0], conv_param->kernels[1], scale_data);
+                       conv_param->kernels[0], conv_param->kernels[1], scale_data, relu_, add_y, add_scale,
+                       relu6_max);
             }
         }
-
-        if (conv_param->activation_type == ActivationType_ReLU) {
-            X86ReluInt8(output_batch, output_batch, output_height * dst_y_step);
-        } else if (conv_param->activation_type == ActivationType_ReLU6) {
-            X86Relu6Int8(output_batch, output_batch, relu6_max_.force_to<int8_t *>(), output_height * output_width, oc_r4);
-        }
     }
     return TNN_OK;
 }
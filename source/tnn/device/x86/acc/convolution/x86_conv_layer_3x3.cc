@@ -566,6 +566,154 @@ template void output_trans_post_2x4<Float8>(const float *src, int src_stride, in
 template void output_trans_post_2x4<Float4>(const float *src, int src_stride, int src_h_stride, float *dest,
                                             int dest_stride, int dest_h_stride, const float *bias_value, int relu_type);
 
+// BT=[4,  0, -5,  0, 1, 0,
+//     0, -4, -4,  1, 1, 0,
+//     0,  4, -4, -1, 1, 0,
+//     0, -2, -1,  2, 1, 0,
+//     0,  2, -1, -2, 1, 0,
+//     0,  4,  0, -5, 0, 1]
+template <typename VEC>
+static inline void input_trans_1d_6(const VEC *s, VEC *d) {
+    VEC t0 = s[4] - s[2] * 4.f;
+    VEC t1 = s[3] - s[1] * 4.f;
+    VEC t2 = s[4] - s[2];
+    VEC t3 = (s[3] - s[1]) * 2.f;
+    d[0]   = s[0] * 4.f - s[2] * 5.f + s[4];
+    d[1]   = t0 + t1;
+    d[2]   = t0 - t1;
+    d[3]   = t2 + t3;
+    d[4]   = t2 - t3;
+    d[5]   = s[1] * 4.f - s[3] * 5.f + s[5];
+}
+
+// BT=[1,  0,   -5.25,  0,     5.25,  0,    -1, 0,
+//     0,  1,    1,    -4.25, -4.25,  1,     1, 0,
+//     0, -1,    1,     4.25, -4.25, -1,     1, 0,
+//     0,  0.5,  0.25, -2.5,  -1.25,  2,     1, 0,
+//     0, -0.5,  0.25,  2.5,  -1.25, -2,     1, 0,
+//     0,  2,    4,    -2.5,  -5,     0.5,   1, 0,
+//     0, -2,    4,     2.5,  -5,    -0.5,   1, 0,
+//     0, -1,    0,     5.25,  0,    -5.25,  0, 1]
+template <typename VEC>
+static inline void input_trans_1d_8(const VEC *s, VEC *d) {
+    VEC t0 = s[2] + s[6] - s[4] * 4.25f;
+    VEC t1 = s[1] + s[5] - s[3] * 4.25f;
+    VEC t2 = s[2] * 0.25f - s[4] * 1.25f + s[6];
+    VEC t3 = s[1] * 0.5f - s[3] * 2.5f + s[5] * 2.f;
+    VEC t4 = s[2] * 4.f - s[4] * 5.f + s[6];
+    VEC t5 = s[1] * 2.f - s[3] * 2.5f + s[5] * 0.5f;
+    d[0]   = s[0] - s[6] + (s[4] - s[2]) * 5.25f;
+    d[1]   = t0 + t1;
+    d[2]   = t0 - t1;
+    d[3]   = t2 + t3;
+    d[4]   = t2 - t3;
+    d[5]   = t4 + t5;
+    d[6]   = t4 - t5;
+    d[7]   = s[7] - s[1] + (s[3] - s[5]) * 5.25f;
+}
+
+// AT=[1, 1,  1, 1,  1, 0,
+//     0, 1, -1, 2, -2, 0,
+//     0, 1,  1, 4,  4, 0,
+//     0, 1, -1, 8, -8, 1]
+template <typename VEC>
+static inline void output_trans_1d_6(const VEC *s, VEC *d) {
+    VEC t0 = s[1] + s[2];
+    VEC t1 = s[1] - s[2];
+    VEC t2 = s[3] + s[4];
+    VEC t3 = s[3] - s[4];
+    d[0]   = s[0] + t0 + t2;
+    d[1]   = t1 + t3 * 2.f;
+    d[2]   = t0 + t2 * 4.f;
+    d[3]   = t1 + t3 * 8.f + s[5];
+}
+
+// AT=[1, 1,  1,  1,  1,  1,        1,       0,
+//     0, 1, -1,  2, -2,  0.5,     -0.5,     0,
+//     0, 1,  1,  4,  4,  0.25,     0.25,    0,
+//     0, 1, -1,  8, -8,  0.125,   -0.125,   0,
+//     0, 1,  1, 16, 16,  0.0625,   0.0625,  0,
+//     0, 1, -1, 32, -32, 0.03125, -0.03125, 1]
+template <typename VEC>
+static inline void output_trans_1d_8(const VEC *s, VEC *d) {
+    VEC t0 = s[1] + s[2];
+    VEC t1 = s[1] - s[2];
+    VEC t2 = s[3] + s[4];
+    VEC t3 = s[3] - s[4];
+    VEC t4 = s[5] + s[6];
+    VEC t5 = s[5] - s[6];
+    d[0]   = s[0] + t0 + t2 + t4;
+    d[1]   = t1 + t3 * 2.f + t5 * 0.5f;
+    d[2]   = t0 + t2 * 4.f + t4 * 0.25f;
+    d[3]   = t1 + t3 * 8.f + t5 * 0.125f;
+    d[4]   = t0 + t2 * 16.f + t4 * 0.0625f;
+    d[5]   = t1 + t3 * 32.f + t5 * 0.03125f + s[7];
+}
+
+// 2d input trans for larger tiles, rows then columns
+// the result is written transposed into the gemm packed layout, the same as input_trans_4x4
+template <typename VEC, int SRC_UNIT, void (*TRANS)(const VEC *, VEC *)>
+static void input_trans_nxn(const float *src, int src_stride, int src_h_stride, float *dest, int dest_stride,
+                            int dest_h_stride) {
+    VEC mid[SRC_UNIT][SRC_UNIT];
+    VEC s[SRC_UNIT];
+    for (int h = 0; h < SRC_UNIT; ++h) {
+        const float *src_h = src + h * src_h_stride;
+        for (int w = 0; w < SRC_UNIT; ++w) {
+            s[w] = VEC::loadu(src_h + w * src_stride);
+        }
+        TRANS(s, mid[h]);
+    }
+    VEC d[SRC_UNIT];
+    for (int w = 0; w < SRC_UNIT; ++w) {
+        for (int h = 0; h < SRC_UNIT; ++h) {
+            s[h] = mid[h][w];
+        }
+        TRANS(s, d);
+        float *dest_w = dest + w * dest_h_stride;
+        for (int h = 0; h < SRC_UNIT; ++h) {
+            VEC::saveu(dest_w + h * dest_stride, d[h]);
+        }
+    }
+}
+
+// 2d output trans with bias and relu/relu6 for larger tiles
+template <typename VEC, int SRC_UNIT, int DST_UNIT, void (*TRANS)(const VEC *, VEC *)>
+static void output_trans_post_nxn(const float *src, int src_stride, int src_h_stride, float *dest, int dest_stride,
+                                  int dest_h_stride, const float *bias_value, int relu_type) {
+    VEC mid[SRC_UNIT][DST_UNIT];
+    VEC s[SRC_UNIT];
+    for (int h = 0; h < SRC_UNIT; ++h) {
+        const float *src_h = src + h * src_h_stride;
+        for (int w = 0; w < SRC_UNIT; ++w) {
+            s[w] = VEC::loadu(src_h + w * src_stride);
+        }
+        TRANS(s, mid[h]);
+    }
+
+    VEC bias  = bias_value ? VEC::loadu(bias_value) : VEC(0.f);
+    VEC zeros = VEC(0.f);
+    VEC sixs  = VEC(6.f);
+    VEC d[DST_UNIT];
+    for (int y = 0; y < DST_UNIT; ++y) {
+        for (int h = 0; h < SRC_UNIT; ++h) {
+            s[h] = mid[h][y];
+        }
+        TRANS(s, d);
+        float *dest_y = dest + y * dest_h_stride;
+        for (int x = 0; x < DST_UNIT; ++x) {
+            VEC v = d[x] + bias;
+            if (relu_type == ActivationType_ReLU || relu_type == ActivationType_ReLU6) {
+                v = VEC::max(v, zeros);
+            }
+            if (relu_type == ActivationType_ReLU6) {
+                v = VEC::min(v, sixs);
+            }
+            VEC::saveu(dest_y + x * dest_stride, v);
+        }
+    }
+}
+
 bool X86ConvLayer3x3::isPrefered(ConvLayerParam *param, const std::vector<Blob *> &inputs,
                                  const std::vector<Blob *> &outputs) {
     if (!param) {
@@ -589,6 +737,36 @@ bool X86ConvLayer3x3::isPrefered(ConvLayerParam *param, const std::vector<Blob *
 
 X86ConvLayer3x3::~X86ConvLayer3x3() {}
 
+void X86ConvLayer3x3::SetWinogradUnit(int unit) {
+    winograd_unit_ = unit;
+}
+
+/*
+estimate the cost of F(2x2,3x3), F(4x4,3x3) and F(6x6,3x3) by gemm and transform flops,
+larger tiles need fewer multiplies but waste more on the output border and transform cost grows,
+F(6x6,3x3) also loses some precision, only use it for wide layers
+*/
+int X86ConvLayer3x3::SelectWinogradUnit(int input_channel, int output_channel, int height_out, int width_out) {
+    const int min_channel = std::min(input_channel, output_channel);
+    int best_unit         = 2;
+    double best_cost      = -1;
+    for (int unit : {2, 4, 6}) {
+        if ((unit == 4 && min_channel < 32) || (unit == 6 && min_channel < 64)) {
+            continue;
+        }
+        const int src_unit = unit + 2;
+        double tiles       = (double)UP_DIV(height_out, unit) * UP_DIV(width_out, unit);
+        double gemm_cost   = (double)src_unit * src_unit * input_channel * output_channel;
+        double trans_cost  = (double)src_unit * src_unit * src_unit * (input_channel + output_channel);
+        double cost        = tiles * (gemm_cost + trans_cost);
+        if (best_cost < 0 || cost < best_cost) {
+            best_cost = cost;
+            best_unit = unit;
+        }
+    }
+    return best_unit;
+}
+
 Status X86ConvLayer3x3::allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     ConvLayerParam *param = dynamic_cast<ConvLayerParam *>(param_);
     CHECK_PARAM_NULL(param);
@@ -606,15 +784,31 @@ Status X86ConvLayer3x3::allocateBufferWeight(const std::vector<Blob *> &inputs,
 
         const int input_channel  = dims_input[1];
         const int output_channel = dims_output[1];
-        const int weight_count   = ROUND_UP(input_channel, CH_PACK) * ROUND_UP(output_channel, CH_PACK) * 4 * 4;
+        if (winograd_unit_ != 2 && winograd_unit_ != 4 && winograd_unit_ != 6) {
+            winograd_unit_ = SelectWinogradUnit(input_channel, output_channel, dims_output[2], dims_output[3]);
+        }
+        const int src_unit     = winograd_unit_ + 2;
+        const int weight_count = ROUND_UP(input_channel, CH_PACK) * ROUND_UP(output_channel, CH_PACK) * src_unit * src_unit;
         const int data_byte_size = DataTypeUtils::GetBytesSize(conv_res->filter_handle.GetDataType());
 
         if (conv_res->filter_handle.GetDataType() == DATA_TYPE_FLOAT) {
             RawBuffer pack_buffer(weight_count * data_byte_size);
             float *dst = pack_buffer.force_to<float *>();
 
-            const float G[4][3] = {{1.0f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}};
-            weight_transform(src, dst, 3, 4, input_channel, output_channel, CH_PACK, G);
+            const float G2[4][3] = {{1.0f, 0.0f, 0.0f}, {0.5f, 0.5f, 0.5f}, {0.5f, -0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}};
+            const float G4[6][3] = {{1.0f / 4, 0.0f, 0.0f},         {-1.0f / 6, -1.0f / 6, -1.0f / 6},
+                                    {-1.0f / 6, 1.0f / 6, -1.0f / 6}, {1.0f / 24, 1.0f / 12, 1.0f / 6},
+                                    {1.0f / 24, -1.0f / 12, 1.0f / 6}, {0.0f, 0.0f, 1.0f}};
+            const float G6[8][3] = {{1.0f, 0.0f, 0.0f},
+                                    {-2.0f / 9, -2.0f / 9, -2.0f / 9},
+                                    {-2.0f / 9, 2.0f / 9, -2.0f / 9},
+                                    {1.0f / 90, 1.0f / 45, 2.0f / 45},
+                                    {1.0f / 90, -1.0f / 45, 2.0f / 45},
+                                    {32.0f / 45, 16.0f / 45, 8.0f / 45},
+                                    {32.0f / 45, -16.0f / 45, 8.0f / 45},
+                                    {0.0f, 0.0f, 1.0f}};
+            const float(*G)[3] = winograd_unit_ == 6 ? G6 : (winograd_unit_ == 4 ? G4 : G2);
+            weight_transform(src, dst, 3, src_unit, input_channel, output_channel, CH_PACK, G);
 
             pack_buffer.SetDataType(DATA_TYPE_FLOAT);
             buffer_weight_ = pack_buffer;
@@ -628,7 +822,7 @@ Status X86ConvLayer3x3::allocateBufferWeight(const std::vector<Blob *> &inputs,
 
 // pack weight offline
 // pack input c8
-// input trans
+// input trans, written into the gemm packed layout
 // gemm
 // output trans
 // write c8 to nchw
@@ -665,15 +859,32 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     int ic_stride    = width_in * height_in;
     int oc_stride    = width_out * height_out;
 
+    const int dst_unit = winograd_unit_;
+    const int src_unit = dst_unit + 2;
+
     auto input_trans_func  = input_trans_4x4<Float4>;
     auto output_trans_func = output_trans_post_2x4<Float4>;
     auto pack_func         = pack_input_c4;
     auto unpack_func       = unpack_output_c4;
     auto gemm_func         = gemm_kernel_avx<Float4, 6, 4, 4>;
     auto CH_PACK           = 4;
+    if (dst_unit == 4) {
+        input_trans_func  = input_trans_nxn<Float4, 6, input_trans_1d_6<Float4>>;
+        output_trans_func = output_trans_post_nxn<Float4, 6, 4, output_trans_1d_6<Float4>>;
+    } else if (dst_unit == 6) {
+        input_trans_func  = input_trans_nxn<Float4, 8, input_trans_1d_8<Float4>>;
+        output_trans_func = output_trans_post_nxn<Float4, 8, 6, output_trans_1d_8<Float4>>;
+    }
     if (arch_ == avx2) {
         input_trans_func  = input_trans_4x4<Float8>;
         output_trans_func = output_trans_post_2x4<Float8>;
+        if (dst_unit == 4) {
+            input_trans_func  = input_trans_nxn<Float8, 6, input_trans_1d_6<Float8>>;
+            output_trans_func = output_trans_post_nxn<Float8, 6, 4, output_trans_1d_6<Float8>>;
+        } else if (dst_unit == 6) {
+            input_trans_func  = input_trans_nxn<Float8, 8, input_trans_1d_8<Float8>>;
+            output_trans_func = output_trans_post_nxn<Float8, 8, 6, output_trans_1d_8<Float8>>;
+        }
         pack_func         = pack_input_c8;
         unpack_func       = unpack_output_c8;
         gemm_func         = gemm_kernel_avx<Float8, 6, 8, 8>;
@@ -683,8 +894,6 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
     int ic_8 = UP_DIV(channel_in, CH_PACK);
     int oc_8 = UP_DIV(channel_out, CH_PACK);
 
-    const int src_unit = 4;
-    const int dst_unit = 2;
     int w_unit         = UP_DIV(width_out, dst_unit);
     int h_unit         = UP_DIV(height_out, dst_unit);
     int total_cnt      = UP_DIV(w_unit * h_unit, TILE_NUM);
@@ -764,7 +973,7 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
                     for (int ci = 0; ci < ic_8; ++ci) {
                         const float *src_ci = src_ptr + ci * ic_8_stride;
                         // pad
-                        memset(src_trans_tmp_per_thread, 0, 16 * CH_PACK * sizeof(float));  // src_unit * src_unit * ch_pack
+                        memset(src_trans_tmp_per_thread, 0, src_unit * src_unit * CH_PACK * sizeof(float));
                         if (x_size > 0) {
                             for (int yi = 0; yi < ey; ++yi) {
                                 float *dst_yi       = src_trans_tmp_per_thread + yi * src_unit * CH_PACK;
@@ -783,7 +992,7 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
 
             // ---------------------------------------- gemm func ----------------------------------------
             // gemm
-            float *dst_temp_data = tmp_data + TILE_NUM * ic_8 * 16 * CH_PACK;  // src_unit * src_unit * ch_pack
+            float *dst_temp_data = tmp_data + TILE_NUM * ic_8 * src_unit * src_unit * CH_PACK;
             float *b_ptr         = tmp_data;
             int w_gi_stride      = ic_8 * oc_8 * CH_PACK * CH_PACK;
             OMP_PARALLEL_FOR_GUIDED_
@@ -817,7 +1026,7 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
                 float *dst_ptr = output_ptr + (dst_y * width_out + dst_x) * CH_PACK;
                 float *src_ptr = dst_temp_data + ti * CH_PACK;
 
-                if (ex == 2) {
+                if (ex == dst_unit) {
                     // trans output
                     for (int ci = 0; ci < oc_8; ++ci) {
                         const float *bias_ci = bias_ptr + ci * CH_PACK;
@@ -837,7 +1046,7 @@ Status X86ConvLayer3x3::DoForward(const std::vector<Blob *> &inputs, const std::
                         output_trans_func(src_ci, c_gi_stride, c_gi_stride * src_unit, src_trans_tmp_per_thread, CH_PACK,
                                           dst_unit * CH_PACK, bias_ci, param->activation_type);
                         // copy to dest
-                        memset(dst_trans_tmp_per_thread, 0, 4 * CH_PACK * sizeof(float));  // dst_unit * dst_unit * ch_pack
+                        memset(dst_trans_tmp_per_thread, 0, dst_unit * dst_unit * CH_PACK * sizeof(float));
                         for (int i = 0; i < ey; ++i) {
                             memcpy(dst_trans_tmp_per_thread + i * ex * CH_PACK, src_trans_tmp_per_thread + i * CH_PACK * dst_unit,
                                    ex * sizeof(float) * CH_PACK);
@@ -29,6 +29,15 @@ public:
                            const std::vector<Blob *> &outputs);
 
     virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
+    // set winograd output tile size (2, 4 or 6) before Init, 0 means select by conv shape
+    void SetWinogradUnit(int unit);
+
+    // select winograd output tile size by channels and output size
+    static int SelectWinogradUnit(int input_channel, int output_channel, int height_out, int width_out);
+
+protected:
+    int winograd_unit_ = 0;
 };
 
 }  // namespace TNN_NS
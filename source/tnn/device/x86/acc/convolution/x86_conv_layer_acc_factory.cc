@@ -14,15 +14,57 @@
 
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_acc_factory.h"
 
+#include <algorithm>
+
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_depthwise.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_1x1.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_3x3.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_layer_common.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_int8_layer_common.h"
 #include "tnn/device/x86/acc/convolution/x86_conv_int8_layer_depthwise.h"
+#include "tnn/device/x86/acc/x86_tune_utils.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 
+enum X86ConvImplType {
+    X86_CONV_IMPL_DEPTHWISE = 0,
+    X86_CONV_IMPL_1X1       = 1,
+    X86_CONV_IMPL_3X3       = 2,
+    X86_CONV_IMPL_COMMON    = 3,
+};
+
+// gemm block sizes tried by the tuner, M_c_ may still be reduced at runtime for multi-thread
+static const std::vector<int> kTuneGemmMBlocks = {32, 64, 128};
+static const std::vector<int> kTuneGemmKBlocks = {128, 256, 512};
+// winograd output tile sizes tried by the tuner for 3x3 conv
+static const std::vector<int> kTuneWinogradUnits = {2, 4, 6};
+
+static std::shared_ptr<X86ConvLayerCommon> CreateImpByType(int type) {
+    switch (type) {
+        case X86_CONV_IMPL_DEPTHWISE:
+            return std::make_shared<X86ConvLayerDepthwise>();
+        case X86_CONV_IMPL_1X1:
+            return std::make_shared<X86ConvLayer1x1>();
+        case X86_CONV_IMPL_3X3:
+            return std::make_shared<X86ConvLayer3x3>();
+        case X86_CONV_IMPL_COMMON:
+            return std::make_shared<X86ConvLayerCommon>();
+        default:
+            return nullptr;
+    }
+}
+
+// the second field of a tune result is the winograd unit for 3x3 conv, M_c_ for others
+static void SetTuneConfig(std::shared_ptr<X86ConvLayerCommon> impl, const std::vector<int> &config) {
+    auto impl_3x3 = dynamic_cast<X86ConvLayer3x3 *>(impl.get());
+    if (impl_3x3) {
+        impl_3x3->SetWinogradUnit(config[1]);
+    } else {
+        impl->SetGemmBlockSize(config[1], config[2]);
+    }
+}
+
 /*
 get different impl based on conv params
 X86ConvLayerCommon always as the last solution
@@ -46,6 +88,87 @@ void X86ConvLayerAccFactory::CreateImpFP(const std::vector<Blob *> &inputs, cons
     }
 }
 
+/*
+get the fastest impl by timing every applicable impl on scratch blobs
+the result is saved as {impl type, M_c_ or winograd unit, K_c_}
+*/
+Status X86ConvLayerAccFactory::CreateImpTuned(Context *context, LayerParam *param, LayerResource *resource,
+                                              const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs,
+                                              std::shared_ptr<X86LayerAcc> &conv_acc_impl) {
+    auto conv_param  = dynamic_cast<ConvLayerParam *>(param);
+    CHECK_PARAM_NULL(conv_param);
+    auto x86_context = dynamic_cast<X86Context *>(context);
+    if (!x86_context || inputs.size() != 1) {
+        CreateImpFP(inputs, outputs, param, conv_acc_impl);
+        return TNN_OK;
+    }
+
+    std::vector<int> conv_params = {conv_param->group, conv_param->activation_type};
+    conv_params.insert(conv_params.end(), conv_param->kernels.begin(), conv_param->kernels.end());
+    conv_params.insert(conv_params.end(), conv_param->strides.begin(), conv_param->strides.end());
+    conv_params.insert(conv_params.end(), conv_param->pads.begin(), conv_param->pads.end());
+    conv_params.insert(conv_params.end(), conv_param->dialations.begin(), conv_param->dialations.end());
+    auto num_threads = x86_context->GetNumThreads();
+    auto key         = GetTuneKey("conv", inputs, outputs, conv_params, num_threads);
+
+    std::vector<std::vector<int>> candidates;
+    if (X86ConvLayerDepthwise::isPrefered(conv_param, inputs, outputs)) {
+        candidates.push_back({X86_CONV_IMPL_DEPTHWISE, 0, 0});
+    }
+    if (X86ConvLayer3x3::isPrefered(conv_param, inputs, outputs)) {
+        for (auto unit : kTuneWinogradUnits) {
+            candidates.push_back({X86_CONV_IMPL_3X3, unit, 0});
+        }
+    }
+    bool is_1x1 = X86ConvLayer1x1::isPrefered(conv_param, inputs, outputs);
+    for (auto m_c : kTuneGemmMBlocks) {
+        for (auto k_c : kTuneGemmKBlocks) {
+            if (is_1x1) {
+                candidates.push_back({X86_CONV_IMPL_1X1, m_c, k_c});
+            }
+            candidates.push_back({X86_CONV_IMPL_COMMON, m_c, k_c});
+        }
+    }
+
+    // a cached result that is none of the candidates comes from an edited or corrupt cache file, tune again
+    std::vector<int> best;
+    if (!x86_context->GetTuneResult(key, best) ||
+        std::find(candidates.begin(), candidates.end(), best) == candidates.end()) {
+        best.clear();
+        TuneBlobs tune_inputs(inputs);
+        TuneBlobs tune_outputs(outputs);
+        OMP_SET_THREADS_(num_threads);
+        float best_time = -1.f;
+        for (const auto &candidate : candidates) {
+            auto impl = CreateImpByType(candidate[0]);
+            SetTuneConfig(impl, candidate);
+            if (impl->Init(context, param, resource, inputs, outputs) != TNN_OK) {
+                continue;
+            }
+            float time = TimeKernel([&]() { return impl->DoForward(tune_inputs.GetBlobs(), tune_outputs.GetBlobs()); });
+            LOGD("X86 conv tune %s: impl %d m_c %d k_c %d, %.3f ms\n", key.c_str(), candidate[0], candidate[1],
+                 candidate[2], time);
+            if (time >= 0 && (best_time < 0 || time < best_time)) {
+                best_time = time;
+                best      = candidate;
+            }
+        }
+        if (best.size() != 3) {
+            CreateImpFP(inputs, outputs, param, conv_acc_impl);
+            return TNN_OK;
+        }
+        x86_context->SetTuneResult(key, best);
+    }
+
+    auto impl = CreateImpByType(best[0]);
+    if (!impl) {
+        return Status(TNNERR_NET_ERR, "invalid x86 conv tune result");
+    }
+    SetTuneConfig(impl, best);
+    conv_acc_impl = impl;
+    return TNN_OK;
+}
+
 /*
 get different impl based on conv params
 X86ConvInt8LayerCommon always as the last solution
@@ -26,6 +26,12 @@ public:
     static void CreateImpFP(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs, LayerParam *param,
                             std::shared_ptr<X86LayerAcc> &conv_acc_impl);
 
+    // time all applicable impls and gemm block sizes, and create the fastest one.
+    // results are cached in X86Context by shape, isa and thread number.
+    static Status CreateImpTuned(Context *context, LayerParam *param, LayerResource *resource,
+                                 const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs,
+                                 std::shared_ptr<X86LayerAcc> &conv_acc_impl);
+
     static void CreateImpInt8(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs, LayerParam *param,
                             std::shared_ptr<X86LayerAcc> &conv_acc_impl);
 };
@@ -29,7 +29,21 @@ bool X86ConvLayerCommon::isPrefered(ConvLayerParam *param, const std::vector<Blo
 
 X86ConvLayerCommon::~X86ConvLayerCommon() {}
 
+// the thread adjustment only shrinks the blocks, so it starts over from the cache derived ones for the new dims
 Status X86ConvLayerCommon::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<ConvLayerParam *>(param_);
+    if (!param || cache_m_c_ <= 0) {
+        return TNN_OK;
+    }
+    auto output_dims = outputs[0]->GetBlobDesc().dims;
+    int spatial_dim  = DimsVectorUtils::Count(output_dims, 2);
+
+    conv_gemm_conf_.M_c_ = cache_m_c_;
+    conv_gemm_conf_.N_c_ = cache_n_c_;
+    int num_threads      = context_->GetNumThreads();
+    conv_ajust_m_blk_size(num_threads, spatial_dim, conv_gemm_conf_.M_c_);
+    conv_ajust_n_blk_size(num_threads, spatial_dim, conv_gemm_conf_.M_c_, output_dims[1] / param->group,
+                          conv_gemm_conf_.n_block_, conv_gemm_conf_.N_c_);
     return TNN_OK;
 }
 
@@ -94,6 +108,11 @@ Status X86ConvLayerCommon::allocateBufferBias(const std::vector<Blob *> &inputs,
     return TNN_OK;
 }
 
+void X86ConvLayerCommon::SetGemmBlockSize(int m_c, int k_c) {
+    gemm_m_c_ = m_c;
+    gemm_k_c_ = k_c;
+}
+
 Status X86ConvLayerCommon::Init(Context *context, LayerParam *param, LayerResource *resource,
                                 const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto status = X86LayerAcc::Init(context, param, resource, inputs, outputs);
@@ -101,6 +120,15 @@ Status X86ConvLayerCommon::Init(Context *context, LayerParam *param, LayerResour
         return status;
     }
     conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+    if (gemm_m_c_ > 0) {
+        conv_gemm_conf_.M_c_ = gemm_m_c_;
+    }
+    if (gemm_k_c_ > 0) {
+        conv_gemm_conf_.K_c_ = gemm_k_c_;
+    }
+    cache_m_c_ = conv_gemm_conf_.M_c_;
+    cache_n_c_ = conv_gemm_conf_.N_c_;
+    RETURN_ON_NEQ(Reshape(inputs, outputs), TNN_OK);
 
     RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
     RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
@@ -128,7 +156,6 @@ Status X86ConvLayerCommon::DoForward(const std::vector<Blob *> &inputs, const st
     size_t col_offset_ = param->kernels[0] * param->kernels[1] * oh * ow * (input_dims[1] / param->group);
 
     int max_num_threads = OMP_MAX_THREADS_NUM_;
-    conv_ajust_m_blk_size(max_num_threads, conv_out_spatial_dim_, conv_gemm_conf_.M_c_);
 
     int m_c = conv_gemm_conf_.M_c_;
     int k_c = conv_gemm_conf_.K_c_;
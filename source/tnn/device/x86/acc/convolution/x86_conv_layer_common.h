@@ -44,8 +44,16 @@ public:
 
     virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
 
+    // set gemm block sizes (M_c_, K_c_) before Init, 0 means the default value
+    void SetGemmBlockSize(int m_c, int k_c);
+
 protected:
     bool do_im2col_ = true;
+    int gemm_m_c_   = 0;
+    int gemm_k_c_   = 0;
+    // M_c_ and N_c_ derived from the cache topology, or set by SetGemmBlockSize, before the thread adjustment
+    dim_t cache_m_c_ = 0;
+    dim_t cache_n_c_ = 0;
     RawBuffer buffer_weight_;
     RawBuffer buffer_bias_;
     conv_gemm_config<float, float, float> conv_gemm_conf_;
@@ -31,7 +31,23 @@ bool X86DeconvLayerCommon::isPrefered(ConvLayerParam *param, const std::vector<B
 
 X86DeconvLayerCommon::~X86DeconvLayerCommon() {}
 
+// the thread adjustment only shrinks the blocks, so it starts over from the cache derived ones for the new dims
 Status X86DeconvLayerCommon::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<ConvLayerParam *>(param_);
+    if (!param || cache_m_c_ <= 0) {
+        return TNN_OK;
+    }
+    auto input_dims  = inputs[0]->GetBlobDesc().dims;
+    auto output_dims = outputs[0]->GetBlobDesc().dims;
+    int spatial_dim  = DimsVectorUtils::Count(input_dims, 2);
+
+    conv_gemm_conf_.M_c_ = cache_m_c_;
+    conv_gemm_conf_.N_c_ = cache_n_c_;
+    int num_threads      = context_->GetNumThreads();
+    conv_ajust_m_blk_size(num_threads, spatial_dim, conv_gemm_conf_.M_c_);
+    conv_ajust_n_blk_size(num_threads, spatial_dim, conv_gemm_conf_.M_c_,
+                          output_dims[1] * param->kernels[0] * param->kernels[1] / param->group,
+                          conv_gemm_conf_.n_block_, conv_gemm_conf_.N_c_);
     return TNN_OK;
 }
 
@@ -111,6 +127,9 @@ Status X86DeconvLayerCommon::Init(Context *context, LayerParam *param, LayerReso
         return status;
     }
     conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+    cache_m_c_      = conv_gemm_conf_.M_c_;
+    cache_n_c_      = conv_gemm_conf_.N_c_;
+    RETURN_ON_NEQ(Reshape(inputs, outputs), TNN_OK);
 
     RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
     RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
@@ -152,7 +171,6 @@ Status X86DeconvLayerCommon::DoForward(const std::vector<Blob *> &inputs, const
         param->kernels[0] * param->kernels[1] * input_dims[2] * input_dims[3] * (output_dims[1] / param->group);
 
     int max_num_threads = OMP_MAX_THREADS_NUM_;
-    conv_ajust_m_blk_size(max_num_threads, conv_in_spatial_dim_, conv_gemm_conf_.M_c_);
 
     int m_c               = conv_gemm_conf_.M_c_;
     int k_c               = conv_gemm_conf_.K_c_;
@@ -51,6 +51,9 @@ protected:
     RawBuffer buffer_weight_;
     RawBuffer buffer_bias_;
     conv_gemm_config<float, float, float> conv_gemm_conf_;
+    // M_c_ and N_c_ derived from the cache topology, before the thread adjustment
+    dim_t cache_m_c_       = 0;
+    dim_t cache_n_c_       = 0;
     post_func_t post_func_ = nullptr;
 };
 
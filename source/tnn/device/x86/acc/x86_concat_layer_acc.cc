@@ -74,9 +74,13 @@ Status X86ConcatLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
         int8_t *input_data          = handle_ptr<int8_t *>(inputs[i]->GetHandle());
         const int input_concat_axis = inputs[i]->GetBlobDesc().dims[axis];
         for (int n = 0; n < num_concats; ++n) {
-            memcpy(output_data + (n * output_concat_axis + output_concat_axis_offset) * concate_size * datasize,
-                   input_data + n * input_concat_axis * concate_size * datasize,
-                   input_concat_axis * concate_size * datasize);
+            int8_t *dst = output_data + (n * output_concat_axis + output_concat_axis_offset) * concate_size * datasize;
+            int8_t *src = input_data + n * input_concat_axis * concate_size * datasize;
+            // inputs planned inside the output are already in place, after a reshape to smaller dims they sit at
+            // or behind their place and moving them in order keeps the ones not moved yet intact
+            if (dst != src) {
+                memmove(dst, src, input_concat_axis * concate_size * datasize);
+            }
         }
         output_concat_axis_offset += input_concat_axis;
     }
@@ -27,7 +27,17 @@ Status X86ConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource
     CHECK_PARAM_NULL(conv_resource);
 
     Status ret;
-    if (conv_resource->filter_handle.GetDataType() == DATA_TYPE_HALF ||
+    if (conv_param->dynamic_range_quantized && conv_resource->filter_handle.GetDataType() == DATA_TYPE_INT8 &&
+        inputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
+        // the int8 filter stays in the model resource, the dequantized copy only lives until it is packed
+        auto fp32_res           = new ConvLayerResource();
+        fp32_res->filter_handle = ConvertInt8Handle(conv_resource->filter_handle, conv_resource->scale_handle,
+                                                    conv_resource->filter_handle.GetDataCount() /
+                                                        std::max(conv_param->output_channel, 1));
+        fp32_res->bias_handle   = ConvertHalfHandle(conv_resource->bias_handle);
+        conv_acc_f32_resource_  = std::shared_ptr<LayerResource>(fp32_res);
+        ret                     = X86LayerAcc::Init(context, param, conv_acc_f32_resource_.get(), inputs, outputs);
+    } else if (conv_resource->filter_handle.GetDataType() == DATA_TYPE_HALF ||
         conv_resource->bias_handle.GetDataType() == DATA_TYPE_HALF) {
         LayerResource *fp32_res = nullptr;
         RETURN_ON_NEQ(ConvertHalfResource(LAYER_CONVOLUTION, conv_resource, &fp32_res), TNN_OK);
@@ -44,6 +54,10 @@ Status X86ConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource
     auto data_type = inputs[0]->GetBlobDesc().data_type;
     if (data_type == DATA_TYPE_INT8) {
         X86ConvLayerAccFactory::CreateImpInt8(inputs, outputs, param_, conv_acc_impl_);
+    } else if (context_->GetEnableTuneKernel()) {
+        RETURN_ON_NEQ(
+            X86ConvLayerAccFactory::CreateImpTuned(context_, param_, resource_, inputs, outputs, conv_acc_impl_),
+            TNN_OK);
     } else {
         X86ConvLayerAccFactory::CreateImpFP(inputs, outputs, param_, conv_acc_impl_);
     }
@@ -62,6 +76,14 @@ Status X86ConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource
     return ret;
 }
 
+// the impl is created after X86LayerAcc::Init reshaped the wrapper
+Status X86ConvLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    if (conv_acc_impl_) {
+        return conv_acc_impl_->Reshape(inputs, outputs);
+    }
+    return TNN_OK;
+}
+
 Status X86ConvLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     if (conv_acc_impl_) {
         return conv_acc_impl_->DoForward(inputs, outputs);
@@ -142,6 +142,8 @@ Status X86CpuAdapterAcc::Reshape(const std::vector<Blob *> &inputs, const std::v
 }
 
 Status X86CpuAdapterAcc::Forward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    context_->GetCounters().adapter_fallback_count.fetch_add(1, std::memory_order_relaxed);
+
     Status status = TNN_OK;
     // convert data from x86 to cpu
     status = ConvertBlobForAdaptorAcc(inputs, cpu_blob_in_, true);
@@ -55,6 +55,14 @@ Status X86DeconvLayerAcc::Init(Context *context, LayerParam *param, LayerResourc
     return ret;
 }
 
+// the impl is created after X86LayerAcc::Init reshaped the wrapper
+Status X86DeconvLayerAcc::Reshape(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    if (conv_acc_impl_) {
+        return conv_acc_impl_->Reshape(inputs, outputs);
+    }
+    return TNN_OK;
+}
+
 Status X86DeconvLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     if (conv_acc_impl_) {
         return conv_acc_impl_->DoForward(inputs, outputs);
@@ -0,0 +1,257 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/device/x86/acc/x86_dw_pw_fused_conv_layer_acc.h"
+
+#include <algorithm>
+
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/omp_utils.h"
+
+namespace TNN_NS {
+
+// bytes of the depthwise result per row tile, keep it in L2 while the 1x1 gemm reads it
+static const int kDwPwTileBytes = 128 * 1024;
+
+X86DwPwFusedConvLayerAcc::~X86DwPwFusedConvLayerAcc() {}
+
+static Status GetFloatResource(ConvLayerResource *res, std::shared_ptr<LayerResource> &fp32_res,
+                               ConvLayerResource **dst_res) {
+    *dst_res = res;
+    if (res->filter_handle.GetDataType() == DATA_TYPE_HALF || res->bias_handle.GetDataType() == DATA_TYPE_HALF) {
+        LayerResource *converted = nullptr;
+        RETURN_ON_NEQ(ConvertHalfResource(LAYER_CONVOLUTION, res, &converted), TNN_OK);
+        fp32_res = std::shared_ptr<LayerResource>(converted);
+        *dst_res = dynamic_cast<ConvLayerResource *>(converted);
+    }
+    if (!(*dst_res) || (*dst_res)->filter_handle.GetDataType() != DATA_TYPE_FLOAT) {
+        LOGE("Error: DataType %d not support\n", res->filter_handle.GetDataType());
+        return Status(TNNERR_MODEL_ERR, "conv_res DataType is not supported");
+    }
+    return TNN_OK;
+}
+
+static RawBuffer PackBias(ConvLayerParam *param, ConvLayerResource *res, int channel) {
+    RawBuffer buffer(ROUND_UP(channel, 8) * sizeof(float));
+    if (param->bias) {
+        memcpy(buffer.force_to<float *>(), res->bias_handle.force_to<float *>(), channel * sizeof(float));
+    }
+    buffer.SetDataType(DATA_TYPE_FLOAT);
+    return buffer;
+}
+
+Status X86DwPwFusedConvLayerAcc::allocateBufferWeight(ConvLayerParam *dw_param, ConvLayerResource *dw_res,
+                                                      ConvLayerParam *pw_param, ConvLayerResource *pw_res,
+                                                      int input_channel) {
+    const int kernel_size = dw_param->kernels[0] * dw_param->kernels[1];
+    const int c_pack      = arch_ == avx2 ? 8 : 4;
+
+    // depthwise weights in c_pack
+    RawBuffer dw_weight(ROUND_UP(input_channel, c_pack) * kernel_size * sizeof(float));
+    if (arch_ == avx2) {
+        PackC8(dw_weight.force_to<float *>(), dw_res->filter_handle.force_to<float *>(), kernel_size, kernel_size,
+               kernel_size, input_channel);
+    } else {
+        PackC4(dw_weight.force_to<float *>(), dw_res->filter_handle.force_to<float *>(), kernel_size, kernel_size,
+               kernel_size, input_channel);
+    }
+    dw_weight.SetDataType(DATA_TYPE_FLOAT);
+    buffer_dw_weight_ = dw_weight;
+    buffer_dw_bias_   = PackBias(dw_param, dw_res, input_channel);
+
+    // pointwise weights packed for the 1x1 gemm, same as X86ConvLayer1x1
+    const int output_channel = pw_param->output_channel;
+    size_t weight_pack_size  = ROUND_UP(input_channel, conv_gemm_conf_.K_c_) *
+                              ROUND_UP(output_channel, conv_gemm_conf_.n_block_);
+    RawBuffer pw_weight(weight_pack_size * sizeof(float));
+    conv_pack_col_b_n(output_channel, input_channel, pw_res->filter_handle.force_to<float *>(), input_channel,
+                      pw_weight.force_to<float *>(), conv_gemm_conf_);
+    pw_weight.SetDataType(DATA_TYPE_FLOAT);
+    buffer_pw_weight_ = pw_weight;
+    buffer_pw_bias_   = PackBias(pw_param, pw_res, output_channel);
+
+    return TNN_OK;
+}
+
+Status X86DwPwFusedConvLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                                      const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    RETURN_ON_NEQ(X86LayerAcc::Init(context, param, resource, inputs, outputs), TNN_OK);
+
+    auto layer_param = dynamic_cast<DwPwFusedConvLayerParam *>(param);
+    CHECK_PARAM_NULL(layer_param);
+    auto layer_res = dynamic_cast<DwPwFusedConvLayerResource *>(resource);
+    CHECK_PARAM_NULL(layer_res);
+
+    if (inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_LAYER_ERR, "dw pw fused conv only supports float");
+    }
+    const int input_channel = inputs[0]->GetBlobDesc().dims[1];
+    if (layer_param->dw_param.group != input_channel) {
+        return Status(TNNERR_PARAM_ERR, "dw pw fused conv requires group == input channel");
+    }
+
+    std::shared_ptr<LayerResource> dw_fp32_res, pw_fp32_res;
+    ConvLayerResource *dw_res = nullptr;
+    ConvLayerResource *pw_res = nullptr;
+    RETURN_ON_NEQ(GetFloatResource(&layer_res->dw_resource, dw_fp32_res, &dw_res), TNN_OK);
+    RETURN_ON_NEQ(GetFloatResource(&layer_res->pw_resource, pw_fp32_res, &pw_res), TNN_OK);
+
+    conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+    return allocateBufferWeight(&layer_param->dw_param, dw_res, &layer_param->pw_param, pw_res, input_channel);
+}
+
+template <int c_pack>
+static void PackDwInputWithPad(const float *src, float *dst, const std::vector<int> &pads, int src_h, int src_w,
+                               int channels) {
+    auto PackAcc = c_pack == 8 ? PackC8 : PackC4;
+
+    int dst_w_stride = (src_w + pads[0] + pads[1]) * c_pack;
+    memset(dst, 0, pads[2] * dst_w_stride * sizeof(float));
+
+    auto dst_ptr = dst + pads[2] * dst_w_stride;
+    for (int h = 0; h < src_h; h++) {
+        auto dst_h = dst_ptr + h * dst_w_stride;
+        memset(dst_h, 0, pads[0] * c_pack * sizeof(float));
+        PackAcc(dst_h + pads[0] * c_pack, src + h * src_w, src_w, src_h * src_w, src_w, channels);
+        memset(dst_h + (pads[0] + src_w) * c_pack, 0, pads[1] * c_pack * sizeof(float));
+    }
+    memset(dst_ptr + src_h * dst_w_stride, 0, pads[3] * dst_w_stride * sizeof(float));
+}
+
+/*
+for each batch:
+    pack the padded input of all channels in c_pack
+    for each row tile of the output (in parallel):
+        depthwise conv with activation -> c_pack tile -> nchw tile [ic][tile]
+        1x1 gemm on the nchw tile, written into the output rows directly
+*/
+Status X86DwPwFusedConvLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto layer_param = dynamic_cast<DwPwFusedConvLayerParam *>(param_);
+    auto &dw_param   = layer_param->dw_param;
+    auto &pw_param   = layer_param->pw_param;
+
+    auto dims_input  = inputs[0]->GetBlobDesc().dims;
+    auto dims_output = outputs[0]->GetBlobDesc().dims;
+
+    const int batch          = dims_output[0];
+    const int input_channel  = dims_input[1];
+    const int height_in      = dims_input[2];
+    const int width_in       = dims_input[3];
+    const int output_channel = dims_output[1];
+    const int height_out     = dims_output[2];
+    const int width_out      = dims_output[3];
+
+    const int c_pack    = arch_ == avx2 ? 8 : 4;
+    const int ic_pack   = UP_DIV(input_channel, c_pack);
+    const int src_pad_w = width_in + dw_param.pads[0] + dw_param.pads[1];
+    const int src_pad_h = height_in + dw_param.pads[2] + dw_param.pads[3];
+
+    auto dw_func = DepthwiseConv<ActivationType_None, Float8, 8>;
+    if (dw_param.activation_type == ActivationType_ReLU) {
+        dw_func = DepthwiseConv<ActivationType_ReLU, Float8, 8>;
+    } else if (dw_param.activation_type == ActivationType_ReLU6) {
+        dw_func = DepthwiseConv<ActivationType_ReLU6, Float8, 8>;
+    }
+    auto pack_func   = PackDwInputWithPad<8>;
+    auto unpack_func = UnpackC8;
+    if (arch_ == sse42) {
+        dw_func = DepthwiseConv<ActivationType_None, Float4, 4>;
+        if (dw_param.activation_type == ActivationType_ReLU) {
+            dw_func = DepthwiseConv<ActivationType_ReLU, Float4, 4>;
+        } else if (dw_param.activation_type == ActivationType_ReLU6) {
+            dw_func = DepthwiseConv<ActivationType_ReLU6, Float4, 4>;
+        }
+        pack_func   = PackDwInputWithPad<4>;
+        unpack_func = UnpackC4;
+    }
+
+    // rows per tile: the nchw depthwise tile fits kDwPwTileBytes, and every thread gets a tile
+    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int tile_rows       = std::max(1, kDwPwTileBytes / (int)sizeof(float) / input_channel / width_out);
+    tile_rows           = std::min(tile_rows, UP_DIV(height_out, max_num_threads));
+    const int tile_num  = UP_DIV(height_out, tile_rows);
+    const int tile_size = tile_rows * width_out;
+
+    size_t src_pad_c_size = ROUND_UP(src_pad_w * src_pad_h * c_pack, 8);
+    size_t dw_tile_size   = ROUND_UP(tile_size * c_pack, 8);
+    size_t nchw_tile_size = ROUND_UP(tile_size * input_channel, 8);
+    size_t gemm_buf_size  = ROUND_UP(conv_gemm_conf_.M_c_ * conv_gemm_conf_.K_c_, 8);
+    size_t thread_size    = dw_tile_size + nchw_tile_size + gemm_buf_size;
+    float *workspace      = reinterpret_cast<float *>(context_->GetSharedWorkSpace(
+        (src_pad_c_size * ic_pack + thread_size * max_num_threads) * sizeof(float)));
+    float *src_pad        = workspace;
+    float *thread_buf     = workspace + src_pad_c_size * ic_pack;
+
+    const float *dw_weight = buffer_dw_weight_.force_to<float *>();
+    const float *dw_bias   = buffer_dw_bias_.force_to<float *>();
+    const float *pw_weight = buffer_pw_weight_.force_to<float *>();
+    const float *pw_bias   = buffer_pw_bias_.force_to<float *>();
+
+    const int kernel_size   = dw_param.kernels[0] * dw_param.kernels[1];
+    const int dilate_x_step = dw_param.dialations[0] * c_pack;
+    const int dilate_y_step = dw_param.dialations[1] * src_pad_w * c_pack;
+    const int src_h_step    = dw_param.strides[1] * src_pad_w * c_pack;
+
+    const float *src_origin = handle_ptr<const float *>(inputs[0]->GetHandle());
+    float *dst_origin       = handle_ptr<float *>(outputs[0]->GetHandle());
+
+    for (int b = 0; b < batch; b++) {
+        auto src_b = src_origin + b * input_channel * height_in * width_in;
+        auto dst_b = dst_origin + b * output_channel * height_out * width_out;
+
+        OMP_PARALLEL_FOR_GUIDED_
+        for (int g = 0; g < ic_pack; g++) {
+            int real_c = std::min(c_pack, input_channel - g * c_pack);
+            pack_func(src_b + g * c_pack * height_in * width_in, src_pad + g * src_pad_c_size, dw_param.pads,
+                      height_in, width_in, real_c);
+        }
+
+        OMP_PARALLEL_FOR_DYNAMIC_
+        for (int t = 0; t < tile_num; t++) {
+            int thread_id  = OMP_TID_;
+            float *dw_tile = thread_buf + thread_id * thread_size;
+            float *nchw    = dw_tile + dw_tile_size;
+            float *gemm    = nchw + nchw_tile_size;
+
+            int y_start   = t * tile_rows;
+            int rows      = std::min(tile_rows, height_out - y_start);
+            int tile_area = rows * width_out;
+
+            for (int g = 0; g < ic_pack; g++) {
+                int real_c = std::min(c_pack, input_channel - g * c_pack);
+                dw_func(dw_tile, src_pad + g * src_pad_c_size + y_start * src_h_step,
+                        dw_weight + g * c_pack * kernel_size, dw_bias + g * c_pack, width_out,
+                        dw_param.strides[0] * c_pack, dw_param.kernels[0], dw_param.kernels[1], dilate_x_step,
+                        dilate_y_step, rows, src_h_step, width_out * c_pack);
+                unpack_func(nchw + g * c_pack * tile_area, dw_tile, tile_area, tile_area, tile_area, real_c);
+            }
+
+            // the tiles are the parallel loop, the gemm of a tile runs on its thread with the thread buffer
+            conv_sgemm_nn_col_major_prepack_b_serial(tile_area, output_channel, input_channel, nchw, tile_area,
+                                                     pw_weight, input_channel, dst_b + y_start * width_out,
+                                                     height_out * width_out, pw_bias, pw_param.activation_type, gemm,
+                                                     conv_gemm_conf_);
+        }
+    }
+
+    return TNN_OK;
+}
+
+REGISTER_X86_ACC(DwPwFusedConv, LAYER_DW_PW_FUSED_CONV);
+
+}  // namespace TNN_NS
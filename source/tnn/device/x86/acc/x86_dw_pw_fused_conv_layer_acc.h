@@ -0,0 +1,49 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_DW_PW_FUSED_CONV_LAYER_ACC_H_
+#define TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_DW_PW_FUSED_CONV_LAYER_ACC_H_
+
+#include <vector>
+
+#include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
+#include "tnn/device/x86/acc/x86_layer_acc.h"
+
+namespace TNN_NS {
+
+// depthwise conv + pointwise conv, the depthwise result of a row tile stays in cache and feeds the 1x1 gemm
+class X86DwPwFusedConvLayerAcc : public X86LayerAcc {
+public:
+    virtual ~X86DwPwFusedConvLayerAcc();
+
+    Status Init(Context *context, LayerParam *param, LayerResource *resource, const std::vector<Blob *> &inputs,
+                const std::vector<Blob *> &outputs) override;
+
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
+
+protected:
+    Status allocateBufferWeight(ConvLayerParam *dw_param, ConvLayerResource *dw_res, ConvLayerParam *pw_param,
+                                ConvLayerResource *pw_res, int input_channel);
+
+    RawBuffer buffer_dw_weight_;
+    RawBuffer buffer_dw_bias_;
+    RawBuffer buffer_pw_weight_;
+    RawBuffer buffer_pw_bias_;
+    conv_gemm_config<float, float, float> conv_gemm_conf_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_DW_PW_FUSED_CONV_LAYER_ACC_H_
@@ -12,13 +12,37 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
-#include "tnn/device/x86/acc/x86_layer_acc.h"
+#include "tnn/device/x86/acc/x86_gather_layer_acc.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/utils/data_type_utils.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/half_utils.h"
 
 namespace TNN_NS {
 
-DECLARE_X86_ACC(Gather, LAYER_GATHER);
+Status X86GatherLayerAcc::Init(Context *context, LayerParam *param, LayerResource *resource,
+                               const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    RETURN_ON_NEQ(X86LayerAcc::Init(context, param, resource, inputs, outputs), TNN_OK);
+
+    auto layer_param    = dynamic_cast<GatherLayerParam *>(param);
+    auto layer_resource = dynamic_cast<GatherLayerResource *>(resource);
+    CHECK_PARAM_NULL(layer_param);
+    if (!layer_param->data_in_resource || !layer_resource ||
+        outputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return TNN_OK;
+    }
+
+    // low precision keeps embedding tables as fp16, which halves the bytes of every gathered row
+    auto &data = layer_resource->data;
+    if (context_->GetPrecision() == PRECISION_LOW && X86HalfWeightSupported() &&
+        data.GetDataType() == DATA_TYPE_FLOAT) {
+        int count         = data.GetDataCount();
+        buffer_data_half_ = RawBuffer(count * sizeof(uint16_t));
+        ConvertFromFloatToHalf(data.force_to<float *>(), buffer_data_half_.force_to<void *>(), count);
+        buffer_data_half_.SetDataType(DATA_TYPE_HALF);
+    }
+    return TNN_OK;
+}
 
 Status X86GatherLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto layer_param = dynamic_cast<GatherLayerParam*>(param_);
@@ -32,9 +56,16 @@ Status X86GatherLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
     
     DimsVector input_data_dims;
     char *input_data_ptr = nullptr;
+    // fp16 rows are expanded to the fp32 output
+    bool half_data = false;
     if (layer_param->data_in_resource) {
         input_data_dims = layer_resource->data.GetBufferDims();
         input_data_ptr = layer_resource->data.force_to<char*>();
+        if (buffer_data_half_.GetBytesSize() > 0) {
+            input_data_ptr = buffer_data_half_.force_to<char*>();
+        }
+        half_data = buffer_data_half_.GetBytesSize() > 0 || layer_resource->data.GetDataType() == DATA_TYPE_HALF;
+        half_data = half_data && outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT;
     } else {
         input_data_dims = (*(inputs.begin()))->GetBlobDesc().dims;
         input_data_ptr = handle_ptr<char*>((*(inputs.begin()))->GetHandle());
@@ -50,6 +81,29 @@ Status X86GatherLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
         indices_data_ptr = handle_ptr<int *>((*(inputs.rbegin()))->GetHandle());
     }
     
+    // embedding lookup: whole rows of a 2-D table, which may be stored as fp16 or int8 with per-row scale
+    if (layer_param->data_in_resource && axis == 0 && input_data_dims.size() == 2 &&
+        outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
+        void *table            = input_data_ptr;
+        DataType table_type    = half_data ? DATA_TYPE_HALF : layer_resource->data.GetDataType();
+        const float *row_scale = nullptr;
+        if (table_type == DATA_TYPE_INT8) {
+            if (layer_resource->scale_data.GetDataCount() != input_data_dims[0]) {
+                LOGE("X86GatherLayerAcc::Forward int8 data needs one scale per row\n");
+                return Status(TNNERR_MODEL_ERR, "X86GatherLayerAcc::Forward int8 data needs one scale per row");
+            }
+            row_scale = layer_resource->scale_data.force_to<float *>();
+        }
+        return X86EmbeddingGather(handle_ptr<float *>(outputs[0]->GetHandle()), table, table_type, row_scale,
+                                  input_data_dims[0], input_data_dims[1], indices_data_ptr,
+                                  DimsVectorUtils::Count(indices_dims));
+    }
+    if (layer_param->data_in_resource && layer_resource->data.GetDataType() == DATA_TYPE_INT8 &&
+        outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
+        LOGE("X86GatherLayerAcc::Forward int8 data is only supported for 2-D tables gathered on axis 0\n");
+        return Status(TNNERR_LAYER_ERR, "X86GatherLayerAcc::Forward int8 data is only supported on axis 0");
+    }
+
     const int slice_size = DimsVectorUtils::Count(input_data_dims, axis+1);
     const int input_slice_count = DimsVectorUtils::Count(input_data_dims, axis, axis+1);
     const int batch = DimsVectorUtils::Count(input_data_dims, 0, axis);
@@ -72,9 +126,14 @@ Status X86GatherLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
             int input_index = input_index_b + slice_index*slice_size;
             int output_index = output_index_b + i*slice_size;
             
-            memcpy(output_data_ptr + output_index*ele_size,
-                   input_data_ptr + input_index*ele_size,
-                   slice_size * ele_size);
+            if (half_data) {
+                X86HalfToFloat(reinterpret_cast<float *>(output_data_ptr) + output_index,
+                               reinterpret_cast<uint16_t *>(input_data_ptr) + input_index, slice_size);
+            } else {
+                memcpy(output_data_ptr + output_index*ele_size,
+                       input_data_ptr + input_index*ele_size,
+                       slice_size * ele_size);
+            }
         }
     }
     return TNN_OK;
@@ -19,51 +19,68 @@
 
 namespace TNN_NS {
 
-template <typename VEC>
-static VEC fast_erf_approximation(const VEC x) {
-    auto t = VEC::div(VEC(1.f), VEC(1.f) + VEC(0.5f) * VEC::abs(x));
-    auto t_2 = t * t;
-    auto t_3 = t_2 * t;
-    auto t_4 = t_3 * t;
-    auto t_5 = t_4 * t;
-    auto t_6 = t_5 * t;
-    auto t_7 = t_6 * t;
-    auto t_8 = t_7 * t;
-    auto t_9 = t_8 * t;
-
-    auto v = t * VEC::exp(VEC::neg(x) * x - VEC(1.26551223) +
-                             VEC(1.00002368) * t +
-                             VEC(0.37409196) * t_2 +
-                             VEC(0.09678418) * t_3 -
-                             VEC(0.18628806) * t_4 +
-                             VEC(0.27886807) * t_5 -
-                             VEC(1.13520398) * t_6 +
-                             VEC(1.48851587) * t_7 -
-                             VEC(0.82215223) * t_8 +
-                             VEC(0.17087277) * t_9);
-    auto v_pos = VEC(1.f) - v;
-    auto v_neg = v - VEC(1.f);
-
-    return VEC::bsl_cge(x, VEC(0.f), v_pos, v_neg);
+/*
+gelu(x) = x * (1 + erf(x / sqrt(2))) / 2, with erfc(|z|) = t * poly(t) * exp(-z^2) and t = 1 / (1 + p * |z|),
+Abramowitz and Stegun 7.1.26, absolute error of erf below 1.5e-7. low precision takes the faster exp.
+*/
+template <typename VEC, bool fast>
+static inline VEC gelu_approximation(const VEC &v) {
+    auto z = v * VEC(0.707106781f);
+    auto t = VEC::div(VEC(1.f), VEC(1.f) + VEC(0.3275911f) * VEC::abs(z));
+    auto p = VEC(1.061405429f) * t + VEC(-1.453152027f);
+    p      = p * t + VEC(1.421413741f);
+    p      = p * t + VEC(-0.284496736f);
+    p      = p * t + VEC(0.254829592f);
+    auto e = fast ? VEC::fast_exp(VEC::neg(z) * z) : VEC::exp(VEC::neg(z) * z);
+    // erfc(z) / 2 for x >= 0, erfc(-z) / 2 = 1 - erfc(z) / 2 for x < 0
+    auto half_erfc = VEC(0.5f) * p * t * e;
+    return v * VEC::bsl_cge(v, VEC(0.f), VEC(1.f) - half_erfc, half_erfc);
 }
 
-typedef struct x86_gelu_operator : x86_unary2_operator {
+template <bool fast>
+struct x86_gelu_operator : x86_unary2_operator {
     virtual float operator()(const float v) {
         return 0.5f * v * (erff(v * 0.707106793288165f) + 1.0f);
     }
 
     virtual Float4 operator()(const Float4 &v) {
-        return Float4(0.5f) * v * (fast_erf_approximation<Float4>(v * Float4(0.707106793288165f)) + Float4(1.f));
+        return gelu_approximation<Float4, fast>(v);
     }
 
     virtual Float8 operator()(const Float8 &v) {
-        return Float8(0.5f) * v * (fast_erf_approximation<Float8>(v * Float8(0.707106793288165f)) + Float8(1.f));
+        return gelu_approximation<Float8, fast>(v);
     }
-} X86_GELU_OP;
+};
+
+typedef x86_gelu_operator<false> X86_GELU_OP;
+typedef x86_gelu_operator<true> X86_GELU_FAST_OP;
 
 X86_REGISTER_UNARY2_KERNEL(LAYER_GELU, avx2, unary2_kernel_avx<X86_GELU_OP>);
 X86_REGISTER_UNARY2_KERNEL(LAYER_GELU, sse42, unary2_kernel_sse<X86_GELU_OP>);
-DECLARE_X86_UNARY2_ACC(Gelu, LAYER_GELU);
+
+class X86GeluLayerAcc : public X86Unary2LayerAcc {
+public:
+    X86GeluLayerAcc() {
+        type_ = LAYER_GELU;
+    }
+    virtual ~X86GeluLayerAcc() {}
+
+    virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override {
+        if (context_->GetPrecision() != PRECISION_LOW) {
+            return X86Unary2LayerAcc::DoForward(inputs, outputs);
+        }
+        auto dims        = outputs[0]->GetBlobDesc().dims;
+        auto input_data  = handle_ptr<float *>(inputs[0]->GetHandle());
+        auto output_data = handle_ptr<float *>(outputs[0]->GetHandle());
+        if (arch_ == avx2) {
+            unary2_kernel_avx<X86_GELU_FAST_OP>(dims, input_data, output_data, param_);
+        } else {
+            unary2_kernel_sse<X86_GELU_FAST_OP>(dims, input_data, output_data, param_);
+        }
+        return TNN_OK;
+    }
+};
+
 REGISTER_X86_ACC(Gelu, LAYER_GELU);
 
-}   // namespace TNN_NS
\ No newline at end of file
+}   // namespace TNN_NS
@@ -12,6 +12,8 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <algorithm>
+
 #include "tnn/device/x86/x86_common.h"
 #include "tnn/device/x86/x86_context.h"
 #include "tnn/device/x86/x86_util.h"
@@ -19,7 +21,10 @@
 #include "tnn/device/x86/acc/compute/x86_compute.h"
 #include "tnn/device/x86/acc/compute/x86_compute_int8.h"
 #include "tnn/device/x86/acc/x86_inner_product_layer_acc.h"
+#include "tnn/device/x86/acc/x86_tune_utils.h"
 #include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/half_utils.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 using namespace x86;
@@ -57,8 +62,23 @@ Status X86InnerProductLayerAcc::Init(Context *context, LayerParam *param, LayerR
     auto res = dynamic_cast<InnerProductLayerResource *>(resource);
     CHECK_PARAM_NULL(res);
 
+    // the optimizer keeps dynamic range quantized weights int8, see NetOptimizerDynamicRangeDequant.
+    // they run as a dynamic int8 gemm under low precision, and stay int8 for the memory bound sgemv otherwise.
+    bool dynamic_range = param->dynamic_range_quantized && res->weight_handle.GetDataType() == DATA_TYPE_INT8 &&
+                         outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT;
+    dynamic_int8_      = dynamic_range && context_->GetPrecision() == PRECISION_LOW;
+    int8_weight_       = dynamic_range && !dynamic_int8_ && impl_ == InnerProductSgemv;
+
     Status ret;
-    if (res->weight_handle.GetDataType() == DATA_TYPE_HALF) {
+    if (dynamic_range && !dynamic_int8_ && !int8_weight_) {
+        // the sgemm packs fp32 weights, the dequantized copy is freed once they are packed
+        auto fp32_res           = new InnerProductLayerResource();
+        fp32_res->weight_handle = ConvertInt8Handle(res->weight_handle, res->scale_handle,
+                                                    DimsVectorUtils::Count(input_dims, 1));
+        fp32_res->bias_handle   = ConvertHalfHandle(res->bias_handle);
+        fc_acc_f32_resource_    = std::shared_ptr<LayerResource>(fp32_res);
+        ret = X86LayerAcc::Init(context, param, fc_acc_f32_resource_.get(), inputs, outputs);
+    } else if (res->weight_handle.GetDataType() == DATA_TYPE_HALF) {
         LayerResource *fp32_res = nullptr;
         RETURN_ON_NEQ(ConvertHalfResource(LAYER_INNER_PRODUCT, res, &fp32_res), TNN_OK);
         fc_acc_f32_resource_ = std::shared_ptr<LayerResource>(fp32_res);
@@ -68,9 +88,22 @@ Status X86InnerProductLayerAcc::Init(Context *context, LayerParam *param, LayerR
     }
 
     RETURN_ON_NEQ(ret, TNN_OK);
-    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
     RETURN_ON_NEQ(allocateBufferBias(inputs, outputs), TNN_OK);
 
+    // low precision keeps the weights as fp16 for the memory bound sgemv
+    half_weight_ = context_->GetPrecision() == PRECISION_LOW && arch_ == avx2 && X86HalfWeightSupported() &&
+                   outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT && !dynamic_int8_;
+    if (dynamic_int8_) {
+        return allocateBufferDynamicWeight(inputs, outputs);
+    } else if (int8_weight_) {
+        return allocateBufferInt8Weight(inputs, outputs);
+    } else if (half_weight_) {
+        impl_ = InnerProductSgemv;
+    } else if (context_->GetEnableTuneKernel() && outputs[0]->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
+        RETURN_ON_NEQ(TuneImpl(inputs, outputs), TNN_OK);
+    }
+    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+
     // converted weights are assumed to be packed, and can be freed now
     if (fc_acc_f32_resource_) {
         fc_acc_f32_resource_.reset();
@@ -81,6 +114,60 @@ Status X86InnerProductLayerAcc::Init(Context *context, LayerParam *param, LayerR
 
 X86InnerProductLayerAcc::~X86InnerProductLayerAcc() {}
 
+// the result is saved as {impl, K_c_}
+Status X86InnerProductLayerAcc::TuneImpl(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<InnerProductLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    auto num_threads = context_->GetNumThreads();
+    auto key = GetTuneKey("inner_product", inputs, outputs, {param->has_bias, param->axis}, num_threads);
+
+    std::vector<std::vector<int>> candidates = {{InnerProductSgemv, 0}};
+    for (auto k_c : {128, 256, 512}) {
+        candidates.push_back({InnerProductSgemm, k_c});
+    }
+
+    // a cached result that is none of the candidates comes from an edited or corrupt cache file, tune again
+    std::vector<int> best;
+    if (!context_->GetTuneResult(key, best) ||
+        std::find(candidates.begin(), candidates.end(), best) == candidates.end()) {
+        best.clear();
+        TuneBlobs tune_inputs(inputs);
+        TuneBlobs tune_outputs(outputs);
+        OMP_SET_THREADS_(num_threads);
+        float best_time = -1.f;
+        for (const auto &candidate : candidates) {
+            impl_ = (InnerProductCompute)candidate[0];
+            conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+            if (candidate[1] > 0) {
+                conv_gemm_conf_.K_c_ = candidate[1];
+            }
+            buffer_weight_ = RawBuffer();
+            RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+            float time = TimeKernel([&]() { return DoForward(tune_inputs.GetBlobs(), tune_outputs.GetBlobs()); });
+            LOGD("X86 inner product tune %s: impl %d k_c %d, %.3f ms\n", key.c_str(), candidate[0], candidate[1],
+                 time);
+            if (time >= 0 && (best_time < 0 || time < best_time)) {
+                best_time = time;
+                best      = candidate;
+            }
+        }
+        if (best.size() != 2) {
+            return Status(TNNERR_LAYER_ERR, "x86 inner product tune failed");
+        }
+        context_->SetTuneResult(key, best);
+    }
+
+    if (impl_ != best[0] || conv_gemm_conf_.K_c_ != best[1]) {
+        buffer_weight_ = RawBuffer();
+    }
+    impl_           = (InnerProductCompute)best[0];
+    conv_gemm_conf_ = conv_gemm_config<float, float, float>();
+    if (best[1] > 0) {
+        conv_gemm_conf_.K_c_ = best[1];
+    }
+    return TNN_OK;
+}
+
 Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     InnerProductLayerParam *param = dynamic_cast<InnerProductLayerParam *>(param_);
     CHECK_PARAM_NULL(param);
@@ -113,8 +200,15 @@ Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &
                     PackC4(dst, src, input_stride, input_stride, input_stride, output_dims[1]);
                 }
 
-                temp_buffer.SetDataType(DATA_TYPE_FLOAT);
-                buffer_weight_ = temp_buffer;
+                if (half_weight_) {
+                    RawBuffer half_buffer(weight_count * sizeof(uint16_t), 32);
+                    ConvertFromFloatToHalf(dst, half_buffer.force_to<void *>(), weight_count);
+                    half_buffer.SetDataType(DATA_TYPE_HALF);
+                    buffer_weight_ = half_buffer;
+                } else {
+                    temp_buffer.SetDataType(DATA_TYPE_FLOAT);
+                    buffer_weight_ = temp_buffer;
+                }
             } else {
                 int k_c = conv_gemm_conf_.K_c_;
                 int m_block = conv_gemm_conf_.m_block_;
@@ -175,6 +269,80 @@ Status X86InnerProductLayerAcc::allocateBufferWeight(const std::vector<Blob *> &
     return TNN_OK;
 }
 
+Status X86InnerProductLayerAcc::allocateBufferDynamicWeight(const std::vector<Blob *> &inputs,
+                                                            const std::vector<Blob *> &outputs) {
+    InnerProductLayerResource *res = dynamic_cast<InnerProductLayerResource *>(resource_);
+    CHECK_PARAM_NULL(res);
+
+    const int K     = DimsVectorUtils::Count(inputs[0]->GetBlobDesc().dims, 1);
+    const int oc    = outputs[0]->GetBlobDesc().dims[1];
+    const int k_r32 = ROUND_UP(K, 32);
+    const int oc_r4 = ROUND_UP(oc, 4);
+
+    auto w_scale = res->scale_handle;
+    if (w_scale.GetDataType() == DATA_TYPE_HALF) {
+        w_scale = ConvertHalfHandle(w_scale);
+    }
+    const int scale_count = w_scale.GetDataCount();
+    if (res->weight_handle.GetDataCount() != oc * K || (scale_count != 1 && scale_count != oc)) {
+        LOGE("Error: dynamic int8 inner product has %d weights and %d scales\n", res->weight_handle.GetDataCount(),
+             scale_count);
+        return Status(TNNERR_MODEL_ERR, "dynamic int8 inner product resource is invalid");
+    }
+
+    RawBuffer weight_buffer(oc_r4 * k_r32, 32);
+    const int8_t *src = res->weight_handle.force_to<int8_t *>();
+    int8_t *dst       = weight_buffer.force_to<int8_t *>();
+    for (int o = 0; o < oc; o++) {
+        memcpy(dst + o * k_r32, src + o * K, K);
+    }
+    weight_buffer.SetDataType(DATA_TYPE_INT8);
+    buffer_weight_ = weight_buffer;
+
+    buffer_scale_    = RawBuffer(oc_r4 * sizeof(float));
+    auto w_scale_ptr = w_scale.force_to<float *>();
+    CHECK_PARAM_NULL(w_scale_ptr);
+    for (int o = 0; o < oc; o++) {
+        buffer_scale_.force_to<float *>()[o] = w_scale_ptr[scale_count == 1 ? 0 : o];
+    }
+    return TNN_OK;
+}
+
+Status X86InnerProductLayerAcc::allocateBufferInt8Weight(const std::vector<Blob *> &inputs,
+                                                         const std::vector<Blob *> &outputs) {
+    InnerProductLayerResource *res = dynamic_cast<InnerProductLayerResource *>(resource_);
+    CHECK_PARAM_NULL(res);
+
+    const int K    = DimsVectorUtils::Count(inputs[0]->GetBlobDesc().dims, 1);
+    const int oc   = outputs[0]->GetBlobDesc().dims[1];
+    const int pack = arch_ == avx2 ? 8 : 4;
+
+    auto w_scale = res->scale_handle;
+    if (w_scale.GetDataType() == DATA_TYPE_HALF) {
+        w_scale = ConvertHalfHandle(w_scale);
+    }
+    const int scale_count = w_scale.GetDataCount();
+    if (res->weight_handle.GetDataCount() != oc * K || (scale_count != 1 && scale_count != oc)) {
+        LOGE("Error: int8 weight inner product has %d weights and %d scales\n", res->weight_handle.GetDataCount(),
+             scale_count);
+        return Status(TNNERR_MODEL_ERR, "int8 weight inner product resource is invalid");
+    }
+
+    RawBuffer weight_buffer(ROUND_UP(oc, pack) * K, 32);
+    X86SgemvPackInt8(weight_buffer.force_to<int8_t *>(), res->weight_handle.force_to<int8_t *>(), K, oc, pack, K, 1);
+    weight_buffer.SetDataType(DATA_TYPE_INT8);
+    buffer_weight_ = weight_buffer;
+
+    // padded to whole vectors, the sgemv scales full blocks
+    buffer_scale_    = RawBuffer(ROUND_UP(oc, pack) * sizeof(float));
+    auto w_scale_ptr = w_scale.force_to<float *>();
+    CHECK_PARAM_NULL(w_scale_ptr);
+    for (int o = 0; o < oc; o++) {
+        buffer_scale_.force_to<float *>()[o] = w_scale_ptr[scale_count == 1 ? 0 : o];
+    }
+    return TNN_OK;
+}
+
 Status X86InnerProductLayerAcc::allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     InnerProductLayerParam *param = dynamic_cast<InnerProductLayerParam *>(param_);
     CHECK_PARAM_NULL(param);
@@ -183,13 +351,16 @@ Status X86InnerProductLayerAcc::allocateBufferBias(const std::vector<Blob *> &in
 
     auto dims_output = outputs[0]->GetBlobDesc().dims;
     if (!buffer_bias_.GetBytesSize()) {
+        // the dynamic range paths keep the source resource, whose bias may still be half
+        auto bias_handle = res->bias_handle;
+        if (bias_handle.GetDataType() == DATA_TYPE_HALF) {
+            bias_handle = ConvertHalfHandle(bias_handle);
+        }
         // int8 bias needs oc_r4 memory space 
-        int total_byte_size = ROUND_UP(dims_output[1], 4) * DataTypeUtils::GetBytesSize(res->bias_handle.GetDataType());
+        int total_byte_size = ROUND_UP(dims_output[1], 4) * DataTypeUtils::GetBytesSize(bias_handle.GetDataType());
         RawBuffer temp_buffer(total_byte_size);
         if (param->has_bias) {
-            const int bias_handle_size    = res->bias_handle.GetBytesSize();
-            const float *bias_handle_data = res->bias_handle.force_to<float *>();
-            memcpy(temp_buffer.force_to<float *>(), res->bias_handle.force_to<float *>(), bias_handle_size);
+            memcpy(temp_buffer.force_to<float *>(), bias_handle.force_to<float *>(), bias_handle.GetBytesSize());
         }
         buffer_bias_ = temp_buffer;
     }
@@ -234,12 +405,27 @@ Status X86InnerProductLayerAcc::DoForward(const std::vector<Blob *> &inputs, con
     auto input_dims   = inputs[0]->GetBlobDesc().dims;
     auto output_dims  = outputs[0]->GetBlobDesc().dims;
 
-    if (output_blob->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
+    if (output_blob->GetBlobDesc().data_type == DATA_TYPE_FLOAT && dynamic_int8_) {
+        const int rows  = input_dims[0];
+        const int K     = DimsVectorUtils::Count(input_dims, 1);
+        const int oc    = output_dims[1];
+        const int k_r32 = ROUND_UP(K, 32);
+
+        size_t src_bytes = ROUND_UP(rows * k_r32, 32);
+        auto workspace   = reinterpret_cast<int8_t *>(context_->GetSharedWorkSpace(src_bytes + rows * sizeof(float)));
+        auto src_scale   = reinterpret_cast<float *>(workspace + src_bytes);
+        X86QuantizeRowsInt8(workspace, src_scale, handle_ptr<float *>(input_blob->GetHandle()), rows, K, k_r32);
+        X86DynamicGemmInt8(handle_ptr<float *>(output_blob->GetHandle()), workspace, src_scale,
+                           buffer_weight_.force_to<int8_t *>(), buffer_scale_.force_to<float *>(),
+                           buffer_bias_.force_to<float *>(), rows, oc, k_r32, oc);
+    } else if (output_blob->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
         auto X86SgemvFunc = X86Sgemv<Float4, 4>;
         void (*X86VecAddFunc)(float*, const float*, long) = X86_VectorAdd<Float4, 4>;
+        int pack = 4;
         if (arch_ == avx2) {
             X86SgemvFunc = X86Sgemv<Float8, 8>;
             X86VecAddFunc = X86_VectorAdd<Float8, 8>;
+            pack = 8;
         }
 
         float *input_data  = handle_ptr<float*>(input_blob->GetHandle());
@@ -248,7 +434,25 @@ Status X86InnerProductLayerAcc::DoForward(const std::vector<Blob *> &inputs, con
         float *bias_data   = buffer_bias_.force_to<float *>();
 
         if (impl_ == InnerProductSgemv) {
-            X86SgemvFunc(output_data, input_data, weight_data, bias_data, input_dims, output_dims);
+            int K = DimsVectorUtils::Count(input_dims, 1);
+            auto plan = X86SgemvPartition(output_dims[0], output_dims[1], K, pack, context_->GetNumThreads());
+            size_t workspace_size = X86SgemvWorkspaceSize(plan, output_dims[0], output_dims[1], K, pack);
+            float *workspace = nullptr;
+            if (workspace_size > 0) {
+                workspace = reinterpret_cast<float *>(context_->GetSharedWorkSpace(workspace_size));
+            }
+            if (buffer_weight_.GetDataType() == DATA_TYPE_HALF) {
+                X86SgemvHalf(output_data, input_data, buffer_weight_.force_to<uint16_t *>(), bias_data, input_dims,
+                             output_dims, plan, workspace);
+            } else if (buffer_weight_.GetDataType() == DATA_TYPE_INT8) {
+                auto X86SgemvInt8Func = arch_ == avx2 ? X86SgemvInt8<Float8, 8> : X86SgemvInt8<Float4, 4>;
+                X86SgemvInt8Func(output_data, input_data, buffer_weight_.force_to<int8_t *>(),
+                                 buffer_scale_.force_to<float *>(), bias_data, output_dims[0], output_dims[1], K,
+                                 plan, workspace);
+            } else {
+                X86SgemvFunc(output_data, input_data, weight_data, bias_data, input_dims, output_dims, plan,
+                             workspace);
+            }
         } else {
             int k_c = conv_gemm_conf_.K_c_;
             int n_block = conv_gemm_conf_.n_block_;
@@ -33,13 +33,26 @@ public:
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
     virtual Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
     virtual Status allocateBufferBias(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    // int8 weights of a dynamic int8 gemm, rows padded to 32 and channels to 4, and per channel scales
+    virtual Status allocateBufferDynamicWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    // int8 weights packed for X86SgemvInt8, and per channel scales
+    virtual Status allocateBufferInt8Weight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
 
 protected:
+    // time sgemv and sgemm with different K_c_, keep the fastest impl and its packed weights
+    Status TuneImpl(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+
     RawBuffer buffer_weight_;
     RawBuffer buffer_bias_;
     RawBuffer buffer_scale_;
     conv_gemm_config<float, float, float> conv_gemm_conf_;
     InnerProductCompute impl_;
+    // sgemv weights are stored as fp16, see X86SgemvHalf
+    bool half_weight_ = false;
+    // dynamic range quantized weights kept int8, the input is quantized per row in DoForward
+    bool dynamic_int8_ = false;
+    // dynamic range quantized weights kept int8 and dequantized inside the sgemv, see X86SgemvInt8
+    bool int8_weight_ = false;
     std::shared_ptr<LayerResource> fc_acc_f32_resource_ = nullptr;
 };
 
@@ -16,6 +16,7 @@
 #include "tnn/device/x86/acc/x86_layer_acc.h"
 #include "tnn/utils/data_type_utils.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/omp_utils.h"
 
 #include "tnn/device/x86/acc/Float4.h"
 #include "tnn/device/x86/acc/Float8.h"
@@ -23,12 +24,14 @@ namespace TNN_NS {
 
 DECLARE_X86_ACC(LayerNorm, LAYER_LAYER_NORM);
 
+// rows are independent, they are normalized in parallel
 template <typename VEC, int pack>
 static void norm_func(float *input, float *output, int channels, int area, const float *k_data, const float *b_data,
                       float ep) {
-    float *input_data  = input;
-    float *output_data = output;
+    OMP_PARALLEL_FOR_
     for (int c = 0; c < channels; c++) {
+        float *input_data  = input + (size_t)c * area;
+        float *output_data = output + (size_t)c * area;
         // step 1: calc varience
         VEC v_sum_x  = VEC(0.f);
         VEC v_sum_x2 = VEC(0.f);
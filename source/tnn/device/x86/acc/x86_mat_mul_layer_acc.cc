@@ -12,10 +12,17 @@
 // CONDITIONS OF ANY KIND, either express or implied. See the License for the
 // specific language governing permissions and limitations under the License.
 
+#include <algorithm>
+
 #include "tnn/device/x86/acc/x86_layer_acc.h"
 #include "tnn/utils/dims_vector_utils.h"
 #include "tnn/device/x86/acc/x86_mat_mul_layer_acc.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/device/x86/acc/compute/x86_compute_int8.h"
+#include "tnn/device/x86/acc/x86_tune_utils.h"
 #include "tnn/interpreter/layer_resource_generator.h"
+#include "tnn/utils/half_utils.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 
@@ -27,12 +34,29 @@ Status X86MatMulLayerAcc::Init(Context *context, LayerParam *param, LayerResourc
     if (inputs.size() == 2) {
         ret = X86LayerAcc::Init(context, param, resource, inputs, outputs);
         RETURN_ON_NEQ(ret, TNN_OK);
+        if (context_->GetEnableTuneKernel()) {
+            RETURN_ON_NEQ(TuneBlockSize(inputs, outputs), TNN_OK);
+        }
         return TNN_OK;
     }
 
     auto res = dynamic_cast<MatMulLayerResource *>(resource);
     CHECK_PARAM_NULL(res);
-
+    // the optimizer keeps dynamic range quantized weights int8, see NetOptimizerDynamicRangeDequant.
+    // they run as a dynamic int8 gemm under low precision, and are dequantized inside the fp32 kernels otherwise.
+    if (param->dynamic_range_quantized && res->weight.GetDataType() == DATA_TYPE_INT8) {
+        RETURN_ON_NEQ(X86LayerAcc::Init(context, param, resource, inputs, outputs), TNN_OK);
+        if (context_->GetPrecision() == PRECISION_LOW) {
+            dynamic_int8_ = true;
+            return allocateBufferDynamicWeight(inputs, outputs);
+        }
+        int8_weight_ = true;
+        RETURN_ON_NEQ(allocateBufferInt8Weight(inputs, outputs), TNN_OK);
+        if (context_->GetEnableTuneKernel()) {
+            RETURN_ON_NEQ(TuneBlockSize(inputs, outputs), TNN_OK);
+        }
+        return TNN_OK;
+    }
     if (res->weight.GetDataType() == DATA_TYPE_HALF) {
         LayerResource *fp32_res = nullptr;
         RETURN_ON_NEQ(ConvertHalfResource(LAYER_MATMUL, res, &fp32_res), TNN_OK);
@@ -43,6 +67,237 @@ Status X86MatMulLayerAcc::Init(Context *context, LayerParam *param, LayerResourc
     }
 
     RETURN_ON_NEQ(ret, TNN_OK);
+    // the fp32 weight is kept besides the packed one, a reshape may give A more rows than the gemv takes
+    RETURN_ON_NEQ(allocateBufferWeight(inputs, outputs), TNN_OK);
+    if (context_->GetEnableTuneKernel()) {
+        RETURN_ON_NEQ(TuneBlockSize(inputs, outputs), TNN_OK);
+    }
+    return TNN_OK;
+}
+
+// a constant B of a gemv is packed for X86Sgemv, as fp16 under low precision
+Status X86MatMulLayerAcc::allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<MatMulLayerParam *>(param_);
+    auto res   = dynamic_cast<MatMulLayerResource *>(resource_);
+    CHECK_PARAM_NULL(param);
+    CHECK_PARAM_NULL(res);
+
+    auto matrix_a_dims = param->matrix_a_dims;
+    auto matrix_b_dims = param->matrix_b_dims;
+    if (matrix_a_dims.size() == 1) {
+        matrix_a_dims.insert(matrix_a_dims.begin(), 1);
+    }
+    if (param->weight_position != 1 || matrix_b_dims.size() < 2 || matrix_a_dims[matrix_a_dims.size() - 2] > 4 ||
+        inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT || res->weight.GetDataType() != DATA_TYPE_FLOAT) {
+        return TNN_OK;
+    }
+
+    int pack    = arch_ == avx2 ? 8 : 4;
+    int M       = matrix_b_dims[matrix_b_dims.size() - 1];
+    int K       = matrix_b_dims[matrix_b_dims.size() - 2];
+    int batch_b = DimsVectorUtils::Count(matrix_b_dims) / (M * K);
+    size_t pack_count = (size_t)ROUND_UP(M, pack) * K;
+
+    RawBuffer packed(batch_b * pack_count * sizeof(float), 32);
+    for (int b = 0; b < batch_b; b++) {
+        X86SgemvPackRowMajor(packed.force_to<float *>() + b * pack_count, res->weight.force_to<float *>() + b * M * K,
+                             K, M, pack);
+    }
+    packed.SetDataType(DATA_TYPE_FLOAT);
+
+    if (context_->GetPrecision() == PRECISION_LOW && arch_ == avx2 && X86HalfWeightSupported()) {
+        RawBuffer half_buffer(batch_b * pack_count * sizeof(uint16_t), 32);
+        ConvertFromFloatToHalf(packed.force_to<float *>(), half_buffer.force_to<void *>(), batch_b * pack_count);
+        half_buffer.SetDataType(DATA_TYPE_HALF);
+        packed = half_buffer;
+    }
+    buffer_weight_ = packed;
+    return TNN_OK;
+}
+
+// B[K][M] of every batch is stored as M_r4 rows of K_r32 int8
+Status X86MatMulLayerAcc::allocateBufferDynamicWeight(const std::vector<Blob *> &inputs,
+                                                      const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<MatMulLayerParam *>(param_);
+    auto res   = dynamic_cast<MatMulLayerResource *>(resource_);
+    CHECK_PARAM_NULL(param);
+    CHECK_PARAM_NULL(res);
+
+    auto matrix_b_dims = param->matrix_b_dims;
+    if (param->weight_position != 1 || matrix_b_dims.size() < 2 ||
+        inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_LAYER_ERR, "x86 dynamic int8 matmul needs a constant B and a float A");
+    }
+    const int M       = matrix_b_dims[matrix_b_dims.size() - 1];
+    const int K       = matrix_b_dims[matrix_b_dims.size() - 2];
+    const int batch_b = DimsVectorUtils::Count(matrix_b_dims) / (M * K);
+    const int m_r4    = ROUND_UP(M, 4);
+    const int k_r32   = ROUND_UP(K, 32);
+
+    RETURN_ON_NEQ(allocateBufferWeightScale(M, 4), TNN_OK);
+
+    RawBuffer weight_buffer((size_t)batch_b * m_r4 * k_r32, 32);
+    for (int b = 0; b < batch_b; b++) {
+        const int8_t *src = res->weight.force_to<int8_t *>() + (size_t)b * K * M;
+        int8_t *dst       = weight_buffer.force_to<int8_t *>() + (size_t)b * m_r4 * k_r32;
+        for (int k = 0; k < K; k++) {
+            for (int m = 0; m < M; m++) {
+                dst[m * k_r32 + k] = src[k * M + m];
+            }
+        }
+    }
+    weight_buffer.SetDataType(DATA_TYPE_INT8);
+    buffer_weight_ = weight_buffer;
+    return TNN_OK;
+}
+
+Status X86MatMulLayerAcc::allocateBufferInt8Weight(const std::vector<Blob *> &inputs,
+                                                   const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<MatMulLayerParam *>(param_);
+    auto res   = dynamic_cast<MatMulLayerResource *>(resource_);
+    CHECK_PARAM_NULL(param);
+    CHECK_PARAM_NULL(res);
+
+    auto matrix_a_dims = param->matrix_a_dims;
+    auto matrix_b_dims = param->matrix_b_dims;
+    if (matrix_a_dims.size() == 1) {
+        matrix_a_dims.insert(matrix_a_dims.begin(), 1);
+    }
+    if (param->weight_position != 1 || matrix_b_dims.size() < 2 ||
+        inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return Status(TNNERR_LAYER_ERR, "x86 int8 weight matmul needs a constant B and a float A");
+    }
+    const int M       = matrix_b_dims[matrix_b_dims.size() - 1];
+    const int K       = matrix_b_dims[matrix_b_dims.size() - 2];
+    const int batch_b = DimsVectorUtils::Count(matrix_b_dims) / (M * K);
+    const int pack    = arch_ == avx2 ? 8 : 4;
+    RETURN_ON_NEQ(allocateBufferWeightScale(M, pack), TNN_OK);
+
+    // the gemm reads B from the resource, only the memory bound gemv gets a packed copy
+    if (matrix_a_dims[matrix_a_dims.size() - 2] > 4) {
+        return TNN_OK;
+    }
+    size_t pack_count = (size_t)ROUND_UP(M, pack) * K;
+    RawBuffer packed(batch_b * pack_count, 32);
+    for (int b = 0; b < batch_b; b++) {
+        X86SgemvPackInt8(packed.force_to<int8_t *>() + b * pack_count, res->weight.force_to<int8_t *>() + b * M * K, K,
+                         M, pack, 1, M);
+    }
+    packed.SetDataType(DATA_TYPE_INT8);
+    buffer_weight_ = packed;
+    return TNN_OK;
+}
+
+// per column scales of an int8 B, padded to a multiple of pad
+Status X86MatMulLayerAcc::allocateBufferWeightScale(int M, int pad) {
+    auto res = dynamic_cast<MatMulLayerResource *>(resource_);
+    CHECK_PARAM_NULL(res);
+
+    auto w_scale = res->scale_handle;
+    if (w_scale.GetDataType() == DATA_TYPE_HALF) {
+        w_scale = ConvertHalfHandle(w_scale);
+    }
+    const int scale_count = w_scale.GetDataCount();
+    if (scale_count != 1 && scale_count != M) {
+        LOGE("Error: int8 weight matmul has %d scales for %d columns\n", scale_count, M);
+        return Status(TNNERR_MODEL_ERR, "int8 weight matmul scale is invalid");
+    }
+
+    buffer_weight_scale_ = RawBuffer(ROUND_UP(M, pad) * sizeof(float));
+    auto w_scale_ptr     = w_scale.force_to<float *>();
+    CHECK_PARAM_NULL(w_scale_ptr);
+    for (int m = 0; m < M; m++) {
+        buffer_weight_scale_.force_to<float *>()[m] = w_scale_ptr[scale_count == 1 ? 0 : m];
+    }
+    return TNN_OK;
+}
+
+Status X86MatMulLayerAcc::DoForwardDynamicInt8(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param               = dynamic_cast<MatMulLayerParam *>(param_);
+    DimsVector matrix_a_dims = param->matrix_a_dims;
+    DimsVector matrix_b_dims = param->matrix_b_dims;
+    if (matrix_a_dims.size() == 1) {
+        matrix_a_dims.insert(matrix_a_dims.begin(), 1);
+    }
+    auto matrix_c_dims = outputs[0]->GetBlobDesc().dims;
+
+    const int M       = matrix_b_dims[matrix_b_dims.size() - 1];
+    const int K       = matrix_a_dims[matrix_a_dims.size() - 1];
+    const int N       = matrix_a_dims[matrix_a_dims.size() - 2];
+    const int batch_a = DimsVectorUtils::Count(matrix_a_dims) / (K * N);
+    const int batch_b = DimsVectorUtils::Count(matrix_b_dims) / (M * K);
+    const int batch_c = DimsVectorUtils::Count(matrix_c_dims) / (M * N);
+    const int k_r32   = ROUND_UP(K, 32);
+    const int m_r4    = ROUND_UP(M, 4);
+
+    // every batch of A is quantized once, B is shared by the batches of C when batch_b is 1
+    size_t src_bytes = ROUND_UP((size_t)batch_a * N * k_r32, 32);
+    auto workspace   = reinterpret_cast<int8_t *>(
+        context_->GetSharedWorkSpace(src_bytes + (size_t)batch_a * N * sizeof(float)));
+    auto src_scale = reinterpret_cast<float *>(workspace + src_bytes);
+    auto matrix_a  = handle_ptr<float *>(inputs[0]->GetHandle());
+    auto matrix_c  = handle_ptr<float *>(outputs[0]->GetHandle());
+    X86QuantizeRowsInt8(workspace, src_scale, matrix_a, batch_a * N, K, k_r32);
+
+    for (int bc = 0; bc < batch_c; ++bc) {
+        int ba = bc < batch_a ? bc : 0;
+        int bb = bc < batch_b ? bc : 0;
+        X86DynamicGemmInt8(matrix_c + (size_t)bc * M * N, workspace + (size_t)ba * N * k_r32, src_scale + ba * N,
+                           buffer_weight_.force_to<int8_t *>() + (size_t)bb * m_r4 * k_r32,
+                           buffer_weight_scale_.force_to<float *>(), nullptr, N, M, k_r32, M);
+    }
+    return TNN_OK;
+}
+
+// the result is saved as {M_c_, K_c_}
+Status X86MatMulLayerAcc::TuneBlockSize(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
+    auto param = dynamic_cast<MatMulLayerParam *>(param_);
+    CHECK_PARAM_NULL(param);
+    if (inputs[0]->GetBlobDesc().data_type != DATA_TYPE_FLOAT) {
+        return TNN_OK;
+    }
+    // the gemv path of DoForward does not use the gemm blocking
+    auto matrix_a_dims = param->matrix_a_dims;
+    if (matrix_a_dims.size() < 2 || matrix_a_dims[matrix_a_dims.size() - 2] <= 4) {
+        return TNN_OK;
+    }
+    auto num_threads = context_->GetNumThreads();
+    auto key         = GetTuneKey("matmul", inputs, outputs, {param->weight_position}, num_threads);
+
+    std::vector<std::vector<int>> candidates;
+    for (auto m_c : {32, 64, 128}) {
+        for (auto k_c : {128, 256, 512}) {
+            candidates.push_back({m_c, k_c});
+        }
+    }
+
+    // a cached result that is none of the candidates comes from an edited or corrupt cache file, tune again
+    std::vector<int> best;
+    if (!context_->GetTuneResult(key, best) ||
+        std::find(candidates.begin(), candidates.end(), best) == candidates.end()) {
+        best.clear();
+        TuneBlobs tune_inputs(inputs);
+        TuneBlobs tune_outputs(outputs);
+        OMP_SET_THREADS_(num_threads);
+        float best_time = -1.f;
+        for (const auto &candidate : candidates) {
+            conv_gemm_conf_.M_c_ = candidate[0];
+            conv_gemm_conf_.K_c_ = candidate[1];
+            float time = TimeKernel([&]() { return DoForward(tune_inputs.GetBlobs(), tune_outputs.GetBlobs()); });
+            LOGD("X86 matmul tune %s: m_c %d k_c %d, %.3f ms\n", key.c_str(), candidate[0], candidate[1], time);
+            if (time >= 0 && (best_time < 0 || time < best_time)) {
+                best_time = time;
+                best      = candidate;
+            }
+        }
+        if (best.size() != 2) {
+            return Status(TNNERR_LAYER_ERR, "x86 matmul tune failed");
+        }
+        context_->SetTuneResult(key, best);
+    }
+
+    conv_gemm_conf_.M_c_ = best[0];
+    conv_gemm_conf_.K_c_ = best[1];
     return TNN_OK;
 }
 
@@ -59,13 +314,18 @@ Status X86MatMulLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
     }
     DataType data_type       = inputs[0]->GetBlobDesc().data_type;
     auto matrix_c_dims       = outputs[0]->GetBlobDesc().dims;
-    if (data_type == DATA_TYPE_FLOAT) {
+    if (data_type == DATA_TYPE_FLOAT && dynamic_int8_) {
+        return DoForwardDynamicInt8(inputs, outputs);
+    } else if (data_type == DATA_TYPE_FLOAT) {
         float *matrix_a;
         float *matrix_b;
 
         if (inputs.size() == 2) {
             matrix_a = handle_ptr<float *>(inputs[0]->GetHandle());
             matrix_b = handle_ptr<float *>(inputs[1]->GetHandle());
+        } else if (int8_weight_) {
+            matrix_a = handle_ptr<float *>(inputs[0]->GetHandle());
+            matrix_b = nullptr;
         } else {
             auto weight = resource->weight.force_to<float *>();
             matrix_a    = param->weight_position == 0 ? weight : handle_ptr<float *>(inputs[0]->GetHandle());
@@ -81,6 +341,53 @@ Status X86MatMulLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
         int K = matrix_a_dims[matrix_a_dims.size() - 1];
         int N = matrix_a_dims[matrix_a_dims.size() - 2];
 
+        int count_a     = DimsVectorUtils::Count(matrix_a_dims);
+        int count_b     = DimsVectorUtils::Count(matrix_b_dims);
+        int count_c     = DimsVectorUtils::Count(matrix_c_dims);
+        int batch_a   = count_a / (K * N);
+        int batch_b   = count_b / (M * K);
+        int batch_c   = count_c / (M * N);
+
+        // a few rows of A make a memory bound gemv, which is partitioned over M and K instead of packed.
+        // an int8 B without a packed copy goes to the gemm, which dequantizes it while packing
+        if (N <= 4 && (!int8_weight_ || buffer_weight_.GetBytesSize() > 0)) {
+            auto X86SgemvFunc       = X86SgemvRowMajor<Float4, 4>;
+            auto X86SgemvPackedFunc = X86Sgemv<Float4, 4>;
+            auto X86SgemvInt8Func   = X86SgemvInt8<Float4, 4>;
+            int pack                = 4;
+            if (arch_ == avx2) {
+                X86SgemvFunc       = X86SgemvRowMajor<Float8, 8>;
+                X86SgemvPackedFunc = X86Sgemv<Float8, 8>;
+                X86SgemvInt8Func   = X86SgemvInt8<Float8, 8>;
+                pack               = 8;
+            }
+            auto plan = X86SgemvPartition(N, M, K, pack, context_->GetNumThreads());
+            size_t workspace_size = X86SgemvWorkspaceSize(plan, N, M, K, pack);
+            float *workspace      = nullptr;
+            if (workspace_size > 0) {
+                workspace = reinterpret_cast<float *>(context_->GetSharedWorkSpace(workspace_size));
+            }
+            for (int bc = 0; bc < batch_c; ++bc) {
+                int ba = bc < batch_a ? bc : 0;
+                int bb = bc < batch_b ? bc : 0;
+                auto c_ptr = matrix_c + bc * M * N;
+                auto a_ptr = matrix_a + ba * K * N;
+                size_t b_offset = (size_t)bb * ROUND_UP(M, pack) * K;
+                if (buffer_weight_.GetDataType() == DATA_TYPE_HALF) {
+                    X86SgemvHalf(c_ptr, a_ptr, buffer_weight_.force_to<uint16_t *>() + b_offset, nullptr, {N, K},
+                                 {N, M}, plan, workspace);
+                } else if (buffer_weight_.GetDataType() == DATA_TYPE_INT8) {
+                    X86SgemvInt8Func(c_ptr, a_ptr, buffer_weight_.force_to<int8_t *>() + b_offset,
+                                     buffer_weight_scale_.force_to<float *>(), nullptr, N, M, K, plan, workspace);
+                } else if (buffer_weight_.GetBytesSize() > 0) {
+                    X86SgemvPackedFunc(c_ptr, a_ptr, buffer_weight_.force_to<float *>() + b_offset, nullptr, {N, K},
+                                       {N, M}, plan, workspace);
+                } else {
+                    X86SgemvFunc(c_ptr, a_ptr, matrix_b + bb * M * K, nullptr, N, M, K, plan, workspace);
+                }
+            }
+            return TNN_OK;
+        }
         size_t pack_a_size = ROUND_UP(m_c * k_c * sizeof(float), 32);
         size_t pack_b_size = k_c * ROUND_UP(N, n_block) * sizeof(float);
         size_t workspace_size = pack_a_size + pack_b_size;
@@ -89,24 +396,24 @@ Status X86MatMulLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
         RawBuffer fake_bias(N * sizeof(float));
         float *fake_bias_ptr = fake_bias.force_to<float *>();
 
-        int count_a     = DimsVectorUtils::Count(matrix_a_dims);
-        int count_b     = DimsVectorUtils::Count(matrix_b_dims);
-        int count_c     = DimsVectorUtils::Count(matrix_c_dims);
-        int batch_a   = count_a / (K * N);
-        int batch_b   = count_b / (M * K);
-        int batch_c   = count_c / (M * N);
         for (int bc = 0; bc < batch_c; ++bc) {
             int ba = bc < batch_a ? bc : 0;
             int bb = bc < batch_b ? bc : 0;
             auto a_ptr = matrix_a + ba * K * N;
-            auto b_ptr = matrix_b + bb * M * K;
             auto c_ptr = matrix_c + bc * M * N;
 
             // row major A[N * K] * B[K * M] = C[N * M]
             // equals to
             // col major B[M * K] * A[K * N] = C[M * N]
-            conv_sgemm_nn_col_major(M, N, K, b_ptr, M, a_ptr, K, c_ptr, M,
-                fake_bias_ptr, ActivationType_None, workspace, conv_gemm_conf_);
+            if (int8_weight_) {
+                conv_sgemm_nn_col_major_int8_a(M, N, K, resource->weight.force_to<int8_t *>() + bb * M * K, M,
+                    buffer_weight_scale_.force_to<float *>(), a_ptr, K, c_ptr, M,
+                    fake_bias_ptr, ActivationType_None, workspace, conv_gemm_conf_);
+            } else {
+                auto b_ptr = matrix_b + bb * M * K;
+                conv_sgemm_nn_col_major(M, N, K, b_ptr, M, a_ptr, K, c_ptr, M,
+                    fake_bias_ptr, ActivationType_None, workspace, conv_gemm_conf_);
+            }
         }
     }
 
@@ -29,9 +29,25 @@ public:
     virtual Status DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) override;
 
 protected:
+    // time gemm with different M_c_ and K_c_, and keep the fastest
+    Status TuneBlockSize(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    Status allocateBufferWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    // transposes a dynamic range quantized B to the int8 layout of X86DynamicGemmInt8
+    Status allocateBufferDynamicWeight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    Status DoForwardDynamicInt8(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    // keeps a dynamic range quantized B int8, packed for X86SgemvInt8 when A has a few rows
+    Status allocateBufferInt8Weight(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs);
+    Status allocateBufferWeightScale(int M, int pad);
+
     conv_gemm_config<float, float, float> conv_gemm_conf_;
     std::shared_ptr<LayerResource> matmul_acc_f32_resource_ = nullptr;
-
+    // packed constant B of the gemv path, fp16 under low precision
+    RawBuffer buffer_weight_;
+    // per column scales of an int8 B, the rows of A are quantized in DoForward
+    RawBuffer buffer_weight_scale_;
+    bool dynamic_int8_ = false;
+    // an int8 B is dequantized inside the sgemv, or while the gemm packs it
+    bool int8_weight_ = false;
 };
 
 }  // namespace TNN_NS
@@ -121,19 +121,29 @@ Status X86PoolLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::
         }
     } else if (input->GetBlobDesc().data_type == DATA_TYPE_INT8) {
         // INT8
+        auto X86MaxPoolingINT8Acc = X86MaxPoolingINT8;
+        auto X86AvgPoolingINT8Acc = X86AvgPoolingINT8;
+#ifdef __AVX2__
+        if (arch_ == avx2 && oc_r4 >= 32) {
+            X86MaxPoolingINT8Acc = X86AVXMaxPoolingINT8;
+        }
+        if (arch_ == avx2 && oc_r4 >= 16) {
+            X86AvgPoolingINT8Acc = X86AVXAvgPoolingINT8;
+        }
+#endif
         for (int n = 0; n < batch; n++) {
             auto input_batch_stride  = dims_input[3] * dims_input[2] * oc_r4;
             auto output_batch_stride = dims_output[3] * dims_output[2] * oc_r4;
             if (param->pool_type == 0) {
-                X86MaxPoolingINT8(reinterpret_cast<int8_t *>(input_ptr) + n * input_batch_stride, dims_input[3],
-                               dims_input[2], reinterpret_cast<int8_t *>(output_ptr) + n * output_batch_stride,
-                               dims_output[3], dims_output[2], oc_r4, param->kernels[0], param->kernels[1],
-                               param->strides[0], param->strides[1], param->pads[0], param->pads[2]);
+                X86MaxPoolingINT8Acc(reinterpret_cast<int8_t *>(input_ptr) + n * input_batch_stride, dims_input[3],
+                                  dims_input[2], reinterpret_cast<int8_t *>(output_ptr) + n * output_batch_stride,
+                                  dims_output[3], dims_output[2], oc_r4, param->kernels[0], param->kernels[1],
+                                  param->strides[0], param->strides[1], param->pads[0], param->pads[2]);
             } else {
-                X86AvgPoolingINT8(reinterpret_cast<int8_t *>(input_ptr) + n * input_batch_stride, dims_input[3],
-                               dims_input[2], reinterpret_cast<int8_t *>(output_ptr) + n * output_batch_stride,
-                               dims_output[3], dims_output[2], oc_r4, param->kernels[0], param->kernels[1],
-                               param->strides[0], param->strides[1], param->pads[0], param->pads[2]);
+                X86AvgPoolingINT8Acc(reinterpret_cast<int8_t *>(input_ptr) + n * input_batch_stride, dims_input[3],
+                                  dims_input[2], reinterpret_cast<int8_t *>(output_ptr) + n * output_batch_stride,
+                                  dims_output[3], dims_output[2], oc_r4, param->kernels[0], param->kernels[1],
+                                  param->strides[0], param->strides[1], param->pads[0], param->pads[2]);
             }
         }
     } else {
@@ -13,6 +13,7 @@
 // specific language governing permissions and limitations under the License.
 
 #include <algorithm>
+#include <cfloat>
 #include <cmath>
 
 #include "tnn/device/x86/acc/Float4.h"
@@ -20,136 +21,171 @@
 #include "tnn/device/x86/acc/x86_layer_acc.h"
 #include "tnn/utils/data_type_utils.h"
 #include "tnn/utils/dims_utils.h"
+#include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 
 DECLARE_X86_ACC(SoftMax, LAYER_SOFTMAX);
 
-template <typename VEC, int pack>
-static void softmax_channel_func(float *input_ptr, float *output_ptr, int channel, int count, void *workspace) {
-    float *temp = reinterpret_cast<float *>(workspace);
-
-    temp[0] = input_ptr[0];
-    // max
-    int ele    = 0;
-    auto v_max = VEC(temp[0]);
-    float vec_buf[pack];
-    for (; ele + pack - 1 < channel; ele += pack) {
-        v_max = VEC::max(v_max, VEC::loadu(input_ptr + ele));
-    }
-    for (; ele < channel; ele++) {
-        temp[0] = std::max(temp[0], input_ptr[ele]);
-    }
-    VEC::saveu(vec_buf, v_max);
-    for (int i = 0; i < pack; i++) {
-        temp[0] = std::max(temp[0], vec_buf[i]);
-    }
-
-    // exp
-    ele = 0;
-    for (; ele + pack - 1 < channel; ele += pack) {
-        VEC::saveu(output_ptr + ele, VEC::exp(VEC::loadu(input_ptr + ele) - VEC(temp[0])));
-    }
-    for (; ele < channel; ele++) {
-        output_ptr[ele] = expf(input_ptr[ele] - temp[0]);
-    }
-
-    // sum
-    temp[0]    = 0.f;
-    auto v_sum = VEC(0.f);
-    ele        = 0;
-    for (; ele + pack - 1 < channel; ele += pack) {
-        v_sum = v_sum + VEC::loadu(output_ptr + ele);
-    }
-    for (; ele < channel; ele++) {
-        temp[0] += output_ptr[ele];
-    }
-    VEC::saveu(vec_buf, v_sum);
-    for (int i = 0; i < pack; i++) {
-        temp[0] += vec_buf[i];
-    }
+// under low precision exp uses a shorter polynomial
+template <typename VEC, bool fast>
+static inline VEC softmax_exp(const VEC &v) {
+    return fast ? VEC::fast_exp(v) : VEC::exp(v);
+}
 
-    // division
-    temp[0] = 1.f / temp[0];
+/*
+softmax of a contiguous row in two passes. the first one walks the row in blocks with a running max, it writes
+exp(x - running max) and keeps a sum that is rescaled whenever the max grows, the max of every block is saved.
+the second one scales every block by exp(block max - max) / sum, so exp is evaluated once per element.
+*/
+template <typename VEC, int pack, bool fast>
+static void softmax_row_func(const float *input_ptr, float *output_ptr, int channel, float *block_max) {
+    const int block = 16 * pack;
+    float max_value = -FLT_MAX;
+    float sum       = 0.f;
+    float lanes[pack];
+    for (int begin = 0, b = 0; begin < channel; begin += block, b++) {
+        const int end  = std::min(begin + block, channel);
+        const int tail = end - (end - begin) % pack;
+
+        auto v_max = VEC(max_value);
+        for (int ele = begin; ele < tail; ele += pack) {
+            v_max = VEC::max(v_max, VEC::loadu(input_ptr + ele));
+        }
+        VEC::saveu(lanes, v_max);
+        float m = max_value;
+        for (int i = 0; i < pack; i++) {
+            m = std::max(m, lanes[i]);
+        }
+        for (int ele = tail; ele < end; ele++) {
+            m = std::max(m, input_ptr[ele]);
+        }
+        if (m > max_value) {
+            sum *= expf(max_value - m);
+        }
 
-    //
-    ele = 0;
-    for (; ele + pack - 1 < channel; ele += pack) {
-        VEC::saveu(output_ptr + ele, VEC::loadu(output_ptr + ele) * temp[0]);
-    }
-    for (; ele < channel; ele++) {
-        output_ptr[ele] *= temp[0];
+        auto v_m   = VEC(m);
+        auto v_sum = VEC(0.f);
+        for (int ele = begin; ele < tail; ele += pack) {
+            auto v = softmax_exp<VEC, fast>(VEC::loadu(input_ptr + ele) - v_m);
+            VEC::saveu(output_ptr + ele, v);
+            v_sum = v_sum + v;
+        }
+        VEC::saveu(lanes, v_sum);
+        for (int i = 0; i < pack; i++) {
+            sum += lanes[i];
+        }
+        for (int ele = tail; ele < end; ele++) {
+            output_ptr[ele] = expf(input_ptr[ele] - m);
+            sum += output_ptr[ele];
+        }
+        block_max[b] = m;
+        max_value    = m;
+    }
+
+    const float scale = 1.f / sum;
+    for (int begin = 0, b = 0; begin < channel; begin += block, b++) {
+        const int end  = std::min(begin + block, channel);
+        const int tail = end - (end - begin) % pack;
+        const float f  = block_max[b] < max_value ? expf(block_max[b] - max_value) * scale : scale;
+        auto v_f       = VEC(f);
+        for (int ele = begin; ele < tail; ele += pack) {
+            VEC::saveu(output_ptr + ele, VEC::loadu(output_ptr + ele) * v_f);
+        }
+        for (int ele = tail; ele < end; ele++) {
+            output_ptr[ele] *= f;
+        }
     }
 }
 
-template <typename VEC, int pack>
-static void softmax_func(float *input_ptr, float *output_ptr, int channel, int count, void *workspace) {
-    if (count == 1) {
-        return softmax_channel_func<VEC, pack>(input_ptr, output_ptr, channel, count, workspace);
-    }
+/*
+softmax over channel of a [channel, count] block, for the positions [begin, end) of count.
+max, exp with sum, and scale are three passes, temp holds the max and the sum of every position.
+*/
+template <typename VEC, int pack, bool fast>
+static void softmax_func(const float *input_ptr, float *output_ptr, int channel, int count, int begin, int end,
+                         float *temp) {
+    float *temp_max = temp;
+    float *temp_sum = temp + (end - begin);
+    const int len   = end - begin;
+    const int tail  = len - len % pack;
+    input_ptr += begin;
+    output_ptr += begin;
 
-    float *temp = reinterpret_cast<float *>(workspace);
     // max
-    memcpy(temp, input_ptr, count * sizeof(float));
+    memcpy(temp_max, input_ptr, len * sizeof(float));
     for (int c = 1; c < channel; c++) {
-        float *input_channel = input_ptr + c * count;
-        int ele              = 0;
-        for (; ele + pack - 1 < count; ele += pack) {
-            VEC::saveu(temp + ele, VEC::max(VEC::loadu(temp + ele), VEC::loadu(input_channel + ele)));
+        const float *input_channel = input_ptr + c * count;
+        for (int ele = 0; ele < tail; ele += pack) {
+            VEC::saveu(temp_max + ele, VEC::max(VEC::loadu(temp_max + ele), VEC::loadu(input_channel + ele)));
         }
-        for (; ele < count; ele++) {
-            temp[ele] = std::max(temp[ele], input_channel[ele]);
+        for (int ele = tail; ele < len; ele++) {
+            temp_max[ele] = std::max(temp_max[ele], input_channel[ele]);
         }
     }
 
-    // exp
+    // exp and sum
+    memset(temp_sum, 0, len * sizeof(float));
     for (int c = 0; c < channel; c++) {
-        float *input_channel  = input_ptr + c * count;
-        float *output_channel = output_ptr + c * count;
-
-        int ele = 0;
-        for (; ele + pack - 1 < count; ele += pack) {
-            VEC::saveu(output_channel + ele, VEC::exp(VEC::loadu(input_channel + ele) - VEC::loadu(temp + ele)));
-        }
-        for (; ele < count; ele++) {
-            output_channel[ele] = expf(input_channel[ele] - temp[ele]);
-        }
-    }
-
-    // sum
-    memcpy(temp, output_ptr, count * sizeof(float));
-    for (int c = 1; c < channel; c++) {
-        float *output_channel = output_ptr + c * count;
-        int ele               = 0;
-        for (; ele + pack - 1 < count; ele += pack) {
-            VEC::saveu(temp + ele, VEC::loadu(temp + ele) + VEC::loadu(output_channel + ele));
+        const float *input_channel = input_ptr + c * count;
+        float *output_channel      = output_ptr + c * count;
+        for (int ele = 0; ele < tail; ele += pack) {
+            auto v = softmax_exp<VEC, fast>(VEC::loadu(input_channel + ele) - VEC::loadu(temp_max + ele));
+            VEC::saveu(output_channel + ele, v);
+            VEC::saveu(temp_sum + ele, VEC::loadu(temp_sum + ele) + v);
         }
-        for (; ele < count; ele++) {
-            temp[ele] += output_channel[ele];
+        for (int ele = tail; ele < len; ele++) {
+            output_channel[ele] = expf(input_channel[ele] - temp_max[ele]);
+            temp_sum[ele] += output_channel[ele];
         }
     }
 
     // division
-    int ele = 0;
-    for (; ele + pack - 1 < count; ele += pack) {
-        VEC::saveu(temp + ele, VEC::div(VEC(1.f), VEC::loadu(temp + ele)));
+    for (int ele = 0; ele < tail; ele += pack) {
+        VEC::saveu(temp_sum + ele, VEC::div(VEC(1.f), VEC::loadu(temp_sum + ele)));
     }
-    for (; ele < count; ele++) {
-        temp[ele] = 1.0f / temp[ele];
+    for (int ele = tail; ele < len; ele++) {
+        temp_sum[ele] = 1.0f / temp_sum[ele];
     }
 
     for (int c = 0; c < channel; c++) {
         float *output_channel = output_ptr + c * count;
-        int ele               = 0;
-        for (; ele + pack - 1 < count; ele += pack) {
-            VEC::saveu(output_channel + ele, VEC::loadu(temp + ele) * VEC::loadu(output_channel + ele));
+        for (int ele = 0; ele < tail; ele += pack) {
+            VEC::saveu(output_channel + ele, VEC::loadu(temp_sum + ele) * VEC::loadu(output_channel + ele));
         }
-        for (; ele < count; ele++) {
-            output_channel[ele] *= temp[ele];
+        for (int ele = tail; ele < len; ele++) {
+            output_channel[ele] *= temp_sum[ele];
         }
     }
 }
 
+// workspace holds the block max of one row per thread
+template <typename VEC, int pack, bool fast>
+static void softmax_batch_func(const float *input_data, float *output_data, int batch, int channel, int count,
+                               float *workspace) {
+    if (count == 1) {
+        const int row_blocks = UP_DIV(channel, 16 * pack);
+        OMP_PARALLEL_FOR_
+        for (int n = 0; n < batch; n++) {
+            softmax_row_func<VEC, pack, fast>(input_data + n * channel, output_data + n * channel, channel,
+                                              workspace + OMP_TID_ * row_blocks);
+        }
+        return;
+    }
+
+    // positions of count are independent, blocks of them are split across threads
+    const int block        = 128;
+    const int block_counts = UP_DIV(count, block);
+    OMP_PARALLEL_FOR_
+    for (int t = 0; t < batch * block_counts; t++) {
+        int n     = t / block_counts;
+        int begin = (t % block_counts) * block;
+        float temp[2 * block];
+        softmax_func<VEC, pack, fast>(input_data + n * channel * count, output_data + n * channel * count, channel,
+                                      count, begin, std::min(begin + block, count), temp);
+    }
+}
+
 Status X86SoftMaxLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std::vector<Blob *> &outputs) {
     auto params = dynamic_cast<SoftmaxLayerParam *>(param_);
 
@@ -169,19 +205,17 @@ Status X86SoftMaxLayerAcc::DoForward(const std::vector<Blob *> &inputs, const st
     int channel        = dims[axis];
     int count          = DimsVectorUtils::Count(dims, axis + 1);
 
-    auto workspace = context_->GetSharedWorkSpace(count * sizeof(float));
+    // enough block max for rows of the narrowest vector
+    int row_blocks = count == 1 ? UP_DIV(channel, 16 * 4) : 0;
+    auto workspace = reinterpret_cast<float *>(
+        context_->GetSharedWorkSpace(std::max(1, row_blocks * OMP_MAX_THREADS_NUM_) * sizeof(float)));
 
-    auto func = softmax_func<Float8, 8>;
+    bool fast = context_->GetPrecision() == PRECISION_LOW;
+    auto func = fast ? softmax_batch_func<Float8, 8, true> : softmax_batch_func<Float8, 8, false>;
     if (arch_ == sse42) {
-        func = softmax_func<Float4, 4>;
-    }
-
-    for (int n = 0; n < batch; n++) {
-        float *const input_batch  = input_data + n * channel * count;
-        float *const output_batch = output_data + n * channel * count;
-
-        func(input_batch, output_batch, channel, count, workspace);
+        func = fast ? softmax_batch_func<Float4, 4, true> : softmax_batch_func<Float4, 4, false>;
     }
+    func(input_data, output_data, batch, channel, count, workspace);
 
     return TNN_OK;
 }
@@ -39,17 +39,21 @@ Status X86SplitVLayerAcc::DoForward(const std::vector<Blob *> &inputs, const std
 
     if (input_blob->GetBlobDesc().data_type == DATA_TYPE_FLOAT) {
         for (size_t b = 0; b < batch; b++) {
-            int slice_input_offset = 0;
-            for (size_t i = 0; i < outputs.size(); i++) {
+            int slice_input_offset = slice_input;
+            // outputs planned inside the input are already in place, after a reshape to smaller dims they sit at
+            // or after their slice and moving them from the last one keeps the slices not moved yet intact
+            for (int i = (int)outputs.size() - 1; i >= 0; i--) {
                 auto output_blob = outputs[i];
                 auto output_data = handle_ptr<float *>(output_blob->GetHandle());
                 const int slice  = output_blob->GetBlobDesc().dims[axis];
+                slice_input_offset -= slice;
 
                 auto input_data_ptr  = input_data + b * slice_input * slice_size + slice_input_offset * slice_size;
                 auto output_data_ptr = output_data + b * slice * slice_size;
 
-                memcpy(output_data_ptr, input_data_ptr, slice * slice_size * sizeof(float));
-                slice_input_offset += slice;
+                if (output_data_ptr != input_data_ptr) {
+                    memmove(output_data_ptr, input_data_ptr, slice * slice_size * sizeof(float));
+                }
             }
         }
     } else {
@@ -0,0 +1,111 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/device/x86/acc/x86_tune_utils.h"
+
+#include <chrono>
+#include <cstring>
+#include <sstream>
+
+#include "tnn/core/abstract_device.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
+#include "tnn/memory_manager/blob_memory_size_info.h"
+
+namespace TNN_NS {
+namespace x86 {
+
+static const int kTuneWarmupCount = 1;
+static const int kTuneRepeatCount = 3;
+
+TuneBlobs::TuneBlobs(const std::vector<Blob *> &blobs) {
+    for (auto blob : blobs) {
+        if (blob->GetHandle().base != nullptr) {
+            blobs_.push_back(blob);
+            continue;
+        }
+        auto scratch = std::make_shared<Blob>(blob->GetBlobDesc(), true);
+        auto device  = GetDevice(blob->GetBlobDesc().device_type);
+        if (scratch->GetHandle().base != nullptr && device != nullptr) {
+            // avoid timing on garbage such as denormals
+            auto size_info = device->Calculate(blob->GetBlobDesc());
+            memset(scratch->GetHandle().base, 0, GetBlobMemoryBytesSize(size_info));
+        }
+        scratch_blobs_.push_back(scratch);
+        blobs_.push_back(scratch.get());
+    }
+}
+
+std::vector<Blob *> &TuneBlobs::GetBlobs() {
+    return blobs_;
+}
+
+static std::string GetIsaName() {
+    if (cpu_with_isa(avx512)) {
+        return "avx512";
+    } else if (cpu_with_isa(avx2)) {
+        return "avx2";
+    } else if (cpu_with_isa(avx)) {
+        return "avx";
+    }
+    return "sse42";
+}
+
+std::string GetTuneKey(const std::string &op_name, const std::vector<Blob *> &inputs,
+                       const std::vector<Blob *> &outputs, const std::vector<int> &params, int num_threads) {
+    std::ostringstream key;
+    key << op_name;
+    for (auto blob : inputs) {
+        key << "_i";
+        for (auto dim : blob->GetBlobDesc().dims) {
+            key << "x" << dim;
+        }
+    }
+    for (auto blob : outputs) {
+        key << "_o";
+        for (auto dim : blob->GetBlobDesc().dims) {
+            key << "x" << dim;
+        }
+    }
+    key << "_p";
+    for (auto param : params) {
+        key << "x" << param;
+    }
+    key << "_" << GetIsaName() << "_t" << num_threads;
+    return key.str();
+}
+
+float TimeKernel(const std::function<Status()> &func) {
+    for (int i = 0; i < kTuneWarmupCount; i++) {
+        if (func() != TNN_OK) {
+            return -1.f;
+        }
+    }
+    float best_time = -1.f;
+    for (int i = 0; i < kTuneRepeatCount; i++) {
+        auto start = std::chrono::steady_clock::now();
+        if (func() != TNN_OK) {
+            return -1.f;
+        }
+        auto stop = std::chrono::steady_clock::now();
+        float time = std::chrono::duration_cast<std::chrono::microseconds>(stop - start).count() / 1000.0f;
+        if (best_time < 0 || time < best_time) {
+            best_time = time;
+        }
+    }
+    return best_time;
+}
+
+}  // namespace x86
+}  // namespace TNN_NS
@@ -0,0 +1,52 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_TUNE_UTILS_H_
+#define TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_TUNE_UTILS_H_
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tnn/core/blob.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+namespace x86 {
+
+// @brief scratch blobs with the same desc as the given blobs, used to time kernels in Init,
+// before the blob memory of the network is allocated. Blobs that already own memory (constant blobs) are reused.
+class TuneBlobs {
+public:
+    explicit TuneBlobs(const std::vector<Blob *> &blobs);
+    std::vector<Blob *> &GetBlobs();
+
+private:
+    std::vector<std::shared_ptr<Blob>> scratch_blobs_;
+    std::vector<Blob *> blobs_;
+};
+
+// @brief key of a tuned kernel config: op name, blob shapes, op params, isa and thread number
+std::string GetTuneKey(const std::string &op_name, const std::vector<Blob *> &inputs,
+                       const std::vector<Blob *> &outputs, const std::vector<int> &params, int num_threads);
+
+// @brief run func a few times and return the best time in ms, or a negative value if func fails
+float TimeKernel(const std::function<Status()> &func);
+
+}  // namespace x86
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_DEVICE_X86_ACC_X86_TUNE_UTILS_H_
@@ -38,18 +38,16 @@ static inline int upsample_nearest2d(float *output_data, const float *input_data
         return 0;
     }
 
-    const float height_scale = (float)input_height / (float)output_height;
-    const float width_scale  = (float)input_width / (float)output_width;
-
+    // floor(j * input_height / output_height) in integers, -ffast-math approximates vectorized float division
     OMP_PARALLEL_FOR_
     for (int i = 0; i < channels; ++i) {
         int output_index  = i * output_height * output_width;
         int input_index_i = i * input_height * input_width;
         for (int j = 0; j < output_height; ++j) {
-            int scaled_j      = static_cast<int>(j * height_scale);
+            int scaled_j      = j * input_height / output_height;
             int input_index_j = input_index_i + scaled_j * input_width;
             for (int u = 0; u < output_width; ++u) {
-                int scaled_u                = static_cast<int>(u * width_scale);
+                int scaled_u                = u * input_width / output_width;
                 output_data[output_index++] = input_data[input_index_j + scaled_u];
             }
         }
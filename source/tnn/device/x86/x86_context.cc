@@ -13,25 +13,106 @@
 // specific language governing permissions and limitations under the License.
 
 #include "tnn/device/x86/x86_context.h"
+
+#include <fstream>
+
 #include "tnn/utils/omp_utils.h"
 
 namespace TNN_NS {
 
+static const std::string X86_TUNE_CACHE_NAME = "tnn_x86_tune.cache";
+// bump when the tune keys or the meaning of the results change, older files are then tuned again
+static const std::string X86_TUNE_CACHE_VERSION = "tnn_x86_tune_v1";
+static const uint32_t X86_TUNE_CACHE_MAX_VALUES = 16;
+
+std::map<std::string, std::vector<int>> X86Context::s_tune_map_;
+std::string X86Context::s_tune_loaded_path_ = "";
+bool X86Context::s_tune_map_changed_        = false;
+std::mutex X86Context::s_tune_mutex_;
+
 Status X86Context::LoadLibrary(std::vector<std::string> path) {
     return TNN_OK;
 }
 
 Status X86Context::GetCommandQueue(void** command_queue) {
+    // the x86 mat converter reads the thread number of the instance from it
+    *command_queue = this;
     return TNN_OK;
 }
 
 Status X86Context::OnInstanceForwardBegin() {
     Context::OnInstanceForwardBegin();
     OMP_SET_THREADS_(GetNumThreads());
+    BindNumaNode();
     return TNN_OK;
 }
 
+// omp workers belong to the calling thread and are shared by all instances it runs, so the node of the pool is
+// remembered per calling thread and every worker keeps the guard restoring its own affinity.
+static thread_local int g_pool_numa_node = -1;
+static thread_local int g_pool_bound_threads = 0;
+static thread_local std::unique_ptr<NumaThreadGuard> g_worker_numa_guard;
+
+void X86Context::BindNumaNode() {
+    // the caller is omp thread 0, it runs on the node for this forward only
+    caller_numa_guard_.reset();
+    if (numa_node_ >= 0) {
+        caller_numa_guard_ = std::make_shared<NumaThreadGuard>(numa_node_);
+    }
+
+    if (g_pool_numa_node == numa_node_ && (numa_node_ < 0 || g_pool_bound_threads >= num_threads_)) {
+        return;
+    }
+    int numa_node   = numa_node_;
+    int num_threads = numa_node >= 0 ? num_threads_ : g_pool_bound_threads;
+    OMP_PARALLEL_FOR_NUM_THREADS_(num_threads)
+    for (int t = 0; t < num_threads; t++) {
+        if (OMP_TID_ == 0) {
+            continue;
+        }
+        // restore the previous affinity first, a new guard saves the one the worker has when it is created
+        g_worker_numa_guard.reset();
+        if (numa_node >= 0) {
+            g_worker_numa_guard.reset(new NumaThreadGuard(numa_node));
+        }
+    }
+    g_pool_numa_node     = numa_node;
+    g_pool_bound_threads = numa_node >= 0 ? num_threads : 0;
+}
+
 Status X86Context::OnInstanceForwardEnd() {
+    caller_numa_guard_.reset();
+    return TNN_OK;
+}
+
+// tune results are saved after reshape, since layer accs are tuned in Init
+Status X86Context::OnInstanceReshapeEnd() {
+    if (!enable_tune_kernel_) {
+        return TNN_OK;
+    }
+    auto cache_file_path = GetTuneCacheFilePath();
+    std::lock_guard<std::mutex> lock(s_tune_mutex_);
+    if (cache_file_path.empty() || !s_tune_map_changed_) {
+        return TNN_OK;
+    }
+    std::ofstream cache_stream(cache_file_path);
+    if (!cache_stream.is_open()) {
+        LOGE("X86Context: open tune cache file %s failed\n", cache_file_path.c_str());
+        return TNN_OK;
+    }
+    cache_stream << X86_TUNE_CACHE_VERSION << " " << s_tune_map_.size() << std::endl;
+    for (const auto &element : s_tune_map_) {
+        cache_stream << element.first << " " << element.second.size();
+        for (const auto &value : element.second) {
+            cache_stream << " " << value;
+        }
+        cache_stream << std::endl;
+        if (!cache_stream.good()) {
+            break;
+        }
+    }
+    cache_stream.close();
+    s_tune_map_changed_ = false;
     return TNN_OK;
 }
 
@@ -53,13 +134,84 @@ void* X86Context::GetSharedWorkSpace(size_t size) {
 }
 
 void* X86Context::GetSharedWorkSpace(size_t size, int index) {
+    bool allocated = false;
     while(work_space_.size() < index + 1) {
         work_space_.push_back(RawBuffer(size, 32));
+        allocated = true;
     }
     if (work_space_[index].GetBytesSize() < size) {
         work_space_[index] = RawBuffer(size, 32);
+        allocated = true;
+    }
+    if (allocated) {
+        int64_t bytes = 0;
+        for (auto &buffer : work_space_) {
+            bytes += buffer.GetBytesSize();
+        }
+        counters_.workspace_bytes.store(bytes, std::memory_order_relaxed);
+        counters_.workspace_grow_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    // the workspace is written by all omp workers, keep its pages on the node of the instance
+    if (allocated && numa_node_ >= 0) {
+        NumaUtils::BindMemory(work_space_[index].force_to<void*>(), work_space_[index].GetBytesSize(), numa_node_);
     }
     return work_space_[index].force_to<void*>();
 }
 
+std::string X86Context::GetTuneCacheFilePath() {
+    if (cache_path_.empty()) {
+        return "";
+    }
+    return cache_path_ + "/" + X86_TUNE_CACHE_NAME;
+}
+
+bool X86Context::GetTuneResult(const std::string &key, std::vector<int> &result) {
+    auto cache_file_path = GetTuneCacheFilePath();
+    std::lock_guard<std::mutex> lock(s_tune_mutex_);
+    if (!cache_file_path.empty() && cache_file_path != s_tune_loaded_path_) {
+        s_tune_loaded_path_ = cache_file_path;
+        std::ifstream cache_stream(cache_file_path);
+        std::string version;
+        uint32_t cache_map_size = 0;
+        if (cache_stream.is_open() && cache_stream >> version >> cache_map_size) {
+            std::map<std::string, std::vector<int>> cache_map;
+            for (int i = 0; i < cache_map_size && !cache_stream.fail(); ++i) {
+                std::string cache_key;
+                uint32_t value_size = 0;
+                cache_stream >> cache_key >> value_size;
+                if (value_size > X86_TUNE_CACHE_MAX_VALUES) {
+                    cache_stream.setstate(std::ios::failbit);
+                    break;
+                }
+                std::vector<int> values(value_size);
+                for (int j = 0; j < value_size; ++j) {
+                    cache_stream >> values[j];
+                }
+                cache_map[cache_key] = values;
+            }
+            // a stale or damaged file is dropped as a whole, the layers tune again and the file is rewritten
+            if (version != X86_TUNE_CACHE_VERSION || cache_stream.fail()) {
+                LOGI("X86Context: ignore stale or damaged tune cache file %s\n", cache_file_path.c_str());
+            } else {
+                // results tuned in this process take precedence
+                s_tune_map_.insert(cache_map.begin(), cache_map.end());
+            }
+            cache_stream.close();
+        }
+    }
+
+    auto iter = s_tune_map_.find(key);
+    if (iter == s_tune_map_.end()) {
+        return false;
+    }
+    result = iter->second;
+    return true;
+}
+
+void X86Context::SetTuneResult(const std::string &key, const std::vector<int> &result) {
+    std::lock_guard<std::mutex> lock(s_tune_mutex_);
+    s_tune_map_[key]    = result;
+    s_tune_map_changed_ = true;
+}
+
 }  // namespace TNN_NS
@@ -15,11 +15,16 @@
 #ifndef TNN_SOURCE_TNN_DEVICE_X86_X86_CONTEXT_H_
 #define TNN_SOURCE_TNN_DEVICE_X86_X86_CONTEXT_H_
 
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "tnn/core/context.h"
 #include "tnn/interpreter/raw_buffer.h"
+#include "tnn/utils/numa_utils.h"
 
 namespace TNN_NS {
 
@@ -38,6 +43,9 @@ public:
     // @brief after instance forward
     virtual Status OnInstanceForwardEnd() override;
 
+    // @brief after instance reshape, save new tune results if needed
+    virtual Status OnInstanceReshapeEnd() override;
+
     // @brief wait for jobs in the current context to complete
     virtual Status Synchronize() override;
 
@@ -50,9 +58,28 @@ public:
     void* GetSharedWorkSpace(size_t size);
     void* GetSharedWorkSpace(size_t size, int index);
 
+    // @brief get the tuned kernel config of key, the tune cache file under cache_path is loaded on first use
+    bool GetTuneResult(const std::string& key, std::vector<int>& result);
+
+    // @brief record the tuned kernel config of key
+    void SetTuneResult(const std::string& key, const std::vector<int>& result);
+
 private:
+    std::string GetTuneCacheFilePath();
+
+    // run the calling thread and its omp workers on the cpus of numa_node_, or unbind the workers if it is < 0
+    void BindNumaNode();
+
     int num_threads_ = 1;
+    // binds the calling thread during a forward, its own affinity is restored in OnInstanceForwardEnd
+    std::shared_ptr<NumaThreadGuard> caller_numa_guard_;
     std::vector<RawBuffer> work_space_;
+
+    // tune results are shared by all instances in the process
+    static std::map<std::string, std::vector<int>> s_tune_map_;
+    static std::string s_tune_loaded_path_;
+    static bool s_tune_map_changed_;
+    static std::mutex s_tune_mutex_;
 };
 
 }  // namespace TNN_NS
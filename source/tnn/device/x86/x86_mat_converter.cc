@@ -14,6 +14,7 @@
 
 #include "tnn/device/x86/x86_mat_converter.h"
 
+#include "tnn/device/x86/x86_context.h"
 #include "tnn/device/x86/x86_mat_util.h"
 
 #include "tnn/utils/dims_utils.h"
@@ -22,6 +23,12 @@
 namespace TNN_NS {
 using namespace x86;
 
+// the threads of the instance the command queue comes from, 0 without one
+static int CommandQueueThreads(void* command_queue) {
+    auto context = reinterpret_cast<X86Context*>(command_queue);
+    return context ? context->GetNumThreads() : 0;
+}
+
 Status X86MatConverterAcc::Copy(Mat& src, Mat& dst, void* command_queue) {
     Status ret = TNN_OK;
 
@@ -44,6 +51,7 @@ Status X86MatConverterAcc::Copy(Mat& src, Mat& dst, void* command_queue) {
 
 Status X86MatConverterAcc::Resize(Mat& src, Mat& dst, ResizeParam param, void* command_queue) {
     Status ret = TNN_OK;
+    MatThreadsScope threads_scope(CommandQueueThreads(command_queue));
 
     ret = CheckMatConverterParams(src, dst, true);
     if (ret != TNN_OK)
@@ -173,6 +181,7 @@ Status X86MatConverterAcc::Crop(Mat& src, Mat& dst, CropParam param, void* comma
 
 Status X86MatConverterAcc::WarpAffine(Mat& src, Mat& dst, WarpAffineParam param, void* command_queue) {
     Status ret = TNN_OK;
+    MatThreadsScope threads_scope(CommandQueueThreads(command_queue));
 
     ret = CheckMatConverterParams(src, dst, true);
     if (ret != TNN_OK)
@@ -204,6 +213,7 @@ Status X86MatConverterAcc::WarpAffine(Mat& src, Mat& dst, WarpAffineParam param,
 
 Status X86MatConverterAcc::CvtColor(Mat& src, Mat& dst, ColorConversionType type, void* command_queue) {
     Status ret = TNN_OK;
+    MatThreadsScope threads_scope(CommandQueueThreads(command_queue));
 
     ret = CheckMatConverterParams(src, dst, true);
     if (ret != TNN_OK)
@@ -18,6 +18,7 @@
 #include <type_traits>
 
 #include "tnn/core/macro.h"
+#include "tnn/device/x86/acc/compute/x86_mat_util_avx2.h"
 #include "tnn/device/x86/x86_common.h"
 #include "tnn/utils/bfp16.h"
 #include "tnn/utils/mat_converter_utils.h"
@@ -35,6 +36,29 @@ static inline void x86Free(void* ptr) {
     _mm_free(ptr);
 }
 
+// fewer rows per thread do not pay for the thread
+static const int kMatMinBandRows = 16;
+
+// threads given by the MatThreadsScope of the calling thread, 0 if there is none
+static thread_local int g_mat_num_threads = 0;
+
+MatThreadsScope::MatThreadsScope(int num_threads) : saved_num_threads_(g_mat_num_threads) {
+    g_mat_num_threads = num_threads;
+}
+
+MatThreadsScope::~MatThreadsScope() {
+    g_mat_num_threads = saved_num_threads_;
+}
+
+static inline int MatMaxThreads() {
+    return g_mat_num_threads > 0 ? g_mat_num_threads : OMP_MAX_THREADS_NUM_;
+}
+
+// threads of a row loop, chosen per call so the omp setting of the calling thread is left alone
+static inline int MatBandThreads(int rows) {
+    return std::max(1, std::min(MatMaxThreads(), UP_DIV(rows, kMatMinBandRows)));
+}
+
 #define SATURATE_CAST_UCHAR(X)                                                                                         \
     (unsigned char)::std::min(::std::max((int)((X) + ((X) >= 0.f ? 0.5f : -0.5f)), (int)0), (int)UCHAR_MAX)
 #define SATURATE_CAST_SHORT(X)                                                                                         \
@@ -114,9 +138,9 @@ color convert
 //     b = (74 * y - 1135 + 129 * uu ) >> 6
 template <bool is_nv12, bool has_alpha>
 void YUVToBGR(const unsigned char* yuv, unsigned char* bgr, int h, int w) {
-    const unsigned char* yptr  = yuv;
-    const unsigned char* vuptr = yuv + w * h;
-    const int channel          = has_alpha ? 4 : 3;
+    const unsigned char* yptr       = yuv;
+    const unsigned char* vuptr_base = yuv + w * h;
+    const int channel               = has_alpha ? 4 : 3;
 
 #ifdef __SSE4_2__
     __m128i _v1135 = _mm_set1_epi16(-1135);
@@ -137,16 +161,30 @@ void YUVToBGR(const unsigned char* yuv, unsigned char* bgr, int h, int w) {
     const __m128i m1    = _mm_setr_epi8(0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0, -1, 0, 0);
 #endif
 
+    const bool use_avx2 = X86MatUtilAVX2Enabled();
+
+    // row pairs are independent, each thread converts a band of them
+    OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
     for (int y = 0; y < h; y += 2) {
-        const unsigned char* yptr0 = yptr;
-        const unsigned char* yptr1 = yptr + w;
-        unsigned char* rgb0        = bgr;
-        unsigned char* rgb1        = bgr + w * channel;
+        const unsigned char* yptr0 = yptr + y * w;
+        const unsigned char* yptr1 = yptr0 + w;
+        const unsigned char* vuptr = vuptr_base + (y / 2) * w;
+        unsigned char* rgb0        = bgr + y * w * channel;
+        unsigned char* rgb1        = rgb0 + w * channel;
 
         int remain = w;
+        if (use_avx2) {
+            int done = X86YUVToBGRTwoRowsAVX2(yptr0, yptr1, vuptr, rgb0, rgb1, w, is_nv12, has_alpha);
+            yptr0 += done;
+            yptr1 += done;
+            vuptr += done;
+            rgb0 += done * channel;
+            rgb1 += done * channel;
+            remain -= done;
+        }
 #ifdef __SSE4_2__
-        int nn = w >> 4;
-        remain = w - (nn << 4);
+        int nn = remain >> 4;
+        remain = remain - (nn << 4);
         for (; nn > 0; nn--) {
             __m128i _yy00_load = _mm_loadl_epi64((__m128i*)yptr0);
             __m128i _yy01_load = _mm_loadl_epi64((__m128i*)(yptr0 + 8));
@@ -275,9 +313,6 @@ void YUVToBGR(const unsigned char* yuv, unsigned char* bgr, int h, int w) {
 #endif
 
         NaiveYUVToBGROrBGRALoop(yptr0, yptr1, vuptr, rgb0, rgb1, remain, is_nv12, channel);
-        yptr += 2 * w;
-        vuptr += remain;
-        bgr += 2 * channel * w;
     }
 }
 
@@ -295,19 +330,24 @@ void NV21ToBGRA(const unsigned char* nv21, unsigned char* bgra, int h, int w) {
 }
 
 template <int channel, bool bgr_order>
-void ColorToGray(const unsigned char* bgr, unsigned char* gray, int h, int w) {
+static void ColorToGrayOneRow(const unsigned char* bgr, unsigned char* gray, int w, bool use_avx2) {
     int offset = 0;
-    int plane  = h * w;
+    int plane  = w;
+
+    if (use_avx2) {
+        offset = X86ColorToGrayAVX2(bgr, gray, plane, channel, bgr_order);
+    }
 
 #ifdef __SSE4_2__
-    const unsigned char* Sp = bgr;
-    unsigned char* Dp       = gray;
-    __m128 _coeff_b         = _mm_set1_ps(0.114);
-    __m128 _coeff_g         = _mm_set1_ps(0.587);
-    __m128 _coeff_r         = _mm_set1_ps(0.299);
-    __m128i _vzero          = _mm_set1_epi16(0);
-    __m128i _maski16_to_i8  = _mm_setr_epi8(0, 2, 4, 6, 8, 10, 12, 14, 1, 3, 5, 7, 9, 11, 13, 15);
-    __m128i _maski32_to_i16 = _mm_setr_epi8(0, 1, 4, 5, 8, 9, 12, 13, 2, 3, 6, 7, 10, 11, 14, 15);
+    const unsigned char* Sp = bgr + offset * channel;
+    unsigned char* Dp       = gray + offset;
+    // b * k_b + g * k_g as one madd of interleaved b g, r * k_r + round as one madd of interleaved r 1
+    __m128i _coeff_bg       = _mm_setr_epi16(kX86GrayCoeffB, kX86GrayCoeffG, kX86GrayCoeffB, kX86GrayCoeffG,
+                                             kX86GrayCoeffB, kX86GrayCoeffG, kX86GrayCoeffB, kX86GrayCoeffG);
+    __m128i _coeff_r1       = _mm_setr_epi16(kX86GrayCoeffR, 1 << (kX86GrayShift - 1), kX86GrayCoeffR,
+                                             1 << (kX86GrayShift - 1), kX86GrayCoeffR, 1 << (kX86GrayShift - 1),
+                                             kX86GrayCoeffR, 1 << (kX86GrayShift - 1));
+    __m128i _one            = _mm_set1_epi16(1);
     __m128i _maskld3_0      = _mm_setr_epi8(0, 3, 6, 9, 12, 15, 1, 4, 7, 10, 13, 2, 5, 8, 11, 14);
     __m128i _maskld3_1      = _mm_setr_epi8(2, 5, 0, 3, 6, 1, 4, 7, 0, 0, 0, 0, 0, 0, 0, 0);
     for (; offset<plane>> 3 << 3; offset += 8) {
@@ -345,39 +385,34 @@ void ColorToGray(const unsigned char* bgr, unsigned char* gray, int h, int w) {
             r_h = _mm_cvtepu8_epi16(bgr_order ? tmp1 : tmp0);
         }
 
-        __m128 b_val, g_val, r_val, acc;
-        b_val        = _mm_cvtepi32_ps(_mm_unpacklo_epi16(b_h, _vzero));
-        g_val        = _mm_cvtepi32_ps(_mm_unpacklo_epi16(g_h, _vzero));
-        r_val        = _mm_cvtepi32_ps(_mm_unpacklo_epi16(r_h, _vzero));
-        acc          = _mm_mul_ps(b_val, _coeff_b);
-        acc          = _mm_add_ps(acc, _mm_mul_ps(g_val, _coeff_g));
-        acc          = _mm_add_ps(acc, _mm_mul_ps(r_val, _coeff_r));
-        __m128i tmp0 = _mm_shuffle_epi8(_mm_cvtps_epi32(acc), _maski32_to_i16);
-
-        b_val        = _mm_cvtepi32_ps(_mm_unpackhi_epi16(b_h, _vzero));
-        g_val        = _mm_cvtepi32_ps(_mm_unpackhi_epi16(g_h, _vzero));
-        r_val        = _mm_cvtepi32_ps(_mm_unpackhi_epi16(r_h, _vzero));
-        acc          = _mm_mul_ps(b_val, _coeff_b);
-        acc          = _mm_add_ps(acc, _mm_mul_ps(g_val, _coeff_g));
-        acc          = _mm_add_ps(acc, _mm_mul_ps(r_val, _coeff_r));
-        __m128i tmp1 = _mm_shuffle_epi8(_mm_cvtps_epi32(acc), _maski32_to_i16);
-
-        _mm_storel_epi64((__m128i*)Dp, _mm_shuffle_epi8(_mm_unpacklo_epi64(tmp0, tmp1), _maski16_to_i8));
+        __m128i acc_lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(b_h, g_h), _coeff_bg),
+                                       _mm_madd_epi16(_mm_unpacklo_epi16(r_h, _one), _coeff_r1));
+        __m128i acc_hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(b_h, g_h), _coeff_bg),
+                                       _mm_madd_epi16(_mm_unpackhi_epi16(r_h, _one), _coeff_r1));
+        __m128i acc    = _mm_packs_epi32(_mm_srai_epi32(acc_lo, kX86GrayShift), _mm_srai_epi32(acc_hi, kX86GrayShift));
+        _mm_storel_epi64((__m128i*)Dp, _mm_packus_epi16(acc, acc));
 
         Sp += 8 * channel;
         Dp += 8;
     }
-    if (plane % 8) {
-        offset -= 8;
-    }
 #endif
 
     for (; offset < plane; ++offset) {
-        unsigned b       = bgr[offset * channel + (bgr_order ? 0 : 2)];
-        unsigned g       = bgr[offset * channel + 1];
-        unsigned r       = bgr[offset * channel + (bgr_order ? 2 : 0)];
-        float gray_color = 0.114 * b + 0.587 * g + 0.299 * r;
-        gray[offset]     = gray_color;
+        int b        = bgr[offset * channel + (bgr_order ? 0 : 2)];
+        int g        = bgr[offset * channel + 1];
+        int r        = bgr[offset * channel + (bgr_order ? 2 : 0)];
+        gray[offset] = (b * kX86GrayCoeffB + g * kX86GrayCoeffG + r * kX86GrayCoeffR + (1 << (kX86GrayShift - 1))) >>
+                       kX86GrayShift;
+    }
+}
+
+template <int channel, bool bgr_order>
+void ColorToGray(const unsigned char* bgr, unsigned char* gray, int h, int w) {
+    const bool use_avx2 = X86MatUtilAVX2Enabled();
+
+    OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
+    for (int y = 0; y < h; ++y) {
+        ColorToGrayOneRow<channel, bgr_order>(bgr + y * w * channel, gray + y * w, w, use_avx2);
     }
 }
 
@@ -542,11 +577,19 @@ static void ResizeGetAdjacentRows(int sy, int prev_sy, short** rows0, short** ro
 
 static void ResizeCalculateOneRow(short* rows0p, short* rows1p, const short b0, const short b1, const int w,
                                   const int c, uint8_t* Dp) {
+    int count = w * c;
+    if (X86MatUtilAVX2Enabled()) {
+        int done = X86ResizeBilinearVerticalAVX2(rows0p, rows1p, b0, b1, count, Dp);
+        rows0p += done;
+        rows1p += done;
+        Dp += done;
+        count -= done;
+    }
 #ifndef __SSE4_2__
-    int remain = w * c;
+    int remain = count;
 #else
-    int nn = (w * c) >> 4;
-    int remain = (w * c) - (nn << 4);
+    int nn = count >> 4;
+    int remain = count - (nn << 4);
     __m128i _b0 = _mm_set1_epi16(b0);
     __m128i _b1 = _mm_set1_epi16(b1);
     __m128i _v2 = _mm_set1_epi16(2);
@@ -638,7 +681,7 @@ void ResizeBilinearC1Impl(const uint8_t* src, int batch, int src_w, int src_h, i
     ResizeBilinearKernelParm param(xofs, yofs, ialpha, ibeta, src, dst, src_plane, src_stride, schannel);
 
     // loop body
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = MatMaxThreads();
     short* rows0        = new short[w * max_num_threads];
     short* rows1        = new short[w * max_num_threads];
     short** rows0_t     = new short*[max_num_threads];
@@ -652,7 +695,7 @@ void ResizeBilinearC1Impl(const uint8_t* src, int batch, int src_w, int src_h, i
             rows1_t[t] = rows1 + t * w;
         }
 
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             int thread_id = OMP_TID_;
             ResizeBilinearOneRow<1>(param, thread_id, rows0_t, rows1_t, prev_sy, b, w, h, stride, dy);
@@ -674,7 +717,7 @@ void ResizeBilinearC2Impl(const uint8_t* src, int batch, int src_w, int src_h, i
     ResizeBilinearKernelParm param(xofs, yofs, ialpha, ibeta, src, dst, src_plane, src_stride, schannel);
 
     // loop body
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = MatMaxThreads();
     short* rows0        = new short[(w * 2 + 2) * max_num_threads];
     short* rows1        = new short[(w * 2 + 2) * max_num_threads];
     short** rows0_t     = new short*[max_num_threads];
@@ -688,7 +731,7 @@ void ResizeBilinearC2Impl(const uint8_t* src, int batch, int src_w, int src_h, i
             rows1_t[t] = rows1 + t * (w * 2 + 2);
         }
 
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             int thread_id = OMP_TID_;
             ResizeBilinearOneRow<2>(param, thread_id, rows0_t, rows1_t, prev_sy, b, w, h, stride, dy);
@@ -710,7 +753,7 @@ void ResizeBilinearC3Impl(const uint8_t* src, int batch, int src_w, int src_h, i
     ResizeBilinearKernelParm param(xofs, yofs, ialpha, ibeta, src, dst, src_plane, src_stride, schannel);
 
     // loop body
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = MatMaxThreads();
     short* rows0        = new short[(w * 3 + 1) * max_num_threads];
     short* rows1        = new short[(w * 3 + 1) * max_num_threads];
     short** rows0_t     = new short*[max_num_threads];
@@ -724,7 +767,7 @@ void ResizeBilinearC3Impl(const uint8_t* src, int batch, int src_w, int src_h, i
             rows1_t[t] = rows1 + t * (w * 3 + 1);
         }
 
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             int thread_id = OMP_TID_;
             ResizeBilinearOneRow<3>(param, thread_id, rows0_t, rows1_t, prev_sy, b, w, h, stride, dy);
@@ -746,7 +789,7 @@ void ResizeBilinearC4Impl(const uint8_t* src, int batch, int src_w, int src_h, i
     ResizeBilinearKernelParm param(xofs, yofs, ialpha, ibeta, src, dst, src_plane, src_stride, schannel);
 
     // loop body
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = MatMaxThreads();
     short* rows0        = new short[(w * 4) * max_num_threads];
     short* rows1        = new short[(w * 4) * max_num_threads];
     short** rows0_t     = new short*[max_num_threads];
@@ -760,7 +803,7 @@ void ResizeBilinearC4Impl(const uint8_t* src, int batch, int src_w, int src_h, i
             rows1_t[t] = rows1 + t * (w * 4);
         }
 
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             int thread_id = OMP_TID_;
             ResizeBilinearOneRow<4>(param, thread_id, rows0_t, rows1_t, prev_sy, b, w, h, stride, dy);
@@ -832,7 +875,7 @@ void ResizeNearestC1Impl(const uint8_t* src, int batch, int src_w, int src_h, in
 
     // loop body
     for (int b = 0; b < batch; ++b) {
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             ResizeNearestLoopPreparation();
 #ifdef __SSE4_2__
@@ -883,7 +926,7 @@ void ResizeNearestC2Impl(const uint8_t* src, int batch, int src_w, int src_h, in
 
     // loop body
     for (int b = 0; b < batch; ++b) {
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             ResizeNearestLoopPreparation();
 #ifdef __SSE4_2__
@@ -938,7 +981,7 @@ void ResizeNearestC3Impl(const uint8_t* src, int batch, int src_w, int src_h, in
 
     // loop body
     for (int b = 0; b < batch; ++b) {
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             ResizeNearestLoopPreparation();
 #ifdef __SSE4_2__
@@ -1008,7 +1051,7 @@ void ResizeNearestC4Impl(const uint8_t* src, int batch, int src_w, int src_h, in
 
     // loop body
     for (int b = 0; b < batch; ++b) {
-        OMP_PARALLEL_FOR_
+        OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(h))
         for (int dy = 0; dy < h; dy++) {
             ResizeNearestLoopPreparation();
 #ifdef __SSE4_2__
@@ -1603,6 +1646,12 @@ void WarpAffineCalculateOneRow<1>(int begin_x, int end_x, int channel, int dst_l
 #if defined(__SSE4_2__)
     __m128i DELTA_vec  = _mm_set1_epi32(1 << 14);
     uint8_t* dst_loc_p = dst + dst_loc_base + x * channel;
+    if (X86MatUtilAVX2Enabled()) {
+        int done = X86WarpAffineBilinearC1AVX2(ptr, tab_loc + x, tab_p, end_x - x + 1, dst_loc_p);
+        x += done;
+        ptr += done * 4;
+        dst_loc_p += done;
+    }
     for (; x + 7 <= end_x; x += 8) {
         short* wtab0 = BilinearTab_i[tab_loc[x]][0];
         short* wtab1 = BilinearTab_i[tab_loc[x + 1]][0];
@@ -1683,13 +1732,13 @@ static void WarpAffineBilinear(const uint8_t* src, int batch, int src_w, int src
     int* adelta = buffer;
     int* bdelta = buffer + dst_w * 2;
 
-    int max_num_threads = OMP_MAX_THREADS_NUM_;
+    int max_num_threads = MatMaxThreads();
     int* buf_loc        = new int[dst_w * max_num_threads];
     short* tab_loc      = new short[dst_w * max_num_threads];
 
     const unsigned char* src2 = src + src_w * schannel;
 
-    OMP_PARALLEL_FOR_
+    OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(dst_h * batch))
     for (int y = 0; y < dst_h * batch; ++y) {
         int thread_id    = OMP_TID_;
         int x_count      = 0;
@@ -1763,7 +1812,7 @@ static void WarpAffineNearest(const uint8_t* src, int batch, int src_w, int src_
 
     int src_stride = src_w * schannel;
     int src_plane  = src_h * src_w * schannel;
-    OMP_PARALLEL_FOR_
+    OMP_PARALLEL_FOR_NUM_THREADS_(MatBandThreads(dst_h * batch))
     for (int y = 0; y < dst_h * batch; ++y) {
         int y_c = y / dst_h;
         int y_r = y % dst_h;
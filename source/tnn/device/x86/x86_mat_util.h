@@ -27,6 +27,17 @@ namespace x86 {
 
 #define GET_OFFSET_PTR(ptr, offset) (reinterpret_cast<int8_t*>(ptr) + offset)
 
+// @brief the mat functions called on this thread use at most num_threads threads until the scope ends,
+// num_threads <= 0 means the omp max threads of the calling thread.
+class MatThreadsScope {
+public:
+    explicit MatThreadsScope(int num_threads);
+    ~MatThreadsScope();
+
+private:
+    int saved_num_threads_;
+};
+
 void MatMemcpy2D(void* src, void* dst, int width, int height, int src_stride, int dst_stride);
 void MatMemcpy2DWithPadding(void* src, void* dst, int width, int height, int src_stride, int dst_stride, int top,
                             int bottom, int left, int right, uint8_t pad_val);
@@ -41,4 +41,8 @@ std::vector<std::string> DefaultModelInterpreter::GetParamsMd5() {
     return params_md5_;
 }
 
+Status DefaultModelInterpreter::ReplicateNetResource() {
+    return Status(TNNERR_COMMON_ERROR, "interpreter does not support replicating net resource");
+}
+
 }  // namespace TNN_NS
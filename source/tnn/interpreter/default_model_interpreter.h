@@ -44,6 +44,10 @@ public:
     //@brief GetParamsMd5 return md5 string of params string
     std::vector<std::string> GetParamsMd5();
 
+    // @brief copy weights and constants into buffers owned by this interpreter, so that a copied
+    // interpreter no longer shares them. pages follow the numa policy of the calling thread.
+    virtual Status ReplicateNetResource();
+
 protected:
     std::vector<std::string> params_md5_;
     NetStructure *net_structure_;
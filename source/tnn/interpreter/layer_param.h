@@ -704,6 +704,14 @@ struct GLULayerParam : public LayerParam {
     PARAM_COPY(GLULayerParam);
 };
 
+// depthwise conv followed by pointwise conv, created by the optimizer
+struct DwPwFusedConvLayerParam : public LayerParam {
+    ConvLayerParam dw_param;
+    ConvLayerParam pw_param;
+
+    PARAM_COPY(DwPwFusedConvLayerParam)
+};
+
 };  // namespace TNN_NS
 
 #endif  // TNN_SOURCE_TNN_INTERPRETER_LAYER_PARAM_H
@@ -172,6 +172,11 @@ struct BiasAddLayerResource : public LayerResource {
     RawBuffer bias_handle;
 };
 
+struct DwPwFusedConvLayerResource : public LayerResource {
+    ConvLayerResource dw_resource;
+    ConvLayerResource pw_resource;
+};
+
 
 }  // namespace TNN_NS
 
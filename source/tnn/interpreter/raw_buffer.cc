@@ -181,6 +181,31 @@ RawBuffer ConvertHalfHandle(RawBuffer &buf) {
     }
 }
 
+/*
+ * Convert a dynamic range quantized int8 handle to Float32, element i is scaled by
+ * scale[(i / inner_count) % scale count], a single scale applies to all elements
+ */
+RawBuffer ConvertInt8Handle(RawBuffer &buf, RawBuffer &scale, int inner_count) {
+    if (buf.GetBytesSize() > 0 && buf.GetDataType() == DATA_TYPE_INT8 && scale.GetBytesSize() > 0) {
+        auto scale_f32   = ConvertHalfHandle(scale);
+        auto data_count  = buf.GetDataCount();
+        auto scale_count = scale_f32.GetDataCount();
+        auto src         = buf.force_to<int8_t *>();
+        auto scale_ptr   = scale_f32.force_to<float *>();
+        RawBuffer buf_f32(data_count * sizeof(float));
+        auto dst = buf_f32.force_to<float *>();
+        for (int i = 0; i < data_count; i++) {
+            int s  = scale_count > 1 ? (i / inner_count) % scale_count : 0;
+            dst[i] = scale_ptr[s] * src[i];
+        }
+        buf_f32.SetDataType(DATA_TYPE_FLOAT);
+        buf_f32.SetBufferDims(buf.GetBufferDims());
+        return buf_f32;
+    } else {
+        return buf;
+    }
+}
+
 /*
  * Convert the data handle form float to bfp16
  */
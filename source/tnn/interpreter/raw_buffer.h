@@ -71,6 +71,7 @@ private:
 
 RawBuffer ConvertFloatToFP16(RawBuffer &buf);
 RawBuffer ConvertHalfHandle(RawBuffer &buf);
+RawBuffer ConvertInt8Handle(RawBuffer &buf, RawBuffer &scale, int inner_count);
 RawBuffer ConvertFloatToBFP16(RawBuffer &buf);
 RawBuffer ConvertHalfToBFP16(RawBuffer &buf);
 std::shared_ptr<float> GetFloatFromRawBuffer(const RawBuffer &raw_buffer);
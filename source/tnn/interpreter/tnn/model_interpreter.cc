@@ -171,6 +171,50 @@ std::shared_ptr<AbstractModelInterpreter> ModelInterpreter::Copy() {
     return interp;
 }
 
+// Replicate resources, each layer resource is saved and interpreted again as if loaded from a model
+Status ModelInterpreter::ReplicateNetResource() {
+    NetStructure *structure = GetNetStructure();
+    NetResource *resource   = GetNetResource();
+    auto &layer_interpreter_map = GetLayerInterpreterMap();
+
+    for (auto layer_info : structure->layers) {
+        auto iter = resource->resource_map.find(layer_info->name);
+        if (iter == resource->resource_map.end() || !iter->second) {
+            continue;
+        }
+        auto layer_interpreter = layer_interpreter_map[layer_info->type];
+        if (!layer_interpreter) {
+            LOGE("ReplicateNetResource: layer_interpreter nil name:%s type:%d\n", layer_info->name.c_str(),
+                 layer_info->type);
+            return Status(TNNERR_LOAD_MODEL, "Error: layer_interpreter is nil");
+        }
+
+        std::stringstream stream;
+        Serializer serializer(stream);
+        RETURN_ON_NEQ(layer_interpreter->SaveResource(serializer, layer_info->param.get(), iter->second.get()),
+                      TNN_OK);
+        Deserializer deserializer(stream);
+        LayerResource *layer_resource = nullptr;
+        Status status = layer_interpreter->InterpretResource(deserializer, &layer_resource);
+        if (status != TNN_OK) {
+            delete layer_resource;
+            return status;
+        }
+        iter->second = std::shared_ptr<LayerResource>(layer_resource);
+    }
+
+    for (auto &element : resource->constant_map) {
+        auto src = element.second;
+        if (!src || src->GetBytesSize() <= 0) {
+            continue;
+        }
+        auto dst = std::make_shared<RawBuffer>(src->GetBytesSize(), src->force_to<char *>(), src->GetBufferDims());
+        dst->SetDataType(src->GetDataType());
+        element.second = dst;
+    }
+    return TNN_OK;
+}
+
 Status ModelInterpreter::InterpretProto(std::string &content) {
     Status ret              = TNN_OK;
     NetStructure *structure = GetNetStructure();
@@ -110,6 +110,9 @@ public:
     // @brief copy interpreter
     virtual std::shared_ptr<AbstractModelInterpreter> Copy();
 
+    // @brief copy layer resources through the layer interpreters, constants by raw copy
+    virtual Status ReplicateNetResource();
+
 private:
     // @brief get layer interpreter by layer type
     static safe_map<LayerType, std::shared_ptr<AbstractLayerInterpreter>>& LayerInterpreterMap();
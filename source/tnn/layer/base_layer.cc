@@ -228,6 +228,10 @@ void BaseLayer::SetLayerName(std::string layer_name) {
     layer_name_ = layer_name;
 }
 
+LayerType BaseLayer::GetLayerType() {
+    return type_;
+}
+
 std::string BaseLayer::GetLayerName() {
     return layer_name_;
 }
@@ -55,6 +55,9 @@ public:
     //@brief set laye name
     void SetLayerName(std::string layer_name);
 
+    //@brief get layer type
+    LayerType GetLayerType();
+
     //@brief get all input blobs
     virtual std::vector<Blob*> GetInputBlobs();
 
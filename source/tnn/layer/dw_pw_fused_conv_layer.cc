@@ -0,0 +1,63 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/layer/base_layer.h"
+
+namespace TNN_NS {
+
+DECLARE_LAYER(DwPwFusedConv, LAYER_DW_PW_FUSED_CONV);
+
+Status DwPwFusedConvLayer::InferOutputDataType() {
+    return BaseLayer::InferOutputDataType();
+}
+
+Status DwPwFusedConvLayer::InferOutputShape(bool ignore_error) {
+    BaseLayer::InferOutputShape(ignore_error);
+
+    Blob* input_blob   = input_blobs_[0];
+    Blob* output_blob  = output_blobs_[0];
+    auto layer_param   = dynamic_cast<DwPwFusedConvLayerParam*>(param_);
+    CHECK_PARAM_NULL(layer_param);
+    auto& dw_param     = layer_param->dw_param;
+
+    int num    = input_blob->GetBlobDesc().dims[0];
+    int height = input_blob->GetBlobDesc().dims[2];
+    int width  = input_blob->GetBlobDesc().dims[3];
+
+    // the optimizer only fuses depthwise conv with explicit pads
+    int kernel_extent_w = dw_param.dialations[0] * (dw_param.kernels[0] - 1) + 1;
+    int kernel_extent_h = dw_param.dialations[1] * (dw_param.kernels[1] - 1) + 1;
+    int height_out = (height + dw_param.pads[2] + dw_param.pads[3] - kernel_extent_h) / dw_param.strides[1] + 1;
+    int width_out  = (width + dw_param.pads[0] + dw_param.pads[1] - kernel_extent_w) / dw_param.strides[0] + 1;
+
+    if (height_out <= 0 || width_out <= 0) {
+        LOGE_IF(!ignore_error, "Error: invalid dw pw fused conv param, height_out(%d) or width_out(%d) is less than zero\n",
+                height_out, width_out);
+        return Status(TNNERR_PARAM_ERR, "invalid dw pw fused conv param, height_out or width_out is less than zero");
+    }
+
+    DimsVector output_dims;
+    output_dims.push_back(num);
+    output_dims.push_back(layer_param->pw_param.output_channel);
+    output_dims.push_back(height_out);
+    output_dims.push_back(width_out);
+    output_blob->GetBlobDesc().dims = output_dims;
+
+    return TNN_OK;
+}
+
+REGISTER_LAYER(DwPwFusedConv, LAYER_DW_PW_FUSED_CONV);
+
+}  // namespace TNN_NS
@@ -36,6 +36,12 @@ Status GatherLayer::InferOutputDataType() {
     //修改输出data type
     if (layer_param->data_in_resource) {
         output_blobs_[0]->GetBlobDesc().data_type = layer_resource->data.GetDataType();
+        // int8 data with one scale per row is a dynamic range quantized embedding, gathered rows are dequantized
+        auto data_dims = layer_resource->data.GetBufferDims();
+        if (layer_resource->data.GetDataType() == DATA_TYPE_INT8 && !data_dims.empty() &&
+            layer_resource->scale_data.GetDataCount() == data_dims[0]) {
+            output_blobs_[0]->GetBlobDesc().data_type = DATA_TYPE_FLOAT;
+        }
     }
 
     // if gather has 2 inputs, the output datatype is as same as the first input datatype
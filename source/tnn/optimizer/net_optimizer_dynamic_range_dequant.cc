@@ -35,6 +35,8 @@ namespace optimizer {
         if (net_config.network_type == NETWORK_TYPE_COREML) {
             return false;
         }
+        device_            = net_config.device_type;
+        keep_int8_weights_ = device_ == DEVICE_X86 && net_config.network_type != NETWORK_TYPE_OPENVINO;
         return true;
     }
 
@@ -87,6 +89,10 @@ namespace optimizer {
                 "This weight might have been dequantized before.\n", layer_name.c_str());
             return TNN_OK;
         }
+        // x86 dequantizes the filter while packing it, see X86ConvLayerAcc
+        if (keep_int8_weights_) {
+            return TNN_OK;
+        }
         auto scale_handler = conv_resource->scale_handle;
 
         const auto filter_dims = filter_handle.GetBufferDims();
@@ -176,12 +182,20 @@ namespace optimizer {
                 return TNN_OK;
             }
 
-            const int data_size = matmul_resource->weight.GetDataCount();
-            auto weight_ptr     = matmul_resource->weight.force_to<int8_t *>();
-            auto scale_value    = scale_handle.force_to<float *>()[0];
+            // x86 runs a dynamic int8 gemm on the int8 weights under low precision, and dequantizes them while
+            // packing otherwise
+            if (keep_int8_weights_) {
+                return TNN_OK;
+            }
+
+            // scales are per tensor, or per column of B when calibrated
+            const int data_size   = matmul_resource->weight.GetDataCount();
+            const int scale_count = scale_handle.GetDataCount();
+            auto weight_ptr       = matmul_resource->weight.force_to<int8_t *>();
+            auto scale_ptr        = scale_handle.force_to<float *>();
             std::vector<float> weight_data(data_size, 0);
             for (int i = 0; i < data_size; i++) {
-                weight_data[i] = scale_value * (float)(weight_ptr[i]);
+                weight_data[i] = scale_ptr[scale_count > 1 ? i % scale_count : 0] * (float)(weight_ptr[i]);
             }
 
             RawBuffer weight_buf(data_size * sizeof(float));
@@ -254,12 +268,21 @@ namespace optimizer {
             return TNN_OK;
         }
 
-        const int data_size = matmul_resource->weight_handle.GetDataCount();
-        auto weight_ptr     = matmul_resource->weight_handle.force_to<int8_t *>();
-        auto scale_value    = scale_handle.force_to<float *>()[0];
+        // x86 runs a dynamic int8 gemm on the int8 weights under low precision, and dequantizes them while
+        // packing otherwise
+        if (keep_int8_weights_) {
+            return TNN_OK;
+        }
+
+        // scales are per tensor, or per output channel when calibrated
+        const int data_size   = matmul_resource->weight_handle.GetDataCount();
+        const int scale_count = scale_handle.GetDataCount();
+        const int kernel_size = data_size / std::max(scale_count, 1);
+        auto weight_ptr       = matmul_resource->weight_handle.force_to<int8_t *>();
+        auto scale_ptr        = scale_handle.force_to<float *>();
         std::vector<float> weight_data(data_size, 0);
         for (int i = 0; i < data_size; i++) {
-            weight_data[i] = scale_value * (float)(weight_ptr[i]);
+            weight_data[i] = scale_ptr[scale_count > 1 ? i / kernel_size : 0] * (float)(weight_ptr[i]);
         }
 
         RawBuffer weight_buf(data_size * sizeof(float));
@@ -292,6 +315,11 @@ Status NetOptimizerDynamicRangeDequant::DequantGatherEmbedding(std::shared_ptr<L
         return TNN_OK;
     }
     
+    // x86 dequantizes the rows while gathering, the table stays int8 in memory
+    if (device_ == DEVICE_X86 && data_dims.size() == 2 && (layer_param->axis == 0 || layer_param->axis == -2)) {
+        return TNN_OK;
+    }
+
     const int data_count = gather_resource->data.GetDataCount();
     const int channel = data_dims[0];
     const int stride = data_dims[1];
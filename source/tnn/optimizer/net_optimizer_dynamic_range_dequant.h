@@ -40,6 +40,10 @@ namespace optimizer {
         Status DequantMatMul(std::shared_ptr<LayerInfo> &layer, NetStructure *structure, NetResource *resource);
         Status DequantInnerProduct(std::shared_ptr<LayerInfo> &layer, NetStructure *structure, NetResource *resource);
         Status DequantGatherEmbedding(std::shared_ptr<LayerInfo> &layer, NetStructure *structure, NetResource *resource);
+
+        DeviceType device_ = DEVICE_NAIVE;
+        // x86 accs consume the int8 weights of conv, inner product and matmul directly
+        bool keep_int8_weights_ = false;
     };
 
 }  // namespace optimizer
@@ -0,0 +1,174 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/optimizer/net_optimizer_fuse_dw_pw_conv.h"
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/interpreter/layer_resource.h"
+#include "tnn/optimizer/net_optimizer_manager.h"
+#include "tnn/optimizer/optimizer_const.h"
+
+namespace TNN_NS {
+
+namespace optimizer {
+
+    // P2 priority: should be fuse after conv activation fuse
+    NetOptimizerRegister<NetOptimizerFuseDwPwConv> g_net_optimizer_fuse_dw_pw_conv(OptPriority::P2);
+
+    std::string NetOptimizerFuseDwPwConv::Strategy() {
+        return kNetOptimizerFuseDwPwConv;
+    }
+
+    bool NetOptimizerFuseDwPwConv::IsSupported(const NetworkConfig &net_config) {
+        auto device = net_config.device_type;
+        // opt-in: the fused layer measured slower than the separate convs for most shapes
+        return device == DEVICE_X86 && net_config.network_type != NETWORK_TYPE_OPENVINO &&
+               net_config.enable_fuse_dw_pw_conv;
+    }
+
+    static bool IsFusableActivation(int activation_type) {
+        return activation_type == ActivationType_None || activation_type == ActivationType_ReLU ||
+               activation_type == ActivationType_ReLU6;
+    }
+
+    static bool IsFusableConv(std::shared_ptr<LayerInfo> layer, NetResource *resource) {
+        if (layer->type != LAYER_CONVOLUTION || layer->inputs.size() != 1 || layer->outputs.size() != 1) {
+            return false;
+        }
+        auto param = dynamic_cast<ConvLayerParam *>(layer->param.get());
+        if (!param || param->quantized || param->dynamic_range_quantized || param->fusion_type != FusionType_None ||
+            !IsFusableActivation(param->activation_type) || param->kernels.size() != 2) {
+            return false;
+        }
+        // find, not operator[], a null entry would stop random resources from being generated later
+        auto iter = resource->resource_map.find(layer->name);
+        return iter != resource->resource_map.end() && dynamic_cast<ConvLayerResource *>(iter->second.get());
+    }
+
+    static bool IsDepthwiseConv(std::shared_ptr<LayerInfo> layer, NetResource *resource) {
+        auto param    = dynamic_cast<ConvLayerParam *>(layer->param.get());
+        auto conv_res = dynamic_cast<ConvLayerResource *>(resource->resource_map[layer->name].get());
+        // one input channel per group, checked by filter count
+        const int filter_count = param->output_channel * param->kernels[0] * param->kernels[1];
+        // only explicit pads, the fused layer does not recompute tensorflow style pads
+        return param->group > 1 && param->output_channel == param->group && param->pad_type == -1 &&
+               conv_res->filter_handle.GetDataCount() == filter_count;
+    }
+
+    static bool IsPointwiseConv(std::shared_ptr<LayerInfo> layer) {
+        auto param = dynamic_cast<ConvLayerParam *>(layer->param.get());
+        for (auto pad : param->pads) {
+            if (pad != 0) {
+                return false;
+            }
+        }
+        return param->group == 1 && param->kernels[0] == 1 && param->kernels[1] == 1 && param->strides[0] == 1 &&
+               param->strides[1] == 1 && param->dialations[0] == 1 && param->dialations[1] == 1 &&
+               (param->pad_type == -1 || param->pad_type == 0 || param->pad_type == 1);
+    }
+
+    Status NetOptimizerFuseDwPwConv::Optimize(NetStructure *structure, NetResource *resource) {
+        if (!structure) {
+            LOGE("Error: empty NetStructure\n");
+            return Status(TNNERR_NET_ERR, "Error: empty NetStructure");
+        }
+        if (!resource) {
+            return TNN_OK;
+        }
+
+        std::vector<std::shared_ptr<LayerInfo>> layers_orig = structure->layers;
+        const int count                                     = (const int)layers_orig.size();
+        if (count <= 1) {
+            return TNN_OK;
+        }
+
+        std::map<std::string, int> blob_consumer_count;
+        for (auto layer : layers_orig) {
+            for (auto input : layer->inputs) {
+                blob_consumer_count[input]++;
+            }
+        }
+
+        // the depthwise output must only be read by the pointwise conv
+        std::map<std::string, int> dw_layer_index;
+        for (int index = 0; index < count; index++) {
+            auto layer = layers_orig[index];
+            if (IsFusableConv(layer, resource) && IsDepthwiseConv(layer, resource) &&
+                blob_consumer_count[layer->outputs[0]] == 1 &&
+                structure->outputs.find(layer->outputs[0]) == structure->outputs.end()) {
+                dw_layer_index[layer->outputs[0]] = index;
+            }
+        }
+
+        std::set<LayerInfo *> fused_dw_layers;
+        std::vector<std::shared_ptr<LayerInfo>> layers_fused;
+        for (int index = 0; index < count; index++) {
+            auto layer = layers_orig[index];
+            if (!IsFusableConv(layer, resource) || !IsPointwiseConv(layer) ||
+                dw_layer_index.find(layer->inputs[0]) == dw_layer_index.end()) {
+                layers_fused.push_back(layer);
+                continue;
+            }
+
+            auto dw_layer = layers_orig[dw_layer_index[layer->inputs[0]]];
+            auto dw_res   = dynamic_cast<ConvLayerResource *>(resource->resource_map[dw_layer->name].get());
+            auto pw_res   = dynamic_cast<ConvLayerResource *>(resource->resource_map[layer->name].get());
+
+            auto fused_param       = std::make_shared<DwPwFusedConvLayerParam>();
+            fused_param->type      = "DwPwFusedConv";
+            fused_param->name      = dw_layer->name + "_" + layer->name;
+            fused_param->dw_param  = *dynamic_cast<ConvLayerParam *>(dw_layer->param.get());
+            fused_param->pw_param  = *dynamic_cast<ConvLayerParam *>(layer->param.get());
+
+            auto fused_res         = std::make_shared<DwPwFusedConvLayerResource>();
+            fused_res->name        = fused_param->name;
+            fused_res->dw_resource = *dw_res;
+            fused_res->pw_resource = *pw_res;
+            resource->resource_map[fused_param->name] = fused_res;
+
+            auto fused_layer      = std::make_shared<LayerInfo>();
+            fused_layer->type     = LAYER_DW_PW_FUSED_CONV;
+            fused_layer->type_str = fused_param->type;
+            fused_layer->name     = fused_param->name;
+            fused_layer->inputs   = dw_layer->inputs;
+            fused_layer->outputs  = layer->outputs;
+            fused_layer->param    = fused_param;
+            layers_fused.push_back(fused_layer);
+
+            fused_dw_layers.insert(dw_layer.get());
+        }
+
+        // drop the fused depthwise layers, keep the order of others
+        std::vector<std::shared_ptr<LayerInfo>> layers_result;
+        for (auto layer : layers_fused) {
+            if (fused_dw_layers.find(layer.get()) == fused_dw_layers.end()) {
+                layers_result.push_back(layer);
+            }
+        }
+        structure->layers = layers_result;
+        LOGD("NetOptimizerFuseDwPwConv: fused %d depthwise + pointwise conv pairs\n", (int)fused_dw_layers.size());
+
+        return TNN_OK;
+    }
+
+}  // namespace optimizer
+
+}  // namespace TNN_NS
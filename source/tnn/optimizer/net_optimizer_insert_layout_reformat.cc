@@ -22,9 +22,11 @@
 #include "tnn/core/layer_type.h"
 #include "tnn/core/macro.h"
 #include "tnn/interpreter/layer_param.h"
+#include "tnn/layer/base_layer.h"
 #include "tnn/optimizer/net_optimizer_manager.h"
 #include "tnn/optimizer/optimizer_const.h"
 #include "tnn/utils/cpu_utils.h"
+#include "tnn/utils/dims_vector_utils.h"
 #include "tnn/utils/string_utils_inner.h"
 
 namespace TNN_NS {
@@ -37,6 +39,14 @@ namespace optimizer {
         return std::string("_") + ToString(layout) + "_layout_reformat";
     }
 
+    // cost of choosing the i-th implemented layout of a layer instead of the first (preferred) one,
+    // as a fraction of the bytes of the layer outputs.
+    static const float kLayoutRankCost = 0.25f;
+    // max number of refinement sweeps of the layout planner
+    static const int kLayoutRefineIterations = 4;
+
+    typedef std::map<std::string, std::vector<int>> BlobConsumerMap;
+
     std::string NetOptimizerInsertLayoutReformat::Strategy() {
         return kNetOptimizerInsertLayoutReformat;
     }
@@ -133,6 +143,449 @@ namespace optimizer {
         }
     }
 
+    // consumers of every blob among the layers with candidate layouts
+    static BlobConsumerMap GetBlobConsumers(const std::vector<std::shared_ptr<LayerInfo>> &layers,
+                                            const std::vector<std::vector<DataFormat>> &candidates) {
+        BlobConsumerMap consumers;
+        for (int index = 0; index < layers.size(); index++) {
+            if (candidates[index].empty()) {
+                continue;
+            }
+            for (const auto &input : layers[index]->inputs) {
+                auto &input_consumers = consumers[input];
+                if (input_consumers.empty() || input_consumers.back() != index) {
+                    input_consumers.push_back(index);
+                }
+            }
+        }
+        return consumers;
+    }
+
+    static bool ContainsLayout(const std::vector<DataFormat> &layouts, DataFormat layout) {
+        return std::find(layouts.begin(), layouts.end(), layout) != layouts.end();
+    }
+
+    static double BlobBytes(const std::map<std::string, int64_t> &blob_bytes, const std::string &blob) {
+        auto iter = blob_bytes.find(blob);
+        return iter != blob_bytes.end() ? (double)iter->second : 0.0;
+    }
+
+    // estimated cost of running layer[index] with the given layout: the bytes of every blob conversion that has to
+    // be inserted for its inputs or outputs, plus a small penalty for non-preferred kernels.
+    // plan holds the layouts choosed so far, DATA_FORMAT_AUTO for layers not planned yet.
+    static double LayoutCost(const int index, const DataFormat layout, const std::vector<std::shared_ptr<LayerInfo>> &layers,
+                             const std::vector<std::vector<DataFormat>> &candidates, const BlobConsumerMap &consumers,
+                             const std::map<std::string, DataFormat> &blob_layouts,
+                             const std::map<std::string, int64_t> &blob_bytes, const std::vector<DataFormat> &plan) {
+        const auto &layer   = layers[index];
+        const auto &layouts = candidates[index];
+
+        double output_bytes = 0;
+        for (const auto &output : layer->outputs) {
+            output_bytes += BlobBytes(blob_bytes, output);
+        }
+        double cost = kLayoutRankCost * (std::find(layouts.begin(), layouts.end(), layout) - layouts.begin()) *
+                      output_bytes;
+
+        std::set<std::string> visited;
+        for (const auto &input : layer->inputs) {
+            if (visited.count(input) > 0 || blob_layouts.find(input) == blob_layouts.end()) {
+                continue;
+            }
+            visited.insert(input);
+            if (blob_layouts.at(input) == layout) {
+                continue;
+            }
+            // the reformat may be shared with another consumer of the same blob
+            bool shared = false;
+            for (const auto &consumer : consumers.at(input)) {
+                if (consumer != index && plan[consumer] == layout) {
+                    shared = true;
+                    break;
+                }
+            }
+            cost += shared ? 0 : BlobBytes(blob_bytes, input);
+        }
+
+        for (const auto &output : layer->outputs) {
+            if (consumers.find(output) == consumers.end()) {
+                continue;
+            }
+            std::set<DataFormat> reformat_layouts;
+            for (const auto &consumer : consumers.at(output)) {
+                if (consumer == index) {
+                    continue;
+                }
+                auto consumer_layout = plan[consumer];
+                if (consumer_layout == DATA_FORMAT_AUTO) {
+                    // not planned yet, assume it follows us if it can
+                    consumer_layout =
+                        ContainsLayout(candidates[consumer], layout) ? layout : candidates[consumer][0];
+                }
+                if (consumer_layout != layout) {
+                    reformat_layouts.insert(consumer_layout);
+                }
+            }
+            cost += reformat_layouts.size() * BlobBytes(blob_bytes, output);
+        }
+        return cost;
+    }
+
+    // output dims of a layer from its own shape inference, empty if the layer can not infer them without data.
+    // layers reading a blob with guessed dims are not inferred, the guess may not even have the right rank.
+    static std::vector<DimsVector> InferLayerDims(const std::shared_ptr<LayerInfo> &layer, NetResource *resource,
+                                                  std::map<std::string, DimsVector> &blob_dims,
+                                                  const std::set<std::string> &guessed_blobs) {
+        std::vector<DimsVector> output_dims;
+        if (!layer->param || layer->inputs.empty()) {
+            return output_dims;
+        }
+        for (const auto &input : layer->inputs) {
+            if (blob_dims.count(input) == 0 || guessed_blobs.count(input) > 0) {
+                return output_dims;
+            }
+        }
+        std::shared_ptr<BaseLayer> base_layer(CreateLayer(layer->type));
+        if (!base_layer) {
+            return output_dims;
+        }
+
+        std::vector<std::shared_ptr<Blob>> blobs;
+        std::vector<Blob *> inputs, outputs;
+        for (const auto &input : layer->inputs) {
+            BlobDesc desc;
+            desc.name = input;
+            desc.dims = blob_dims[input];
+            blobs.push_back(std::make_shared<Blob>(desc));
+            inputs.push_back(blobs.back().get());
+        }
+        for (const auto &output : layer->outputs) {
+            BlobDesc desc;
+            desc.name = output;
+            blobs.push_back(std::make_shared<Blob>(desc));
+            outputs.push_back(blobs.back().get());
+        }
+        // shape inference may write to the param, work on a copy
+        auto param          = layer->param->Copy();
+        auto layer_resource = resource->resource_map.find(layer->name);
+        base_layer->SetConstantResource(&resource->constant_map);
+        base_layer->InferShapeAhead(inputs, outputs, param.get(),
+                                    layer_resource != resource->resource_map.end() ? layer_resource->second.get()
+                                                                                    : nullptr);
+
+        for (auto output : outputs) {
+            const auto &dims = output->GetBlobDesc().dims;
+            if (dims.empty() || DimsVectorUtils::Count(dims) <= 0) {
+                return {};
+            }
+            output_dims.push_back(dims);
+        }
+        return output_dims;
+    }
+
+    std::map<std::string, int64_t> EstimateBlobBytes(NetStructure *structure, NetResource *resource) {
+        std::map<std::string, DimsVector> blob_dims(structure->inputs_shape_map.begin(),
+                                                    structure->inputs_shape_map.end());
+        for (const auto &iter : resource->constant_map) {
+            if (iter.second) {
+                blob_dims[iter.first] = iter.second->GetBufferDims();
+            }
+        }
+
+        std::set<std::string> guessed_blobs;
+        for (const auto &layer : structure->layers) {
+            auto output_dims = InferLayerDims(layer, resource, blob_dims, guessed_blobs);
+            if (output_dims.size() == layer->outputs.size() && !output_dims.empty()) {
+                for (int i = 0; i < output_dims.size(); i++) {
+                    blob_dims[layer->outputs[i]] = output_dims[i];
+                }
+                continue;
+            }
+
+            DimsVector dims;
+            for (const auto &input : layer->inputs) {
+                if (blob_dims.count(input) > 0) {
+                    dims = blob_dims[input];
+                    break;
+                }
+            }
+            if (dims.size() < 2) {
+                continue;
+            }
+            // spatial dims shrink by the strides of conv and pooling, pads and kernels are ignored
+            auto strided = [&](const std::vector<int> &strides, bool up) {
+                for (int i = 0; i < strides.size() && i + 2 < dims.size(); i++) {
+                    // strides are in [w h d] order
+                    auto &dim = dims[dims.size() - 1 - i];
+                    dim       = up ? dim * strides[i] : (dim + strides[i] - 1) / std::max(strides[i], 1);
+                }
+            };
+            if (layer->type == LAYER_CONVOLUTION || layer->type == LAYER_DECONVOLUTION) {
+                auto param = dynamic_cast<ConvLayerParam *>(layer->param.get());
+                if (param) {
+                    dims[1] = param->output_channel;
+                    strided(param->strides, layer->type == LAYER_DECONVOLUTION);
+                }
+            } else if (layer->type == LAYER_POOLING) {
+                auto param = dynamic_cast<PoolingLayerParam *>(layer->param.get());
+                if (param && param->is_global_pool) {
+                    std::fill(dims.begin() + 2, dims.end(), 1);
+                } else if (param) {
+                    strided(param->strides, false);
+                }
+            } else if (layer->type == LAYER_INNER_PRODUCT) {
+                auto param = dynamic_cast<InnerProductLayerParam *>(layer->param.get());
+                if (param) {
+                    dims = {dims[0], param->num_output, 1, 1};
+                }
+            } else if (layer->type == LAYER_CONCAT) {
+                auto param = dynamic_cast<ConcatLayerParam *>(layer->param.get());
+                int axis   = param ? (param->axis + (int)dims.size()) % (int)dims.size() : 1;
+                dims[axis] = 0;
+                for (const auto &input : layer->inputs) {
+                    if (blob_dims.count(input) > 0 && blob_dims[input].size() == dims.size()) {
+                        dims[axis] += blob_dims[input][axis];
+                    }
+                }
+            }
+            for (const auto &output : layer->outputs) {
+                blob_dims[output] = dims;
+                guessed_blobs.insert(output);
+            }
+        }
+
+        std::map<std::string, int64_t> blob_bytes;
+        for (const auto &iter : blob_dims) {
+            blob_bytes[iter.first] = (int64_t)DimsVectorUtils::Count(iter.second) * (int64_t)sizeof(float);
+        }
+        return blob_bytes;
+    }
+
+    std::vector<DataFormat> PlanLayerLayouts(const std::vector<std::shared_ptr<LayerInfo>> &layers,
+                                             const std::vector<std::vector<DataFormat>> &candidates,
+                                             const std::map<std::string, DataFormat> &input_layouts,
+                                             const std::map<std::string, int64_t> &blob_bytes) {
+        const int count     = (const int)layers.size();
+        auto consumers      = GetBlobConsumers(layers, candidates);
+        auto blob_layouts   = input_layouts;
+
+        auto best_layout = [&](const int index, const std::vector<DataFormat> &plan, double &best_cost) {
+            DataFormat best = candidates[index][0];
+            best_cost = LayoutCost(index, best, layers, candidates, consumers, blob_layouts, blob_bytes, plan);
+            for (int i = 1; i < candidates[index].size(); i++) {
+                double cost = LayoutCost(index, candidates[index][i], layers, candidates, consumers, blob_layouts,
+                                         blob_bytes, plan);
+                if (cost < best_cost) {
+                    best      = candidates[index][i];
+                    best_cost = cost;
+                }
+            }
+            return best;
+        };
+
+        // forward pass: each layer picks its cheapest layout given its producers and a guess of its consumers
+        std::vector<DataFormat> plan(count, DATA_FORMAT_AUTO);
+        for (int index = 0; index < count; index++) {
+            if (candidates[index].empty()) {
+                continue;
+            }
+            double cost = 0;
+            plan[index] = best_layout(index, plan, cost);
+            for (const auto &output : layers[index]->outputs) {
+                blob_layouts[output] = plan[index];
+            }
+        }
+
+        // backward refinement: now that every consumer is planned, move layers to a cheaper layout until stable.
+        // a single layer in a chain can only go down in cost, so this converges quickly.
+        for (int iter = 0; iter < kLayoutRefineIterations; iter++) {
+            bool changed = false;
+            for (int index = count - 1; index >= 0; index--) {
+                if (candidates[index].empty()) {
+                    continue;
+                }
+                double best_cost = 0;
+                auto best        = best_layout(index, plan, best_cost);
+                if (best != plan[index] && best_cost < LayoutCost(index, plan[index], layers, candidates, consumers,
+                                                                  blob_layouts, blob_bytes, plan)) {
+                    plan[index] = best;
+                    for (const auto &output : layers[index]->outputs) {
+                        blob_layouts[output] = best;
+                    }
+                    changed = true;
+                }
+            }
+            if (!changed) {
+                break;
+            }
+        }
+        return plan;
+    }
+
+    // number of blob conversions the given layer layouts need, each blob is converted once per layout.
+    // bytes is set to the bytes written by these conversions.
+    static int CountReformats(const std::vector<std::shared_ptr<LayerInfo>> &layers, NetResource *resource,
+                              const std::map<std::string, DataFormat> &layouts, DataFormat input_layout,
+                              const std::map<std::string, int64_t> &blob_bytes, int64_t &bytes) {
+        std::map<std::string, DataFormat> blob_layouts;
+        for (const auto &layer : layers) {
+            if (layouts.find(layer->name) != layouts.end()) {
+                for (const auto &output : layer->outputs) {
+                    blob_layouts[output] = layouts.at(layer->name);
+                }
+            }
+        }
+
+        std::set<std::pair<std::string, DataFormat>> conversions;
+        for (const auto &layer : layers) {
+            if (layouts.find(layer->name) == layouts.end()) {
+                continue;
+            }
+            const auto layout = layouts.at(layer->name);
+            for (const auto &input : layer->inputs) {
+                if (resource->constant_map.count(input) > 0) {
+                    continue;
+                }
+                auto src_layout = blob_layouts.count(input) > 0 ? blob_layouts[input] : input_layout;
+                if (src_layout != layout) {
+                    conversions.insert(std::make_pair(input, layout));
+                }
+            }
+        }
+        bytes = 0;
+        for (const auto &conversion : conversions) {
+            bytes += (int64_t)BlobBytes(blob_bytes, conversion.first);
+        }
+        return (int)conversions.size();
+    }
+
+    static int CountReformatBlobs(const std::vector<std::shared_ptr<LayerInfo>> &layers) {
+        int count = 0;
+        for (const auto &layer : layers) {
+            if (layer->type == LAYER_REFORMAT) {
+                count += (int)layer->outputs.size();
+            }
+        }
+        return count;
+    }
+
+    int MergeReformatLayers(NetStructure *structure) {
+        auto &layers = structure->layers;
+        int merged   = 0;
+
+        // outputs of the previous reformats of merged ones, dropped below if nobody reads them any more
+        std::set<std::string> merged_inputs;
+        // blob -> (reformat layer, input blob of the reformat)
+        std::map<std::string, std::pair<LayerInfo *, std::string>> reformat_producers;
+        for (auto &layer : layers) {
+            if (layer->type != LAYER_REFORMAT) {
+                continue;
+            }
+            auto param = dynamic_cast<ReformatLayerParam *>(layer->param.get());
+            if (!param) {
+                continue;
+            }
+            for (int i = (int)layer->inputs.size() - 1; i >= 0; i--) {
+                const auto input  = layer->inputs[i];
+                const auto output = layer->outputs[i];
+                if (reformat_producers.find(input) == reformat_producers.end() || structure->outputs.count(output)) {
+                    continue;
+                }
+                auto prev       = reformat_producers[input];
+                auto prev_param = dynamic_cast<ReformatLayerParam *>(prev.first->param.get());
+                if (!prev_param) {
+                    continue;
+                }
+                const auto origin = prev.second;
+                if (prev_param->src_format == param->dst_format && prev_param->dst_format == param->src_format &&
+                    prev_param->src_type == param->dst_type && prev_param->dst_type == param->src_type) {
+                    // the reformat converts the output of the previous reformat back, its readers can read the blob
+                    // before the previous reformat directly.
+                    for (auto &next_layer : layers) {
+                        std::replace(next_layer->inputs.begin(), next_layer->inputs.end(), output, origin);
+                    }
+                    layer->inputs.erase(layer->inputs.begin() + i);
+                    layer->outputs.erase(layer->outputs.begin() + i);
+                    structure->blobs.erase(output);
+                    merged_inputs.insert(input);
+                    merged++;
+                } else if (layer->inputs.size() == 1 && prev_param->dst_format == param->src_format &&
+                           prev_param->src_type == prev_param->dst_type && param->src_type == param->dst_type &&
+                           prev_param->dst_type == param->src_type) {
+                    // two layout conversions in a row are done by one reformat from the blob before the previous
+                    // one, reformats that also change the data type are kept as they are.
+                    layer->inputs[i]  = origin;
+                    param->src_format = prev_param->src_format;
+                    merged_inputs.insert(input);
+                    merged++;
+                }
+            }
+            for (int i = 0; i < layer->outputs.size(); i++) {
+                reformat_producers[layer->outputs[i]] = std::make_pair(layer.get(), layer->inputs[i]);
+            }
+        }
+
+        // drop the outputs of the previous reformats nobody reads any more
+        std::set<std::string> used_blobs(structure->outputs.begin(), structure->outputs.end());
+        for (const auto &layer : layers) {
+            used_blobs.insert(layer->inputs.begin(), layer->inputs.end());
+        }
+        for (auto &layer : layers) {
+            if (layer->type != LAYER_REFORMAT) {
+                continue;
+            }
+            for (int i = (int)layer->outputs.size() - 1; i >= 0; i--) {
+                if (merged_inputs.count(layer->outputs[i]) > 0 && used_blobs.count(layer->outputs[i]) == 0) {
+                    structure->blobs.erase(layer->outputs[i]);
+                    layer->inputs.erase(layer->inputs.begin() + i);
+                    layer->outputs.erase(layer->outputs.begin() + i);
+                }
+            }
+        }
+
+        layers.erase(std::remove_if(layers.begin(), layers.end(),
+                                    [](const std::shared_ptr<LayerInfo> &layer) {
+                                        return layer->type == LAYER_REFORMAT && layer->outputs.empty();
+                                    }),
+                     layers.end());
+        return merged;
+    }
+
+    Status NetOptimizerInsertLayoutReformat::PlanLayouts(const std::vector<std::shared_ptr<LayerInfo>> &layers,
+                                                         NetStructure *structure, NetResource *resource,
+                                                         DataFormat input_layout,
+                                                         const std::map<std::string, int64_t> &blob_bytes) {
+        const int count             = (const int)layers.size();
+        const auto &constant_layers = resource->constant_layers;
+        const auto &constant_blobs  = resource->constant_map;
+
+        std::vector<std::vector<DataFormat>> candidates(count);
+        for (int index = 0; index < count; index++) {
+            if (constant_layers.count(layers[index]->name) > 0) {
+                continue;
+            }
+            auto implemented_layouts = GetLayoutsByLayerType(layers[index]->type);
+            if (implemented_layouts) {
+                candidates[index] = implemented_layouts->layouts;
+            }
+        }
+
+        std::map<std::string, DataFormat> input_layouts;
+        for (const auto &iter : structure->inputs_shape_map) {
+            if (constant_blobs.count(iter.first) == 0) {
+                input_layouts[iter.first] = input_layout;
+            }
+        }
+
+        auto plan = PlanLayerLayouts(layers, candidates, input_layouts, blob_bytes);
+        for (int index = 0; index < count; index++) {
+            if (plan[index] != DATA_FORMAT_AUTO) {
+                layer_choosed_layout[layers[index]->name] = plan[index];
+            }
+        }
+        return TNN_OK;
+    }
+
     Status NetOptimizerInsertLayoutReformat::Optimize(NetStructure *structure, NetResource *resource) {
         if (!structure) {
             LOGE("Error: empty NetStructure\n");
@@ -153,6 +606,50 @@ namespace optimizer {
 
         const auto &constant_layers = resource->constant_layers;
         const auto &constant_blobs  = resource->constant_map;
+
+        // choose layouts for the whole graph first, the insertion below follows the choosed layouts
+        const auto model_input_layout = GetInputLayout(net_config_, device_->GetDeviceType());
+        std::map<std::string, DataFormat> greedy_layouts;
+        std::map<std::string, std::string> blob_producer;
+        for (const auto &layer : layers_orig) {
+            if (constant_layers.count(layer->name) > 0) {
+                continue;
+            }
+            auto implemented_layouts = GetLayoutsByLayerType(layer->type);
+            if (!implemented_layouts || implemented_layouts->layouts.empty()) {
+                continue;
+            }
+            // the layout the layer-by-layer strategy would pick: follow the first producer if possible
+            DataFormat layout = implemented_layouts->layouts[0];
+            for (const auto &input : layer->inputs) {
+                DataFormat src_layout = DATA_FORMAT_AUTO;
+                if (structure->inputs_shape_map.count(input) > 0) {
+                    src_layout = model_input_layout;
+                } else if (blob_producer.count(input) > 0) {
+                    src_layout = greedy_layouts[blob_producer[input]];
+                }
+                if (src_layout != DATA_FORMAT_AUTO) {
+                    if (ContainsLayout(implemented_layouts->layouts, src_layout)) {
+                        layout = src_layout;
+                    }
+                    break;
+                }
+            }
+            greedy_layouts[layer->name] = layout;
+            for (const auto &output : layer->outputs) {
+                blob_producer[output] = layer->name;
+            }
+        }
+        const auto blob_bytes = EstimateBlobBytes(structure, resource);
+        RETURN_ON_NEQ(PlanLayouts(layers_orig, structure, resource, model_input_layout, blob_bytes), TNN_OK);
+        int64_t greedy_bytes = 0, planned_bytes = 0;
+        const int greedy_reformats =
+            CountReformats(layers_orig, resource, greedy_layouts, model_input_layout, blob_bytes, greedy_bytes);
+        const int planned_reformats =
+            CountReformats(layers_orig, resource, layer_choosed_layout, model_input_layout, blob_bytes, planned_bytes);
+        LOGD("NetOptimizerInsertLayoutReformat: layer-by-layer layouts need %d reformats (~%lld bytes), "
+             "planned layouts need %d reformats (~%lld bytes)\n",
+             greedy_reformats, (long long)greedy_bytes, planned_reformats, (long long)planned_bytes);
         // reformat input layers if needed.
         // support multi inputs/outputs.
         // support multi layouts
@@ -338,6 +835,11 @@ namespace optimizer {
         structure->layers = layers_modified;
         layer_choosed_layout.clear();
 
+        const int reformats_before = CountReformatBlobs(structure->layers);
+        const int merged           = MergeReformatLayers(structure);
+        LOGD("NetOptimizerInsertLayoutReformat: %d reformat blobs before merging, %d merged, %d after merging\n",
+             reformats_before, merged, CountReformatBlobs(structure->layers));
+
         return TNN_OK;
     }
 
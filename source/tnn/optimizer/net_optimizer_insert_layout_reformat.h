@@ -15,7 +15,10 @@
 #ifndef TNN_SOURCE_TNN_OPTIMIZER_NET_OPTIMIZER_INSERT_LAYOUT_REFORMAT_H_
 #define TNN_SOURCE_TNN_OPTIMIZER_NET_OPTIMIZER_INSERT_LAYOUT_REFORMAT_H_
 
+#include <map>
+#include <set>
 #include <string>
+#include <vector>
 
 #include "tnn/core/abstract_device.h"
 #include "tnn/core/common.h"
@@ -28,6 +31,27 @@ namespace TNN_NS {
 
 namespace optimizer {
 
+    // @brief estimate the fp32 bytes of every blob from the model input shapes. the shapes come from the shape
+    // inference of the layers, layers that can not infer their shape without data keep the shape of their first
+    // input, or the shape of conv, deconv, pooling, inner product and concat estimated from their params.
+    std::map<std::string, int64_t> EstimateBlobBytes(NetStructure* structure, NetResource* resource);
+
+    // @brief choose the layout of every layer that minimizes the bytes written by reformats, plus a penalty for
+    // kernels other than the preferred one.
+    // @param candidates implemented layouts of every layer, preferred first, empty for layers left out
+    // @param input_layouts layouts of the model inputs
+    // @param blob_bytes estimated bytes of the blobs
+    // @return the layout of every layer, DATA_FORMAT_AUTO for the layers left out
+    std::vector<DataFormat> PlanLayerLayouts(const std::vector<std::shared_ptr<LayerInfo>>& layers,
+                                             const std::vector<std::vector<DataFormat>>& candidates,
+                                             const std::map<std::string, DataFormat>& input_layouts,
+                                             const std::map<std::string, int64_t>& blob_bytes);
+
+    // @brief remove the reformats that convert the output of the previous reformat back, and let two layout
+    // reformats of the same data type in a row convert from the blob before the first one.
+    // @return the number of merged reformat blobs
+    int MergeReformatLayers(NetStructure* structure);
+
     //@brief net optimize: insert reformat layer between layers with different layouts
     class NetOptimizerInsertLayoutReformat : public NetOptimizer {
     public:
@@ -44,6 +68,12 @@ namespace optimizer {
     private:
         std::shared_ptr<const ImplementedLayout> GetLayoutsByLayerType(LayerType type);
 
+        // @brief choose the layout of every layer before reformat insertion by minimizing the estimated
+        // reformat bytes over the whole graph, the result is stored in layer_choosed_layout.
+        Status PlanLayouts(const std::vector<std::shared_ptr<LayerInfo>>& layers, NetStructure* structure,
+                           NetResource* resource, DataFormat input_layout,
+                           const std::map<std::string, int64_t>& blob_bytes);
+
         AbstractDevice* device_;
         AbstractDevice* adaptor_device_;
         std::map<std::string, DataFormat> layer_choosed_layout;
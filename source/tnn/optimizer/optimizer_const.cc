@@ -54,4 +54,7 @@ const char * kNetOptimizerDynamicRangeDequant =
 const char * kNetOptimizerConvertMatMulToConv =
     "net_optimizer_convert_matmul_to_conv";
 
+const char * kNetOptimizerFuseDwPwConv =
+    "net_optimizer_fuse_dw_pw_conv";
+
 }  // namespace TNN_NS
@@ -45,6 +45,8 @@ extern const char * kNetOptimizerDynamicRangeDequant;
 
 extern const char * kNetOptimizerConvertMatMulToConv;
 
+extern const char * kNetOptimizerFuseDwPwConv;
+
 }
 
 #endif // TNN_SOURCE_TNN_OPTIMIZER_OPTIMIZER_CONST_H_
@@ -17,6 +17,7 @@
 #include <string.h>
 #include <vector>
 #include "tnn/utils/cpu_info.h"
+#include "tnn/utils/numa_utils.h"
 
 #ifdef _OPENMP
 #include <omp.h>
@@ -609,4 +610,16 @@ void CpuUtils::SetCpuDenormal(int denormal) {
 #endif
 }
 
+int CpuUtils::GetNumaNodeCount() {
+    return NumaUtils::GetNodeCount();
+}
+
+Status CpuUtils::GetNumaNodeCpus(int node, std::vector<int>& cpu_list) {
+    return NumaUtils::GetNodeCpus(node, cpu_list);
+}
+
+Status CpuUtils::SetNumaInterleave(bool interleave) {
+    return interleave ? NumaUtils::SetInterleave() : NumaUtils::SetDefault();
+}
+
 }  // namespace TNN_NS
@@ -29,6 +29,9 @@
 
 namespace TNN_NS {
 
+// the naive kernels are the reference of the other devices, they only run independent outputs in parallel and
+// accumulate every output on one thread in the serial order, so the results are the same for any thread count
+
 int8_t float2int8(float val) {
     return static_cast<int8_t>(MAX(MIN(val + (val >= 0.f ? 0.5f : -0.5f), 127.0f), -128.0f));
 }
@@ -62,6 +65,7 @@ void NaiveAdaptivePooling(T *input_data, T *output_data, DimsVector dims_input,
     int64_t output_height  = is_1d ? dims_output[1] : dims_output[2];
     int64_t output_width   = is_1d ? dims_output[2] : dims_output[3];
 
+    OMP_PARALLEL_FOR_
     for (int c = 0; c < channels; c++) {
         T *input_ptr  = input_data + c * input_height * input_width;
         T *output_ptr = output_data + c * output_height * output_width;
@@ -107,6 +111,7 @@ void NaivePooling(T *input_ptr, T *output_ptr, DimsVector dims_input, DimsVector
     for (int n = 0; n < dims_output[0]; n++) {
         T *in_current_batch = input_ptr + n * input_width * input_height * output_channel;
         T *ou_current_batch = output_ptr + n * output_width * output_height * output_channel;
+        OMP_PARALLEL_FOR_
         for (int c = 0; c < output_channel; c++) {
             for (int h = 0; h < output_height; h++) {
                 for (int w = 0; w < output_width; w++) {
@@ -187,6 +192,7 @@ void NaivePooling3D(T *input_ptr, T *output_ptr, DimsVector dims_input, DimsVect
     for (int n = 0; n < dims_output[0]; n++) {
         T *in_current_batch = input_ptr + n * input_width * input_height * input_depth * output_channel;
         T *ou_current_batch = output_ptr + n * output_width * output_height * output_depth * output_channel;
+        OMP_PARALLEL_FOR_
         for (int c = 0; c < output_channel; c++) {
             for (int d = 0; d < output_depth; d++) {
                 for (int h = 0; h < output_height; h++) {
@@ -378,57 +384,55 @@ void NaiveConv1D(void *input_ptr, void *output_ptr, void *weight_ptr, void *bias
     int input_channels_per_group  = input_channel / group;
 
     OMP_PARALLEL_FOR_
-    for (int n = 0; n < number; ++n) {
-        for (int g = 0; g < group; ++g) {
-            int output_c_start = g * output_channels_per_group;
-            int output_c_end   = (g + 1) * output_channels_per_group;
-            int input_c_start  = g * input_channels_per_group;
-            int input_c_end    = (g + 1) * input_channels_per_group;
-            int weights_start  = g * output_channels_per_group * input_channels_per_group * kernel_size;
-            for (int output_c = output_c_start; output_c < output_c_end; ++output_c) {
-                for (int h = 0; h < output_height; ++h) {
-                    int input_h_start = h * stride - pad;
-                    Tacc result       = static_cast<Tacc>(0.0f);
-                    for (int kernel_h = 0; kernel_h < kernel_size; ++kernel_h) {
-                        int input_h = input_h_start + kernel_h * dilation;
-                        if (input_h < 0 || input_h >= input_height) {
-                            continue;
-                        }
-                        for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
-                            int input_position = (n * input_channel + input_c) * input_height + input_h;
-                            int weight_position =
-                                weights_start +
-                                ((output_c - output_c_start) * input_channels_per_group + input_c - input_c_start) *
-                                kernel_size +
-                                kernel_h;
-                            auto ip = input_data[input_position];
-                            auto wd = weight_data[weight_position];
-                            result += input_data[input_position] * weight_data[weight_position];
-                        }
-                    }
+    for (int index = 0; index < number * output_channel; ++index) {
+        int n              = index / output_channel;
+        int output_c       = index % output_channel;
+        int g              = output_c / output_channels_per_group;
+        int output_c_start = g * output_channels_per_group;
+        int input_c_start  = g * input_channels_per_group;
+        int input_c_end    = (g + 1) * input_channels_per_group;
+        int weights_start  = g * output_channels_per_group * input_channels_per_group * kernel_size;
+        for (int h = 0; h < output_height; ++h) {
+            int input_h_start = h * stride - pad;
+            Tacc result       = static_cast<Tacc>(0.0f);
+            for (int kernel_h = 0; kernel_h < kernel_size; ++kernel_h) {
+                int input_h = input_h_start + kernel_h * dilation;
+                if (input_h < 0 || input_h >= input_height) {
+                    continue;
+                }
+                for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
+                    int input_position = (n * input_channel + input_c) * input_height + input_h;
+                    int weight_position =
+                        weights_start +
+                        ((output_c - output_c_start) * input_channels_per_group + input_c - input_c_start) *
+                        kernel_size +
+                        kernel_h;
+                    auto ip = input_data[input_position];
+                    auto wd = weight_data[weight_position];
+                    result += input_data[input_position] * weight_data[weight_position];
+                }
+            }
 
-                    int output_position = (n * output_channel + output_c) * output_height + h;
-                    if (bias_data) {
-                        result += bias_data[output_c];
-                    }
-                    if (sizeof(Tin) > 1) {  // float
-                        FloatActivate(result, activation_type);
-                        output_data[output_position] = result;
-                    } else {
-                        int scaleidx = scale_len == 1 ? 0 : output_c;
-                        float val    = result * scale[scaleidx];
-                        if (fusion_type == FusionType_Conv_Add_Activation) {
-                            val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
-                        }
-                        if (activation_type == ActivationType_ReLU) {
-                            val = std::max(0.0f, val);
-                        }
-                        if (fusion_type == FusionType_Conv_Activation_Add) {
-                            val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
-                        }
-                        output_data[output_position] = float2int8(val);
-                    }
+            int output_position = (n * output_channel + output_c) * output_height + h;
+            if (bias_data) {
+                result += bias_data[output_c];
+            }
+            if (sizeof(Tin) > 1) {  // float
+                FloatActivate(result, activation_type);
+                output_data[output_position] = result;
+            } else {
+                int scaleidx = scale_len == 1 ? 0 : output_c;
+                float val    = result * scale[scaleidx];
+                if (fusion_type == FusionType_Conv_Add_Activation) {
+                    val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
+                }
+                if (activation_type == ActivationType_ReLU) {
+                    val = std::max(0.0f, val);
                 }
+                if (fusion_type == FusionType_Conv_Activation_Add) {
+                    val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
+                }
+                output_data[output_position] = float2int8(val);
             }
         }
     }
@@ -465,75 +469,73 @@ void NaiveConv(void *input_ptr, void *output_ptr, void *weight_ptr, void *bias,
     int input_channels_per_group  = input_channel / group;
 
     OMP_PARALLEL_FOR_
-    for (int n = 0; n < number; ++n) {
-        for (int g = 0; g < group; ++g) {
-            int output_c_start = g * output_channels_per_group;
-            int output_c_end   = (g + 1) * output_channels_per_group;
-            int input_c_start  = g * input_channels_per_group;
-            int input_c_end    = (g + 1) * input_channels_per_group;
-            int weights_start =
-                g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y;
-            for (int output_c = output_c_start; output_c < output_c_end; ++output_c) {
-                for (int h = 0; h < output_height; ++h) {
-                    int input_h_start = h * stride_y - pad_y;
-                    for (int w = 0; w < output_width; ++w) {
-                        int input_w_start = w * stride_x - pad_x;
-                        Tacc result       = static_cast<Tacc>(0.0f);
-                        for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
-                            int input_h = input_h_start + kernel_h * dilation;
-                            if (input_h < 0 || input_h >= input_height) {
-                                continue;
-                            }
-                            for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
-                                int input_w = input_w_start + kernel_w * dilation;
-                                if (input_w < 0 || input_w >= input_width) {
-                                    continue;
-                                }
-                                for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
-                                    int input_position =
-                                        ((n * input_channel + input_c) * input_height + input_h) * input_width +
-                                        input_w;
-                                    int weight_position = weights_start +
-                                                          (((output_c - output_c_start) * input_channels_per_group +
-                                                            input_c - input_c_start) *
-                                                               kernel_size_y +
-                                                           kernel_h) *
-                                                              kernel_size_x +
-                                                          kernel_w;
-                                    result += input_data[input_position] * weight_data[weight_position];
-                                }
-                            }
-                        }
-
-                        int output_position = ((n * output_channel + output_c) * output_height + h) * output_width + w;
-                        if (bias_data) {
-                            result += bias_data[output_c];
+    for (int index = 0; index < number * output_channel; ++index) {
+        int n              = index / output_channel;
+        int output_c       = index % output_channel;
+        int g              = output_c / output_channels_per_group;
+        int output_c_start = g * output_channels_per_group;
+        int input_c_start  = g * input_channels_per_group;
+        int input_c_end    = (g + 1) * input_channels_per_group;
+        int weights_start =
+            g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y;
+        for (int h = 0; h < output_height; ++h) {
+            int input_h_start = h * stride_y - pad_y;
+            for (int w = 0; w < output_width; ++w) {
+                int input_w_start = w * stride_x - pad_x;
+                Tacc result       = static_cast<Tacc>(0.0f);
+                for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
+                    int input_h = input_h_start + kernel_h * dilation;
+                    if (input_h < 0 || input_h >= input_height) {
+                        continue;
+                    }
+                    for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
+                        int input_w = input_w_start + kernel_w * dilation;
+                        if (input_w < 0 || input_w >= input_width) {
+                            continue;
                         }
-                        if (sizeof(Tin) > 1) {  // float
-                            FloatActivate(result, activation_type);
-                            output_data[output_position] = result;
-                        } else {
-                            int scale_idx = weight_scale_len == 1 ? 0 : output_c;
-                            float val    = result * weight_scale[scale_idx];
-                            if (fusion_type == FusionType_Conv_Add_Activation) {
-                                val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
-                            }
-                            if (activation_type == ActivationType_ReLU) {
-                                val = std::max(0.0f, val);
-                            } else if (activation_type == ActivationType_ReLU6) {
-                                int relu6_max_idx = relu6_max_len == 1 ? 0:output_c;
-                                int8_t res = std::min(float2int8(val), relu6_max[relu6_max_idx]);
-                                res = std::max((int8_t)0, res);
-                                output_data[output_position] = res;
-                                continue;
-                            }
-                            if (fusion_type == FusionType_Conv_Activation_Add) {
-                                val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
-                            }
-                            output_data[output_position] = float2int8(val);
+                        for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
+                            int input_position =
+                                ((n * input_channel + input_c) * input_height + input_h) * input_width +
+                                input_w;
+                            int weight_position = weights_start +
+                                                  (((output_c - output_c_start) * input_channels_per_group +
+                                                    input_c - input_c_start) *
+                                                       kernel_size_y +
+                                                   kernel_h) *
+                                                      kernel_size_x +
+                                                  kernel_w;
+                            result += input_data[input_position] * weight_data[weight_position];
                         }
                     }
                 }
+
+                int output_position = ((n * output_channel + output_c) * output_height + h) * output_width + w;
+                if (bias_data) {
+                    result += bias_data[output_c];
+                }
+                if (sizeof(Tin) > 1) {  // float
+                    FloatActivate(result, activation_type);
+                    output_data[output_position] = result;
+                } else {
+                    int scale_idx = weight_scale_len == 1 ? 0 : output_c;
+                    float val    = result * weight_scale[scale_idx];
+                    if (fusion_type == FusionType_Conv_Add_Activation) {
+                        val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
+                    }
+                    if (activation_type == ActivationType_ReLU) {
+                        val = std::max(0.0f, val);
+                    } else if (activation_type == ActivationType_ReLU6) {
+                        int relu6_max_idx = relu6_max_len == 1 ? 0:output_c;
+                        int8_t res = std::min(float2int8(val), relu6_max[relu6_max_idx]);
+                        res = std::max((int8_t)0, res);
+                        output_data[output_position] = res;
+                        continue;
+                    }
+                    if (fusion_type == FusionType_Conv_Activation_Add) {
+                        val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
+                    }
+                    output_data[output_position] = float2int8(val);
+                }
             }
         }
     }
@@ -565,92 +567,90 @@ void NaiveConvBias(void *input_ptr, void *output_ptr, void *weight_ptr, void *bi
     Tin *add_bias_i               = static_cast<Tin *>(add_bias_input);
 
     OMP_PARALLEL_FOR_
-    for (int n = 0; n < number; ++n) {
-        for (int g = 0; g < group; ++g) {
-            int output_c_start = g * output_channels_per_group;
-            int output_c_end   = (g + 1) * output_channels_per_group;
-            int input_c_start  = g * input_channels_per_group;
-            int input_c_end    = (g + 1) * input_channels_per_group;
-            int weights_start =
-                g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y;
-            for (int output_c = output_c_start; output_c < output_c_end; ++output_c) {
-                int scale_idx = weight_scale_len == 1 ? 0 : output_c;
-                int weight_bias_idx = zero_point_len_w == 1 ? 0 : output_c;
-                int output_bias_idx = zero_point_len_o == 1 ? 0 : output_c;
-                for (int h = 0; h < output_height; ++h) {
-                    int input_h_start = h * stride_y - pad_y;
-                    for (int w = 0; w < output_width; ++w) {
-                        int input_w_start = w * stride_x - pad_x;
-                        Tacc result       = static_cast<Tacc>(0.0f);
-                        int output_position = ((n * output_channel + output_c) * output_height + h) * output_width + w;
-                        for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
-                            int input_h = input_h_start + kernel_h * dilation;
-                            bool pad_flag_h = false;
-                            if (input_h < 0 || input_h >= input_height) {
-                                pad_flag_h = true;
-                            }
-                            for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
-                                int input_w = input_w_start + kernel_w * dilation;
-                                bool pad_flag_w = false;
-                                if (input_w < 0 || input_w >= input_width) {
-                                    pad_flag_w = true;
-                                }
-                                for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
-                                    int weight_position = weights_start +
-                                                          (((output_c - output_c_start) * input_channels_per_group +
-                                                            input_c - input_c_start) *
-                                                               kernel_size_y +
-                                                           kernel_h) *
-                                                              kernel_size_x +
-                                                          kernel_w;
-                                    if (pad_flag_h || pad_flag_w) {
-                                        int input_bias_idx = zero_point_len_i == 1 ? 0 : input_c;
-                                        result += static_cast<Tacc>(zero_point_handle_i[input_bias_idx] *
-                                                                    weight_data[weight_position]) -
-                                                  static_cast<Tacc>(zero_point_handle_i[input_bias_idx] *
-                                                                    zero_point_handle_w[weight_bias_idx]);
-                                    } else {
-                                        int input_position =
-                                            ((n * input_channel + input_c) * input_height + input_h) * input_width +
-                                            input_w;
-                                        result += input_data[input_position] * weight_data[weight_position] -
-                                                  static_cast<Tacc>(input_data[input_position] *
-                                                                    zero_point_handle_w[weight_bias_idx]);
-                                    }
-                                }
-                            }
-                        }
-                        result += buffer_weight_x_bias[output_c];
-                        if (bias_data) {
-                            result += bias_data[output_c];
+    for (int index = 0; index < number * output_channel; ++index) {
+        int n              = index / output_channel;
+        int output_c       = index % output_channel;
+        int g              = output_c / output_channels_per_group;
+        int output_c_start = g * output_channels_per_group;
+        int input_c_start  = g * input_channels_per_group;
+        int input_c_end    = (g + 1) * input_channels_per_group;
+        int weights_start =
+            g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y;
+        int scale_idx = weight_scale_len == 1 ? 0 : output_c;
+        int weight_bias_idx = zero_point_len_w == 1 ? 0 : output_c;
+        int output_bias_idx = zero_point_len_o == 1 ? 0 : output_c;
+        for (int h = 0; h < output_height; ++h) {
+            int input_h_start = h * stride_y - pad_y;
+            for (int w = 0; w < output_width; ++w) {
+                int input_w_start = w * stride_x - pad_x;
+                Tacc result       = static_cast<Tacc>(0.0f);
+                int output_position = ((n * output_channel + output_c) * output_height + h) * output_width + w;
+                for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
+                    int input_h = input_h_start + kernel_h * dilation;
+                    bool pad_flag_h = false;
+                    if (input_h < 0 || input_h >= input_height) {
+                        pad_flag_h = true;
+                    }
+                    for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
+                        int input_w = input_w_start + kernel_w * dilation;
+                        bool pad_flag_w = false;
+                        if (input_w < 0 || input_w >= input_width) {
+                            pad_flag_w = true;
                         }
-                        if (sizeof(Tin) > 1) {  // float
-                            FloatActivate(result, activation_type);
-                            output_data[output_position] = result;
-                        } else {
-                            float val = result * weight_scale[scale_idx];
-                            if (fusion_type == FusionType_Conv_Add_Activation) {
-                                val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
-                                       add_bias_i[output_bias_idx] * add_scale[output_c];
-                            }
-                            if (activation_type == ActivationType_ReLU) {
-                                val = std::max(0.0f, val);
-                            } else if (activation_type == ActivationType_ReLU6) {
-                                int relu6_max_idx            = relu6_max_len == 1 ? 0 : output_c;
-                                int8_t res                   = std::min(float2int8(val), relu6_max[relu6_max_idx]);
-                                res                          = std::max((int8_t)0, res);
-                                output_data[output_position] = res;
-                                continue;
-                            }
-                            if (fusion_type == FusionType_Conv_Activation_Add) {
-                                val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
-                                       add_bias_i[output_bias_idx] * add_scale[output_c];
+                        for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
+                            int weight_position = weights_start +
+                                                  (((output_c - output_c_start) * input_channels_per_group +
+                                                    input_c - input_c_start) *
+                                                       kernel_size_y +
+                                                   kernel_h) *
+                                                      kernel_size_x +
+                                                  kernel_w;
+                            if (pad_flag_h || pad_flag_w) {
+                                int input_bias_idx = zero_point_len_i == 1 ? 0 : input_c;
+                                result += static_cast<Tacc>(zero_point_handle_i[input_bias_idx] *
+                                                            weight_data[weight_position]) -
+                                          static_cast<Tacc>(zero_point_handle_i[input_bias_idx] *
+                                                            zero_point_handle_w[weight_bias_idx]);
+                            } else {
+                                int input_position =
+                                    ((n * input_channel + input_c) * input_height + input_h) * input_width +
+                                    input_w;
+                                result += input_data[input_position] * weight_data[weight_position] -
+                                          static_cast<Tacc>(input_data[input_position] *
+                                                            zero_point_handle_w[weight_bias_idx]);
                             }
-                            val += static_cast<Tacc>(zero_point_handle_o[output_bias_idx]);
-                            output_data[output_position] = float2int8(val);
                         }
                     }
                 }
+                result += buffer_weight_x_bias[output_c];
+                if (bias_data) {
+                    result += bias_data[output_c];
+                }
+                if (sizeof(Tin) > 1) {  // float
+                    FloatActivate(result, activation_type);
+                    output_data[output_position] = result;
+                } else {
+                    float val = result * weight_scale[scale_idx];
+                    if (fusion_type == FusionType_Conv_Add_Activation) {
+                        val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
+                               add_bias_i[output_bias_idx] * add_scale[output_c];
+                    }
+                    if (activation_type == ActivationType_ReLU) {
+                        val = std::max(0.0f, val);
+                    } else if (activation_type == ActivationType_ReLU6) {
+                        int relu6_max_idx            = relu6_max_len == 1 ? 0 : output_c;
+                        int8_t res                   = std::min(float2int8(val), relu6_max[relu6_max_idx]);
+                        res                          = std::max((int8_t)0, res);
+                        output_data[output_position] = res;
+                        continue;
+                    }
+                    if (fusion_type == FusionType_Conv_Activation_Add) {
+                        val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
+                               add_bias_i[output_bias_idx] * add_scale[output_c];
+                    }
+                    val += static_cast<Tacc>(zero_point_handle_o[output_bias_idx]);
+                    output_data[output_position] = float2int8(val);
+                }
             }
         }
     }
@@ -681,86 +681,84 @@ void NaiveConvBias(void *input_ptr, void *output_ptr, void *weight_ptr, void *bi
     Tin *add_bias_i               = static_cast<Tin *>(add_bias_input);
 
     OMP_PARALLEL_FOR_
-    for (int n = 0; n < number; ++n) {
-        for (int g = 0; g < group; ++g) {
-            int output_c_start = g * output_channels_per_group;
-            int output_c_end   = (g + 1) * output_channels_per_group;
-            int input_c_start  = g * input_channels_per_group;
-            int input_c_end    = (g + 1) * input_channels_per_group;
-            int weights_start =
-                g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y;
-            for (int output_c = output_c_start; output_c < output_c_end; ++output_c) {
-                int scale_idx = weight_scale_len == 1 ? 0 : output_c;
-                int weight_bias_idx = zero_point_len_w == 1 ? 0 : output_c;
-                int output_bias_idx = zero_point_len_o == 1 ? 0 : output_c;
-                for (int h = 0; h < output_height; ++h) {
-                    int input_h_start = h * stride_y - pad_y;
-                    for (int w = 0; w < output_width; ++w) {
-                        int input_w_start   = w * stride_x - pad_x;
-                        Tacc result         = static_cast<Tacc>(0.0f);
-                        int output_position = ((n * output_channel + output_c) * output_height + h) * output_width + w;
-                        for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
-                            int input_h = input_h_start + kernel_h * dilation;
-                            if (input_h < 0 || input_h >= input_height) {
-                                continue;
-                            }
-                            for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
-                                int input_w = input_w_start + kernel_w * dilation;
-                                if (input_w < 0 || input_w >= input_width) {
-                                    continue;
-                                }
-                                for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
-                                    int input_position =
-                                        ((n * input_channel + input_c) * input_height + input_h) * input_width +
-                                        input_w;
-                                    int weight_position = weights_start +
-                                                          (((output_c - output_c_start) * input_channels_per_group +
-                                                            input_c - input_c_start) *
-                                                               kernel_size_y +
-                                                           kernel_h) *
-                                                              kernel_size_x +
-                                                          kernel_w;
-                                    int input_bias_idx = zero_point_len_i == 1 ? 0 : input_c;
-                                    result +=
-                                        input_data[input_position] * weight_data[weight_position] -
-                                        static_cast<Tacc>(input_data[input_position] * zero_point_handle_w[weight_bias_idx]) -
-                                        static_cast<Tacc>(zero_point_handle_i[input_bias_idx] * weight_data[weight_position]) +
-                                        static_cast<Tacc>(zero_point_handle_i[input_bias_idx] *
-                                                          zero_point_handle_w[weight_bias_idx]);
-                                }
-                            }
-                        }
-
-                        if (bias_data) {
-                            result += bias_data[output_c];
+    for (int index = 0; index < number * output_channel; ++index) {
+        int n              = index / output_channel;
+        int output_c       = index % output_channel;
+        int g              = output_c / output_channels_per_group;
+        int output_c_start = g * output_channels_per_group;
+        int input_c_start  = g * input_channels_per_group;
+        int input_c_end    = (g + 1) * input_channels_per_group;
+        int weights_start =
+            g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y;
+        int scale_idx = weight_scale_len == 1 ? 0 : output_c;
+        int weight_bias_idx = zero_point_len_w == 1 ? 0 : output_c;
+        int output_bias_idx = zero_point_len_o == 1 ? 0 : output_c;
+        for (int h = 0; h < output_height; ++h) {
+            int input_h_start = h * stride_y - pad_y;
+            for (int w = 0; w < output_width; ++w) {
+                int input_w_start   = w * stride_x - pad_x;
+                Tacc result         = static_cast<Tacc>(0.0f);
+                int output_position = ((n * output_channel + output_c) * output_height + h) * output_width + w;
+                for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
+                    int input_h = input_h_start + kernel_h * dilation;
+                    if (input_h < 0 || input_h >= input_height) {
+                        continue;
+                    }
+                    for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
+                        int input_w = input_w_start + kernel_w * dilation;
+                        if (input_w < 0 || input_w >= input_width) {
+                            continue;
                         }
-                        if (sizeof(Tin) > 1) {  // float
-                            FloatActivate(result, activation_type);
-                            output_data[output_position] = result;
-                        } else {
-                            float val = result * weight_scale[scale_idx];
-                            if (fusion_type == FusionType_Conv_Add_Activation) {
-                                val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
-                                       add_bias_i[output_bias_idx] * add_scale[output_c];
-                            }
-                            if (activation_type == ActivationType_ReLU) {
-                                val = std::max(0.0f, val);
-                            } else if (activation_type == ActivationType_ReLU6) {
-                                int relu6_max_idx = relu6_max_len == 1 ? 0:output_c;
-                                int8_t res = std::min(float2int8(val), relu6_max[relu6_max_idx]);
-                                res = std::max((int8_t)0, res);
-                                output_data[output_position] = res;
-                                continue;
-                            }
-                            if (fusion_type == FusionType_Conv_Activation_Add) {
-                                val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
-                                       add_bias_i[output_bias_idx] * add_scale[output_c];
-                            }
-                            val += static_cast<Tin>(zero_point_handle_o[output_bias_idx]);
-                            output_data[output_position] = float2int8(val);
+                        for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
+                            int input_position =
+                                ((n * input_channel + input_c) * input_height + input_h) * input_width +
+                                input_w;
+                            int weight_position = weights_start +
+                                                  (((output_c - output_c_start) * input_channels_per_group +
+                                                    input_c - input_c_start) *
+                                                       kernel_size_y +
+                                                   kernel_h) *
+                                                      kernel_size_x +
+                                                  kernel_w;
+                            int input_bias_idx = zero_point_len_i == 1 ? 0 : input_c;
+                            result +=
+                                input_data[input_position] * weight_data[weight_position] -
+                                static_cast<Tacc>(input_data[input_position] * zero_point_handle_w[weight_bias_idx]) -
+                                static_cast<Tacc>(zero_point_handle_i[input_bias_idx] * weight_data[weight_position]) +
+                                static_cast<Tacc>(zero_point_handle_i[input_bias_idx] *
+                                                  zero_point_handle_w[weight_bias_idx]);
                         }
                     }
                 }
+
+                if (bias_data) {
+                    result += bias_data[output_c];
+                }
+                if (sizeof(Tin) > 1) {  // float
+                    FloatActivate(result, activation_type);
+                    output_data[output_position] = result;
+                } else {
+                    float val = result * weight_scale[scale_idx];
+                    if (fusion_type == FusionType_Conv_Add_Activation) {
+                        val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
+                               add_bias_i[output_bias_idx] * add_scale[output_c];
+                    }
+                    if (activation_type == ActivationType_ReLU) {
+                        val = std::max(0.0f, val);
+                    } else if (activation_type == ActivationType_ReLU6) {
+                        int relu6_max_idx = relu6_max_len == 1 ? 0:output_c;
+                        int8_t res = std::min(float2int8(val), relu6_max[relu6_max_idx]);
+                        res = std::max((int8_t)0, res);
+                        output_data[output_position] = res;
+                        continue;
+                    }
+                    if (fusion_type == FusionType_Conv_Activation_Add) {
+                        val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c] -
+                               add_bias_i[output_bias_idx] * add_scale[output_c];
+                    }
+                    val += static_cast<Tin>(zero_point_handle_o[output_bias_idx]);
+                    output_data[output_position] = float2int8(val);
+                }
             }
         }
     }
@@ -832,83 +830,81 @@ void NaiveConv3D(void *input_ptr, void *output_ptr, void *weight_ptr, void *bias
     int input_channels_per_group  = input_channel / group;
 
     OMP_PARALLEL_FOR_
-    for (int n = 0; n < number; ++n) {
-        for (int g = 0; g < group; ++g) {
-            int output_c_start = g * output_channels_per_group;
-            int output_c_end   = (g + 1) * output_channels_per_group;
-            int input_c_start  = g * input_channels_per_group;
-            int input_c_end    = (g + 1) * input_channels_per_group;
-            int weights_start =
-                g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y * kernel_size_d;
-            for (int output_c = output_c_start; output_c < output_c_end; ++output_c) {
-                for (int d = 0; d < output_depth; ++d) {
-                    int input_d_start = d * stride_d - pad_d;
-                    for (int h = 0; h < output_height; ++h) {
-                        int input_h_start = h * stride_y - pad_y;
-                        for (int w = 0; w < output_width; ++w) {
-                            int input_w_start = w * stride_x - pad_x;
-                            Tacc result       = static_cast<Tacc>(0.0f);
-                            for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
-                                for (int kernel_d = 0; kernel_d < kernel_size_d; ++kernel_d) {
-                                    int input_d = input_d_start + kernel_d * dilation_d;
-                                    if (input_d < 0 || input_d >= input_depth) {
+    for (int index = 0; index < number * output_channel; ++index) {
+        int n              = index / output_channel;
+        int output_c       = index % output_channel;
+        int g              = output_c / output_channels_per_group;
+        int output_c_start = g * output_channels_per_group;
+        int input_c_start  = g * input_channels_per_group;
+        int input_c_end    = (g + 1) * input_channels_per_group;
+        int weights_start =
+            g * output_channels_per_group * input_channels_per_group * kernel_size_x * kernel_size_y * kernel_size_d;
+        for (int d = 0; d < output_depth; ++d) {
+            int input_d_start = d * stride_d - pad_d;
+            for (int h = 0; h < output_height; ++h) {
+                int input_h_start = h * stride_y - pad_y;
+                for (int w = 0; w < output_width; ++w) {
+                    int input_w_start = w * stride_x - pad_x;
+                    Tacc result       = static_cast<Tacc>(0.0f);
+                    for (int input_c = input_c_start; input_c < input_c_end; ++input_c) {
+                        for (int kernel_d = 0; kernel_d < kernel_size_d; ++kernel_d) {
+                            int input_d = input_d_start + kernel_d * dilation_d;
+                            if (input_d < 0 || input_d >= input_depth) {
+                                continue;
+                            }
+                            for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
+                                int input_h = input_h_start + kernel_h * dilation_y;
+                                if (input_h < 0 || input_h >= input_height) {
+                                    continue;
+                                }
+                                for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
+                                    int input_w = input_w_start + kernel_w * dilation_x;
+                                    if (input_w < 0 || input_w >= input_width) {
                                         continue;
                                     }
-                                    for (int kernel_h = 0; kernel_h < kernel_size_y; ++kernel_h) {
-                                        int input_h = input_h_start + kernel_h * dilation_y;
-                                        if (input_h < 0 || input_h >= input_height) {
-                                            continue;
-                                        }
-                                        for (int kernel_w = 0; kernel_w < kernel_size_x; ++kernel_w) {
-                                            int input_w = input_w_start + kernel_w * dilation_x;
-                                            if (input_w < 0 || input_w >= input_width) {
-                                                continue;
-                                            }
-                                            int input_position =
-                                                (((n * input_channel + input_c) * input_depth + input_d) *
-                                                     input_height +
-                                                 input_h) *
-                                                    input_width +
-                                                input_w;
-                                            int weight_position =
-                                                weights_start +
-                                                ((((output_c - output_c_start) * input_channels_per_group + input_c -
-                                                   input_c_start) *
-                                                      kernel_size_d +
-                                                  kernel_d) *
-                                                     kernel_size_y +
-                                                 kernel_h) *
-                                                    kernel_size_x +
-                                                kernel_w;
-                                            result += input_data[input_position] * weight_data[weight_position];
-                                        }
-                                    }
+                                    int input_position =
+                                        (((n * input_channel + input_c) * input_depth + input_d) *
+                                             input_height +
+                                         input_h) *
+                                            input_width +
+                                        input_w;
+                                    int weight_position =
+                                        weights_start +
+                                        ((((output_c - output_c_start) * input_channels_per_group + input_c -
+                                           input_c_start) *
+                                              kernel_size_d +
+                                          kernel_d) *
+                                             kernel_size_y +
+                                         kernel_h) *
+                                            kernel_size_x +
+                                        kernel_w;
+                                    result += input_data[input_position] * weight_data[weight_position];
                                 }
                             }
+                        }
+                    }
 
-                            int output_position =
-                                (((n * output_channel + output_c) * output_depth + d) * output_height + h) * output_width + w;
-                            if (bias_data) {
-                                result += bias_data[output_c];
-                            }
-                            if (sizeof(Tin) > 1) {  // float
-                                FloatActivate(result, activation_type);
-                                output_data[output_position] = result;
-                            } else {
-                                int scaleidx = scale_len == 1 ? 0 : output_c;
-                                float val    = result * scale[scaleidx];
-                                if (fusion_type == FusionType_Conv_Add_Activation) {
-                                    val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
-                                }
-                                if (activation_type == ActivationType_ReLU) {
-                                    val = std::max(0.0f, val);
-                                }
-                                if (fusion_type == FusionType_Conv_Activation_Add) {
-                                    val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
-                                }
-                                output_data[output_position] = float2int8(val);
-                            }
+                    int output_position =
+                        (((n * output_channel + output_c) * output_depth + d) * output_height + h) * output_width + w;
+                    if (bias_data) {
+                        result += bias_data[output_c];
+                    }
+                    if (sizeof(Tin) > 1) {  // float
+                        FloatActivate(result, activation_type);
+                        output_data[output_position] = result;
+                    } else {
+                        int scaleidx = scale_len == 1 ? 0 : output_c;
+                        float val    = result * scale[scaleidx];
+                        if (fusion_type == FusionType_Conv_Add_Activation) {
+                            val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
+                        }
+                        if (activation_type == ActivationType_ReLU) {
+                            val = std::max(0.0f, val);
                         }
+                        if (fusion_type == FusionType_Conv_Activation_Add) {
+                            val += static_cast<Tin *>(add_input)[output_position] * add_scale[output_c];
+                        }
+                        output_data[output_position] = float2int8(val);
                     }
                 }
             }
@@ -0,0 +1,241 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tnn/utils/numa_utils.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+#include "tnn/core/common.h"
+#include "tnn/utils/cpu_utils.h"
+
+#if defined(__linux__) && !defined(__ANDROID__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#if defined(SYS_set_mempolicy) && defined(SYS_get_mempolicy) && defined(SYS_mbind)
+#define TNN_NUMA_SYSCALL 1
+#endif
+#endif
+
+namespace TNN_NS {
+
+#ifdef TNN_NUMA_SYSCALL
+// from include/uapi/linux/mempolicy.h
+static const int TNN_MPOL_DEFAULT     = 0;
+static const int TNN_MPOL_PREFERRED   = 1;
+static const int TNN_MPOL_INTERLEAVE  = 3;
+static const unsigned TNN_MPOL_MF_MOVE = 1 << 1;
+
+static const unsigned long TNN_NUMA_MAX_NODES = 1024;
+static const unsigned long TNN_NUMA_MASK_BITS = 8 * sizeof(unsigned long);
+// the cpu set size of CpuUtils::SetCpuAffinity
+static const unsigned long TNN_NUMA_CPU_SETSIZE = 1024;
+// maxnode of all mempolicy syscalls, the kernel reads and writes maxnode - 1 bits of the mask
+static const unsigned long TNN_NUMA_MAXNODE = TNN_NUMA_MAX_NODES + 1;
+
+// "0-3,8-11" -> {0, 1, 2, 3, 8, 9, 10, 11}
+static std::vector<int> ReadSysfsList(const std::string& path) {
+    std::vector<int> values;
+    FILE* fp = fopen(path.c_str(), "r");
+    if (!fp) {
+        return values;
+    }
+    char buf[1024] = {0};
+    if (fgets(buf, sizeof(buf), fp)) {
+        const char* p = buf;
+        while (*p && *p != '\n') {
+            char* end = nullptr;
+            long first = strtol(p, &end, 10);
+            if (end == p) {
+                break;
+            }
+            long last = first;
+            p         = end;
+            if (*p == '-') {
+                last = strtol(p + 1, &end, 10);
+                p    = end;
+            }
+            for (long v = first; v <= last; v++) {
+                values.push_back(static_cast<int>(v));
+            }
+            if (*p == ',') {
+                p++;
+            }
+        }
+    }
+    fclose(fp);
+    return values;
+}
+
+static std::vector<unsigned long> NodeMask(const std::vector<int>& nodes) {
+    std::vector<unsigned long> mask(TNN_NUMA_MAX_NODES / TNN_NUMA_MASK_BITS, 0);
+    for (auto node : nodes) {
+        if (node >= 0 && node < (int)TNN_NUMA_MAX_NODES) {
+            mask[node / TNN_NUMA_MASK_BITS] |= 1UL << (node % TNN_NUMA_MASK_BITS);
+        }
+    }
+    return mask;
+}
+
+static Status SetMemPolicy(int mode, const std::vector<unsigned long>& mask) {
+    long ret = syscall(SYS_set_mempolicy, mode, mask.empty() ? nullptr : mask.data(),
+                       mask.empty() ? 0 : TNN_NUMA_MAXNODE);
+    if (ret != 0) {
+        LOGE("NumaUtils: set_mempolicy mode %d failed\n", mode);
+        return Status(TNNERR_COMMON_ERROR, "set_mempolicy failed");
+    }
+    return TNN_OK;
+}
+#endif
+
+int NumaUtils::GetNodeCount() {
+#ifdef TNN_NUMA_SYSCALL
+    static int node_count = [] {
+        auto nodes = ReadSysfsList("/sys/devices/system/node/online");
+        return nodes.empty() ? 1 : nodes.back() + 1;
+    }();
+    return node_count;
+#else
+    return 1;
+#endif
+}
+
+Status NumaUtils::GetNodeCpus(int node, std::vector<int>& cpu_list) {
+    if (node < 0 || node >= GetNodeCount()) {
+        return Status(TNNERR_PARAM_ERR, "invalid numa node");
+    }
+#ifdef TNN_NUMA_SYSCALL
+    cpu_list = ReadSysfsList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+#else
+    cpu_list.clear();
+#endif
+    if (cpu_list.empty()) {
+        return Status(TNNERR_COMMON_ERROR, "numa node has no cpus");
+    }
+    return TNN_OK;
+}
+
+Status NumaUtils::SetPreferredNode(int node) {
+    if (node < 0 || node >= GetNodeCount()) {
+        return Status(TNNERR_PARAM_ERR, "invalid numa node");
+    }
+#ifdef TNN_NUMA_SYSCALL
+    return SetMemPolicy(TNN_MPOL_PREFERRED, NodeMask({node}));
+#else
+    return TNN_OK;
+#endif
+}
+
+Status NumaUtils::SetInterleave() {
+#ifdef TNN_NUMA_SYSCALL
+    return SetMemPolicy(TNN_MPOL_INTERLEAVE, NodeMask(ReadSysfsList("/sys/devices/system/node/online")));
+#else
+    return TNN_OK;
+#endif
+}
+
+Status NumaUtils::SetDefault() {
+#ifdef TNN_NUMA_SYSCALL
+    return SetMemPolicy(TNN_MPOL_DEFAULT, {});
+#else
+    return TNN_OK;
+#endif
+}
+
+Status NumaUtils::BindThread(int node) {
+    std::vector<int> cpu_list;
+    RETURN_ON_NEQ(GetNodeCpus(node, cpu_list), TNN_OK);
+    RETURN_ON_NEQ(CpuUtils::SetCpuAffinity(cpu_list), TNN_OK);
+    return SetPreferredNode(node);
+}
+
+Status NumaUtils::BindMemory(void* ptr, size_t size, int node) {
+    if (node < 0 || node >= GetNodeCount()) {
+        return Status(TNNERR_PARAM_ERR, "invalid numa node");
+    }
+#ifdef TNN_NUMA_SYSCALL
+    // only whole pages can be bound, partial pages at both ends may be shared with other buffers
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    size_t begin           = (reinterpret_cast<size_t>(ptr) + page_size - 1) / page_size * page_size;
+    size_t end             = (reinterpret_cast<size_t>(ptr) + size) / page_size * page_size;
+    if (end <= begin) {
+        return TNN_OK;
+    }
+    auto mask = NodeMask({node});
+    long ret  = syscall(SYS_mbind, reinterpret_cast<void*>(begin), end - begin, TNN_MPOL_PREFERRED, mask.data(),
+                       TNN_NUMA_MAXNODE, TNN_MPOL_MF_MOVE);
+    if (ret != 0) {
+        LOGE("NumaUtils: mbind %zu bytes to node %d failed\n", end - begin, node);
+        return Status(TNNERR_COMMON_ERROR, "mbind failed");
+    }
+#endif
+    return TNN_OK;
+}
+
+NumaMemoryGuard::NumaMemoryGuard(int node) {
+    if (node < 0) {
+        return;
+    }
+#ifdef TNN_NUMA_SYSCALL
+    old_mask_.resize(TNN_NUMA_MAX_NODES / TNN_NUMA_MASK_BITS, 0);
+    if (syscall(SYS_get_mempolicy, &old_mode_, old_mask_.data(), TNN_NUMA_MAXNODE, nullptr, 0) != 0) {
+        LOGE("NumaMemoryGuard: get_mempolicy failed, memory of node %d is not bound\n", node);
+        return;
+    }
+#endif
+    bound_  = NumaUtils::SetPreferredNode(node) == TNN_OK;
+    thread_ = std::this_thread::get_id();
+}
+
+NumaMemoryGuard::~NumaMemoryGuard() {
+    if (!bound_ || thread_ != std::this_thread::get_id()) {
+        return;
+    }
+#ifdef TNN_NUMA_SYSCALL
+    SetMemPolicy(old_mode_, old_mode_ == TNN_MPOL_DEFAULT ? std::vector<unsigned long>() : old_mask_);
+#endif
+}
+
+NumaThreadGuard::NumaThreadGuard(int node) : memory_guard_(node) {
+    if (node < 0) {
+        return;
+    }
+#ifdef TNN_NUMA_SYSCALL
+    old_cpus_.resize(TNN_NUMA_CPU_SETSIZE / TNN_NUMA_MASK_BITS, 0);
+    if (syscall(SYS_sched_getaffinity, 0, old_cpus_.size() * sizeof(unsigned long), old_cpus_.data()) < 0) {
+        LOGE("NumaThreadGuard: sched_getaffinity failed, thread is not bound to node %d\n", node);
+        return;
+    }
+    std::vector<int> cpu_list;
+    if (NumaUtils::GetNodeCpus(node, cpu_list) != TNN_OK || CpuUtils::SetCpuAffinity(cpu_list) != TNN_OK) {
+        LOGE("NumaThreadGuard: thread is not bound to the cpus of node %d\n", node);
+        return;
+    }
+    bound_  = true;
+    thread_ = std::this_thread::get_id();
+#endif
+}
+
+NumaThreadGuard::~NumaThreadGuard() {
+    if (!bound_ || thread_ != std::this_thread::get_id()) {
+        return;
+    }
+#ifdef TNN_NUMA_SYSCALL
+    syscall(SYS_sched_setaffinity, 0, old_cpus_.size() * sizeof(unsigned long), old_cpus_.data());
+#endif
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,84 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_SOURCE_TNN_UTILS_NUMA_UTILS_H_
+#define TNN_SOURCE_TNN_UTILS_NUMA_UTILS_H_
+
+#include <thread>
+#include <vector>
+
+#include "tnn/core/macro.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+// numa memory placement through the linux mempolicy syscalls, no libnuma needed.
+// on other platforms there is a single node and the calls do nothing.
+class NumaUtils {
+public:
+    // @brief number of online numa nodes, at least 1
+    static int GetNodeCount();
+
+    // @brief cpuids of a numa node
+    static Status GetNodeCpus(int node, std::vector<int>& cpu_list);
+
+    // @brief pages first touched by the calling thread are allocated on node if possible
+    static Status SetPreferredNode(int node);
+
+    // @brief pages first touched by the calling thread are interleaved over all nodes
+    static Status SetInterleave();
+
+    // @brief restore the default local allocation of the calling thread
+    static Status SetDefault();
+
+    // @brief run the calling thread on the cpus of node and allocate its memory there
+    static Status BindThread(int node);
+
+    // @brief move the whole pages of [ptr, ptr + size) to node
+    static Status BindMemory(void* ptr, size_t size, int node);
+};
+
+// binds the memory allocated by the calling thread to a node while in scope and
+// restores the previous policy of the thread on destruction, does nothing if node < 0.
+// a guard destroyed on another thread than the one that created it restores nothing.
+class NumaMemoryGuard {
+public:
+    explicit NumaMemoryGuard(int node);
+    ~NumaMemoryGuard();
+
+private:
+    bool bound_ = false;
+    int old_mode_ = 0;
+    std::vector<unsigned long> old_mask_;
+    std::thread::id thread_;
+};
+
+// runs the calling thread on the cpus of a node and allocates its memory there while in scope,
+// the previous affinity and policy of the thread are restored on destruction like NumaMemoryGuard
+class NumaThreadGuard {
+public:
+    explicit NumaThreadGuard(int node);
+    ~NumaThreadGuard();
+
+private:
+    NumaMemoryGuard memory_guard_;
+    bool bound_ = false;
+    std::vector<unsigned long> old_cpus_;
+    std::thread::id thread_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_SOURCE_TNN_UTILS_NUMA_UTILS_H_
@@ -0,0 +1,511 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// TNNBenchmark runs a model with one or more concurrent instances and reports latency percentiles of
+// each phase (init, create instance, reshape, input convert, forward, output convert) and the
+// aggregate throughput. Common flags are the same as TNNTest, see test/flags.h.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "test/flags.h"
+#include "test/test.h"
+#include "tnn/core/instance.h"
+#include "tnn/core/macro.h"
+#include "tnn/core/tnn.h"
+#include "tnn/utils/cpu_utils.h"
+
+namespace TNN_NS {
+
+namespace test {
+
+    typedef std::chrono::steady_clock BenchClock;
+
+    static double ElapsedMs(const BenchClock::time_point& start, const BenchClock::time_point& stop) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(stop - start).count() / 1000000.0;
+    }
+
+    // keeps every sample, percentiles use the nearest rank
+    class LatencyStat {
+    public:
+        void Add(double ms) {
+            samples_.push_back(ms);
+            sorted_ = false;
+        }
+
+        void Merge(const LatencyStat& other) {
+            samples_.insert(samples_.end(), other.samples_.begin(), other.samples_.end());
+            sorted_ = false;
+        }
+
+        size_t Count() const {
+            return samples_.size();
+        }
+
+        double Percentile(double p) {
+            if (samples_.empty()) {
+                return 0;
+            }
+            Sort();
+            size_t rank = static_cast<size_t>(std::ceil(p / 100.0 * samples_.size()));
+            rank        = std::min(std::max(rank, (size_t)1), samples_.size());
+            return samples_[rank - 1];
+        }
+
+        double Min() {
+            return Percentile(0);
+        }
+
+        double Max() {
+            return Percentile(100);
+        }
+
+        double Avg() const {
+            double sum = 0;
+            for (auto v : samples_) {
+                sum += v;
+            }
+            return samples_.empty() ? 0 : sum / samples_.size();
+        }
+
+        double Stddev() const {
+            if (samples_.size() < 2) {
+                return 0;
+            }
+            double avg = Avg(), sum = 0;
+            for (auto v : samples_) {
+                sum += (v - avg) * (v - avg);
+            }
+            return std::sqrt(sum / (samples_.size() - 1));
+        }
+
+        // equal width buckets between min and max, each entry is (upper bound, count)
+        std::vector<std::pair<double, int>> Histogram(int bucket_num) {
+            std::vector<std::pair<double, int>> buckets;
+            if (samples_.empty()) {
+                return buckets;
+            }
+            double min = Min(), max = Max();
+            double width = (max - min) / bucket_num;
+            for (int i = 0; i < bucket_num; ++i) {
+                buckets.push_back(std::make_pair(min + width * (i + 1), 0));
+            }
+            for (auto v : samples_) {
+                int index = width > 0 ? static_cast<int>((v - min) / width) : 0;
+                buckets[std::min(index, bucket_num - 1)].second++;
+            }
+            return buckets;
+        }
+
+    private:
+        void Sort() {
+            if (!sorted_) {
+                std::sort(samples_.begin(), samples_.end());
+                sorted_ = true;
+            }
+        }
+
+        std::vector<double> samples_;
+        bool sorted_ = false;
+    };
+
+    struct InstanceBench {
+        std::shared_ptr<Instance> instance;
+        std::vector<int> cpus;
+        double create_ms  = 0;
+        double reshape_ms = 0;
+        double wall_ms    = 0;
+        LatencyStat convert_in;
+        LatencyStat forward;
+        LatencyStat convert_out;
+        LatencyStat total;
+        Status status   = TNN_OK;
+        int numa_node   = -1;
+        bool interleave = false;
+    };
+
+    // one benchmark pass over all instances with a numa placement
+    struct BenchRun {
+        std::string placement;
+        std::vector<InstanceBench> benches;
+        LatencyStat convert_in;
+        LatencyStat forward;
+        LatencyStat convert_out;
+        LatencyStat total;
+        double wall_ms    = 0;
+        double throughput = 0;
+    };
+
+    // all instances finish warm up before the timed loops start together
+    class StartGate {
+    public:
+        explicit StartGate(int count) : waiting_(count) {}
+
+        void ArriveAndWait() {
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (--waiting_ == 0) {
+                start_ = BenchClock::now();
+                cond_.notify_all();
+            } else {
+                cond_.wait(lock, [this] { return waiting_ == 0; });
+            }
+        }
+
+        BenchClock::time_point StartTime() {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return start_;
+        }
+
+    private:
+        std::mutex mutex_;
+        std::condition_variable cond_;
+        int waiting_;
+        BenchClock::time_point start_;
+    };
+
+    static std::vector<std::vector<int>> ParsePinList(const std::string& message) {
+        std::vector<std::vector<int>> pin_list;
+        std::stringstream instance_stream(message);
+        std::string cpu_list;
+        while (std::getline(instance_stream, cpu_list, ';')) {
+            std::vector<int> cpus;
+            std::stringstream cpu_stream(cpu_list);
+            std::string cpu;
+            while (std::getline(cpu_stream, cpu, ',')) {
+                if (!cpu.empty()) {
+                    cpus.push_back(atoi(cpu.c_str()));
+                }
+            }
+            pin_list.push_back(cpus);
+        }
+        return pin_list;
+    }
+
+    static void RunInstance(InstanceBench& bench, StartGate& gate) {
+        if (!bench.cpus.empty() && CpuUtils::SetCpuAffinity(bench.cpus) != TNN_OK) {
+            LOGE("set cpu affinity failed, run without pinning\n");
+        }
+        if (bench.interleave && CpuUtils::SetNumaInterleave(true) != TNN_OK) {
+            LOGE("set numa interleave failed, run with local allocation\n");
+        }
+
+        auto& instance = bench.instance;
+        BlobMap input_blob_map;
+        BlobMap output_blob_map;
+        void* command_queue = nullptr;
+        instance->GetAllInputBlobs(input_blob_map);
+        instance->GetAllOutputBlobs(output_blob_map);
+        instance->GetCommandQueue(&command_queue);
+
+        MatMap input_mat_map = CreateBlobMatMap(input_blob_map, FLAGS_it);
+        InitInputMatMap(input_mat_map);
+        auto input_converters_map = CreateBlobConverterMap(input_blob_map);
+        auto input_params_map     = CreateConvertParamMap(input_mat_map, true);
+
+        MatMap output_mat_map       = CreateBlobMatMap(output_blob_map, 0);
+        auto output_converters_map  = CreateBlobConverterMap(output_blob_map);
+        auto output_params_map      = CreateConvertParamMap(output_mat_map, false);
+
+        auto run_once = [&](bool record) -> Status {
+            Status status = TNN_OK;
+            auto t0       = BenchClock::now();
+            for (auto element : input_converters_map) {
+                auto name = element.first;
+                status    = element.second->ConvertFromMatAsync(*input_mat_map[name], input_params_map[name],
+                                                             command_queue);
+                RETURN_ON_NEQ(status, TNN_OK);
+            }
+            auto t1 = BenchClock::now();
+            status  = instance->Forward();
+            RETURN_ON_NEQ(status, TNN_OK);
+            auto t2 = BenchClock::now();
+            for (auto element : output_converters_map) {
+                auto name = element.first;
+                status = element.second->ConvertToMat(*output_mat_map[name], output_params_map[name], command_queue);
+                RETURN_ON_NEQ(status, TNN_OK);
+            }
+            auto t3 = BenchClock::now();
+
+            if (record) {
+                bench.convert_in.Add(ElapsedMs(t0, t1));
+                bench.forward.Add(ElapsedMs(t1, t2));
+                bench.convert_out.Add(ElapsedMs(t2, t3));
+                bench.total.Add(ElapsedMs(t0, t3));
+            }
+            return status;
+        };
+
+        Status ret = TNN_OK;
+        for (int i = 0; i < FLAGS_wc && ret == TNN_OK; ++i) {
+            ret = run_once(false);
+        }
+        // arrive even on failure, otherwise the other instances never start
+        gate.ArriveAndWait();
+        for (int i = 0; i < FLAGS_ic && ret == TNN_OK; ++i) {
+            ret = run_once(true);
+        }
+        bench.wall_ms = ElapsedMs(gate.StartTime(), BenchClock::now());
+        bench.status  = ret;
+
+        FreeMatMapMemory(input_mat_map);
+        FreeMatMapMemory(output_mat_map);
+    }
+
+    static void PrintStat(const std::string& name, LatencyStat& stat) {
+        printf("%-28s count = %-6d avg = %9.3f ms  p50 = %9.3f  p90 = %9.3f  p99 = %9.3f  p99.9 = %9.3f  max = %9.3f\n",
+               name.c_str(), (int)stat.Count(), stat.Avg(), stat.Percentile(50), stat.Percentile(90),
+               stat.Percentile(99), stat.Percentile(99.9), stat.Max());
+    }
+
+    static std::string EscapeJson(const std::string& str) {
+        std::string result;
+        for (auto c : str) {
+            if (c == '"' || c == '\\') {
+                result.push_back('\\');
+                result.push_back(c);
+            } else if ((unsigned char)c < 0x20) {
+                char code[8];
+                snprintf(code, sizeof(code), "\\u%04x", (unsigned char)c);
+                result += code;
+            } else {
+                result.push_back(c);
+            }
+        }
+        return result;
+    }
+
+    static void WriteStatJson(std::ostream& out, LatencyStat& stat) {
+        out << "{\"count\": " << stat.Count() << ", \"min\": " << stat.Min() << ", \"max\": " << stat.Max()
+            << ", \"avg\": " << stat.Avg() << ", \"stddev\": " << stat.Stddev() << ", \"p50\": " << stat.Percentile(50)
+            << ", \"p90\": " << stat.Percentile(90) << ", \"p99\": " << stat.Percentile(99)
+            << ", \"p99_9\": " << stat.Percentile(99.9) << ", \"histogram\": [";
+        auto buckets = stat.Histogram(16);
+        for (size_t i = 0; i < buckets.size(); ++i) {
+            out << (i ? ", " : "") << "{\"le\": " << buckets[i].first << ", \"count\": " << buckets[i].second << "}";
+        }
+        out << "]}";
+    }
+
+    static void WritePhasesJson(std::ostream& out, LatencyStat& convert_in, LatencyStat& forward,
+                                LatencyStat& convert_out, LatencyStat& total) {
+        out << "{\"convert_in\": ";
+        WriteStatJson(out, convert_in);
+        out << ", \"forward\": ";
+        WriteStatJson(out, forward);
+        out << ", \"convert_out\": ";
+        WriteStatJson(out, convert_out);
+        out << ", \"total\": ";
+        WriteStatJson(out, total);
+        out << "}";
+    }
+
+    // placement "local" binds instance i and its calling thread to numa node i % nodes with replicated weights,
+    // "interleave" spreads the memory of all instances over the nodes, "" keeps the default
+    static Status RunInstances(TNN& net, NetworkConfig network_config, const InputShapesMap& input_shape,
+                               const std::string& placement, BenchRun& run) {
+        auto pin_list  = ParsePinList(FLAGS_pl);
+        int numa_nodes = CpuUtils::GetNumaNodeCount();
+
+        run.placement = placement;
+        run.benches.resize(FLAGS_ni);
+        Status ret = TNN_OK;
+        for (int i = 0; i < FLAGS_ni; ++i) {
+            auto& bench      = run.benches[i];
+            bench.interleave = placement == "interleave";
+            if (placement == "local") {
+                bench.numa_node                       = i % numa_nodes;
+                network_config.numa_node              = bench.numa_node;
+                network_config.numa_replicate_weights = true;
+                // the instance binds its omp workers, the calling thread is pinned to the node here
+                if (CpuUtils::GetNumaNodeCpus(bench.numa_node, bench.cpus) != TNN_OK) {
+                    LOGE("get the cpus of numa node %d failed, run its caller without pinning\n", bench.numa_node);
+                    bench.cpus.clear();
+                }
+            } else if (!pin_list.empty()) {
+                bench.cpus = pin_list[i % pin_list.size()];
+            }
+
+            if (bench.interleave) {
+                CpuUtils::SetNumaInterleave(true);
+            }
+            auto t0         = BenchClock::now();
+            bench.instance  = net.CreateInst(network_config, ret, input_shape);
+            bench.create_ms = ElapsedMs(t0, BenchClock::now());
+            if (ret == TNN_OK) {
+                bench.instance->SetCpuNumThreads(std::max(FLAGS_th, 1));
+
+                // reshape to the current input shapes, the cost of a shape change without reallocation
+                InputShapesMap reshape_shapes = input_shape;
+                if (reshape_shapes.empty()) {
+                    BlobMap input_blob_map;
+                    bench.instance->GetAllInputBlobs(input_blob_map);
+                    for (auto iter : input_blob_map) {
+                        reshape_shapes[iter.first] = iter.second->GetBlobDesc().dims;
+                    }
+                }
+                t0               = BenchClock::now();
+                ret              = bench.instance->Reshape(reshape_shapes);
+                bench.reshape_ms = ElapsedMs(t0, BenchClock::now());
+            }
+            if (bench.interleave) {
+                CpuUtils::SetNumaInterleave(false);
+            }
+            RETURN_ON_NEQ(ret, TNN_OK);
+        }
+
+        StartGate gate(FLAGS_ni);
+        std::vector<std::thread> threads;
+        for (int i = 0; i < FLAGS_ni; ++i) {
+            threads.push_back(std::thread(RunInstance, std::ref(run.benches[i]), std::ref(gate)));
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+
+        for (auto& bench : run.benches) {
+            bench.instance.reset();
+            RETURN_ON_NEQ(bench.status, TNN_OK);
+            run.convert_in.Merge(bench.convert_in);
+            run.forward.Merge(bench.forward);
+            run.convert_out.Merge(bench.convert_out);
+            run.total.Merge(bench.total);
+            run.wall_ms = std::max(run.wall_ms, bench.wall_ms);
+        }
+        run.throughput = run.wall_ms > 0 ? run.total.Count() * 1000.0 / run.wall_ms : 0;
+        return TNN_OK;
+    }
+
+    static void PrintRun(BenchRun& run, const std::string& model_name, double init_ms) {
+        printf("%s - %s, instances = %d, threads = %d", model_name.c_str(), FLAGS_dt.c_str(), FLAGS_ni, FLAGS_th);
+        if (!run.placement.empty()) {
+            printf(", numa = %s", run.placement.c_str());
+        }
+        printf("\n%-28s %9.3f ms\n", "init", init_ms);
+        for (int i = 0; i < FLAGS_ni; ++i) {
+            printf("instance %-3d create = %9.3f ms  reshape = %9.3f ms\n", i, run.benches[i].create_ms,
+                   run.benches[i].reshape_ms);
+        }
+        PrintStat("convert_in", run.convert_in);
+        PrintStat("forward", run.forward);
+        PrintStat("convert_out", run.convert_out);
+        PrintStat("total", run.total);
+        printf("%-28s %9.3f inferences/s\n", "throughput", run.throughput);
+    }
+
+    static void WriteRunJson(std::ostream& out, BenchRun& run, const std::string& model_name, double init_ms) {
+        out << "{\"model\": \"" << EscapeJson(model_name) << "\", \"device\": \"" << EscapeJson(FLAGS_dt)
+            << "\", \"threads\": " << FLAGS_th << ", \"instance_num\": " << FLAGS_ni << ", \"iterations\": " << FLAGS_ic
+            << ", \"warm_up\": " << FLAGS_wc;
+        if (!run.placement.empty()) {
+            out << ", \"numa\": \"" << run.placement << "\"";
+        }
+        out << ", \"init_ms\": " << init_ms << ",\n \"instances\": [";
+        for (int i = 0; i < FLAGS_ni; ++i) {
+            auto& bench = run.benches[i];
+            out << (i ? ",\n  " : "\n  ") << "{\"id\": " << i << ", \"cpus\": [";
+            for (size_t c = 0; c < bench.cpus.size(); ++c) {
+                out << (c ? ", " : "") << bench.cpus[c];
+            }
+            out << "], \"numa_node\": " << bench.numa_node << ", \"create_ms\": " << bench.create_ms
+                << ", \"reshape_ms\": " << bench.reshape_ms << ", \"wall_ms\": " << bench.wall_ms << ", \"phases\": ";
+            WritePhasesJson(out, bench.convert_in, bench.forward, bench.convert_out, bench.total);
+            out << "}";
+        }
+        out << "],\n \"aggregate\": {\"wall_ms\": " << run.wall_ms << ", \"throughput\": " << run.throughput
+            << ", \"phases\": ";
+        WritePhasesJson(out, run.convert_in, run.forward, run.convert_out, run.total);
+        out << "}}";
+    }
+
+    static int RunBenchmark(int argc, char* argv[]) {
+        gflags::ParseCommandLineNonHelpFlags(&argc, &argv, true);
+        bool valid_numa = FLAGS_nm.empty() || FLAGS_nm == "local" || FLAGS_nm == "interleave" || FLAGS_nm == "compare";
+        if (FLAGS_h || FLAGS_mp.empty() || FLAGS_ic < 1 || FLAGS_ni < 1 || !valid_numa) {
+            ShowUsage();
+            printf("    -ni \"<number>\"        \t%s \n", instance_num_message);
+            printf("    -pl \"<pin list>\"      \t%s \n", pin_list_message);
+            printf("    -jp \"<json path>\"     \t%s \n", json_path_message);
+            printf("    -nm \"<numa mode>\"     \t%s \n", numa_mode_message);
+            return FLAGS_h ? 0 : -1;
+        }
+
+        ModelConfig model_config     = GetModelConfig();
+        NetworkConfig network_config = GetNetworkConfig();
+        InputShapesMap input_shape   = GetInputShapesMap();
+
+        srand(102);
+
+        TNN net;
+        auto t0        = BenchClock::now();
+        Status ret     = net.Init(model_config);
+        double init_ms = ElapsedMs(t0, BenchClock::now());
+        model_config.params.clear();
+        if (!CheckResult("init tnn", ret)) {
+            return ret;
+        }
+
+        std::vector<std::string> placements = {FLAGS_nm};
+        if (FLAGS_nm == "compare") {
+            placements = {"interleave", "local"};
+        }
+        std::string model_name = FLAGS_mp.substr(FLAGS_mp.find_last_of("/") + 1);
+        std::vector<BenchRun> runs(placements.size());
+        for (size_t i = 0; i < placements.size(); ++i) {
+            ret = RunInstances(net, network_config, input_shape, placements[i], runs[i]);
+            if (!CheckResult("benchmark", ret)) {
+                return ret;
+            }
+            PrintRun(runs[i], model_name, init_ms);
+        }
+        if (runs.size() == 2) {
+            printf("numa local vs interleave: %.3f vs %.3f inferences/s, speedup = %.3f\n", runs[1].throughput,
+                   runs[0].throughput, runs[0].throughput > 0 ? runs[1].throughput / runs[0].throughput : 0);
+        }
+
+        if (!FLAGS_jp.empty()) {
+            std::ofstream out(FLAGS_jp);
+            if (!out.is_open()) {
+                LOGE("open json file %s failed\n", FLAGS_jp.c_str());
+                return -1;
+            }
+            if (runs.size() == 1) {
+                WriteRunJson(out, runs[0], model_name, init_ms);
+            } else {
+                out << "{\"interleave\": ";
+                WriteRunJson(out, runs[0], model_name, init_ms);
+                out << ",\n\"local\": ";
+                WriteRunJson(out, runs[1], model_name, init_ms);
+                out << "}";
+            }
+            out << "\n";
+        }
+        return 0;
+    }
+
+}  // namespace test
+
+}  // namespace TNN_NS
+
+int main(int argc, char* argv[]) {
+    return TNN_NS::test::RunBenchmark(argc, argv);
+}
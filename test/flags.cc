@@ -54,8 +54,24 @@ DEFINE_string(is, "", input_shape_message);
 
 DEFINE_bool(et, false, enable_tune_message);
 
+DEFINE_string(cp, "", cache_path_message);
+
 DEFINE_string(sc, "", scale_message);
 
 DEFINE_string(bi, "", bias_message);
 
+DEFINE_int32(ni, 1, instance_num_message);
+
+DEFINE_string(pl, "", pin_list_message);
+
+DEFINE_string(jp, "", json_path_message);
+
+DEFINE_string(nm, "", numa_mode_message);
+
+DEFINE_string(perf_baseline, "", perf_baseline_message);
+
+DEFINE_double(perf_threshold, 0.2, perf_threshold_message);
+
+DEFINE_int32(shards, 1, shards_message);
+
 }  // namespace TNN_NS
@@ -61,10 +61,26 @@ static const char network_type_message[] = "network type: NAIVE, NPU, COREML, SN
 
 static const char enable_tune_message[] = "enable tune kernel(default false)";
 
+static const char cache_path_message[] = "cache path to store tuned kernel info";
+
 static const char scale_message[] = "input scale: s0,s1,s2,...)";
 
 static const char bias_message[] = "input bias: b0,b1,b2,...)";
 
+static const char instance_num_message[] = "instance number, instances forward concurrently in their own threads (default 1)";
+
+static const char pin_list_message[] = "cpu list of each instance thread, separated by ';' (eg: 0,1,2,3;4,5,6,7)";
+
+static const char json_path_message[] = "json file path to write the benchmark result";
+
+static const char numa_mode_message[] = "numa placement: local (instance i on node i % nodes), interleave, or compare to run both";
+
+static const char perf_baseline_message[] = "layer test timings json written by -jp, cases slowing down more than perf_threshold fail";
+
+static const char perf_threshold_message[] = "allowed slowdown against the perf baseline (default 0.2, i.e. 20%)";
+
+static const char shards_message[] = "run the unit tests in this many parallel processes (default 1)";
+
 DECLARE_bool(h);
 
 DECLARE_string(mt);
@@ -103,10 +119,26 @@ DECLARE_string(is);
 
 DECLARE_bool(et);
 
+DECLARE_string(cp);
+
 DECLARE_string(sc);
 
 DECLARE_string(bi);
 
+DECLARE_int32(ni);
+
+DECLARE_string(pl);
+
+DECLARE_string(jp);
+
+DECLARE_string(nm);
+
+DECLARE_string(perf_baseline);
+
+DECLARE_double(perf_threshold);
+
+DECLARE_int32(shards);
+
 }  // namespace TNN_NS
 
 #endif  // TNN_TEST_FLAGS_H_
@@ -41,10 +41,6 @@
 #include "tnn/utils/omp_utils.h"
 #include "tnn/utils/string_utils_inner.h"
 
-int main(int argc, char* argv[]) {
-    return TNN_NS::test::Run(argc, argv);
-}
-
 namespace TNN_NS {
 
 namespace test {
@@ -207,6 +203,7 @@ namespace test {
         printf("    -fc \"<format for compare>\t%s \n", output_format_cmp_message);
         printf("    -nt \"<network type>\t%s \n", output_format_cmp_message);
         printf("    -et \"<enable tune>\t%s \n", enable_tune_message);
+        printf("    -cp \"<cache path>\t%s \n", cache_path_message);
         printf("    -sc \"<input scale>\t%s \n", scale_message);
         printf("    -bi \"<input bias>\t%s \n", bias_message);
     }
@@ -315,6 +312,9 @@ namespace test {
 #else
         config.cache_path = "";
 #endif
+        if (!FLAGS_cp.empty()) {
+            config.cache_path = FLAGS_cp;
+        }
 
         // Device Type: ARM, OPENECL, ...
         config.device_type = ConvertDeviceType(FLAGS_dt);
@@ -29,11 +29,11 @@ Timer::Timer(std::string timer_info) {
 }
 
 void Timer::Start() {
-    start_ = system_clock::now();
+    start_ = steady_clock::now();
 }
 
 void Timer::Stop() {
-    stop_ = system_clock::now();
+    stop_ = steady_clock::now();
     float delta = duration_cast<microseconds>(stop_ - start_).count() / 1000.0f;
     min_         = static_cast<float>(fmin(min_, delta));
     max_         = static_cast<float>(fmax(max_, delta));
@@ -46,9 +46,17 @@ void Timer::Reset() {
     max_ = FLT_MIN;
     sum_ = 0.0f;
     count_ = 0;
-    stop_ = start_ = system_clock::now();
+    stop_ = start_ = steady_clock::now();
 }
    
+float Timer::GetMin() const {
+    return count_ > 0 ? min_ : 0.0f;
+}
+
+float Timer::GetAvg() const {
+    return count_ > 0 ? sum_ / count_ : 0.0f;
+}
+
 void Timer::Print() {
     char min_str[16];
     snprintf(min_str, 16, "%6.3f", min_);
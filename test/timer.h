@@ -25,7 +25,7 @@ namespace TNN_NS {
 namespace test {
 
 using std::chrono::time_point;
-using std::chrono::system_clock;
+using std::chrono::steady_clock;
 
 class Timer {
 public:
@@ -34,14 +34,17 @@ public:
     void Stop();
     void Reset();
     void Print();
+    // @brief min and average of the stopped intervals in ms
+    float GetMin() const;
+    float GetAvg() const;
 
 private:
     float min_;
     float max_;
     float sum_;
     std::string timer_info_;
-    time_point<system_clock> start_;
-    time_point<system_clock> stop_;
+    time_point<steady_clock> start_;
+    time_point<steady_clock> stop_;
     int count_;
 };
 
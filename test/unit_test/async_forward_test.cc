@@ -0,0 +1,233 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cmath>
+#include <future>
+#include <mutex>
+
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "test/unit_test/utils/network_test_utils.h"
+#include "tnn/utils/dims_vector_utils.h"
+
+namespace TNN_NS {
+
+// ox = sigmoid(x), oy = relu(y)
+static const char *kAsyncProto = "\"1 4 1 4206624770 ,\"\n"
+                                 "\"x 1 8 16 16 : y 1 4 8 8 ,\"\n"
+                                 "\" ox oy x y ,\"\n"
+                                 "\"ox oy ,\"\n"
+                                 "\" 2 ,\"\n"
+                                 "\"Sigmoid sig 1 1 x ox ,\"\n"
+                                 "\"ReLU relu 1 1 y oy ,\"\n";
+
+class AsyncForwardTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        auto dev = ConvertDeviceType(FLAGS_dt);
+        if (dev != DEVICE_NAIVE && dev != DEVICE_X86 && dev != DEVICE_ARM) {
+            GTEST_SKIP();
+        }
+        NetworkConfig config;
+        config.device_type = dev;
+        ModelConfig model_config;
+        model_config.params = {"", ""};
+        instance_           = std::make_shared<Instance>(config, model_config);
+        ASSERT_EQ((int)instance_->Init(GenerateInterpreterFromProto(kAsyncProto), InputShapesMap()), TNN_OK);
+    }
+
+    static float FrameValue(int frame) {
+        return 0.05f * frame - 1.0f;
+    }
+
+    Status SetInput(const std::string &name, DimsVector dims, float value) {
+        auto mat  = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, dims);
+        auto data = reinterpret_cast<float *>(mat->GetData());
+        std::fill(data, data + DimsVectorUtils::Count(dims), value);
+        return instance_->SetInputMat(mat, MatConvertParam(), name);
+    }
+
+    // the frame whose sigmoid fills mat, -1 if mat is not filled by a single frame
+    static int FrameOf(std::shared_ptr<Mat> mat, int frame_count) {
+        auto data = reinterpret_cast<float *>(mat->GetData());
+        int count = DimsVectorUtils::Count(mat->GetDims());
+        for (int frame = 0; frame < frame_count; ++frame) {
+            float expect = 1.0f / (1.0f + std::exp(-FrameValue(frame)));
+            bool match   = true;
+            for (int i = 0; i < count && match; ++i) {
+                match = std::fabs(data[i] - expect) < 1e-4f;
+            }
+            if (match) {
+                return frame;
+            }
+        }
+        return -1;
+    }
+
+    std::shared_ptr<Instance> instance_ = nullptr;
+    DimsVector x_dims_                  = {1, 8, 16, 16};
+};
+
+// inputs set while a forward runs are staged for the next one, callbacks and results keep the frame order
+TEST_F(AsyncForwardTest, Ordering) {
+    const int frame_count = 16;
+    std::mutex mutex;
+    std::vector<int> called;
+    std::promise<void> staged;
+    auto staged_future = staged.get_future().share();
+
+    ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(0)), TNN_OK);
+    int last_completed = -1;
+    for (int frame = 0; frame < frame_count; ++frame) {
+        // the first callback holds the worker until the input of frame 1 is staged
+        ASSERT_EQ((int)instance_->ForwardAsync([&, frame]() {
+            if (frame == 0) {
+                staged_future.wait();
+            }
+            std::lock_guard<std::mutex> guard(mutex);
+            called.push_back(frame);
+        }),
+                  TNN_OK);
+        if (frame + 1 < frame_count) {
+            ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(frame + 1)), TNN_OK);
+        }
+        if (frame == 0) {
+            staged.set_value();
+        }
+
+        std::shared_ptr<Mat> completed;
+        if (instance_->GetCompletedOutputMat(completed, MatConvertParam(), "ox", DEVICE_NAIVE) == TNN_OK) {
+            int completed_frame = FrameOf(completed, frame_count);
+            EXPECT_GE(completed_frame, last_completed);
+            EXPECT_LE(completed_frame, frame);
+            last_completed = completed_frame;
+        }
+    }
+
+    std::shared_ptr<Mat> output;
+    ASSERT_EQ((int)instance_->GetOutputMat(output, MatConvertParam(), "ox", DEVICE_NAIVE), TNN_OK);
+    EXPECT_EQ(FrameOf(output, frame_count), frame_count - 1);
+    std::lock_guard<std::mutex> guard(mutex);
+    ASSERT_EQ((int)called.size(), frame_count);
+    for (int frame = 0; frame < frame_count; ++frame) {
+        EXPECT_EQ(called[frame], frame);
+    }
+}
+
+// a callback chains the next forward while the instance thread reads the completed outputs
+TEST_F(AsyncForwardTest, Chaining) {
+    const int frame_count = 64;
+    std::atomic<int> next_frame(1);
+    std::promise<void> done;
+    auto done_future = done.get_future();
+
+    std::function<void(void)> chain = [&]() {
+        int frame = next_frame.fetch_add(1);
+        if (frame >= frame_count) {
+            done.set_value();
+            return;
+        }
+        EXPECT_EQ((int)SetInput("x", x_dims_, FrameValue(frame)), TNN_OK);
+        EXPECT_EQ((int)instance_->ForwardAsync(chain), TNN_OK);
+    };
+    ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(0)), TNN_OK);
+    ASSERT_EQ((int)instance_->ForwardAsync(chain), TNN_OK);
+
+    // every read sees one whole frame, never a mix of two
+    int last_completed = -1;
+    while (done_future.wait_for(std::chrono::milliseconds(0)) != std::future_status::ready) {
+        std::shared_ptr<Mat> completed;
+        if (instance_->GetCompletedOutputMat(completed, MatConvertParam(), "ox", DEVICE_NAIVE) == TNN_OK) {
+            int completed_frame = FrameOf(completed, frame_count);
+            EXPECT_GE(completed_frame, last_completed);
+            last_completed = completed_frame;
+        }
+    }
+
+    std::shared_ptr<Mat> output;
+    ASSERT_EQ((int)instance_->GetOutputMat(output, MatConvertParam(), "ox", DEVICE_NAIVE), TNN_OK);
+    EXPECT_EQ(FrameOf(output, frame_count), frame_count - 1);
+}
+
+// the instance thread sets inputs while callbacks keep chaining forwards, every forward reads one whole frame
+// and the last input set reaches the network
+TEST_F(AsyncForwardTest, SetInputWhileChaining) {
+    const int frame_count = 40;
+    std::atomic<bool> stop(false);
+    std::promise<void> done;
+    auto done_future = done.get_future();
+
+    std::function<void(void)> chain = [&]() {
+        if (stop) {
+            done.set_value();
+            return;
+        }
+        EXPECT_EQ((int)instance_->ForwardAsync(chain), TNN_OK);
+    };
+    ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(0)), TNN_OK);
+    ASSERT_EQ((int)instance_->ForwardAsync(chain), TNN_OK);
+
+    for (int frame = 1; frame < frame_count; ++frame) {
+        ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(frame)), TNN_OK);
+        std::shared_ptr<Mat> completed;
+        if (instance_->GetCompletedOutputMat(completed, MatConvertParam(), "ox", DEVICE_NAIVE) == TNN_OK) {
+            EXPECT_GE(FrameOf(completed, frame_count), 0) << "frame " << frame;
+        }
+    }
+    stop = true;
+    done_future.wait();
+
+    ASSERT_EQ((int)instance_->Forward(), TNN_OK);
+    std::shared_ptr<Mat> output;
+    ASSERT_EQ((int)instance_->GetOutputMat(output, MatConvertParam(), "ox", DEVICE_NAIVE), TNN_OK);
+    EXPECT_EQ(FrameOf(output, frame_count), frame_count - 1);
+}
+
+// an input staged during an async forward survives a reshape of another input
+TEST_F(AsyncForwardTest, Reshape) {
+    const int frame_count = 2;
+    std::promise<void> staged;
+    auto staged_future = staged.get_future();
+
+    ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(0)), TNN_OK);
+    ASSERT_EQ((int)instance_->ForwardAsync([&]() { staged_future.wait(); }), TNN_OK);
+    ASSERT_EQ((int)SetInput("x", x_dims_, FrameValue(1)), TNN_OK);
+    staged.set_value();
+
+    DimsVector y_dims = {1, 4, 4, 4};
+    ASSERT_EQ((int)instance_->Reshape({{"x", x_dims_}, {"y", y_dims}}), TNN_OK);
+    ASSERT_EQ((int)SetInput("y", y_dims, 0.5f), TNN_OK);
+    ASSERT_EQ((int)instance_->Forward(), TNN_OK);
+
+    std::shared_ptr<Mat> output;
+    ASSERT_EQ((int)instance_->GetOutputMat(output, MatConvertParam(), "ox", DEVICE_NAIVE), TNN_OK);
+    EXPECT_EQ(FrameOf(output, frame_count), 1);
+    ASSERT_EQ((int)instance_->GetOutputMat(output, MatConvertParam(), "oy", DEVICE_NAIVE), TNN_OK);
+    EXPECT_TRUE(DimsVectorUtils::Equal(output->GetDims(), y_dims));
+
+    // the staging blobs follow the new shapes
+    std::promise<void> restaged;
+    auto restaged_future = restaged.get_future();
+    ASSERT_EQ((int)instance_->ForwardAsync([&]() { restaged_future.wait(); }), TNN_OK);
+    ASSERT_EQ((int)SetInput("y", y_dims, 0.25f), TNN_OK);
+    restaged.set_value();
+    ASSERT_EQ((int)instance_->Forward(), TNN_OK);
+    ASSERT_EQ((int)instance_->GetOutputMat(output, MatConvertParam(), "oy", DEVICE_NAIVE), TNN_OK);
+    EXPECT_FLOAT_EQ(reinterpret_cast<float *>(output->GetData())[DimsVectorUtils::Count(y_dims) - 1], 0.25f);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,155 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Latency and accuracy of the dynamic int8 gemm against the fp32 matmul gemm on the linear layers of a
+// bert-base encoder. A is quantized per row at runtime, B per column when the model is loaded.
+// usage: x86_dynamic_int8_benchmark [thread_num] [iterations] [seq_len]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
+#include "tnn/device/x86/acc/compute/x86_compute_int8.h"
+#include "tnn/utils/omp_utils.h"
+
+#include <xmmintrin.h>
+
+namespace TNN_NS {
+
+// A[rows x K] * B[K x N] of one linear layer
+struct LinearShape {
+    std::string name;
+    int K;
+    int N;
+};
+
+// the workspace is read with aligned loads by the jit kernels
+static std::shared_ptr<float> AlignedAlloc(size_t count) {
+    return std::shared_ptr<float>(static_cast<float *>(_mm_malloc(count * sizeof(float), 32)), _mm_free);
+}
+
+template <typename Func>
+static double AverageLatency(Func func, int iterations) {
+    func();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+}
+
+// |c - ref| / |ref| over the whole matrix
+static double RelativeError(const std::vector<float> &c, const std::vector<double> &ref) {
+    double diff = 0, norm = 0;
+    for (size_t i = 0; i < c.size(); ++i) {
+        diff += (c[i] - ref[i]) * (c[i] - ref[i]);
+        norm += ref[i] * ref[i];
+    }
+    return norm > 0 ? std::sqrt(diff / norm) : 0;
+}
+
+static void RunBenchmark(int threads, int iterations, int rows) {
+    printf("threads %d, seq_len %d\n", threads, rows);
+    OMP_SET_THREADS_(threads);
+
+    std::vector<LinearShape> shapes = {
+        {"bert.qkv", 768, 2304},
+        {"bert.attn.out", 768, 768},
+        {"bert.ffn.in", 768, 3072},
+        {"bert.ffn.out", 3072, 768},
+    };
+
+    std::mt19937 rng(2021);
+    std::normal_distribution<float> normal(0.f, 1.f);
+    double total_fp32 = 0, total_int8 = 0;
+    for (const auto &shape : shapes) {
+        const int K = shape.K, N = shape.N;
+        std::vector<float> a((size_t)rows * K), b((size_t)K * N);
+        for (auto &v : a) {
+            v = normal(rng);
+        }
+        for (auto &v : b) {
+            v = normal(rng) * 0.02f;
+        }
+
+        // fp32, as X86MatMulLayerAcc runs it
+        conv_gemm_config<float, float, float> conf;
+        size_t workspace_count = ROUND_UP(conf.M_c_ * conf.K_c_, 8) + conf.K_c_ * ROUND_UP(rows, conf.n_block_);
+        auto workspace         = AlignedAlloc(workspace_count);
+        std::vector<float> fake_bias(rows, 0.f), c_fp32((size_t)rows * N), c_int8((size_t)rows * N);
+        double fp32_ms = AverageLatency([&]() {
+            conv_sgemm_nn_col_major(N, rows, K, b.data(), N, a.data(), K, c_fp32.data(), N, fake_bias.data(),
+                                    ActivationType_None, workspace.get(), conf);
+        }, iterations);
+
+        // int8 B transposed to rows of k_r32 with per column scales, as the weights are packed at init
+        const int k_r32 = ROUND_UP(K, 32), n_r4 = ROUND_UP(N, 4);
+        std::vector<int8_t> b_int8((size_t)n_r4 * k_r32, 0), a_int8((size_t)rows * k_r32);
+        std::vector<float> b_scale(n_r4, 0.f), a_scale(rows);
+        for (int n = 0; n < N; ++n) {
+            float max = 0;
+            for (int k = 0; k < K; ++k) {
+                max = std::max(max, std::fabs(b[(size_t)k * N + n]));
+            }
+            b_scale[n] = max / 127.f;
+            for (int k = 0; k < K; ++k) {
+                b_int8[(size_t)n * k_r32 + k] = (int8_t)std::nearbyint(b[(size_t)k * N + n] * 127.f / max);
+            }
+        }
+        double int8_ms = AverageLatency([&]() {
+            X86QuantizeRowsInt8(a_int8.data(), a_scale.data(), a.data(), rows, K, k_r32);
+            X86DynamicGemmInt8(c_int8.data(), a_int8.data(), a_scale.data(), b_int8.data(), b_scale.data(), nullptr,
+                               rows, N, k_r32, N);
+        }, iterations);
+
+        std::vector<double> ref((size_t)rows * N, 0.0);
+        for (int r = 0; r < rows; ++r) {
+            for (int k = 0; k < K; ++k) {
+                const double av = a[(size_t)r * K + k];
+                for (int n = 0; n < N; ++n) {
+                    ref[(size_t)r * N + n] += av * b[(size_t)k * N + n];
+                }
+            }
+        }
+
+        double gflop = 2.0 * rows * N * K * 1e-6;
+        printf("%-14s K %4d N %4d | fp32 %8.3f ms %6.1f GFLOPS rel err %.2e | int8 %8.3f ms %6.1f GOPS rel err "
+               "%.2e | speedup %.2f\n",
+               shape.name.c_str(), K, N, fp32_ms, gflop / fp32_ms, RelativeError(c_fp32, ref), int8_ms,
+               gflop / int8_ms, RelativeError(c_int8, ref), fp32_ms / int8_ms);
+        total_fp32 += fp32_ms;
+        total_int8 += int8_ms;
+    }
+    printf("bert-base encoder linear layers x 12 | fp32 %8.2f ms | int8 %8.2f ms | speedup %.2f\n", total_fp32 * 12,
+           total_int8 * 12, total_fp32 / total_int8);
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char **argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : OMP_CORES_;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    int seq_len    = argc > 3 ? atoi(argv[3]) : 128;
+
+    TNN_NS::RunBenchmark(threads, iterations, seq_len);
+    return 0;
+}
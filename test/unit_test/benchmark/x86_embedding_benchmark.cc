@@ -0,0 +1,142 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Latency of random row lookups in a 1M x 128 embedding table stored as fp32, fp16 and int8 with per-row scale.
+// The plain gather converts one row after another without prefetching, like the generic gather loop.
+// usage: x86_embedding_benchmark [thread_num] [lookups] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/utils/half_utils.h"
+#include "tnn/utils/omp_utils.h"
+
+namespace TNN_NS {
+
+static const int kTableRows = 1 << 20;
+static const int kRowSize   = 128;
+
+// median latency in ms
+template <typename Func>
+static double MedianLatency(Func func, int iterations) {
+    std::vector<double> times;
+    func();
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void PlainGather(float *dst, const void *table, DataType table_type, const float *scale, const int *indices,
+                        int lookups) {
+    for (int i = 0; i < lookups; ++i) {
+        size_t offset  = (size_t)indices[i] * kRowSize;
+        float *dst_row = dst + (size_t)i * kRowSize;
+        if (table_type == DATA_TYPE_FLOAT) {
+            memcpy(dst_row, (const float *)table + offset, kRowSize * sizeof(float));
+        } else if (table_type == DATA_TYPE_HALF) {
+            X86HalfToFloat(dst_row, (const uint16_t *)table + offset, kRowSize);
+        } else {
+            const int8_t *src = (const int8_t *)table + offset;
+            for (int j = 0; j < kRowSize; ++j) {
+                dst_row[j] = scale[indices[i]] * src[j];
+            }
+        }
+    }
+}
+
+static void RunBenchmark(int threads, int lookups, int iterations) {
+    printf("threads %d table %d x %d lookups %d\n", threads, kTableRows, kRowSize, lookups);
+    OMP_SET_THREADS_(threads);
+
+    // every run looks up other rows, so that they come from dram as in a real lookup
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(0, kTableRows - 1);
+    std::vector<std::vector<int>> indices(2 * (iterations + 1), std::vector<int>(lookups));
+    for (auto &batch : indices) {
+        for (auto &index : batch) {
+            index = dist(gen);
+        }
+    }
+
+    const size_t count = (size_t)kTableRows * kRowSize;
+    std::vector<float> dst(lookups * kRowSize), expected(lookups * kRowSize);
+    auto run = [&](const char *name, const void *table, DataType table_type, const float *scale, int ele_size) {
+        int step     = 0;
+        double plain = MedianLatency([&]() {
+            PlainGather(dst.data(), table, table_type, scale, indices[step++ % indices.size()].data(), lookups);
+        }, iterations);
+        // the plain gather has warmed its own rows only
+        step = iterations + 1;
+        double gather = MedianLatency([&]() {
+            X86EmbeddingGather(dst.data(), table, table_type, scale, kTableRows, kRowSize,
+                               indices[step++ % indices.size()].data(), lookups);
+        }, iterations);
+
+        PlainGather(expected.data(), table, table_type, scale, indices[0].data(), lookups);
+        X86EmbeddingGather(dst.data(), table, table_type, scale, kTableRows, kRowSize, indices[0].data(), lookups);
+        float max_diff = 0;
+        for (size_t i = 0; i < dst.size(); ++i) {
+            max_diff = std::max(max_diff, std::fabs(dst[i] - expected[i]));
+        }
+        double gb = (double)lookups * kRowSize * ele_size / (1024.0 * 1024.0 * 1024.0);
+        printf("%-5s table %5.0f MB | plain %8.3f ms gather %8.3f ms speedup %.2f | %6.2f GB/s | max diff %g\n", name,
+               count * ele_size / (1024.0 * 1024.0), plain, gather, plain / gather, gb / (gather / 1000.0), max_diff);
+    };
+
+    {
+        std::vector<float> table(count);
+        for (size_t i = 0; i < count; ++i) {
+            table[i] = (float)((i * 7) % 255) / 127.f - 1.f;
+        }
+        run("fp32", table.data(), DATA_TYPE_FLOAT, nullptr, sizeof(float));
+
+        std::vector<uint16_t> table_half(count);
+        ConvertFromFloatToHalf(table.data(), table_half.data(), (int)count);
+        run("fp16", table_half.data(), DATA_TYPE_HALF, nullptr, sizeof(uint16_t));
+    }
+    {
+        std::vector<int8_t> table(count);
+        std::vector<float> scale(kTableRows);
+        for (size_t i = 0; i < count; ++i) {
+            table[i] = (int8_t)((int)((i * 7) % 255) - 127);
+        }
+        for (int r = 0; r < kTableRows; ++r) {
+            scale[r] = 1.f / 127.f * (1 + r % 3);
+        }
+        run("int8", table.data(), DATA_TYPE_INT8, scale.data(), sizeof(int8_t));
+    }
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char **argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : 1;
+    int lookups    = argc > 2 ? atoi(argv[2]) : 4096;
+    int iterations = argc > 3 ? atoi(argv[3]) : 50;
+
+    TNN_NS::RunBenchmark(threads, lookups, iterations);
+    return 0;
+}
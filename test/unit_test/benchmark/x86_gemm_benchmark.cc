@@ -0,0 +1,137 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+
+// Compares the fixed gemm blocking (M_c 64, K_c 256, no N split) with the
+// blocking derived from the cache topology on matrix shapes of real conv layers.
+// usage: x86_gemm_benchmark [thread_num] [iterations]
+// the derived blocking can be overridden with TNN_X86_GEMM_BLOCK="M_c,K_c[,N_c]"
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "tnn/device/x86/acc/compute/jit/conv_gemm_config.h"
+#include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_cache.h"
+#include "tnn/utils/omp_utils.h"
+
+#include <xmmintrin.h>
+
+namespace TNN_NS {
+
+// gemm of one conv layer, M = out_h * out_w, N = out_channel, K = in_channel * kernel_h * kernel_w
+struct GemmShape {
+    std::string name;
+    int M;
+    int N;
+    int K;
+};
+
+// packed buffers are read with aligned loads by the jit kernels
+static std::shared_ptr<float> AlignedAlloc(size_t count) {
+    return std::shared_ptr<float>(static_cast<float*>(_mm_malloc(count * sizeof(float), 32)), _mm_free);
+}
+
+static double RunGemm(const GemmShape& shape, conv_gemm_config<float, float, float>& conf, bool split_n,
+                      const std::vector<float>& src, const std::vector<float>& weight, const std::vector<float>& bias,
+                      std::vector<float>& dst, int threads, int iterations) {
+    conv_ajust_m_blk_size(threads, shape.M, conf.M_c_);
+    if (split_n) {
+        conv_ajust_n_blk_size(threads, shape.M, conf.M_c_, shape.N, conf.n_block_, conf.N_c_);
+    }
+
+    auto packed_weight = AlignedAlloc(ROUND_UP(shape.K, conf.K_c_) * ROUND_UP(shape.N, conf.n_block_));
+    conv_pack_col_b_n(shape.N, shape.K, weight.data(), shape.K, packed_weight.get(), conf);
+    auto src_trans = AlignedAlloc(conf.M_c_ * conf.K_c_ * threads);
+
+    auto run = [&]() {
+        conv_sgemm_nn_col_major_prepack_b(shape.M, shape.N, shape.K, src.data(), shape.M, packed_weight.get(),
+                                          shape.K, dst.data(), shape.M, bias.data(), 0, src_trans.get(), conf);
+    };
+
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        run();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+}
+
+static void RunBenchmark(int threads, int iterations) {
+    const auto& cache = cpu_cache_info();
+    printf("L1d %ld KB, L2 %ld KB shared by %ld, L3 %ld KB shared by %ld, threads %d\n", (long)cache.l1d_size / 1024,
+           (long)cache.l2_size / 1024, (long)cache.l2_sharing, (long)cache.l3_size / 1024, (long)cache.l3_sharing,
+           threads);
+
+    std::vector<GemmShape> shapes = {
+        {"resnet50.conv1", 12544, 64, 147},     {"resnet50.res2.1x1", 3136, 64, 64},
+        {"resnet50.res2.3x3", 3136, 64, 576},   {"resnet50.res2.expand", 3136, 256, 64},
+        {"resnet50.res3.3x3", 784, 128, 1152},  {"resnet50.res3.expand", 784, 512, 128},
+        {"resnet50.res4.3x3", 196, 256, 2304},  {"resnet50.res4.expand", 196, 1024, 256},
+        {"resnet50.res5.3x3", 49, 512, 4608},   {"resnet50.res5.expand", 49, 2048, 512},
+        {"mobilenet.pw1", 12544, 64, 32},       {"mobilenet.pw3", 3136, 128, 128},
+        {"mobilenet.pw5", 784, 256, 256},       {"mobilenet.pw7", 196, 512, 512},
+        {"mobilenet.pw13", 49, 1024, 1024},     {"mobilenet.fc", 1, 1000, 1024},
+    };
+
+    OMP_SET_THREADS_(threads);
+    for (const auto& shape : shapes) {
+        std::vector<float> src((size_t)shape.M * shape.K);
+        std::vector<float> weight((size_t)shape.N * shape.K);
+        std::vector<float> bias(ROUND_UP(shape.N, 8), 0.1f);
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = (float)((i * 7) % 17) / 17.f - 0.5f;
+        }
+        for (size_t i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)((i * 5) % 13) / 13.f - 0.5f;
+        }
+        std::vector<float> dst_fixed((size_t)shape.M * shape.N), dst_cache((size_t)shape.M * shape.N);
+
+        conv_gemm_config<float, float, float> fixed_conf;
+        fixed_conf.M_c_ = 64;
+        fixed_conf.K_c_ = 256;
+        double fixed_ms = RunGemm(shape, fixed_conf, false, src, weight, bias, dst_fixed, threads, iterations);
+
+        conv_gemm_config<float, float, float> cache_conf;
+        int m_c = (int)cache_conf.M_c_, k_c = (int)cache_conf.K_c_;
+        double cache_ms = RunGemm(shape, cache_conf, true, src, weight, bias, dst_cache, threads, iterations);
+
+        float max_diff = 0;
+        for (size_t i = 0; i < dst_fixed.size(); ++i) {
+            max_diff = std::max(max_diff, std::fabs(dst_fixed[i] - dst_cache[i]));
+        }
+        double gflop = 2.0 * shape.M * shape.N * shape.K * 1e-6;
+        printf("%-22s M %5d N %4d K %4d | fixed %8.3f ms %6.1f GFLOPS | cache M_c %3d K_c %3d N_c %4d %8.3f ms %6.1f "
+               "GFLOPS | speedup %.2f max diff %g\n",
+               shape.name.c_str(), shape.M, shape.N, shape.K, fixed_ms, gflop / fixed_ms, m_c, k_c,
+               (int)std::min<dim_t>(cache_conf.N_c_, shape.N), cache_ms, gflop / cache_ms, fixed_ms / cache_ms,
+               max_diff);
+    }
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char** argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : OMP_CORES_;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    TNN_NS::RunBenchmark(threads, iterations);
+    return 0;
+}
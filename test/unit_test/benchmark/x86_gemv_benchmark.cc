@@ -0,0 +1,152 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Scaling of the x86 gemv used by InnerProduct and MatMul with few rows, from 1 to 32 threads.
+// Compares the old split over output channels only with the tiles chosen by X86SgemvPartition,
+// which also splits depth when the output is too small to keep all threads busy.
+// usage: x86_gemv_benchmark [max_thread_num] [iterations]
+
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/device/x86/x86_util.h"
+#include "tnn/utils/omp_utils.h"
+
+namespace TNN_NS {
+
+// inner product of batch rows, input_size -> output_size
+struct GemvShape {
+    std::string name;
+    int batch;
+    int input_size;
+    int output_size;
+};
+
+typedef void (*SgemvFunc)(float *, const float *, const float *, float *, DimsVector, DimsVector,
+                          const X86SgemvPlan &, float *);
+
+static double RunGemv(SgemvFunc func, const GemvShape &shape, const X86SgemvPlan &plan, int pack,
+                      const std::vector<float> &src, const std::vector<float> &weight, std::vector<float> &bias,
+                      std::vector<float> &dst, int iterations) {
+    DimsVector input_dims  = {shape.batch, shape.input_size, 1, 1};
+    DimsVector output_dims = {shape.batch, shape.output_size, 1, 1};
+    std::vector<float> workspace(
+        X86SgemvWorkspaceSize(plan, shape.batch, shape.output_size, shape.input_size, pack) / sizeof(float) + 1);
+
+    auto run = [&]() {
+        func(dst.data(), src.data(), weight.data(), bias.data(), input_dims, output_dims, plan, workspace.data());
+    };
+
+    run();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        run();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+}
+
+static void RunBenchmark(int max_threads, int iterations) {
+#ifdef __AVX2__
+    // the Float8 kernels are built with fma, an avx only cpu runs the sse4.2 ones
+    bool use_avx = cpu_with_isa(avx2);
+#else
+    bool use_avx = false;
+#endif
+    int pack     = use_avx ? 8 : 4;
+    auto func    = use_avx ? X86Sgemv<Float8, 8> : X86Sgemv<Float4, 4>;
+    printf("%s, max threads %d\n", use_avx ? "avx2" : "sse4.2", max_threads);
+
+    std::vector<GemvShape> shapes = {
+        {"resnet50.fc", 1, 2048, 1000},    {"mobilenet.fc", 1, 1024, 1000}, {"vgg16.fc6", 1, 25088, 4096},
+        {"vgg16.fc7", 1, 4096, 4096},      {"bert.ffn.in", 1, 768, 3072},   {"bert.ffn.out", 1, 3072, 768},
+        {"bert.pooler", 1, 768, 768},      {"bert.classifier", 1, 768, 2},  {"fc.small_out", 1, 4096, 32},
+        {"fc.batch4", 4, 1024, 1024},      {"fc.batch4.small", 4, 2048, 64},
+    };
+
+    std::vector<int> thread_nums;
+    for (int t = 1; t <= max_threads; t *= 2) {
+        thread_nums.push_back(t);
+    }
+
+    for (const auto &shape : shapes) {
+        std::vector<float> src((size_t)shape.batch * shape.input_size);
+        std::vector<float> weight((size_t)shape.output_size * shape.input_size);
+        std::vector<float> bias(ROUND_UP(shape.output_size, pack), 0.1f);
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = (float)((i * 7) % 17) / 17.f - 0.5f;
+        }
+        for (size_t i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)((i * 5) % 13) / 13.f - 0.5f;
+        }
+        std::vector<float> packed_weight((size_t)ROUND_UP(shape.output_size, pack) * shape.input_size, 0.f);
+        if (use_avx) {
+            PackC8(packed_weight.data(), weight.data(), shape.input_size, shape.input_size, shape.input_size,
+                   shape.output_size);
+        } else {
+            PackC4(packed_weight.data(), weight.data(), shape.input_size, shape.input_size, shape.input_size,
+                   shape.output_size);
+        }
+
+        std::vector<float> dst_ref((size_t)shape.batch * shape.output_size);
+        std::vector<float> dst((size_t)shape.batch * shape.output_size);
+        double gflop = 2.0 * shape.batch * shape.input_size * shape.output_size * 1e-6;
+        double base_ms = 0;
+
+        for (int threads : thread_nums) {
+            OMP_SET_THREADS_(threads);
+
+            // previous behaviour: one task per pack of output channels, no depth split
+            X86SgemvPlan rows_plan;
+            rows_plan.row_tile = 1;
+            rows_plan.col_tile = pack;
+            rows_plan.k_tile   = shape.input_size;
+            double rows_ms = RunGemv(func, shape, rows_plan, pack, src, packed_weight, bias, dst_ref, iterations);
+
+            auto plan = X86SgemvPartition(shape.batch, shape.output_size, shape.input_size, pack, threads);
+            double plan_ms = RunGemv(func, shape, plan, pack, src, packed_weight, bias, dst, iterations);
+            if (threads == 1) {
+                base_ms = plan_ms;
+            }
+
+            float max_diff = 0;
+            for (size_t i = 0; i < dst.size(); ++i) {
+                max_diff = std::max(max_diff, std::fabs(dst[i] - dst_ref[i]));
+            }
+            printf("%-16s b %d k %5d n %4d t %2d | oc split %8.3f ms %6.1f GFLOPS | tiles %d x %4d x %5d %8.3f ms "
+                   "%6.1f GFLOPS | vs oc split %.2f vs 1 thread %.2f max diff %g\n",
+                   shape.name.c_str(), shape.batch, shape.input_size, shape.output_size, threads, rows_ms,
+                   gflop / rows_ms, plan.row_tile, plan.col_tile, plan.k_tile, plan_ms, gflop / plan_ms,
+                   rows_ms / plan_ms, base_ms / plan_ms, max_diff);
+        }
+    }
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char **argv) {
+    int max_threads = argc > 1 ? atoi(argv[1]) : 32;
+    int iterations  = argc > 2 ? atoi(argv[2]) : 50;
+
+    TNN_NS::RunBenchmark(max_threads, iterations);
+    return 0;
+}
@@ -0,0 +1,144 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Batch 1 latency of the x86 gemv with fp32 weights and with fp16 weights expanded by f16c.
+// InnerProduct packs its weights, MatMul packs a constant B the same way and streams a variable B unpacked.
+// usage: x86_half_gemv_benchmark [thread_num] [iterations]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/device/x86/x86_util.h"
+#include "tnn/utils/half_utils.h"
+#include "tnn/utils/omp_utils.h"
+
+namespace TNN_NS {
+
+struct FcShape {
+    std::string name;
+    int input_size;
+    int output_size;
+};
+
+// median latency in ms
+template <typename Func>
+static double MedianLatency(Func func, int iterations) {
+    std::vector<double> times;
+    func();
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+static void RunBenchmark(int threads, int iterations) {
+    if (!X86HalfWeightSupported()) {
+        printf("fp16 weights need avx2 and f16c\n");
+        return;
+    }
+    printf("threads %d\n", threads);
+    OMP_SET_THREADS_(threads);
+
+    std::vector<FcShape> shapes = {
+        {"resnet50.fc", 2048, 1000}, {"vgg16.fc6", 25088, 4096}, {"vgg16.fc7", 4096, 4096},
+        {"bert.qkv", 768, 2304},     {"bert.ffn.in", 768, 3072}, {"bert.ffn.out", 3072, 768},
+        {"gpt2.lm_head", 768, 50257},
+    };
+
+    for (const auto &shape : shapes) {
+        int K = shape.input_size;
+        int M = shape.output_size;
+        size_t weight_count = (size_t)ROUND_UP(M, 8) * K;
+
+        std::vector<float> src(K), bias(ROUND_UP(M, 8), 0.1f), weight((size_t)M * K);
+        for (size_t i = 0; i < src.size(); ++i) {
+            src[i] = (float)((i * 7) % 17) / 17.f - 0.5f;
+        }
+        for (size_t i = 0; i < weight.size(); ++i) {
+            weight[i] = (float)((i * 5) % 13) / 13.f - 0.5f;
+        }
+
+        // inner product, weights packed to c8
+        std::vector<float> packed(weight_count, 0.f);
+        PackC8(packed.data(), weight.data(), K, K, K, M);
+        std::vector<uint16_t> packed_half(weight_count);
+        ConvertFromFloatToHalf(packed.data(), packed_half.data(), (int)weight_count);
+
+        // matmul, weight is read as a row major [K x M] matrix
+        std::vector<float> packed_mm(weight_count);
+        X86SgemvPackRowMajor(packed_mm.data(), weight.data(), K, M, 8);
+        std::vector<uint16_t> packed_mm_half(weight_count);
+        ConvertFromFloatToHalf(packed_mm.data(), packed_mm_half.data(), (int)weight_count);
+
+        DimsVector input_dims  = {1, K, 1, 1};
+        DimsVector output_dims = {1, M, 1, 1};
+        auto plan = X86SgemvPartition(1, M, K, 8, threads);
+        std::vector<float> workspace(X86SgemvWorkspaceSize(plan, 1, M, K, 8) / sizeof(float) + 1);
+        std::vector<float> dst_fp32(M), dst_fp16(M), mm_fp32(M), mm_fp16(M), mm_unpacked(M);
+
+        double fc_fp32 = MedianLatency([&]() {
+            X86Sgemv<Float8, 8>(dst_fp32.data(), src.data(), packed.data(), bias.data(), input_dims, output_dims,
+                                plan, workspace.data());
+        }, iterations);
+        double fc_fp16 = MedianLatency([&]() {
+            X86SgemvHalf(dst_fp16.data(), src.data(), packed_half.data(), bias.data(), input_dims, output_dims, plan,
+                         workspace.data());
+        }, iterations);
+        double mm_time_unpacked = MedianLatency([&]() {
+            X86SgemvRowMajor<Float8, 8>(mm_unpacked.data(), src.data(), weight.data(), nullptr, 1, M, K, plan,
+                                        workspace.data());
+        }, iterations);
+        double mm_time_fp32 = MedianLatency([&]() {
+            X86Sgemv<Float8, 8>(mm_fp32.data(), src.data(), packed_mm.data(), nullptr, input_dims, output_dims, plan,
+                                workspace.data());
+        }, iterations);
+        double mm_time_fp16 = MedianLatency([&]() {
+            X86SgemvHalf(mm_fp16.data(), src.data(), packed_mm_half.data(), nullptr, input_dims, output_dims, plan,
+                         workspace.data());
+        }, iterations);
+
+        float max_diff = 0;
+        for (int i = 0; i < M; ++i) {
+            max_diff = std::max(max_diff, std::fabs(dst_fp32[i] - dst_fp16[i]));
+            max_diff = std::max(max_diff, std::fabs(mm_fp32[i] - mm_fp16[i]));
+            max_diff = std::max(max_diff, std::fabs(mm_fp32[i] - mm_unpacked[i]));
+        }
+        double mb = (double)M * K * sizeof(float) / (1024.0 * 1024.0);
+        printf("%-14s k %5d n %5d %7.1f MB | fc fp32 %8.3f ms fp16 %8.3f ms speedup %.2f | matmul unpacked %8.3f ms "
+               "fp32 %8.3f ms fp16 %8.3f ms speedup %.2f | max diff %g\n",
+               shape.name.c_str(), K, M, mb, fc_fp32, fc_fp16, fc_fp32 / fc_fp16, mm_time_unpacked, mm_time_fp32,
+               mm_time_fp16, mm_time_fp32 / mm_time_fp16, max_diff);
+    }
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char **argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : 1;
+    int iterations = argc > 2 ? atoi(argv[2]) : 50;
+
+    TNN_NS::RunBenchmark(threads, iterations);
+    return 0;
+}
@@ -0,0 +1,179 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Latency of the int8 depthwise conv and pooling kernels on the layers of quant_mobilenet_v1/v2.tnnproto
+// at 224x224: the sse kernel followed by a separate relu pass, the sse kernel with the relu fused and the
+// avx2 kernel with the relu fused. the input is padded so that every output goes through the row kernels.
+// usage: x86_int8_depthwise_benchmark [thread_num] [iterations]
+
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tnn/core/macro.h"
+#include "tnn/device/x86/acc/compute/x86_compute_int8.h"
+#include "tnn/utils/omp_utils.h"
+
+namespace TNN_NS {
+
+struct DepthwiseShape {
+    std::string name;
+    int channel;
+    int input_size;
+    int stride;
+};
+
+template <typename Func>
+static double AverageLatency(Func func, int iterations) {
+    func();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        func();
+    }
+    auto stop = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(stop - start).count() / iterations;
+}
+
+static std::vector<int8_t> RandomInt8(size_t count, std::mt19937 &rng) {
+    std::uniform_int_distribution<int> dist(-127, 127);
+    std::vector<int8_t> data(count);
+    for (auto &v : data) {
+        v = static_cast<int8_t>(dist(rng));
+    }
+    return data;
+}
+
+typedef void (*DepthwiseFunc)(int8_t *, const int8_t *, const int8_t *, const int32_t *, long, long, long, long, long,
+                              long, long, const float *, long, const int8_t *, const float *, const int8_t *);
+
+// 3x3 depthwise conv with pad 1, rows are split among threads as in X86ConvInt8LayerDepthwise
+static void RunDepthwise(DepthwiseFunc func, int8_t *dst, const int8_t *src, const int8_t *weight,
+                         const int32_t *bias, const float *scale, const DepthwiseShape &shape, long relu) {
+    const int c_r4 = ROUND_UP(shape.channel, 4);
+    const int iw   = shape.input_size + 2;
+    const int ow   = (shape.input_size - 1) / shape.stride + 1;
+    OMP_PARALLEL_FOR_GUIDED_
+    for (int dy = 0; dy < ow; ++dy) {
+        func(dst + dy * ow * c_r4, src + dy * shape.stride * iw * c_r4, weight, bias, ow, iw * c_r4, c_r4,
+             shape.stride * c_r4, c_r4, 3, 3, scale, relu, nullptr, nullptr, nullptr);
+    }
+}
+
+static void BenchmarkDepthwise(const std::string &model, const std::vector<DepthwiseShape> &shapes, int iterations) {
+    std::mt19937 rng(2021);
+    double total_sse = 0, total_fused = 0, total_avx = 0;
+    for (const auto &shape : shapes) {
+        const int c_r4 = ROUND_UP(shape.channel, 4);
+        const int iw   = shape.input_size + 2;
+        const int ow   = (shape.input_size - 1) / shape.stride + 1;
+        auto src       = RandomInt8((size_t)iw * iw * c_r4, rng);
+        auto weight    = RandomInt8((size_t)9 * c_r4, rng);
+        std::vector<int32_t> bias(c_r4, 100);
+        std::vector<float> scale(c_r4, 0.002f);
+        std::vector<int8_t> dst((size_t)ow * ow * c_r4);
+
+        double sse_ms = AverageLatency([&]() {
+            RunDepthwise(X86DepthwiseI8K3, dst.data(), src.data(), weight.data(), bias.data(), scale.data(), shape, 0);
+            X86ReluInt8(dst.data(), dst.data(), (long)dst.size());
+        }, iterations);
+        double fused_ms = AverageLatency([&]() {
+            RunDepthwise(X86DepthwiseI8K3, dst.data(), src.data(), weight.data(), bias.data(), scale.data(), shape, 1);
+        }, iterations);
+        double avx_ms = sse_ms;
+#ifdef __AVX2__
+        if (c_r4 >= 16) {
+            avx_ms = AverageLatency([&]() {
+                RunDepthwise(X86AVXDepthwiseI8K3, dst.data(), src.data(), weight.data(), bias.data(), scale.data(),
+                             shape, 1);
+            }, iterations);
+        }
+#endif
+        printf("%-18s %-16s c %4d %3dx%-3d s%d | sse + relu %7.3f ms | sse fused %7.3f ms | avx2 fused %7.3f ms | "
+               "speedup %.2f\n",
+               model.c_str(), shape.name.c_str(), shape.channel, shape.input_size, shape.input_size, shape.stride,
+               sse_ms, fused_ms, avx_ms, sse_ms / avx_ms);
+        total_sse += sse_ms;
+        total_fused += fused_ms;
+        total_avx += avx_ms;
+    }
+    printf("%-18s depthwise total    | sse + relu %7.3f ms | sse fused %7.3f ms | avx2 fused %7.3f ms | speedup %.2f\n",
+           model.c_str(), total_sse, total_fused, total_avx, total_sse / total_avx);
+}
+
+typedef void (*PoolingFunc)(const int8_t *, long, long, int8_t *, long, long, long, long, long, long, long, long,
+                            long);
+
+static void BenchmarkPooling(const std::string &name, int channel, int input_size, int kernel, int stride, int pad,
+                             int pool_type, int iterations) {
+    std::mt19937 rng(2021);
+    const int c_r4 = ROUND_UP(channel, 4);
+    const int ow   = (input_size + 2 * pad - kernel) / stride + 1;
+    auto src       = RandomInt8((size_t)input_size * input_size * c_r4, rng);
+    std::vector<int8_t> dst((size_t)ow * ow * c_r4);
+
+    PoolingFunc sse_func = pool_type == 0 ? X86MaxPoolingINT8 : X86AvgPoolingINT8;
+    PoolingFunc avx_func = sse_func;
+#ifdef __AVX2__
+    avx_func = pool_type == 0 ? X86AVXMaxPoolingINT8 : X86AVXAvgPoolingINT8;
+#endif
+    double sse_ms = AverageLatency([&]() {
+        sse_func(src.data(), input_size, input_size, dst.data(), ow, ow, c_r4, kernel, kernel, stride, stride, pad, pad);
+    }, iterations);
+    double avx_ms = AverageLatency([&]() {
+        avx_func(src.data(), input_size, input_size, dst.data(), ow, ow, c_r4, kernel, kernel, stride, stride, pad, pad);
+    }, iterations);
+    printf("%-35s c %4d %3dx%-3d k%d s%d | sse %7.3f ms | avx2 %7.3f ms | speedup %.2f\n", name.c_str(), channel,
+           input_size, input_size, kernel, stride, sse_ms, avx_ms, sse_ms / avx_ms);
+}
+
+static void RunBenchmark(int threads, int iterations) {
+    printf("threads %d\n", threads);
+    OMP_SET_THREADS_(threads);
+
+    std::vector<DepthwiseShape> mobilenet_v1 = {
+        {"conv2_1/dw", 32, 112, 1},  {"conv2_2/dw", 64, 112, 2},  {"conv3_1/dw", 128, 56, 1},
+        {"conv3_2/dw", 128, 56, 2},  {"conv4_1/dw", 256, 28, 1},  {"conv4_2/dw", 256, 28, 2},
+        {"conv5_1/dw", 512, 14, 1},  {"conv5_2/dw", 512, 14, 1},  {"conv5_3/dw", 512, 14, 1},
+        {"conv5_4/dw", 512, 14, 1},  {"conv5_5/dw", 512, 14, 1},  {"conv5_6/dw", 512, 14, 2},
+        {"conv6/dw", 1024, 7, 1},
+    };
+    std::vector<DepthwiseShape> mobilenet_v2 = {
+        {"conv2_1/dwise", 32, 112, 1}, {"conv2_2/dwise", 96, 112, 2}, {"conv3_1/dwise", 144, 56, 1},
+        {"conv3_2/dwise", 144, 56, 2}, {"conv4_1/dwise", 192, 28, 1}, {"conv4_2/dwise", 192, 28, 1},
+        {"conv4_3/dwise", 192, 28, 2}, {"conv4_4/dwise", 384, 14, 1}, {"conv4_5/dwise", 384, 14, 1},
+        {"conv4_6/dwise", 384, 14, 1}, {"conv4_7/dwise", 384, 14, 1}, {"conv5_1/dwise", 576, 14, 1},
+        {"conv5_2/dwise", 576, 14, 1}, {"conv5_3/dwise", 576, 14, 2}, {"conv6_1/dwise", 960, 7, 1},
+        {"conv6_2/dwise", 960, 7, 1},  {"conv6_3/dwise", 960, 7, 1},
+    };
+    BenchmarkDepthwise("quant_mobilenet_v1", mobilenet_v1, iterations);
+    BenchmarkDepthwise("quant_mobilenet_v2", mobilenet_v2, iterations);
+
+    BenchmarkPooling("quant_mobilenet_v1 pool6 (avg)", 1024, 7, 7, 1, 0, 1, iterations);
+    BenchmarkPooling("quant_mobilenet_v2 pool6 (avg)", 1280, 7, 7, 1, 0, 1, iterations);
+    // the mobilenets have no max pooling, this is the stem pooling of quant_resnet50
+    BenchmarkPooling("quant_resnet50 pool1 (max)", 64, 112, 3, 2, 0, 0, iterations);
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char **argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : OMP_CORES_;
+    int iterations = argc > 2 ? atoi(argv[2]) : 100;
+
+    TNN_NS::RunBenchmark(threads, iterations);
+    return 0;
+}
@@ -0,0 +1,164 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Weight memory and latency of dynamic range quantized linear layers on x86, with the int8 weights dequantized
+// at load (fp32 resource and fp32 kernels) and kept int8 (dequantized inside the sgemv, or while the gemm packs
+// them). Batch 1 runs the packed gemv, seq_len rows run the matmul gemm.
+// usage: x86_int8_weight_benchmark [thread_num] [iterations] [seq_len]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/jit/conv_sgemm_driver.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+#include "tnn/utils/omp_utils.h"
+
+#include <xmmintrin.h>
+
+namespace TNN_NS {
+
+// A[rows x K] * B[K x N] of one linear layer
+struct LinearShape {
+    std::string name;
+    int K;
+    int N;
+};
+
+// the workspace is read with aligned loads by the jit kernels
+static std::shared_ptr<float> AlignedAlloc(size_t count) {
+    return std::shared_ptr<float>(static_cast<float *>(_mm_malloc(count * sizeof(float), 32)), _mm_free);
+}
+
+// median latency in ms
+template <typename Func>
+static double MedianLatency(Func func, int iterations) {
+    std::vector<double> times;
+    func();
+    for (int i = 0; i < iterations; ++i) {
+        auto start = std::chrono::steady_clock::now();
+        func();
+        auto stop = std::chrono::steady_clock::now();
+        times.push_back(std::chrono::duration<double, std::milli>(stop - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// the int8 path has to match the fp32 path on the dequantized weights up to rounding
+static float MaxDiff(const std::vector<float> &a, const std::vector<float> &b) {
+    float diff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, std::fabs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+static void RunBenchmark(int threads, int iterations, int seq_len) {
+    printf("threads %d, seq_len %d\n", threads, seq_len);
+    OMP_SET_THREADS_(threads);
+
+    std::vector<LinearShape> shapes = {
+        {"bert.qkv", 768, 2304},     {"bert.attn.out", 768, 768}, {"bert.ffn.in", 768, 3072},
+        {"bert.ffn.out", 3072, 768}, {"resnet50.fc", 2048, 1000}, {"gpt2.lm_head", 768, 50257},
+    };
+
+    std::mt19937 rng(2021);
+    std::normal_distribution<float> normal(0.f, 1.f);
+    double mb_fp32 = 0, mb_int8 = 0;
+    for (const auto &shape : shapes) {
+        const int K = shape.K, N = shape.N, pack = 8;
+        const size_t pack_count = (size_t)ROUND_UP(N, pack) * K;
+
+        // per column symmetric int8 B, and the fp32 B the optimizer used to dequantize it to
+        std::vector<int8_t> b_int8((size_t)K * N);
+        std::vector<float> b((size_t)K * N), scale(ROUND_UP(N, pack), 0.f);
+        for (int n = 0; n < N; ++n) {
+            scale[n] = 0.02f * 3 / 127.f;
+        }
+        for (size_t i = 0; i < b_int8.size(); ++i) {
+            b_int8[i] = (int8_t)std::max(-127.f, std::min(127.f, std::nearbyint(normal(rng) * 127.f / 3)));
+            b[i]      = b_int8[i] * scale[i % N];
+        }
+
+        // batch 1: packed gemv, fp32 or int8 weights
+        std::vector<float> a1(K), c1_fp32(N), c1_int8(N);
+        for (auto &v : a1) {
+            v = normal(rng);
+        }
+        std::vector<float> packed_fp32(pack_count);
+        std::vector<int8_t> packed_int8(pack_count);
+        X86SgemvPackRowMajor(packed_fp32.data(), b.data(), K, N, pack);
+        X86SgemvPackInt8(packed_int8.data(), b_int8.data(), K, N, pack, 1, N);
+        auto plan             = X86SgemvPartition(1, N, K, pack, threads);
+        size_t workspace_size = X86SgemvWorkspaceSize(plan, 1, N, K, pack);
+        auto gemv_workspace   = AlignedAlloc(workspace_size / sizeof(float) + 1);
+        double gemv_fp32_ms   = MedianLatency([&]() {
+            X86Sgemv<Float8, 8>(c1_fp32.data(), a1.data(), packed_fp32.data(), nullptr, {1, K}, {1, N}, plan,
+                                gemv_workspace.get());
+        }, iterations);
+        double gemv_int8_ms = MedianLatency([&]() {
+            X86SgemvInt8<Float8, 8>(c1_int8.data(), a1.data(), packed_int8.data(), scale.data(), nullptr, 1, N, K,
+                                    plan, gemv_workspace.get());
+        }, iterations);
+
+        // seq_len rows: the gemm packs B per block, from fp32 or dequantizing int8
+        std::vector<float> a((size_t)seq_len * K), c_fp32((size_t)seq_len * N), c_int8((size_t)seq_len * N);
+        for (auto &v : a) {
+            v = normal(rng);
+        }
+        conv_gemm_config<float, float, float> conf;
+        size_t workspace_count = ROUND_UP(conf.M_c_ * conf.K_c_, 8) + conf.K_c_ * ROUND_UP(seq_len, conf.n_block_);
+        auto workspace         = AlignedAlloc(workspace_count);
+        std::vector<float> fake_bias(seq_len, 0.f);
+        double gemm_fp32_ms = MedianLatency([&]() {
+            conv_sgemm_nn_col_major(N, seq_len, K, b.data(), N, a.data(), K, c_fp32.data(), N, fake_bias.data(),
+                                    ActivationType_None, workspace.get(), conf);
+        }, iterations);
+        double gemm_int8_ms = MedianLatency([&]() {
+            conv_sgemm_nn_col_major_int8_a(N, seq_len, K, b_int8.data(), N, scale.data(), a.data(), K,
+                                           c_int8.data(), N, fake_bias.data(), ActivationType_None, workspace.get(),
+                                           conf);
+        }, iterations);
+
+        // resident weights: the resource and the packed gemv copy
+        double layer_fp32 = (4.0 * K * N + 4.0 * pack_count) / (1 << 20);
+        double layer_int8 = (1.0 * K * N + 1.0 * pack_count + 4.0 * N) / (1 << 20);
+        printf("%-14s K %4d N %5d | weights %7.2f MB -> %6.2f MB | gemv %7.3f -> %7.3f ms (diff %.1e) | gemm %7.3f "
+               "-> %7.3f ms (diff %.1e)\n",
+               shape.name.c_str(), K, N, layer_fp32, layer_int8, gemv_fp32_ms, gemv_int8_ms,
+               MaxDiff(c1_fp32, c1_int8), gemm_fp32_ms, gemm_int8_ms, MaxDiff(c_fp32, c_int8));
+        mb_fp32 += layer_fp32;
+        mb_int8 += layer_int8;
+    }
+    printf("total weights %.2f MB dequantized at load, %.2f MB kept int8\n", mb_fp32, mb_int8);
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char **argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : OMP_CORES_;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+    int seq_len    = argc > 3 ? atoi(argv[3]) : 128;
+
+    TNN_NS::RunBenchmark(threads, iterations, seq_len);
+    return 0;
+}
@@ -0,0 +1,137 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+// Compares the sse4.2 and avx2 paths of the x86 mat kernels on common resolutions.
+// usage: x86_mat_benchmark [thread_num] [iterations]
+
+#include <cmath>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "test/timer.h"
+#include "tnn/device/x86/acc/compute/x86_mat_util_avx2.h"
+#include "tnn/device/x86/x86_mat_util.h"
+#include "tnn/utils/omp_utils.h"
+
+namespace TNN_NS {
+
+struct Resolution {
+    std::string name;
+    int width;
+    int height;
+};
+
+typedef std::function<void(const uint8_t*, uint8_t*, int, int)> MatKernel;
+
+struct MatBenchCase {
+    std::string name;
+    int src_channel_x2;  // channel * 2, nv12 is 3 bytes per 2 pixels
+    int dst_channel_x2;
+    bool half_dst;
+    MatKernel kernel;
+};
+
+static void RunCase(const MatBenchCase& bench, const Resolution& res, const uint8_t* src, uint8_t* dst, bool avx2,
+                     int threads, int iterations) {
+    X86MatUtilSetAVX2Enabled(avx2);
+    OMP_SET_THREADS_(threads);
+
+    char info[128];
+    snprintf(info, 128, "%s %s %s t%d", bench.name.c_str(), res.name.c_str(), avx2 ? "avx2" : "sse ", threads);
+    test::Timer timer(info);
+
+    bench.kernel(src, dst, res.width, res.height);
+    for (int i = 0; i < iterations; ++i) {
+        timer.Start();
+        bench.kernel(src, dst, res.width, res.height);
+        timer.Stop();
+    }
+    timer.Print();
+}
+
+static int MaxDiff(const std::vector<uint8_t>& a, const std::vector<uint8_t>& b) {
+    int diff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        diff = std::max(diff, std::abs(a[i] - b[i]));
+    }
+    return diff;
+}
+
+static void RunBenchmark(int threads, int iterations) {
+    // rotate 15 degree around the center of a 1920x1080 image
+    static const float transform[2][3] = {{0.9659f, -0.2588f, 312.f}, {0.2588f, 0.9659f, -230.f}};
+
+    std::vector<Resolution> resolutions = {{"720p", 1280, 720}, {"1080p", 1920, 1080}, {"4k", 3840, 2160}};
+    std::vector<MatBenchCase> cases     = {
+        {"NV12ToBGR", 3, 6, false,
+         [](const uint8_t* s, uint8_t* d, int w, int h) { x86::NV12ToBGR(s, d, h, w); }},
+        {"NV12ToBGRA", 3, 8, false,
+         [](const uint8_t* s, uint8_t* d, int w, int h) { x86::NV12ToBGRA(s, d, h, w); }},
+        {"BGRToGray", 6, 2, false,
+         [](const uint8_t* s, uint8_t* d, int w, int h) { x86::BGRToGray(s, d, h, w); }},
+        {"BGRAToGray", 8, 2, false,
+         [](const uint8_t* s, uint8_t* d, int w, int h) { x86::BGRAToGray(s, d, h, w); }},
+        {"ResizeBilinearC1", 2, 2, true,
+         [](const uint8_t* s, uint8_t* d, int w, int h) { x86::ResizeBilinearC1(s, 1, w, h, d, w / 2, h / 2); }},
+        {"ResizeBilinearC3", 6, 6, true,
+         [](const uint8_t* s, uint8_t* d, int w, int h) { x86::ResizeBilinearC3(s, 1, w, h, d, w / 2, h / 2); }},
+        {"WarpAffineBilinearC1", 2, 2, false,
+         [](const uint8_t* s, uint8_t* d, int w, int h) {
+             x86::WarpAffineBilinearC1(s, 1, w, h, d, w, h, transform, 0);
+         }},
+        {"WarpAffineBilinearC3", 6, 6, false,
+         [](const uint8_t* s, uint8_t* d, int w, int h) {
+             x86::WarpAffineBilinearC3(s, 1, w, h, d, w, h, transform, 0);
+         }},
+    };
+
+    for (const auto& res : resolutions) {
+        for (const auto& bench : cases) {
+            size_t src_size = (size_t)res.width * res.height * bench.src_channel_x2 / 2;
+            size_t dst_size = (size_t)res.width * res.height * bench.dst_channel_x2 / 2;
+            if (bench.half_dst) {
+                dst_size = (size_t)(res.width / 2) * (res.height / 2) * bench.dst_channel_x2 / 2;
+            }
+            std::vector<uint8_t> src(src_size);
+            for (size_t i = 0; i < src_size; ++i) {
+                src[i] = (uint8_t)((i * 7 + (i >> 11) * 13) & 0xff);
+            }
+            std::vector<uint8_t> dst_sse(dst_size), dst_avx2(dst_size);
+
+            RunCase(bench, res, src.data(), dst_sse.data(), false, 1, iterations);
+            RunCase(bench, res, src.data(), dst_avx2.data(), true, 1, iterations);
+            if (threads > 1) {
+                RunCase(bench, res, src.data(), dst_avx2.data(), true, threads, iterations);
+            }
+            printf("%s %s max diff sse vs avx2: %d\n", bench.name.c_str(), res.name.c_str(),
+                   MaxDiff(dst_sse, dst_avx2));
+        }
+    }
+}
+
+}  // namespace TNN_NS
+
+int main(int argc, char** argv) {
+    int threads    = argc > 1 ? atoi(argv[1]) : OMP_CORES_;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20;
+
+    if (!TNN_NS::X86MatUtilAVX2Enabled()) {
+        printf("avx2 kernels are not available, both runs use the sse4.2 path\n");
+    }
+    TNN_NS::RunBenchmark(threads, iterations);
+    return 0;
+}
@@ -0,0 +1,191 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <vector>
+
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "test/unit_test/utils/network_test_utils.h"
+#include "tnn/utils/dims_vector_utils.h"
+
+namespace TNN_NS {
+
+// the flatten output lives in the memory of the input x and the concat members in the output cat on x86
+static const char* kBindProto = "\"1 5 1 4206624770 ,\"\n"
+                                "\"x 1 4 8 8 ,\"\n"
+                                "\" a b f cat x ,\"\n"
+                                "\"cat f ,\"\n"
+                                "\" 4 ,\"\n"
+                                "\"Flatten flat 1 1 x f 1 ,\"\n"
+                                "\"ReLU relu 1 1 x a ,\"\n"
+                                "\"Sigmoid sig 1 1 x b ,\"\n"
+                                "\"Concat cat 2 1 a b cat 1 ,\"\n";
+
+class BindMatTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        device_type_ = ConvertDeviceType(FLAGS_dt);
+        if (device_type_ != DEVICE_X86 && device_type_ != DEVICE_NAIVE) {
+            GTEST_SKIP();
+        }
+    }
+
+    Status InitPair(NetworkTestPair& pair, std::set<std::string> external_memory_blobs = {}) {
+        NetworkConfig config;
+        config.device_type           = device_type_;
+        config.precision             = PRECISION_HIGH;
+        config.external_memory_blobs = external_memory_blobs;
+        RETURN_ON_NEQ(pair.Init(GenerateInterpreterFromProto(kBindProto), config, {{"x", {1, 4, 4, 4}}},
+                                {{"x", {1, 4, 8, 8}}}),
+                      TNN_OK);
+        return pair.Reshape({{"x", {1, 4, 8, 8}}});
+    }
+
+    // a float mat on buffer from offset on
+    static std::shared_ptr<Mat> FloatMat(std::vector<float>& buffer, DimsVector dims, int offset = 0) {
+        return std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, dims, buffer.data() + offset);
+    }
+
+    // the output mat of the device instance holds the data written into the bound memory
+    static void ExpectOutput(NetworkTestPair& pair, const std::string& name, const float* bound) {
+        std::shared_ptr<Mat> mat;
+        ASSERT_EQ((int)pair.device_->GetOutputMat(mat, MatConvertParam(), name, DEVICE_NAIVE), TNN_OK);
+        auto data = reinterpret_cast<float*>(mat->GetData());
+        for (int i = 0; i < DimsVectorUtils::Count(mat->GetDims()); ++i) {
+            ASSERT_EQ(data[i], bound[i]) << name << " at " << i;
+        }
+    }
+
+    DeviceType device_type_ = DEVICE_NAIVE;
+};
+
+// the bound blobs take part in the x86 blob aliasing, the layers still see their data
+TEST_F(BindMatTest, AliasedBlobs) {
+    NetworkTestPair pair;
+    ASSERT_EQ((int)InitPair(pair), TNN_OK);
+
+    std::vector<float> x(1 * 4 * 8 * 8), cat(1 * 8 * 8 * 8), f(1 * 256);
+    ASSERT_EQ((int)pair.device_->BindInputMat(FloatMat(x, {1, 4, 8, 8}), "x"), TNN_OK);
+    ASSERT_EQ((int)pair.device_->BindOutputMat(FloatMat(cat, {1, 8, 8, 8}), "cat"), TNN_OK);
+    ASSERT_EQ((int)pair.device_->BindOutputMat(FloatMat(f, {1, 256}), "f"), TNN_OK);
+
+    for (int seed = 0; seed < 2; ++seed) {
+        ASSERT_EQ((int)pair.SetRandomInputs(seed), TNN_OK);
+        ASSERT_EQ((int)pair.Forward(), TNN_OK);
+        EXPECT_EQ((int)pair.Compare(), TNN_OK);
+        ExpectOutput(pair, "cat", cat.data());
+        ExpectOutput(pair, "f", f.data());
+    }
+}
+
+// one layer writing a bound blob would clobber another blob bound to the same memory
+TEST_F(BindMatTest, OverlappingMatsAreRejected) {
+    NetworkTestPair pair;
+    ASSERT_EQ((int)InitPair(pair), TNN_OK);
+
+    std::vector<float> buffer(1 * 8 * 8 * 8 + 256);
+    ASSERT_EQ((int)pair.device_->BindOutputMat(FloatMat(buffer, {1, 8, 8, 8}), "cat"), TNN_OK);
+    EXPECT_EQ((int)pair.device_->BindOutputMat(FloatMat(buffer, {1, 256}, 100), "f"), TNNERR_PARAM_ERR);
+    EXPECT_EQ((int)pair.device_->BindInputMat(FloatMat(buffer, {1, 4, 8, 8}, 8 * 8 * 8 - 1), "x"), TNNERR_PARAM_ERR);
+    // adjacent memory and rebinding the same blob are fine
+    EXPECT_EQ((int)pair.device_->BindOutputMat(FloatMat(buffer, {1, 256}, 8 * 8 * 8), "f"), TNN_OK);
+    EXPECT_EQ((int)pair.device_->BindOutputMat(FloatMat(buffer, {1, 8, 8, 8}), "cat"), TNN_OK);
+
+    ASSERT_EQ((int)pair.SetRandomInputs(0), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(), TNN_OK);
+}
+
+TEST_F(BindMatTest, MismatchedMatsAreRejected) {
+    NetworkTestPair pair;
+    ASSERT_EQ((int)InitPair(pair), TNN_OK);
+
+    std::vector<float> buffer(1 * 8 * 8 * 8);
+    auto device = pair.device_;
+    // dims
+    EXPECT_EQ((int)device->BindInputMat(FloatMat(buffer, {1, 4, 8, 7}), "x"), TNNERR_PARAM_ERR);
+    EXPECT_EQ((int)device->BindInputMat(FloatMat(buffer, {1, 4, 64}), "x"), TNNERR_PARAM_ERR);
+    EXPECT_EQ((int)device->BindOutputMat(FloatMat(buffer, {1, 4, 8, 8}), "cat"), TNNERR_PARAM_ERR);
+    // type
+    auto int32_mat = std::make_shared<Mat>(DEVICE_NAIVE, NC_INT32, DimsVector({1, 4, 8, 8}), buffer.data());
+    EXPECT_EQ((int)device->BindInputMat(int32_mat, "x"), TNNERR_PARAM_ERR);
+    auto bgr_mat = std::make_shared<Mat>(DEVICE_NAIVE, N8UC3, DimsVector({1, 3, 8, 8}), buffer.data());
+    EXPECT_EQ((int)device->BindInputMat(bgr_mat, "x"), TNNERR_PARAM_ERR);
+    // name and data
+    EXPECT_EQ((int)device->BindInputMat(FloatMat(buffer, {1, 4, 8, 8}), "cat"), TNNERR_MODEL_ERR);
+    EXPECT_EQ((int)device->BindOutputMat(FloatMat(buffer, {1, 8, 8, 8}), "a"), TNNERR_MODEL_ERR);
+    EXPECT_EQ((int)device->BindInputMat(std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT), "x"), TNNERR_PARAM_ERR);
+
+    // a binding sized for the old dims is refused at forward after reshape, until it is renewed
+    ASSERT_EQ((int)device->BindInputMat(FloatMat(buffer, {1, 4, 8, 8}), "x"), TNN_OK);
+    ASSERT_EQ((int)pair.Reshape({{"x", {1, 4, 4, 4}}}), TNN_OK);
+    ASSERT_EQ((int)pair.SetRandomInputs(0), TNN_OK);
+    EXPECT_NE((int)device->Forward(), TNN_OK);
+    ASSERT_EQ((int)device->BindInputMat(FloatMat(buffer, {1, 4, 4, 4}), "x"), TNN_OK);
+    ASSERT_EQ((int)pair.SetRandomInputs(1), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(), TNN_OK);
+}
+
+// after unbinding, the blob is back in the forward memory and the mat is no longer written
+TEST_F(BindMatTest, Unbind) {
+    NetworkTestPair pair;
+    ASSERT_EQ((int)InitPair(pair), TNN_OK);
+    auto device = pair.device_;
+
+    std::vector<float> x(1 * 4 * 8 * 8), cat(1 * 8 * 8 * 8);
+    ASSERT_EQ((int)device->BindInputMat(FloatMat(x, {1, 4, 8, 8}), "x"), TNN_OK);
+    ASSERT_EQ((int)device->BindOutputMat(FloatMat(cat, {1, 8, 8, 8}), "cat"), TNN_OK);
+    ASSERT_EQ((int)pair.SetRandomInputs(0), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(), TNN_OK);
+
+    ASSERT_EQ((int)device->UnbindMat("x"), TNN_OK);
+    ASSERT_EQ((int)device->UnbindMat("cat"), TNN_OK);
+    EXPECT_EQ((int)device->UnbindMat("cat"), TNNERR_PARAM_ERR);
+    EXPECT_EQ((int)device->UnbindMat("f"), TNNERR_PARAM_ERR);
+
+    std::vector<float> x_before = x, cat_before = cat;
+    ASSERT_EQ((int)pair.SetRandomInputs(1), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(), TNN_OK);
+    EXPECT_EQ(x, x_before);
+    EXPECT_EQ(cat, cat_before);
+}
+
+// an external memory blob has no forward memory, forward fails whenever it is not bound
+TEST_F(BindMatTest, UnbindExternalMemoryBlob) {
+    NetworkTestPair pair;
+    ASSERT_EQ((int)InitPair(pair, {"x", "cat"}), TNN_OK);
+    auto device = pair.device_;
+    EXPECT_NE((int)device->Forward(), TNN_OK);
+
+    std::vector<float> x(1 * 4 * 8 * 8), cat(1 * 8 * 8 * 8);
+    ASSERT_EQ((int)device->BindInputMat(FloatMat(x, {1, 4, 8, 8}), "x"), TNN_OK);
+    ASSERT_EQ((int)device->BindOutputMat(FloatMat(cat, {1, 8, 8, 8}), "cat"), TNN_OK);
+    ASSERT_EQ((int)pair.SetRandomInputs(0), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(), TNN_OK);
+    ExpectOutput(pair, "cat", cat.data());
+
+    ASSERT_EQ((int)device->UnbindMat("cat"), TNN_OK);
+    EXPECT_NE((int)device->Forward(), TNN_OK);
+    ASSERT_EQ((int)device->BindOutputMat(FloatMat(cat, {1, 8, 8, 8}), "cat"), TNN_OK);
+    EXPECT_EQ((int)device->Forward(), TNN_OK);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,119 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "test/unit_test/utils/network_test_utils.h"
+#include "tnn/core/instance_metrics.h"
+
+namespace TNN_NS {
+
+// three concat members, the middle one is also read by a layer after the concat when second_reader is set
+static std::string ConcatProto(bool second_reader) {
+    std::string proto = "\"1 6 1 4206624770 ,\"\n"
+                        "\"x 1 4 8 8 ,\"\n"
+                        "\" a b c cat e x ,\"\n"
+                        "\"cat e ,\"\n"
+                        "\" 5 ,\"\n"
+                        "\"ReLU relu 1 1 x a ,\"\n"
+                        "\"Sigmoid sig 1 1 x b ,\"\n"
+                        "\"Abs abs 1 1 x c ,\"\n"
+                        "\"Concat cat 3 1 a b c cat 1 ,\"\n";
+    proto += second_reader ? "\"Sigmoid sig2 1 1 b e ,\"\n" : "\"Sigmoid sig2 1 1 x e ,\"\n";
+    return proto;
+}
+
+// the split input is also read by a layer after the split when second_reader is set
+static std::string SplitVProto(bool second_reader) {
+    std::string proto = "\"1 6 1 4206624770 ,\"\n"
+                        "\"x 1 4 8 8 ,\"\n"
+                        "\" a s0 s1 s2 e x ,\"\n"
+                        "\"s0 s1 s2 e ,\"\n"
+                        "\" 3 ,\"\n"
+                        "\"ReLU relu 1 1 x a ,\"\n"
+                        "\"SplitV split 1 3 a s0 s1 s2 1 3 1 1 2 ,\"\n";
+    proto += second_reader ? "\"Sigmoid sig 1 1 a e ,\"\n" : "\"Sigmoid sig 1 1 x e ,\"\n";
+    return proto;
+}
+
+// the split input is a view of the reshape input, which is also read by a layer after the split when second_reader
+// is set
+static std::string ReshapeSplitVProto(bool second_reader) {
+    std::string proto = "\"1 7 1 4206624770 ,\"\n"
+                        "\"x 1 4 8 8 ,\"\n"
+                        "\" a r s0 s1 s2 e x ,\"\n"
+                        "\"s0 s1 s2 e ,\"\n"
+                        "\" 4 ,\"\n"
+                        "\"ReLU relu 1 1 x a ,\"\n"
+                        "\"Reshape reshape 1 1 a r 0 4 4 0 4 -1 1 0 ,\"\n"
+                        "\"SplitV split 1 3 r s0 s1 s2 1 3 1 1 2 ,\"\n";
+    proto += second_reader ? "\"Sigmoid sig 1 1 a e ,\"\n" : "\"Sigmoid sig 1 1 x e ,\"\n";
+    return proto;
+}
+
+class BlobAliasTest : public ::testing::TestWithParam<bool> {
+protected:
+    void SetUp() override {
+        if (ConvertDeviceType(FLAGS_dt) != DEVICE_X86) {
+            GTEST_SKIP();
+        }
+    }
+
+    // init at the max shape, then run and compare at each of shapes
+    void RunShapes(const std::string& proto, std::vector<DimsVector> shapes, bool expect_alias) {
+        NetworkConfig config;
+        config.device_type = DEVICE_X86;
+        config.precision   = PRECISION_HIGH;
+
+        NetworkTestPair pair;
+        ASSERT_EQ((int)pair.Init(GenerateInterpreterFromProto(proto), config, {{"x", {1, 4, 1, 1}}},
+                                 {{"x", {1, 4, 8, 8}}}),
+                  TNN_OK);
+
+        InstanceMetrics metrics;
+        ASSERT_EQ((int)pair.device_->GetMetrics(metrics), TNN_OK);
+        EXPECT_EQ(metrics.aliased_copy_bytes > 0, expect_alias);
+
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            ASSERT_EQ((int)pair.Reshape({{"x", shapes[i]}}), TNN_OK);
+            ASSERT_EQ((int)pair.SetRandomInputs((int)i), TNN_OK);
+            ASSERT_EQ((int)pair.Forward(), TNN_OK);
+            EXPECT_EQ((int)pair.Compare(), TNN_OK) << "shape " << i;
+        }
+    }
+};
+
+INSTANTIATE_TEST_SUITE_P(BlobAliasTest, BlobAliasTest, ::testing::Values(false, true));
+
+TEST_P(BlobAliasTest, ConcatMembers) {
+    bool second_reader = GetParam();
+    // shrinking moves the members down over each other inside the concat output
+    RunShapes(ConcatProto(second_reader), {{1, 4, 8, 8}, {1, 4, 4, 4}, {1, 4, 3, 5}, {1, 4, 8, 8}}, !second_reader);
+}
+
+TEST_P(BlobAliasTest, SplitVOutputs) {
+    bool second_reader = GetParam();
+    RunShapes(SplitVProto(second_reader), {{1, 4, 8, 8}, {1, 4, 4, 4}, {1, 4, 3, 5}, {1, 4, 8, 8}}, !second_reader);
+}
+
+// the reshape output is aliased either way, the split outputs only without the second reader. shrinking a little
+// moves the later split outputs over data the reshape input still holds
+TEST_P(BlobAliasTest, ReshapeSplitVOutputs) {
+    bool second_reader = GetParam();
+    RunShapes(ReshapeSplitVProto(second_reader), {{1, 4, 8, 8}, {1, 4, 6, 8}, {1, 4, 3, 5}, {1, 4, 8, 8}}, true);
+}
+
+}  // namespace TNN_NS
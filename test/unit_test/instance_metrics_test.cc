@@ -0,0 +1,206 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <cstdlib>
+#include <map>
+#include <regex>
+#include <sstream>
+#include <vector>
+
+#include "examples/base/tnn_metrics_exporter.h"
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "test/unit_test/utils/network_test_utils.h"
+#include "tnn/core/instance_metrics.h"
+
+namespace TNN_NS {
+
+static const char* kMetricsProto = "\"1 2 1 4206624770 ,\"\n"
+                                   "\"x 1 4 8 8 ,\"\n"
+                                   "\" a y x ,\"\n"
+                                   "\"y ,\"\n"
+                                   "\" 2 ,\"\n"
+                                   "\"ReLU relu 1 1 x a ,\"\n"
+                                   "\"Sigmoid sig 1 1 a y ,\"\n";
+
+static uint64_t BucketSum(const LatencyHistogram& histogram) {
+    uint64_t sum = 0;
+    for (int i = 0; i < LatencyHistogram::kBucketCount; ++i) {
+        sum += histogram.buckets[i];
+    }
+    return sum;
+}
+
+TEST(InstanceMetricsTest, BucketBounds) {
+    for (int i = 1; i < LatencyHistogram::kBucketCount - 1; ++i) {
+        EXPECT_GT(LatencyHistogram::GetBucketBoundUs(i), LatencyHistogram::GetBucketBoundUs(i - 1));
+    }
+    EXPECT_EQ(LatencyHistogram::GetBucketBoundUs(0), 50);
+    EXPECT_EQ(LatencyHistogram::GetBucketBoundUs(LatencyHistogram::kBucketCount - 2), 1000000);
+    EXPECT_LT(LatencyHistogram::GetBucketBoundUs(LatencyHistogram::kBucketCount - 1), 0);
+    EXPECT_LT(LatencyHistogram::GetBucketBoundUs(-1), 0);
+}
+
+// every phase adds one sample to its histogram, failed forwards are counted as forwards and errors
+TEST(InstanceMetricsTest, CountersAndHistograms) {
+    DeviceType device_type = ConvertDeviceType(FLAGS_dt);
+    if (device_type != DEVICE_X86 && device_type != DEVICE_NAIVE) {
+        GTEST_SKIP();
+    }
+    NetworkConfig config;
+    config.device_type           = device_type;
+    config.external_memory_blobs = {"x"};
+
+    NetworkTestPair pair;
+    ASSERT_EQ((int)pair.Init(GenerateInterpreterFromProto(kMetricsProto), config), TNN_OK);
+    auto instance = pair.device_;
+    ASSERT_EQ((int)instance->ResetMetrics(), TNN_OK);
+
+    // x is not bound yet
+    EXPECT_NE((int)instance->Forward(), TNN_OK);
+
+    auto x     = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, DimsVector({1, 4, 8, 8}));
+    auto bound = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, DimsVector({1, 4, 8, 8}));
+    ASSERT_EQ((int)instance->BindInputMat(bound, "x"), TNN_OK);
+    const int forwards = 3;
+    for (int i = 0; i < forwards; ++i) {
+        ASSERT_EQ((int)instance->SetInputMat(x, MatConvertParam(), "x"), TNN_OK);
+        ASSERT_EQ((int)instance->Forward(), TNN_OK);
+        std::shared_ptr<Mat> y;
+        ASSERT_EQ((int)instance->GetOutputMat(y, MatConvertParam(), "y", DEVICE_NAIVE), TNN_OK);
+    }
+    ASSERT_EQ((int)instance->Reshape({{"x", {1, 4, 8, 8}}}), TNN_OK);
+
+    InstanceMetrics metrics;
+    ASSERT_EQ((int)instance->GetMetrics(metrics), TNN_OK);
+    EXPECT_EQ(metrics.forward_count, forwards + 1);
+    EXPECT_EQ(metrics.forward_error_count, 1);
+    EXPECT_EQ(metrics.reshape_count, 1);
+    EXPECT_GT(metrics.forward_memory_bytes, 0);
+
+    const LatencyHistogram* histograms[] = {&metrics.convert_in_latency, &metrics.forward_latency,
+                                            &metrics.convert_out_latency};
+    const uint64_t counts[]              = {forwards, forwards + 1, forwards};
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_EQ(histograms[i]->count, counts[i]) << "histogram " << i;
+        EXPECT_EQ(BucketSum(*histograms[i]), counts[i]) << "histogram " << i;
+        EXPECT_GT(histograms[i]->sum_us, 0) << "histogram " << i;
+    }
+
+    ASSERT_EQ((int)instance->ResetMetrics(), TNN_OK);
+    ASSERT_EQ((int)instance->GetMetrics(metrics), TNN_OK);
+    EXPECT_EQ(metrics.forward_count, 0);
+    EXPECT_EQ(metrics.forward_error_count, 0);
+    EXPECT_EQ(metrics.reshape_count, 0);
+    EXPECT_EQ(metrics.forward_latency.count, 0);
+    EXPECT_EQ(BucketSum(metrics.forward_latency), 0);
+    EXPECT_EQ(metrics.forward_latency.sum_us, 0);
+    // the planned memory is a gauge and stays
+    EXPECT_GT(metrics.forward_memory_bytes, 0);
+}
+
+// the output follows the prometheus text exposition format 0.0.4
+TEST(InstanceMetricsTest, PrometheusExpositionFormat) {
+    InstanceMetrics metrics;
+    metrics.forward_count        = 7;
+    metrics.forward_error_count  = 1;
+    metrics.forward_memory_bytes = 123456789;
+    // 2 samples <= 50us, 3 <= 250us, 1 above 1s
+    metrics.forward_latency.buckets[0]                                = 2;
+    metrics.forward_latency.buckets[2]                                = 3;
+    metrics.forward_latency.buckets[LatencyHistogram::kBucketCount - 1] = 1;
+    metrics.forward_latency.count                                     = 6;
+    metrics.forward_latency.sum_us                                    = 2000500;
+
+    TNNMetricsExporter exporter("tnn", {{"model", "a \"quoted\\ name\nx"}, {"device", "x86"}});
+    std::string text = exporter.Format(metrics);
+    ASSERT_FALSE(text.empty());
+    ASSERT_EQ(text.back(), '\n');
+
+    const std::regex help_line("# HELP ([a-zA-Z_:][a-zA-Z0-9_:]*) [^\\n]*");
+    const std::regex type_line("# TYPE ([a-zA-Z_:][a-zA-Z0-9_:]*) (counter|gauge|histogram|summary|untyped)");
+    const std::string label   = "[a-zA-Z_][a-zA-Z0-9_]*=\"([^\"\\\\\\n]|\\\\[\\\\\"n])*\"";
+    const std::regex sample_line("([a-zA-Z_:][a-zA-Z0-9_:]*)(\\{" + label + "(," + label + ")*\\})? (\\S+)");
+
+    std::map<std::string, std::string> types;
+    std::map<std::string, std::string> samples;
+    std::vector<double> bucket_bounds;
+    std::vector<double> bucket_counts;
+    std::string current;
+    std::istringstream stream(text);
+    std::string line;
+    while (std::getline(stream, line)) {
+        std::smatch match;
+        if (std::regex_match(line, match, help_line)) {
+            current = match[1];
+            // HELP comes first and once per metric
+            EXPECT_EQ(types.count(current), 0) << line;
+        } else if (std::regex_match(line, match, type_line)) {
+            EXPECT_EQ(match[1], current) << line;
+            types[current] = match[2];
+        } else if (std::regex_match(line, match, sample_line)) {
+            std::string name = match[1];
+            // samples follow the TYPE of their metric, histograms add the _bucket, _sum and _count suffixes
+            bool own_metric = name == current;
+            if (types[current] == "histogram") {
+                own_metric = name == current + "_bucket" || name == current + "_sum" || name == current + "_count";
+            }
+            EXPECT_TRUE(own_metric) << line;
+            EXPECT_NE(line.find("model=\"a \\\"quoted\\\\ name\\nx\""), std::string::npos) << line;
+            EXPECT_NE(line.find("device=\"x86\""), std::string::npos) << line;
+
+            std::string value = match[match.size() - 1];
+            char* end         = nullptr;
+            std::strtod(value.c_str(), &end);
+            EXPECT_EQ(*end, '\0') << line;
+            if (name == "tnn_forward_seconds_bucket") {
+                auto le_begin = line.find("le=\"") + 4;
+                auto le       = line.substr(le_begin, line.find('"', le_begin) - le_begin);
+                bucket_bounds.push_back(le == "+Inf" ? INFINITY : std::strtod(le.c_str(), nullptr));
+                bucket_counts.push_back(std::strtod(value.c_str(), nullptr));
+            } else if (name.find("_bucket") == std::string::npos) {
+                samples[name] = value;
+            }
+        } else {
+            ADD_FAILURE() << "not in the exposition format: " << line;
+        }
+    }
+
+    EXPECT_EQ(types["tnn_forward_total"], "counter");
+    EXPECT_EQ(types["tnn_forward_memory_bytes"], "gauge");
+    EXPECT_EQ(types["tnn_forward_seconds"], "histogram");
+    EXPECT_EQ(samples["tnn_forward_total"], "7");
+    EXPECT_EQ(samples["tnn_forward_errors_total"], "1");
+    EXPECT_EQ(samples["tnn_forward_memory_bytes"], "123456789");
+    EXPECT_EQ(samples["tnn_forward_seconds_count"], "6");
+    EXPECT_NEAR(std::strtod(samples["tnn_forward_seconds_sum"].c_str(), nullptr), 2.0005, 1e-9);
+
+    // buckets are cumulative in seconds with increasing bounds, the +Inf one holds all samples
+    ASSERT_EQ((int)bucket_bounds.size(), (int)LatencyHistogram::kBucketCount);
+    EXPECT_DOUBLE_EQ(bucket_bounds[0], 50e-6);
+    EXPECT_EQ(bucket_bounds.back(), INFINITY);
+    for (size_t i = 1; i < bucket_bounds.size(); ++i) {
+        EXPECT_GT(bucket_bounds[i], bucket_bounds[i - 1]);
+        EXPECT_GE(bucket_counts[i], bucket_counts[i - 1]);
+    }
+    EXPECT_EQ(bucket_counts[0], 2);
+    EXPECT_EQ(bucket_counts[2], 5);
+    EXPECT_EQ(bucket_counts[LatencyHistogram::kBucketCount - 2], 5);
+    EXPECT_EQ(bucket_counts.back(), 6);
+}
+
+}  // namespace TNN_NS
@@ -150,6 +150,9 @@ Status LayerTest::Init(std::shared_ptr<AbstractModelInterpreter> interp, Precisi
         LOGE("tnn init cpu instance failed (%s)\n", ret.description().c_str());
         return ret;
     }
+    // the naive reference gives the same result for any thread count
+    ret = instance_cpu_->SetCpuNumThreads(std::max(FLAGS_th, 1));
+    RETURN_ON_NEQ(ret, TNN_OK);
     ret = instance_device_->Init(instance_cpu_->GetInterpreter(), input_shape);
     if (ret != TNN_OK) {
         LOGE("tnn init device instance failed (%s)\n", ret.description().c_str());
@@ -176,15 +179,23 @@ Status LayerTest::Init(std::shared_ptr<AbstractModelInterpreter> interp, Precisi
 Status LayerTest::Forward() {
     TNN_NS::Status ret = TNN_NS::TNN_OK;
 
+    test::Timer cpu_timer("cpu");
 #ifndef TNN_UNIT_TEST_BENCHMARK
+    cpu_timer.Start();
     ret = instance_cpu_->Forward();
     EXPECT_EQ_OR_RETURN(ret, TNN_OK);
+    cpu_timer.Stop();
 #endif
 
 #if TNN_PROFILE && defined(TNN_UNIT_TEST_BENCHMARK)
     instance_device_->StartProfile();
 #endif
 
+    for (int i = 0; i < FLAGS_wc; ++i) {
+        ret = instance_device_->Forward();
+        EXPECT_EQ_OR_RETURN(ret, TNN_OK);
+    }
+
     test::Timer timer("device " + FLAGS_dt);
     for (int i = 0; i < FLAGS_ic; ++i) {
         timer.Start();
@@ -207,9 +218,32 @@ Status LayerTest::Forward() {
         timer.Print();
     }
 
+    CasePerf perf;
+    perf.device_ms = timer.GetMin();
+    perf.naive_ms  = cpu_timer.GetMin();
+    RecordPerf(perf);
+
     return ret;
 }
 
+void LayerTest::RecordPerf(const CasePerf& perf) {
+    if (FLAGS_jp.empty() && FLAGS_perf_baseline.empty()) {
+        return;
+    }
+    auto test_info = ::testing::UnitTest::GetInstance()->current_test_info();
+    auto key       = PerfRecorder::GetInstance().Record(
+        std::string(test_info->test_suite_name()) + "." + test_info->name(), perf);
+    printf("perf %s: device %.3f ms  naive %.3f ms\n", key.c_str(), perf.device_ms, perf.naive_ms);
+
+    // cases this short are dominated by timer and scheduling noise
+    const double min_baseline_ms = 0.05;
+    double slowdown              = 1.0;
+    if (!FLAGS_perf_baseline.empty() && PerfRecorder::GetInstance().Compare(key, perf, min_baseline_ms, slowdown)) {
+        EXPECT_LE(slowdown, 1.0 + FLAGS_perf_threshold)
+            << key << " is " << (slowdown - 1.0) * 100 << "% slower than the perf baseline";
+    }
+}
+
 Status LayerTest::Compare() {
     BlobMap output_blobs_cpu;
     BlobMap output_blobs_device;
@@ -21,6 +21,7 @@
 #include "test/test_utils.h"
 #include "test/unit_test/layer_test/layer_test_utils.h"
 #include "test/unit_test/unit_test_macro.h"
+#include "test/unit_test/utils/perf_recorder.h"
 #include "tnn/core/abstract_device.h"
 #include "tnn/core/common.h"
 #include "tnn/core/context.h"
@@ -68,6 +69,9 @@ private:
     int CompareDims(DimsVector dims_a, DimsVector dims_b);
 
     Status InitInputBlobsDataRandom();
+
+    // @brief record the forward times and check them against the perf baseline
+    void RecordPerf(const CasePerf& perf);
 };
 
 }  // namespace TNN_NS
@@ -15,6 +15,7 @@
 #include "test/unit_test/layer_test/layer_test.h"
 #include "test/unit_test/unit_test_common.h"
 #include "test/unit_test/utils/network_helpers.h"
+#include "test/unit_test/utils/network_test_utils.h"
 #include "tnn/utils/cpu_utils.h"
 #include "tnn/utils/dims_utils.h"
 
@@ -105,4 +106,42 @@ TEST_P(ConvLayerTest, ConvLayer) {
     Run(interpreter, precision);
 }
 
+// the x86 gemm blocking follows the input shape, a reshape to a larger or smaller input recomputes it
+TEST(ConvReshapeTest, BlockingFollowsShape) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    const int channel = 32;
+    for (int kernel : {1, 3}) {
+        std::shared_ptr<ConvLayerParam> param(new ConvLayerParam());
+        param->name            = "Conv";
+        param->input_channel   = channel;
+        param->output_channel  = 48;
+        param->group           = 1;
+        param->kernels         = {kernel, kernel};
+        param->dialations      = {1, 1};
+        param->strides         = {1, 1};
+        param->pads            = {kernel / 2, kernel / 2, kernel / 2, kernel / 2};
+        param->pad_type        = -1;
+        param->bias            = 1;
+        param->activation_type = ActivationType_ReLU;
+
+        NetworkConfig config;
+        config.device_type = DEVICE_X86;
+        config.precision   = PRECISION_HIGH;
+
+        NetworkTestPair pair;
+        auto interpreter = GenerateInterpreter("Convolution", {{1, channel, 64, 64}}, param);
+        ASSERT_EQ((int)pair.Init(interpreter, config, {{"input0", {1, channel, 2, 3}}},
+                                 {{"input0", {1, channel, 64, 64}}}),
+                  TNN_OK);
+        for (auto shape : std::vector<DimsVector>({{1, channel, 2, 3}, {1, channel, 64, 64}, {1, channel, 7, 5}})) {
+            ASSERT_EQ((int)pair.Reshape({{"input0", shape}}), TNN_OK);
+            ASSERT_EQ((int)pair.SetRandomInputs(shape[2]), TNN_OK);
+            ASSERT_EQ((int)pair.Forward(), TNN_OK);
+            EXPECT_EQ((int)pair.Compare(0.001f), TNN_OK);
+        }
+    }
+}
+
 }  // namespace TNN_NS
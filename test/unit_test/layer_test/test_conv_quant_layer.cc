@@ -22,7 +22,13 @@ namespace TNN_NS {
 
 class ConvQuantLayerTest : public LayerTest,
                            public ::testing::WithParamInterface<std::tuple<int, int, int, int, int, int, int, DataType,
-                                                                           ActivationType, FusionType>> {};
+                                                                           ActivationType, FusionType>> {
+protected:
+    void RunConvQuantTest();
+};
+
+// depthwise conv with enough channels for the 16 channel x86 kernels
+class ConvQuantDepthwiseLayerTest : public ConvQuantLayerTest {};
 
 INSTANTIATE_TEST_SUITE_P(LayerTest, ConvQuantLayerTest,
                          ::testing::Combine(testing::Values(1), 
@@ -44,7 +50,27 @@ INSTANTIATE_TEST_SUITE_P(LayerTest, ConvQuantLayerTest,
                                             testing::Values(FusionType_None, FusionType_Conv_Add_Activation,
                                                             FusionType_Conv_Activation_Add)));
 
-TEST_P(ConvQuantLayerTest, ConvLayer) {
+INSTANTIATE_TEST_SUITE_P(LayerTest, ConvQuantDepthwiseLayerTest,
+                         ::testing::Combine(testing::Values(1),
+                                            testing::Values(1),
+                                            testing::Values(9, 14),
+                                            // kernel
+                                            testing::Values(3, 5),
+                                            // stride
+                                            testing::Values(1, 2),
+                                            // group
+                                            testing::Values(16, 20, 36),
+                                            // dilation
+                                            testing::Values(1, 2),
+                                            // data_type
+                                            testing::Values(DATA_TYPE_INT8),
+                                            // activation_type
+                                            testing::Values(ActivationType_None, ActivationType_ReLU, ActivationType_ReLU6),
+                                            // fusion_type
+                                            testing::Values(FusionType_None, FusionType_Conv_Add_Activation,
+                                                            FusionType_Conv_Activation_Add)));
+
+void ConvQuantLayerTest::RunConvQuantTest() {
     // get param
     int batch             = std::get<0>(GetParam());
     int channel_per_group = std::get<1>(GetParam());
@@ -64,8 +90,9 @@ TEST_P(ConvQuantLayerTest, ConvLayer) {
     }
 
     if (fusion_type != FusionType_None) {
-        // only int8 data type support conv add fusion
-        if (group != 1 || data_type != DATA_TYPE_INT8) {
+        // only int8 data type support conv add fusion, x86 also fuses it into depthwise conv
+        bool x86_depthwise = channel_per_group == 1 && DEVICE_X86 == dev;
+        if ((group != 1 && !x86_depthwise) || data_type != DATA_TYPE_INT8) {
             GTEST_SKIP();
         }
     }
@@ -126,4 +153,12 @@ TEST_P(ConvQuantLayerTest, ConvLayer) {
     Run(interpreter, precision);
 }
 
+TEST_P(ConvQuantLayerTest, ConvLayer) {
+    RunConvQuantTest();
+}
+
+TEST_P(ConvQuantDepthwiseLayerTest, ConvLayer) {
+    RunConvQuantTest();
+}
+
 }  // namespace TNN_NS
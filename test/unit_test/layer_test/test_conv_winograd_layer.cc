@@ -0,0 +1,67 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_helpers.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+// wide 3x3 stride 1 conv, covers the larger winograd tiles selected by channels and size
+class ConvWinogradLayerTest : public LayerTest,
+                              public ::testing::WithParamInterface<std::tuple<int, int, int, int, ActivationType>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, ConvWinogradLayerTest,
+                         ::testing::Combine(  // batch
+                             testing::Values(1, 2),
+                             // input channel
+                             testing::Values(32, 64, 96),
+                             // output channel
+                             testing::Values(36, 64, 128),
+                             // hw
+                             testing::Values(7, 14, 23, 30),
+                             // activation_type
+                             testing::Values(ActivationType_None, ActivationType_ReLU)));
+
+TEST_P(ConvWinogradLayerTest, ConvLayer) {
+    // get param
+    int batch           = std::get<0>(GetParam());
+    int input_channel   = std::get<1>(GetParam());
+    int output_channel  = std::get<2>(GetParam());
+    int input_size      = std::get<3>(GetParam());
+    int activation_type = std::get<4>(GetParam());
+    DeviceType dev      = ConvertDeviceType(FLAGS_dt);
+
+    // param
+    std::shared_ptr<ConvLayerParam> param(new ConvLayerParam());
+    param->name            = "Conv";
+    param->input_channel   = input_channel;
+    param->output_channel  = output_channel;
+    param->group           = 1;
+    param->kernels         = {3, 3};
+    param->dialations      = {1, 1};
+    param->strides         = {1, 1};
+    param->pads            = {1, 1, 1, 1};
+    param->bias            = 1;
+    param->activation_type = activation_type;
+
+    // generate interpreter
+    Precision precision         = SetPrecision(dev, DATA_TYPE_FLOAT);
+    std::vector<int> input_dims = {batch, input_channel, input_size, input_size};
+    auto interpreter            = GenerateInterpreter("Convolution", {input_dims}, param);
+    Run(interpreter, precision);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,143 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <sstream>
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/utils/network_test_utils.h"
+
+namespace TNN_NS {
+
+// depthwise 3x3 conv followed by a 1x1 conv, both with activation act
+static std::string DwPwProto(int channel, int output_channel, int height, int width, int stride, int act,
+                             bool dw_output_is_read_again) {
+    std::ostringstream proto;
+    proto << "\"1 4 1 4206624770 ,\"\n";
+    proto << "\"x 1 " << channel << " " << height << " " << width << " ,\"\n";
+    proto << "\" d p r x ,\"\n";
+    proto << (dw_output_is_read_again ? "\"p r ,\"\n" : "\"p ,\"\n");
+    proto << (dw_output_is_read_again ? "\" 3 ,\"\n" : "\" 2 ,\"\n");
+    proto << "\"Convolution dw 1 1 x d " << channel << " " << channel << " " << channel << " 3 3 " << stride << " "
+          << stride << " 1 1 1 -1 1 1 " << act << " ,\"\n";
+    proto << "\"Convolution pw 1 1 d p 1 " << channel << " " << output_channel << " 1 1 1 1 0 0 1 -1 1 1 " << act
+          << " ,\"\n";
+    if (dw_output_is_read_again) {
+        proto << "\"ReLU relu 1 1 d r ,\"\n";
+    }
+    return proto.str();
+}
+
+static int CountLayers(std::shared_ptr<AbstractModelInterpreter> interpreter, LayerType type) {
+    auto structure = dynamic_cast<DefaultModelInterpreter *>(interpreter.get())->GetNetStructure();
+    int count      = 0;
+    for (auto layer : structure->layers) {
+        count += layer->type == type ? 1 : 0;
+    }
+    return count;
+}
+
+class DwPwFusedConvLayerTest : public ::testing::TestWithParam<std::tuple<int, int, int, int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, DwPwFusedConvLayerTest,
+                         ::testing::Combine(
+                             // channel
+                             testing::Values(8, 13, 32),
+                             // output channel
+                             testing::Values(16, 27),
+                             // input size
+                             testing::Values(9, 30),
+                             // stride
+                             testing::Values(1, 2),
+                             // activation
+                             testing::Values(ActivationType_None, ActivationType_ReLU, ActivationType_ReLU6)));
+
+// the fused x86 layer against the separate naive convs
+TEST_P(DwPwFusedConvLayerTest, DwPwFusedConvLayer) {
+    int channel        = std::get<0>(GetParam());
+    int output_channel = std::get<1>(GetParam());
+    int size           = std::get<2>(GetParam());
+    int stride         = std::get<3>(GetParam());
+    int act            = std::get<4>(GetParam());
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+
+    NetworkConfig config;
+    config.device_type            = DEVICE_X86;
+    config.precision              = PRECISION_HIGH;
+    config.enable_fuse_dw_pw_conv = true;
+
+    NetworkTestPair pair;
+    auto proto = DwPwProto(channel, output_channel, size, size + 3, stride, act, false);
+    ASSERT_EQ((int)pair.Init(GenerateInterpreterFromProto(proto), config), TNN_OK);
+    EXPECT_EQ(CountLayers(pair.device_->GetInterpreter(), LAYER_DW_PW_FUSED_CONV), 1);
+
+    ASSERT_EQ((int)pair.SetRandomInputs(channel), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(0.001f), TNN_OK);
+}
+
+// a depthwise output read by another layer stays unfused
+TEST(DwPwFusedConvTest, SecondReaderIsNotFused) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    NetworkConfig config;
+    config.device_type            = DEVICE_X86;
+    config.precision              = PRECISION_HIGH;
+    config.enable_fuse_dw_pw_conv = true;
+
+    NetworkTestPair pair;
+    auto proto = DwPwProto(16, 24, 12, 12, 1, ActivationType_ReLU, true);
+    ASSERT_EQ((int)pair.Init(GenerateInterpreterFromProto(proto), config), TNN_OK);
+    EXPECT_EQ(CountLayers(pair.device_->GetInterpreter(), LAYER_DW_PW_FUSED_CONV), 0);
+
+    ASSERT_EQ((int)pair.SetRandomInputs(0), TNN_OK);
+    ASSERT_EQ((int)pair.Forward(), TNN_OK);
+    EXPECT_EQ((int)pair.Compare(0.001f), TNN_OK);
+}
+
+// the fusion is opt-in, by default the depthwise output stays a blob of the network
+TEST(DwPwFusedConvTest, NotFusedByDefault) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    NetworkConfig config;
+    config.device_type = DEVICE_X86;
+    config.precision   = PRECISION_HIGH;
+
+    NetworkTestPair pair;
+    auto proto = DwPwProto(16, 24, 12, 12, 1, ActivationType_ReLU, false);
+    ASSERT_EQ((int)pair.Init(GenerateInterpreterFromProto(proto), config), TNN_OK);
+    EXPECT_EQ(CountLayers(pair.device_->GetInterpreter(), LAYER_DW_PW_FUSED_CONV), 0);
+}
+
+// a model without weights gets random resources at layer init, after the optimizer ran
+TEST(DwPwFusedConvTest, GeneratedResource) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    NetworkConfig config;
+    config.device_type            = DEVICE_X86;
+    config.enable_fuse_dw_pw_conv = true;
+    ModelConfig model_config;
+    model_config.params = {"", ""};
+
+    Instance instance(config, model_config);
+    auto proto = DwPwProto(16, 24, 12, 12, 1, ActivationType_ReLU, false);
+    ASSERT_EQ((int)instance.Init(GenerateInterpreterFromProto(proto), InputShapesMap()), TNN_OK);
+    EXPECT_EQ((int)instance.Forward(), TNN_OK);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,234 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <cmath>
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_test_utils.h"
+
+namespace TNN_NS {
+
+// int8 weights of count values, and scale_count scales
+static void GenerateInt8Weight(int count, int scale_count, const DimsVector &dims, RawBuffer &weight,
+                               RawBuffer &scale) {
+    weight = RawBuffer(count);
+    InitRandom(weight.force_to<int8_t *>(), count, (int8_t)-127, (int8_t)127);
+    weight.SetDataType(DATA_TYPE_INT8);
+    weight.SetBufferDims(dims);
+
+    scale = RawBuffer(scale_count * sizeof(float));
+    InitRandom(scale.force_to<float *>(), scale_count, 0.002f, 0.01f);
+    scale.SetDataType(DATA_TYPE_FLOAT);
+    scale.SetBufferDims({scale_count});
+}
+
+// the x86 device runs the int8 weights, the naive reference their dequantized fp32 copy
+static Status RunDynamicRange(std::shared_ptr<AbstractModelInterpreter> ref_interp,
+                              std::shared_ptr<AbstractModelInterpreter> device_interp, Precision precision, float ep,
+                              float dp) {
+    NetworkConfig config;
+    config.device_type = DEVICE_X86;
+    config.precision   = precision;
+
+    NetworkTestPair pair;
+    RETURN_ON_NEQ(pair.Init(ref_interp, device_interp, config), TNN_OK);
+    RETURN_ON_NEQ(pair.SetRandomInputs(0), TNN_OK);
+    RETURN_ON_NEQ(pair.Forward(), TNN_OK);
+    return pair.Compare(ep, dp);
+}
+
+// the dynamic gemm rounds the activations of a row to 1/254 of its range, the absolute error of a dot product of
+// depth k grows with sqrt(k)
+static float Tolerance(Precision precision, int k) {
+    return precision == PRECISION_LOW ? 0.01f * std::sqrt((float)k) : 0.001f;
+}
+
+class DynamicRangeInnerProductLayerTest
+    : public ::testing::TestWithParam<std::tuple<int, int, int, int, bool, DataType, Precision>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, DynamicRangeInnerProductLayerTest,
+                         ::testing::Combine(
+                             // batch, 1 runs the sgemv and 8 the sgemm of the fp32 path
+                             testing::Values(1, 8),
+                             // input channel
+                             testing::Values(3, 32),
+                             // input size
+                             testing::Values(2, 7),
+                             // output channel
+                             testing::Values(4, 21, 50),
+                             // per channel scales
+                             testing::Values(false, true),
+                             // bias data type
+                             testing::Values(DATA_TYPE_FLOAT, DATA_TYPE_HALF),
+                             // low precision runs the dynamic int8 gemm, auto the fp32 kernels on the int8 weights
+                             testing::Values(PRECISION_LOW, PRECISION_AUTO)));
+
+TEST_P(DynamicRangeInnerProductLayerTest, DynamicRangeInnerProductLayer) {
+    int batch           = std::get<0>(GetParam());
+    int input_channel   = std::get<1>(GetParam());
+    int input_size      = std::get<2>(GetParam());
+    int output_channel  = std::get<3>(GetParam());
+    bool per_channel    = std::get<4>(GetParam());
+    DataType bias_dtype = std::get<5>(GetParam());
+    Precision precision = std::get<6>(GetParam());
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    const int k = input_channel * input_size * input_size;
+
+    std::shared_ptr<InnerProductLayerResource> resource(new InnerProductLayerResource());
+    GenerateInt8Weight(output_channel * k, per_channel ? output_channel : 1, {output_channel, k},
+                       resource->weight_handle, resource->scale_handle);
+    RawBuffer bias(output_channel * sizeof(float), {output_channel});
+    InitRandom(bias.force_to<float *>(), output_channel, 1.0f);
+    resource->bias_handle = bias_dtype == DATA_TYPE_HALF ? ConvertFloatToFP16(bias) : bias;
+
+    std::shared_ptr<InnerProductLayerResource> ref_resource(new InnerProductLayerResource());
+    ref_resource->weight_handle = ConvertInt8Handle(resource->weight_handle, resource->scale_handle, k);
+    ref_resource->bias_handle   = ConvertHalfHandle(resource->bias_handle);
+
+    std::vector<std::shared_ptr<InnerProductLayerParam>> params;
+    for (bool dynamic_range : {false, true}) {
+        std::shared_ptr<InnerProductLayerParam> param(new InnerProductLayerParam());
+        param->name                    = "InnerProduct";
+        param->num_output              = output_channel;
+        param->has_bias                = 1;
+        param->axis                    = 1;
+        param->dynamic_range_quantized = dynamic_range;
+        params.push_back(param);
+    }
+
+    std::vector<int> input_dims = {batch, input_channel, input_size, input_size};
+    auto ref_interp             = GenerateInterpreter("InnerProduct", {input_dims}, params[0], ref_resource);
+    auto device_interp          = GenerateInterpreter("InnerProduct", {input_dims}, params[1], resource);
+    EXPECT_EQ((int)RunDynamicRange(ref_interp, device_interp, precision, 0.01f, Tolerance(precision, k)), TNN_OK);
+}
+
+class DynamicRangeMatMulLayerTest
+    : public ::testing::TestWithParam<std::tuple<int, int, int, bool, Precision>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, DynamicRangeMatMulLayerTest,
+                         ::testing::Combine(
+                             // rows of A
+                             testing::Values(1, 5, 33),
+                             // K
+                             testing::Values(16, 97),
+                             // M
+                             testing::Values(9, 64),
+                             // per column scales
+                             testing::Values(false, true),
+                             // low precision runs the dynamic int8 gemm, auto the fp32 kernels on the int8 weights
+                             testing::Values(PRECISION_LOW, PRECISION_AUTO)));
+
+TEST_P(DynamicRangeMatMulLayerTest, DynamicRangeMatMulLayer) {
+    int n               = std::get<0>(GetParam());
+    int k               = std::get<1>(GetParam());
+    int m               = std::get<2>(GetParam());
+    bool per_column     = std::get<3>(GetParam());
+    Precision precision = std::get<4>(GetParam());
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<MatMulLayerResource> resource(new MatMulLayerResource());
+    GenerateInt8Weight(k * m, per_column ? m : 1, {k, m}, resource->weight, resource->scale_handle);
+
+    std::shared_ptr<MatMulLayerResource> ref_resource(new MatMulLayerResource());
+    ref_resource->weight = ConvertInt8Handle(resource->weight, resource->scale_handle, 1);
+
+    std::vector<std::shared_ptr<MatMulLayerParam>> params;
+    for (bool dynamic_range : {false, true}) {
+        std::shared_ptr<MatMulLayerParam> param(new MatMulLayerParam());
+        param->name                    = "MatMul";
+        param->weight_position         = 1;
+        param->dynamic_range_quantized = dynamic_range;
+        params.push_back(param);
+    }
+
+    auto ref_interp    = GenerateInterpreter("MatMul", {{2, n, k}}, params[0], ref_resource);
+    auto device_interp = GenerateInterpreter("MatMul", {{2, n, k}}, params[1], resource);
+    EXPECT_EQ((int)RunDynamicRange(ref_interp, device_interp, precision, 0.01f, Tolerance(precision, k)), TNN_OK);
+}
+
+class DynamicRangeConvLayerTest
+    : public ::testing::TestWithParam<std::tuple<int, int, int, int, int, int, bool>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, DynamicRangeConvLayerTest,
+                         ::testing::Combine(
+                             // batch
+                             testing::Values(1, 2),
+                             // input channel per group
+                             testing::Values(3, 16),
+                             // output channel per group
+                             testing::Values(5, 24),
+                             // group
+                             testing::Values(1, 2),
+                             // kernel
+                             testing::Values(1, 3),
+                             // stride
+                             testing::Values(1, 2),
+                             // per channel scales
+                             testing::Values(false, true)));
+
+TEST_P(DynamicRangeConvLayerTest, DynamicRangeConvLayer) {
+    int batch          = std::get<0>(GetParam());
+    int input_channel  = std::get<1>(GetParam()) * std::get<3>(GetParam());
+    int output_channel = std::get<2>(GetParam()) * std::get<3>(GetParam());
+    int group          = std::get<3>(GetParam());
+    int kernel         = std::get<4>(GetParam());
+    int stride         = std::get<5>(GetParam());
+    bool per_channel   = std::get<6>(GetParam());
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    const int k = input_channel / group * kernel * kernel;
+
+    std::shared_ptr<ConvLayerResource> resource(new ConvLayerResource());
+    GenerateInt8Weight(output_channel * k, per_channel ? output_channel : 1,
+                       {output_channel, input_channel / group, kernel, kernel}, resource->filter_handle,
+                       resource->scale_handle);
+    resource->bias_handle = RawBuffer(output_channel * sizeof(float), {output_channel});
+    InitRandom(resource->bias_handle.force_to<float *>(), output_channel, 1.0f);
+
+    std::shared_ptr<ConvLayerResource> ref_resource(new ConvLayerResource());
+    ref_resource->filter_handle = ConvertInt8Handle(resource->filter_handle, resource->scale_handle, k);
+    ref_resource->bias_handle   = resource->bias_handle;
+
+    std::vector<std::shared_ptr<ConvLayerParam>> params;
+    for (bool dynamic_range : {false, true}) {
+        std::shared_ptr<ConvLayerParam> param(new ConvLayerParam());
+        param->name                    = "Conv";
+        param->input_channel           = input_channel;
+        param->output_channel          = output_channel;
+        param->group                   = group;
+        param->kernels                 = {kernel, kernel};
+        param->dialations              = {1, 1};
+        param->strides                 = {stride, stride};
+        param->pads                    = {kernel / 2, kernel / 2, kernel / 2, kernel / 2};
+        param->pad_type                = -1;
+        param->bias                    = 1;
+        param->activation_type         = ActivationType_ReLU;
+        param->dynamic_range_quantized = dynamic_range;
+        params.push_back(param);
+    }
+
+    std::vector<int> input_dims = {batch, input_channel, 11, 9};
+    auto ref_interp             = GenerateInterpreter("Convolution", {input_dims}, params[0], ref_resource);
+    auto device_interp          = GenerateInterpreter("Convolution", {input_dims}, params[1], resource);
+    EXPECT_EQ((int)RunDynamicRange(ref_interp, device_interp, PRECISION_AUTO, 0.01f, Tolerance(PRECISION_AUTO, k)),
+              TNN_OK);
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,87 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_helpers.h"
+#include "tnn/utils/dims_utils.h"
+
+namespace TNN_NS {
+
+class GatherLayerTest : public LayerTest,
+                        public ::testing::WithParamInterface<std::tuple<int, int, std::vector<int>, DataType>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, GatherLayerTest,
+                         ::testing::Combine(
+                             // table rows
+                             testing::Values(1, 37, 1000),
+                             // row size
+                             testing::Values(1, 13, 64, 128),
+                             // indices dims
+                             testing::Values(std::vector<int>({1}), std::vector<int>({7}), std::vector<int>({4, 50}),
+                                             std::vector<int>({2, 600})),
+                             // table data type, half is the fp16 copy kept under low precision
+                             testing::Values(DATA_TYPE_FLOAT, DATA_TYPE_HALF, DATA_TYPE_INT8)));
+
+TEST_P(GatherLayerTest, GatherEmbeddingLayer) {
+    // get param
+    int rows                      = std::get<0>(GetParam());
+    int row_size                  = std::get<1>(GetParam());
+    std::vector<int> indices_dims = std::get<2>(GetParam());
+    DataType dtype                = std::get<3>(GetParam());
+    DeviceType dev                = ConvertDeviceType(FLAGS_dt);
+
+    // fp16 and int8 tables are only gathered on x86
+    if (dtype != DATA_TYPE_FLOAT && DEVICE_X86 != dev && DEVICE_NAIVE != dev) {
+        GTEST_SKIP();
+    }
+    if (DEVICE_HUAWEI_NPU == dev || DEVICE_APPLE_NPU == dev) {
+        GTEST_SKIP();
+    }
+
+    integer_input_min_ = 0;
+    integer_input_max_ = rows;
+
+    // param
+    std::shared_ptr<GatherLayerParam> param(new GatherLayerParam());
+    param->name                = "Gather";
+    param->axis                = 0;
+    param->data_in_resource    = true;
+    param->indices_in_resource = false;
+
+    // resource
+    std::shared_ptr<GatherLayerResource> resource(new GatherLayerResource());
+    const int count = rows * row_size;
+    if (dtype == DATA_TYPE_INT8) {
+        RawBuffer data(count, {rows, row_size});
+        data.SetDataType(DATA_TYPE_INT8);
+        InitRandom(data.force_to<int8_t*>(), count, (int8_t)127);
+        RawBuffer scale(rows * sizeof(float), {rows});
+        InitRandom(scale.force_to<float*>(), rows, 0.001f, 0.1f);
+        resource->data       = data;
+        resource->scale_data = scale;
+    } else {
+        RawBuffer data(count * sizeof(float), {rows, row_size});
+        InitRandom(data.force_to<float*>(), count, 1.0f);
+        resource->data = data;
+    }
+
+    // generate interpreter
+    std::vector<DataType> input_dtype = {DATA_TYPE_INT32};
+    auto interpreter = GenerateInterpreter("Gather", {indices_dims}, param, resource, 1, input_dtype);
+    Run(interpreter, dtype == DATA_TYPE_HALF ? PRECISION_LOW : PRECISION_AUTO);
+}
+
+}  // namespace TNN_NS
@@ -66,4 +66,27 @@ TEST_P(GeluLayerTest, GeluLayer) {
     Run(interpreter);
 }
 
+// low precision x86 gelu takes the polynomial exp
+class GeluLowPrecisionLayerTest : public LayerTest, public ::testing::WithParamInterface<std::tuple<int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, GeluLowPrecisionLayerTest,
+                         ::testing::Combine(testing::Values(1, 2),                // batch
+                                            testing::Values(3, 64, 768, 3079)));  // size
+
+TEST_P(GeluLowPrecisionLayerTest, GeluLayer) {
+    int batch      = std::get<0>(GetParam());
+    int size       = std::get<1>(GetParam());
+    DeviceType dev = ConvertDeviceType(FLAGS_dt);
+
+    if (DEVICE_X86 != dev && DEVICE_NAIVE != dev) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<LayerParam> param(new LayerParam());
+    param->name = "Gelu";
+
+    auto interpreter = GenerateInterpreter("GELU", {{batch, 4, size}}, param);
+    Run(interpreter, PRECISION_LOW);
+}
+
 }  // namespace TNN_NS
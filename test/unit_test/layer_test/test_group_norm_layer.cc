@@ -24,7 +24,7 @@ class GroupNormLayerTest : public LayerTest,
 
 INSTANTIATE_TEST_SUITE_P(LayerTest, GroupNormLayerTest,
                          ::testing::Combine(testing::Values(1, 2),             // batch
-                                            testing::Values(1, 6, 24),         // channel
+                                            testing::Values(1, 6, 24, 64),     // channel
                                             testing::Values(10, 20, 65, 128),  // input_size
                                             testing::Values(1, 2, 3, 4),       // group
                                             testing::Values(2, 3, 4, 5),       // dim count
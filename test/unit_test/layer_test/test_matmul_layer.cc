@@ -15,6 +15,7 @@
 #include "test/unit_test/layer_test/layer_test.h"
 #include "test/unit_test/unit_test_common.h"
 #include "test/unit_test/utils/network_helpers.h"
+#include "test/unit_test/utils/network_test_utils.h"
 #include "tnn/utils/dims_utils.h"
 
 namespace TNN_NS {
@@ -122,4 +123,79 @@ TEST_P(MatMulLayerTest, MatMulLayer) {
     Run(interpreter);
 }
 
+class MatMulGemvLayerTest : public LayerTest,
+                            public ::testing::WithParamInterface<std::tuple<int, int, int, DataType, Precision>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, MatMulGemvLayerTest,
+                         ::testing::Combine(
+                             // rows of A
+                             testing::Values(1, 3, 4),
+                             // K
+                             testing::Values(16, 97),
+                             // M
+                             testing::Values(9, 64),
+                             // weight data type
+                             testing::Values(DATA_TYPE_FLOAT, DATA_TYPE_HALF),
+                             // low precision keeps the packed B as fp16 on x86
+                             testing::Values(PRECISION_AUTO, PRECISION_LOW)));
+
+// a constant B with at most 4 rows of A runs as a gemv of the packed B
+TEST_P(MatMulGemvLayerTest, MatMulGemvLayer) {
+    int n          = std::get<0>(GetParam());
+    int k          = std::get<1>(GetParam());
+    int m          = std::get<2>(GetParam());
+    DataType dtype = std::get<3>(GetParam());
+    auto precision = std::get<4>(GetParam());
+    DeviceType dev = ConvertDeviceType(FLAGS_dt);
+
+    if (DEVICE_X86 != dev && DEVICE_NAIVE != dev) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<MatMulLayerParam> param(new MatMulLayerParam());
+    param->name            = "MatMul";
+    param->weight_position = 1;
+
+    std::shared_ptr<MatMulLayerResource> resource(new MatMulLayerResource());
+    RawBuffer buffer(k * m * sizeof(float), {k, m});
+    InitRandom(buffer.force_to<float*>(), k * m, 1.0f);
+    resource->weight = dtype == DATA_TYPE_HALF ? ConvertFloatToFP16(buffer) : buffer;
+
+    auto interpreter = GenerateInterpreter("MatMul", {{1, n, k}}, param, resource);
+    Run(interpreter, precision);
+}
+
+// B is packed for the gemv at init, a reshape to more rows of A has to run the gemm
+TEST(MatMulReshapeTest, GemvToGemm) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    const int k = 64, m = 24;
+    for (auto dtype : {DATA_TYPE_FLOAT, DATA_TYPE_HALF}) {
+        std::shared_ptr<MatMulLayerParam> param(new MatMulLayerParam());
+        param->name            = "MatMul";
+        param->weight_position = 1;
+
+        std::shared_ptr<MatMulLayerResource> resource(new MatMulLayerResource());
+        RawBuffer buffer(k * m * sizeof(float), {k, m});
+        InitRandom(buffer.force_to<float*>(), k * m, 1.0f);
+        resource->weight = dtype == DATA_TYPE_HALF ? ConvertFloatToFP16(buffer) : buffer;
+
+        NetworkConfig config;
+        config.device_type = DEVICE_X86;
+        config.precision   = PRECISION_LOW;
+
+        // the blobs of {4, 4, k} also hold {1, 16, k}
+        NetworkTestPair pair;
+        auto interpreter = GenerateInterpreter("MatMul", {{4, 4, k}}, param, resource);
+        ASSERT_EQ((int)pair.Init(interpreter, config, {{"input0", {1, 1, k}}}, {{"input0", {4, 4, k}}}), TNN_OK);
+        for (auto shape : std::vector<DimsVector>({{4, 4, k}, {1, 16, k}, {2, 3, k}})) {
+            ASSERT_EQ((int)pair.Reshape({{"input0", shape}}), TNN_OK);
+            ASSERT_EQ((int)pair.SetRandomInputs(shape[1]), TNN_OK);
+            ASSERT_EQ((int)pair.Forward(), TNN_OK);
+            EXPECT_EQ((int)pair.Compare(0.01f, 0.01f), TNN_OK);
+        }
+    }
+}
+
 }  // namespace TNN_NS
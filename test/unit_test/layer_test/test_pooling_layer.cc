@@ -32,6 +32,18 @@ INSTANTIATE_TEST_SUITE_P(LayerTest, PoolingLayerTest,
                                             // datatype
                                             testing::Values(DATA_TYPE_INT8, DATA_TYPE_FLOAT, DATA_TYPE_BFP16, DATA_TYPE_HALF)));
 
+// channels that are not a multiple of 32 run the overlapping tail of the x86 avx2 int8 pooling
+INSTANTIATE_TEST_SUITE_P(LayerTestInt8Tail, PoolingLayerTest,
+                         ::testing::Combine(testing::Values(1, 2), testing::Values(40, 72), testing::Values(9, 16),
+                                            // kernel
+                                            testing::Values(3, 2),
+                                            // stride
+                                            testing::Values(1, 2),
+                                            // pool type
+                                            testing::Values(0, 1),
+                                            // datatype
+                                            testing::Values(DATA_TYPE_INT8)));
+
 TEST_P(PoolingLayerTest, PoolingLayer) {
     // get param
     int batch          = std::get<0>(GetParam());
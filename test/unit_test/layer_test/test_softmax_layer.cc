@@ -98,4 +98,31 @@ TEST_P(SoftmaxLayerTest, SoftmaxLayer) {
     Run(interpreter, precision);
 }
 
+// low precision x86 softmax takes the polynomial exp, rows are long enough for the blocked running max
+class SoftmaxLowPrecisionLayerTest : public LayerTest,
+                                     public ::testing::WithParamInterface<std::tuple<int, int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, SoftmaxLowPrecisionLayerTest,
+                         ::testing::Combine(testing::Values(1, 3),               // batch
+                                            testing::Values(7, 64, 1000, 4099),  // size
+                                            testing::Values(-1, 1)));            // axis
+
+TEST_P(SoftmaxLowPrecisionLayerTest, SoftmaxLayer) {
+    int batch      = std::get<0>(GetParam());
+    int size       = std::get<1>(GetParam());
+    int axis       = std::get<2>(GetParam());
+    DeviceType dev = ConvertDeviceType(FLAGS_dt);
+
+    if (DEVICE_X86 != dev && DEVICE_NAIVE != dev) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<SoftmaxLayerParam> param(new SoftmaxLayerParam());
+    param->name = "Softmax";
+    param->axis = axis;
+
+    auto interpreter = GenerateInterpreter("Softmax", {{batch, 5, size}}, param);
+    Run(interpreter, PRECISION_LOW);
+}
+
 }  // namespace TNN_NS
@@ -98,4 +98,43 @@ TEST_P(UpsampleLayerTest, UpsampleLayer) {
     Run(interpreter);
 }
 
+class UpsampleNearestDownscaleLayerTest : public LayerTest,
+                                          public ::testing::WithParamInterface<std::tuple<int, int, DataType>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, UpsampleNearestDownscaleLayerTest,
+                         ::testing::Combine(
+                             // input size
+                             testing::Values(12, 18, 27),
+                             // downscale factor, the source index j * factor lands exactly on an integer
+                             testing::Values(2, 3),
+                             // data_type
+                             testing::Values(DATA_TYPE_FLOAT, DATA_TYPE_INT8)));
+
+TEST_P(UpsampleNearestDownscaleLayerTest, UpsampleLayer) {
+    int input_size = std::get<0>(GetParam());
+    int factor     = std::get<1>(GetParam());
+    auto data_type = std::get<2>(GetParam());
+
+    DeviceType dev = ConvertDeviceType(FLAGS_dt);
+    if (CheckDataTypeSkip(data_type) || DEVICE_HUAWEI_NPU == dev || DEVICE_APPLE_NPU == dev) {
+        GTEST_SKIP();
+    }
+    if (input_size % factor != 0) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<UpsampleLayerParam> param(new UpsampleLayerParam());
+    param->name          = "Upsample";
+    param->mode          = 1;
+    param->align_corners = 0;
+    param->scales        = {1.0f / factor, 1.0f / factor};
+    param->dims          = {input_size / factor, input_size / factor};
+    if (DATA_TYPE_INT8 == data_type) {
+        param->quantized = true;
+    }
+
+    auto interpreter = GenerateInterpreter("Upsample", {{1, 8, input_size, input_size}}, param);
+    Run(interpreter);
+}
+
 }  // namespace TNN_NS
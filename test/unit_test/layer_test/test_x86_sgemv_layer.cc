@@ -0,0 +1,195 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <cmath>
+
+#include "test/unit_test/layer_test/layer_test.h"
+#include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/network_helpers.h"
+#include "tnn/device/x86/acc/Float4.h"
+#include "tnn/device/x86/acc/Float8.h"
+#include "tnn/device/x86/acc/compute/jit/utils/cpu_isa.h"
+#include "tnn/device/x86/acc/compute/x86_compute.h"
+
+namespace TNN_NS {
+
+// how the tasks of a plan split the product, PARTITION takes the tiles X86SgemvPartition picks for 8 threads
+enum SgemvSplit { SPLIT_NONE = 0, SPLIT_ROWS, SPLIT_COLS, SPLIT_DEPTH, SPLIT_ALL, SPLIT_PARTITION };
+
+static X86SgemvPlan MakeSgemvPlan(int split, int rows, int cols, int depth, int pack) {
+    if (split == SPLIT_PARTITION) {
+        return X86SgemvPartition(rows, cols, depth, pack, 8);
+    }
+    X86SgemvPlan plan;
+    plan.row_tile = (split == SPLIT_ROWS || split == SPLIT_ALL) ? 1 : MIN(rows, 4);
+    plan.col_tile = (split == SPLIT_COLS || split == SPLIT_ALL) ? pack : ROUND_UP(cols, pack);
+    plan.k_tile   = (split == SPLIT_DEPTH || split == SPLIT_ALL) ? ROUND_UP(UP_DIV(depth, 3), 8) : depth;
+    return plan;
+}
+
+// dst[rows x cols] = src[rows x depth] * weight[depth x cols] + bias, in double
+static std::vector<float> NaiveGemv(const std::vector<float> &src, const std::vector<float> &weight,
+                                    const std::vector<float> &bias, int rows, int cols, int depth) {
+    std::vector<float> dst((size_t)rows * cols);
+    for (int r = 0; r < rows; ++r) {
+        for (int c = 0; c < cols; ++c) {
+            double sum = bias[c];
+            for (int k = 0; k < depth; ++k) {
+                sum += (double)src[(size_t)r * depth + k] * weight[(size_t)k * cols + c];
+            }
+            dst[(size_t)r * cols + c] = (float)sum;
+        }
+    }
+    return dst;
+}
+
+static float MaxDiff(const std::vector<float> &a, const std::vector<float> &b) {
+    float max_diff = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        max_diff = std::max(max_diff, std::fabs(a[i] - b[i]));
+    }
+    return max_diff;
+}
+
+class X86SgemvTest : public ::testing::TestWithParam<std::tuple<int, int, int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, X86SgemvTest,
+                         ::testing::Combine(
+                             // rows, 1 is the inner product and matmul at batch 1
+                             testing::Values(1, 3, 6),
+                             // cols, with and without a partial pack
+                             testing::Values(5, 16, 37),
+                             // depth, the odd ones leave a tail in the last depth task
+                             testing::Values(1, 31, 257, 1027),
+                             testing::Values(SPLIT_NONE, SPLIT_ROWS, SPLIT_COLS, SPLIT_DEPTH, SPLIT_ALL,
+                                             SPLIT_PARTITION)));
+
+// the packed kernel of the inner product and the row major one of the matmul give the naive result for every plan
+TEST_P(X86SgemvTest, X86Sgemv) {
+    int rows  = std::get<0>(GetParam());
+    int cols  = std::get<1>(GetParam());
+    int depth = std::get<2>(GetParam());
+    int split = std::get<3>(GetParam());
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+
+    std::vector<float> src((size_t)rows * depth);
+    std::vector<float> weight((size_t)depth * cols);
+    std::vector<float> bias(ROUND_UP(cols, 8));
+    InitRandom(src.data(), src.size(), 1.0f);
+    InitRandom(weight.data(), weight.size(), 1.0f);
+    InitRandom(bias.data(), bias.size(), 1.0f);
+    auto expected   = NaiveGemv(src, weight, bias, rows, cols, depth);
+    float tolerance = 1e-5f * depth + 1e-5f;
+
+    // Float8 only names the type of the x86 kernels when built with avx, the layer test covers it otherwise
+    std::vector<int> packs = {4};
+#ifdef __AVX2__
+    if (cpu_with_isa(avx2)) {
+        packs.push_back(8);
+    }
+#endif
+    for (int pack : packs) {
+        auto plan = MakeSgemvPlan(split, rows, cols, depth, pack);
+        std::vector<float> workspace(X86SgemvWorkspaceSize(plan, rows, cols, depth, pack) / sizeof(float) + 1);
+        std::vector<float> packed_weight((size_t)ROUND_UP(cols, pack) * depth);
+        X86SgemvPackRowMajor(packed_weight.data(), weight.data(), depth, cols, pack);
+
+        std::vector<float> dst((size_t)rows * cols);
+        auto sgemv           = X86Sgemv<Float4, 4>;
+        auto sgemv_row_major = X86SgemvRowMajor<Float4, 4>;
+#ifdef __AVX2__
+        if (pack == 8) {
+            sgemv           = X86Sgemv<Float8, 8>;
+            sgemv_row_major = X86SgemvRowMajor<Float8, 8>;
+        }
+#endif
+        sgemv(dst.data(), src.data(), packed_weight.data(), bias.data(), {rows, depth}, {rows, cols}, plan,
+              workspace.data());
+        EXPECT_LE(MaxDiff(dst, expected), tolerance) << "packed, pack " << pack;
+
+        std::vector<float> row_major_dst((size_t)rows * cols);
+        sgemv_row_major(row_major_dst.data(), src.data(), weight.data(), bias.data(), rows, cols, depth, plan,
+                        workspace.data());
+        EXPECT_LE(MaxDiff(row_major_dst, expected), tolerance) << "row major, pack " << pack;
+    }
+}
+
+// the partition splits the output while it gives enough tasks, and depth only when it does not
+TEST(X86SgemvPartitionTest, X86SgemvPartition) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    // one thread, or too little work for a second one, runs a single task
+    auto plan = X86SgemvPartition(1, 1000, 2048, 8, 1);
+    EXPECT_EQ(plan.col_tile, 1000);
+    EXPECT_EQ(plan.k_tile, 2048);
+    plan = X86SgemvPartition(1, 16, 64, 8, 8);
+    EXPECT_EQ(plan.col_tile, 16);
+    EXPECT_EQ(plan.k_tile, 64);
+
+    // a wide output is split over columns
+    plan = X86SgemvPartition(1, 4096, 1024, 8, 8);
+    EXPECT_LT(plan.col_tile, 4096);
+    EXPECT_EQ(plan.col_tile % 8, 0);
+    EXPECT_EQ(plan.k_tile, 1024);
+
+    // a narrow output with a deep product is split over depth
+    plan = X86SgemvPartition(1, 16, 65531, 8, 8);
+    EXPECT_EQ(plan.col_tile, 8);
+    EXPECT_LT(plan.k_tile, 65531);
+    EXPECT_EQ(plan.k_tile % 8, 0);
+    EXPECT_GT(X86SgemvWorkspaceSize(plan, 1, 16, 65531, 8), 0);
+
+    // rows share the weight loads up to 4 per task
+    plan = X86SgemvPartition(6, 1024, 1024, 8, 8);
+    EXPECT_EQ(plan.row_tile, 4);
+}
+
+class X86SgemvLayerTest : public LayerTest, public ::testing::WithParamInterface<std::tuple<int, int>> {};
+
+INSTANTIATE_TEST_SUITE_P(LayerTest, X86SgemvLayerTest,
+                         ::testing::Combine(
+                             // K, odd and deep enough for the depth split with a few threads
+                             testing::Values(1027, 4099),
+                             // output channels
+                             testing::Values(13, 64)));
+
+// batch 1 inner product and matmul on the sgemv, the depth split needs -th > 1
+TEST_P(X86SgemvLayerTest, X86SgemvLayer) {
+    int k = std::get<0>(GetParam());
+    int m = std::get<1>(GetParam());
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+
+    std::shared_ptr<InnerProductLayerParam> ip_param(new InnerProductLayerParam());
+    ip_param->name       = "InnerProduct";
+    ip_param->num_output = m;
+    ip_param->has_bias   = 1;
+    ip_param->axis       = 1;
+    Run(GenerateInterpreter("InnerProduct", {{1, k, 1, 1}}, ip_param));
+
+    std::shared_ptr<MatMulLayerParam> matmul_param(new MatMulLayerParam());
+    matmul_param->name            = "MatMul";
+    matmul_param->weight_position = 1;
+    std::shared_ptr<MatMulLayerResource> resource(new MatMulLayerResource());
+    RawBuffer buffer(k * m * sizeof(float), {k, m});
+    InitRandom(buffer.force_to<float *>(), k * m, 1.0f);
+    resource->weight = buffer;
+    Run(GenerateInterpreter("MatMul", {{1, k}}, matmul_param, resource));
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,256 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include <gtest/gtest.h>
+
+#include "tnn/interpreter/layer_param.h"
+#include "tnn/optimizer/net_optimizer_insert_layout_reformat.h"
+
+namespace TNN_NS {
+
+using optimizer::EstimateBlobBytes;
+using optimizer::PlanLayerLayouts;
+
+static const DataFormat kA = DATA_FORMAT_NC4HW4;
+static const DataFormat kB = DATA_FORMAT_NCHW;
+
+static std::shared_ptr<LayerInfo> Layer(LayerType type, std::string name, std::vector<std::string> inputs,
+                                        std::vector<std::string> outputs, LayerParam *param = nullptr) {
+    std::shared_ptr<LayerInfo> layer(new LayerInfo());
+    layer->type    = type;
+    layer->name    = name;
+    layer->inputs  = inputs;
+    layer->outputs = outputs;
+    layer->param   = std::shared_ptr<LayerParam>(param ? param : new LayerParam());
+    return layer;
+}
+
+// x is in A. pool prefers B but also runs in A and shrinks its input 64 times, fc only runs in B.
+// converting x or y is one reformat either way, converting the small y moves far fewer bytes.
+TEST(LayoutPlannerTest, ConvertsTheSmallerBlob) {
+    std::vector<std::shared_ptr<LayerInfo>> layers = {
+        Layer(LAYER_POOLING, "pool", {"x"}, {"y"}),
+        Layer(LAYER_INNER_PRODUCT, "fc", {"y"}, {"z"}),
+    };
+    std::vector<std::vector<DataFormat>> candidates = {{kB, kA}, {kB}};
+    std::map<std::string, int64_t> bytes           = {{"x", 64 * 1024}, {"y", 1024}, {"z", 64}};
+
+    auto plan = PlanLayerLayouts(layers, candidates, {{"x", kA}}, bytes);
+    EXPECT_EQ(plan[0], kA);
+    EXPECT_EQ(plan[1], kB);
+
+    // with the sizes turned around, x is the one to convert and pool runs its preferred layout
+    bytes = {{"x", 1024}, {"y", 64 * 1024}, {"z", 64}};
+    plan  = PlanLayerLayouts(layers, candidates, {{"x", kA}}, bytes);
+    EXPECT_EQ(plan[0], kB);
+    EXPECT_EQ(plan[1], kB);
+}
+
+// the two readers of x that only run in B share one reformat of x. counted once it is cheaper than running relu
+// in B, which needs a reformat of in and one of x for add.
+TEST(LayoutPlannerTest, SharedReformat) {
+    std::vector<std::shared_ptr<LayerInfo>> layers = {
+        Layer(LAYER_RELU, "relu", {"in"}, {"x"}),
+        Layer(LAYER_SIGMOID, "sig", {"x"}, {"a"}),
+        Layer(LAYER_ABS, "abs", {"x"}, {"b"}),
+        Layer(LAYER_ADD, "add", {"in", "x"}, {"c"}),
+    };
+    std::vector<std::vector<DataFormat>> candidates = {{kA, kB}, {kB}, {kB}, {kA}};
+    std::map<std::string, int64_t> bytes = {{"in", 500}, {"x", 1000}, {"a", 1000}, {"b", 1000}, {"c", 1000}};
+
+    auto plan = PlanLayerLayouts(layers, candidates, {{"in", kA}}, bytes);
+    EXPECT_EQ(plan[0], kA);
+    EXPECT_EQ(plan[1], kB);
+    EXPECT_EQ(plan[2], kB);
+    EXPECT_EQ(plan[3], kA);
+}
+
+// a layer left out of planning keeps DATA_FORMAT_AUTO and is not counted as a reader
+TEST(LayoutPlannerTest, LayersWithoutCandidates) {
+    std::vector<std::shared_ptr<LayerInfo>> layers = {
+        Layer(LAYER_RELU, "relu", {"x"}, {"y"}),
+        Layer(LAYER_CONST, "const", {}, {"w"}),
+        Layer(LAYER_MUL, "mul", {"y", "w"}, {"z"}),
+    };
+    std::vector<std::vector<DataFormat>> candidates = {{kA, kB}, {}, {kB, kA}};
+    auto plan = PlanLayerLayouts(layers, candidates, {{"x", kA}}, {{"x", 100}, {"y", 100}, {"z", 100}});
+    EXPECT_EQ(plan[0], kA);
+    EXPECT_EQ(plan[1], DATA_FORMAT_AUTO);
+    EXPECT_EQ(plan[2], kA);
+}
+
+TEST(LayoutPlannerTest, EstimateBlobBytes) {
+    NetStructure structure;
+    structure.inputs_shape_map = {{"x", {1, 3, 224, 224}}};
+
+    auto conv            = new ConvLayerParam();
+    conv->output_channel = 64;
+    conv->kernels        = {3, 3};
+    conv->strides        = {2, 2};
+    conv->pads           = {1, 1, 1, 1};
+    conv->dialations     = {1, 1};
+    auto pool            = new PoolingLayerParam();
+    pool->kernels_params = {2, 2};
+    pool->kernels        = {2, 2};
+    pool->kernel_indexs  = {-1, -1};
+    pool->strides        = {2, 2};
+    pool->pads           = {0, 0, 0, 0};
+    auto global_pool            = new PoolingLayerParam();
+    global_pool->is_global_pool = 1;
+    global_pool->kernels_params = {0, 0};
+    global_pool->kernels        = {0, 0};
+    global_pool->kernel_indexs  = {-1, -1};
+    global_pool->strides        = {1, 1};
+    global_pool->pads           = {0, 0, 0, 0};
+    auto fc                     = new InnerProductLayerParam();
+    fc->num_output              = 10;
+    fc->axis                    = 1;
+    auto concat                 = new ConcatLayerParam();
+    concat->axis                = 1;
+    structure.layers = {
+        Layer(LAYER_CONVOLUTION, "conv", {"x"}, {"c"}, conv),
+        Layer(LAYER_POOLING, "pool", {"c"}, {"p"}, pool),
+        Layer(LAYER_RELU, "relu", {"p"}, {"r"}),
+        Layer(LAYER_CONCAT, "concat", {"p", "r"}, {"cat"}, concat),
+        Layer(LAYER_POOLING, "gpool", {"cat"}, {"g"}, global_pool),
+        Layer(LAYER_INNER_PRODUCT, "fc", {"g"}, {"fc"}, fc),
+    };
+
+    NetResource resource;
+    auto bytes = EstimateBlobBytes(&structure, &resource);
+    EXPECT_EQ(bytes["x"], 1 * 3 * 224 * 224 * 4);
+    EXPECT_EQ(bytes["c"], 1 * 64 * 112 * 112 * 4);
+    EXPECT_EQ(bytes["p"], 1 * 64 * 56 * 56 * 4);
+    EXPECT_EQ(bytes["r"], bytes["p"]);
+    EXPECT_EQ(bytes["cat"], 1 * 128 * 56 * 56 * 4);
+    EXPECT_EQ(bytes["g"], 1 * 128 * 4);
+    EXPECT_EQ(bytes["fc"], 1 * 10 * 4);
+}
+
+// upsample is not known to the estimation, its shape comes from its own shape inference. the readers of a layer
+// that can not infer its shape keep the guessed shape of their first input.
+TEST(LayoutPlannerTest, EstimateBlobBytesByShapeInference) {
+    NetStructure structure;
+    structure.inputs_shape_map = {{"x", {1, 8, 16, 16}}};
+
+    auto upsample    = new UpsampleLayerParam();
+    upsample->mode   = 1;
+    upsample->scales = {2.f, 2.f};
+    auto no_scales   = new UpsampleLayerParam();
+    no_scales->mode  = 1;
+    structure.layers = {
+        Layer(LAYER_UPSAMPLE, "up", {"x"}, {"u"}, upsample),
+        Layer(LAYER_UPSAMPLE, "bad", {"u"}, {"b"}, no_scales),
+        Layer(LAYER_RELU, "relu", {"b"}, {"r"}),
+    };
+
+    NetResource resource;
+    auto bytes = EstimateBlobBytes(&structure, &resource);
+    EXPECT_EQ(bytes["u"], 1 * 8 * 32 * 32 * 4);
+    EXPECT_EQ(bytes["b"], bytes["u"]);
+    EXPECT_EQ(bytes["r"], bytes["u"]);
+}
+
+static std::shared_ptr<LayerInfo> Reformat(std::string name, std::vector<std::string> inputs,
+                                           std::vector<std::string> outputs, DataFormat src_format,
+                                           DataFormat dst_format, DataType src_type = DATA_TYPE_AUTO,
+                                           DataType dst_type = DATA_TYPE_AUTO) {
+    auto param        = new ReformatLayerParam();
+    param->src_format = src_format;
+    param->dst_format = dst_format;
+    param->src_type   = src_type;
+    param->dst_type   = dst_type;
+    return Layer(LAYER_REFORMAT, name, inputs, outputs, param);
+}
+
+static ReformatLayerParam *ReformatParam(const std::shared_ptr<LayerInfo> &layer) {
+    return dynamic_cast<ReformatLayerParam *>(layer->param.get());
+}
+
+// a reformat that converts the previous reformat back is removed, its reader reads the blob before both
+TEST(LayoutPlannerTest, MergeRoundTripReformats) {
+    NetStructure structure;
+    structure.layers = {
+        Layer(LAYER_RELU, "relu", {"x"}, {"y"}),
+        Reformat("to_b", {"y"}, {"y_b"}, kA, kB),
+        Reformat("to_a", {"y_b"}, {"y_a"}, kB, kA),
+        Layer(LAYER_SIGMOID, "sig", {"y_a"}, {"z"}),
+    };
+    structure.blobs   = {"x", "y", "y_b", "y_a", "z"};
+    structure.outputs = {"z"};
+
+    EXPECT_EQ(optimizer::MergeReformatLayers(&structure), 1);
+    ASSERT_EQ(structure.layers.size(), 2);
+    EXPECT_EQ(structure.layers[1]->name, "sig");
+    EXPECT_EQ(structure.layers[1]->inputs, std::vector<std::string>({"y"}));
+    EXPECT_EQ(structure.blobs.count("y_b"), 0);
+    EXPECT_EQ(structure.blobs.count("y_a"), 0);
+}
+
+// two layout reformats in a row collapse into one, the first one is kept while another layer reads it
+TEST(LayoutPlannerTest, MergeChainedReformats) {
+    NetStructure structure;
+    structure.layers = {
+        Layer(LAYER_RELU, "relu", {"x"}, {"y"}),
+        Reformat("to_b", {"y"}, {"y_b"}, kA, kB),
+        Reformat("to_c", {"y_b"}, {"y_c"}, kB, DATA_FORMAT_NHC4W4),
+        Layer(LAYER_SIGMOID, "sig", {"y_c"}, {"z"}),
+    };
+    structure.blobs   = {"x", "y", "y_b", "y_c", "z"};
+    structure.outputs = {"z"};
+
+    EXPECT_EQ(optimizer::MergeReformatLayers(&structure), 1);
+    ASSERT_EQ(structure.layers.size(), 3);
+    EXPECT_EQ(structure.layers[1]->name, "to_c");
+    EXPECT_EQ(structure.layers[1]->inputs, std::vector<std::string>({"y"}));
+    EXPECT_EQ(ReformatParam(structure.layers[1])->src_format, kA);
+    EXPECT_EQ(ReformatParam(structure.layers[1])->dst_format, DATA_FORMAT_NHC4W4);
+    EXPECT_EQ(structure.blobs.count("y_b"), 0);
+
+    // with a second reader of y_b the first reformat stays
+    structure.layers = {
+        Layer(LAYER_RELU, "relu", {"x"}, {"y"}),
+        Reformat("to_b", {"y"}, {"y_b"}, kA, kB),
+        Reformat("to_c", {"y_b"}, {"y_c"}, kB, DATA_FORMAT_NHC4W4),
+        Layer(LAYER_SIGMOID, "sig", {"y_c"}, {"z"}),
+        Layer(LAYER_ABS, "abs", {"y_b"}, {"w"}),
+    };
+    structure.blobs   = {"x", "y", "y_b", "y_c", "z", "w"};
+    structure.outputs = {"z", "w"};
+    EXPECT_EQ(optimizer::MergeReformatLayers(&structure), 1);
+    ASSERT_EQ(structure.layers.size(), 5);
+    EXPECT_EQ(structure.layers[1]->outputs, std::vector<std::string>({"y_b"}));
+    EXPECT_EQ(structure.layers[2]->inputs, std::vector<std::string>({"y"}));
+}
+
+// reformats that change the data type are only merged when they round-trip, and model outputs are kept
+TEST(LayoutPlannerTest, MergeKeepsTypeChangesAndOutputs) {
+    NetStructure structure;
+    structure.layers = {
+        Layer(LAYER_RELU, "relu", {"x"}, {"y"}),
+        Reformat("to_half", {"y"}, {"y_h"}, kA, kA, DATA_TYPE_FLOAT, DATA_TYPE_HALF),
+        Reformat("to_b", {"y_h"}, {"y_b"}, kA, kB, DATA_TYPE_HALF, DATA_TYPE_HALF),
+        Reformat("to_float", {"y_h"}, {"y_f"}, kA, kA, DATA_TYPE_HALF, DATA_TYPE_FLOAT),
+        Layer(LAYER_SIGMOID, "sig", {"y_b"}, {"z"}),
+    };
+    structure.blobs   = {"x", "y", "y_h", "y_b", "y_f", "z"};
+    structure.outputs = {"z", "y_f"};
+
+    EXPECT_EQ(optimizer::MergeReformatLayers(&structure), 0);
+    EXPECT_EQ(structure.layers.size(), 5);
+    EXPECT_EQ(structure.layers[2]->inputs, std::vector<std::string>({"y_h"}));
+    EXPECT_EQ(structure.layers[3]->outputs, std::vector<std::string>({"y_f"}));
+}
+
+}  // namespace TNN_NS
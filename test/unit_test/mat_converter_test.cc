@@ -468,4 +468,49 @@ TEST_P(MatConverterTest, MatConverterTest) {
 
 #undef CHECK_STATUS
 
+// odd widths end the rows inside the 16 pixel avx2 step and the 8 pixel sse step of the x86 kernels,
+// x86 gray is rounded in 14-bit fixed point on every path, the naive reference truncates a float
+TEST(MatConverterGrayTest, OddWidth) {
+    DeviceType device_type = ConvertDeviceType(FLAGS_dt);
+    if (device_type != DEVICE_NAIVE && device_type != DEVICE_X86 && device_type != DEVICE_ARM) {
+        GTEST_SKIP();
+    }
+    const int height = 3;
+    for (auto cvt_type : {COLOR_CONVERT_BGRTOGRAY, COLOR_CONVERT_RGBTOGRAY, COLOR_CONVERT_BGRATOGRAY,
+                          COLOR_CONVERT_RGBATOGRAY}) {
+        const bool has_alpha = cvt_type == COLOR_CONVERT_BGRATOGRAY || cvt_type == COLOR_CONVERT_RGBATOGRAY;
+        const bool bgr_order = cvt_type == COLOR_CONVERT_BGRTOGRAY || cvt_type == COLOR_CONVERT_BGRATOGRAY;
+        const int channel    = has_alpha ? 4 : 3;
+        for (int width : {1, 7, 9, 15, 17, 23, 31, 33, 47, 51}) {
+            Mat src(DEVICE_NAIVE, has_alpha ? N8UC4 : N8UC3, {1, channel, height, width});
+            auto src_data = static_cast<uint8_t*>(src.GetData());
+            InitRandom(src_data, height * width * channel, (uint8_t)0, (uint8_t)255);
+
+            Mat ref(DEVICE_NAIVE, NGRAY, {1, 1, height, width});
+            ASSERT_EQ((int)MatUtils::CvtColor(src, ref, cvt_type, nullptr), TNN_OK);
+
+            Mat device_src(device_type, src.GetMatType(), src.GetDims());
+            Mat device_dst(device_type, NGRAY, {1, 1, height, width});
+            Mat dst(DEVICE_NAIVE, NGRAY, {1, 1, height, width});
+            ASSERT_EQ((int)MatUtils::Copy(src, device_src, nullptr), TNN_OK);
+            ASSERT_EQ((int)MatUtils::CvtColor(device_src, device_dst, cvt_type, nullptr), TNN_OK);
+            ASSERT_EQ((int)MatUtils::Copy(device_dst, dst, nullptr), TNN_OK);
+
+            auto ref_data = static_cast<uint8_t*>(ref.GetData());
+            auto dst_data = static_cast<uint8_t*>(dst.GetData());
+            EXPECT_EQ(CompareData(ref_data, dst_data, 1, 1, height * width), 0) << "width " << width;
+            if (device_type != DEVICE_X86) {
+                continue;
+            }
+            for (int i = 0; i < height * width; ++i) {
+                int b      = src_data[i * channel + (bgr_order ? 0 : 2)];
+                int g      = src_data[i * channel + 1];
+                int r      = src_data[i * channel + (bgr_order ? 2 : 0)];
+                int expect = (b * 1868 + g * 9617 + r * 4899 + (1 << 13)) >> 14;
+                ASSERT_EQ(dst_data[i], expect) << "width " << width << " pixel " << i;
+            }
+        }
+    }
+}
+
 }  // namespace TNN_NS
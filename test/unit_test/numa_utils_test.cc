@@ -0,0 +1,110 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#if defined(__linux__) && !defined(__ANDROID__)
+
+#include <gtest/gtest.h>
+#include <sched.h>
+
+#include <set>
+#include <vector>
+
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "test/unit_test/utils/network_test_utils.h"
+#include "tnn/utils/cpu_utils.h"
+#include "tnn/utils/numa_utils.h"
+
+namespace TNN_NS {
+
+static std::set<int> GetAffinity() {
+    std::set<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.insert(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+// every test pins the calling thread to the first cpu of node 0 and gives it its affinity back afterwards
+class NumaUtilsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (NumaUtils::GetNodeCount() < 1 || NumaUtils::GetNodeCpus(0, node_cpus_) != TNN_OK || node_cpus_.empty()) {
+            GTEST_SKIP();
+        }
+        CPU_ZERO(&saved_affinity_);
+        ASSERT_EQ(sched_getaffinity(0, sizeof(saved_affinity_), &saved_affinity_), 0);
+        ASSERT_EQ((int)CpuUtils::SetCpuAffinity({node_cpus_[0]}), TNN_OK);
+    }
+
+    void TearDown() override {
+        if (!node_cpus_.empty()) {
+            sched_setaffinity(0, sizeof(saved_affinity_), &saved_affinity_);
+        }
+    }
+
+    std::vector<int> node_cpus_;
+    cpu_set_t saved_affinity_;
+};
+
+TEST_F(NumaUtilsTest, ThreadGuardRestoresAffinity) {
+    {
+        NumaThreadGuard guard(0);
+        EXPECT_EQ(GetAffinity(), std::set<int>(node_cpus_.begin(), node_cpus_.end()));
+    }
+    EXPECT_EQ(GetAffinity(), std::set<int>({node_cpus_[0]}));
+
+    // no node binds nothing
+    {
+        NumaThreadGuard guard(-1);
+        EXPECT_EQ(GetAffinity(), std::set<int>({node_cpus_[0]}));
+    }
+    EXPECT_EQ(GetAffinity(), std::set<int>({node_cpus_[0]}));
+}
+
+// the caller runs on the node during the forward only, the result does not depend on the binding
+TEST_F(NumaUtilsTest, X86ForwardRestoresCallerAffinity) {
+    if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+        GTEST_SKIP();
+    }
+    std::string proto = "\"1 2 1 4206624770 ,\"\n"
+                        "\"x 1 64 1 1 ,\"\n"
+                        "\" x y ,\"\n"
+                        "\"y ,\"\n"
+                        "\" 1 ,\"\n"
+                        "\"InnerProduct fc 1 1 x y 8 1 0 1 ,\"\n";
+
+    NetworkConfig config;
+    config.device_type = DEVICE_X86;
+    config.numa_node   = 0;
+
+    NetworkTestPair pair;
+    ASSERT_EQ((int)pair.Init(GenerateInterpreterFromProto(proto), config), TNN_OK);
+    for (int i = 0; i < 2; ++i) {
+        ASSERT_EQ((int)pair.SetRandomInputs(i), TNN_OK);
+        ASSERT_EQ((int)pair.Forward(), TNN_OK);
+        EXPECT_EQ(GetAffinity(), std::set<int>({node_cpus_[0]}));
+        EXPECT_EQ((int)pair.Compare(), TNN_OK);
+    }
+}
+
+}  // namespace TNN_NS
+
+#endif  // __linux__ && !__ANDROID__
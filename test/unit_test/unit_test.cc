@@ -14,10 +14,20 @@
 
 #include <gtest/gtest.h>
 #include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "test/flags.h"
 #include "test/test_utils.h"
 #include "test/unit_test/unit_test_common.h"
+#include "test/unit_test/utils/perf_recorder.h"
 
 #include "tnn/utils/omp_utils.h"
 
@@ -30,6 +40,11 @@ void ShowUsage() {
     printf("    -ub \"<bool>\"          %s \n", unit_test_benchmark_message);
     printf("    -th \"<bumber>\"        %s \n", cpu_thread_num_message);
     printf("    -et \"<enable tune>\t%s \n", enable_tune_message);
+    printf("    -wc \"<number>\"        %s \n", warm_up_count_message);
+    printf("    -jp \"<path>\"          layer test timings json to write\n");
+    printf("    --perf-baseline \"<path>\"  %s \n", perf_baseline_message);
+    printf("    --perf-threshold \"<ratio>\"  %s \n", perf_threshold_message);
+    printf("    --shards \"<number>\"  %s \n", shards_message);
 }
 
 bool ParseAndCheckCommandLine(int argc, char *argv[]) {
@@ -42,17 +57,119 @@ bool ParseAndCheckCommandLine(int argc, char *argv[]) {
     return true;
 }
 
+// the shard processes write their timings next to the merged json
+std::string ShardPerfPath(int shard_index) {
+    return FLAGS_jp + ".shard" + std::to_string(shard_index);
+}
+
+int RunTests() {
+    if (!FLAGS_perf_baseline.empty()) {
+        auto status = PerfRecorder::GetInstance().LoadBaseline(FLAGS_perf_baseline);
+        if (status != TNN_OK) {
+            return -1;
+        }
+    }
+
+    int result = RUN_ALL_TESTS();
+
+    if (!FLAGS_jp.empty() && !PerfRecorder::GetInstance().Empty()) {
+        const char* shard_index = getenv("GTEST_SHARD_INDEX");
+        auto path               = shard_index ? ShardPerfPath(atoi(shard_index)) : FLAGS_jp;
+        if (PerfRecorder::GetInstance().Save(path, FLAGS_dt) != TNN_OK) {
+            result = -1;
+        }
+    }
+    return result;
+}
+
+// run the tests in FLAGS_shards child processes through the gtest sharding env vars
+int RunShards(const std::vector<std::string>& args) {
+#ifdef _WIN32
+    LOGE("--shards is not supported on windows, running in one process\n");
+    return RunTests();
+#else
+    const int shard_count = FLAGS_shards;
+    std::vector<pid_t> pids;
+    std::vector<FILE*> logs;
+    for (int i = 0; i < shard_count; ++i) {
+        FILE* log = tmpfile();
+        fflush(stdout);
+        pid_t pid = fork();
+        if (pid == 0) {
+            setenv("GTEST_TOTAL_SHARDS", std::to_string(shard_count).c_str(), 1);
+            setenv("GTEST_SHARD_INDEX", std::to_string(i).c_str(), 1);
+            if (log) {
+                dup2(fileno(log), STDOUT_FILENO);
+                dup2(fileno(log), STDERR_FILENO);
+            }
+            std::vector<char*> argv;
+            for (auto& arg : args) {
+                argv.push_back(const_cast<char*>(arg.c_str()));
+            }
+            argv.push_back(nullptr);
+            execvp(argv[0], argv.data());
+            _exit(127);
+        }
+        if (pid < 0) {
+            LOGE("fork shard %d failed\n", i);
+        }
+        pids.push_back(pid);
+        logs.push_back(log);
+    }
+
+    int result = 0;
+    for (int i = 0; i < shard_count; ++i) {
+        int status  = -1;
+        bool passed = pids[i] > 0 && waitpid(pids[i], &status, 0) == pids[i] && WIFEXITED(status) &&
+                      WEXITSTATUS(status) == 0;
+        if (!passed) {
+            result = -1;
+        }
+        printf("=== Shard %d/%d %s ===\n", i, shard_count, passed ? "passed" : "failed");
+        if (logs[i]) {
+            rewind(logs[i]);
+            char buffer[4096];
+            size_t size = 0;
+            while ((size = fread(buffer, 1, sizeof(buffer), logs[i])) > 0) {
+                fwrite(buffer, 1, size, stdout);
+            }
+            fclose(logs[i]);
+        }
+    }
+
+    if (!FLAGS_jp.empty()) {
+        auto& recorder = PerfRecorder::GetInstance();
+        for (int i = 0; i < shard_count; ++i) {
+            if (recorder.Merge(ShardPerfPath(i)) == TNN_OK) {
+                remove(ShardPerfPath(i).c_str());
+            }
+        }
+        if (recorder.Save(FLAGS_jp, FLAGS_dt) != TNN_OK) {
+            result = -1;
+        }
+    }
+    return result;
+#endif
+}
+
 }  // namespace TNN_NS
 
 GTEST_API_ int main(int argc, char **argv) {
     std::chrono::time_point<std::chrono::system_clock> start = std::chrono::system_clock::now();
 
+    // the shard processes get the original arguments, parsing below removes the known flags
+    std::vector<std::string> args(argv, argv + argc);
+
     int result = 0;
     try {
         ::testing::InitGoogleTest(&argc, argv);
         if (TNN_NS::ParseAndCheckCommandLine(argc, argv)) {
             LOGD("run unit for device type: %s \n", TNN_NS::FLAGS_dt.c_str());
-            result = RUN_ALL_TESTS();
+            if (TNN_NS::FLAGS_shards > 1 && getenv("GTEST_SHARD_INDEX") == nullptr) {
+                result = TNN_NS::RunShards(args);
+            } else {
+                result = TNN_NS::RunTests();
+            }
         }
     } catch (std::exception e) {
         LOGE("unit test catches an exception: %s \n", e.what());
@@ -0,0 +1,130 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#include "test/unit_test/utils/network_test_utils.h"
+
+#include <cmath>
+#include <random>
+
+#include "tnn/utils/dims_vector_utils.h"
+
+namespace TNN_NS {
+
+std::shared_ptr<AbstractModelInterpreter> GenerateInterpreterFromProto(const std::string& proto) {
+    std::shared_ptr<AbstractModelInterpreter> interpreter(CreateModelInterpreter(MODEL_TYPE_TNN));
+    if (!interpreter) {
+        return nullptr;
+    }
+    std::vector<std::string> params = {proto, ""};
+    if (interpreter->Interpret(params) != TNN_OK) {
+        return nullptr;
+    }
+    return interpreter;
+}
+
+Status NetworkTestPair::Init(std::shared_ptr<AbstractModelInterpreter> interp, NetworkConfig device_config,
+                             InputShapesMap min_shapes, InputShapesMap max_shapes) {
+    // the device interpreter is taken from the naive instance, which holds the generated weights
+    return Init(interp, nullptr, device_config, min_shapes, max_shapes);
+}
+
+Status NetworkTestPair::Init(std::shared_ptr<AbstractModelInterpreter> ref_interp,
+                             std::shared_ptr<AbstractModelInterpreter> device_interp, NetworkConfig device_config,
+                             InputShapesMap min_shapes, InputShapesMap max_shapes) {
+    if (!ref_interp) {
+        return Status(TNNERR_NULL_PARAM, "interpreter is null");
+    }
+    ModelConfig model_config;
+    model_config.params = {"", ""};
+
+    NetworkConfig naive_config;
+    naive_config.device_type = DEVICE_NAIVE;
+
+    naive_  = std::make_shared<Instance>(naive_config, model_config);
+    device_ = std::make_shared<Instance>(device_config, model_config);
+    if (max_shapes.empty()) {
+        max_shapes = min_shapes;
+    }
+    Status status = naive_->Init(ref_interp, min_shapes, max_shapes);
+    RETURN_ON_NEQ(status, TNN_OK);
+    if (!device_interp) {
+        device_interp = naive_->GetInterpreter();
+    }
+    return device_->Init(device_interp, min_shapes, max_shapes);
+}
+
+Status NetworkTestPair::Reshape(const InputShapesMap& shapes) {
+    Status status = naive_->Reshape(shapes);
+    RETURN_ON_NEQ(status, TNN_OK);
+    return device_->Reshape(shapes);
+}
+
+Status NetworkTestPair::SetRandomInputs(int seed) {
+    BlobMap input_blobs;
+    Status status = naive_->GetAllInputBlobs(input_blobs);
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    std::mt19937 generator(seed);
+    std::uniform_real_distribution<float> distribution(-1.0f, 1.0f);
+    for (auto iter : input_blobs) {
+        auto dims = iter.second->GetBlobDesc().dims;
+        auto mat  = std::make_shared<Mat>(DEVICE_NAIVE, NCHW_FLOAT, dims);
+        auto data = reinterpret_cast<float*>(mat->GetData());
+        for (int i = 0; i < DimsVectorUtils::Count(dims); ++i) {
+            data[i] = distribution(generator);
+        }
+        status = naive_->SetInputMat(mat, MatConvertParam(), iter.first);
+        RETURN_ON_NEQ(status, TNN_OK);
+        status = device_->SetInputMat(mat, MatConvertParam(), iter.first);
+        RETURN_ON_NEQ(status, TNN_OK);
+    }
+    return TNN_OK;
+}
+
+Status NetworkTestPair::Forward() {
+    Status status = naive_->Forward();
+    RETURN_ON_NEQ(status, TNN_OK);
+    return device_->Forward();
+}
+
+Status NetworkTestPair::Compare(float ep, float dp) {
+    BlobMap output_blobs;
+    Status status = naive_->GetAllOutputBlobs(output_blobs);
+    RETURN_ON_NEQ(status, TNN_OK);
+
+    for (auto iter : output_blobs) {
+        std::shared_ptr<Mat> ref_mat, device_mat;
+        status = naive_->GetOutputMat(ref_mat, MatConvertParam(), iter.first, DEVICE_NAIVE);
+        RETURN_ON_NEQ(status, TNN_OK);
+        status = device_->GetOutputMat(device_mat, MatConvertParam(), iter.first, DEVICE_NAIVE);
+        RETURN_ON_NEQ(status, TNN_OK);
+        if (!DimsVectorUtils::Equal(ref_mat->GetDims(), device_mat->GetDims())) {
+            LOGE("output %s has different dims\n", iter.first.c_str());
+            return Status(TNNERR_COMMON_ERROR, "output dims mismatch");
+        }
+        auto ref_data    = reinterpret_cast<float*>(ref_mat->GetData());
+        auto device_data = reinterpret_cast<float*>(device_mat->GetData());
+        for (int i = 0; i < DimsVectorUtils::Count(ref_mat->GetDims()); ++i) {
+            float diff = std::fabs(device_data[i] - ref_data[i]);
+            if (diff > ep * (std::fabs(device_data[i]) + std::fabs(ref_data[i])) && diff > dp) {
+                LOGE("output %s differs from the naive reference at %d: %f vs %f\n", iter.first.c_str(), i,
+                     device_data[i], ref_data[i]);
+                return Status(TNNERR_COMMON_ERROR, "output data mismatch");
+            }
+        }
+    }
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,60 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef TNN_TEST_UNIT_TEST_UTILS_NETWORK_TEST_UTILS_H_
+#define TNN_TEST_UNIT_TEST_UTILS_NETWORK_TEST_UTILS_H_
+
+#include <memory>
+#include <string>
+
+#include "tnn/core/common.h"
+#include "tnn/core/instance.h"
+#include "tnn/core/status.h"
+#include "tnn/interpreter/abstract_model_interpreter.h"
+
+namespace TNN_NS {
+
+// @brief interpreter of a tnnproto text, the layer resources are generated at init
+std::shared_ptr<AbstractModelInterpreter> GenerateInterpreterFromProto(const std::string& proto);
+
+// @brief a naive reference instance and a device instance running the same network with the same weights
+class NetworkTestPair {
+public:
+    // min_shapes and max_shapes may be empty to use the shapes of the proto
+    Status Init(std::shared_ptr<AbstractModelInterpreter> interp, NetworkConfig device_config,
+                InputShapesMap min_shapes = InputShapesMap(), InputShapesMap max_shapes = InputShapesMap());
+
+    // the reference runs ref_interp instead, e.g. with the weights that the device quantizes dequantized in advance
+    Status Init(std::shared_ptr<AbstractModelInterpreter> ref_interp,
+                std::shared_ptr<AbstractModelInterpreter> device_interp, NetworkConfig device_config,
+                InputShapesMap min_shapes = InputShapesMap(), InputShapesMap max_shapes = InputShapesMap());
+
+    Status Reshape(const InputShapesMap& shapes);
+
+    // fill the same random data into the inputs of both instances
+    Status SetRandomInputs(int seed);
+
+    Status Forward();
+
+    // compare all float outputs of the device against the naive reference,
+    // an element fails if it is off by more than ep relative and dp absolute
+    Status Compare(float ep = 1e-4f, float dp = 1e-4f);
+
+    std::shared_ptr<Instance> naive_  = nullptr;
+    std::shared_ptr<Instance> device_ = nullptr;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_TEST_UNIT_TEST_UTILS_NETWORK_TEST_UTILS_H_
@@ -0,0 +1,211 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "test/unit_test/utils/perf_recorder.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#include "tnn/core/macro.h"
+
+namespace TNN_NS {
+
+namespace {
+
+// reader of the json subset written by PerfRecorder::Save
+class PerfJsonReader {
+public:
+    explicit PerfJsonReader(const std::string& text) : text_(text) {}
+
+    bool ReadCases(std::map<std::string, CasePerf>& cases) {
+        auto pos = text_.find("\"cases\"");
+        if (pos == std::string::npos) {
+            return false;
+        }
+        pos_ = pos + 7;
+        if (!Expect(':') || !Expect('{')) {
+            return false;
+        }
+        if (Peek() == '}') {
+            return true;
+        }
+        while (true) {
+            std::string name;
+            if (!ReadString(name) || !Expect(':') || !Expect('{')) {
+                return false;
+            }
+            CasePerf perf;
+            while (Peek() != '}') {
+                std::string field;
+                double value = 0;
+                if (!ReadString(field) || !Expect(':') || !ReadNumber(value)) {
+                    return false;
+                }
+                if (field == "device_ms") {
+                    perf.device_ms = value;
+                } else if (field == "naive_ms") {
+                    perf.naive_ms = value;
+                }
+                if (Peek() == ',') {
+                    pos_++;
+                }
+            }
+            pos_++;
+            cases[name] = perf;
+            if (Peek() == ',') {
+                pos_++;
+                continue;
+            }
+            return Expect('}');
+        }
+    }
+
+private:
+    char Peek() {
+        while (pos_ < text_.size() && isspace(text_[pos_])) {
+            pos_++;
+        }
+        return pos_ < text_.size() ? text_[pos_] : '\0';
+    }
+
+    bool Expect(char c) {
+        if (Peek() != c) {
+            return false;
+        }
+        pos_++;
+        return true;
+    }
+
+    bool ReadString(std::string& str) {
+        if (!Expect('"')) {
+            return false;
+        }
+        str.clear();
+        while (pos_ < text_.size() && text_[pos_] != '"') {
+            if (text_[pos_] == '\\' && pos_ + 1 < text_.size()) {
+                pos_++;
+            }
+            str.push_back(text_[pos_++]);
+        }
+        return Expect('"');
+    }
+
+    bool ReadNumber(double& value) {
+        Peek();
+        const char* begin = text_.c_str() + pos_;
+        char* end         = nullptr;
+        value             = strtod(begin, &end);
+        if (end == begin) {
+            return false;
+        }
+        pos_ += end - begin;
+        return true;
+    }
+
+    const std::string& text_;
+    size_t pos_ = 0;
+};
+
+std::string EscapeJson(const std::string& str) {
+    std::string result;
+    for (auto c : str) {
+        if (c == '"' || c == '\\') {
+            result.push_back('\\');
+        }
+        result.push_back(c);
+    }
+    return result;
+}
+
+}  // namespace
+
+PerfRecorder& PerfRecorder::GetInstance() {
+    static PerfRecorder recorder;
+    return recorder;
+}
+
+std::string PerfRecorder::Record(const std::string& test_name, const CasePerf& perf) {
+    // tests running several networks get one case per run
+    int run   = run_count_[test_name]++;
+    auto key  = run == 0 ? test_name : test_name + "#" + std::to_string(run);
+    cases_[key] = perf;
+    return key;
+}
+
+bool PerfRecorder::Compare(const std::string& key, const CasePerf& perf, double min_ms, double& slowdown) {
+    auto iter = baseline_.find(key);
+    if (iter == baseline_.end() || iter->second.device_ms < min_ms || iter->second.device_ms <= 0 ||
+        perf.device_ms <= 0) {
+        return false;
+    }
+    const auto& base = iter->second;
+    slowdown         = perf.device_ms / base.device_ms;
+    if (perf.naive_ms > 0 && base.naive_ms > 0) {
+        // the naive device runs the same scalar code everywhere, it cancels out the speed of the machine
+        slowdown = (perf.device_ms / perf.naive_ms) / (base.device_ms / base.naive_ms);
+    }
+    return true;
+}
+
+Status PerfRecorder::LoadBaseline(const std::string& path) {
+    baseline_.clear();
+    return Load(path, baseline_);
+}
+
+Status PerfRecorder::Merge(const std::string& path) {
+    return Load(path, cases_);
+}
+
+bool PerfRecorder::Empty() const {
+    return cases_.empty();
+}
+
+Status PerfRecorder::Load(const std::string& path, std::map<std::string, CasePerf>& cases) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOGE("PerfRecorder: open %s failed\n", path.c_str());
+        return Status(TNNERR_INVALID_INPUT, "open perf json failed");
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    PerfJsonReader reader(text);
+    if (!reader.ReadCases(cases)) {
+        LOGE("PerfRecorder: %s is not a layer test perf json\n", path.c_str());
+        return Status(TNNERR_INVALID_INPUT, "invalid perf json");
+    }
+    return TNN_OK;
+}
+
+Status PerfRecorder::Save(const std::string& path, const std::string& device) const {
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        LOGE("PerfRecorder: create %s failed\n", path.c_str());
+        return Status(TNNERR_INVALID_INPUT, "create perf json failed");
+    }
+    file << "{\"device\": \"" << EscapeJson(device) << "\", \"cases\": {";
+    bool first = true;
+    for (const auto& item : cases_) {
+        file << (first ? "\n  " : ",\n  ") << "\"" << EscapeJson(item.first) << "\": {\"device_ms\": "
+             << item.second.device_ms << ", \"naive_ms\": " << item.second.naive_ms << "}";
+        first = false;
+    }
+    file << "\n}}\n";
+    return TNN_OK;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,66 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_TEST_UNIT_TEST_UTILS_PERF_RECORDER_H_
+#define TNN_TEST_UNIT_TEST_UTILS_PERF_RECORDER_H_
+
+#include <map>
+#include <string>
+
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+struct CasePerf {
+    // min forward time of the target device
+    double device_ms = 0;
+    // forward time of the naive device, 0 if it did not run
+    double naive_ms = 0;
+};
+
+// forward times of the layer test cases, saved to and compared against a json file of the form
+// {"device": "X86", "cases": {"<test name>": {"device_ms": 0.1, "naive_ms": 2.0}, ...}}
+class PerfRecorder {
+public:
+    static PerfRecorder& GetInstance();
+
+    // @brief record the case, returns the key it is stored under
+    std::string Record(const std::string& test_name, const CasePerf& perf);
+
+    // @brief compare with the baseline case of the same key, slowdown is the ratio of the device time to the
+    // baseline one, normalized by the naive time if both runs have it
+    // @return false if the baseline has no such case or its device time is below min_ms
+    bool Compare(const std::string& key, const CasePerf& perf, double min_ms, double& slowdown);
+
+    Status LoadBaseline(const std::string& path);
+
+    Status Save(const std::string& path, const std::string& device) const;
+
+    // @brief add the cases of another json file, used to merge the shards
+    Status Merge(const std::string& path);
+
+    bool Empty() const;
+
+private:
+    static Status Load(const std::string& path, std::map<std::string, CasePerf>& cases);
+
+    std::map<std::string, CasePerf> cases_;
+    std::map<std::string, CasePerf> baseline_;
+    std::map<std::string, int> run_count_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_TEST_UNIT_TEST_UTILS_PERF_RECORDER_H_
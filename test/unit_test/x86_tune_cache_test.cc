@@ -0,0 +1,233 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+#ifndef _WIN32
+
+#include <gtest/gtest.h>
+#include <stdlib.h>
+
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "test/flags.h"
+#include "test/test_utils.h"
+#include "test/unit_test/utils/network_test_utils.h"
+
+namespace TNN_NS {
+
+static const std::string kTuneCacheVersion = "tnn_x86_tune_v1";
+
+// the tune results are kept for the whole process, every test tunes inner products of its own input channels
+class X86TuneCacheTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        if (DEVICE_X86 != ConvertDeviceType(FLAGS_dt)) {
+            GTEST_SKIP();
+        }
+        char dir[] = "/tmp/tnn_tune_cache_XXXXXX";
+        ASSERT_NE(mkdtemp(dir), nullptr);
+        cache_path_ = dir;
+    }
+
+    void TearDown() override {
+        if (!cache_path_.empty()) {
+            std::remove(CacheFile().c_str());
+            std::remove(cache_path_.c_str());
+        }
+    }
+
+    std::string CacheFile() {
+        return cache_path_ + "/tnn_x86_tune.cache";
+    }
+
+    static int NextChannel() {
+        static int channel = 1000;
+        return ++channel;
+    }
+
+    // tune an inner product from 1 x channel to 8 outputs and check it against the naive device
+    Status RunInnerProduct(int channel) {
+        std::ostringstream proto;
+        proto << "\"1 2 1 4206624770 ,\"\n"
+              << "\"x 1 " << channel << " 1 1 ,\"\n"
+              << "\" x y ,\"\n"
+              << "\"y ,\"\n"
+              << "\" 1 ,\"\n"
+              << "\"InnerProduct fc 1 1 x y 8 1 0 1 ,\"\n";
+
+        NetworkConfig config;
+        config.device_type        = DEVICE_X86;
+        config.enable_tune_kernel = true;
+        config.cache_path         = cache_path_;
+
+        NetworkTestPair pair;
+        RETURN_ON_NEQ(pair.Init(GenerateInterpreterFromProto(proto.str()), config), TNN_OK);
+        RETURN_ON_NEQ(pair.SetRandomInputs(0), TNN_OK);
+        RETURN_ON_NEQ(pair.Forward(), TNN_OK);
+        return pair.Compare();
+    }
+
+    std::string ReadFile() {
+        std::ifstream stream(CacheFile());
+        std::stringstream content;
+        content << stream.rdbuf();
+        return content.str();
+    }
+
+    void WriteFile(const std::string& content) {
+        std::ofstream stream(CacheFile());
+        stream << content;
+    }
+
+    // the results of the cache file, or an empty map if it is not a valid file
+    std::map<std::string, std::vector<int>> ParseFile() {
+        std::map<std::string, std::vector<int>> results;
+        std::ifstream stream(CacheFile());
+        std::string version;
+        int count = 0;
+        if (!(stream >> version >> count) || version != kTuneCacheVersion) {
+            return {};
+        }
+        for (int i = 0; i < count; ++i) {
+            std::string key;
+            int size = 0;
+            stream >> key >> size;
+            std::vector<int> values(size);
+            for (auto& value : values) {
+                stream >> value;
+            }
+            results[key] = values;
+        }
+        std::string extra;
+        if (stream.fail() || stream >> extra) {
+            return {};
+        }
+        return results;
+    }
+
+    // the key of the inner product of the given input channels, as written to the cache file by a tuned run
+    std::string KeyOf(int channel, const std::string& key_of_other, int other_channel) {
+        auto key  = key_of_other;
+        auto from = "_ix1x" + std::to_string(other_channel) + "x1x1_";
+        key.replace(key.find(from), from.size(), "_ix1x" + std::to_string(channel) + "x1x1_");
+        return key;
+    }
+
+    std::string FindKey(const std::map<std::string, std::vector<int>>& results, int channel) {
+        auto pattern = "inner_product_ix1x" + std::to_string(channel) + "x1x1_";
+        for (const auto& result : results) {
+            if (result.first.find(pattern) == 0) {
+                return result.first;
+            }
+        }
+        return "";
+    }
+
+    std::string cache_path_;
+};
+
+// the file holds every result of the process, and a result read back from it is used without tuning again
+TEST_F(X86TuneCacheTest, RoundTrip) {
+    int tuned = NextChannel();
+    ASSERT_EQ((int)RunInnerProduct(tuned), TNN_OK);
+    auto results = ParseFile();
+    auto key     = FindKey(results, tuned);
+    ASSERT_FALSE(key.empty()) << ReadFile();
+    ASSERT_EQ(results[key].size(), 2);
+
+    // a fresh directory that holds a result for a shape this process has not tuned yet
+    TearDown();
+    SetUp();
+    int cached = NextChannel();
+    std::ostringstream content;
+    content << kTuneCacheVersion << " 1\n" << KeyOf(cached, key, tuned) << " 2 1 512\n";
+    WriteFile(content.str());
+
+    ASSERT_EQ((int)RunInnerProduct(cached), TNN_OK);
+    EXPECT_EQ(ReadFile(), content.str());
+}
+
+// a result of another thread number does not match, the layer is tuned and the file rewritten
+TEST_F(X86TuneCacheTest, KeyMismatch) {
+    int other = NextChannel();
+    ASSERT_EQ((int)RunInnerProduct(other), TNN_OK);
+    auto other_key = FindKey(ParseFile(), other);
+    ASSERT_FALSE(other_key.empty());
+
+    TearDown();
+    SetUp();
+    int channel   = NextChannel();
+    auto key      = KeyOf(channel, other_key, other);
+    auto mismatch = key.substr(0, key.rfind("_t")) + "_t999";
+    WriteFile(kTuneCacheVersion + " 1\n" + mismatch + " 2 1 512\n");
+
+    ASSERT_EQ((int)RunInnerProduct(channel), TNN_OK);
+    auto results = ParseFile();
+    EXPECT_EQ(results.count(key), 1) << ReadFile();
+    EXPECT_EQ(results.count(mismatch), 1) << ReadFile();
+}
+
+// a damaged file is dropped as a whole and rewritten, a value that is not a candidate is tuned again
+TEST_F(X86TuneCacheTest, CorruptFile) {
+    int other = NextChannel();
+    ASSERT_EQ((int)RunInnerProduct(other), TNN_OK);
+    auto other_key = FindKey(ParseFile(), other);
+    ASSERT_FALSE(other_key.empty());
+
+    int invalid = NextChannel();
+    for (const std::string& content : {std::string("garbage"), kTuneCacheVersion + " 3\n" + other_key + " 2 0",
+                                       kTuneCacheVersion + " 1\n" + other_key + " 2000000000 0 0\n"}) {
+        TearDown();
+        SetUp();
+        WriteFile(content);
+        int channel = NextChannel();
+        ASSERT_EQ((int)RunInnerProduct(channel), TNN_OK);
+        auto results = ParseFile();
+        EXPECT_FALSE(FindKey(results, channel).empty()) << ReadFile();
+    }
+
+    TearDown();
+    SetUp();
+    auto key = KeyOf(invalid, other_key, other);
+    WriteFile(kTuneCacheVersion + " 1\n" + key + " 2 7 -3\n");
+    ASSERT_EQ((int)RunInnerProduct(invalid), TNN_OK);
+    auto results = ParseFile();
+    ASSERT_EQ(results.count(key), 1) << ReadFile();
+    EXPECT_NE(results[key], std::vector<int>({7, -3}));
+}
+
+// files of another version, or of the format without a version, are not read
+TEST_F(X86TuneCacheTest, StaleFile) {
+    int other = NextChannel();
+    ASSERT_EQ((int)RunInnerProduct(other), TNN_OK);
+    auto other_key = FindKey(ParseFile(), other);
+    ASSERT_FALSE(other_key.empty());
+
+    for (const std::string& header : {std::string("tnn_x86_tune_v0 1\n"), std::string("1\n")}) {
+        TearDown();
+        SetUp();
+        int channel = NextChannel();
+        auto key    = KeyOf(channel, other_key, other);
+        WriteFile(header + key + " 2 1 512\n");
+        ASSERT_EQ((int)RunInnerProduct(channel), TNN_OK);
+        EXPECT_EQ(ParseFile().count(key), 1) << ReadFile();
+    }
+}
+
+}  // namespace TNN_NS
+
+#endif  // _WIN32
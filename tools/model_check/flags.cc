@@ -44,4 +44,12 @@ DEFINE_string(sp, "", set_precision_message);
 
 DEFINE_string(du, "", dump_unaligned_layer_path_message);
 
+DEFINE_string(tp, "", tolerance_profile_message);
+
+DEFINE_bool(bs, false, first_unaligned_message);
+
+DEFINE_int32(ct, 0, compare_threads_message);
+
+DEFINE_int32(th, 1, cpu_threads_message);
+
 }  // namespace TNN_NS
@@ -48,6 +48,14 @@ static const char set_precision_message[] = "(optional) specify tnn precision ty
 
 static const char dump_unaligned_layer_path_message[] = "(optional) specify the path for dump unaligned layer";
 
+static const char tolerance_profile_message[] = "(optional) per layer type tolerance: default, fp16, int8 or a profile file with lines \"<layer type|*> <relative> <absolute> <cosine> [integer]\"";
+
+static const char first_unaligned_message[] = "(optional) stop at the first unaligned layer instead of comparing all layers";
+
+static const char compare_threads_message[] = "(optional) threads comparing blobs, default is all cores";
+
+static const char cpu_threads_message[] = "(optional) threads of the cpu reference, results are the same for any count, default is 1";
+
 DECLARE_bool(h);
 
 DECLARE_string(p);
@@ -75,6 +83,14 @@ DECLARE_string(sp);
 DECLARE_string(do);
 
 DECLARE_string(du);
+
+DECLARE_string(tp);
+
+DECLARE_bool(bs);
+
+DECLARE_int32(ct);
+
+DECLARE_int32(th);
 }  // namespace TNN_NS
 
 #endif  // TNN_TOOLS_MODEL_CHECK_FLAGS_H_
@@ -164,6 +164,10 @@ void ShowUsage() {
     printf("\t-do, <dir path>   \t%s\n", dump_output_path_message);
     printf("\t-du, <dir path>   \t%s\n", dump_unaligned_layer_path_message);
     printf("\t-sp, <set precision>\t%s\n", set_precision_message);
+    printf("\t-tp, <tolerance>\t%s\n", tolerance_profile_message);
+    printf("\t-bs, <first unaligned>\t%s\n", first_unaligned_message);
+    printf("\t-ct, <threads>  \t%s\n", compare_threads_message);
+    printf("\t-th, <threads>  \t%s\n", cpu_threads_message);
 }
 
 bool ParseAndCheckCommandLine(int argc, char* argv[]) {
@@ -205,6 +209,10 @@ int main(int argc, char* argv[]) {
     model_checker_param.only_check_output = FLAGS_e;
     model_checker_param.check_batch       = FLAGS_b;
     model_checker_param.dump_unaligned_layer_path = FLAGS_du;
+    model_checker_param.tolerance_profile = FLAGS_tp;
+    model_checker_param.stop_at_first_unaligned = FLAGS_bs;
+    model_checker_param.compare_threads   = FLAGS_ct;
+    model_checker_param.cpu_threads       = FLAGS_th;
 
     printf("proto: %s\n", proto_file_name.c_str());
     printf("model: %s\n", model_file_name.c_str());
@@ -245,6 +253,12 @@ int main(int argc, char* argv[]) {
     if(FLAGS_b) {
         printf("check result of multi batch\n");
     }
+    if(!FLAGS_tp.empty()) {
+        printf("tolerance profile: %s\n", FLAGS_tp.c_str());
+    }
+    if(FLAGS_bs) {
+        printf("stop at the first unaligned layer\n");
+    }
 
     if ("" == model_checker_param.input_file.first && "" != model_checker_param.ref_file.first) {
         printf("Error: there is no input file for output reference file!\n");
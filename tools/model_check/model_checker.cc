@@ -20,9 +20,15 @@
 #include <string.h>
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <condition_variable>
 #include <fstream>
+#include <functional>
+#include <mutex>
+#include <queue>
 #include <random>
+#include <thread>
 
 #include "file_reader.h"
 #include "tnn/core/macro.h"
@@ -35,12 +41,114 @@
 
 namespace TNN_NS {
 
+namespace {
+
+// blobs of the cpu instance, filled by the cpu forward thread and taken by the compare tasks
+class CpuBlobStore {
+public:
+    void Put(const std::string& name, std::shared_ptr<char> data) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        blobs_[name] = data;
+        cond_.notify_all();
+    }
+
+    void Finish(Status status) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        status_   = status;
+        finished_ = true;
+        cond_.notify_all();
+    }
+
+    // wait for the blob, returns nullptr if the cpu forward finished without producing it
+    std::shared_ptr<char> Take(const std::string& name) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        cond_.wait(lock, [&] { return finished_ || blobs_.count(name) > 0; });
+        auto iter = blobs_.find(name);
+        if (iter == blobs_.end()) {
+            return nullptr;
+        }
+        auto data = iter->second;
+        blobs_.erase(iter);
+        return data;
+    }
+
+    Status GetStatus() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return status_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::map<std::string, std::shared_ptr<char>> blobs_;
+    Status status_ = TNN_OK;
+    bool finished_ = false;
+};
+
+// fixed size thread pool running the compare tasks
+class CompareWorkers {
+public:
+    explicit CompareWorkers(int count) {
+        for (int i = 0; i < std::max(count, 1); ++i) {
+            threads_.emplace_back([this] { Run(); });
+        }
+    }
+
+    ~CompareWorkers() {
+        Join();
+    }
+
+    void Submit(std::function<void()> task) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        tasks_.push(std::move(task));
+        cond_.notify_one();
+    }
+
+    // run the remaining tasks and stop the threads
+    void Join() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+            cond_.notify_all();
+        }
+        for (auto& thread : threads_) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+    }
+
+private:
+    void Run() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cond_.wait(lock, [&] { return stop_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> threads_;
+    std::queue<std::function<void()>> tasks_;
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_ = false;
+};
+
+}  // namespace
+
 ModelChecker::ModelChecker() {
     model_checker_params_.input_file  = std::make_pair("", NOTSUPPORT);
     model_checker_params_.input_bias  = {0, 0, 0, 0};
     model_checker_params_.input_scale = {1.0f, 1.0f, 1.0f, 1.0f};
     output_ref_mat_map_.clear();
-    cpu_blobdata_map.clear();
     check_results.clear();
 }
 
@@ -82,6 +190,8 @@ Status ModelChecker::Init(NetworkConfig& net_config, ModelConfig& model_config)
         LOGE("create cpu instance failed: %s\n", status.description().c_str());
         return status;
     }
+    status = instance_cpu_->SetCpuNumThreads(std::max(model_checker_params_.cpu_threads, 1));
+    RETURN_ON_NEQ(status, TNN_OK);
 
     // just compare the output if Device is NAIVE
     if (net_config.device_type == DEVICE_NAIVE) {
@@ -105,7 +215,7 @@ Status ModelChecker::Init(NetworkConfig& net_config, ModelConfig& model_config)
 
 Status ModelChecker::SetModelCheckerParams(ModelCheckerParam params) {
     model_checker_params_ = params;
-    return TNN_OK;
+    return tolerance_profile_.Load(params.tolerance_profile);
 }
 
 Status ModelChecker::RunModelChecker() {
@@ -116,6 +226,8 @@ Status ModelChecker::RunModelChecker() {
     } else {
         if (!model_checker_params_.dump_dir_path.empty()) {
             ret = RunModelCheckerFromDumpFile();
+        } else if (model_checker_params_.stop_at_first_unaligned) {
+            ret = RunModelCheckerFirstUnaligned();
         } else {
             ret = RunModelCheckerPerLayer();
         }
@@ -159,14 +271,8 @@ Status ModelChecker::RunModelCheckerPerLayer() {
         return Status(TNNERR_COMMON_ERROR, "get output reference data failed");
     }
 
-    // get cpu instance blobs data
-    ret = GetCpuBlobData();
-    if (ret != TNN_OK) {
-        return Status(TNNERR_COMMON_ERROR, "get cpu blob data failed");
-    }
-
     // compare between cpu and device
-    ret = CompareDeviceAndCpu();
+    ret = ForwardAndCompare(std::set<std::string>());
     if (ret != TNN_OK) {
         return Status(TNNERR_COMMON_ERROR, "compare device and cpu data failed");
     }
@@ -196,6 +302,42 @@ Status ModelChecker::RunModelCheckerPerLayer() {
     }
 }
 
+Status ModelChecker::RunModelCheckerFirstUnaligned() {
+    LOGD("ModelChecker::RunModelCheckerFirstUnaligned\n");
+    Status ret = FeedInputData();
+    if (ret != TNN_OK) {
+        return Status(TNNERR_COMMON_ERROR, "feed input data failed");
+    }
+
+    ret = GetOutputRefData();
+    if (ret != TNN_OK) {
+        return Status(TNNERR_COMMON_ERROR, "get output reference data failed");
+    }
+
+    ret = ForwardAndCompare(std::set<std::string>(), true);
+    if (ret != TNN_OK) {
+        return Status(TNNERR_COMMON_ERROR, "compare device and cpu data failed");
+    }
+
+    // layers after the first unaligned one may not have been compared
+    for (size_t i = 0; i < check_results.size(); ++i) {
+        if (check_results[i].second) {
+            continue;
+        }
+        auto info = check_results[i].first;
+        LOGE("first unaligned layer: %d of %d compared (layer name: %s,  layer type: %s)\n", (int)i + 1,
+             (int)check_results.size(), info->name.c_str(), info->type_str.c_str());
+        if (i > 0) {
+            info = check_results[i - 1].first;
+            printf("previous layer is aligned (layer name: %s,  layer type: %s)\n", info->name.c_str(),
+                   info->type_str.c_str());
+        }
+        return Status(TNNERR_COMMON_ERROR, "model check failed");
+    }
+    printf("all %d layers are aligned\n", (int)check_results.size());
+    return TNN_OK;
+}
+
 Status ModelChecker::RunModelCheckerFromDumpFile() {
     LOGD("ModelChecker::RunModelCheckerFromDumpFile\n");
     Status status = FeedInputData();
@@ -228,7 +370,8 @@ Status ModelChecker::RunModelCheckerFromDumpFile() {
             auto* tnn_data_ptr  = blob->GetHandle().base;
             auto data_dims      = blob->GetBlobDesc().dims;
 
-            check_pass &= CompareData(dump_data_ptr, tnn_data_ptr, data_type, data_dims);
+            check_pass &= CompareData(dump_data_ptr, tnn_data_ptr, data_type, data_dims,
+                                      tolerance_profile_.Get(info->type));
             if (!check_pass) {
                 check_results.push_back(std::make_pair(info, check_pass));
 
@@ -353,12 +496,14 @@ Status ModelChecker::RunModelCheckerOutput() {
                             (char*)output_ref_mat_map_[blob_name]->GetData() + offset,
                             data_type,
                             compare_dims,
+                            tolerance_profile_.GetDefault(),
                             COSINE)) {
                 check_result = true;
             } else if (CompareData((char*)device_output_mat_map[blob_name]->GetData() + offset,
                                    (char*)output_ref_mat_map_[blob_name]->GetData() + offset,
                                    data_type,
-                                   compare_dims)) {
+                                   compare_dims,
+                                   tolerance_profile_.GetDefault())) {
                 check_result = true;
             } else {
                 check_result = false;
@@ -565,19 +710,6 @@ Status ModelChecker::GetOutputRefData() {
     return TNN_OK;
 }
 
-Status ModelChecker::GetCpuBlobData() {
-    BlobStatisticCallback cpu_func_after = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
-        for (auto blob : blobs) {
-            auto ret = GetBlobData(instance_cpu_.get(), blob, cpu_blobdata_map);
-            if (ret != TNN_OK) {
-                LOGE("get blob data failed (%s)\n", ret.description().c_str());
-            }
-        }
-    };
-
-    return instance_cpu_->ForwardWithCallback(nullptr, cpu_func_after);
-}
-
 Status ModelChecker::GetOutputData(Instance* instance, std::map<std::string, std::shared_ptr<Mat>>& output_map) {
     BlobMap output_blobs;
     instance->GetAllOutputBlobs(output_blobs);
@@ -655,80 +787,156 @@ Status ModelChecker::GetBlobData(Instance* instance, Blob* blob,
     return TNN_OK;
 }
 
-Status ModelChecker::CompareDeviceAndCpu() {
+Status ModelChecker::ForwardAndCompare(const std::set<std::string>& filter, bool stop_on_failure) {
     BlobMap output_blobs_device;
     instance_device_->GetAllOutputBlobs(output_blobs_device);
 
     check_results.clear();
+    // set by the compare tasks, both forwards still run to the end but copy no more blobs
+    std::atomic<bool> stopped(false);
+
+    // the cpu instance runs on its own thread, its blobs are kept until the device blob of the same name is compared
+    CpuBlobStore cpu_blobs;
+    std::thread cpu_thread([&] {
+        BlobStatisticCallback cpu_func_after = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
+            if (stopped) {
+                return;
+            }
+            for (auto blob : blobs) {
+                if (!filter.empty() && filter.count(blob->GetBlobDesc().name) == 0) {
+                    continue;
+                }
+                std::map<std::string, std::shared_ptr<char>> cpu_output_map;
+                auto ret = GetBlobData(instance_cpu_.get(), blob, cpu_output_map);
+                if (ret != TNN_OK) {
+                    LOGE("get blob data failed (%s)\n", ret.description().c_str());
+                    continue;
+                }
+                cpu_blobs.Put(blob->GetBlobDesc().name, cpu_output_map.begin()->second);
+            }
+        };
+        cpu_blobs.Finish(instance_cpu_->ForwardWithCallback(nullptr, cpu_func_after));
+    });
+    // the same instance can not run two forwards at once
+    if (instance_device_ == instance_cpu_) {
+        cpu_thread.join();
+    }
 
-    BlobStatisticCallback device_func_after = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
-        bool is_pass = true;
+    int compare_threads = model_checker_params_.compare_threads;
+    if (compare_threads <= 0) {
+        compare_threads = std::max(static_cast<int>(std::thread::hardware_concurrency()), 1);
+    }
+    std::mutex result_mutex;
+    CompareWorkers workers(compare_threads);
 
+    BlobStatisticCallback device_func_after = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
+        // the cpu instance has no reformat layers, their blobs would never be produced there
+        if (info->type == LAYER_REFORMAT) {
+            LOGD("skip reformat layer: %s\n", info->name.c_str());
+            return;
+        }
+        if (stopped) {
+            return;
+        }
+        int result_index = -1;
         for (auto blob : blobs) {
-            std::map<std::string, std::shared_ptr<char>> device_output_map;
             auto blob_desc        = blob->GetBlobDesc();
             std::string blob_name = blob_desc.name;
-            auto ret              = GetBlobData(instance_device_.get(), blob, device_output_map);
-            if (ret != TNN_OK) {
-                LOGE("get blob data failed (%s)\n", ret.description().c_str());
+            if (!filter.empty() && filter.count(blob_name) == 0) {
+                continue;
+            }
+            if (result_index < 0) {
+                std::lock_guard<std::mutex> lock(result_mutex);
+                result_index = static_cast<int>(check_results.size());
+                check_results.push_back(std::make_pair(info, true));
             }
-            char* output_data_ptr = device_output_map[blob_name].get();
-            const auto data_type  = blob_desc.data_type == DATA_TYPE_HALF ? DATA_TYPE_FLOAT : blob_desc.data_type;
 
-            // compare device data with default data
-            if (cpu_blobdata_map.count(blob_name) <= 0 && info->type == LAYER_REFORMAT) {
-                printf("Skip reformat laye:%s\n", info->name.c_str());
-                return;
+            std::map<std::string, std::shared_ptr<char>> device_output_map;
+            auto ret = GetBlobData(instance_device_.get(), blob, device_output_map);
+            if (ret != TNN_OK) {
+                LOGE("get blob data failed (%s)\n", ret.description().c_str());
+                std::lock_guard<std::mutex> lock(result_mutex);
+                check_results[result_index].second = false;
+                continue;
             }
-            is_pass &= CompareData(output_data_ptr, cpu_blobdata_map[blob_name].get(), data_type, blob_desc.dims);
-
-            // compare data with reference file
-            if (!output_ref_mat_map_.empty()) {
-                if (output_blobs_device.find(blob_name) != output_blobs_device.end()) {
-                    if (output_ref_mat_map_.find(blob_name) != output_ref_mat_map_.end()) {
-                        auto compare_data = output_ref_mat_map_[blob_name]->GetData();
-                        is_pass &= CompareData(output_data_ptr, compare_data, data_type, blob_desc.dims);
-                    } else {
-                        LOGE("The output layer name: %s not find in the reference file.\n", blob_name.c_str());
-                        is_pass = false;
-                    }
+            auto device_data     = device_output_map[blob_name];
+            const auto data_type = blob_desc.data_type == DATA_TYPE_HALF ? DATA_TYPE_FLOAT : blob_desc.data_type;
+            const bool is_output = output_blobs_device.find(blob_name) != output_blobs_device.end();
+
+            workers.Submit([&, info, blob_name, device_data, data_type, blob_desc, is_output, result_index] {
+                auto cpu_data = cpu_blobs.Take(blob_name);
+                if (cpu_data == nullptr && stopped) {
+                    // the cpu forward stopped copying after an earlier unaligned layer
+                    return;
                 }
-            }
-
-            if (!model_checker_params_.dump_output_path.empty()) {
-                if (output_blobs_device.find(blob_name) != output_blobs_device.end()) {
-                    LOGE("dump blob (%s) data to %s\n", blob_name.c_str(),
-                         model_checker_params_.dump_output_path.c_str());
-                    auto replace_name = blob_name;
-                    std::replace(replace_name.begin(), replace_name.end(), '/', '_');
-                    DumpBlobData(cpu_blobdata_map[blob_name].get(), blob_desc.dims,
-                                 model_checker_params_.dump_output_path + "/cpu_" + blob_name + ".txt",
-                                 data_type);
-                    DumpBlobData(output_data_ptr, blob_desc.dims,
-                                 model_checker_params_.dump_output_path + "/device_" + blob_name + ".txt",
-                                 data_type);
+                bool is_pass = CompareBlob(info, blob_name, device_data.get(), cpu_data.get(), data_type,
+                                           blob_desc.dims, is_output);
+                std::lock_guard<std::mutex> lock(result_mutex);
+                check_results[result_index].second = check_results[result_index].second && is_pass;
+                if (!is_pass && stop_on_failure) {
+                    stopped = true;
                 }
-            }
-
-            if (!model_checker_params_.dump_unaligned_layer_path.empty() && !is_pass) {
-                LOGE("dump unaligned blob (%s) data to %s\n", blob_name.c_str(),
-                     model_checker_params_.dump_unaligned_layer_path.c_str());
-                auto replace_name = blob_name;
-                std::replace(replace_name.begin(), replace_name.end(), '/', '_');
-                DumpBlobData(cpu_blobdata_map[blob_name].get(), blob_desc.dims,
-                             model_checker_params_.dump_unaligned_layer_path + "/cpu_" + blob_name + ".txt", data_type);
-                DumpBlobData(output_data_ptr, blob_desc.dims,
-                             model_checker_params_.dump_unaligned_layer_path + "/device_" + blob_name + ".txt",
-                             data_type);
-            }
+            });
         }
-        check_results.push_back(std::make_pair(info, is_pass));
     };
 
-    return instance_device_->ForwardWithCallback(nullptr, device_func_after);
+    Status ret = instance_device_->ForwardWithCallback(nullptr, device_func_after);
+    if (ret != TNN_OK) {
+        // unblock the compare tasks waiting for blobs the device did not produce
+        cpu_blobs.Finish(ret);
+    }
+    workers.Join();
+    if (cpu_thread.joinable()) {
+        cpu_thread.join();
+    }
+    RETURN_ON_NEQ(ret, TNN_OK);
+    return cpu_blobs.GetStatus();
+}
+
+bool ModelChecker::CompareBlob(LayerInfo* info, const std::string& blob_name, char* device_data, char* cpu_data,
+                               DataType data_type, DimsVector dims, bool is_output) {
+    if (cpu_data == nullptr) {
+        LOGE("blob (name:%s) not found in cpu instance\n", blob_name.c_str());
+        return false;
+    }
+
+    // compare device data with default data
+    const auto& tolerance = tolerance_profile_.Get(info->type);
+    bool is_pass          = CompareData(device_data, cpu_data, data_type, dims, tolerance);
+
+    // compare data with reference file
+    if (!output_ref_mat_map_.empty() && is_output) {
+        auto iter = output_ref_mat_map_.find(blob_name);
+        if (iter != output_ref_mat_map_.end()) {
+            is_pass &= CompareData(device_data, iter->second->GetData(), data_type, dims, tolerance);
+        } else {
+            LOGE("The output layer name: %s not find in the reference file.\n", blob_name.c_str());
+            is_pass = false;
+        }
+    }
+
+    if (!model_checker_params_.dump_output_path.empty() && is_output) {
+        LOGE("dump blob (%s) data to %s\n", blob_name.c_str(), model_checker_params_.dump_output_path.c_str());
+        DumpBlobData(cpu_data, dims, model_checker_params_.dump_output_path + "/cpu_" + blob_name + ".txt",
+                     data_type);
+        DumpBlobData(device_data, dims, model_checker_params_.dump_output_path + "/device_" + blob_name + ".txt",
+                     data_type);
+    }
+
+    if (!model_checker_params_.dump_unaligned_layer_path.empty() && !is_pass) {
+        LOGE("dump unaligned blob (%s) data to %s\n", blob_name.c_str(),
+             model_checker_params_.dump_unaligned_layer_path.c_str());
+        DumpBlobData(cpu_data, dims,
+                     model_checker_params_.dump_unaligned_layer_path + "/cpu_" + blob_name + ".txt", data_type);
+        DumpBlobData(device_data, dims,
+                     model_checker_params_.dump_unaligned_layer_path + "/device_" + blob_name + ".txt", data_type);
+    }
+
+    return is_pass;
 }
 
-bool ModelChecker::CompareData(void* device_data, void* cpu_data, DataType data_type, DimsVector blob_dims, CompareType dist_type) {
+bool ModelChecker::CompareData(void* device_data, void* cpu_data, DataType data_type, DimsVector blob_dims,
+                               const CompareTolerance& tolerance, CompareType dist_type) {
     int data_count     = DimsVectorUtils::Count(blob_dims);
     
     //use COSINE only for float data
@@ -737,14 +945,14 @@ bool ModelChecker::CompareData(void* device_data, void* cpu_data, DataType data_
     }
 
     if (DEFAULT == dist_type) {
-        float ep = 0.005;
+        const float ep = tolerance.relative;
         if (data_type == DATA_TYPE_FLOAT) {
             auto result_data  = reinterpret_cast<float*>(device_data);
             auto ref_data    = reinterpret_cast<float*>(cpu_data);
             for (unsigned long long i = 0; i < data_count; i++) {
                 auto diff = static_cast<float>(fabs(result_data[i] - ref_data[i]));
                 auto sum  = static_cast<float>(fabs(result_data[i]) + fabs(ref_data[i]));
-                if (fabs(diff / sum) > ep && fabs(diff) > 1e-3f) {
+                if (fabs(diff / sum) > ep && fabs(diff) > tolerance.absolute) {
                     LOGE("ERROR AT %llu result %.6f ref %.6f  diff/sum %f  diff %f\n", i, result_data[i],
                          ref_data[i],
                          fabs(diff / sum), fabs(diff));
@@ -755,7 +963,7 @@ bool ModelChecker::CompareData(void* device_data, void* cpu_data, DataType data_
             auto result_data  = reinterpret_cast<int*>(device_data);
             auto ref_data    = reinterpret_cast<int*>(cpu_data);
             for (unsigned long long i = 0; i < data_count; i++) {
-                if (abs(result_data[i] - ref_data[i]) > 1) {
+                if (abs(result_data[i] - ref_data[i]) > tolerance.integer) {
                     LOGE("ERROR AT %llu result %d ref %d\n", i, result_data[i], ref_data[i]);
                     return false;
                 }
@@ -764,7 +972,7 @@ bool ModelChecker::CompareData(void* device_data, void* cpu_data, DataType data_
             auto result_data  = reinterpret_cast<char*>(device_data);
             auto ref_data    = reinterpret_cast<char*>(cpu_data);
             for (unsigned long long i = 0; i < data_count; i++) {
-                if (abs(result_data[i] - ref_data[i]) > 1) {
+                if (abs(result_data[i] - ref_data[i]) > tolerance.integer) {
                     LOGE("ERROR AT %llu result %d ref %d\n", i, result_data[i], ref_data[i]);
                     return false;
                 }
@@ -799,7 +1007,7 @@ bool ModelChecker::CompareData(void* device_data, void* cpu_data, DataType data_
 
         printf("max diff: %lf   index: %d\n", max_diff, max_diff_idx);
         printf("cos distance: %lf\n", cos_distance);
-        if (cos_distance < 0.999 || std::isnan(cos_distance) || std::isinf(cos_distance)) {
+        if (cos_distance < tolerance.cosine || std::isnan(cos_distance) || std::isinf(cos_distance)) {
             return false;
         }
     } else {
@@ -16,12 +16,14 @@
 #define TNN_TOOLS_MODEL_CHECK_MODEL_CHECKER_H_
 
 #include <memory>
+#include <set>
 #include "file_reader.h"
 #include "tnn/core/blob.h"
 #include "tnn/core/instance.h"
 #include "tnn/core/layer_type.h"
 #include "tnn/core/status.h"
 #include "tnn/core/tnn.h"
+#include "tolerance_profile.h"
 
 namespace TNN_NS {
 
@@ -35,6 +37,14 @@ struct ModelCheckerParam {
     std::string dump_dir_path;
     std::string dump_output_path;
     std::string dump_unaligned_layer_path;
+    // builtin profile name or profile file, see ToleranceProfile
+    std::string tolerance_profile;
+    // stop comparing at the first unaligned layer instead of comparing every blob
+    bool stop_at_first_unaligned = false;
+    // threads comparing blobs, 0 uses all cores
+    int compare_threads = 0;
+    // threads of the cpu reference instance
+    int cpu_threads = 1;
 };
 
 enum CompareType { DEFAULT = 0, COSINE = 1 };
@@ -65,11 +75,19 @@ private:
     // @brief change batch size to check multi batch
     Status ChangeBatchOfInputShapes(InputShapesMap& input_shapes);
 
-    // @brief compare all blobs data between device and cpu
-    Status CompareDeviceAndCpu();
+    // @brief run cpu and device concurrently and compare the blobs in filter (all if empty) as they are produced,
+    // check_results gets one entry per device layer with compared blobs, in execution order. with stop_on_failure
+    // no more blobs are copied or compared once a layer is unaligned
+    Status ForwardAndCompare(const std::set<std::string>& filter, bool stop_on_failure = false);
+    // @brief compare one device blob with the cpu blob of the same name
+    bool CompareBlob(LayerInfo* info, const std::string& blob_name, char* device_data, char* cpu_data,
+                     DataType data_type, DimsVector dims, bool is_output);
     // @brief per channel compare
     Status RunModelCheckerPerLayer();
 
+    // @brief find the first unaligned layer in one forward of cpu and device
+    Status RunModelCheckerFirstUnaligned();
+
     // @brief just compare output
     Status RunModelCheckerOutput();
 
@@ -89,11 +107,9 @@ private:
     Status GetOutputRefData();
     // @brief convert blob data to nchw float data
     Status GetBlobData(Instance* instance, Blob* blob, std::map<std::string, std::shared_ptr<char>>& output_map);
-    // @brief get all blobs data
-    Status GetCpuBlobData();
-
     // @brief compare raw
-    bool CompareData(void* device_data, void* cpu_data, DataType data_type, DimsVector blob_dims, CompareType type = DEFAULT);
+    bool CompareData(void* device_data, void* cpu_data, DataType data_type, DimsVector blob_dims,
+                     const CompareTolerance& tolerance, CompareType type = DEFAULT);
     // @brief dump blob data
     void DumpBlobData(void* blob_data, DimsVector blob_dims, std::string output_name, DataType data_type);
 
@@ -102,8 +118,8 @@ private:
     std::shared_ptr<Instance> instance_cpu_    = nullptr;
     std::shared_ptr<Instance> instance_device_ = nullptr;
     std::map<std::string, std::shared_ptr<Mat>> output_ref_mat_map_;
-    std::map<std::string, std::shared_ptr<char>> cpu_blobdata_map;
     std::vector<std::pair<LayerInfo*, bool>> check_results;
+    ToleranceProfile tolerance_profile_;
 };
 
 }  // namespace TNN_NS
@@ -0,0 +1,115 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#include "tolerance_profile.h"
+
+#include <fstream>
+#include <sstream>
+
+#include "tnn/core/macro.h"
+
+namespace TNN_NS {
+
+static CompareTolerance MakeTolerance(float relative, float absolute, float cosine, int integer) {
+    CompareTolerance tolerance;
+    tolerance.relative = relative;
+    tolerance.absolute = absolute;
+    tolerance.cosine   = cosine;
+    tolerance.integer  = integer;
+    return tolerance;
+}
+
+Status ToleranceProfile::Load(const std::string& name_or_path) {
+    tolerances_.clear();
+    name_              = name_or_path.empty() ? "default" : name_or_path;
+    default_tolerance_ = CompareTolerance();
+
+    if (name_ == "default") {
+        return TNN_OK;
+    } else if (name_ == "fp16") {
+        // accumulations over long reductions lose the most bits in half precision
+        default_tolerance_ = MakeTolerance(0.01f, 1e-2f, 0.999f, 1);
+        for (auto type : {LAYER_CONVOLUTION, LAYER_DECONVOLUTION, LAYER_INNER_PRODUCT, LAYER_MATMUL, LAYER_LSTMONNX,
+                          LAYER_LAYER_NORM, LAYER_REDUCE_SUM, LAYER_REDUCE_MEAN}) {
+            tolerances_[type] = MakeTolerance(0.02f, 2e-2f, 0.998f, 1);
+        }
+        return TNN_OK;
+    } else if (name_ == "int8") {
+        default_tolerance_ = MakeTolerance(0.05f, 5e-2f, 0.99f, 2);
+        return TNN_OK;
+    }
+    return LoadFile(name_);
+}
+
+Status ToleranceProfile::LoadFile(const std::string& path) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        LOGE("ToleranceProfile: open %s failed, builtin profiles are default, fp16 and int8\n", path.c_str());
+        return Status(TNNERR_INVALID_INPUT, "tolerance profile not found");
+    }
+
+    std::string line;
+    int line_index = 0;
+    while (std::getline(file, line)) {
+        line_index++;
+        auto comment = line.find('#');
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        std::istringstream stream(line);
+        std::string type_str;
+        if (!(stream >> type_str)) {
+            continue;
+        }
+
+        CompareTolerance tolerance;
+        if (!(stream >> tolerance.relative >> tolerance.absolute >> tolerance.cosine)) {
+            LOGE("ToleranceProfile: %s:%d needs <layer type> <relative> <absolute> <cosine> [integer]\n",
+                 path.c_str(), line_index);
+            return Status(TNNERR_INVALID_INPUT, "invalid tolerance profile line");
+        }
+        int integer = 0;
+        if (stream >> integer) {
+            tolerance.integer = integer;
+        }
+
+        if (type_str == "*") {
+            default_tolerance_ = tolerance;
+            continue;
+        }
+        auto type = GlobalConvertLayerType(type_str);
+        if (type == LAYER_NOT_SUPPORT) {
+            LOGE("ToleranceProfile: %s:%d unknown layer type %s\n", path.c_str(), line_index, type_str.c_str());
+            return Status(TNNERR_INVALID_INPUT, "unknown layer type in tolerance profile");
+        }
+        tolerances_[type] = tolerance;
+    }
+    return TNN_OK;
+}
+
+const CompareTolerance& ToleranceProfile::Get(LayerType type) const {
+    auto iter = tolerances_.find(type);
+    return iter != tolerances_.end() ? iter->second : default_tolerance_;
+}
+
+const CompareTolerance& ToleranceProfile::GetDefault() const {
+    return default_tolerance_;
+}
+
+std::string ToleranceProfile::GetName() const {
+    return name_;
+}
+
+}  // namespace TNN_NS
@@ -0,0 +1,62 @@
+// Tencent is pleased to support the open source community by making TNN available.
+//
+// Copyright (C) 2020 THL A29 Limited, a Tencent company. All rights reserved.
+//
+// Licensed under the BSD 3-Clause License (the "License"); you may not use this file except
+// in compliance with the License. You may obtain a copy of the License at
+//
+// https://opensource.org/licenses/BSD-3-Clause
+//
+// Unless required by applicable law or agreed to in writing, software distributed
+// under the License is distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR
+// CONDITIONS OF ANY KIND, either express or implied. See the License for the
+// specific language governing permissions and limitations under the License.
+
+
+#ifndef TNN_TOOLS_MODEL_CHECK_TOLERANCE_PROFILE_H_
+#define TNN_TOOLS_MODEL_CHECK_TOLERANCE_PROFILE_H_
+
+#include <map>
+#include <string>
+
+#include "tnn/core/layer_type.h"
+#include "tnn/core/status.h"
+
+namespace TNN_NS {
+
+// a float element fails if both its relative and its absolute diff exceed the limits,
+// a whole output fails if its cosine similarity is below cosine
+struct CompareTolerance {
+    float relative = 0.005f;
+    float absolute = 1e-3f;
+    float cosine   = 0.999f;
+    // max diff of int32 and int8 elements
+    int integer = 1;
+};
+
+// tolerances per layer type, layers without an entry use the default one
+class ToleranceProfile {
+public:
+    // @brief load a builtin profile (default, fp16, int8) or a profile file, lines of the file are
+    // "<layer type> <relative> <absolute> <cosine> [integer]", the type * sets the default
+    Status Load(const std::string& name_or_path);
+
+    // @brief tolerance of layers of type
+    const CompareTolerance& Get(LayerType type) const;
+
+    // @brief tolerance of layers without an entry
+    const CompareTolerance& GetDefault() const;
+
+    std::string GetName() const;
+
+private:
+    Status LoadFile(const std::string& path);
+
+    std::string name_ = "default";
+    CompareTolerance default_tolerance_;
+    std::map<LayerType, CompareTolerance> tolerances_;
+};
+
+}  // namespace TNN_NS
+
+#endif  // TNN_TOOLS_MODEL_CHECK_TOLERANCE_PROFILE_H_
@@ -30,6 +30,23 @@ static const std::set<LayerType> kQuantizedLayerTypeStr = {LAYER_CONVOLUTION, LA
 
 static const std::set<LayerType> kBlobScaleMergeLayerTypeStr = {LAYER_RELU, LAYER_POOLING};
 
+// symmetric per channel quantization, element i of channel c is at c * channel_step + i * step
+static void QuantizeSymmetricPerChannel(const float* weights, int channels, int channel_step, int count, int step,
+                                        int8_t* quantized_weights, float* weight_scale) {
+    for (int c = 0; c < channels; ++c) {
+        float max = 0;
+        for (int i = 0; i < count; ++i) {
+            max = std::max(max, std::fabs(weights[c * channel_step + i * step]));
+        }
+        weight_scale[c] = max / 127.f;
+        const float inv = max > 0 ? 127.f / max : 0.f;
+        for (int i = 0; i < count; ++i) {
+            const int index          = c * channel_step + i * step;
+            quantized_weights[index] = static_cast<int8_t>(std::roundf(weights[index] * inv));
+        }
+    }
+}
+
 static void InitWeightScaleADMM(const float* weights, const int size, const int output_channel, bool merge_channel,
                                 float* weight_scale, const int quantize_bits) {
     int weight_scale_count = merge_channel ? 1 : output_channel;
@@ -241,6 +258,9 @@ int Calibration::InitFeatureMap() {
 
     BlobStatisticCallback func = [&](std::vector<Blob*>& blobs, LayerInfo* info) {
         LayerType layer_type = info->type;
+        if (cali_params_.dynamic_int8_matmul && layer_type == LAYER_INNER_PRODUCT) {
+            return;
+        }
         if (kQuantizedLayerTypeStr.find(layer_type) != kQuantizedLayerTypeStr.end() ||
             kBlobScaleMergeLayerTypeStr.find(layer_type) != kBlobScaleMergeLayerTypeStr.end()) {
             for (auto blob : blobs) {
@@ -413,6 +433,15 @@ int Calibration::QuantizeParams() {
             continue;
         }
 
+        if (cali_params_.dynamic_int8_matmul && (layer_type == LAYER_MATMUL || layer_type == LAYER_INNER_PRODUCT)) {
+            int ret = QuantizeDynamicInt8Params(item.get(), net_resource);
+            if (ret != 0) {
+                LOGE("Quantize dynamic int8 weights failed! (layer name: %s)\n", item->name.c_str());
+                return -1;
+            }
+            continue;
+        }
+
         if (kQuantizedLayerTypeStr.find(layer_type) != kQuantizedLayerTypeStr.end()) {
             // assign NetStructure
             item->param->quantized = true;
@@ -674,6 +703,78 @@ int Calibration::QuantizeFcParams(InnerProductLayerResource* resource, InnerProd
     return 0;
 }
 
+// the weights are stored as dynamic range quantized ones with per channel scales, x86 runs
+// them as a dynamic int8 gemm under low precision and other devices dequantize them on load
+int Calibration::QuantizeDynamicInt8Params(LayerInfo* layer_info, NetResource* net_resource) {
+    auto iter = net_resource->resource_map.find(layer_info->name);
+    if (iter == net_resource->resource_map.end()) {
+        return 0;
+    }
+
+    if (layer_info->type == LAYER_INNER_PRODUCT) {
+        printf("\tQuantize InnerProduct parameters for dynamic int8...\n");
+        auto fc_res   = dynamic_cast<InnerProductLayerResource*>(iter->second.get());
+        auto fc_param = dynamic_cast<InnerProductLayerParam*>(layer_info->param.get());
+        if (!fc_res || !fc_param) {
+            return -1;
+        }
+        auto weight_handle = ConvertHalfHandle(fc_res->weight_handle);
+        int size           = weight_handle.GetDataCount();
+        int output_channel = fc_param->num_output;
+        if (output_channel <= 0 || size % output_channel != 0) {
+            LOGE("invalid weight size!\n");
+            return -1;
+        }
+
+        RawBuffer weight_quantized(size * sizeof(char));
+        weight_quantized.SetDataType(DATA_TYPE_INT8);
+        weight_quantized.SetBufferDims(fc_res->weight_handle.GetBufferDims());
+        RawBuffer weight_scale(output_channel * sizeof(float));
+        QuantizeSymmetricPerChannel(weight_handle.force_to<float*>(), output_channel, size / output_channel,
+                                    size / output_channel, 1, weight_quantized.force_to<int8_t*>(),
+                                    weight_scale.force_to<float*>());
+        fc_res->weight_handle = weight_quantized;
+        fc_res->scale_handle  = weight_scale;
+        if (fc_param->has_bias) {
+            fc_res->bias_handle = ConvertHalfHandle(fc_res->bias_handle);
+        }
+    } else {
+        auto matmul_res   = dynamic_cast<MatMulLayerResource*>(iter->second.get());
+        auto matmul_param = dynamic_cast<MatMulLayerParam*>(layer_info->param.get());
+        if (!matmul_res || !matmul_param || matmul_param->weight_position != 1) {
+            return 0;
+        }
+        printf("\tQuantize MatMul parameters for dynamic int8...\n");
+        auto weight_handle = ConvertHalfHandle(matmul_res->weight);
+        auto weight_dims   = weight_handle.GetBufferDims();
+        if (weight_dims.size() < 2) {
+            // old models do not save the dims of the weight, the forward pass has inferred them
+            weight_dims = matmul_param->matrix_b_dims;
+        }
+        int size = weight_handle.GetDataCount();
+        int columns        = weight_dims.empty() ? 0 : weight_dims.back();
+        if (weight_dims.size() < 2 || columns <= 0 || size % columns != 0) {
+            LOGE("invalid matmul weight dims!\n");
+            return -1;
+        }
+
+        // one scale per column of B, shared by the batches of B
+        RawBuffer weight_quantized(size * sizeof(char));
+        weight_quantized.SetDataType(DATA_TYPE_INT8);
+        weight_quantized.SetBufferDims(weight_dims);
+        RawBuffer weight_scale(columns * sizeof(float));
+        QuantizeSymmetricPerChannel(weight_handle.force_to<float*>(), columns, 1, size / columns, columns,
+                                    weight_quantized.force_to<int8_t*>(), weight_scale.force_to<float*>());
+        matmul_res->weight       = weight_quantized;
+        matmul_res->scale_handle = weight_scale;
+    }
+
+    layer_info->param->quantized               = false;
+    layer_info->param->dynamic_range_quantized = true;
+    printf("\t====> done!\n");
+    return 0;
+}
+
 int Calibration::CalQuantizedWeights(const float* weights, const int size, const int output_channel, bool merge_channel,
                                      int8_t* quantized_weights, float* weight_scale, int8_t* weight_zero_point) {
     ASSERT(size % output_channel == 0);
@@ -71,6 +71,7 @@ private:
     //                         int8_t* quantized_weight, float* weight_scale);
     int CalQuantizedWeights(const float* weights, const int size, const int output_channel, bool merge_channel,
                             int8_t* quantized_weight, float* weight_scale,  int8_t* weight_zero_point);
+    int QuantizeDynamicInt8Params(LayerInfo* layer_info, NetResource* net_resource);
 
     int MergeBlobScale();
     void MergeBlobScaleRecursion(LayerInfo* layer_info, NetStructure* net_struct, NetResource* net_resource);
@@ -54,6 +54,9 @@ struct CalibrationParam {
     std::vector<float> input_bias             = {0, 0, 0, 0};
     std::vector<float> input_scale            = {1.0f, 1.0f, 1.0f, 1.0f};
     bool reverse_channel                      = false;
+    /* matmul and inner product keep float blobs, their weights are quantized per output channel
+       and their inputs per row at runtime */
+    bool dynamic_int8_matmul                  = false;
 };
 
 }  // namespace TNN_NS
@@ -178,7 +178,7 @@ bool CheckFileName(std::string name) {
 void PrintConfig() {
     printf(
         "usage:\n./quantization_cmd [-h] [-p] <proto file> [-m] <model file> [-i] <input folder> [-b] <val> [-w] <val> "
-        "[-n] <val> [-s] <val> [-t] <val> [-o] <output_name>\n"
+        "[-n] <val> [-s] <val> [-t] <val> [-d] <val> [-o] <output_name>\n"
         "\t-h, --help        \t show this message\n"
         "\t-p, --proto       \t(require) tnn proto file name\n"
         "\t-m, --model       \t(require) tnn model file name\n"
@@ -207,6 +207,9 @@ void PrintConfig() {
         "\t\t0: per-channel mode  (default)\n"
         "\t\t1: mix mode          weight: per-channel  blob: per-tensor\n"
         "\t\t2: per-tensor mode\n"
+        "\t-d, --dynamic_matmul\t(optional) quantize matmul and inner product for a dynamic int8 gemm\n"
+        "\t\t0: matmul stays fp32, inner product is quantized with the other layers  (default)\n"
+        "\t\t1: int8 weights with per channel scales, inputs are quantized per row at runtime (x86, low precision)\n"
         "\t-o, --output       \t(optional) specify the name of output\n");
 }
 
@@ -228,11 +231,12 @@ int main(int argc, char* argv[]) {
                                     {"bias", required_argument, 0, 'n'},
                                     {"scale", required_argument, 0, 's'},
                                     {"merge_type", required_argument, 0, 't'},
+                                    {"dynamic_matmul", required_argument, 0, 'd'},
                                     {"output", required_argument, 0, 'o'},
                                     {"help", no_argument, 0, 'h'},
                                     {0, 0, 0, 0}};
 
-    const char* optstring = "p:m:i:b:w:r:n:s:t:o:h";
+    const char* optstring = "p:m:i:b:w:r:n:s:t:d:o:h";
 
     if (argc == 1) {
         PrintConfig();
@@ -317,6 +321,10 @@ int main(int argc, char* argv[]) {
                     cali_params.merge_weights_channel = false;
                 }
             } break;
+            case 'd':
+                printf("dynamic matmul: %s\n", optarg);
+                cali_params.dynamic_int8_matmul = atoi(optarg) == 1;
+                break;
             case 'o':
                 printf("output name: %s\n", optarg);
                 output_name = optarg;